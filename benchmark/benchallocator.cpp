@@ -0,0 +1,244 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "benchmark.h"
+#include "platform.h"
+
+#ifndef NCNN_SIMPLESTL
+#include <vector>
+#endif
+
+// one malloc into slot or free of slot
+struct AllocatorOp
+{
+    int slot;
+    size_t size; // 0 for free
+};
+
+// the blob and workspace pattern of one inference through a chain of layers
+// every fourth blob stays alive for a while as a shortcut branch
+static void make_net_trace(std::vector<AllocatorOp>& ops, int& slot_count)
+{
+    const size_t sizes[] = {
+        802816, 401408, 401408, 200704, 200704, 200704, 100352, 100352,
+        100352, 100352, 50176, 50176, 50176, 50176, 50176, 25088,
+        25088, 25088, 12544, 12544, 6272, 4096, 4000, 1000
+    };
+    const int size_count = sizeof(sizes) / sizeof(sizes[0]);
+
+    const int layer_count = 96;
+
+    ops.clear();
+    slot_count = layer_count + 1;
+
+    // input blob
+    AllocatorOp op;
+    op.slot = 0;
+    op.size = sizes[0];
+    ops.push_back(op);
+
+    unsigned int seed = 7767517;
+    for (int i = 0; i < layer_count; i++)
+    {
+        const size_t top_size = sizes[i * size_count / layer_count];
+
+        // top blob
+        op.slot = i + 1;
+        op.size = top_size;
+        ops.push_back(op);
+
+        // workspace
+        seed = seed * 1103515245 + 12345;
+        const int workspace_count = (seed >> 16) % 3;
+        for (int j = 0; j < workspace_count; j++)
+        {
+            op.slot = slot_count + j;
+            op.size = top_size * (2 + j) + (seed >> 8) % 64 * 16;
+            ops.push_back(op);
+        }
+        for (int j = 0; j < workspace_count; j++)
+        {
+            op.slot = slot_count + j;
+            op.size = 0;
+            ops.push_back(op);
+        }
+
+        // bottom blob is consumed, shortcut blobs are consumed four layers later
+        if (i % 4 != 0)
+        {
+            op.slot = i;
+            op.size = 0;
+            ops.push_back(op);
+        }
+        if (i >= 4 && (i - 4) % 4 == 0)
+        {
+            op.slot = i - 4;
+            op.size = 0;
+            ops.push_back(op);
+        }
+    }
+
+    // output blob and remaining shortcuts
+    for (int i = layer_count - 4; i <= layer_count; i++)
+    {
+        if (i % 4 == 0 || i == layer_count)
+        {
+            op.slot = i;
+            op.size = 0;
+            ops.push_back(op);
+        }
+    }
+
+    slot_count += 2;
+}
+
+struct BenchThreadArgs
+{
+    ncnn::Allocator* allocator;
+    const std::vector<AllocatorOp>* ops;
+    int slot_count;
+    int loop_count;
+};
+
+static void* bench_thread(void* args)
+{
+    BenchThreadArgs* ta = (BenchThreadArgs*)args;
+
+    const std::vector<AllocatorOp>& ops = *ta->ops;
+
+    std::vector<void*> slots(ta->slot_count, (void*)0);
+
+    for (int i = 0; i < ta->loop_count; i++)
+    {
+        for (size_t j = 0; j < ops.size(); j++)
+        {
+            const AllocatorOp& op = ops[j];
+            if (op.size)
+            {
+                slots[op.slot] = ta->allocator->fastMalloc(op.size);
+
+                // touch the first line as a layer would
+                *(volatile char*)slots[op.slot] = 0;
+            }
+            else
+            {
+                ta->allocator->fastFree(slots[op.slot]);
+                slots[op.slot] = 0;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static double run_bench(ncnn::Allocator* allocator, const std::vector<AllocatorOp>& ops, int slot_count, int loop_count, int thread_count)
+{
+    // warm up the pool
+    {
+        BenchThreadArgs args;
+        args.allocator = allocator;
+        args.ops = &ops;
+        args.slot_count = slot_count;
+        args.loop_count = 1;
+        bench_thread(&args);
+    }
+
+    std::vector<BenchThreadArgs> args(thread_count);
+    for (int i = 0; i < thread_count; i++)
+    {
+        args[i].allocator = allocator;
+        args[i].ops = &ops;
+        args[i].slot_count = slot_count;
+        args[i].loop_count = loop_count;
+    }
+
+    double start = ncnn::get_current_time();
+
+#if NCNN_THREADS
+    std::vector<ncnn::Thread*> threads(thread_count);
+    for (int i = 0; i < thread_count; i++)
+    {
+        threads[i] = new ncnn::Thread(bench_thread, &args[i]);
+    }
+    for (int i = 0; i < thread_count; i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+#else
+    for (int i = 0; i < thread_count; i++)
+    {
+        bench_thread(&args[i]);
+    }
+#endif
+
+    double end = ncnn::get_current_time();
+
+    return end - start;
+}
+
+static void print_result(const char* name, int thread_count, double time, size_t op_count)
+{
+    // one malloc and one free per two ops
+    const double ns_per_pair = time * 1000000.0 / (op_count / 2);
+    fprintf(stderr, "%24s  threads = %2d  time = %8.2f ms  %8.1f ns per malloc/free\n", name, thread_count, time, ns_per_pair);
+}
+
+int main(int argc, char** argv)
+{
+    int loop_count = 2000;
+    int max_thread_count = 8;
+
+    if (argc >= 2)
+    {
+        loop_count = atoi(argv[1]);
+    }
+    if (argc >= 3)
+    {
+        max_thread_count = atoi(argv[2]);
+    }
+
+    if (loop_count < 1 || max_thread_count < 1)
+    {
+        fprintf(stderr, "Usage: %s [loop count] [max threads]\n", argv[0]);
+        return -1;
+    }
+
+    std::vector<AllocatorOp> ops;
+    int slot_count = 0;
+    make_net_trace(ops, slot_count);
+
+    fprintf(stderr, "loop_count = %d\n", loop_count);
+    fprintf(stderr, "max_thread_count = %d\n", max_thread_count);
+    fprintf(stderr, "ops per loop = %d\n", (int)ops.size());
+
+    // single extractor
+    {
+        ncnn::UnlockedPoolAllocator allocator;
+        double time = run_bench(&allocator, ops, slot_count, loop_count, 1);
+        print_result("UnlockedPoolAllocator", 1, time, ops.size() * loop_count);
+    }
+
+    // many extractors sharing one pool
+    for (int thread_count = 1; thread_count <= max_thread_count; thread_count *= 2)
+    {
+        {
+            ncnn::PoolAllocator allocator;
+            double time = run_bench(&allocator, ops, slot_count, loop_count, thread_count);
+            print_result("PoolAllocator", thread_count, time, ops.size() * loop_count * thread_count);
+        }
+
+        {
+            ncnn::BinnedPoolAllocator allocator;
+            double time = run_bench(&allocator, ops, slot_count, loop_count, thread_count);
+            print_result("BinnedPoolAllocator", thread_count, time, ops.size() * loop_count * thread_count);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,529 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu.h"
+#include "testutil.h"
+
+#ifndef NCNN_SIMPLESTL
+#include <vector>
+#endif
+
+// one layer instance to sweep
+struct BenchCase
+{
+    const char* layer_type;
+    char shape[64];
+    char path[16];
+
+    ncnn::ParamDict pd;
+    std::vector<ncnn::Mat> weights;
+    std::vector<ncnn::Mat> inputs;
+
+    // work of one forward
+    double flops;
+    double activation_elements;
+    double weight_elements;
+
+    // options selecting the kernel path
+    bool use_winograd_convolution;
+    bool use_winograd23_convolution;
+    bool use_winograd43_convolution;
+    bool use_winograd63_convolution;
+    bool use_sgemm_convolution;
+
+    // weights carry int8 scales
+    bool int8;
+};
+
+static void init_case(BenchCase& bc, const char* layer_type)
+{
+    bc.layer_type = layer_type;
+    bc.shape[0] = '\0';
+    strcpy(bc.path, "default");
+    bc.flops = 0;
+    bc.activation_elements = 0;
+    bc.weight_elements = 0;
+    bc.use_winograd_convolution = true;
+    bc.use_winograd23_convolution = true;
+    bc.use_winograd43_convolution = true;
+    bc.use_winograd63_convolution = true;
+    bc.use_sgemm_convolution = true;
+    bc.int8 = false;
+}
+
+static void make_convolution_cases(std::vector<BenchCase>& cases, int w, int h, int c, int outch, int kernel, int stride, bool int8)
+{
+    const int outw = (w + 2 * (kernel / 2) - kernel) / stride + 1;
+    const int outh = (h + 2 * (kernel / 2) - kernel) / stride + 1;
+
+    // winograd only applies to 3x3 s1
+    const char* paths[] = {"wino63", "wino43", "wino23", "sgemm", "direct"};
+    const int path_start = kernel == 3 && stride == 1 && !int8 ? 0 : 3;
+
+    for (int p = path_start; p < 5; p++)
+    {
+        BenchCase bc;
+        init_case(bc, "Convolution");
+        sprintf(bc.shape, "%dx%dx%d->%d k%ds%d", w, h, c, outch, kernel, stride);
+        strcpy(bc.path, paths[p]);
+
+        bc.pd.set(0, outch);
+        bc.pd.set(1, kernel);
+        bc.pd.set(3, stride);
+        bc.pd.set(4, kernel / 2);
+        bc.pd.set(5, 1);
+        bc.pd.set(6, outch * c * kernel * kernel);
+
+        bc.weights.push_back(RandomMat(outch * c * kernel * kernel));
+        bc.weights.push_back(RandomMat(outch));
+        bc.inputs.push_back(RandomMat(w, h, c));
+
+        if (int8)
+        {
+            bc.pd.set(8, 1);
+            bc.weights.push_back(scales_mat(bc.weights[0], outch, c * kernel * kernel, c * kernel * kernel));
+            bc.weights.push_back(scales_mat(bc.inputs[0], 1, w * h * c, bc.inputs[0].cstep));
+            bc.int8 = true;
+        }
+
+        bc.use_winograd63_convolution = p == 0;
+        bc.use_winograd43_convolution = p == 1;
+        bc.use_winograd23_convolution = p == 2;
+        bc.use_winograd_convolution = p < 3;
+        bc.use_sgemm_convolution = p == 3;
+
+        bc.flops = 2.0 * outw * outh * outch * c * kernel * kernel;
+        bc.activation_elements = (double)w * h * c + (double)outw * outh * outch;
+        bc.weight_elements = (double)outch * c * kernel * kernel;
+
+        cases.push_back(bc);
+    }
+}
+
+static void make_convolutiondepthwise_case(std::vector<BenchCase>& cases, int w, int h, int c, int kernel, int stride, bool int8)
+{
+    const int outw = (w + 2 * (kernel / 2) - kernel) / stride + 1;
+    const int outh = (h + 2 * (kernel / 2) - kernel) / stride + 1;
+
+    BenchCase bc;
+    init_case(bc, "ConvolutionDepthWise");
+    sprintf(bc.shape, "%dx%dx%d k%ds%d", w, h, c, kernel, stride);
+
+    bc.pd.set(0, c);
+    bc.pd.set(1, kernel);
+    bc.pd.set(3, stride);
+    bc.pd.set(4, kernel / 2);
+    bc.pd.set(5, 1);
+    bc.pd.set(6, c * kernel * kernel);
+    bc.pd.set(7, c);
+
+    bc.weights.push_back(RandomMat(c * kernel * kernel));
+    bc.weights.push_back(RandomMat(c));
+    bc.inputs.push_back(RandomMat(w, h, c));
+
+    if (int8)
+    {
+        bc.pd.set(8, 1);
+        bc.weights.push_back(scales_mat(bc.weights[0], c, kernel * kernel, kernel * kernel));
+        bc.weights.push_back(scales_mat(bc.inputs[0], 1, w * h * c, bc.inputs[0].cstep));
+        bc.int8 = true;
+    }
+
+    bc.flops = 2.0 * outw * outh * c * kernel * kernel;
+    bc.activation_elements = (double)w * h * c + (double)outw * outh * c;
+    bc.weight_elements = (double)c * kernel * kernel;
+
+    cases.push_back(bc);
+}
+
+static void make_gemm_cases(std::vector<BenchCase>& cases, int M, int N, int K)
+{
+    // B as constant weight or as the second input
+    for (int constantB = 1; constantB >= 0; constantB--)
+    {
+        BenchCase bc;
+        init_case(bc, "Gemm");
+        sprintf(bc.shape, "M%d N%d K%d", M, N, K);
+        strcpy(bc.path, constantB ? "constB" : "dynamicB");
+
+        bc.pd.set(2, 0);
+        bc.pd.set(3, 1);
+        bc.pd.set(4, 0);
+        bc.pd.set(5, constantB);
+        bc.pd.set(6, 1);
+        bc.pd.set(7, M);
+        bc.pd.set(8, N);
+        bc.pd.set(9, K);
+        bc.pd.set(10, -1);
+
+        bc.inputs.push_back(RandomMat(K, M));
+        if (constantB)
+            bc.weights.push_back(RandomMat(K, N));
+        else
+            bc.inputs.push_back(RandomMat(K, N));
+
+        bc.flops = 2.0 * M * N * K;
+        bc.activation_elements = (double)M * K + (double)M * N;
+        bc.weight_elements = (double)N * K;
+
+        cases.push_back(bc);
+    }
+}
+
+static void make_innerproduct_case(std::vector<BenchCase>& cases, int M, int K, int N, bool int8)
+{
+    BenchCase bc;
+    init_case(bc, "InnerProduct");
+    if (M == 1)
+        sprintf(bc.shape, "%d->%d", K, N);
+    else
+        sprintf(bc.shape, "%dx%d->%d", M, K, N);
+
+    bc.pd.set(0, N);
+    bc.pd.set(1, 1);
+    bc.pd.set(2, N * K);
+
+    bc.weights.push_back(RandomMat(N * K));
+    bc.weights.push_back(RandomMat(N));
+    bc.inputs.push_back(M == 1 ? RandomMat(K) : RandomMat(K, M));
+
+    if (int8)
+    {
+        bc.pd.set(8, 1);
+        bc.weights.push_back(scales_mat(bc.weights[0], N, K, K));
+        bc.weights.push_back(scales_mat(bc.inputs[0], 1, M * K, M * K));
+        bc.int8 = true;
+    }
+
+    bc.flops = 2.0 * M * N * K;
+    bc.activation_elements = (double)M * K + (double)M * N;
+    bc.weight_elements = (double)N * K;
+
+    cases.push_back(bc);
+}
+
+static void make_multiheadattention_case(std::vector<BenchCase>& cases, int seqlen, int embed_dim, int num_heads)
+{
+    BenchCase bc;
+    init_case(bc, "MultiHeadAttention");
+    sprintf(bc.shape, "L%d E%d H%d", seqlen, embed_dim, num_heads);
+
+    bc.pd.set(0, embed_dim);
+    bc.pd.set(1, num_heads);
+    bc.pd.set(2, embed_dim * embed_dim);
+    bc.pd.set(3, embed_dim);
+    bc.pd.set(4, embed_dim);
+
+    for (int i = 0; i < 4; i++)
+    {
+        bc.weights.push_back(RandomMat(embed_dim * embed_dim));
+        bc.weights.push_back(RandomMat(embed_dim));
+    }
+    bc.inputs.push_back(RandomMat(embed_dim, seqlen));
+
+    // q k v out projections and the two attention products
+    bc.flops = 4 * 2.0 * seqlen * embed_dim * embed_dim + 2 * 2.0 * seqlen * seqlen * embed_dim;
+    bc.activation_elements = 2.0 * seqlen * embed_dim;
+    bc.weight_elements = 4.0 * embed_dim * embed_dim;
+
+    cases.push_back(bc);
+}
+
+static void make_layernorm_case(std::vector<BenchCase>& cases, int w, int h)
+{
+    BenchCase bc;
+    init_case(bc, "LayerNorm");
+    sprintf(bc.shape, "%dx%d", w, h);
+
+    bc.pd.set(0, w);
+    bc.pd.set(1, 0.00001f);
+    bc.pd.set(2, 1);
+
+    bc.weights.push_back(RandomMat(w));
+    bc.weights.push_back(RandomMat(w));
+    bc.inputs.push_back(RandomMat(w, h));
+
+    // mean, variance, normalize and affine
+    bc.flops = 7.0 * w * h;
+    bc.activation_elements = 2.0 * w * h;
+    bc.weight_elements = 2.0 * w;
+
+    cases.push_back(bc);
+}
+
+static void make_softmax_case(std::vector<BenchCase>& cases, int w, int h)
+{
+    BenchCase bc;
+    init_case(bc, "Softmax");
+    sprintf(bc.shape, "%dx%d", w, h);
+
+    bc.pd.set(0, 1);
+    bc.pd.set(1, 1);
+
+    bc.inputs.push_back(RandomMat(w, h));
+
+    // max, sub, exp, sum and div, exp counted as one
+    bc.flops = 5.0 * w * h;
+    bc.activation_elements = 2.0 * w * h;
+
+    cases.push_back(bc);
+}
+
+static void make_cases(std::vector<BenchCase>& cases)
+{
+    make_convolution_cases(cases, 56, 56, 64, 64, 3, 1, false);
+    make_convolution_cases(cases, 28, 28, 128, 128, 3, 1, false);
+    make_convolution_cases(cases, 14, 14, 256, 256, 3, 1, false);
+    make_convolution_cases(cases, 56, 56, 64, 256, 1, 1, false);
+    make_convolution_cases(cases, 112, 112, 32, 64, 3, 2, false);
+    make_convolution_cases(cases, 28, 28, 128, 128, 3, 1, true);
+
+    make_convolutiondepthwise_case(cases, 112, 112, 32, 3, 1, false);
+    make_convolutiondepthwise_case(cases, 56, 56, 128, 3, 2, false);
+    make_convolutiondepthwise_case(cases, 28, 28, 256, 5, 1, false);
+    make_convolutiondepthwise_case(cases, 56, 56, 96, 7, 1, false);
+    make_convolutiondepthwise_case(cases, 28, 28, 192, 13, 1, false);
+    make_convolutiondepthwise_case(cases, 14, 14, 256, 31, 1, false);
+    make_convolutiondepthwise_case(cases, 56, 56, 128, 3, 1, true);
+
+    make_gemm_cases(cases, 64, 64, 64);
+    make_gemm_cases(cases, 256, 256, 256);
+    make_gemm_cases(cases, 1, 1024, 1024);
+    make_gemm_cases(cases, 384, 768, 768);
+
+    make_innerproduct_case(cases, 1, 1024, 1000, false);
+    make_innerproduct_case(cases, 1, 4096, 4096, false);
+    make_innerproduct_case(cases, 64, 768, 768, false);
+    make_innerproduct_case(cases, 1, 4096, 4096, true);
+
+    make_multiheadattention_case(cases, 64, 256, 4);
+    make_multiheadattention_case(cases, 197, 768, 12);
+
+    make_layernorm_case(cases, 768, 197);
+    make_layernorm_case(cases, 4096, 32);
+
+    make_softmax_case(cases, 197, 197 * 12);
+    make_softmax_case(cases, 32000, 4);
+}
+
+// fp32 fp16 bf16 or int8
+static int set_precision(ncnn::Option& opt, const char* precision, const BenchCase& bc)
+{
+    opt.use_fp16_packed = false;
+    opt.use_fp16_storage = false;
+    opt.use_fp16_arithmetic = false;
+    opt.use_bf16_storage = false;
+    opt.use_int8_inference = bc.int8;
+
+    if (strcmp(precision, "fp32") == 0)
+        return bc.int8 ? -1 : 0;
+
+    if (strcmp(precision, "int8") == 0)
+        return bc.int8 ? 0 : -1;
+
+    if (bc.int8)
+        return -1;
+
+    if (strcmp(precision, "fp16") == 0)
+    {
+        opt.use_fp16_packed = true;
+        opt.use_fp16_storage = true;
+        opt.use_fp16_arithmetic = true;
+        return 0;
+    }
+
+    if (strcmp(precision, "bf16") == 0)
+    {
+        opt.use_bf16_storage = true;
+        return 0;
+    }
+
+    return -1;
+}
+
+// bytes of one element in each precision, int8 layers take int8 weights and fp32 activations
+static double activation_bytes(const char* precision)
+{
+    return strcmp(precision, "fp16") == 0 || strcmp(precision, "bf16") == 0 ? 2 : 4;
+}
+
+static double weight_bytes(const char* precision)
+{
+    if (strcmp(precision, "int8") == 0)
+        return 1;
+
+    return strcmp(precision, "fp16") == 0 || strcmp(precision, "bf16") == 0 ? 2 : 4;
+}
+
+static std::vector<int> parse_int_list(char* s)
+{
+    std::vector<int> values;
+
+    char* pch = strtok(s, ",");
+    while (pch != NULL)
+    {
+        values.push_back(atoi(pch));
+        pch = strtok(NULL, ",");
+    }
+
+    return values;
+}
+
+static void show_usage()
+{
+    fprintf(stderr, "Usage: benchlayer [loop count] [num threads] [(key=value)...]\n");
+    fprintf(stderr, "  layer=Convolution\n");
+    fprintf(stderr, "  threads=1,4\n");
+    fprintf(stderr, "  packing=0/1/2\n");
+    fprintf(stderr, "  precision=all/fp32/fp16/bf16/int8\n");
+    fprintf(stderr, "  format=text/csv\n");
+}
+
+int main(int argc, char** argv)
+{
+    int loop_count = 10;
+    int num_threads = ncnn::get_physical_big_cpu_count();
+    const char* layer_filter = 0;
+    std::vector<int> thread_list;
+    int packing = 2;
+    const char* precision_filter = "all";
+    bool csv = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+        {
+            show_usage();
+            return -1;
+        }
+    }
+
+    if (argc >= 2)
+    {
+        loop_count = std::max(atoi(argv[1]), 1);
+    }
+    if (argc >= 3)
+    {
+        num_threads = std::max(atoi(argv[2]), 1);
+    }
+
+    for (int i = 3; i < argc; i++)
+    {
+        // key=value
+        char* kv = argv[i];
+
+        char* eqs = strchr(kv, '=');
+        if (eqs == NULL)
+        {
+            fprintf(stderr, "unrecognized arg %s\n", kv);
+            continue;
+        }
+
+        // split k v
+        eqs[0] = '\0';
+        const char* key = kv;
+        char* value = eqs + 1;
+
+        if (strcmp(key, "layer") == 0)
+            layer_filter = value;
+        if (strcmp(key, "threads") == 0)
+            thread_list = parse_int_list(value);
+        if (strcmp(key, "packing") == 0)
+            packing = atoi(value);
+        if (strcmp(key, "precision") == 0)
+            precision_filter = value;
+        if (strcmp(key, "format") == 0)
+            csv = strcmp(value, "csv") == 0;
+    }
+
+    if (thread_list.empty())
+    {
+        thread_list.push_back(1);
+        if (num_threads > 1)
+            thread_list.push_back(num_threads);
+    }
+
+    ncnn::set_omp_dynamic(0);
+
+    SRAND(7767517);
+
+    std::vector<BenchCase> cases;
+    make_cases(cases);
+
+    const char* precisions[] = {"fp32", "fp16", "bf16", "int8"};
+
+    fprintf(stderr, "loop_count = %d\n", loop_count);
+    fprintf(stderr, "%-20s %-24s %-8s %4s %5s %3s %9s %9s %8s %8s\n", "layer", "shape", "path", "prec", "pack", "thr", "min(ms)", "avg(ms)", "GFLOPS", "GB/s");
+
+    if (csv)
+    {
+        printf("layer,shape,path,precision,packing,threads,min,avg,gflops,gbps\n");
+    }
+
+    for (size_t i = 0; i < cases.size(); i++)
+    {
+        const BenchCase& bc = cases[i];
+
+        if (layer_filter && strcmp(layer_filter, bc.layer_type) != 0)
+            continue;
+
+        for (int pi = 0; pi < 4; pi++)
+        {
+            const char* precision = precisions[pi];
+
+            if (strcmp(precision_filter, "all") != 0 && strcmp(precision_filter, precision) != 0)
+                continue;
+
+            for (int use_packing_layout = 0; use_packing_layout < 2; use_packing_layout++)
+            {
+                if (packing != 2 && packing != use_packing_layout)
+                    continue;
+
+                for (size_t ti = 0; ti < thread_list.size(); ti++)
+                {
+                    ncnn::Option opt;
+                    opt.num_threads = thread_list[ti];
+                    opt.use_packing_layout = use_packing_layout != 0;
+                    opt.use_winograd_convolution = bc.use_winograd_convolution;
+                    opt.use_winograd23_convolution = bc.use_winograd23_convolution;
+                    opt.use_winograd43_convolution = bc.use_winograd43_convolution;
+                    opt.use_winograd63_convolution = bc.use_winograd63_convolution;
+                    opt.use_sgemm_convolution = bc.use_sgemm_convolution;
+
+                    if (set_precision(opt, precision, bc) != 0)
+                        continue;
+
+                    ncnn::set_omp_num_threads(opt.num_threads);
+
+                    double time_min = 0;
+                    double time_avg = 0;
+                    int ret = bench_layer_cpu(bc.layer_type, bc.pd, bc.weights, opt, bc.inputs, 1, loop_count, time_min, time_avg);
+                    if (ret == 233)
+                        continue;
+
+                    if (ret != 0)
+                    {
+                        fprintf(stderr, "%-20s %-24s %-8s %4s %5d %3d failed %d\n", bc.layer_type, bc.shape, bc.path, precision, use_packing_layout, opt.num_threads, ret);
+                        continue;
+                    }
+
+                    const double gflops = bc.flops / (time_min * 1e6);
+                    const double gbps = (bc.activation_elements * activation_bytes(precision) + bc.weight_elements * weight_bytes(precision)) / (time_min * 1e6);
+
+                    fprintf(stderr, "%-20s %-24s %-8s %4s %5d %3d %9.3f %9.3f %8.2f %8.2f\n", bc.layer_type, bc.shape, bc.path, precision, use_packing_layout, opt.num_threads, time_min, time_avg, gflops, gbps);
+
+                    if (csv)
+                    {
+                        printf("%s,%s,%s,%s,%d,%d,%.4f,%.4f,%.3f,%.3f\n", bc.layer_type, bc.shape, bc.path, precision, use_packing_layout, opt.num_threads, time_min, time_avg, gflops, gbps);
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -9,6 +9,10 @@
 #include <emscripten.h>
 #endif
 
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
 #include "benchmark.h"
 #include "cpu.h"
 #include "datareader.h"
@@ -16,6 +20,7 @@
 #include "gpu.h"
 
 #ifndef NCNN_SIMPLESTL
+#include <algorithm>
 #include <vector>
 #endif
 
@@ -36,16 +41,190 @@ public:
 static int g_warmup_loop_count = 8;
 static int g_loop_count = 4;
 static bool g_enable_cooling_down = true;
+static int g_batch = 1;
+static bool g_report_load_time = false;
+static int g_concurrency = 1;
+
+// 0 = text only, 1 = also json to stdout, 2 = also csv to stdout
+static int g_output_format = 0;
 
 static ncnn::UnlockedPoolAllocator g_blob_pool_allocator;
 static ncnn::PoolAllocator g_workspace_pool_allocator;
 
+// parallel branch mode runs layers concurrently, the blob allocator has to lock
+static ncnn::PoolAllocator g_blob_locked_pool_allocator;
+
+// concurrent extractors share the pools
+static ncnn::BinnedPoolAllocator g_blob_shared_pool_allocator;
+static ncnn::BinnedPoolAllocator g_workspace_shared_pool_allocator;
+
+// result of one model for the machine readable output
+struct BenchResult
+{
+    char name[256];
+    double time_min;
+    double time_max;
+    double time_avg;
+    double time_p50;
+    double time_p90;
+    double time_p99;
+    double rps;
+    double peak_memory_mb;
+    double load_time;
+};
+
+static std::vector<BenchResult> g_results;
+
 #if NCNN_VULKAN
 static ncnn::VulkanDevice* g_vkdev = 0;
 static ncnn::VkAllocator* g_blob_vkallocator = 0;
 static ncnn::VkAllocator* g_staging_vkallocator = 0;
 #endif // NCNN_VULKAN
 
+static void forward_once(const ncnn::Net& net, const std::vector<ncnn::Mat>& _in)
+{
+    const std::vector<const char*>& input_names = net.input_names();
+    const std::vector<const char*>& output_names = net.output_names();
+
+    ncnn::Extractor ex = net.create_extractor();
+
+    if (g_batch > 1)
+    {
+        for (size_t j = 0; j < input_names.size(); ++j)
+        {
+            std::vector<ncnn::Mat> in(g_batch, _in[j]);
+            ex.input(input_names[j], in);
+        }
+
+        for (size_t j = 0; j < output_names.size(); ++j)
+        {
+            std::vector<ncnn::Mat> out;
+            ex.extract(output_names[j], out);
+        }
+
+        return;
+    }
+
+    for (size_t j = 0; j < input_names.size(); ++j)
+    {
+        ncnn::Mat in = _in[j];
+        ex.input(input_names[j], in);
+    }
+
+    for (size_t j = 0; j < output_names.size(); ++j)
+    {
+        ncnn::Mat out;
+        ex.extract(output_names[j], out);
+    }
+}
+
+#if NCNN_THREADS
+struct BenchWorkerArgs
+{
+    const ncnn::Net* net;
+    const std::vector<ncnn::Mat>* in;
+    int loop_count;
+
+    // time per sample of each loop, empty for warm up
+    std::vector<double>* times;
+};
+
+static void* bench_worker(void* args)
+{
+    BenchWorkerArgs* wa = (BenchWorkerArgs*)args;
+
+    for (int i = 0; i < wa->loop_count; i++)
+    {
+        double start = ncnn::get_current_time();
+
+        forward_once(*wa->net, *wa->in);
+
+        double end = ncnn::get_current_time();
+
+        if (wa->times)
+            wa->times->push_back((end - start) / g_batch);
+    }
+
+    return 0;
+}
+
+// run loop_count forwards in each of g_concurrency threads, the extractors share net
+static void run_concurrent(const ncnn::Net& net, const std::vector<ncnn::Mat>& _in, int loop_count, std::vector<std::vector<double> >* times)
+{
+    std::vector<BenchWorkerArgs> args(g_concurrency);
+    std::vector<ncnn::Thread*> threads(g_concurrency);
+    for (int i = 0; i < g_concurrency; i++)
+    {
+        args[i].net = &net;
+        args[i].in = &_in;
+        args[i].loop_count = loop_count;
+        args[i].times = times ? &(*times)[i] : 0;
+        threads[i] = new ncnn::Thread(bench_worker, (void*)&args[i]);
+    }
+
+    for (int i = 0; i < g_concurrency; i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+}
+#endif // NCNN_THREADS
+
+static void reset_peak_memory()
+{
+#if defined(__linux__)
+    // linux 4.0+ resets the peak resident set size
+    FILE* fp = fopen("/proc/self/clear_refs", "wb");
+    if (fp)
+    {
+        fputs("5", fp);
+        fclose(fp);
+    }
+#endif
+}
+
+// peak resident set size of the process in MB, -1 if unknown
+static double get_peak_memory()
+{
+#if defined(__linux__)
+    FILE* fp = fopen("/proc/self/status", "rb");
+    if (fp)
+    {
+        char line[256];
+        while (fgets(line, sizeof(line), fp))
+        {
+            long kb = 0;
+            if (sscanf(line, "VmHWM: %ld kB", &kb) == 1)
+            {
+                fclose(fp);
+                return kb / 1024.0;
+            }
+        }
+        fclose(fp);
+    }
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss / 1024.0;
+#elif defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss / 1024.0 / 1024.0;
+#endif
+
+    return -1.0;
+}
+
+// nearest rank percentile of sorted times, 0 for no times
+static double percentile(const std::vector<double>& sorted_times, int p)
+{
+    if (sorted_times.empty())
+        return 0.0;
+
+    int rank = ((int)sorted_times.size() * p + 99) / 100;
+    return sorted_times[std::max(rank, 1) - 1];
+}
+
 void benchmark(const char* comment, const std::vector<ncnn::Mat>& _in, const ncnn::Option& opt, bool fixed_path = true)
 {
     // Skip if int8 model name and using GPU
@@ -57,7 +236,12 @@ void benchmark(const char* comment, const std::vector<ncnn::Mat>& _in, const ncn
     }
 
     g_blob_pool_allocator.clear();
+    g_blob_locked_pool_allocator.clear();
     g_workspace_pool_allocator.clear();
+    g_blob_shared_pool_allocator.clear();
+    g_workspace_shared_pool_allocator.clear();
+
+    reset_peak_memory();
 
 #if NCNN_VULKAN
     if (opt.use_vulkan_compute)
@@ -84,6 +268,8 @@ void benchmark(const char* comment, const std::vector<ncnn::Mat>& _in, const ncn
 #define MODEL_DIR ""
 #endif
 
+    double load_start = ncnn::get_current_time();
+
     if (fixed_path)
     {
         char parampath[256];
@@ -98,8 +284,9 @@ void benchmark(const char* comment, const std::vector<ncnn::Mat>& _in, const ncn
     DataReaderFromEmpty dr;
     net.load_model(dr);
 
+    double load_time = ncnn::get_current_time() - load_start;
+
     const std::vector<const char*>& input_names = net.input_names();
-    const std::vector<const char*>& output_names = net.output_names();
 
     if (g_enable_cooling_down)
     {
@@ -120,20 +307,49 @@ void benchmark(const char* comment, const std::vector<ncnn::Mat>& _in, const ncn
         in.fill(0.01f);
     }
 
-    // warm up
-    for (int i = 0; i < g_warmup_loop_count; i++)
+    // time per sample
+    std::vector<double> times;
+    double wall_time = 0;
+
+#if NCNN_THREADS
+    if (g_concurrency > 1)
     {
-        ncnn::Extractor ex = net.create_extractor();
-        for (size_t j = 0; j < input_names.size(); ++j)
+        // warm up
+        run_concurrent(net, _in, g_warmup_loop_count, 0);
+
+        std::vector<std::vector<double> > thread_times(g_concurrency);
+
+        double start = ncnn::get_current_time();
+
+        run_concurrent(net, _in, g_loop_count, &thread_times);
+
+        wall_time = ncnn::get_current_time() - start;
+
+        for (int i = 0; i < g_concurrency; i++)
         {
-            ncnn::Mat in = _in[j];
-            ex.input(input_names[j], in);
+            times.insert(times.end(), thread_times[i].begin(), thread_times[i].end());
+        }
+    }
+    else
+#endif // NCNN_THREADS
+    {
+        // warm up
+        for (int i = 0; i < g_warmup_loop_count; i++)
+        {
+            forward_once(net, _in);
         }
 
-        for (size_t j = 0; j < output_names.size(); ++j)
+        for (int i = 0; i < g_loop_count; i++)
         {
-            ncnn::Mat out;
-            ex.extract(output_names[j], out);
+            double start = ncnn::get_current_time();
+
+            forward_once(net, _in);
+
+            double end = ncnn::get_current_time();
+
+            times.push_back((end - start) / g_batch);
+
+            wall_time += end - start;
         }
     }
 
@@ -141,36 +357,48 @@ void benchmark(const char* comment, const std::vector<ncnn::Mat>& _in, const ncn
     double time_max = -DBL_MAX;
     double time_avg = 0;
 
-    for (int i = 0; i < g_loop_count; i++)
+    for (size_t i = 0; i < times.size(); i++)
     {
-        double start = ncnn::get_current_time();
-        {
-            ncnn::Extractor ex = net.create_extractor();
-            for (size_t j = 0; j < input_names.size(); ++j)
-            {
-                ncnn::Mat in = _in[j];
-                ex.input(input_names[j], in);
-            }
-
-            for (size_t j = 0; j < output_names.size(); ++j)
-            {
-                ncnn::Mat out;
-                ex.extract(output_names[j], out);
-            }
-        }
-
-        double end = ncnn::get_current_time();
-
-        double time = end - start;
-
-        time_min = std::min(time_min, time);
-        time_max = std::max(time_max, time);
-        time_avg += time;
+        time_min = std::min(time_min, times[i]);
+        time_max = std::max(time_max, times[i]);
+        time_avg += times[i];
     }
 
-    time_avg /= g_loop_count;
+    if (times.empty())
+    {
+        // loop_count 0 runs no timed forward
+        time_min = 0;
+        time_max = 0;
+    }
+    else
+    {
+        time_avg /= times.size();
+    }
 
-    fprintf(stderr, "%20s  min = %7.2f  max = %7.2f  avg = %7.2f\n", comment, time_min, time_max, time_avg);
+    std::sort(times.begin(), times.end());
+
+    BenchResult r;
+    strncpy(r.name, comment, sizeof(r.name) - 1);
+    r.name[sizeof(r.name) - 1] = '\0';
+    r.time_min = time_min;
+    r.time_max = time_max;
+    r.time_avg = time_avg;
+    r.time_p50 = percentile(times, 50);
+    r.time_p90 = percentile(times, 90);
+    r.time_p99 = percentile(times, 99);
+    r.rps = wall_time > 0 ? times.size() * g_batch * 1000.0 / wall_time : 0;
+    r.peak_memory_mb = get_peak_memory();
+    r.load_time = load_time;
+    g_results.push_back(r);
+
+    if (g_report_load_time)
+    {
+        fprintf(stderr, "%20s  min = %7.2f  max = %7.2f  avg = %7.2f  p50 = %7.2f  p90 = %7.2f  p99 = %7.2f  rps = %8.2f  peak = %7.1fMB  load = %7.2f\n", comment, r.time_min, r.time_max, r.time_avg, r.time_p50, r.time_p90, r.time_p99, r.rps, r.peak_memory_mb, r.load_time);
+    }
+    else
+    {
+        fprintf(stderr, "%20s  min = %7.2f  max = %7.2f  avg = %7.2f  p50 = %7.2f  p90 = %7.2f  p99 = %7.2f  rps = %8.2f  peak = %7.1fMB\n", comment, r.time_min, r.time_max, r.time_avg, r.time_p50, r.time_p90, r.time_p99, r.rps, r.peak_memory_mb);
+    }
 }
 
 void benchmark(const char* comment, const ncnn::Mat& _in, const ncnn::Option& opt, bool fixed_path = true)
@@ -185,6 +413,59 @@ void show_usage()
     fprintf(stderr, "Usage: benchncnn [loop count] [num threads] [powersave] [gpu device] [cooling down] [(key=value)...]\n");
     fprintf(stderr, "  param=model.param\n");
     fprintf(stderr, "  shape=[227,227,3],...\n");
+    fprintf(stderr, "  branch=0/1\n");
+    fprintf(stderr, "  memplan=0/1\n");
+    fprintf(stderr, "  batch=1\n");
+    fprintf(stderr, "  plan=0/1\n");
+    fprintf(stderr, "  pipeline=0/1\n");
+    fprintf(stderr, "  load=0/1\n");
+    fprintf(stderr, "  concurrency=1\n");
+    fprintf(stderr, "  format=text/json/csv\n");
+}
+
+static void print_json_string(const char* s)
+{
+    putchar('"');
+    for (; *s; s++)
+    {
+        if (*s == '"' || *s == '\\')
+            putchar('\\');
+        putchar(*s);
+    }
+    putchar('"');
+}
+
+static void print_results_json(int loop_count, int num_threads, int powersave, int gpu_device, const ncnn::Option& opt)
+{
+    printf("{\n");
+    printf("  \"loop_count\": %d,\n", loop_count);
+    printf("  \"num_threads\": %d,\n", num_threads);
+    printf("  \"powersave\": %d,\n", powersave);
+    printf("  \"gpu_device\": %d,\n", gpu_device);
+    printf("  \"concurrency\": %d,\n", g_concurrency);
+    printf("  \"batch\": %d,\n", g_batch);
+    printf("  \"parallel_branch\": %d,\n", (int)opt.use_parallel_branch);
+    printf("  \"memory_planner\": %d,\n", (int)opt.use_memory_planner);
+    printf("  \"execution_plan\": %d,\n", (int)opt.use_execution_plan);
+    printf("  \"results\": [");
+    for (size_t i = 0; i < g_results.size(); i++)
+    {
+        const BenchResult& r = g_results[i];
+        printf(i == 0 ? "\n    {\"name\": " : ",\n    {\"name\": ");
+        print_json_string(r.name);
+        printf(", \"min\": %.3f, \"max\": %.3f, \"avg\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"rps\": %.3f, \"peak_memory_mb\": %.1f, \"load\": %.3f}", r.time_min, r.time_max, r.time_avg, r.time_p50, r.time_p90, r.time_p99, r.rps, r.peak_memory_mb, r.load_time);
+    }
+    printf("\n  ]\n}\n");
+}
+
+static void print_results_csv()
+{
+    printf("name,min,max,avg,p50,p90,p99,rps,peak_memory_mb,load\n");
+    for (size_t i = 0; i < g_results.size(); i++)
+    {
+        const BenchResult& r = g_results[i];
+        printf("%s,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f,%.3f\n", r.name, r.time_min, r.time_max, r.time_avg, r.time_p50, r.time_p90, r.time_p99, r.rps, r.peak_memory_mb, r.load_time);
+    }
 }
 
 static std::vector<ncnn::Mat> parse_shape_list(char* s)
@@ -256,6 +537,10 @@ int main(int argc, char** argv)
     int powersave = 2;
     int gpu_device = -1;
     int cooling_down = 1;
+    int parallel_branch = 0;
+    int memory_planner = 0;
+    int execution_plan = 0;
+    int parallel_create_pipeline = 0;
     char* model = 0;
     std::vector<ncnn::Mat> inputs;
 
@@ -316,8 +601,39 @@ int main(int argc, char** argv)
             model = value;
         if (strcmp(key, "shape") == 0)
             inputs = parse_shape_list(value);
+        if (strcmp(key, "branch") == 0)
+            parallel_branch = atoi(value);
+        if (strcmp(key, "memplan") == 0)
+            memory_planner = atoi(value);
+        if (strcmp(key, "batch") == 0)
+            g_batch = std::max(atoi(value), 1);
+        if (strcmp(key, "plan") == 0)
+            execution_plan = atoi(value);
+        if (strcmp(key, "pipeline") == 0)
+            parallel_create_pipeline = atoi(value);
+        if (strcmp(key, "load") == 0)
+            g_report_load_time = atoi(value) != 0;
+        if (strcmp(key, "concurrency") == 0)
+            g_concurrency = std::max(atoi(value), 1);
+        if (strcmp(key, "format") == 0)
+        {
+            if (strcmp(value, "json") == 0)
+                g_output_format = 1;
+            else if (strcmp(value, "csv") == 0)
+                g_output_format = 2;
+            else if (strcmp(value, "text") != 0)
+                fprintf(stderr, "unrecognized format %s\n", value);
+        }
     }
 
+#if !NCNN_THREADS
+    if (g_concurrency > 1)
+    {
+        fprintf(stderr, "concurrency needs NCNN_THREADS, fallback to 1\n");
+        g_concurrency = 1;
+    }
+#endif
+
     if (model && inputs.empty())
     {
         fprintf(stderr, "input tensor shape empty!\n");
@@ -332,12 +648,21 @@ int main(int argc, char** argv)
 
     bool use_vulkan_compute = gpu_device != -1;
 
+    if (use_vulkan_compute && g_concurrency > 1)
+    {
+        fprintf(stderr, "concurrency is cpu only, fallback to 1\n");
+        g_concurrency = 1;
+    }
+
     g_enable_cooling_down = cooling_down != 0;
 
     g_loop_count = loop_count;
 
     g_blob_pool_allocator.set_size_compare_ratio(0.f);
+    g_blob_locked_pool_allocator.set_size_compare_ratio(0.f);
     g_workspace_pool_allocator.set_size_compare_ratio(0.f);
+    g_blob_shared_pool_allocator.set_size_compare_ratio(0.f);
+    g_workspace_shared_pool_allocator.set_size_compare_ratio(0.f);
 
 #if NCNN_VULKAN
     if (use_vulkan_compute)
@@ -360,8 +685,14 @@ int main(int argc, char** argv)
     ncnn::Option opt;
     opt.lightmode = true;
     opt.num_threads = num_threads;
-    opt.blob_allocator = &g_blob_pool_allocator;
+    opt.blob_allocator = parallel_branch ? (ncnn::Allocator*)&g_blob_locked_pool_allocator : (ncnn::Allocator*)&g_blob_pool_allocator;
     opt.workspace_allocator = &g_workspace_pool_allocator;
+    if (g_concurrency > 1)
+    {
+        // each thread runs its own extractor on the shared net, num_threads is per extractor
+        opt.blob_allocator = &g_blob_shared_pool_allocator;
+        opt.workspace_allocator = &g_workspace_shared_pool_allocator;
+    }
 #if NCNN_VULKAN
     opt.blob_vkallocator = g_blob_vkallocator;
     opt.workspace_vkallocator = g_blob_vkallocator;
@@ -378,12 +709,22 @@ int main(int argc, char** argv)
     opt.use_int8_arithmetic = true;
     opt.use_packing_layout = true;
     opt.use_shader_pack8 = false;
+    opt.use_parallel_branch = parallel_branch != 0;
+    opt.use_memory_planner = memory_planner != 0;
+    opt.use_execution_plan = execution_plan != 0;
+    opt.use_parallel_create_pipeline = parallel_create_pipeline != 0;
 
     fprintf(stderr, "loop_count = %d\n", g_loop_count);
     fprintf(stderr, "num_threads = %d\n", num_threads);
     fprintf(stderr, "powersave = %d\n", ncnn::get_cpu_powersave());
     fprintf(stderr, "gpu_device = %d\n", gpu_device);
     fprintf(stderr, "cooling_down = %d\n", (int)g_enable_cooling_down);
+    fprintf(stderr, "parallel_branch = %d\n", (int)opt.use_parallel_branch);
+    fprintf(stderr, "memory_planner = %d\n", (int)opt.use_memory_planner);
+    fprintf(stderr, "batch = %d\n", g_batch);
+    fprintf(stderr, "execution_plan = %d\n", (int)opt.use_execution_plan);
+    fprintf(stderr, "parallel_create_pipeline = %d\n", (int)opt.use_parallel_create_pipeline);
+    fprintf(stderr, "concurrency = %d\n", g_concurrency);
 
     if (model != 0)
     {
@@ -465,6 +806,16 @@ int main(int argc, char** argv)
 
         benchmark("FastestDet", ncnn::Mat(352, 352, 3), opt);
     }
+
+    if (g_output_format == 1)
+    {
+        print_results_json(loop_count, num_threads, ncnn::get_cpu_powersave(), gpu_device, opt);
+    }
+    if (g_output_format == 2)
+    {
+        print_results_csv();
+    }
+
 #if NCNN_VULKAN
     delete g_blob_vkallocator;
     delete g_staging_vkallocator;
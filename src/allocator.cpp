@@ -346,6 +346,490 @@ void UnlockedPoolAllocator::fastFree(void* ptr)
     ncnn::fastFree(ptr);
 }
 
+// each power of two is split into 4 size classes
+#define NCNN_POOL_BIN_COUNT 256
+
+// threads are striped over the caches, each cache holds a few recent budgets
+// a cache is guarded by its own mutex, contended only by threads striped onto the same cache
+#define NCNN_POOL_CACHE_COUNT 16
+#define NCNN_POOL_CACHE_SIZE 4
+
+// payouts start after a header holding their size
+// the header takes a whole alignment unit so the payouts stay aligned
+#define NCNN_POOL_HEADER_SIZE NCNN_MALLOC_ALIGN
+#define NCNN_POOL_MAGIC ((size_t)0x6e636e6e)
+
+static int pool_size_class(size_t size)
+{
+    if (size < 4)
+        return (int)size;
+
+    int msb = 0;
+    for (size_t s = size >> 1; s; s >>= 1)
+        msb++;
+
+    return msb * 4 + (int)((size >> (msb - 2)) & 3);
+}
+
+// the smallest size of size class c
+static size_t pool_size_class_lower(int c)
+{
+    if (c < 8)
+        return c < 4 ? (size_t)c : 4;
+
+    return (size_t)(4 + c % 4) << (c / 4 - 2);
+}
+
+static ThreadLocalStorage tls_pool_cache_index;
+static int g_pool_thread_count = 0;
+
+static int get_pool_cache_index()
+{
+    // stored plus one, zero means unassigned
+    size_t index = (size_t)tls_pool_cache_index.get();
+    if (index == 0)
+    {
+        index = (size_t)(NCNN_XADD(&g_pool_thread_count, 1) % NCNN_POOL_CACHE_COUNT) + 1;
+        tls_pool_cache_index.set((void*)index);
+    }
+
+    return (int)index - 1;
+}
+
+static void pool_free_budget(void* ptr)
+{
+    ncnn::fastFree((unsigned char*)ptr - NCNN_POOL_HEADER_SIZE);
+}
+
+struct BinnedPoolCache
+{
+    Mutex lock;
+    int count;
+    // oldest first
+    size_t sizes[NCNN_POOL_CACHE_SIZE];
+    void* ptrs[NCNN_POOL_CACHE_SIZE];
+};
+
+class BinnedPoolAllocatorPrivate
+{
+public:
+    bool fits(size_t bs, size_t size) const
+    {
+        // size_compare_ratio ~ 100%
+        return bs >= size && ((bs * size_compare_ratio) >> 8) <= size;
+    }
+
+    void* cache_take(BinnedPoolCache& cache, size_t size);
+    void caches_drain();
+
+    // the following require bins_lock
+    int first_bin(int c) const;
+    int last_bin() const;
+    void* bins_take(size_t size);
+    void bins_put(size_t bs, void* ptr);
+    void bins_erase(int c, size_t i);
+    void bins_drop(size_t size);
+
+public:
+    unsigned int size_compare_ratio; // 0~256
+    size_t size_drop_threshold;
+    int payout_count;
+
+    BinnedPoolCache caches[NCNN_POOL_CACHE_COUNT];
+
+    Mutex bins_lock;
+    size_t budget_count;
+    unsigned int bin_mask[NCNN_POOL_BIN_COUNT / 32];
+    std::vector<std::pair<size_t, void*> > bins[NCNN_POOL_BIN_COUNT];
+};
+
+void* BinnedPoolAllocatorPrivate::cache_take(BinnedPoolCache& cache, size_t size)
+{
+    int best = -1;
+    for (int i = 0; i < cache.count; i++)
+    {
+        if (fits(cache.sizes[i], size) && (best == -1 || cache.sizes[i] < cache.sizes[best]))
+            best = i;
+    }
+
+    if (best == -1)
+        return 0;
+
+    void* ptr = cache.ptrs[best];
+
+    for (int i = best; i + 1 < cache.count; i++)
+    {
+        cache.sizes[i] = cache.sizes[i + 1];
+        cache.ptrs[i] = cache.ptrs[i + 1];
+    }
+    cache.count--;
+
+    return ptr;
+}
+
+void BinnedPoolAllocatorPrivate::caches_drain()
+{
+    for (int i = 0; i < NCNN_POOL_CACHE_COUNT; i++)
+    {
+        BinnedPoolCache& cache = caches[i];
+
+        size_t sizes[NCNN_POOL_CACHE_SIZE];
+        void* ptrs[NCNN_POOL_CACHE_SIZE];
+
+        cache.lock.lock();
+        const int count = cache.count;
+        for (int j = 0; j < count; j++)
+        {
+            sizes[j] = cache.sizes[j];
+            ptrs[j] = cache.ptrs[j];
+        }
+        cache.count = 0;
+        cache.lock.unlock();
+
+        if (count == 0)
+            continue;
+
+        bins_lock.lock();
+        for (int j = 0; j < count; j++)
+        {
+            bins_put(sizes[j], ptrs[j]);
+        }
+        bins_lock.unlock();
+    }
+}
+
+int BinnedPoolAllocatorPrivate::first_bin(int c) const
+{
+    while (c < NCNN_POOL_BIN_COUNT)
+    {
+        unsigned int bits = bin_mask[c / 32] >> (c % 32);
+        if (bits)
+        {
+            while (!(bits & 1))
+            {
+                bits >>= 1;
+                c++;
+            }
+            return c;
+        }
+
+        c = (c / 32 + 1) * 32;
+    }
+
+    return NCNN_POOL_BIN_COUNT;
+}
+
+int BinnedPoolAllocatorPrivate::last_bin() const
+{
+    for (int c = NCNN_POOL_BIN_COUNT - 1; c >= 0; c--)
+    {
+        if (bin_mask[c / 32] & (1u << (c % 32)))
+            return c;
+    }
+
+    return -1;
+}
+
+void* BinnedPoolAllocatorPrivate::bins_take(size_t size)
+{
+    const int c0 = pool_size_class(size);
+
+    for (int c = first_bin(c0); c < NCNN_POOL_BIN_COUNT; c = first_bin(c + 1))
+    {
+        // budgets in later bins are even larger
+        if (c > c0 && ((pool_size_class_lower(c) * size_compare_ratio) >> 8) > size)
+            break;
+
+        // pick the smallest budget that fits, the bin of size may also hold smaller ones
+        const std::vector<std::pair<size_t, void*> >& bin = bins[c];
+
+        int best = -1;
+        for (size_t i = 0; i < bin.size(); i++)
+        {
+            if (fits(bin[i].first, size) && (best == -1 || bin[i].first < bin[best].first))
+                best = (int)i;
+        }
+
+        if (best != -1)
+        {
+            void* ptr = bin[best].second;
+            bins_erase(c, best);
+            return ptr;
+        }
+    }
+
+    return 0;
+}
+
+void BinnedPoolAllocatorPrivate::bins_put(size_t bs, void* ptr)
+{
+    const int c = pool_size_class(bs);
+
+    bins[c].push_back(std::make_pair(bs, ptr));
+    bin_mask[c / 32] |= 1u << (c % 32);
+    budget_count++;
+}
+
+void BinnedPoolAllocatorPrivate::bins_erase(int c, size_t i)
+{
+    std::vector<std::pair<size_t, void*> >& bin = bins[c];
+
+    bin[i] = bin.back();
+    bin.pop_back();
+    if (bin.empty())
+        bin_mask[c / 32] &= ~(1u << (c % 32));
+    budget_count--;
+}
+
+void BinnedPoolAllocatorPrivate::bins_drop(size_t size)
+{
+    if (budget_count == 0 || budget_count < size_drop_threshold)
+        return;
+
+    const int cmin = first_bin(0);
+    const int cmax = last_bin();
+
+    size_t imin = 0;
+    for (size_t i = 1; i < bins[cmin].size(); i++)
+    {
+        if (bins[cmin][i].first < bins[cmin][imin].first)
+            imin = i;
+    }
+
+    size_t imax = 0;
+    for (size_t i = 1; i < bins[cmax].size(); i++)
+    {
+        if (bins[cmax][i].first > bins[cmax][imax].first)
+            imax = i;
+    }
+
+    // All chunks in pool are not chosen. Then try to drop some outdated
+    // chunks and return them to OS.
+    if (bins[cmax][imax].first < size)
+    {
+        // Current query is asking for a chunk larger than any cached chunks.
+        // Then remove the smallest one.
+        pool_free_budget(bins[cmin][imin].second);
+        bins_erase(cmin, imin);
+    }
+    else if (bins[cmin][imin].first > size)
+    {
+        // Current query is asking for a chunk smaller than any cached chunks.
+        // Then remove the largest one.
+        pool_free_budget(bins[cmax][imax].second);
+        bins_erase(cmax, imax);
+    }
+}
+
+BinnedPoolAllocator::BinnedPoolAllocator()
+    : Allocator(), d(new BinnedPoolAllocatorPrivate)
+{
+    d->size_compare_ratio = 0;
+    d->size_drop_threshold = 10;
+    d->payout_count = 0;
+
+    for (int i = 0; i < NCNN_POOL_CACHE_COUNT; i++)
+    {
+        d->caches[i].count = 0;
+    }
+
+    d->budget_count = 0;
+    for (int i = 0; i < NCNN_POOL_BIN_COUNT / 32; i++)
+    {
+        d->bin_mask[i] = 0;
+    }
+}
+
+BinnedPoolAllocator::~BinnedPoolAllocator()
+{
+    clear();
+
+    if (d->payout_count != 0)
+    {
+        NCNN_LOGE("FATAL ERROR! binned pool allocator destroyed too early");
+        NCNN_LOGE("%d buffers still in use", d->payout_count);
+    }
+
+    delete d;
+}
+
+BinnedPoolAllocator::BinnedPoolAllocator(const BinnedPoolAllocator&)
+    : d(0)
+{
+}
+
+BinnedPoolAllocator& BinnedPoolAllocator::operator=(const BinnedPoolAllocator&)
+{
+    return *this;
+}
+
+void BinnedPoolAllocator::clear()
+{
+    for (int i = 0; i < NCNN_POOL_CACHE_COUNT; i++)
+    {
+        BinnedPoolCache& cache = d->caches[i];
+
+        cache.lock.lock();
+
+        for (int j = 0; j < cache.count; j++)
+        {
+            pool_free_budget(cache.ptrs[j]);
+        }
+        cache.count = 0;
+
+        cache.lock.unlock();
+    }
+
+    d->bins_lock.lock();
+
+    for (int c = 0; c < NCNN_POOL_BIN_COUNT; c++)
+    {
+        for (size_t i = 0; i < d->bins[c].size(); i++)
+        {
+            pool_free_budget(d->bins[c][i].second);
+        }
+        d->bins[c].clear();
+    }
+    for (int i = 0; i < NCNN_POOL_BIN_COUNT / 32; i++)
+    {
+        d->bin_mask[i] = 0;
+    }
+    d->budget_count = 0;
+
+    d->bins_lock.unlock();
+}
+
+void BinnedPoolAllocator::set_size_compare_ratio(float scr)
+{
+    if (scr < 0.f || scr > 1.f)
+    {
+        NCNN_LOGE("invalid size compare ratio %f", scr);
+        return;
+    }
+
+    d->size_compare_ratio = (unsigned int)(scr * 256);
+}
+
+void BinnedPoolAllocator::set_size_drop_threshold(size_t threshold)
+{
+    d->size_drop_threshold = threshold;
+}
+
+void* BinnedPoolAllocator::fastMalloc(size_t size)
+{
+    const int cache_index = get_pool_cache_index();
+
+    // find free budget in the cache of this thread
+    {
+        BinnedPoolCache& cache = d->caches[cache_index];
+
+        cache.lock.lock();
+        void* ptr = d->cache_take(cache, size);
+        cache.lock.unlock();
+
+        if (ptr)
+        {
+            NCNN_XADD(&d->payout_count, 1);
+            return ptr;
+        }
+    }
+
+    // find free budget in the shared bins
+    {
+        d->bins_lock.lock();
+        void* ptr = d->bins_take(size);
+        d->bins_lock.unlock();
+
+        if (ptr)
+        {
+            NCNN_XADD(&d->payout_count, 1);
+            return ptr;
+        }
+    }
+
+    // move the budgets of every cache to the shared bins
+    // so the drop threshold counts all free budgets, as in PoolAllocator
+    d->caches_drain();
+
+    {
+        d->bins_lock.lock();
+        void* ptr = d->bins_take(size);
+        if (!ptr)
+            d->bins_drop(size);
+        d->bins_lock.unlock();
+
+        if (ptr)
+        {
+            NCNN_XADD(&d->payout_count, 1);
+            return ptr;
+        }
+    }
+
+    // new
+    unsigned char* base = (unsigned char*)ncnn::fastMalloc(size + NCNN_POOL_HEADER_SIZE);
+    if (!base)
+        return 0;
+
+    unsigned char* ptr = base + NCNN_POOL_HEADER_SIZE;
+
+    size_t* header = (size_t*)ptr - 2;
+    header[0] = size;
+    header[1] = NCNN_POOL_MAGIC ^ size;
+
+    NCNN_XADD(&d->payout_count, 1);
+
+    return ptr;
+}
+
+void BinnedPoolAllocator::fastFree(void* ptr)
+{
+    const size_t* header = (const size_t*)ptr - 2;
+    const size_t bs = header[0];
+    if (header[1] != (NCNN_POOL_MAGIC ^ bs))
+    {
+        NCNN_LOGE("FATAL ERROR! binned pool allocator get wild %p", ptr);
+        ncnn::fastFree(ptr);
+        return;
+    }
+
+    NCNN_XADD(&d->payout_count, -1);
+
+    // return to the cache of this thread
+    BinnedPoolCache& cache = d->caches[get_pool_cache_index()];
+
+    void* evicted_ptr = 0;
+    size_t evicted_size = 0;
+
+    cache.lock.lock();
+
+    if (cache.count == NCNN_POOL_CACHE_SIZE)
+    {
+        // the oldest budget moves on to the shared bins
+        evicted_size = cache.sizes[0];
+        evicted_ptr = cache.ptrs[0];
+
+        for (int i = 0; i + 1 < cache.count; i++)
+        {
+            cache.sizes[i] = cache.sizes[i + 1];
+            cache.ptrs[i] = cache.ptrs[i + 1];
+        }
+        cache.count--;
+    }
+
+    cache.sizes[cache.count] = bs;
+    cache.ptrs[cache.count] = ptr;
+    cache.count++;
+
+    cache.lock.unlock();
+
+    if (evicted_ptr)
+    {
+        d->bins_lock.lock();
+        d->bins_put(evicted_size, evicted_ptr);
+        d->bins_lock.unlock();
+    }
+}
+
 #if NCNN_VULKAN
 VkAllocator::VkAllocator(const VulkanDevice* _vkdev)
     : vkdev(_vkdev)
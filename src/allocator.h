@@ -205,6 +205,43 @@ private:
     UnlockedPoolAllocatorPrivate* const d;
 };
 
+// thread-safe pool allocator for many threads sharing one pool
+// budgets are kept in size class bins instead of one list
+// the size of each payout is stored in front of the buffer so fastFree does not search
+// each thread returns and reuses recent budgets through its own small cache
+// and only takes the shared bins lock when the cache misses
+// the caches are not lock-free, each one is guarded by a mutex
+// that is only contended when two threads striped onto the same cache use the pool at once
+// a miss moves the budgets of all caches to the bins before the drop threshold is applied
+class BinnedPoolAllocatorPrivate;
+class NCNN_EXPORT BinnedPoolAllocator : public Allocator
+{
+public:
+    BinnedPoolAllocator();
+    ~BinnedPoolAllocator();
+
+    // ratio range 0 ~ 1
+    // default cr = 0
+    void set_size_compare_ratio(float scr);
+
+    // budget drop threshold
+    // default threshold = 10
+    void set_size_drop_threshold(size_t);
+
+    // release all budgets immediately
+    void clear();
+
+    virtual void* fastMalloc(size_t size);
+    virtual void fastFree(void* ptr);
+
+private:
+    BinnedPoolAllocator(const BinnedPoolAllocator&);
+    BinnedPoolAllocator& operator=(const BinnedPoolAllocator&);
+
+private:
+    BinnedPoolAllocatorPrivate* const d;
+};
+
 #if NCNN_VULKAN
 
 class VulkanDevice;
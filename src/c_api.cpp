@@ -1296,6 +1296,11 @@ int ncnn_net_load_model(ncnn_net_t net, const char* path)
 {
     return ((Net*)net->pthis)->load_model(path);
 }
+
+int ncnn_net_load_model_mmap(ncnn_net_t net, const char* path)
+{
+    return ((Net*)net->pthis)->load_model_mmap(path);
+}
 #endif /* NCNN_STDIO */
 
 #if NCNN_STDIO
@@ -1390,6 +1395,16 @@ void ncnn_extractor_set_option(ncnn_extractor_t ex, const ncnn_option_t opt)
 #endif
 }
 
+void ncnn_extractor_set_streaming(ncnn_extractor_t ex, int enable)
+{
+    ((Extractor*)ex)->set_streaming(enable);
+}
+
+void ncnn_extractor_reset_stream(ncnn_extractor_t ex)
+{
+    ((Extractor*)ex)->reset_stream();
+}
+
 #if NCNN_STRING
 int ncnn_extractor_input(ncnn_extractor_t ex, const char* name, const ncnn_mat_t mat)
 {
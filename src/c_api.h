@@ -277,6 +277,7 @@ NCNN_EXPORT int ncnn_net_load_param(ncnn_net_t net, const char* path);
 #endif /* NCNN_STRING */
 NCNN_EXPORT int ncnn_net_load_param_bin(ncnn_net_t net, const char* path);
 NCNN_EXPORT int ncnn_net_load_model(ncnn_net_t net, const char* path);
+NCNN_EXPORT int ncnn_net_load_model_mmap(ncnn_net_t net, const char* path);
 #endif /* NCNN_STDIO */
 
 #if NCNN_STDIO
@@ -312,6 +313,9 @@ NCNN_EXPORT void ncnn_extractor_destroy(ncnn_extractor_t ex);
 
 NCNN_EXPORT void ncnn_extractor_set_option(ncnn_extractor_t ex, const ncnn_option_t opt);
 
+NCNN_EXPORT void ncnn_extractor_set_streaming(ncnn_extractor_t ex, int enable);
+NCNN_EXPORT void ncnn_extractor_reset_stream(ncnn_extractor_t ex);
+
 #if NCNN_STRING
 NCNN_EXPORT int ncnn_extractor_input(ncnn_extractor_t ex, const char* name, const ncnn_mat_t mat);
 NCNN_EXPORT int ncnn_extractor_extract(ncnn_extractor_t ex, const char* name, ncnn_mat_t* mat);
@@ -3,8 +3,22 @@
 
 #include "datareader.h"
 
+#include "allocator.h"
+
 #include <string.h>
 
+#if NCNN_STDIO
+#if defined _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined __unix__ || defined __APPLE__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#endif // NCNN_STDIO
+
 namespace ncnn {
 
 DataReader::DataReader()
@@ -74,6 +88,170 @@ size_t DataReaderFromStdio::read(void* buf, size_t size) const
 {
     return fread(buf, 1, size, d->fp);
 }
+
+class DataReaderFromMmapPrivate
+{
+public:
+    DataReaderFromMmapPrivate()
+        : data(0), size(0), offset(0)
+    {
+#if defined _WIN32
+        mapping = 0;
+#endif
+    }
+
+    const unsigned char* data;
+    size_t size;
+    mutable size_t offset;
+
+#if defined _WIN32
+    HANDLE mapping;
+#endif
+};
+
+DataReaderFromMmap::DataReaderFromMmap(const char* filepath)
+    : DataReader(), d(new DataReaderFromMmapPrivate)
+{
+#if defined _WIN32
+    HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        NCNN_LOGE("CreateFile %s failed", filepath);
+        return;
+    }
+
+    LARGE_INTEGER filesize;
+    if (!GetFileSizeEx(file, &filesize) || filesize.QuadPart == 0)
+    {
+        NCNN_LOGE("GetFileSizeEx %s failed", filepath);
+        CloseHandle(file);
+        return;
+    }
+
+    d->mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!d->mapping)
+    {
+        NCNN_LOGE("CreateFileMapping %s failed", filepath);
+        return;
+    }
+
+    d->data = (const unsigned char*)MapViewOfFile(d->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!d->data)
+    {
+        NCNN_LOGE("MapViewOfFile %s failed", filepath);
+        CloseHandle(d->mapping);
+        d->mapping = 0;
+        return;
+    }
+
+    d->size = (size_t)filesize.QuadPart;
+#elif defined __unix__ || defined __APPLE__
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0)
+    {
+        NCNN_LOGE("open %s failed", filepath);
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        NCNN_LOGE("fstat %s failed", filepath);
+        close(fd);
+        return;
+    }
+
+    void* ptr = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED)
+    {
+        NCNN_LOGE("mmap %s failed", filepath);
+        return;
+    }
+
+    d->data = (const unsigned char*)ptr;
+    d->size = (size_t)st.st_size;
+#else
+    // no mmap on this platform, read the whole file instead
+    FILE* fp = fopen(filepath, "rb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", filepath);
+        return;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long filesize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    unsigned char* buf = filesize > 0 ? (unsigned char*)fastMalloc((size_t)filesize) : 0;
+    if (!buf || fread(buf, 1, (size_t)filesize, fp) != (size_t)filesize)
+    {
+        NCNN_LOGE("fread %s failed", filepath);
+        if (buf)
+            fastFree(buf);
+        fclose(fp);
+        return;
+    }
+    fclose(fp);
+
+    d->data = buf;
+    d->size = (size_t)filesize;
+#endif
+}
+
+DataReaderFromMmap::~DataReaderFromMmap()
+{
+    if (d->data)
+    {
+#if defined _WIN32
+        UnmapViewOfFile(d->data);
+        CloseHandle(d->mapping);
+#elif defined __unix__ || defined __APPLE__
+        munmap((void*)d->data, d->size);
+#else
+        fastFree((void*)d->data);
+#endif
+    }
+
+    delete d;
+}
+
+DataReaderFromMmap::DataReaderFromMmap(const DataReaderFromMmap&)
+    : d(0)
+{
+}
+
+DataReaderFromMmap& DataReaderFromMmap::operator=(const DataReaderFromMmap&)
+{
+    return *this;
+}
+
+bool DataReaderFromMmap::empty() const
+{
+    return d->data == 0;
+}
+
+size_t DataReaderFromMmap::read(void* buf, size_t size) const
+{
+    if (size > d->size - d->offset)
+        size = d->size - d->offset;
+
+    memcpy(buf, d->data + d->offset, size);
+    d->offset += size;
+    return size;
+}
+
+size_t DataReaderFromMmap::reference(size_t size, const void** buf) const
+{
+    if (size > d->size - d->offset)
+        return 0;
+
+    *buf = d->data + d->offset;
+    d->offset += size;
+    return size;
+}
 #endif // NCNN_STDIO
 
 class DataReaderFromMemoryPrivate
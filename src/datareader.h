@@ -59,6 +59,31 @@ private:
 private:
     DataReaderFromStdioPrivate* const d;
 };
+
+class DataReaderFromMmapPrivate;
+// map the whole file read-only
+// model data is referenced from the mapping instead of copied
+// so the pages are shared with all processes mapping the same file
+// the mapping should be retained as long as the referenced data is used
+class NCNN_EXPORT DataReaderFromMmap : public DataReader
+{
+public:
+    explicit DataReaderFromMmap(const char* filepath);
+    virtual ~DataReaderFromMmap();
+
+    // return true if the file was not mapped
+    bool empty() const;
+
+    virtual size_t read(void* buf, size_t size) const;
+    virtual size_t reference(size_t size, const void** buf) const;
+
+private:
+    DataReaderFromMmap(const DataReaderFromMmap&);
+    DataReaderFromMmap& operator=(const DataReaderFromMmap&);
+
+private:
+    DataReaderFromMmapPrivate* const d;
+};
 #endif // NCNN_STDIO
 
 class DataReaderFromMemoryPrivate;
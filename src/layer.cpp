@@ -26,6 +26,9 @@ Layer::Layer()
     support_reserved_000 = false;
     support_reserved_00 = false;
 
+    support_batch_stacking = false;
+    support_batch_depth_stacking = false;
+
     featmask = 0;
 
 #if NCNN_VULKAN
@@ -238,6 +241,8 @@ public:
         support_bf16_storage = layer_cpu->support_bf16_storage;
         support_fp16_storage = layer_cpu->support_fp16_storage;
         support_int8_storage = layer_cpu->support_int8_storage;
+        support_batch_stacking = layer_cpu->support_batch_stacking;
+        support_batch_depth_stacking = layer_cpu->support_batch_depth_stacking;
 
         support_vulkan = 0;
         support_tensor_storage = 0;
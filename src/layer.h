@@ -70,8 +70,13 @@ public:
 
     bool support_reserved_00;
 
-    bool support_reserved_0;
-    bool support_reserved_1;
+    // rows of a 2-dim blob are independent samples
+    // blobs of several batch samples can be stacked along rows and forwarded at once
+    bool support_batch_stacking;
+
+    // 3-dim blobs of several batch samples can be stacked along depth into one 4-dim blob and forwarded at once
+    bool support_batch_depth_stacking;
+
     bool support_reserved_2;
     bool support_reserved_3;
     bool support_reserved_4;
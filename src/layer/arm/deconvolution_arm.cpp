@@ -41,6 +41,17 @@ int Deconvolution_arm::create_pipeline(const Option& opt)
     if (dynamic_weight)
         return 0;
 
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        // TODO implement int8, forward runs the reference int8 path on unpacked fp32 blobs
+        support_packing = false;
+        support_fp16_storage = false;
+        support_bf16_storage = false;
+        return 0;
+    }
+#endif
+
     activation = create_activation_layer(activation_type, activation_params, opt);
 
 #if NCNN_ARM82
@@ -227,6 +238,13 @@ int Deconvolution_arm::destroy_pipeline(const Option& opt)
 
 int Deconvolution_arm::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+#if NCNN_INT8
+    if (opt.use_int8_inference && int8_scale_term)
+    {
+        return Deconvolution::forward_int8(bottom_blob, top_blob, opt);
+    }
+#endif
+
     int elembits = bottom_blob.elembits();
 
 #if NCNN_ARM82
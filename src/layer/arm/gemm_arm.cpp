@@ -11,6 +11,7 @@
 #include "arm_usability.h"
 
 #include "cpu.h"
+#include "weight_quant.h"
 
 namespace ncnn {
 
@@ -4235,6 +4236,37 @@ static int gemm_AT_BT_arm(const Mat& AT, const Mat& BT, const Mat& C, Mat& top_b
 
 int Gemm_arm::create_pipeline(const Option& opt)
 {
+    if (weight_quant_bits)
+    {
+        // expand the weight-only quantized constant A or B to float32
+        Option opt_dequant = opt;
+        opt_dequant.blob_allocator = 0;
+
+        if (constantA)
+        {
+            Mat A_data_fp32;
+            dequantize_weight_quant(A_data, A_data_quant_scales, A_data_fp32, constantK, weight_quant_bits, weight_quant_group_size, opt_dequant);
+            if (A_data_fp32.empty())
+                return -100;
+
+            A_data = A_data_fp32;
+        }
+
+        if (constantB)
+        {
+            Mat B_data_fp32;
+            dequantize_weight_quant(B_data, B_data_quant_scales, B_data_fp32, constantK, weight_quant_bits, weight_quant_group_size, opt_dequant);
+            if (B_data_fp32.empty())
+                return -100;
+
+            B_data = B_data_fp32;
+        }
+
+        A_data_quant_scales.release();
+        B_data_quant_scales.release();
+        weight_quant_bits = 0;
+    }
+
 #if NCNN_INT8
     if (int8_scale_term)
     {
@@ -4556,7 +4588,7 @@ int Gemm_arm::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& to
         return -100;
 
     int _nT = nT ? nT : opt.num_threads;
-    if (nT != 0 && opt.num_threads != nT)
+    if (nT != 0 && opt.num_threads != nT && !opt.use_parallel_branch)
     {
         // force num_threads the same as in create_pipeline
         // so we could use pre-packed A/B from the same tile config
@@ -5251,7 +5283,7 @@ int Gemm_arm::forward_bf16s(const std::vector<Mat>& bottom_blobs, std::vector<Ma
         return -100;
 
     int _nT = nT ? nT : opt.num_threads;
-    if (nT != 0 && opt.num_threads != nT)
+    if (nT != 0 && opt.num_threads != nT && !opt.use_parallel_branch)
     {
         // force num_threads the same as in create_pipeline
         // so we could use pre-packed A/B from the same tile config
@@ -6241,7 +6273,7 @@ int Gemm_arm::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat
         return -100;
 
     int _nT = nT ? nT : opt.num_threads;
-    if (nT != 0 && opt.num_threads != nT)
+    if (nT != 0 && opt.num_threads != nT && !opt.use_parallel_branch)
     {
         // force num_threads the same as in create_pipeline
         // so we could use pre-packed A/B from the same tile config
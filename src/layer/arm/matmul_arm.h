@@ -18,6 +18,10 @@ public:
 
     virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 
+protected:
+    // gemm->forward with B quantized per output column in int8 mode
+    int forward_gemm(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
 public:
     Layer* gemm;
 };
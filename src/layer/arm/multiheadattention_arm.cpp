@@ -300,12 +300,59 @@ int MultiHeadAttention_arm::destroy_pipeline(const Option& _opt)
     return 0;
 }
 
+// append the projected keys or values of the new tokens to the cache along w
+static int concat_kv_cache(const Mat& cached_blob, const Mat& affine, Mat& top_blob, const Option& opt)
+{
+    if (cached_blob.empty())
+    {
+        top_blob = affine;
+        return 0;
+    }
+
+    Mat cached_blob_unpacked = cached_blob;
+    if (cached_blob.elempack != 1)
+    {
+        convert_packing(cached_blob, cached_blob_unpacked, 1, opt);
+        if (cached_blob_unpacked.empty())
+            return -100;
+    }
+
+    if (cached_blob_unpacked.h != affine.h || cached_blob_unpacked.elemsize != affine.elemsize)
+    {
+        NCNN_LOGE("kv cache shape %d x %d does not match %d x %d", cached_blob_unpacked.w, cached_blob_unpacked.h, affine.w, affine.h);
+        return -1;
+    }
+
+    const int past_seqlen = cached_blob_unpacked.w;
+    const int cur_seqlen = affine.w;
+    const size_t elemsize = affine.elemsize;
+
+    top_blob.create(past_seqlen + cur_seqlen, affine.h, elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < affine.h; i++)
+    {
+        unsigned char* outptr = top_blob.row<unsigned char>(i);
+        memcpy(outptr, cached_blob_unpacked.row<const unsigned char>(i), past_seqlen * elemsize);
+        memcpy(outptr + past_seqlen * elemsize, affine.row<const unsigned char>(i), cur_seqlen * elemsize);
+    }
+
+    return 0;
+}
+
 int MultiHeadAttention_arm::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& _opt) const
 {
+    const bool use_kv_cache = kv_cache && top_blobs.size() == 3;
+    const size_t input_blob_count = use_kv_cache ? bottom_blobs.size() - 2 : bottom_blobs.size();
+
     const Mat& q_blob = bottom_blobs[0];
-    const Mat& k_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
-    const Mat& v_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : (bottom_blobs.size() == 2 || (bottom_blobs.size() == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
-    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blobs.size() - 1] : Mat();
+    const Mat& k_blob = (input_blob_count == 1 || (input_blob_count == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
+    const Mat& v_blob = (input_blob_count == 1 || (input_blob_count == 2 && attn_mask)) ? q_blob : (input_blob_count == 2 || (input_blob_count == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
+    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[input_blob_count - 1] : Mat();
+    const Mat& cached_k_blob = use_kv_cache ? bottom_blobs[input_blob_count] : Mat();
+    const Mat& cached_v_blob = use_kv_cache ? bottom_blobs[input_blob_count + 1] : Mat();
 
     Option opt = _opt;
     opt.use_fp16_storage &= support_fp16_storage;
@@ -325,7 +372,6 @@ int MultiHeadAttention_arm::forward(const std::vector<Mat>& bottom_blobs, std::v
 
     const int embed_dim_per_head = embed_dim / num_heads;
     const int src_seqlen = q_blob.h * q_blob.elempack;
-    const int dst_seqlen = k_blob.h * k_blob.elempack;
 
     // const int elembits = q_blob.elembits();
 
@@ -341,6 +387,17 @@ int MultiHeadAttention_arm::forward(const std::vector<Mat>& bottom_blobs, std::v
     if (retk != 0)
         return retk;
 
+    if (use_kv_cache)
+    {
+        int ret = concat_kv_cache(cached_k_blob, k_affine, top_blobs[1], opt);
+        if (ret != 0)
+            return ret;
+
+        k_affine = top_blobs[1];
+    }
+
+    const int dst_seqlen = k_affine.w;
+
     Mat qk_cross(dst_seqlen, src_seqlen * num_heads, elemsize, opt.blob_allocator);
     if (qk_cross.empty())
         return -100;
@@ -382,6 +439,15 @@ int MultiHeadAttention_arm::forward(const std::vector<Mat>& bottom_blobs, std::v
     if (retv != 0)
         return retv;
 
+    if (use_kv_cache)
+    {
+        int ret = concat_kv_cache(cached_v_blob, v_affine, top_blobs[2], opt);
+        if (ret != 0)
+            return ret;
+
+        v_affine = top_blobs[2];
+    }
+
     Mat qkv_cross(src_seqlen, embed_dim_per_head * num_heads, elemsize, opt.blob_allocator);
     if (qkv_cross.empty())
         return -100;
@@ -24,6 +24,7 @@ int Convolution1D::load_param(const ParamDict& pd)
     pad_value = pd.get(18, 0.f);
     bias_term = pd.get(5, 0);
     weight_data_size = pd.get(6, 0);
+    int8_scale_term = pd.get(8, 0);
     activation_type = pd.get(9, 0);
     activation_params = pd.get(10, Mat());
 
@@ -34,6 +35,16 @@ int Convolution1D::load_param(const ParamDict& pd)
         one_blob_only = false;
     }
 
+    if (int8_scale_term)
+    {
+#if NCNN_INT8
+        support_int8_storage = true;
+#else
+        NCNN_LOGE("please build ncnn with NCNN_INT8 enabled for int8 inference");
+        return -1;
+#endif
+    }
+
     return 0;
 }
 
@@ -53,6 +64,36 @@ int Convolution1D::load_model(const ModelBin& mb)
             return -100;
     }
 
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        weight_data_int8_scales = mb.load(num_output, 1);
+        bottom_blob_int8_scales = mb.load(1, 1);
+    }
+#endif // NCNN_INT8
+
+#if NCNN_INT8
+    // runtime quantize the weight data
+    if (weight_data.elemsize == (size_t)4u && int8_scale_term)
+    {
+        const int num_input = weight_data_size / num_output / kernel_w;
+
+        Mat weight_data_r2 = weight_data.reshape(kernel_w, num_input, num_output);
+
+        Mat weight_data_int8;
+
+        Option opt_q;
+        opt_q.num_threads = 1;
+        opt_q.blob_allocator = weight_data.allocator;
+        opt_q.use_packing_layout = false;
+        quantize_to_int8(weight_data_r2, weight_data_int8, weight_data_int8_scales, opt_q);
+        if (weight_data_int8.empty())
+            return -100;
+
+        weight_data = weight_data_int8.reshape(weight_data_size);
+    }
+#endif // NCNN_INT8
+
     return 0;
 }
 
@@ -106,6 +147,13 @@ static int convolution1d(const Mat& bottom_blob, Mat& top_blob, const Mat& weigh
 
 int Convolution1D::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        return forward_int8(bottom_blob, top_blob, opt);
+    }
+#endif
+
     Mat bottom_blob_bordered;
     make_padding(bottom_blob, bottom_blob_bordered, opt);
     if (bottom_blob_bordered.empty())
@@ -217,4 +265,80 @@ void Convolution1D::make_padding(const Mat& bottom_blob, Mat& bottom_blob_border
     }
 }
 
+#if NCNN_INT8
+int Convolution1D::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    Mat bottom_blob_int8 = bottom_blob;
+    if (bottom_blob.elemsize != 1)
+    {
+        Option opt_q = opt;
+        opt_q.blob_allocator = opt.workspace_allocator;
+        opt_q.use_packing_layout = false;
+        quantize_to_int8(bottom_blob, bottom_blob_int8, bottom_blob_int8_scales, opt_q);
+        if (bottom_blob_int8.empty())
+            return -100;
+    }
+
+    Mat bottom_blob_bordered;
+    make_padding(bottom_blob_int8, bottom_blob_bordered, opt);
+    if (bottom_blob_bordered.empty())
+        return -100;
+
+    const int w = bottom_blob_bordered.w;
+    const int h = bottom_blob_bordered.h;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+
+    const int outw = (w - kernel_extent_w) / stride_w + 1;
+
+    top_blob.create(outw, num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < num_output; p++)
+    {
+        float* outptr = top_blob.row(p);
+
+        // dequantize
+        float scale_in;
+        if (weight_data_int8_scales[p] == 0)
+            scale_in = 0;
+        else
+            scale_in = 1.f / (bottom_blob_int8_scales[0] * weight_data_int8_scales[p]);
+
+        const float bias = bias_term ? bias_data[p] : 0.f;
+
+        for (int j = 0; j < outw; j++)
+        {
+            int sum = 0;
+
+            const signed char* kptr = (const signed char*)weight_data + kernel_w * h * p;
+
+            for (int q = 0; q < h; q++)
+            {
+                const signed char* sptr = bottom_blob_bordered.row<const signed char>(q) + j * stride_w;
+
+                for (int k = 0; k < kernel_w; k++)
+                {
+                    int val = sptr[0];
+                    int wt = kptr[k];
+                    sum += val * wt;
+
+                    sptr += dilation_w;
+                }
+
+                kptr += kernel_w;
+            }
+
+            float sumfp32 = sum * scale_in + bias;
+
+            outptr[j] = activation_ss(sumfp32, activation_type, activation_params);
+        }
+    }
+
+    return 0;
+}
+#endif // NCNN_INT8
+
 } // namespace ncnn
@@ -25,6 +25,10 @@ protected:
     void make_padding(const Mat& bottom_blob, Mat& bottom_blob_bordered, const Option& opt) const;
     void make_padding(const Mat& bottom_blob, Mat& bottom_blob_bordered, int kernel_w, const Option& opt) const;
 
+#if NCNN_INT8
+    int forward_int8(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+#endif
+
 public:
     // param
     int num_output;
@@ -38,6 +42,8 @@ public:
 
     int weight_data_size;
 
+    int int8_scale_term;
+
     // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid
     int activation_type;
     Mat activation_params;
@@ -47,6 +53,11 @@ public:
     // model
     Mat weight_data;
     Mat bias_data;
+
+#if NCNN_INT8
+    Mat weight_data_int8_scales;
+    Mat bottom_blob_int8_scales;
+#endif
 };
 
 } // namespace ncnn
@@ -27,6 +27,7 @@ int ConvolutionDepthWise1D::load_param(const ParamDict& pd)
     bias_term = pd.get(5, 0);
     weight_data_size = pd.get(6, 0);
     group = pd.get(7, 1);
+    int8_scale_term = pd.get(8, 0);
     activation_type = pd.get(9, 0);
     activation_params = pd.get(10, Mat());
 
@@ -43,6 +44,16 @@ int ConvolutionDepthWise1D::load_param(const ParamDict& pd)
         return -100;
     }
 
+    if (int8_scale_term)
+    {
+#if NCNN_INT8
+        support_int8_storage = true;
+#else
+        NCNN_LOGE("please build ncnn with NCNN_INT8 enabled for int8 inference");
+        return -1;
+#endif
+    }
+
     return 0;
 }
 
@@ -62,6 +73,45 @@ int ConvolutionDepthWise1D::load_model(const ModelBin& mb)
             return -100;
     }
 
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        weight_data_int8_scales = mb.load(group, 1);
+        bottom_blob_int8_scales = mb.load(1, 1);
+
+        float bottom_blob_int8_scale = bottom_blob_int8_scales[0];
+        bottom_blob_int8_scales = Mat(group);
+        bottom_blob_int8_scales.fill(bottom_blob_int8_scale);
+    }
+#endif // NCNN_INT8
+
+#if NCNN_INT8
+    // runtime quantize the weight data
+    if (weight_data.elemsize == (size_t)4u && int8_scale_term)
+    {
+        Mat int8_weight_data(weight_data_size, (size_t)1u);
+        if (int8_weight_data.empty())
+            return -100;
+
+        const int weight_data_size_g = weight_data_size / group;
+
+        for (int g = 0; g < group; g++)
+        {
+            Option opt_q;
+            opt_q.num_threads = 1;
+            opt_q.blob_allocator = int8_weight_data.allocator;
+            opt_q.use_packing_layout = false;
+
+            const Mat weight_data_g = weight_data.range(weight_data_size_g * g, weight_data_size_g);
+            Mat int8_weight_data_g = int8_weight_data.range(weight_data_size_g * g, weight_data_size_g);
+            const Mat weight_data_int8_scales_g = weight_data_int8_scales.range(g, 1);
+            quantize_to_int8(weight_data_g, int8_weight_data_g, weight_data_int8_scales_g, opt_q);
+        }
+
+        weight_data = int8_weight_data;
+    }
+#endif // NCNN_INT8
+
     return 0;
 }
 
@@ -159,6 +209,13 @@ static int convolutiondepthwise1d(const Mat& bottom_blob, Mat& top_blob, const M
 
 int ConvolutionDepthWise1D::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        return forward_int8(bottom_blob, top_blob, opt);
+    }
+#endif
+
     Mat bottom_blob_bordered;
     make_padding(bottom_blob, bottom_blob_bordered, opt);
     if (bottom_blob_bordered.empty())
@@ -270,4 +327,106 @@ void ConvolutionDepthWise1D::make_padding(const Mat& bottom_blob, Mat& bottom_bl
     }
 }
 
+#if NCNN_INT8
+int ConvolutionDepthWise1D::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int channels = bottom_blob.h;
+
+    if (channels % group != 0 || num_output % group != 0)
+    {
+        // reject invalid group
+        return -100;
+    }
+
+    const int channels_g = channels / group;
+    const int num_output_g = num_output / group;
+
+    Mat bottom_blob_int8 = bottom_blob;
+    if (bottom_blob.elemsize != 1)
+    {
+        Mat scales(channels);
+        {
+            float* ps = scales;
+            for (int g = 0; g < group; g++)
+            {
+                float scale = bottom_blob_int8_scales[g];
+                for (int q = 0; q < channels_g; q++)
+                {
+                    *ps++ = scale;
+                }
+            }
+        }
+
+        Option opt_q = opt;
+        opt_q.blob_allocator = opt.workspace_allocator;
+        opt_q.use_packing_layout = false;
+        quantize_to_int8(bottom_blob, bottom_blob_int8, scales, opt_q);
+        if (bottom_blob_int8.empty())
+            return -100;
+    }
+
+    Mat bottom_blob_bordered;
+    make_padding(bottom_blob_int8, bottom_blob_bordered, opt);
+    if (bottom_blob_bordered.empty())
+        return -100;
+
+    const int w = bottom_blob_bordered.w;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+
+    const int outw = (w - kernel_extent_w) / stride_w + 1;
+
+    top_blob.create(outw, num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // depth-wise is the group convolution with channels_g = num_output_g = 1
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < num_output; p++)
+    {
+        const int g = p / num_output_g;
+
+        float* outptr = top_blob.row(p);
+
+        // dequantize
+        float scale_in;
+        if (weight_data_int8_scales[g] == 0)
+            scale_in = 0;
+        else
+            scale_in = 1.f / (bottom_blob_int8_scales[g] * weight_data_int8_scales[g]);
+
+        const float bias = bias_term ? bias_data[p] : 0.f;
+
+        for (int j = 0; j < outw; j++)
+        {
+            int sum = 0;
+
+            const signed char* kptr = (const signed char*)weight_data + kernel_w * channels_g * p;
+
+            for (int q = 0; q < channels_g; q++)
+            {
+                const signed char* sptr = bottom_blob_bordered.row<const signed char>(channels_g * g + q) + j * stride_w;
+
+                for (int k = 0; k < kernel_w; k++)
+                {
+                    int val = sptr[0];
+                    int wt = kptr[k];
+                    sum += val * wt;
+
+                    sptr += dilation_w;
+                }
+
+                kptr += kernel_w;
+            }
+
+            float sumfp32 = sum * scale_in + bias;
+
+            outptr[j] = activation_ss(sumfp32, activation_type, activation_params);
+        }
+    }
+
+    return 0;
+}
+#endif // NCNN_INT8
+
 } // namespace ncnn
@@ -32,6 +32,7 @@ int Deconvolution::load_param(const ParamDict& pd)
     output_h = pd.get(21, output_w);
     bias_term = pd.get(5, 0);
     weight_data_size = pd.get(6, 0);
+    int8_scale_term = pd.get(8, 0);
     activation_type = pd.get(9, 0);
     activation_params = pd.get(10, Mat());
 
@@ -42,6 +43,16 @@ int Deconvolution::load_param(const ParamDict& pd)
         one_blob_only = false;
     }
 
+    if (int8_scale_term)
+    {
+#if NCNN_INT8
+        support_int8_storage = true;
+#else
+        NCNN_LOGE("please build ncnn with NCNN_INT8 enabled for int8 inference");
+        return -1;
+#endif
+    }
+
     return 0;
 }
 
@@ -61,6 +72,37 @@ int Deconvolution::load_model(const ModelBin& mb)
             return -100;
     }
 
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        weight_data_int8_scales = mb.load(num_output, 1);
+        bottom_blob_int8_scales = mb.load(1, 1);
+    }
+#endif // NCNN_INT8
+
+#if NCNN_INT8
+    // runtime quantize the weight data
+    if (weight_data.elemsize == (size_t)4u && int8_scale_term)
+    {
+        const int maxk = kernel_w * kernel_h;
+        const int num_input = weight_data_size / num_output / maxk;
+
+        Mat weight_data_r2 = weight_data.reshape(maxk, num_input, num_output);
+
+        Mat weight_data_int8;
+
+        Option opt_q;
+        opt_q.num_threads = 1;
+        opt_q.blob_allocator = weight_data.allocator;
+        opt_q.use_packing_layout = false;
+        quantize_to_int8(weight_data_r2, weight_data_int8, weight_data_int8_scales, opt_q);
+        if (weight_data_int8.empty())
+            return -100;
+
+        weight_data = weight_data_int8.reshape(weight_data_size);
+    }
+#endif // NCNN_INT8
+
     return 0;
 }
 
@@ -145,6 +187,13 @@ static int deconvolution(const Mat& bottom_blob, Mat& top_blob, const Mat& weigh
 
 int Deconvolution::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        return forward_int8(bottom_blob, top_blob, opt);
+    }
+#endif
+
     int w = bottom_blob.w;
     int h = bottom_blob.h;
     size_t elemsize = bottom_blob.elemsize;
@@ -294,4 +343,125 @@ void Deconvolution::cut_padding(const Mat& top_blob_bordered, Mat& top_blob, con
     }
 }
 
+#if NCNN_INT8
+int Deconvolution::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int inch = bottom_blob.c;
+
+    Mat bottom_blob_int8 = bottom_blob;
+    if (bottom_blob.elemsize != 1)
+    {
+        Option opt_q = opt;
+        opt_q.blob_allocator = opt.workspace_allocator;
+        opt_q.use_packing_layout = false;
+        quantize_to_int8(bottom_blob, bottom_blob_int8, bottom_blob_int8_scales, opt_q);
+        if (bottom_blob_int8.empty())
+            return -100;
+    }
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    const int outw = (w - 1) * stride_w + kernel_extent_w + output_pad_right;
+    const int outh = (h - 1) * stride_h + kernel_extent_h + output_pad_bottom;
+
+    Mat top_blob_bordered;
+    if (pad_left > 0 || pad_right > 0 || pad_top > 0 || pad_bottom > 0 || (output_w > 0 && output_h > 0))
+    {
+        top_blob_bordered.create(outw, outh, num_output, 4u, opt.workspace_allocator);
+    }
+    else
+    {
+        top_blob_bordered = top_blob;
+        top_blob_bordered.create(outw, outh, num_output, 4u, opt.blob_allocator);
+    }
+    if (top_blob_bordered.empty())
+        return -100;
+
+    const int maxk = kernel_w * kernel_h;
+
+    // kernel offsets
+    std::vector<int> _space_ofs(maxk);
+    int* space_ofs = &_space_ofs[0];
+    {
+        int p1 = 0;
+        int p2 = 0;
+        int gap = outw * dilation_h - kernel_w * dilation_w;
+        for (int i = 0; i < kernel_h; i++)
+        {
+            for (int j = 0; j < kernel_w; j++)
+            {
+                space_ofs[p1] = p2;
+                p1++;
+                p2 += dilation_w;
+            }
+            p2 += gap;
+        }
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < num_output; p++)
+    {
+        // accumulate int32 sums in place of the fp32 output channel
+        Mat out = top_blob_bordered.channel(p);
+        out.fill(0);
+
+        const signed char* kptr = (const signed char*)weight_data + maxk * inch * p;
+
+        for (int q = 0; q < inch; q++)
+        {
+            const signed char* sptr = bottom_blob_int8.channel(q);
+
+            for (int i = 0; i < h; i++)
+            {
+                for (int j = 0; j < w; j++)
+                {
+                    const int val = sptr[j];
+                    if (val == 0)
+                        continue;
+
+                    int* outptr = out.row<int>(i * stride_h) + j * stride_w;
+
+                    for (int k = 0; k < maxk; k++)
+                    {
+                        outptr[space_ofs[k]] += val * kptr[k];
+                    }
+                }
+
+                sptr += w;
+            }
+
+            kptr += maxk;
+        }
+
+        // dequantize
+        float scale_in;
+        if (weight_data_int8_scales[p] == 0)
+            scale_in = 0;
+        else
+            scale_in = 1.f / (bottom_blob_int8_scales[0] * weight_data_int8_scales[p]);
+
+        const float bias = bias_term ? bias_data[p] : 0.f;
+
+        int* sumptr = out;
+        float* outptr = out;
+        const int size = outw * outh;
+
+        for (int i = 0; i < size; i++)
+        {
+            float sumfp32 = sumptr[i] * scale_in + bias;
+            outptr[i] = activation_ss(sumfp32, activation_type, activation_params);
+        }
+    }
+
+    cut_padding(top_blob_bordered, top_blob, opt);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+#endif // NCNN_INT8
+
 } // namespace ncnn
@@ -24,6 +24,10 @@ public:
 protected:
     void cut_padding(const Mat& top_blob_bordered, Mat& top_blob, const Option& opt) const;
 
+#if NCNN_INT8
+    int forward_int8(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+#endif
+
 public:
     // param
     int num_output;
@@ -45,6 +49,8 @@ public:
 
     int weight_data_size;
 
+    int int8_scale_term;
+
     // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid
     int activation_type;
     Mat activation_params;
@@ -54,6 +60,11 @@ public:
     // model
     Mat weight_data;
     Mat bias_data;
+
+#if NCNN_INT8
+    Mat weight_data_int8_scales;
+    Mat bottom_blob_int8_scales;
+#endif
 };
 
 } // namespace ncnn
@@ -3,6 +3,8 @@
 
 #include "gemm.h"
 
+#include "weight_quant.h"
+
 namespace ncnn {
 
 Gemm::Gemm()
@@ -29,9 +31,11 @@ int Gemm::load_param(const ParamDict& pd)
     output_elemtype = pd.get(13, 0);
     output_transpose = pd.get(14, 0);
     int8_scale_term = pd.get(18, 0);
+    weight_quant_bits = pd.get(19, 0);
     constant_TILE_M = pd.get(20, 0);
     constant_TILE_N = pd.get(21, 0);
     constant_TILE_K = pd.get(22, 0);
+    weight_quant_group_size = pd.get(23, 0);
 
     if (int8_scale_term)
     {
@@ -41,6 +45,28 @@ int Gemm::load_param(const ParamDict& pd)
 #endif
     }
 
+    if (weight_quant_bits)
+    {
+        if (weight_quant_bits != 8 && weight_quant_bits != 4)
+        {
+            NCNN_LOGE("weight_quant_bits must be 8 or 4");
+            return -1;
+        }
+
+        if (int8_scale_term)
+        {
+            NCNN_LOGE("weight_quant_bits and int8_scale_term can not be enabled together");
+            return -1;
+        }
+
+        // the quantized matrix keeps K along w
+        if (!((constantA == 1 && constantB == 0 && transA == 0) || (constantA == 0 && constantB == 1 && transB == 1)))
+        {
+            NCNN_LOGE("weight_quant_bits requires constant A without transA or constant B with transB");
+            return -1;
+        }
+    }
+
     if (constantA == 1 && (constantM == 0 || constantK == 0))
     {
         NCNN_LOGE("constantM and constantK must be non-zero when constantA enabled");
@@ -68,14 +94,35 @@ int Gemm::load_param(const ParamDict& pd)
     if (constantA == 1 && constantB == 1 && constantC == 0)
         one_blob_only = true;
 
+    // rows of A map to rows of output when B is constant and C does not vary along M
+    support_batch_stacking = constantA == 0 && constantB == 1 && transA == 0 && output_N1M == 0 && output_elempack == 0 && output_transpose == 0 && int8_scale_term == 0
+                             && (constantC == 0 || constant_broadcast_type_C == -1 || constant_broadcast_type_C == 0 || constant_broadcast_type_C == 4);
+
     return 0;
 }
 
+static Mat load_weight_quant(const ModelBin& mb, int rows, int K, int bits)
+{
+    const int row_bytes = weight_quant_row_bytes(K, bits);
+
+    // int4 rows are padded to whole bytes
+    Mat m = mb.load(bits == 4 ? row_bytes * 2 * rows : K * rows, 0);
+    if (m.empty() || m.elemsize != 1u)
+    {
+        NCNN_LOGE("weight-only quantized data expected");
+        return Mat();
+    }
+
+    return m.reshape(row_bytes, rows);
+}
+
 int Gemm::load_model(const ModelBin& mb)
 {
     if (constantA == 1)
     {
-        if (transA == 0)
+        if (weight_quant_bits)
+            A_data = load_weight_quant(mb, constantM, constantK, weight_quant_bits);
+        else if (transA == 0)
             A_data = mb.load(constantK, constantM, 0);
         else
             A_data = mb.load(constantM, constantK, 0);
@@ -85,7 +132,9 @@ int Gemm::load_model(const ModelBin& mb)
 
     if (constantB == 1)
     {
-        if (transB == 0)
+        if (weight_quant_bits)
+            B_data = load_weight_quant(mb, constantN, constantK, weight_quant_bits);
+        else if (transB == 0)
             B_data = mb.load(constantN, constantK, 0);
         else
             B_data = mb.load(constantK, constantN, 0);
@@ -109,6 +158,25 @@ int Gemm::load_model(const ModelBin& mb)
             return -100;
     }
 
+    if (weight_quant_bits)
+    {
+        const int group_count = weight_quant_group_count(constantK, weight_quant_group_size);
+
+        if (constantA == 1)
+        {
+            A_data_quant_scales = mb.load(group_count, constantM, 1);
+            if (A_data_quant_scales.empty())
+                return -100;
+        }
+
+        if (constantB == 1)
+        {
+            B_data_quant_scales = mb.load(group_count, constantN, 1);
+            if (B_data_quant_scales.empty())
+                return -100;
+        }
+    }
+
 #if NCNN_INT8
     if (int8_scale_term)
     {
@@ -121,6 +189,14 @@ int Gemm::load_model(const ModelBin& mb)
         {
             B_data_int8_scale = mb.load(1, 1)[0];
         }
+
+        const int input_count = (constantA ? 0 : 1) + (constantB ? 0 : 1);
+        if (int8_scale_term == 3 && input_count > 0)
+        {
+            bottom_blob_int8_scales = mb.load(input_count, 1);
+            if (bottom_blob_int8_scales.empty())
+                return -100;
+        }
     }
 #endif // NCNN_INT8
 
@@ -291,8 +367,24 @@ int Gemm::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_bl
     }
 #endif // NCNN_INT8
 
-    const Mat& A0 = constantA ? A_data : bottom_blobs[0];
-    const Mat& B0 = constantB ? B_data : constantA ? bottom_blobs[0] : bottom_blobs[1];
+    Mat A_data_dequantized = A_data;
+    Mat B_data_dequantized = B_data;
+    if (weight_quant_bits)
+    {
+        Option opt_q = opt;
+        opt_q.blob_allocator = opt.workspace_allocator;
+
+        int ret = 0;
+        if (constantA)
+            ret = dequantize_weight_quant(A_data, A_data_quant_scales, A_data_dequantized, constantK, weight_quant_bits, weight_quant_group_size, opt_q);
+        if (constantB)
+            ret = dequantize_weight_quant(B_data, B_data_quant_scales, B_data_dequantized, constantK, weight_quant_bits, weight_quant_group_size, opt_q);
+        if (ret != 0)
+            return ret;
+    }
+
+    const Mat& A0 = constantA ? A_data_dequantized : bottom_blobs[0];
+    const Mat& B0 = constantB ? B_data_dequantized : constantA ? bottom_blobs[0] : bottom_blobs[1];
 
     size_t elemsize = A0.elemsize;
 
@@ -466,6 +558,17 @@ int Gemm::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& t
         }
     }
 
+    // static input scales from calibration, 0 for dynamic quantize
+    float A_static_int8_scale = 0.f;
+    float B_static_int8_scale = 0.f;
+    if (int8_scale_term == 3)
+    {
+        if (!constantA)
+            A_static_int8_scale = bottom_blob_int8_scales[0];
+        if (!constantB)
+            B_static_int8_scale = bottom_blob_int8_scales[constantA ? 0 : 1];
+    }
+
     // dynamic quantize A
     Mat A_int8 = A;
     Mat A_int8_scales = A_data_int8_scales;
@@ -479,13 +582,17 @@ int Gemm::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& t
             const size_t A_hstep = A.dims == 3 ? A.cstep : (size_t)A.w;
             const float* ptr = (const float*)A + i * A_hstep;
 
-            float absmax = 0.f;
-            for (int k = 0; k < A_int8.w; k++)
+            float A_int8_scale = A_static_int8_scale;
+            if (A_int8_scale == 0.f)
             {
-                absmax = std::max(absmax, (float)fabs(ptr[k]));
-            }
+                float absmax = 0.f;
+                for (int k = 0; k < A_int8.w; k++)
+                {
+                    absmax = std::max(absmax, (float)fabs(ptr[k]));
+                }
 
-            float A_int8_scale = absmax == 0.f ? 1.f : 127.f / absmax;
+                A_int8_scale = absmax == 0.f ? 1.f : 127.f / absmax;
+            }
             A_int8_scales[i] = A_int8_scale;
 
             signed char* ptrAi = A_int8.row<signed char>(i);
@@ -504,19 +611,23 @@ int Gemm::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& t
     {
         B0_int8.create(B0.w, B0.dims == 3 ? B0.c : B0.h, (size_t)1u, 1, opt.workspace_allocator);
 
-        float absmax = 0.f;
-        for (int i = 0; i < B0_int8.h; i++)
+        B_int8_scale = B_static_int8_scale;
+        if (B_int8_scale == 0.f)
         {
-            const size_t B_hstep = B0.dims == 3 ? B0.cstep : (size_t)B0.w;
-            const float* ptr = (const float*)B0 + i * B_hstep;
-
-            for (int k = 0; k < B0_int8.w; k++)
+            float absmax = 0.f;
+            for (int i = 0; i < B0_int8.h; i++)
             {
-                absmax = std::max(absmax, (float)fabs(ptr[k]));
+                const size_t B_hstep = B0.dims == 3 ? B0.cstep : (size_t)B0.w;
+                const float* ptr = (const float*)B0 + i * B_hstep;
+
+                for (int k = 0; k < B0_int8.w; k++)
+                {
+                    absmax = std::max(absmax, (float)fabs(ptr[k]));
+                }
             }
-        }
 
-        B_int8_scale = absmax == 0.f ? 1.f : 127.f / absmax;
+            B_int8_scale = absmax == 0.f ? 1.f : 127.f / absmax;
+        }
 
         for (int i = 0; i < B0_int8.h; i++)
         {
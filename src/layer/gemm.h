@@ -44,7 +44,11 @@ public:
     int output_elemtype; // 0=auto 1=fp32
     int output_transpose;
 
-    int int8_scale_term;
+    int int8_scale_term; // 2=dynamic input quantization 3=static input scales
+
+    // weight-only quantized constant A or B, 0=off 8=int8 4=int4
+    int weight_quant_bits;
+    int weight_quant_group_size;
 
     int constant_TILE_M;
     int constant_TILE_N;
@@ -58,7 +62,13 @@ public:
 #if NCNN_INT8
     Mat A_data_int8_scales;
     float B_data_int8_scale;
+
+    // static scales of the non-constant A and B inputs in order
+    Mat bottom_blob_int8_scales;
 #endif
+
+    Mat A_data_quant_scales;
+    Mat B_data_quant_scales;
 };
 
 } // namespace ncnn
@@ -53,6 +53,13 @@ int GRU::load_model(const ModelBin& mb)
     {
         weight_xc_data_int8_scales = mb.load(num_output * 3, num_directions, 1);
         weight_hc_data_int8_scales = mb.load(num_output * 3, num_directions, 1);
+
+        if (int8_scale_term == 3)
+        {
+            bottom_blob_int8_scales = mb.load(1, 1);
+            if (bottom_blob_int8_scales.empty())
+                return -100;
+        }
     }
 #endif // NCNN_INT8
 
@@ -168,7 +175,7 @@ static int gru(const Mat& bottom_blob, Mat& top_blob, int reverse, const Mat& we
 }
 
 #if NCNN_INT8
-static int gru_int8(const Mat& bottom_blob, Mat& top_blob, int reverse, const Mat& weight_xc_int8, const float* weight_xc_int8_scales, const Mat& bias_c, const Mat& weight_hc_int8, const float* weight_hc_int8_scales, Mat& hidden_state, const Option& opt)
+static int gru_int8(const Mat& bottom_blob, const Mat& bottom_blob_static_int8_scales, Mat& top_blob, int reverse, const Mat& weight_xc_int8, const float* weight_xc_int8_scales, const Mat& bias_c, const Mat& weight_hc_int8, const float* weight_hc_int8_scales, Mat& hidden_state, const Option& opt)
 {
     int size = bottom_blob.w;
     int T = bottom_blob.h;
@@ -180,12 +187,18 @@ static int gru_int8(const Mat& bottom_blob, Mat& top_blob, int reverse, const Ma
     if (gates.empty())
         return -100;
 
-    // dynamic quantize bottom_blob
+    // dynamic quantize bottom_blob unless the static scale is known
     Mat bottom_blob_int8(size, T, (size_t)1u, 1, opt.workspace_allocator);
     Mat bottom_blob_int8_scales(T, (size_t)4u, 1, opt.workspace_allocator);
     {
         for (int t = 0; t < T; t++)
         {
+            if (!bottom_blob_static_int8_scales.empty())
+            {
+                bottom_blob_int8_scales[t] = bottom_blob_static_int8_scales[0];
+                continue;
+            }
+
             const float* x = bottom_blob.row(t);
 
             float absmax = 0.f;
@@ -365,7 +378,7 @@ int GRU::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = gru_int8(bottom_blob, top_blob, direction, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), hidden, opt);
+            int ret = gru_int8(bottom_blob, bottom_blob_int8_scales, top_blob, direction, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), hidden, opt);
             if (ret != 0)
                 return ret;
         }
@@ -391,7 +404,7 @@ int GRU::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = gru_int8(bottom_blob, top_blob_forward, 0, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), hidden, opt);
+            int ret = gru_int8(bottom_blob, bottom_blob_int8_scales, top_blob_forward, 0, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), hidden, opt);
             if (ret != 0)
                 return ret;
         }
@@ -408,7 +421,7 @@ int GRU::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = gru_int8(bottom_blob, top_blob_reverse, 1, weight_xc_data.channel(1), weight_xc_data_int8_scales.row(1), bias_c_data.channel(1), weight_hc_data.channel(1), weight_hc_data_int8_scales.row(1), hidden, opt);
+            int ret = gru_int8(bottom_blob, bottom_blob_int8_scales, top_blob_reverse, 1, weight_xc_data.channel(1), weight_xc_data_int8_scales.row(1), bias_c_data.channel(1), weight_hc_data.channel(1), weight_hc_data_int8_scales.row(1), hidden, opt);
             if (ret != 0)
                 return ret;
         }
@@ -466,7 +479,7 @@ int GRU::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blo
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = gru_int8(bottom_blob, top_blob, direction, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), hidden, opt);
+            int ret = gru_int8(bottom_blob, bottom_blob_int8_scales, top_blob, direction, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), hidden, opt);
             if (ret != 0)
                 return ret;
         }
@@ -493,7 +506,7 @@ int GRU::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blo
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = gru_int8(bottom_blob, top_blob_forward, 0, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), hidden0, opt);
+            int ret = gru_int8(bottom_blob, bottom_blob_int8_scales, top_blob_forward, 0, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), hidden0, opt);
             if (ret != 0)
                 return ret;
         }
@@ -509,7 +522,7 @@ int GRU::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blo
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = gru_int8(bottom_blob, top_blob_reverse, 1, weight_xc_data.channel(1), weight_xc_data_int8_scales.row(1), bias_c_data.channel(1), weight_hc_data.channel(1), weight_hc_data_int8_scales.row(1), hidden1, opt);
+            int ret = gru_int8(bottom_blob, bottom_blob_int8_scales, top_blob_reverse, 1, weight_xc_data.channel(1), weight_xc_data_int8_scales.row(1), bias_c_data.channel(1), weight_hc_data.channel(1), weight_hc_data_int8_scales.row(1), hidden1, opt);
             if (ret != 0)
                 return ret;
         }
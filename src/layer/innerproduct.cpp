@@ -6,6 +6,7 @@
 #include "layer_type.h"
 
 #include "fused_activation.h"
+#include "weight_quant.h"
 
 namespace ncnn {
 
@@ -13,6 +14,7 @@ InnerProduct::InnerProduct()
 {
     one_blob_only = true;
     support_inplace = false;
+    support_batch_stacking = true;
 }
 
 int InnerProduct::load_param(const ParamDict& pd)
@@ -23,6 +25,8 @@ int InnerProduct::load_param(const ParamDict& pd)
     int8_scale_term = pd.get(8, 0);
     activation_type = pd.get(9, 0);
     activation_params = pd.get(10, Mat());
+    weight_quant_bits = pd.get(11, 0);
+    weight_quant_group_size = pd.get(12, 0);
 
     if (int8_scale_term)
     {
@@ -34,14 +38,47 @@ int InnerProduct::load_param(const ParamDict& pd)
 #endif
     }
 
+    if (weight_quant_bits)
+    {
+        if (weight_quant_bits != 8 && weight_quant_bits != 4)
+        {
+            NCNN_LOGE("weight_quant_bits must be 8 or 4");
+            return -1;
+        }
+
+        if (int8_scale_term)
+        {
+            NCNN_LOGE("weight_quant_bits and int8_scale_term can not be enabled together");
+            return -1;
+        }
+    }
+
     return 0;
 }
 
 int InnerProduct::load_model(const ModelBin& mb)
 {
-    weight_data = mb.load(weight_data_size, 0);
-    if (weight_data.empty())
-        return -100;
+    if (weight_quant_bits)
+    {
+        const int num_input = weight_data_size / num_output;
+        const int row_bytes = weight_quant_row_bytes(num_input, weight_quant_bits);
+
+        // int4 rows are padded to whole bytes
+        weight_data = mb.load(weight_quant_bits == 4 ? row_bytes * 2 * num_output : weight_data_size, 0);
+        if (weight_data.empty() || weight_data.elemsize != 1u)
+        {
+            NCNN_LOGE("weight-only quantized data expected");
+            return -100;
+        }
+
+        weight_data = weight_data.reshape(row_bytes, num_output);
+    }
+    else
+    {
+        weight_data = mb.load(weight_data_size, 0);
+        if (weight_data.empty())
+            return -100;
+    }
 
     if (bias_term)
     {
@@ -50,6 +87,15 @@ int InnerProduct::load_model(const ModelBin& mb)
             return -100;
     }
 
+    if (weight_quant_bits)
+    {
+        const int num_input = weight_data_size / num_output;
+
+        weight_data_quant_scales = mb.load(weight_quant_group_count(num_input, weight_quant_group_size), num_output, 1);
+        if (weight_data_quant_scales.empty())
+            return -100;
+    }
+
 #if NCNN_INT8
     if (int8_scale_term)
     {
@@ -84,7 +130,7 @@ int InnerProduct::load_model(const ModelBin& mb)
 int InnerProduct::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
 #if NCNN_INT8
-    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u && weight_quant_bits == 0)
     {
         return forward_int8(bottom_blob, top_blob, opt);
     }
@@ -113,16 +159,25 @@ int InnerProduct::forward(const Mat& bottom_blob, Mat& top_blob, const Option& o
 
             for (int p = 0; p < num_output; p++)
             {
-                const float* kptr = (const float*)weight_data + w * p;
-
                 float sum = 0.f;
 
                 if (bias_term)
                     sum = bias_data[p];
 
-                for (int i = 0; i < w; i++)
+                if (weight_quant_bits)
                 {
-                    sum += m[i] * kptr[i];
+                    // expand the weight-only quantized row inside the dot product
+                    const unsigned char* kptr = weight_data.row<const unsigned char>(p);
+                    sum += dot_weight_quant_row(m, kptr, weight_data_quant_scales.row(p), 0, w, weight_quant_bits, weight_quant_group_size);
+                }
+                else
+                {
+                    const float* kptr = (const float*)weight_data + w * p;
+
+                    for (int i = 0; i < w; i++)
+                    {
+                        sum += m[i] * kptr[i];
+                    }
                 }
 
                 outptr[p] = activation_ss(sum, activation_type, activation_params);
@@ -148,9 +203,17 @@ int InnerProduct::forward(const Mat& bottom_blob, Mat& top_blob, const Option& o
         // channels
         for (int q = 0; q < channels; q++)
         {
-            const float* w = (const float*)weight_data + size * channels * p + size * q;
             const float* m = bottom_blob.channel(q);
 
+            if (weight_quant_bits)
+            {
+                const unsigned char* kptr = weight_data.row<const unsigned char>(p);
+                sum += dot_weight_quant_row(m, kptr, weight_data_quant_scales.row(p), size * q, size, weight_quant_bits, weight_quant_group_size);
+                continue;
+            }
+
+            const float* w = (const float*)weight_data + size * channels * p + size * q;
+
             for (int i = 0; i < size; i++)
             {
                 sum += m[i] * w[i];
@@ -33,6 +33,10 @@ public:
 
     int int8_scale_term;
 
+    // weight-only quantized weight, 0=off 8=int8 4=int4
+    int weight_quant_bits;
+    int weight_quant_group_size;
+
     // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid
     int activation_type;
     Mat activation_params;
@@ -45,6 +49,8 @@ public:
     Mat weight_data_int8_scales;
     Mat bottom_blob_int8_scales;
 #endif
+
+    Mat weight_data_quant_scales;
 };
 
 } // namespace ncnn
@@ -24,6 +24,15 @@ int Convolution1D_loongarch::create_pipeline(const Option& opt)
     if (dynamic_weight)
         return 0;
 
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        // TODO implement int8, forward runs the reference int8 path on unpacked fp32 blobs
+        support_packing = false;
+        return 0;
+    }
+#endif
+
     const int num_input = weight_data_size / kernel_w / num_output;
 
     int elempack = 1;
@@ -80,6 +89,13 @@ int Convolution1D_loongarch::destroy_pipeline(const Option& /*opt*/)
 
 int Convolution1D_loongarch::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+#if NCNN_INT8
+    if (opt.use_int8_inference && int8_scale_term)
+    {
+        return Convolution1D::forward_int8(bottom_blob, top_blob, opt);
+    }
+#endif
+
     int w = bottom_blob.w;
     int h = bottom_blob.h;
     size_t elemsize = bottom_blob.elemsize;
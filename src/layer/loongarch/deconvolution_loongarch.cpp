@@ -32,6 +32,15 @@ int Deconvolution_loongarch::create_pipeline(const Option& opt)
     if (dynamic_weight)
         return 0;
 
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        // TODO implement int8, forward runs the reference int8 path on unpacked fp32 blobs
+        support_packing = false;
+        return 0;
+    }
+#endif
+
     const int maxk = kernel_w * kernel_h;
     int num_input = weight_data_size / maxk / num_output;
 
@@ -128,6 +137,13 @@ int Deconvolution_loongarch::destroy_pipeline(const Option& opt)
 
 int Deconvolution_loongarch::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+#if NCNN_INT8
+    if (opt.use_int8_inference && int8_scale_term)
+    {
+        return Deconvolution::forward_int8(bottom_blob, top_blob, opt);
+    }
+#endif
+
     // deconvolv with NxN kernel
     // value = value + bias
 
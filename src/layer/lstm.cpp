@@ -61,6 +61,13 @@ int LSTM::load_model(const ModelBin& mb)
     {
         weight_xc_data_int8_scales = mb.load(hidden_size * 4, num_directions, 1);
         weight_hc_data_int8_scales = mb.load(hidden_size * 4, num_directions, 1);
+
+        if (int8_scale_term == 3)
+        {
+            bottom_blob_int8_scales = mb.load(1, 1);
+            if (bottom_blob_int8_scales.empty())
+                return -100;
+        }
     }
 #endif // NCNN_INT8
 
@@ -214,7 +221,7 @@ static int lstm(const Mat& bottom_blob, Mat& top_blob, int reverse, const Mat& w
 }
 
 #if NCNN_INT8
-static int lstm_int8(const Mat& bottom_blob, Mat& top_blob, int reverse, const Mat& weight_xc_int8, const float* weight_xc_int8_scales, const Mat& bias_c, const Mat& weight_hc_int8, const float* weight_hc_int8_scales, const Mat& weight_hr, Mat& hidden_state, Mat& cell_state, const Option& opt)
+static int lstm_int8(const Mat& bottom_blob, const Mat& bottom_blob_static_int8_scales, Mat& top_blob, int reverse, const Mat& weight_xc_int8, const float* weight_xc_int8_scales, const Mat& bias_c, const Mat& weight_hc_int8, const float* weight_hc_int8_scales, const Mat& weight_hr, Mat& hidden_state, Mat& cell_state, const Option& opt)
 {
     int size = bottom_blob.w;
     int T = bottom_blob.h;
@@ -235,12 +242,18 @@ static int lstm_int8(const Mat& bottom_blob, Mat& top_blob, int reverse, const M
             return -100;
     }
 
-    // dynamic quantize bottom_blob
+    // dynamic quantize bottom_blob unless the static scale is known
     Mat bottom_blob_int8(size, T, (size_t)1u, 1, opt.workspace_allocator);
     Mat bottom_blob_int8_scales(T, (size_t)4u, 1, opt.workspace_allocator);
     {
         for (int t = 0; t < T; t++)
         {
+            if (!bottom_blob_static_int8_scales.empty())
+            {
+                bottom_blob_int8_scales[t] = bottom_blob_static_int8_scales[0];
+                continue;
+            }
+
             const float* x = bottom_blob.row(t);
 
             float absmax = 0.f;
@@ -458,7 +471,7 @@ int LSTM::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) cons
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = lstm_int8(bottom_blob, top_blob, direction, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), num_output == hidden_size ? Mat() : weight_hr_data.channel(0), hidden, cell, opt);
+            int ret = lstm_int8(bottom_blob, bottom_blob_int8_scales, top_blob, direction, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), num_output == hidden_size ? Mat() : weight_hr_data.channel(0), hidden, cell, opt);
             if (ret != 0)
                 return ret;
         }
@@ -484,7 +497,7 @@ int LSTM::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) cons
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = lstm_int8(bottom_blob, top_blob_forward, 0, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), num_output == hidden_size ? Mat() : weight_hr_data.channel(0), hidden, cell, opt);
+            int ret = lstm_int8(bottom_blob, bottom_blob_int8_scales, top_blob_forward, 0, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), num_output == hidden_size ? Mat() : weight_hr_data.channel(0), hidden, cell, opt);
             if (ret != 0)
                 return ret;
         }
@@ -502,7 +515,7 @@ int LSTM::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) cons
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = lstm_int8(bottom_blob, top_blob_reverse, 1, weight_xc_data.channel(1), weight_xc_data_int8_scales.row(1), bias_c_data.channel(1), weight_hc_data.channel(1), weight_hc_data_int8_scales.row(1), num_output == hidden_size ? Mat() : weight_hr_data.channel(1), hidden, cell, opt);
+            int ret = lstm_int8(bottom_blob, bottom_blob_int8_scales, top_blob_reverse, 1, weight_xc_data.channel(1), weight_xc_data_int8_scales.row(1), bias_c_data.channel(1), weight_hc_data.channel(1), weight_hc_data_int8_scales.row(1), num_output == hidden_size ? Mat() : weight_hr_data.channel(1), hidden, cell, opt);
             if (ret != 0)
                 return ret;
         }
@@ -567,7 +580,7 @@ int LSTM::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_bl
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = lstm_int8(bottom_blob, top_blob, direction, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), num_output == hidden_size ? Mat() : weight_hr_data.channel(0), hidden, cell, opt);
+            int ret = lstm_int8(bottom_blob, bottom_blob_int8_scales, top_blob, direction, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), num_output == hidden_size ? Mat() : weight_hr_data.channel(0), hidden, cell, opt);
             if (ret != 0)
                 return ret;
         }
@@ -595,7 +608,7 @@ int LSTM::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_bl
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = lstm_int8(bottom_blob, top_blob_forward, 0, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), num_output == hidden_size ? Mat() : weight_hr_data.channel(0), hidden0, cell0, opt);
+            int ret = lstm_int8(bottom_blob, bottom_blob_int8_scales, top_blob_forward, 0, weight_xc_data.channel(0), weight_xc_data_int8_scales.row(0), bias_c_data.channel(0), weight_hc_data.channel(0), weight_hc_data_int8_scales.row(0), num_output == hidden_size ? Mat() : weight_hr_data.channel(0), hidden0, cell0, opt);
             if (ret != 0)
                 return ret;
         }
@@ -612,7 +625,7 @@ int LSTM::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_bl
 #if NCNN_INT8
         if (int8_scale_term)
         {
-            int ret = lstm_int8(bottom_blob, top_blob_reverse, 1, weight_xc_data.channel(1), weight_xc_data_int8_scales.row(1), bias_c_data.channel(1), weight_hc_data.channel(1), weight_hc_data_int8_scales.row(1), num_output == hidden_size ? Mat() : weight_hr_data.channel(1), hidden1, cell1, opt);
+            int ret = lstm_int8(bottom_blob, bottom_blob_int8_scales, top_blob_reverse, 1, weight_xc_data.channel(1), weight_xc_data_int8_scales.row(1), bias_c_data.channel(1), weight_hc_data.channel(1), weight_hc_data_int8_scales.row(1), num_output == hidden_size ? Mat() : weight_hr_data.channel(1), hidden1, cell1, opt);
             if (ret != 0)
                 return ret;
         }
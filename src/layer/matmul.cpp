@@ -14,6 +14,15 @@ MatMul::MatMul()
 int MatMul::load_param(const ParamDict& pd)
 {
     transB = pd.get(0, 0);
+    int8_scale_term = pd.get(18, 0);
+
+    if (int8_scale_term)
+    {
+#if !NCNN_INT8
+        NCNN_LOGE("please build ncnn with NCNN_INT8 enabled for int8 inference");
+        return -1;
+#endif
+    }
 
     return 0;
 }
@@ -37,8 +46,112 @@ static void transpose(const Mat& X, Mat& XT, const Option& opt)
     }
 }
 
-static void matmul_transb(const Mat& A, const Mat& B, Mat& top_blob, const Option& opt)
+#if NCNN_INT8
+static inline signed char float2int8(float v)
+{
+    int int32 = static_cast<int>(round(v));
+    if (int32 > 127) return 127;
+    if (int32 < -127) return -127;
+    return (signed char)int32;
+}
+
+static void matmul_transb_int8(const Mat& A, const Mat& B, Mat& top_blob, const Option& opt)
+{
+    const int M = A.h;
+    const int K = A.w; // assert A.w == B.w
+    const int N = B.h;
+
+    const float* pA = A;
+    const float* pB = B;
+    float* pOut = top_blob;
+
+    // dynamic quantize B per output column
+    // each column is normalized to absmax 1 and quantized with scale 127, the same as the arch gemm path
+    Mat B_int8(K, N, (size_t)1u, 1, opt.workspace_allocator);
+    if (B_int8.empty())
+        return;
+
+    Mat B_absmax(N, (size_t)4u, 1, opt.workspace_allocator);
+    if (B_absmax.empty())
+        return;
+
+    for (int j = 0; j < N; j++)
+    {
+        const float* ptrB = pB + j * K;
+        signed char* ptrB_int8 = B_int8.row<signed char>(j);
+
+        float absmax = 0.f;
+        for (int k = 0; k < K; k++)
+        {
+            absmax = std::max(absmax, (float)fabs(ptrB[k]));
+        }
+
+        if (absmax == 0.f)
+            absmax = 1.f;
+
+        for (int k = 0; k < K; k++)
+        {
+            ptrB_int8[k] = float2int8(ptrB[k] / absmax * 127.f);
+        }
+
+        B_absmax[j] = absmax;
+    }
+
+    Mat A_int8(K, M, (size_t)1u, 1, opt.workspace_allocator);
+    if (A_int8.empty())
+        return;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < M; i++)
+    {
+        const float* ptrA = pA + i * K;
+        signed char* ptrA_int8 = A_int8.row<signed char>(i);
+        float* outptr = pOut + i * N;
+
+        // dynamic quantize A per row
+        float absmax = 0.f;
+        for (int k = 0; k < K; k++)
+        {
+            absmax = std::max(absmax, (float)fabs(ptrA[k]));
+        }
+
+        const float A_int8_scale = absmax == 0.f ? 1.f : 127.f / absmax;
+
+        for (int k = 0; k < K; k++)
+        {
+            ptrA_int8[k] = float2int8(ptrA[k] * A_int8_scale);
+        }
+
+        const float descale = 1.f / (A_int8_scale * 127.f);
+
+        for (int j = 0; j < N; j++)
+        {
+            const signed char* ptrB_int8 = B_int8.row<const signed char>(j);
+
+            int sum = 0;
+            for (int k = 0; k < K; k++)
+            {
+                sum += ptrA_int8[k] * ptrB_int8[k];
+            }
+
+            *outptr++ = sum * descale * B_absmax[j];
+        }
+    }
+}
+#endif // NCNN_INT8
+
+static void matmul_transb(const Mat& A, const Mat& B, Mat& top_blob, int int8_scale_term, const Option& opt)
 {
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        matmul_transb_int8(A, B, top_blob, opt);
+        return;
+    }
+#else
+    (void)int8_scale_term;
+#endif
+
     const int M = A.h;
     const int K = A.w; // assert A.w == B.w
     const int N = B.h;
@@ -87,6 +200,14 @@ int MatMul::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_
             return -100;
 
         const int K = A.w; // assert A.w == B.w
+
+        if (int8_scale_term)
+        {
+            Mat top_blob1 = top_blob.reshape(1, 1);
+            matmul_transb(A.reshape(K, 1), B.reshape(K, 1), top_blob1, int8_scale_term, opt);
+            return 0;
+        }
+
         const float* ptrA = A;
         const float* ptrB = B;
 
@@ -122,7 +243,7 @@ int MatMul::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_
             BT = B;
         }
 
-        matmul_transb(A, BT, top_blob, opt);
+        matmul_transb(A, BT, top_blob, int8_scale_term, opt);
     }
     else if (Adims == 1 && Bdims == 2)
     {
@@ -149,7 +270,7 @@ int MatMul::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_
             BT = B;
         }
 
-        matmul_transb(A1, BT, top_blob1, opt);
+        matmul_transb(A1, BT, top_blob1, int8_scale_term, opt);
 
         top_blob = top_blob1.reshape(N);
     }
@@ -164,7 +285,7 @@ int MatMul::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_
 
         Mat BT = B.reshape(B.w, 1);
 
-        matmul_transb(A, BT, top_blob1, opt);
+        matmul_transb(A, BT, top_blob1, int8_scale_term, opt);
 
         top_blob = top_blob1.reshape(M);
     }
@@ -198,7 +319,7 @@ int MatMul::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_
             }
 
             Mat top_blob1_p = top_blob1.channel(p);
-            matmul_transb(A1, BT, top_blob1_p, opt);
+            matmul_transb(A1, BT, top_blob1_p, int8_scale_term, opt);
         }
 
         if (Bdims == 3)
@@ -222,7 +343,7 @@ int MatMul::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_
         for (int p = 0; p < batch_size; p++)
         {
             Mat top_blob1_p = top_blob1.channel(p);
-            matmul_transb(A1.channel(p), BT, top_blob1_p, opt);
+            matmul_transb(A1.channel(p), BT, top_blob1_p, int8_scale_term, opt);
         }
 
         if (Adims == 3)
@@ -287,7 +408,7 @@ int MatMul::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_
             }
 
             Mat top_blob_p = top_blob.channel(p);
-            matmul_transb(A1.channel(Ap), BT, top_blob_p, opt);
+            matmul_transb(A1.channel(Ap), BT, top_blob_p, int8_scale_term, opt);
         }
     }
     else if (max_ABdims == 4)
@@ -374,7 +495,7 @@ int MatMul::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_
                 }
 
                 Mat top_blob_p_q = top_blob.channel(p).depth(q);
-                matmul_transb(A1.channel(Ap).depth(Ad), BT, top_blob_p_q, opt);
+                matmul_transb(A1.channel(Ap).depth(Ad), BT, top_blob_p_q, int8_scale_term, opt);
             }
         }
     }
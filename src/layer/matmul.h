@@ -19,6 +19,9 @@ public:
 
 public:
     int transB;
+
+    // 0=fp32 2=int8 with dynamic quantization
+    int int8_scale_term;
 };
 
 } // namespace ncnn
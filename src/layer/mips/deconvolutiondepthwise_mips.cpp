@@ -26,6 +26,15 @@ int DeconvolutionDepthWise_mips::create_pipeline(const Option& opt)
     if (dynamic_weight)
         return 0;
 
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        // TODO implement int8, forward runs the reference int8 path on unpacked fp32 blobs
+        support_packing = false;
+        return 0;
+    }
+#endif
+
     const int maxk = kernel_w * kernel_h;
     int channels = (weight_data_size / group) / maxk / (num_output / group) * group;
 
@@ -170,6 +179,13 @@ int DeconvolutionDepthWise_mips::destroy_pipeline(const Option& opt)
 
 int DeconvolutionDepthWise_mips::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+#if NCNN_INT8
+    if (opt.use_int8_inference && int8_scale_term)
+    {
+        return DeconvolutionDepthWise::forward_int8(bottom_blob, top_blob, opt);
+    }
+#endif
+
     // convolv with NxN kernel
     // value = value + bias
 
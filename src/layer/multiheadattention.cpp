@@ -20,6 +20,7 @@ int MultiHeadAttention::load_param(const ParamDict& pd)
     vdim = pd.get(4, embed_dim);
     attn_mask = pd.get(5, 0);
     scale = pd.get(6, 1.f / sqrtf(embed_dim / num_heads));
+    kv_cache = pd.get(7, 0);
     int8_scale_term = pd.get(18, 0);
 
     return 0;
@@ -68,12 +69,64 @@ int MultiHeadAttention::load_model(const ModelBin& mb)
         k_weight_data_int8_scales = mb.load(embed_dim, 1);
         v_weight_data_int8_scales = mb.load(embed_dim, 1);
         out_weight_data_int8_scale = mb.load(1, 1)[0];
+
+        if (int8_scale_term == 3)
+        {
+            bottom_blob_int8_scales = mb.load(3, 1);
+            if (bottom_blob_int8_scales.empty())
+                return -100;
+        }
     }
 #endif // NCNN_INT8
 
     return 0;
 }
 
+// cached keys and values are (embed_dim, seqlen, 1), one row per token in a single channel so that they are never repacked
+// the buffer keeps spare rows behind h and the capacity doubles when full
+// the tokens of each step are appended in place only when this layer holds the only reference to the cache,
+// a cache shared with another step, extractor or the caller is copied into a new buffer first
+int MultiHeadAttention::append_kv_cache(const Mat& cached_blob, int dst_seqlen, Mat& top_blob, const Option& opt) const
+{
+    int past_seqlen = 0;
+    int capacity = 0;
+    if (!cached_blob.empty())
+    {
+        if (cached_blob.w != embed_dim || cached_blob.c != 1 || cached_blob.elemsize != 4u || cached_blob.elempack != 1)
+        {
+            NCNN_LOGE("kv cache shape %d x %d x %d does not match embed_dim %d", cached_blob.w, cached_blob.h, cached_blob.c, embed_dim);
+            return -1;
+        }
+
+        past_seqlen = cached_blob.h;
+        capacity = (int)(cached_blob.cstep / embed_dim);
+    }
+
+    const bool exclusive = cached_blob.refcount && NCNN_XADD(cached_blob.refcount, 0) == 1;
+
+    if (dst_seqlen <= capacity && exclusive)
+    {
+        top_blob = cached_blob;
+        top_blob.h = dst_seqlen;
+        return 0;
+    }
+
+    Mat m;
+    m.create(embed_dim, dst_seqlen <= capacity ? capacity : std::max(dst_seqlen, capacity * 2), 1, 4u, opt.blob_allocator);
+    if (m.empty())
+        return -100;
+
+    if (past_seqlen > 0)
+    {
+        memcpy(m.data, cached_blob.data, (size_t)embed_dim * past_seqlen * sizeof(float));
+    }
+
+    top_blob = m;
+    top_blob.h = dst_seqlen;
+
+    return 0;
+}
+
 // refers to https://pytorch.org/docs/stable/generated/torch.nn.MultiheadAttention.html
 int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
@@ -84,13 +137,22 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
     }
 #endif
 
+    // the cached keys and values follow the inputs when the updated cache is requested
+    const bool use_kv_cache = kv_cache && top_blobs.size() == 3;
+    const size_t input_blob_count = use_kv_cache ? bottom_blobs.size() - 2 : bottom_blobs.size();
+
     const Mat& q_blob = bottom_blobs[0];
-    const Mat& k_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
-    const Mat& v_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : (bottom_blobs.size() == 2 || (bottom_blobs.size() == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
-    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blobs.size() - 1] : Mat();
+    const Mat& k_blob = (input_blob_count == 1 || (input_blob_count == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
+    const Mat& v_blob = (input_blob_count == 1 || (input_blob_count == 2 && attn_mask)) ? q_blob : (input_blob_count == 2 || (input_blob_count == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
+    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[input_blob_count - 1] : Mat();
+    const Mat& cached_k_blob = use_kv_cache ? bottom_blobs[input_blob_count] : Mat();
+    const Mat& cached_v_blob = use_kv_cache ? bottom_blobs[input_blob_count + 1] : Mat();
+
+    // projected keys and values of the past tokens, empty for the first step
+    const int past_seqlen = cached_k_blob.empty() ? 0 : cached_k_blob.h;
 
     const int src_seqlen = q_blob.h;
-    const int dst_seqlen = k_blob.h;
+    const int dst_seqlen = past_seqlen + k_blob.h;
     const int embed_dim_per_head = embed_dim / num_heads;
     const int qdim = weight_data_size / embed_dim;
 
@@ -104,12 +166,32 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
     Mat xq(embed_dim_per_head, src_seqlen, num_heads, 4u, opt.workspace_allocator);
     if (xq.empty())
         return -100;
-    Mat xk(embed_dim_per_head, dst_seqlen, num_heads, 4u, opt.workspace_allocator);
-    if (xk.empty())
-        return -100;
-    Mat xv(dst_seqlen, embed_dim_per_head, num_heads, 4u, opt.workspace_allocator);
-    if (xv.empty())
-        return -100;
+
+    // keys and values of all tokens, one row of embed_dim per token, the new tokens go behind the cached ones
+    Mat xk;
+    Mat xv;
+    if (use_kv_cache)
+    {
+        int ret = append_kv_cache(cached_k_blob, dst_seqlen, top_blobs[1], opt);
+        if (ret != 0)
+            return ret;
+
+        ret = append_kv_cache(cached_v_blob, dst_seqlen, top_blobs[2], opt);
+        if (ret != 0)
+            return ret;
+
+        xk = top_blobs[1];
+        xv = top_blobs[2];
+    }
+    else
+    {
+        xk.create(embed_dim, dst_seqlen, 4u, opt.workspace_allocator);
+        if (xk.empty())
+            return -100;
+        xv.create(embed_dim, dst_seqlen, 4u, opt.workspace_allocator);
+        if (xv.empty())
+            return -100;
+    }
 
     Mat xqk(dst_seqlen, src_seqlen, num_heads, 4u, opt.workspace_allocator);
     if (xqk.empty())
@@ -148,11 +230,9 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
 
         // xk = affine(k)
         {
-            Mat outm = xk.channel(q);
-
-            for (int i = 0; i < dst_seqlen; i++)
+            for (int i = 0; i < k_blob.h; i++)
             {
-                float* outptr = outm.row(i);
+                float* outptr = xk.row(past_seqlen + i) + q * embed_dim_per_head;
 
                 for (int j = 0; j < embed_dim_per_head; j++)
                 {
@@ -172,23 +252,21 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
 
         // xv = affine(v)
         {
-            Mat outm = xv.channel(q);
-
-            for (int i = 0; i < embed_dim_per_head; i++)
+            for (int i = 0; i < v_blob.h; i++)
             {
-                for (int j = 0; j < dst_seqlen; j++)
+                float* outptr = xv.row(past_seqlen + i) + q * embed_dim_per_head;
+
+                for (int j = 0; j < embed_dim_per_head; j++)
                 {
-                    const float* ptr = v_blob.row(j);
-                    const float* kptr = (const float*)v_weight_data + vdim * (q * embed_dim_per_head + i);
+                    const float* ptr = v_blob.row(i);
+                    const float* kptr = (const float*)v_weight_data + vdim * (q * embed_dim_per_head + j);
 
-                    float sum = v_bias_data[q * embed_dim_per_head + i];
+                    float sum = v_bias_data[q * embed_dim_per_head + j];
                     for (int k = 0; k < vdim; k++)
                     {
                         sum += *ptr++ * *kptr++;
                     }
 
-                    float* outptr = outm.row(i);
-
                     outptr[j] = sum;
                 }
             }
@@ -196,10 +274,9 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
 
         // xqk = xq * xk
         // xq  (embed_dim_per_head, src_seqlen)
-        // xk  (embed_dim_per_head, dst_seqlen)
+        // xk  (embed_dim, dst_seqlen), the head starts at column q * embed_dim_per_head
         {
             const Mat xqm = xq.channel(q);
-            const Mat xkm = xk.channel(q);
 
             Mat outm = xqk.channel(q);
 
@@ -210,7 +287,7 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
                 for (int j = 0; j < dst_seqlen; j++)
                 {
                     const float* qptr = xqm.row(i);
-                    const float* kptr = xkm.row(j);
+                    const float* kptr = xk.row(j) + q * embed_dim_per_head;
 
                     float sum = 0.f;
                     for (int k = 0; k < embed_dim_per_head; k++)
@@ -271,11 +348,10 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
 
         // xqkv = xqk * xv
         // xqk (dst_seqlen, src_seqlen)
-        // xv  (dst_seqlen, embed_dim_per_head)
+        // xv  (embed_dim, dst_seqlen), the head starts at column q * embed_dim_per_head
         // out (embed_dim_per_head, num_heads, src_seqlen)
         {
             const Mat xqkm = xqk.channel(q);
-            const Mat xvm = xv.channel(q);
 
             for (int i = 0; i < src_seqlen; i++)
             {
@@ -284,12 +360,11 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
                 for (int j = 0; j < embed_dim_per_head; j++)
                 {
                     const float* qkptr = xqkm.row(i);
-                    const float* vptr = xvm.row(j);
 
                     float sum = 0.f;
                     for (int k = 0; k < dst_seqlen; k++)
                     {
-                        sum += *qkptr++ * *vptr++;
+                        sum += qkptr[k] * xv.row(k)[q * embed_dim_per_head + j];
                     }
 
                     outptr[j] = sum;
@@ -361,6 +436,31 @@ static void dynamic_quantize_2d(const Mat& blob, Mat& blob_int8, float& scale, c
     }
 }
 
+// quantize with the calibrated scale, dynamic quantize if it is zero
+static void static_quantize_2d(const Mat& blob, Mat& blob_int8, float& scale, float static_scale, const Option& opt)
+{
+    if (static_scale == 0.f)
+    {
+        dynamic_quantize_2d(blob, blob_int8, scale, opt);
+        return;
+    }
+
+    blob_int8.create(blob.w, blob.h, (size_t)1u, 1, opt.workspace_allocator);
+
+    scale = static_scale;
+
+    for (int i = 0; i < blob_int8.h; i++)
+    {
+        const float* ptr = blob.row(i);
+        signed char* outptr = blob_int8.row<signed char>(i);
+
+        for (int j = 0; j < blob_int8.w; j++)
+        {
+            outptr[j] = float2int8(ptr[j] * scale);
+        }
+    }
+}
+
 static void dynamic_quantize_2d_per_h(const Mat& blob, Mat& blob_int8, Mat& scales, const Option& opt)
 {
     blob_int8.create(blob.w, blob.h, (size_t)1u, 1, opt.workspace_allocator);
@@ -394,13 +494,22 @@ static void dynamic_quantize_2d_per_h(const Mat& blob, Mat& blob_int8, Mat& scal
 
 int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
+    // the cached keys and values follow the inputs when the updated cache is requested
+    const bool use_kv_cache = kv_cache && top_blobs.size() == 3;
+    const size_t input_blob_count = use_kv_cache ? bottom_blobs.size() - 2 : bottom_blobs.size();
+
     const Mat& q_blob = bottom_blobs[0];
-    const Mat& k_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
-    const Mat& v_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : (bottom_blobs.size() == 2 || (bottom_blobs.size() == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
-    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blobs.size() - 1] : Mat();
+    const Mat& k_blob = (input_blob_count == 1 || (input_blob_count == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
+    const Mat& v_blob = (input_blob_count == 1 || (input_blob_count == 2 && attn_mask)) ? q_blob : (input_blob_count == 2 || (input_blob_count == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
+    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[input_blob_count - 1] : Mat();
+    const Mat& cached_k_blob = use_kv_cache ? bottom_blobs[input_blob_count] : Mat();
+    const Mat& cached_v_blob = use_kv_cache ? bottom_blobs[input_blob_count + 1] : Mat();
+
+    // projected keys and values of the past tokens, empty for the first step
+    const int past_seqlen = cached_k_blob.empty() ? 0 : cached_k_blob.h;
 
     const int src_seqlen = q_blob.h;
-    const int dst_seqlen = k_blob.h;
+    const int dst_seqlen = past_seqlen + k_blob.h;
     const int embed_dim_per_head = embed_dim / num_heads;
     const int qdim = weight_data_size / embed_dim;
 
@@ -414,12 +523,32 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
     Mat xq(embed_dim_per_head, src_seqlen, num_heads, 4u, opt.workspace_allocator);
     if (xq.empty())
         return -100;
-    Mat xk(embed_dim_per_head, dst_seqlen, num_heads, 4u, opt.workspace_allocator);
-    if (xk.empty())
-        return -100;
-    Mat xv(dst_seqlen, embed_dim_per_head, num_heads, 4u, opt.workspace_allocator);
-    if (xv.empty())
-        return -100;
+
+    // keys and values of all tokens, one row of embed_dim per token, the new tokens go behind the cached ones
+    Mat xk;
+    Mat xv;
+    if (use_kv_cache)
+    {
+        int ret = append_kv_cache(cached_k_blob, dst_seqlen, top_blobs[1], opt);
+        if (ret != 0)
+            return ret;
+
+        ret = append_kv_cache(cached_v_blob, dst_seqlen, top_blobs[2], opt);
+        if (ret != 0)
+            return ret;
+
+        xk = top_blobs[1];
+        xv = top_blobs[2];
+    }
+    else
+    {
+        xk.create(embed_dim, dst_seqlen, 4u, opt.workspace_allocator);
+        if (xk.empty())
+            return -100;
+        xv.create(embed_dim, dst_seqlen, 4u, opt.workspace_allocator);
+        if (xv.empty())
+            return -100;
+    }
 
     Mat xqk(dst_seqlen, src_seqlen, num_heads, 4u, opt.workspace_allocator);
     if (xqk.empty())
@@ -429,40 +558,60 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
     if (xqkv.empty())
         return -100;
 
-    // dynamic quantize q_blob
+    // keys and transposed values of each head, gathered from the head columns
+    Mat xkh(embed_dim_per_head, dst_seqlen, num_heads, 4u, opt.workspace_allocator);
+    if (xkh.empty())
+        return -100;
+
+    Mat xvh(dst_seqlen, embed_dim_per_head, num_heads, 4u, opt.workspace_allocator);
+    if (xvh.empty())
+        return -100;
+
+    // static input scales from calibration, 0 for dynamic quantize
+    float q_static_int8_scale = 0.f;
+    float k_static_int8_scale = 0.f;
+    float v_static_int8_scale = 0.f;
+    if (int8_scale_term == 3)
+    {
+        q_static_int8_scale = bottom_blob_int8_scales[0];
+        k_static_int8_scale = bottom_blob_int8_scales[1];
+        v_static_int8_scale = bottom_blob_int8_scales[2];
+    }
+
+    // quantize q_blob
     Mat q_blob_int8;
     float q_blob_int8_scale;
-    dynamic_quantize_2d(q_blob, q_blob_int8, q_blob_int8_scale, opt);
+    static_quantize_2d(q_blob, q_blob_int8, q_blob_int8_scale, q_static_int8_scale, opt);
 
-    // dynamic quantize k_blob
+    // quantize k_blob
     Mat k_blob_int8;
     float k_blob_int8_scale;
-    if (bottom_blobs.size() == 1)
+    if (input_blob_count == 1)
     {
         k_blob_int8 = q_blob_int8;
         k_blob_int8_scale = q_blob_int8_scale;
     }
     else
     {
-        dynamic_quantize_2d(k_blob, k_blob_int8, k_blob_int8_scale, opt);
+        static_quantize_2d(k_blob, k_blob_int8, k_blob_int8_scale, k_static_int8_scale, opt);
     }
 
-    // dynamic quantize v_blob
+    // quantize v_blob
     Mat v_blob_int8;
     float v_blob_int8_scale;
-    if (bottom_blobs.size() == 1)
+    if (input_blob_count == 1)
     {
         v_blob_int8 = q_blob_int8;
         v_blob_int8_scale = q_blob_int8_scale;
     }
-    else if (bottom_blobs.size() == 2)
+    else if (input_blob_count == 2)
     {
         v_blob_int8 = k_blob_int8;
         v_blob_int8_scale = k_blob_int8_scale;
     }
     else
     {
-        dynamic_quantize_2d(v_blob, v_blob_int8, v_blob_int8_scale, opt);
+        static_quantize_2d(v_blob, v_blob_int8, v_blob_int8_scale, v_static_int8_scale, opt);
     }
 
     // NCNN_LOGE("%.4f %.4f", q_weight_data_int8_scale, q_blob_int8_scale);
@@ -498,10 +647,10 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
 
         // xk = affine(k)
         {
-            float* outptr = xk.channel(q);
-
             for (int i = 0; i < k_blob_int8.h; i++)
             {
+                float* outptr = xk.row(past_seqlen + i) + q * embed_dim_per_head;
+
                 for (int j = 0; j < embed_dim_per_head; j++)
                 {
                     const signed char* ptr = k_blob_int8.row<const signed char>(i);
@@ -522,24 +671,22 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
 
         // xv = affine(v)
         {
-            Mat outm = xv.channel(q);
-
-            for (int i = 0; i < embed_dim_per_head; i++)
+            for (int i = 0; i < v_blob_int8.h; i++)
             {
-                float* outptr = outm.row(i);
+                float* outptr = xv.row(past_seqlen + i) + q * embed_dim_per_head;
 
-                for (int j = 0; j < v_blob_int8.h; j++)
+                for (int j = 0; j < embed_dim_per_head; j++)
                 {
-                    const signed char* ptr = v_blob_int8.row<const signed char>(j);
-                    const signed char* kptr = (const signed char*)v_weight_data + vdim * (q * embed_dim_per_head + i);
+                    const signed char* ptr = v_blob_int8.row<const signed char>(i);
+                    const signed char* kptr = (const signed char*)v_weight_data + vdim * (q * embed_dim_per_head + j);
 
                     int sum = 0;
                     for (int k = 0; k < vdim; k++)
                     {
                         sum += *ptr++ * *kptr++;
                     }
-                    const float v_descale = 1.f / (v_weight_data_int8_scales[q * embed_dim_per_head + i] * v_blob_int8_scale);
-                    float sum_fp32 = sum * v_descale + v_bias_data[q * embed_dim_per_head + i];
+                    const float v_descale = 1.f / (v_weight_data_int8_scales[q * embed_dim_per_head + j] * v_blob_int8_scale);
+                    float sum_fp32 = sum * v_descale + v_bias_data[q * embed_dim_per_head + j];
 
                     *outptr++ = sum_fp32;
                 }
@@ -548,10 +695,15 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
 
         // xqk = xq * xk
         // xq  (embed_dim_per_head, src_seqlen)
-        // xk  (embed_dim_per_head, dst_seqlen)
+        // xk  (embed_dim_per_head, dst_seqlen), gathered from the head columns
         {
             const Mat xqm = xq.channel(q);
-            const Mat xkm = xk.channel(q);
+
+            Mat xkm = xkh.channel(q);
+            for (int j = 0; j < dst_seqlen; j++)
+            {
+                memcpy(xkm.row(j), xk.row(j) + q * embed_dim_per_head, embed_dim_per_head * sizeof(float));
+            }
 
             Mat outm = xqk.channel(q);
 
@@ -635,11 +787,20 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
 
         // xqkv = xqk * xv
         // xqk (dst_seqlen, src_seqlen)
-        // xv  (dst_seqlen, embed_dim_per_head)
+        // xv  (dst_seqlen, embed_dim_per_head), gathered from the head columns
         // out (embed_dim_per_head, num_heads, src_seqlen)
         {
             const Mat xqkm = xqk.channel(q);
-            const Mat xvm = xv.channel(q);
+
+            Mat xvm = xvh.channel(q);
+            for (int i = 0; i < embed_dim_per_head; i++)
+            {
+                float* outptr = xvm.row(i);
+                for (int j = 0; j < dst_seqlen; j++)
+                {
+                    outptr[j] = xv.row(j)[q * embed_dim_per_head + i];
+                }
+            }
 
             // dynamic quantize xqkm
             Mat xqkm_int8;
@@ -20,6 +20,8 @@ public:
     virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 
 protected:
+    int append_kv_cache(const Mat& cached_blob, int dst_seqlen, Mat& top_blob, const Option& opt) const;
+
 #if NCNN_INT8
     int forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 #endif
@@ -32,8 +34,9 @@ public:
     int vdim;
     int attn_mask;
     float scale;
+    int kv_cache;
 
-    int int8_scale_term;
+    int int8_scale_term; // 2=dynamic input quantization 3=static input scales
 
     Mat q_weight_data;
     Mat q_bias_data;
@@ -49,6 +52,9 @@ public:
     Mat k_weight_data_int8_scales;
     Mat v_weight_data_int8_scales;
     float out_weight_data_int8_scale;
+
+    // static scales of the q k v inputs
+    Mat bottom_blob_int8_scales;
 #endif
 };
 
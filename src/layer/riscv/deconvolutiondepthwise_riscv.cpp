@@ -34,6 +34,16 @@ int DeconvolutionDepthWise_riscv::create_pipeline(const Option& opt)
     if (dynamic_weight)
         return 0;
 
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        // TODO implement int8, forward runs the reference int8 path on unpacked fp32 blobs
+        support_packing = false;
+        support_fp16_storage = false;
+        return 0;
+    }
+#endif
+
 #if NCNN_ZFH
     if (support_fp16_storage && opt.use_fp16_storage)
     {
@@ -189,6 +199,13 @@ int DeconvolutionDepthWise_riscv::destroy_pipeline(const Option& opt)
 
 int DeconvolutionDepthWise_riscv::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+#if NCNN_INT8
+    if (opt.use_int8_inference && int8_scale_term)
+    {
+        return DeconvolutionDepthWise::forward_int8(bottom_blob, top_blob, opt);
+    }
+#endif
+
 #if NCNN_ZFH
     int elembits = bottom_blob.elembits();
 
@@ -10,6 +10,7 @@
 #include "riscv_usability.h"
 
 #include "cpu.h"
+#include "weight_quant.h"
 
 namespace ncnn {
 
@@ -1850,6 +1851,37 @@ int Gemm_riscv::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt
 
 int Gemm_riscv::create_pipeline(const Option& opt)
 {
+    if (weight_quant_bits)
+    {
+        // expand the weight-only quantized constant A or B to float32
+        Option opt_dequant = opt;
+        opt_dequant.blob_allocator = 0;
+
+        if (constantA)
+        {
+            Mat A_data_fp32;
+            dequantize_weight_quant(A_data, A_data_quant_scales, A_data_fp32, constantK, weight_quant_bits, weight_quant_group_size, opt_dequant);
+            if (A_data_fp32.empty())
+                return -100;
+
+            A_data = A_data_fp32;
+        }
+
+        if (constantB)
+        {
+            Mat B_data_fp32;
+            dequantize_weight_quant(B_data, B_data_quant_scales, B_data_fp32, constantK, weight_quant_bits, weight_quant_group_size, opt_dequant);
+            if (B_data_fp32.empty())
+                return -100;
+
+            B_data = B_data_fp32;
+        }
+
+        A_data_quant_scales.release();
+        B_data_quant_scales.release();
+        weight_quant_bits = 0;
+    }
+
 #if NCNN_INT8
     if (int8_scale_term)
     {
@@ -2129,7 +2161,7 @@ int Gemm_riscv::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
         return -100;
 
     int _nT = nT ? nT : opt.num_threads;
-    if (nT != 0 && opt.num_threads != nT)
+    if (nT != 0 && opt.num_threads != nT && !opt.use_parallel_branch)
     {
         // force num_threads the same as in create_pipeline
         // so we could use pre-packed A/B from the same tile config
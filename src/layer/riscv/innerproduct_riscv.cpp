@@ -12,6 +12,7 @@
 #include "riscv_usability.h"
 
 #include "cpu.h"
+#include "weight_quant.h"
 
 namespace ncnn {
 
@@ -33,6 +34,22 @@ InnerProduct_riscv::InnerProduct_riscv()
 
 int InnerProduct_riscv::create_pipeline(const Option& opt)
 {
+    if (weight_quant_bits)
+    {
+        // expand the weight-only quantized weight to float32
+        Option opt_dequant = opt;
+        opt_dequant.blob_allocator = 0;
+
+        Mat weight_data_fp32;
+        dequantize_weight_quant(weight_data, weight_data_quant_scales, weight_data_fp32, weight_data_size / num_output, weight_quant_bits, weight_quant_group_size, opt_dequant);
+        if (weight_data_fp32.empty())
+            return -100;
+
+        weight_data = weight_data_fp32.reshape(weight_data_size);
+        weight_data_quant_scales.release();
+        weight_quant_bits = 0;
+    }
+
     {
         flatten = ncnn::create_layer_cpu(ncnn::LayerType::Flatten);
 
@@ -26,7 +26,7 @@ public:
     int weight_data_size;
     int direction; // 0=forward 1=reverse 2=bidirectional
 
-    int int8_scale_term;
+    int int8_scale_term; // 2=dynamic input quantization 3=static input scale
 
     Mat weight_hc_data;
     Mat weight_xc_data;
@@ -35,6 +35,9 @@ public:
 #if NCNN_INT8
     Mat weight_hc_data_int8_scales;
     Mat weight_xc_data_int8_scales;
+
+    // static scale of the input sequence
+    Mat bottom_blob_int8_scales;
 #endif
 };
 
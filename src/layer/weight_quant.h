@@ -0,0 +1,160 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef WEIGHT_QUANT_H
+#define WEIGHT_QUANT_H
+
+#include "mat.h"
+#include "option.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+// weight-only quantized data keeps one row per output channel with K values along the input
+// bits = 8, one signed value per byte
+// bits = 4, two values per byte with the low nibble first, each stored as value + 8
+// the values of a row are split into groups of group_size, the last group may be shorter
+// group_size = 0 puts the whole row in one group
+// scales hold one float per group, value = round(weight * scale)
+// scale = 127 / absmax for int8 and 7 / absmax for int4
+
+static inline int weight_quant_group_count(int K, int group_size)
+{
+    return group_size == 0 ? 1 : (K + group_size - 1) / group_size;
+}
+
+static inline int weight_quant_row_bytes(int K, int bits)
+{
+    return bits == 4 ? (K + 1) / 2 : K;
+}
+
+static inline int weight_quant_value(const unsigned char* ptr, int k, int bits)
+{
+    if (bits == 4)
+    {
+        const unsigned char v = ptr[k / 2];
+        return (k % 2 == 0 ? (v & 15) : (v >> 4)) - 8;
+    }
+
+    return ((const signed char*)ptr)[k];
+}
+
+// dot product of n float32 values with the weight-only quantized row ptr starting at value k0
+// scales is the scale row of ptr
+static inline float dot_weight_quant_row(const float* x, const unsigned char* ptr, const float* scales, int k0, int n, int bits, int group_size)
+{
+    float sum = 0.f;
+
+    int k = k0;
+    while (k < k0 + n)
+    {
+        const int g = group_size == 0 ? 0 : k / group_size;
+        const int k_end = group_size == 0 ? k0 + n : std::min(k0 + n, (g + 1) * group_size);
+
+        const float descale = scales[g] == 0.f ? 0.f : 1.f / scales[g];
+
+        for (; k < k_end; k++)
+        {
+            sum += x[k - k0] * (weight_quant_value(ptr, k, bits) * descale);
+        }
+    }
+
+    return sum;
+}
+
+// weight  rows of weight_quant_row_bytes(K, bits), elemsize 1
+// scales  rows of weight_quant_group_count(K, group_size)
+// expand to float32 rows of K allocated from opt.blob_allocator
+static inline int dequantize_weight_quant(const ncnn::Mat& weight, const ncnn::Mat& scales, ncnn::Mat& weight_fp32, int K, int bits, int group_size, const ncnn::Option& opt)
+{
+    const int rows = weight.h;
+    const int group_count = weight_quant_group_count(K, group_size);
+    const int gs = group_size == 0 ? K : group_size;
+
+    weight_fp32.create(K, rows, 4u, opt.blob_allocator);
+    if (weight_fp32.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < rows; i++)
+    {
+        const unsigned char* ptr = weight.row<const unsigned char>(i);
+        const float* scales_ptr = scales.row(i);
+        float* outptr = weight_fp32.row(i);
+
+        for (int g = 0; g < group_count; g++)
+        {
+            const float descale = scales_ptr[g] == 0.f ? 0.f : 1.f / scales_ptr[g];
+
+            const int k_end = std::min(K, (g + 1) * gs);
+            for (int k = g * gs; k < k_end; k++)
+            {
+                outptr[k] = weight_quant_value(ptr, k, bits) * descale;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// rows of K float32 values to weight-only quantized rows and scales
+static inline int quantize_weight_quant(const ncnn::Mat& weight_fp32, ncnn::Mat& weight, ncnn::Mat& scales, int K, int bits, int group_size, const ncnn::Option& opt)
+{
+    const int rows = weight_fp32.h;
+    const int group_count = weight_quant_group_count(K, group_size);
+    const int gs = group_size == 0 ? K : group_size;
+    const float qmax = bits == 4 ? 7.f : 127.f;
+
+    weight.create(weight_quant_row_bytes(K, bits), rows, (size_t)1u, opt.blob_allocator);
+    if (weight.empty())
+        return -100;
+
+    scales.create(group_count, rows, 4u, opt.blob_allocator);
+    if (scales.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < rows; i++)
+    {
+        const float* ptr = weight_fp32.row(i);
+        unsigned char* outptr = weight.row<unsigned char>(i);
+        float* scales_ptr = scales.row(i);
+
+        memset(outptr, 0, weight.w);
+
+        for (int g = 0; g < group_count; g++)
+        {
+            const int k_end = std::min(K, (g + 1) * gs);
+
+            float absmax = 0.f;
+            for (int k = g * gs; k < k_end; k++)
+            {
+                absmax = std::max(absmax, (float)fabs(ptr[k]));
+            }
+
+            const float scale = absmax == 0.f ? 1.f : qmax / absmax;
+            scales_ptr[g] = scale;
+
+            for (int k = g * gs; k < k_end; k++)
+            {
+                int v = static_cast<int>(round(ptr[k] * scale));
+                v = std::min(std::max(v, (int)-qmax), (int)qmax);
+
+                if (bits == 4)
+                {
+                    outptr[k / 2] |= (unsigned char)((v + 8) << (k % 2 * 4));
+                }
+                else
+                {
+                    ((signed char*)outptr)[k] = (signed char)v;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+#endif // WEIGHT_QUANT_H
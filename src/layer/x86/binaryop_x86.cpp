@@ -22,6 +22,9 @@ BinaryOp_x86::BinaryOp_x86()
 #if __SSE2__
     support_packing = true;
 #endif // __SSE2__
+#if NCNN_BF16
+    support_bf16_storage = true;
+#endif
 }
 
 template<typename Op>
@@ -796,6 +799,128 @@ static void binary_op_vector(const float* ptr, const float* ptr1, float* outptr,
     // should never reach here
 }
 
+#if NCNN_BF16
+static void bfloat2float_vector(const unsigned short* ptr, float* outptr, int size)
+{
+    int i = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    for (; i + 15 < size; i += 16)
+    {
+        _mm512_storeu_ps(outptr, bfloat2float_avx512(_mm256_loadu_si256((const __m256i*)ptr)));
+        ptr += 16;
+        outptr += 16;
+    }
+#endif // __AVX512F__
+    for (; i + 7 < size; i += 8)
+    {
+        _mm256_storeu_ps(outptr, bfloat2float_avx(_mm_loadu_si128((const __m128i*)ptr)));
+        ptr += 8;
+        outptr += 8;
+    }
+#endif // __AVX__
+    for (; i + 3 < size; i += 4)
+    {
+        _mm_storeu_ps(outptr, bfloat2float_sse(_mm_loadl_epi64((const __m128i*)ptr)));
+        ptr += 4;
+        outptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        *outptr++ = bfloat16_to_float32(*ptr++);
+    }
+}
+
+static void float2bfloat_vector(const float* ptr, unsigned short* outptr, int size)
+{
+    int i = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    for (; i + 15 < size; i += 16)
+    {
+        _mm256_storeu_si256((__m256i*)outptr, float2bfloat_avx512(_mm512_loadu_ps(ptr)));
+        ptr += 16;
+        outptr += 16;
+    }
+#endif // __AVX512F__
+    for (; i + 7 < size; i += 8)
+    {
+        _mm_storeu_si128((__m128i*)outptr, float2bfloat_avx(_mm256_loadu_ps(ptr)));
+        ptr += 8;
+        outptr += 8;
+    }
+#endif // __AVX__
+    for (; i + 3 < size; i += 4)
+    {
+        __m128 _p = _mm_loadu_ps(ptr);
+        _mm_storel_epi64((__m128i*)outptr, float2bfloat_sse(_p, _p));
+        ptr += 4;
+        outptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        *outptr++ = float32_to_bfloat16(*ptr++);
+    }
+}
+
+// bf16 rows are widened tile by tile into L1 resident scratch and run through the fp32 kernels
+#define BINARYOP_BF16S_TILE 64
+
+static void binary_op_vector(const unsigned short* ptr, const unsigned short* ptr1, unsigned short* outptr, int aw, int bw, int ap, int bp, int op_type)
+{
+    const int w = std::max(aw, bw);
+    const int elempack = std::max(ap, bp);
+
+    float tmp[3][BINARYOP_BF16S_TILE * 16];
+
+    for (int j = 0; j < w; j += BINARYOP_BF16S_TILE)
+    {
+        const int n = std::min(BINARYOP_BF16S_TILE, w - j);
+        const int tile_aw = aw == 1 ? 1 : n;
+        const int tile_bw = bw == 1 ? 1 : n;
+
+        bfloat2float_vector(aw == 1 ? ptr : ptr + j * ap, tmp[0], tile_aw * ap);
+        bfloat2float_vector(bw == 1 ? ptr1 : ptr1 + j * bp, tmp[1], tile_bw * bp);
+        binary_op_vector(tmp[0], tmp[1], tmp[2], tile_aw, tile_bw, ap, bp, op_type);
+        float2bfloat_vector(tmp[2], outptr + j * elempack, n * elempack);
+    }
+}
+
+static void binary_op_vector_scalar_b(const unsigned short* ptr, float b, unsigned short* outptr, int size, int op_type)
+{
+    float tmp[2][BINARYOP_BF16S_TILE * 16];
+
+    for (int j = 0; j < size; j += BINARYOP_BF16S_TILE * 16)
+    {
+        const int n = std::min(BINARYOP_BF16S_TILE * 16, size - j);
+
+        bfloat2float_vector(ptr + j, tmp[0], n);
+        binary_op_vector(tmp[0], &b, tmp[1], n, 1, 1, 1, op_type);
+        float2bfloat_vector(tmp[1], outptr + j, n);
+    }
+}
+
+static float scalar_value(const unsigned short* ptr)
+{
+    return bfloat16_to_float32(ptr[0]);
+}
+#endif // NCNN_BF16
+
+static void binary_op_vector_scalar_b(const float* ptr, float b, float* outptr, int size, int op_type)
+{
+    binary_op_vector(ptr, &b, outptr, size, 1, 1, 1, op_type);
+}
+
+static float scalar_value(const float* ptr)
+{
+    return ptr[0];
+}
+
+template<typename T>
 static void binary_op_scalar(const Mat& a, float b, Mat& c, int op_type, const Option& opt)
 {
     const int channels = a.c;
@@ -804,13 +929,14 @@ static void binary_op_scalar(const Mat& a, float b, Mat& c, int op_type, const O
     #pragma omp parallel for num_threads(opt.num_threads)
     for (int q = 0; q < channels; q++)
     {
-        const float* ptr = a.channel(q);
-        float* outptr = c.channel(q);
+        const T* ptr = a.channel(q);
+        T* outptr = c.channel(q);
 
-        binary_op_vector(ptr, &b, outptr, size, 1, 1, 1, op_type);
+        binary_op_vector_scalar_b(ptr, b, outptr, size, op_type);
     }
 }
 
+template<typename T>
 static void binary_op_no_broadcast(const Mat& a, const Mat& b, Mat& c, int op_type, const Option& opt)
 {
     const int channels = a.c;
@@ -819,24 +945,25 @@ static void binary_op_no_broadcast(const Mat& a, const Mat& b, Mat& c, int op_ty
     #pragma omp parallel for num_threads(opt.num_threads)
     for (int q = 0; q < channels; q++)
     {
-        const float* ptr = a.channel(q);
-        const float* ptr1 = b.channel(q);
-        float* outptr = c.channel(q);
+        const T* ptr = a.channel(q);
+        const T* ptr1 = b.channel(q);
+        T* outptr = c.channel(q);
 
         binary_op_vector(ptr, ptr1, outptr, size, size, 1, 1, op_type);
     }
 }
 
+template<typename T>
 static void binary_op_broadcast(const Mat& a, const Mat& b, Mat& c, int op_type, const Option& opt)
 {
     if (b.w * b.h * b.d * b.c * b.elempack == 1)
     {
-        return binary_op_scalar(a, b[0], c, op_type, opt);
+        return binary_op_scalar<T>(a, scalar_value((const T*)b), c, op_type, opt);
     }
 
     if (a.dims == b.dims && a.w == b.w && a.h == b.h && a.d == b.d && a.c == b.c && a.elempack == b.elempack)
     {
-        return binary_op_no_broadcast(a, b, c, op_type, opt);
+        return binary_op_no_broadcast<T>(a, b, c, op_type, opt);
     }
 
     const int dims = c.dims;
@@ -851,9 +978,9 @@ static void binary_op_broadcast(const Mat& a, const Mat& b, Mat& c, int op_type,
             const int y0 = std::min(y, a.h - 1);
             const int y1 = std::min(y, b.h - 1);
 
-            const float* ptr = a.row(y0);
-            const float* ptr1 = b.row(y1);
-            float* outptr = c.row(y);
+            const T* ptr = a.row<const T>(y0);
+            const T* ptr1 = b.row<const T>(y1);
+            T* outptr = c.row<T>(y);
 
             binary_op_vector(ptr, ptr1, outptr, a.w, b.w, a.elempack, b.elempack, op_type);
         }
@@ -871,9 +998,9 @@ static void binary_op_broadcast(const Mat& a, const Mat& b, Mat& c, int op_type,
 
             if (b.d * b.h * b.w == 1)
             {
-                const float* ptr = a.channel(q0);
-                const float* ptr1 = b.channel(q1);
-                float* outptr = c.channel(q);
+                const T* ptr = a.channel(q0);
+                const T* ptr1 = b.channel(q1);
+                T* outptr = c.channel(q);
 
                 binary_op_vector(ptr, ptr1, outptr, a.w * a.h * a.d, 1, a.elempack, b.elempack, op_type);
                 continue;
@@ -886,9 +1013,9 @@ static void binary_op_broadcast(const Mat& a, const Mat& b, Mat& c, int op_type,
                     const int z0 = std::min(z, a.d - 1);
                     const int z1 = std::min(z, b.d - 1);
 
-                    const float* ptr = a.channel(q0).depth(z0);
-                    const float* ptr1 = b.channel(q1).depth(z1);
-                    float* outptr = c.channel(q).depth(z);
+                    const T* ptr = a.channel(q0).depth(z0);
+                    const T* ptr1 = b.channel(q1).depth(z1);
+                    T* outptr = c.channel(q).depth(z);
 
                     binary_op_vector(ptr, ptr1, outptr, a.w * a.h, 1, a.elempack, b.elempack, op_type);
                 }
@@ -905,9 +1032,9 @@ static void binary_op_broadcast(const Mat& a, const Mat& b, Mat& c, int op_type,
                     const int y0 = std::min(y, a.h - 1);
                     const int y1 = std::min(y, b.h - 1);
 
-                    const float* ptr = a.channel(q0).depth(z0).row(y0);
-                    const float* ptr1 = b.channel(q1).depth(z1).row(y1);
-                    float* outptr = c.channel(q).depth(z).row(y);
+                    const T* ptr = a.channel(q0).depth(z0).row<const T>(y0);
+                    const T* ptr1 = b.channel(q1).depth(z1).row<const T>(y1);
+                    T* outptr = c.channel(q).depth(z).row<T>(y);
 
                     binary_op_vector(ptr, ptr1, outptr, a.w, b.w, a.elempack, b.elempack, op_type);
                 }
@@ -916,6 +1043,7 @@ static void binary_op_broadcast(const Mat& a, const Mat& b, Mat& c, int op_type,
     }
 }
 
+template<typename T>
 static void binary_op_scalar_inplace(Mat& a, float b, int op_type, const Option& opt)
 {
     const int channels = a.c;
@@ -924,9 +1052,9 @@ static void binary_op_scalar_inplace(Mat& a, float b, int op_type, const Option&
     #pragma omp parallel for num_threads(opt.num_threads)
     for (int q = 0; q < channels; q++)
     {
-        float* ptr = a.channel(q);
+        T* ptr = a.channel(q);
 
-        binary_op_vector(ptr, &b, ptr, size, 1, 1, 1, op_type);
+        binary_op_vector_scalar_b(ptr, b, ptr, size, op_type);
     }
 }
 
@@ -1080,21 +1208,35 @@ int BinaryOp_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>
     const bool a_pack_is_lower = A2.elempack < B2.elempack;
     const bool a_pack_is_equal = A2.elempack == B2.elempack;
     const bool a_size_is_lower = A2.w * A2.h * A2.d * A2.c * A2.elempack < B2.w * B2.h * B2.d * B2.c * B2.elempack;
-    if (a_pack_is_lower || (a_pack_is_equal && a_size_is_lower))
-    {
-        binary_op_broadcast(B2, A2, top_blob, get_reverse_op_type(op_type), opt);
-    }
-    else
+    const bool reverse = a_pack_is_lower || (a_pack_is_equal && a_size_is_lower);
+    const Mat& a = reverse ? B2 : A2;
+    const Mat& b = reverse ? A2 : B2;
+    const int broadcast_op_type = reverse ? get_reverse_op_type(op_type) : op_type;
+
+#if NCNN_BF16
+    if (opt.use_bf16_storage && top_blob.elembits() == 16)
     {
-        binary_op_broadcast(A2, B2, top_blob, op_type, opt);
+        binary_op_broadcast<unsigned short>(a, b, top_blob, broadcast_op_type, opt);
+        return 0;
     }
+#endif
+
+    binary_op_broadcast<float>(a, b, top_blob, broadcast_op_type, opt);
 
     return 0;
 }
 
 int BinaryOp_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
 {
-    binary_op_scalar_inplace(bottom_top_blob, b, op_type, opt);
+#if NCNN_BF16
+    if (opt.use_bf16_storage && bottom_top_blob.elembits() == 16)
+    {
+        binary_op_scalar_inplace<unsigned short>(bottom_top_blob, b, op_type, opt);
+        return 0;
+    }
+#endif
+
+    binary_op_scalar_inplace<float>(bottom_top_blob, b, op_type, opt);
 
     return 0;
 }
@@ -10,9 +10,13 @@ Concat_x86::Concat_x86()
 #if __SSE2__
     support_packing = true;
 #endif // __SSE2__
+#if NCNN_BF16
+    support_bf16_storage = true;
+#endif
 }
 
-int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+template<typename T>
+static int concat(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, int axis, const Option& opt)
 {
     int dims = bottom_blobs[0].dims;
     int positive_axis = axis < 0 ? dims + axis : axis;
@@ -50,12 +54,12 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
         if (top_blob.empty())
             return -100;
 
-        float* outptr = top_blob;
+        T* outptr = top_blob;
         for (size_t b = 0; b < bottom_blobs.size(); b++)
         {
             const Mat& bottom_blob = bottom_blobs[b];
 
-            const float* ptr = bottom_blob;
+            const T* ptr = bottom_blob;
             memcpy(outptr, ptr, bottom_blob.w * bottom_blob.elemsize);
 
             outptr += bottom_blob.w * bottom_blob.elempack;
@@ -107,7 +111,7 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
                 return -100;
         }
 
-        float* outptr = top_blob_unpacked;
+        T* outptr = top_blob_unpacked;
         for (size_t b = 0; b < bottom_blobs.size(); b++)
         {
             const Mat& bottom_blob = bottom_blobs[b];
@@ -118,10 +122,10 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
             {
                 for (int i = 0; i < bottom_blob.h; i++)
                 {
-                    const float* r0 = bottom_blob.row(i);
+                    const T* r0 = bottom_blob.row<const T>(i);
 
-                    float* outptr0 = outptr;
-                    float* outptr1 = outptr + w * 8;
+                    T* outptr0 = outptr;
+                    T* outptr1 = outptr + w * 8;
 
                     for (int j = 0; j < w; j++)
                     {
@@ -154,12 +158,12 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
             {
                 for (int i = 0; i < bottom_blob.h; i++)
                 {
-                    const float* r0 = bottom_blob.row(i);
+                    const T* r0 = bottom_blob.row<const T>(i);
 
-                    float* outptr0 = outptr;
-                    float* outptr1 = outptr + w * 4;
-                    float* outptr2 = outptr + w * 8;
-                    float* outptr3 = outptr + w * 12;
+                    T* outptr0 = outptr;
+                    T* outptr1 = outptr + w * 4;
+                    T* outptr2 = outptr + w * 8;
+                    T* outptr3 = outptr + w * 12;
 
                     for (int j = 0; j < w; j++)
                     {
@@ -194,24 +198,24 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
             {
                 for (int i = 0; i < bottom_blob.h; i++)
                 {
-                    const float* r0 = bottom_blob.row(i);
-
-                    float* outptr0 = outptr;
-                    float* outptr1 = outptr + w;
-                    float* outptr2 = outptr + w * 2;
-                    float* outptr3 = outptr + w * 3;
-                    float* outptr4 = outptr + w * 4;
-                    float* outptr5 = outptr + w * 5;
-                    float* outptr6 = outptr + w * 6;
-                    float* outptr7 = outptr + w * 7;
-                    float* outptr8 = outptr + w * 8;
-                    float* outptr9 = outptr + w * 9;
-                    float* outptra = outptr + w * 10;
-                    float* outptrb = outptr + w * 11;
-                    float* outptrc = outptr + w * 12;
-                    float* outptrd = outptr + w * 13;
-                    float* outptre = outptr + w * 14;
-                    float* outptrf = outptr + w * 15;
+                    const T* r0 = bottom_blob.row<const T>(i);
+
+                    T* outptr0 = outptr;
+                    T* outptr1 = outptr + w;
+                    T* outptr2 = outptr + w * 2;
+                    T* outptr3 = outptr + w * 3;
+                    T* outptr4 = outptr + w * 4;
+                    T* outptr5 = outptr + w * 5;
+                    T* outptr6 = outptr + w * 6;
+                    T* outptr7 = outptr + w * 7;
+                    T* outptr8 = outptr + w * 8;
+                    T* outptr9 = outptr + w * 9;
+                    T* outptra = outptr + w * 10;
+                    T* outptrb = outptr + w * 11;
+                    T* outptrc = outptr + w * 12;
+                    T* outptrd = outptr + w * 13;
+                    T* outptre = outptr + w * 14;
+                    T* outptrf = outptr + w * 15;
 
                     for (int j = 0; j < w; j++)
                     {
@@ -243,10 +247,10 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
             {
                 for (int i = 0; i < bottom_blob.h; i++)
                 {
-                    const float* r0 = bottom_blob.row(i);
+                    const T* r0 = bottom_blob.row<const T>(i);
 
-                    float* outptr0 = outptr;
-                    float* outptr1 = outptr + w * 4;
+                    T* outptr0 = outptr;
+                    T* outptr1 = outptr + w * 4;
 
                     for (int j = 0; j < w; j++)
                     {
@@ -271,16 +275,16 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
             {
                 for (int i = 0; i < bottom_blob.h; i++)
                 {
-                    const float* r0 = bottom_blob.row(i);
+                    const T* r0 = bottom_blob.row<const T>(i);
 
-                    float* outptr0 = outptr;
-                    float* outptr1 = outptr + w;
-                    float* outptr2 = outptr + w * 2;
-                    float* outptr3 = outptr + w * 3;
-                    float* outptr4 = outptr + w * 4;
-                    float* outptr5 = outptr + w * 5;
-                    float* outptr6 = outptr + w * 6;
-                    float* outptr7 = outptr + w * 7;
+                    T* outptr0 = outptr;
+                    T* outptr1 = outptr + w;
+                    T* outptr2 = outptr + w * 2;
+                    T* outptr3 = outptr + w * 3;
+                    T* outptr4 = outptr + w * 4;
+                    T* outptr5 = outptr + w * 5;
+                    T* outptr6 = outptr + w * 6;
+                    T* outptr7 = outptr + w * 7;
 
                     for (int j = 0; j < w; j++)
                     {
@@ -304,12 +308,12 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
             {
                 for (int i = 0; i < bottom_blob.h; i++)
                 {
-                    const float* r0 = bottom_blob.row(i);
+                    const T* r0 = bottom_blob.row<const T>(i);
 
-                    float* outptr0 = outptr;
-                    float* outptr1 = outptr + w;
-                    float* outptr2 = outptr + w * 2;
-                    float* outptr3 = outptr + w * 3;
+                    T* outptr0 = outptr;
+                    T* outptr1 = outptr + w;
+                    T* outptr2 = outptr + w * 2;
+                    T* outptr3 = outptr + w * 3;
 
                     for (int j = 0; j < w; j++)
                     {
@@ -328,7 +332,7 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
             {
                 int size = w * bottom_blob.h;
 
-                const float* ptr = bottom_blob;
+                const T* ptr = bottom_blob;
                 memcpy(outptr, ptr, size * bottom_blob.elemsize);
 
                 outptr += size * bottom_blob.elempack;
@@ -365,12 +369,12 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
         #pragma omp parallel for num_threads(opt.num_threads)
         for (int i = 0; i < h; i++)
         {
-            float* outptr = top_blob.row(i);
+            T* outptr = top_blob.row<T>(i);
             for (size_t b = 0; b < bottom_blobs.size(); b++)
             {
                 const Mat& bottom_blob = bottom_blobs[b];
 
-                const float* ptr = bottom_blob.row(i);
+                const T* ptr = bottom_blob.row<const T>(i);
                 memcpy(outptr, ptr, bottom_blob.w * elemsize);
 
                 outptr += bottom_blob.w * elempack;
@@ -442,10 +446,10 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
 
                 for (int q = 0; q < bottom_blob.c; q++)
                 {
-                    const float* r0 = bottom_blob.channel(q);
+                    const T* r0 = bottom_blob.channel(q);
 
-                    float* outptr0 = top_blob_unpacked.channel(p);
-                    float* outptr1 = top_blob_unpacked.channel(p + 1);
+                    T* outptr0 = top_blob_unpacked.channel(p);
+                    T* outptr1 = top_blob_unpacked.channel(p + 1);
 
                     for (int i = 0; i < size; i++)
                     {
@@ -480,12 +484,12 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
 
                 for (int q = 0; q < bottom_blob.c; q++)
                 {
-                    const float* r0 = bottom_blob.channel(q);
+                    const T* r0 = bottom_blob.channel(q);
 
-                    float* outptr0 = top_blob_unpacked.channel(p);
-                    float* outptr1 = top_blob_unpacked.channel(p + 1);
-                    float* outptr2 = top_blob_unpacked.channel(p + 2);
-                    float* outptr3 = top_blob_unpacked.channel(p + 3);
+                    T* outptr0 = top_blob_unpacked.channel(p);
+                    T* outptr1 = top_blob_unpacked.channel(p + 1);
+                    T* outptr2 = top_blob_unpacked.channel(p + 2);
+                    T* outptr3 = top_blob_unpacked.channel(p + 3);
 
                     for (int i = 0; i < size; i++)
                     {
@@ -522,24 +526,24 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
 
                 for (int q = 0; q < bottom_blob.c; q++)
                 {
-                    const float* r0 = bottom_blob.channel(q);
-
-                    float* outptr0 = top_blob_unpacked.channel(p);
-                    float* outptr1 = top_blob_unpacked.channel(p + 1);
-                    float* outptr2 = top_blob_unpacked.channel(p + 2);
-                    float* outptr3 = top_blob_unpacked.channel(p + 3);
-                    float* outptr4 = top_blob_unpacked.channel(p + 4);
-                    float* outptr5 = top_blob_unpacked.channel(p + 5);
-                    float* outptr6 = top_blob_unpacked.channel(p + 6);
-                    float* outptr7 = top_blob_unpacked.channel(p + 7);
-                    float* outptr8 = top_blob_unpacked.channel(p + 8);
-                    float* outptr9 = top_blob_unpacked.channel(p + 9);
-                    float* outptra = top_blob_unpacked.channel(p + 10);
-                    float* outptrb = top_blob_unpacked.channel(p + 11);
-                    float* outptrc = top_blob_unpacked.channel(p + 12);
-                    float* outptrd = top_blob_unpacked.channel(p + 13);
-                    float* outptre = top_blob_unpacked.channel(p + 14);
-                    float* outptrf = top_blob_unpacked.channel(p + 15);
+                    const T* r0 = bottom_blob.channel(q);
+
+                    T* outptr0 = top_blob_unpacked.channel(p);
+                    T* outptr1 = top_blob_unpacked.channel(p + 1);
+                    T* outptr2 = top_blob_unpacked.channel(p + 2);
+                    T* outptr3 = top_blob_unpacked.channel(p + 3);
+                    T* outptr4 = top_blob_unpacked.channel(p + 4);
+                    T* outptr5 = top_blob_unpacked.channel(p + 5);
+                    T* outptr6 = top_blob_unpacked.channel(p + 6);
+                    T* outptr7 = top_blob_unpacked.channel(p + 7);
+                    T* outptr8 = top_blob_unpacked.channel(p + 8);
+                    T* outptr9 = top_blob_unpacked.channel(p + 9);
+                    T* outptra = top_blob_unpacked.channel(p + 10);
+                    T* outptrb = top_blob_unpacked.channel(p + 11);
+                    T* outptrc = top_blob_unpacked.channel(p + 12);
+                    T* outptrd = top_blob_unpacked.channel(p + 13);
+                    T* outptre = top_blob_unpacked.channel(p + 14);
+                    T* outptrf = top_blob_unpacked.channel(p + 15);
 
                     for (int i = 0; i < size; i++)
                     {
@@ -573,10 +577,10 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
 
                 for (int q = 0; q < bottom_blob.c; q++)
                 {
-                    const float* r0 = bottom_blob.channel(q);
+                    const T* r0 = bottom_blob.channel(q);
 
-                    float* outptr0 = top_blob_unpacked.channel(p);
-                    float* outptr1 = top_blob_unpacked.channel(p + 1);
+                    T* outptr0 = top_blob_unpacked.channel(p);
+                    T* outptr1 = top_blob_unpacked.channel(p + 1);
 
                     for (int i = 0; i < size; i++)
                     {
@@ -603,16 +607,16 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
 
                 for (int q = 0; q < bottom_blob.c; q++)
                 {
-                    const float* r0 = bottom_blob.channel(q);
+                    const T* r0 = bottom_blob.channel(q);
 
-                    float* outptr0 = top_blob_unpacked.channel(p);
-                    float* outptr1 = top_blob_unpacked.channel(p + 1);
-                    float* outptr2 = top_blob_unpacked.channel(p + 2);
-                    float* outptr3 = top_blob_unpacked.channel(p + 3);
-                    float* outptr4 = top_blob_unpacked.channel(p + 4);
-                    float* outptr5 = top_blob_unpacked.channel(p + 5);
-                    float* outptr6 = top_blob_unpacked.channel(p + 6);
-                    float* outptr7 = top_blob_unpacked.channel(p + 7);
+                    T* outptr0 = top_blob_unpacked.channel(p);
+                    T* outptr1 = top_blob_unpacked.channel(p + 1);
+                    T* outptr2 = top_blob_unpacked.channel(p + 2);
+                    T* outptr3 = top_blob_unpacked.channel(p + 3);
+                    T* outptr4 = top_blob_unpacked.channel(p + 4);
+                    T* outptr5 = top_blob_unpacked.channel(p + 5);
+                    T* outptr6 = top_blob_unpacked.channel(p + 6);
+                    T* outptr7 = top_blob_unpacked.channel(p + 7);
 
                     for (int i = 0; i < size; i++)
                     {
@@ -638,12 +642,12 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
 
                 for (int q = 0; q < bottom_blob.c; q++)
                 {
-                    const float* r0 = bottom_blob.channel(q);
+                    const T* r0 = bottom_blob.channel(q);
 
-                    float* outptr0 = top_blob_unpacked.channel(p);
-                    float* outptr1 = top_blob_unpacked.channel(p + 1);
-                    float* outptr2 = top_blob_unpacked.channel(p + 2);
-                    float* outptr3 = top_blob_unpacked.channel(p + 3);
+                    T* outptr0 = top_blob_unpacked.channel(p);
+                    T* outptr1 = top_blob_unpacked.channel(p + 1);
+                    T* outptr2 = top_blob_unpacked.channel(p + 2);
+                    T* outptr3 = top_blob_unpacked.channel(p + 3);
 
                     for (int i = 0; i < size; i++)
                     {
@@ -662,8 +666,8 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
             {
                 int size = bottom_blob.total();
 
-                const float* ptr = bottom_blob;
-                float* outptr = top_blob_unpacked.channel(p);
+                const T* ptr = bottom_blob;
+                T* outptr = top_blob_unpacked.channel(p);
                 memcpy(outptr, ptr, size * bottom_blob.elemsize);
 
                 p += bottom_blob.c;
@@ -704,7 +708,7 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
         #pragma omp parallel for num_threads(opt.num_threads)
         for (int q = 0; q < channels; q++)
         {
-            float* outptr = top_blob.channel(q);
+            T* outptr = top_blob.channel(q);
 
             for (int i = 0; i < d; i++)
             {
@@ -714,7 +718,7 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
 
                     int size = bottom_blob.w * bottom_blob.h;
 
-                    const float* ptr = bottom_blob.channel(q).depth(i);
+                    const T* ptr = bottom_blob.channel(q).depth(i);
                     memcpy(outptr, ptr, size * elemsize);
 
                     outptr += size * elempack;
@@ -750,7 +754,7 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
         #pragma omp parallel for num_threads(opt.num_threads)
         for (int q = 0; q < channels; q++)
         {
-            float* outptr = top_blob.channel(q);
+            T* outptr = top_blob.channel(q);
 
             for (int i = 0; i < d; i++)
             {
@@ -760,7 +764,7 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
                     {
                         const Mat& bottom_blob = bottom_blobs[b];
 
-                        const float* ptr = bottom_blob.channel(q).depth(i).row(j);
+                        const T* ptr = bottom_blob.channel(q).depth(i).row<const T>(j);
                         memcpy(outptr, ptr, bottom_blob.w * elemsize);
 
                         outptr += bottom_blob.w * elempack;
@@ -795,7 +799,7 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
         #pragma omp parallel for num_threads(opt.num_threads)
         for (int q = 0; q < channels; q++)
         {
-            float* outptr = top_blob.channel(q);
+            T* outptr = top_blob.channel(q);
 
             for (size_t b = 0; b < bottom_blobs.size(); b++)
             {
@@ -803,7 +807,7 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
 
                 int size = bottom_blob.w * bottom_blob.h * bottom_blob.d;
 
-                const float* ptr = bottom_blob.channel(q);
+                const T* ptr = bottom_blob.channel(q);
                 memcpy(outptr, ptr, size * elemsize);
 
                 outptr += size * elempack;
@@ -814,4 +818,14 @@ int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
     return 0;
 }
 
+int Concat_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+#if NCNN_BF16
+    if (opt.use_bf16_storage && bottom_blobs[0].elembits() == 16)
+        return concat<unsigned short>(bottom_blobs, top_blobs, axis, opt);
+#endif
+
+    return concat<float>(bottom_blobs, top_blobs, axis, opt);
+}
+
 } // namespace ncnn
@@ -3,6 +3,8 @@
 
 #include "convolution1d_x86.h"
 
+#include "layer_type.h"
+
 #if __SSE2__
 #include <emmintrin.h>
 #if __AVX__
@@ -21,6 +23,10 @@ Convolution1D_x86::Convolution1D_x86()
 #if __SSE2__
     support_packing = true;
 #endif // __SSE2__
+
+#if NCNN_INT8
+    convolution_int8 = 0;
+#endif
 }
 
 int Convolution1D_x86::create_pipeline(const Option& opt)
@@ -28,6 +34,13 @@ int Convolution1D_x86::create_pipeline(const Option& opt)
     if (dynamic_weight)
         return 0;
 
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        return create_pipeline_int8_x86(opt);
+    }
+#endif
+
     int num_input = weight_data_size / kernel_w / num_output;
 
     convolution1d_transform_kernel_packed(weight_data, weight_data_tm, num_input, num_output, kernel_w);
@@ -38,13 +51,29 @@ int Convolution1D_x86::create_pipeline(const Option& opt)
     return 0;
 }
 
-int Convolution1D_x86::destroy_pipeline(const Option& /*opt*/)
+int Convolution1D_x86::destroy_pipeline(const Option& opt)
 {
+#if NCNN_INT8
+    if (convolution_int8)
+    {
+        convolution_int8->destroy_pipeline(opt);
+        delete convolution_int8;
+        convolution_int8 = 0;
+    }
+#endif
+
     return 0;
 }
 
 int Convolution1D_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+#if NCNN_INT8
+    if (opt.use_int8_inference && int8_scale_term)
+    {
+        return forward_int8_x86(bottom_blob, top_blob, opt);
+    }
+#endif
+
     int w = bottom_blob.w;
     size_t elemsize = bottom_blob.elemsize;
     int elempack = bottom_blob.elempack;
@@ -152,4 +181,76 @@ int Convolution1D_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector
     return 0;
 }
 
+#if NCNN_INT8
+int Convolution1D_x86::create_pipeline_int8_x86(const Option& opt)
+{
+    // the weight layout outch-inch-kw is the same as Convolution with kernel_h=1,
+    // so reuse its packed and im2col-gemm int8 kernels
+    convolution_int8 = ncnn::create_layer_cpu(ncnn::LayerType::Convolution);
+
+    ncnn::ParamDict pd;
+    pd.set(0, num_output);
+    pd.set(1, kernel_w);
+    pd.set(11, 1); // kernel_h
+    pd.set(2, dilation_w);
+    pd.set(12, 1); // dilation_h
+    pd.set(3, stride_w);
+    pd.set(13, 1); // stride_h
+    pd.set(4, pad_left);
+    pd.set(15, pad_right);
+    pd.set(14, pad_left < 0 ? pad_left : 0);   // pad_top
+    pd.set(16, pad_right < 0 ? pad_right : 0); // pad_bottom
+    pd.set(18, pad_value);
+    pd.set(5, bias_term);
+    pd.set(6, weight_data_size);
+    pd.set(8, int8_scale_term);
+    pd.set(9, activation_type);
+    pd.set(10, activation_params);
+
+    convolution_int8->load_param(pd);
+
+    ncnn::Mat weights[4];
+    if (bias_term)
+    {
+        weights[0] = weight_data;
+        weights[1] = bias_data;
+        weights[2] = weight_data_int8_scales;
+        weights[3] = bottom_blob_int8_scales;
+    }
+    else
+    {
+        weights[0] = weight_data;
+        weights[1] = weight_data_int8_scales;
+        weights[2] = bottom_blob_int8_scales;
+    }
+
+    convolution_int8->load_model(ModelBinFromMatArray(weights));
+
+    convolution_int8->create_pipeline(opt);
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+int Convolution1D_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    Mat bottom_blob_3d = bottom_blob.reshape(bottom_blob.w, 1, bottom_blob.h, opt.workspace_allocator);
+    if (bottom_blob_3d.empty())
+        return -100;
+
+    Mat top_blob_3d;
+    int ret = convolution_int8->forward(bottom_blob_3d, top_blob_3d, opt);
+    if (ret != 0)
+        return ret;
+
+    top_blob = top_blob_3d.reshape(top_blob_3d.w, top_blob_3d.c, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+#endif // NCNN_INT8
+
 } // namespace ncnn
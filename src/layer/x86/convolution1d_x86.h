@@ -20,8 +20,19 @@ public:
 
     virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 
+protected:
+#if NCNN_INT8
+    int create_pipeline_int8_x86(const Option& opt);
+    int forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+#endif
+
 public:
     Mat weight_data_tm;
+
+#if NCNN_INT8
+    // int8 convolution with kernel_h=1 on the reshaped input
+    Layer* convolution_int8;
+#endif
 };
 
 } // namespace ncnn
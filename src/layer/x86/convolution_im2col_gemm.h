@@ -4595,13 +4595,16 @@ static void convolution_im2col_gemm_transform_kernel(const Mat& kernel, Mat& AT,
     }
 }
 
-static int convolution_im2col_gemm(const Mat& bottom_blob, Mat& top_blob, const Mat& AT, const Mat& bias, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, int nT, const Option& opt)
+static int convolution_im2col_gemm(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Mat& AT, const Mat& bias, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, int nT, const Option& opt)
 {
+    // all samples share the packed weights, each A tile is streamed once for the whole batch
+    const int batch = (int)bottom_blobs.size();
+
     const int maxk = kernel_w * kernel_h;
 
-    const int M = top_blob.c * top_blob.elempack;
-    const int N = top_blob.w * top_blob.h;
-    const int K = bottom_blob.c * bottom_blob.elempack * maxk;
+    const int M = top_blobs[0].c * top_blobs[0].elempack;
+    const int N = top_blobs[0].w * top_blobs[0].h;
+    const int K = bottom_blobs[0].c * bottom_blobs[0].elempack * maxk;
 
     int TILE_M, TILE_N, TILE_K;
     convolution_im2col_gemm_get_optimal_tile_mnk(M, N, K, TILE_M, TILE_N, TILE_K, nT);
@@ -4612,28 +4615,29 @@ static int convolution_im2col_gemm(const Mat& bottom_blob, Mat& top_blob, const
 
     // NCNN_LOGE("TILE M/N/K = %d %d %d -> %d %d %d", M, N, K, TILE_M, TILE_N, TILE_K);
 
-    Mat BT(TILE_K * TILE_N, (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 4u, opt.workspace_allocator);
+    Mat BT(TILE_K * TILE_N, (K + TILE_K - 1) / TILE_K, batch * nn_N, 4u, opt.workspace_allocator);
     if (BT.empty())
         return -100;
 
-    const int nn_NK = nn_N * nn_K;
+    const int nn_NK = batch * nn_N * nn_K;
 
     #pragma omp parallel for num_threads(nT)
     for (int ppjk = 0; ppjk < nn_NK; ppjk++)
     {
-        const int ppj = ppjk / nn_K;
+        const int ppbj = ppjk / nn_K;
         const int ppk = ppjk % nn_K;
 
-        const int j = ppj * TILE_N;
+        const int b = ppbj / nn_N;
+        const int j = (ppbj % nn_N) * TILE_N;
         const int k = ppk * TILE_K;
 
         const int max_jj = std::min((N - j), TILE_N);
         const int max_kk = std::min((K - k), TILE_K);
 
-        Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+        Mat BT_tile = BT.channel(ppbj).row_range(k / TILE_K, 1);
 
         // im2col
-        convolution_im2col_input_tile(bottom_blob, BT_tile, j, max_jj, k, max_kk, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h);
+        convolution_im2col_input_tile(bottom_blobs[b], BT_tile, j, max_jj, k, max_kk, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h);
     }
 
     Mat topT_tileX;
@@ -4644,6 +4648,19 @@ static int convolution_im2col_gemm(const Mat& bottom_blob, Mat& top_blob, const
             return -100;
     }
 
+#if __SSE2__
+    // 16-bit packed weights are widened once per row of tiles
+    const bool AT_16bit = AT.elembits() == 16;
+
+    Mat ATX;
+    if (AT_16bit)
+    {
+        ATX.create(TILE_K * TILE_M, (K + TILE_K - 1) / TILE_K, nT, 4u, opt.workspace_allocator);
+        if (ATX.empty())
+            return -100;
+    }
+#endif
+
     #pragma omp parallel for num_threads(nT)
     for (int ppj = 0; ppj < nn_M; ppj++)
     {
@@ -4655,24 +4672,46 @@ static int convolution_im2col_gemm(const Mat& bottom_blob, Mat& top_blob, const
 
         const int max_ii = std::min((M - i), TILE_M);
 
-        for (int j = 0; j < N; j += TILE_N)
+        for (int b = 0; b < batch; b++)
         {
-            const int max_jj = std::min((N - j), TILE_N);
+            Mat& top_blob = top_blobs[b];
 
-            for (int k = 0; k < K; k += TILE_K)
+            for (int j = 0; j < N; j += TILE_N)
             {
-                const int max_kk = std::min((K - k), TILE_K);
+                const int max_jj = std::min((N - j), TILE_N);
 
-                const Mat AT_tile = AT.channel(i / TILE_M).row_range(k / TILE_K, 1);
+                for (int k = 0; k < K; k += TILE_K)
+                {
+                    const int max_kk = std::min((K - k), TILE_K);
 
-                const Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+                    Mat AT_tile = AT.channel(i / TILE_M).row_range(k / TILE_K, 1);
 
-                bool k_end = k + TILE_K >= K;
+#if __SSE2__
+                    if (AT_16bit)
+                    {
+                        Mat AT_tile_fp32 = ATX.channel(get_omp_thread_num()).row_range(k / TILE_K, 1);
+                        if (b == 0 && j == 0)
+                            cast_packed_weight_to_fp32(AT_tile, AT_tile_fp32, max_ii * max_kk, opt.use_bf16_packed_weight);
+                        AT_tile = AT_tile_fp32;
+                    }
+#endif
+
+                    const Mat BT_tile = BT.channel(b * nn_N + j / TILE_N).row_range(k / TILE_K, 1);
+
+                    bool k_end = k + TILE_K >= K;
 
-                convolution_gemm_transB_packed_tile(AT_tile, BT_tile, bias, topT_tile, top_blob, i, max_ii, j, max_jj, k, max_kk, k_end);
+                    convolution_gemm_transB_packed_tile(AT_tile, BT_tile, bias, topT_tile, top_blob, i, max_ii, j, max_jj, k, max_kk, k_end);
+                }
             }
         }
     }
 
     return 0;
 }
+
+static int convolution_im2col_gemm(const Mat& bottom_blob, Mat& top_blob, const Mat& AT, const Mat& bias, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, int nT, const Option& opt)
+{
+    const std::vector<Mat> bottom_blobs(1, bottom_blob);
+    std::vector<Mat> top_blobs(1, top_blob);
+    return convolution_im2col_gemm(bottom_blobs, top_blobs, AT, bias, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, nT, opt);
+}
@@ -21,6 +21,7 @@
 #include "benchmark.h"
 #include "cpu.h"
 #include "layer_type.h"
+#include "packedweightcache.h"
 
 namespace ncnn {
 
@@ -352,15 +353,17 @@ int Convolution_x86::create_pipeline(const Option& opt)
 
     if (opt.use_winograd_convolution && prefer_winograd && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
     {
+        int winograd_type = 0;
+
         if ((bottom_shapes.empty() || bottom_shapes[0].w == 0 || bottom_shapes[0].h == 0) && (top_shapes.empty() || top_shapes[0].w == 0 || top_shapes[0].h == 0))
         {
             // dynamic shape
             if ((opt.use_winograd63_convolution) && (num_input <= 32 && num_output <= 32))
-                conv3x3s1_winograd63_transform_kernel(weight_data, weight_winograd63_data, num_input, num_output, opt);
+                winograd_type = 63;
             else if (opt.use_winograd43_convolution)
-                conv3x3s1_winograd43_transform_kernel(weight_data, weight_winograd43_data, num_input, num_output, opt);
+                winograd_type = 43;
             else
-                conv3x3s1_winograd23_transform_kernel(weight_data, weight_winograd23_data, num_input, num_output, opt);
+                winograd_type = 23;
         }
         else
         {
@@ -425,15 +428,15 @@ int Convolution_x86::create_pipeline(const Option& opt)
 
             if (prefer_winograd23)
             {
-                conv3x3s1_winograd23_transform_kernel(weight_data, weight_winograd23_data, num_input, num_output, opt);
+                winograd_type = 23;
             }
             else if (prefer_winograd43)
             {
-                conv3x3s1_winograd43_transform_kernel(weight_data, weight_winograd43_data, num_input, num_output, opt);
+                winograd_type = 43;
             }
             else if (prefer_winograd63)
             {
-                conv3x3s1_winograd63_transform_kernel(weight_data, weight_winograd63_data, num_input, num_output, opt);
+                winograd_type = 63;
             }
             else
             {
@@ -441,6 +444,25 @@ int Convolution_x86::create_pipeline(const Option& opt)
             }
         }
 
+        if (winograd_type != 0)
+        {
+            Mat& weight_winograd_data = winograd_type == 23 ? weight_winograd23_data : winograd_type == 43 ? weight_winograd43_data : weight_winograd63_data;
+
+            const int params[4] = {typeindex, winograd_type, num_output, opt.num_threads};
+            uint64_t digest = 0;
+            if (packed_weight_cache_get(opt, weight_data, params, 4, weight_winograd_data, digest) != 0)
+            {
+                if (winograd_type == 23)
+                    conv3x3s1_winograd23_transform_kernel(weight_data, weight_winograd_data, num_input, num_output, opt);
+                if (winograd_type == 43)
+                    conv3x3s1_winograd43_transform_kernel(weight_data, weight_winograd_data, num_input, num_output, opt);
+                if (winograd_type == 63)
+                    conv3x3s1_winograd63_transform_kernel(weight_data, weight_winograd_data, num_input, num_output, opt);
+
+                packed_weight_cache_put(opt, digest, weight_winograd_data);
+            }
+        }
+
         if (opt.lightmode)
             weight_data.release();
 
@@ -452,7 +474,52 @@ int Convolution_x86::create_pipeline(const Option& opt)
 
     if ((opt.use_sgemm_convolution && prefer_sgemm) || (kernel_w == 1 && kernel_h == 1))
     {
-        convolution_im2col_gemm_transform_kernel(weight_data, weight_sgemm_data, num_input, num_output, kernel_w, kernel_h, opt);
+        // packed weights are kept in bf16, or in fp16 with f16c, only when the caller opts in
+        bool use_bf16_weight = false;
+#if __SSE2__
+        use_bf16_weight = opt.use_bf16_packed_weight;
+#endif
+        bool use_fp16_weight = false;
+#if NCNN_F16C && __F16C__
+        use_fp16_weight = opt.use_fp16_packed_weight && cpu_support_x86_f16c() && !use_bf16_weight;
+#endif
+
+        const int params[7] = {typeindex, use_bf16_weight ? 8 : use_fp16_weight ? 7 : 1, num_output, kernel_w, kernel_h, opt.num_threads, opt.use_packing_layout};
+        uint64_t digest = 0;
+        if (packed_weight_cache_get(opt, weight_data, params, 7, weight_sgemm_data, digest) != 0)
+        {
+            convolution_im2col_gemm_transform_kernel(weight_data, weight_sgemm_data, num_input, num_output, kernel_w, kernel_h, opt);
+
+            if (use_bf16_weight)
+            {
+                Option opt_pack = opt;
+                opt_pack.blob_allocator = 0;
+
+                Mat weight_sgemm_data_bf16;
+                cast_float32_to_bfloat16(weight_sgemm_data, weight_sgemm_data_bf16, opt_pack);
+                if (weight_sgemm_data_bf16.empty())
+                    return -100;
+
+                weight_sgemm_data = weight_sgemm_data_bf16;
+            }
+            if (use_fp16_weight)
+            {
+                Option opt_pack = opt;
+                opt_pack.blob_allocator = 0;
+
+                Mat weight_sgemm_data_fp16;
+                cast_float32_to_float16(weight_sgemm_data, weight_sgemm_data_fp16, opt_pack);
+                if (weight_sgemm_data_fp16.empty())
+                    return -100;
+
+                weight_sgemm_data = weight_sgemm_data_fp16;
+            }
+
+            packed_weight_cache_put(opt, digest, weight_sgemm_data);
+        }
+
+        // the batched im2col gemm takes several samples stacked along depth
+        support_batch_depth_stacking = true;
 
         if (opt.lightmode)
             weight_data.release();
@@ -469,11 +536,25 @@ int Convolution_x86::create_pipeline(const Option& opt)
             || (elempack == 1 && out_elempack == 4 && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
             || (elempack == 1 && out_elempack == 4 && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 2 && stride_h == 2))
     {
-        convolution_transform_kernel_packed_sse(weight_data, weight_data_tm, num_input, num_output, kernel_w, kernel_h, elempack, out_elempack);
+        const int params[6] = {typeindex, 2, num_output, kernel_w, kernel_h, elempack * 100 + out_elempack};
+        uint64_t digest = 0;
+        if (packed_weight_cache_get(opt, weight_data, params, 6, weight_data_tm, digest) != 0)
+        {
+            convolution_transform_kernel_packed_sse(weight_data, weight_data_tm, num_input, num_output, kernel_w, kernel_h, elempack, out_elempack);
+
+            packed_weight_cache_put(opt, digest, weight_data_tm);
+        }
     }
     else
     {
-        convolution_transform_kernel_packed(weight_data, weight_data_tm, num_input, num_output, kernel_w, kernel_h);
+        const int params[5] = {typeindex, 3, num_output, kernel_w, kernel_h};
+        uint64_t digest = 0;
+        if (packed_weight_cache_get(opt, weight_data, params, 5, weight_data_tm, digest) != 0)
+        {
+            convolution_transform_kernel_packed(weight_data, weight_data_tm, num_input, num_output, kernel_w, kernel_h);
+
+            packed_weight_cache_put(opt, digest, weight_data_tm);
+        }
     }
 
     if (opt.lightmode)
@@ -554,6 +635,12 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         return 0;
     }
 
+    // batch samples stacked along depth, run through one im2col gemm
+    if (bottom_blob.dims == 4 && support_batch_depth_stacking)
+    {
+        return forward_batch_sgemm(bottom_blob, top_blob, opt);
+    }
+
     int w = bottom_blob.w;
     int h = bottom_blob.h;
     int channels = bottom_blob.c;
@@ -639,7 +726,7 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         }
 
         int _nT = nT ? nT : opt.num_threads;
-        if (nT != 0 && opt.num_threads != nT)
+        if (nT != 0 && opt.num_threads != nT && !opt.use_parallel_branch)
         {
             // force num_threads the same as in create_pipeline
             // so we could use pre-packed A/B from the same tile config
@@ -679,7 +766,7 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
     if ((opt.use_sgemm_convolution && prefer_sgemm) || (kernel_w == 1 && kernel_h == 1))
     {
         int _nT = nT ? nT : opt.num_threads;
-        if (nT != 0 && opt.num_threads != nT)
+        if (nT != 0 && opt.num_threads != nT && !opt.use_parallel_branch)
         {
             // force num_threads the same as in create_pipeline
             // so we could use pre-packed A/B from the same tile config
@@ -808,6 +895,78 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
     return 0;
 }
 
+int Convolution_x86::forward_batch_sgemm(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int batch = bottom_blob.d;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    // each depth slice is one sample sharing the channel step of the stacked blob
+    std::vector<Mat> bottom_blobs_bordered(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        Mat bottom_blob_b(bottom_blob.w, bottom_blob.h, bottom_blob.c, (unsigned char*)bottom_blob.data + (size_t)bottom_blob.w * bottom_blob.h * elemsize * b, elemsize, elempack);
+        bottom_blob_b.cstep = bottom_blob.cstep;
+
+        make_padding(bottom_blob_b, bottom_blobs_bordered[b], opt);
+        if (bottom_blobs_bordered[b].empty())
+            return -100;
+    }
+
+    const int w = bottom_blobs_bordered[0].w;
+    const int h = bottom_blobs_bordered[0].h;
+
+    int outw = (w - kernel_extent_w) / stride_w + 1;
+    int outh = (h - kernel_extent_h) / stride_h + 1;
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        out_elempack = num_output % 16 == 0 ? 16 : num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        out_elempack = num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = num_output % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+    size_t out_elemsize = elemsize / elempack * out_elempack;
+
+    top_blob.create(outw, outh, batch, num_output / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    std::vector<Mat> top_blobs(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        top_blobs[b] = Mat(outw, outh, top_blob.c, (unsigned char*)top_blob.data + (size_t)outw * outh * out_elemsize * b, out_elemsize, out_elempack);
+        top_blobs[b].cstep = top_blob.cstep;
+    }
+
+    int _nT = nT ? nT : opt.num_threads;
+    if (nT != 0 && opt.num_threads != nT && !opt.use_parallel_branch)
+    {
+        // force num_threads the same as in create_pipeline
+        // so we could use pre-packed A/B from the same tile config
+        NCNN_LOGE("opt.num_threads %d changed, convolution gemm will use load-time value %d", opt.num_threads, nT);
+    }
+
+    int ret = convolution_im2col_gemm(bottom_blobs_bordered, top_blobs, weight_sgemm_data, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, _nT, opt);
+    if (ret != 0)
+        return ret;
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob, opt);
+    }
+
+    return 0;
+}
+
 int Convolution_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
     const Mat& bottom_blob = bottom_blobs[0];
@@ -892,18 +1051,42 @@ int Convolution_x86::create_pipeline_int8_x86(const Option& opt)
 
     if (opt.use_winograd_convolution && prefer_winograd && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
     {
-        if (opt.use_winograd43_convolution)
-            conv3x3s1_winograd43_transform_kernel_int8(weight_data, weight_winograd43_data, num_input, num_output, opt);
-        else
-            conv3x3s1_winograd23_transform_kernel_int8(weight_data, weight_winograd23_data, num_input, num_output, opt);
+        const int winograd_type = opt.use_winograd43_convolution ? 43 : 23;
+        Mat& weight_winograd_data = winograd_type == 43 ? weight_winograd43_data : weight_winograd23_data;
+
+        const int params[4] = {typeindex, 4, winograd_type, opt.num_threads};
+        uint64_t digest = 0;
+        if (packed_weight_cache_get(opt, weight_data, params, 4, weight_winograd_data, digest) != 0)
+        {
+            if (winograd_type == 43)
+                conv3x3s1_winograd43_transform_kernel_int8(weight_data, weight_winograd_data, num_input, num_output, opt);
+            else
+                conv3x3s1_winograd23_transform_kernel_int8(weight_data, weight_winograd_data, num_input, num_output, opt);
+
+            packed_weight_cache_put(opt, digest, weight_winograd_data);
+        }
     }
     else if (opt.use_sgemm_convolution)
     {
-        convolution_im2col_gemm_transform_kernel_int8(weight_data, weight_sgemm_data, num_input, num_output, kernel_w, kernel_h, opt);
+        const int params[7] = {typeindex, 5, num_output, kernel_w, kernel_h, opt.num_threads, opt.use_packing_layout};
+        uint64_t digest = 0;
+        if (packed_weight_cache_get(opt, weight_data, params, 7, weight_sgemm_data, digest) != 0)
+        {
+            convolution_im2col_gemm_transform_kernel_int8(weight_data, weight_sgemm_data, num_input, num_output, kernel_w, kernel_h, opt);
+
+            packed_weight_cache_put(opt, digest, weight_sgemm_data);
+        }
     }
     else
     {
-        convolution_transform_kernel_packed_int8(weight_data, weight_data_tm, num_input, num_output, kernel_w, kernel_h);
+        const int params[5] = {typeindex, 6, num_output, kernel_w, kernel_h};
+        uint64_t digest = 0;
+        if (packed_weight_cache_get(opt, weight_data, params, 5, weight_data_tm, digest) != 0)
+        {
+            convolution_transform_kernel_packed_int8(weight_data, weight_data_tm, num_input, num_output, kernel_w, kernel_h);
+
+            packed_weight_cache_put(opt, digest, weight_data_tm);
+        }
     }
 
     scale_in_data.create(num_output);
@@ -1030,7 +1213,7 @@ int Convolution_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, con
         return -100;
 
     int _nT = nT ? nT : opt.num_threads;
-    if (nT != 0 && opt.num_threads != nT)
+    if (nT != 0 && opt.num_threads != nT && !opt.use_parallel_branch)
     {
         // force num_threads the same as in create_pipeline
         // so we could use pre-packed A/B from the same tile config
@@ -26,6 +26,7 @@ protected:
     int forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 #endif
     int forwardDilation_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_batch_sgemm(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 
 public:
     Layer* activation;
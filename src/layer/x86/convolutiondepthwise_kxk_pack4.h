@@ -0,0 +1,175 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+static void convdw_kxk_pack4_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel, const Mat& _bias, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, int activation_type, const Mat& activation_params, const Option& opt)
+{
+    int w = bottom_blob.w;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int group = bottom_blob.c;
+
+    const int maxk = kernel_w * kernel_h;
+
+    // kernel offsets
+    std::vector<int> _space_ofs(maxk);
+    int* space_ofs = &_space_ofs[0];
+    {
+        int p1 = 0;
+        int p2 = 0;
+        int gap = w * dilation_h - kernel_w * dilation_w;
+        for (int i = 0; i < kernel_h; i++)
+        {
+            for (int j = 0; j < kernel_w; j++)
+            {
+                space_ofs[p1] = p2 * 4;
+                p1++;
+                p2 += dilation_w;
+            }
+            p2 += gap;
+        }
+    }
+
+    const int sstep = stride_w * 4;
+
+    const float* bias = _bias;
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int g = 0; g < group; g++)
+    {
+        float* outptr = top_blob.channel(g);
+
+        __m128 _bias0 = bias ? _mm_loadu_ps(bias + g * 4) : _mm_setzero_ps();
+
+        const float* kptr = kernel.row(g);
+
+        const Mat img0 = bottom_blob.channel(g);
+
+        for (int i = 0; i < outh; i++)
+        {
+            const float* r0 = img0.row(i * stride_h);
+
+            int j = 0;
+            for (; j + 7 < outw; j += 8)
+            {
+                const float* sptr = r0 + j * sstep;
+
+                __m128 _sum0 = _bias0;
+                __m128 _sum1 = _bias0;
+                __m128 _sum2 = _bias0;
+                __m128 _sum3 = _bias0;
+                __m128 _sum4 = _bias0;
+                __m128 _sum5 = _bias0;
+                __m128 _sum6 = _bias0;
+                __m128 _sum7 = _bias0;
+
+                for (int k = 0; k < maxk; k++)
+                {
+                    const float* sptr0 = sptr + space_ofs[k];
+                    __m128 _w = _mm_loadu_ps(kptr + k * 4);
+                    _sum0 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0), _w, _sum0);
+                    _sum1 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0 + sstep), _w, _sum1);
+                    _sum2 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0 + sstep * 2), _w, _sum2);
+                    _sum3 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0 + sstep * 3), _w, _sum3);
+                    _sum4 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0 + sstep * 4), _w, _sum4);
+                    _sum5 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0 + sstep * 5), _w, _sum5);
+                    _sum6 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0 + sstep * 6), _w, _sum6);
+                    _sum7 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0 + sstep * 7), _w, _sum7);
+                }
+
+                _sum0 = activation_sse(_sum0, activation_type, activation_params);
+                _sum1 = activation_sse(_sum1, activation_type, activation_params);
+                _sum2 = activation_sse(_sum2, activation_type, activation_params);
+                _sum3 = activation_sse(_sum3, activation_type, activation_params);
+                _sum4 = activation_sse(_sum4, activation_type, activation_params);
+                _sum5 = activation_sse(_sum5, activation_type, activation_params);
+                _sum6 = activation_sse(_sum6, activation_type, activation_params);
+                _sum7 = activation_sse(_sum7, activation_type, activation_params);
+
+                _mm_storeu_ps(outptr, _sum0);
+                _mm_storeu_ps(outptr + 4, _sum1);
+                _mm_storeu_ps(outptr + 8, _sum2);
+                _mm_storeu_ps(outptr + 12, _sum3);
+                _mm_storeu_ps(outptr + 16, _sum4);
+                _mm_storeu_ps(outptr + 20, _sum5);
+                _mm_storeu_ps(outptr + 24, _sum6);
+                _mm_storeu_ps(outptr + 28, _sum7);
+
+                outptr += 32;
+            }
+            for (; j + 3 < outw; j += 4)
+            {
+                const float* sptr = r0 + j * sstep;
+
+                __m128 _sum0 = _bias0;
+                __m128 _sum1 = _bias0;
+                __m128 _sum2 = _bias0;
+                __m128 _sum3 = _bias0;
+
+                for (int k = 0; k < maxk; k++)
+                {
+                    const float* sptr0 = sptr + space_ofs[k];
+                    __m128 _w = _mm_loadu_ps(kptr + k * 4);
+                    _sum0 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0), _w, _sum0);
+                    _sum1 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0 + sstep), _w, _sum1);
+                    _sum2 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0 + sstep * 2), _w, _sum2);
+                    _sum3 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0 + sstep * 3), _w, _sum3);
+                }
+
+                _sum0 = activation_sse(_sum0, activation_type, activation_params);
+                _sum1 = activation_sse(_sum1, activation_type, activation_params);
+                _sum2 = activation_sse(_sum2, activation_type, activation_params);
+                _sum3 = activation_sse(_sum3, activation_type, activation_params);
+
+                _mm_storeu_ps(outptr, _sum0);
+                _mm_storeu_ps(outptr + 4, _sum1);
+                _mm_storeu_ps(outptr + 8, _sum2);
+                _mm_storeu_ps(outptr + 12, _sum3);
+
+                outptr += 16;
+            }
+            for (; j + 1 < outw; j += 2)
+            {
+                const float* sptr = r0 + j * sstep;
+
+                __m128 _sum0 = _bias0;
+                __m128 _sum1 = _bias0;
+
+                for (int k = 0; k < maxk; k++)
+                {
+                    const float* sptr0 = sptr + space_ofs[k];
+                    __m128 _w = _mm_loadu_ps(kptr + k * 4);
+                    _sum0 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0), _w, _sum0);
+                    _sum1 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0 + sstep), _w, _sum1);
+                }
+
+                _sum0 = activation_sse(_sum0, activation_type, activation_params);
+                _sum1 = activation_sse(_sum1, activation_type, activation_params);
+
+                _mm_storeu_ps(outptr, _sum0);
+                _mm_storeu_ps(outptr + 4, _sum1);
+
+                outptr += 8;
+            }
+            for (; j < outw; j++)
+            {
+                const float* sptr = r0 + j * sstep;
+
+                __m128 _sum0 = _bias0;
+
+                for (int k = 0; k < maxk; k++)
+                {
+                    const float* sptr0 = sptr + space_ofs[k];
+                    __m128 _w = _mm_loadu_ps(kptr + k * 4);
+                    _sum0 = _mm_comp_fmadd_ps(_mm_loadu_ps(sptr0), _w, _sum0);
+                }
+
+                _sum0 = activation_sse(_sum0, activation_type, activation_params);
+
+                _mm_storeu_ps(outptr, _sum0);
+
+                outptr += 4;
+            }
+        }
+    }
+}
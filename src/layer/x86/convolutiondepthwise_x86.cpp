@@ -20,12 +20,15 @@ namespace ncnn {
 #if __SSE2__
 #include "convolutiondepthwise_3x3_pack4.h"
 #include "convolutiondepthwise_5x5_pack4.h"
+#include "convolutiondepthwise_kxk_pack4.h"
 #if __AVX__
 #include "convolutiondepthwise_3x3_pack8.h"
 #include "convolutiondepthwise_5x5_pack8.h"
+#include "convolutiondepthwise_kxk_pack8.h"
 #if __AVX512F__
 #include "convolutiondepthwise_3x3_pack16.h"
 #include "convolutiondepthwise_5x5_pack16.h"
+#include "convolutiondepthwise_kxk_pack16.h"
 #endif // __AVX512F__
 #endif // __AVX__
 #endif // __SSE2__
@@ -35,6 +38,30 @@ namespace ncnn {
 #include "convolutiondepthwise_3x3_int8.h"
 #endif // NCNN_INT8
 
+#if __SSE2__
+static void convdw_kxk_packed(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel, const Mat& bias, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, int activation_type, const Mat& activation_params, const Option& opt)
+{
+    const int elempack = bottom_blob.elempack;
+
+#if __AVX__
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        convdw_kxk_pack16_avx512(bottom_blob, top_blob, kernel, bias, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
+    }
+#endif // __AVX512F__
+    if (elempack == 8)
+    {
+        convdw_kxk_pack8_avx(bottom_blob, top_blob, kernel, bias, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
+    }
+#endif // __AVX__
+    if (elempack == 4)
+    {
+        convdw_kxk_pack4_sse(bottom_blob, top_blob, kernel, bias, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
+    }
+}
+#endif // __SSE2__
+
 ConvolutionDepthWise_x86::ConvolutionDepthWise_x86()
 {
 #if __SSE2__
@@ -351,69 +378,10 @@ int ConvolutionDepthWise_x86::forward(const Mat& bottom_blob, Mat& top_blob, con
 
                 return 0;
             }
-            else
-            {
-                const int maxk = kernel_w * kernel_h;
-
-                // kernel offsets
-                std::vector<int> _space_ofs(maxk);
-                int* space_ofs = &_space_ofs[0];
-                {
-                    int p1 = 0;
-                    int p2 = 0;
-                    int gap = w * dilation_h - kernel_w * dilation_w;
-                    for (int i = 0; i < kernel_h; i++)
-                    {
-                        for (int j = 0; j < kernel_w; j++)
-                        {
-                            space_ofs[p1] = p2;
-                            p1++;
-                            p2 += dilation_w;
-                        }
-                        p2 += gap;
-                    }
-                }
 
-                #pragma omp parallel for num_threads(opt.num_threads)
-                for (int g = 0; g < channels; g++)
-                {
-                    float* outptr = top_blob.channel(g);
-                    const float* kptr = (const float*)weight_data_tm + maxk * g * 16;
-                    const Mat m = bottom_blob_bordered.channel(g);
+            convdw_kxk_pack16_avx512(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
 
-                    for (int i = 0; i < outh; i++)
-                    {
-                        for (int j = 0; j < outw; j++)
-                        {
-                            __m512 _sum = _mm512_set1_ps(0.f);
-
-                            if (bias_term)
-                            {
-                                _sum = _mm512_loadu_ps(((const float*)bias_data) + g * 16);
-                            }
-
-                            const float* sptr = m.row(i * stride_h) + j * stride_w * 16;
-
-                            for (int k = 0; k < maxk; k++)
-                            {
-                                __m512 _val = _mm512_loadu_ps(sptr + space_ofs[k] * 16);
-                                __m512 _w = _mm512_loadu_ps(kptr + k * 16);
-                                _sum = _mm512_fmadd_ps(_val, _w, _sum);
-                            }
-
-                            _mm512_storeu_ps(outptr, _sum);
-                            outptr += 16;
-                        }
-                    }
-                }
-
-                if (activation)
-                {
-                    activation->forward_inplace(top_blob, opt);
-                }
-
-                return 0;
-            }
+            return 0;
         }
 #endif // __AVX512F__
         if (elempack == 8)
@@ -462,70 +430,10 @@ int ConvolutionDepthWise_x86::forward(const Mat& bottom_blob, Mat& top_blob, con
 
                 return 0;
             }
-            else
-            {
-                const int maxk = kernel_w * kernel_h;
-
-                // kernel offsets
-                std::vector<int> _space_ofs(maxk);
-                int* space_ofs = &_space_ofs[0];
-                {
-                    int p1 = 0;
-                    int p2 = 0;
-                    int gap = w * dilation_h - kernel_w * dilation_w;
-                    for (int i = 0; i < kernel_h; i++)
-                    {
-                        for (int j = 0; j < kernel_w; j++)
-                        {
-                            space_ofs[p1] = p2;
-                            p1++;
-                            p2 += dilation_w;
-                        }
-                        p2 += gap;
-                    }
-                }
-
-                #pragma omp parallel for num_threads(opt.num_threads)
-                for (int g = 0; g < channels; g++)
-                {
-                    float* outptr = top_blob.channel(g);
-                    const float* kptr = (const float*)weight_data_tm + maxk * g * 8;
-                    const Mat m = bottom_blob_bordered.channel(g);
-
-                    for (int i = 0; i < outh; i++)
-                    {
-                        for (int j = 0; j < outw; j++)
-                        {
-                            __m256 _sum = _mm256_set1_ps(0.f);
-
-                            if (bias_term)
-                            {
-                                _sum = _mm256_loadu_ps(((const float*)bias_data) + g * 8);
-                            }
-
-                            const float* sptr = m.row(i * stride_h) + j * stride_w * 8;
 
-                            for (int k = 0; k < maxk; k++)
-                            {
-                                __m256 _val = _mm256_loadu_ps(sptr + space_ofs[k] * 8);
-                                __m256 _w = _mm256_loadu_ps(kptr + k * 8);
-                                _sum = _mm256_comp_fmadd_ps(_val, _w, _sum);
-                            }
+            convdw_kxk_pack8_avx(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
 
-                            _mm256_storeu_ps(outptr + j * 8, _sum);
-                        }
-
-                        outptr += outw * 8;
-                    }
-                }
-
-                if (activation)
-                {
-                    activation->forward_inplace(top_blob, opt);
-                }
-
-                return 0;
-            }
+            return 0;
         }
 #endif // __AVX__
 
@@ -575,66 +483,10 @@ int ConvolutionDepthWise_x86::forward(const Mat& bottom_blob, Mat& top_blob, con
 
                 return 0;
             }
-            {
-                const int maxk = kernel_w * kernel_h;
 
-                // kernel offsets
-                std::vector<int> _space_ofs(maxk);
-                int* space_ofs = &_space_ofs[0];
-                {
-                    int p1 = 0;
-                    int p2 = 0;
-                    int gap = w * dilation_h - kernel_w * dilation_w;
-                    for (int i = 0; i < kernel_h; i++)
-                    {
-                        for (int j = 0; j < kernel_w; j++)
-                        {
-                            space_ofs[p1] = p2;
-                            p1++;
-                            p2 += dilation_w;
-                        }
-                        p2 += gap;
-                    }
-                }
-
-                #pragma omp parallel for num_threads(opt.num_threads)
-                for (int g = 0; g < channels; g++)
-                {
-                    float* outptr = top_blob.channel(g);
-                    const float* kptr = (const float*)weight_data_tm + maxk * g * 4;
-                    const Mat m = bottom_blob_bordered.channel(g);
+            convdw_kxk_pack4_sse(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
 
-                    for (int i = 0; i < outh; i++)
-                    {
-                        for (int j = 0; j < outw; j++)
-                        {
-                            __m128 _sum = _mm_set1_ps(0.f);
-
-                            if (bias_term)
-                            {
-                                _sum = _mm_loadu_ps(((const float*)bias_data) + g * 4);
-                            }
-
-                            const float* sptr = m.row(i * stride_h) + j * stride_w * 4;
-
-                            for (int k = 0; k < maxk; k++)
-                            {
-                                __m128 _val = _mm_loadu_ps(sptr + space_ofs[k] * 4);
-                                __m128 _w = _mm_loadu_ps(kptr + k * 4);
-                                _sum = _mm_add_ps(_mm_mul_ps(_val, _w), _sum);
-                            }
-
-                            _sum = activation_sse(_sum, activation_type, activation_params);
-
-                            _mm_storeu_ps(outptr + j * 4, _sum);
-                        }
-
-                        outptr += outw * 4;
-                    }
-                }
-
-                return 0;
-            }
+            return 0;
         }
 #endif // __SSE2__
 
@@ -41,6 +41,187 @@ namespace ncnn {
 #endif // __AVX__
 #endif // __SSE2__
 
+static void deconvolution_col2im(const Mat& top_col2im, Mat& top_blob_bordered, const Mat& bias_data, int w, int h, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt)
+{
+    const int outw = top_blob_bordered.w;
+    const int out_channels = top_blob_bordered.c;
+    const int out_elempack = top_blob_bordered.elempack;
+
+    const int maxk = kernel_w * kernel_h;
+
+    // col2im
+    const int gap = (outw * stride_h - w * stride_w) * out_elempack;
+
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    if (out_elempack == 16)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < out_channels; p++)
+        {
+            const float* sptr = top_col2im.row(p * maxk);
+            Mat outm = top_blob_bordered.channel(p);
+
+            if (bias_data.empty())
+            {
+                outm.fill(_mm512_setzero_ps());
+            }
+            else
+            {
+                outm.fill(_mm512_loadu_ps((const float*)bias_data + p * 16));
+            }
+
+            for (int u = 0; u < kernel_h; u++)
+            {
+                for (int v = 0; v < kernel_w; v++)
+                {
+                    float* ptr = outm.row(dilation_h * u) + dilation_w * v * 16;
+
+                    for (int i = 0; i < h; i++)
+                    {
+                        for (int j = 0; j < w; j++)
+                        {
+                            __m512 _val = _mm512_load_ps(ptr);
+                            __m512 _s = _mm512_load_ps(sptr);
+                            _val = _mm512_add_ps(_val, _s);
+                            _mm512_store_ps(ptr, _val);
+
+                            ptr += stride_w * 16;
+                            sptr += 16;
+                        }
+
+                        ptr += gap;
+                    }
+                }
+            }
+        }
+    }
+#endif // __AVX512F__
+
+    if (out_elempack == 8)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < out_channels; p++)
+        {
+            const float* sptr = top_col2im.row(p * maxk);
+            Mat outm = top_blob_bordered.channel(p);
+
+            if (bias_data.empty())
+            {
+                outm.fill(_mm256_setzero_ps());
+            }
+            else
+            {
+                outm.fill(_mm256_loadu_ps((const float*)bias_data + p * 8));
+            }
+
+            for (int u = 0; u < kernel_h; u++)
+            {
+                for (int v = 0; v < kernel_w; v++)
+                {
+                    float* ptr = outm.row(dilation_h * u) + dilation_w * v * 8;
+
+                    for (int i = 0; i < h; i++)
+                    {
+                        for (int j = 0; j < w; j++)
+                        {
+                            __m256 _val = _mm256_load_ps(ptr);
+                            __m256 _s = _mm256_load_ps(sptr);
+                            _val = _mm256_add_ps(_val, _s);
+                            _mm256_store_ps(ptr, _val);
+
+                            ptr += stride_w * 8;
+                            sptr += 8;
+                        }
+
+                        ptr += gap;
+                    }
+                }
+            }
+        }
+    }
+#endif // __AVX__
+
+    if (out_elempack == 4)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < out_channels; p++)
+        {
+            const float* sptr = top_col2im.row(p * maxk);
+            Mat outm = top_blob_bordered.channel(p);
+
+            if (bias_data.empty())
+            {
+                outm.fill(_mm_setzero_ps());
+            }
+            else
+            {
+                outm.fill(_mm_loadu_ps((const float*)bias_data + p * 4));
+            }
+
+            for (int u = 0; u < kernel_h; u++)
+            {
+                for (int v = 0; v < kernel_w; v++)
+                {
+                    float* ptr = outm.row(dilation_h * u) + dilation_w * v * 4;
+
+                    for (int i = 0; i < h; i++)
+                    {
+                        for (int j = 0; j < w; j++)
+                        {
+                            __m128 _val = _mm_load_ps(ptr);
+                            __m128 _s = _mm_load_ps(sptr);
+                            _val = _mm_add_ps(_val, _s);
+                            _mm_store_ps(ptr, _val);
+
+                            ptr += stride_w * 4;
+                            sptr += 4;
+                        }
+
+                        ptr += gap;
+                    }
+                }
+            }
+        }
+    }
+#endif // __SSE2__
+
+    if (out_elempack == 1)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < out_channels; p++)
+        {
+            const float* sptr = top_col2im.row(p * maxk);
+            Mat outm = top_blob_bordered.channel(p);
+
+            const float bias = bias_data.empty() ? 0.f : bias_data[p];
+            outm.fill(bias);
+
+            for (int u = 0; u < kernel_h; u++)
+            {
+                for (int v = 0; v < kernel_w; v++)
+                {
+                    float* ptr = outm.row(dilation_h * u) + dilation_w * v;
+
+                    for (int i = 0; i < h; i++)
+                    {
+                        for (int j = 0; j < w; j++)
+                        {
+                            ptr[0] += sptr[0];
+
+                            ptr += stride_w;
+                            sptr += 1;
+                        }
+
+                        ptr += gap;
+                    }
+                }
+            }
+        }
+    }
+}
+
 Deconvolution_x86::Deconvolution_x86()
 {
 #if __SSE2__
@@ -58,6 +239,13 @@ int Deconvolution_x86::create_pipeline(const Option& opt)
 
     activation = create_activation_layer(activation_type, activation_params, opt);
 
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        return create_pipeline_int8_x86(opt);
+    }
+#endif
+
     const int maxk = kernel_w * kernel_h;
     int num_input = weight_data_size / maxk / num_output;
 
@@ -209,6 +397,13 @@ int Deconvolution_x86::destroy_pipeline(const Option& opt)
 
 int Deconvolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+#if NCNN_INT8
+    if (opt.use_int8_inference && int8_scale_term)
+    {
+        return forward_int8_x86(bottom_blob, top_blob, opt);
+    }
+#endif
+
     // deconvolv with NxN kernel
     // value = value + bias
 
@@ -271,179 +466,7 @@ int Deconvolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Opti
         if (ret != 0)
             return ret;
 
-        {
-            // col2im
-            const int gap = (outw * stride_h - w * stride_w) * out_elempack;
-
-#if __SSE2__
-#if __AVX__
-#if __AVX512F__
-            if (out_elempack == 16)
-            {
-                #pragma omp parallel for num_threads(opt.num_threads)
-                for (int p = 0; p < out_channels; p++)
-                {
-                    const float* sptr = top_col2im.row(p * maxk);
-                    Mat outm = top_blob_bordered.channel(p);
-
-                    if (bias_data.empty())
-                    {
-                        outm.fill(_mm512_setzero_ps());
-                    }
-                    else
-                    {
-                        outm.fill(_mm512_loadu_ps((const float*)bias_data + p * 16));
-                    }
-
-                    for (int u = 0; u < kernel_h; u++)
-                    {
-                        for (int v = 0; v < kernel_w; v++)
-                        {
-                            float* ptr = outm.row(dilation_h * u) + dilation_w * v * 16;
-
-                            for (int i = 0; i < h; i++)
-                            {
-                                for (int j = 0; j < w; j++)
-                                {
-                                    __m512 _val = _mm512_load_ps(ptr);
-                                    __m512 _s = _mm512_load_ps(sptr);
-                                    _val = _mm512_add_ps(_val, _s);
-                                    _mm512_store_ps(ptr, _val);
-
-                                    ptr += stride_w * 16;
-                                    sptr += 16;
-                                }
-
-                                ptr += gap;
-                            }
-                        }
-                    }
-                }
-            }
-#endif // __AVX512F__
-
-            if (out_elempack == 8)
-            {
-                #pragma omp parallel for num_threads(opt.num_threads)
-                for (int p = 0; p < out_channels; p++)
-                {
-                    const float* sptr = top_col2im.row(p * maxk);
-                    Mat outm = top_blob_bordered.channel(p);
-
-                    if (bias_data.empty())
-                    {
-                        outm.fill(_mm256_setzero_ps());
-                    }
-                    else
-                    {
-                        outm.fill(_mm256_loadu_ps((const float*)bias_data + p * 8));
-                    }
-
-                    for (int u = 0; u < kernel_h; u++)
-                    {
-                        for (int v = 0; v < kernel_w; v++)
-                        {
-                            float* ptr = outm.row(dilation_h * u) + dilation_w * v * 8;
-
-                            for (int i = 0; i < h; i++)
-                            {
-                                for (int j = 0; j < w; j++)
-                                {
-                                    __m256 _val = _mm256_load_ps(ptr);
-                                    __m256 _s = _mm256_load_ps(sptr);
-                                    _val = _mm256_add_ps(_val, _s);
-                                    _mm256_store_ps(ptr, _val);
-
-                                    ptr += stride_w * 8;
-                                    sptr += 8;
-                                }
-
-                                ptr += gap;
-                            }
-                        }
-                    }
-                }
-            }
-#endif // __AVX__
-
-            if (out_elempack == 4)
-            {
-                #pragma omp parallel for num_threads(opt.num_threads)
-                for (int p = 0; p < out_channels; p++)
-                {
-                    const float* sptr = top_col2im.row(p * maxk);
-                    Mat outm = top_blob_bordered.channel(p);
-
-                    if (bias_data.empty())
-                    {
-                        outm.fill(_mm_setzero_ps());
-                    }
-                    else
-                    {
-                        outm.fill(_mm_loadu_ps((const float*)bias_data + p * 4));
-                    }
-
-                    for (int u = 0; u < kernel_h; u++)
-                    {
-                        for (int v = 0; v < kernel_w; v++)
-                        {
-                            float* ptr = outm.row(dilation_h * u) + dilation_w * v * 4;
-
-                            for (int i = 0; i < h; i++)
-                            {
-                                for (int j = 0; j < w; j++)
-                                {
-                                    __m128 _val = _mm_load_ps(ptr);
-                                    __m128 _s = _mm_load_ps(sptr);
-                                    _val = _mm_add_ps(_val, _s);
-                                    _mm_store_ps(ptr, _val);
-
-                                    ptr += stride_w * 4;
-                                    sptr += 4;
-                                }
-
-                                ptr += gap;
-                            }
-                        }
-                    }
-                }
-            }
-#endif // __SSE2__
-
-            if (out_elempack == 1)
-            {
-                #pragma omp parallel for num_threads(opt.num_threads)
-                for (int p = 0; p < out_channels; p++)
-                {
-                    const float* sptr = top_col2im.row(p * maxk);
-                    Mat outm = top_blob_bordered.channel(p);
-
-                    const float bias = bias_data.empty() ? 0.f : bias_data[p];
-                    outm.fill(bias);
-
-                    for (int u = 0; u < kernel_h; u++)
-                    {
-                        for (int v = 0; v < kernel_w; v++)
-                        {
-                            float* ptr = outm.row(dilation_h * u) + dilation_w * v;
-
-                            for (int i = 0; i < h; i++)
-                            {
-                                for (int j = 0; j < w; j++)
-                                {
-                                    ptr[0] += sptr[0];
-
-                                    ptr += stride_w;
-                                    sptr += 1;
-                                }
-
-                                ptr += gap;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        deconvolution_col2im(top_col2im, top_blob_bordered, bias_data, w, h, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
 
         if (activation)
         {
@@ -725,4 +748,166 @@ int Deconvolution_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector
     return 0;
 }
 
+#if NCNN_INT8
+int Deconvolution_x86::create_pipeline_int8_x86(const Option& opt)
+{
+    const int maxk = kernel_w * kernel_h;
+    const int num_input = weight_data_size / maxk / num_output;
+
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        out_elempack = num_output % 16 == 0 ? 16 : num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        out_elempack = num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = num_output % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+
+    // the int8 gemm writes dequantized fp32 columns, col2im is shared with the fp32 path
+    gemm = ncnn::create_layer_cpu(ncnn::LayerType::Gemm);
+
+    ncnn::ParamDict pd;
+    pd.set(2, 1);                 // transA
+    pd.set(3, 0);                 // transB
+    pd.set(4, 1);                 // constantA
+    pd.set(5, 0);                 // constantB
+    pd.set(6, 1);                 // constantC
+    pd.set(7, maxk * num_output); // M = maxk*num_output
+    pd.set(8, 0);                 // N = size
+    pd.set(9, num_input);         // K = inch
+    pd.set(10, -1);               // constant_broadcast_type_C = null
+    pd.set(11, 0);                // output_N1M
+    pd.set(12, out_elempack);
+    pd.set(18, 3);                // int8_scale_term = static input scale
+
+    gemm->load_param(pd);
+
+    // maxk-inch-outch to pa-maxk-outch/pa-inch
+    Mat tmp;
+    Mat tmp_int8_scales;
+    {
+        Mat weight_data_r2 = weight_data.reshape(maxk, num_input, num_output);
+
+        tmp.create(maxk * num_output, num_input, (size_t)1u);
+        tmp_int8_scales.create(maxk * num_output);
+
+        for (int p = 0; p < num_input; p += 1)
+        {
+            signed char* g00 = tmp.row<signed char>(p);
+
+            for (int q = 0; q + (out_elempack - 1) < num_output; q += out_elempack)
+            {
+                for (int k = 0; k < maxk; k++)
+                {
+                    for (int i = 0; i < out_elempack; i++)
+                    {
+                        const signed char* k00 = weight_data_r2.channel(q + i).row<const signed char>(p);
+                        g00[0] = k00[k];
+                        g00++;
+                    }
+                }
+            }
+        }
+
+        float* ps = tmp_int8_scales;
+        for (int q = 0; q + (out_elempack - 1) < num_output; q += out_elempack)
+        {
+            for (int k = 0; k < maxk; k++)
+            {
+                for (int i = 0; i < out_elempack; i++)
+                {
+                    *ps++ = weight_data_int8_scales[q + i];
+                }
+            }
+        }
+    }
+
+    ncnn::Mat weights[3];
+    weights[0] = tmp;
+    weights[1] = tmp_int8_scales;
+    weights[2] = bottom_blob_int8_scales;
+
+    gemm->load_model(ModelBinFromMatArray(weights));
+
+    gemm->create_pipeline(opt);
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+int Deconvolution_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    const int outw = (w - 1) * stride_w + kernel_extent_w + output_pad_right;
+    const int outh = (h - 1) * stride_h + kernel_extent_h + output_pad_bottom;
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        out_elempack = num_output % 16 == 0 ? 16 : num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        out_elempack = num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = num_output % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+    const size_t out_elemsize = 4u * out_elempack;
+
+    const int out_channels = num_output / out_elempack;
+
+    Mat top_blob_bordered;
+    if (pad_left > 0 || pad_right > 0 || pad_top > 0 || pad_bottom > 0 || (output_w > 0 && output_h > 0))
+    {
+        top_blob_bordered.create(outw, outh, out_channels, out_elemsize, out_elempack, opt.workspace_allocator);
+    }
+    else
+    {
+        top_blob_bordered = top_blob;
+        top_blob_bordered.create(outw, outh, out_channels, out_elemsize, out_elempack, opt.blob_allocator);
+    }
+    if (top_blob_bordered.empty())
+        return -100;
+
+    // the gemm quantizes the input with the static bottom scale
+    Mat bottom_blob_2 = bottom_blob;
+    {
+        bottom_blob_2.w = bottom_blob.w * bottom_blob.h;
+        bottom_blob_2.h = 1;
+    }
+    Mat top_col2im;
+    Option opt_b = opt;
+    opt_b.blob_allocator = top_blob_bordered.allocator;
+    int ret = gemm->forward(bottom_blob_2, top_col2im, opt_b);
+    if (ret != 0)
+        return ret;
+
+    deconvolution_col2im(top_col2im, top_blob_bordered, bias_data, w, h, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob_bordered, opt);
+    }
+
+    cut_padding(top_blob_bordered, top_blob, opt);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+#endif // NCNN_INT8
+
 } // namespace ncnn
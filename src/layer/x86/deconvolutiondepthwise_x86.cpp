@@ -35,6 +35,14 @@ int DeconvolutionDepthWise_x86::create_pipeline(const Option& opt)
     // depth-wise
     if (channels == group && group == num_output)
     {
+#if NCNN_INT8
+        if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+        {
+            // TODO implement packed int8 kernel, forward unpacks to the reference path
+            return 0;
+        }
+#endif
+
         int elempack = 1;
 #if __SSE2__
         if (opt.use_packing_layout)
@@ -153,6 +161,7 @@ int DeconvolutionDepthWise_x86::create_group_ops(const Option& opt)
         pd.set(19, output_pad_bottom);
         pd.set(5, bias_term);
         pd.set(6, maxk * channels_g * num_output_g); // weight_data_size
+        pd.set(8, int8_scale_term);
         pd.set(9, activation_type);
         pd.set(10, activation_params);
 
@@ -161,17 +170,37 @@ int DeconvolutionDepthWise_x86::create_group_ops(const Option& opt)
         // set weights
         if (bias_term)
         {
-            ncnn::Mat weights[2];
+            ncnn::Mat weights[4];
             weights[0] = weight_data_g;
             weights[1] = bias_data_g;
 
+#if NCNN_INT8
+            if (int8_scale_term)
+            {
+                Mat weight_data_int8_scales_g(num_output_g);
+                weight_data_int8_scales_g.fill(weight_data_int8_scales[g]);
+                weights[2] = weight_data_int8_scales_g;
+                weights[3] = bottom_blob_int8_scales.range(g, 1);
+            }
+#endif
+
             op->load_model(ModelBinFromMatArray(weights));
         }
         else
         {
-            ncnn::Mat weights[1];
+            ncnn::Mat weights[3];
             weights[0] = weight_data_g;
 
+#if NCNN_INT8
+            if (int8_scale_term)
+            {
+                Mat weight_data_int8_scales_g(num_output_g);
+                weight_data_int8_scales_g.fill(weight_data_int8_scales[g]);
+                weights[1] = weight_data_int8_scales_g;
+                weights[2] = bottom_blob_int8_scales.range(g, 1);
+            }
+#endif
+
             op->load_model(ModelBinFromMatArray(weights));
         }
 
@@ -206,6 +235,23 @@ int DeconvolutionDepthWise_x86::forward(const Mat& bottom_blob, Mat& top_blob, c
     size_t elemsize = bottom_blob.elemsize;
     int elempack = bottom_blob.elempack;
 
+#if NCNN_INT8
+    if (opt.use_int8_inference && int8_scale_term && channels * elempack == group && group == num_output)
+    {
+        Mat bottom_blob_unpacked = bottom_blob;
+        if (elempack != 1)
+        {
+            Option opt_p = opt;
+            opt_p.blob_allocator = opt.workspace_allocator;
+            convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_p);
+            if (bottom_blob_unpacked.empty())
+                return -100;
+        }
+
+        return DeconvolutionDepthWise::forward_int8(bottom_blob_unpacked, top_blob, opt);
+    }
+#endif
+
     const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
     const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
 
@@ -18,10 +18,18 @@ Eltwise_x86::Eltwise_x86()
 #if __SSE2__
     support_packing = true;
 #endif // __SSE2__
+#if NCNN_BF16
+    support_bf16_storage = true;
+#endif
 }
 
 int Eltwise_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
+#if NCNN_BF16
+    if (opt.use_bf16_storage && bottom_blobs[0].elembits() == 16)
+        return forward_bf16s(bottom_blobs, top_blobs, opt);
+#endif
+
     const Mat& bottom_blob = bottom_blobs[0];
     int w = bottom_blob.w;
     int h = bottom_blob.h;
@@ -529,4 +537,133 @@ int Eltwise_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
     return 0;
 }
 
+#if NCNN_BF16
+int Eltwise_x86::forward_bf16s(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const Mat& bottom_blob = bottom_blobs[0];
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int d = bottom_blob.d;
+    int channels = bottom_blob.c;
+    int elempack = bottom_blob.elempack;
+    int size = w * h * d * elempack;
+
+    Mat& top_blob = top_blobs[0];
+    top_blob.create_like(bottom_blob, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const int count = (int)bottom_blobs.size();
+
+    // all inputs are reduced in registers with one pass over memory
+    const float* coeffs_ptr = op_type == Operation_SUM && coeffs.w != 0 ? (const float*)coeffs : 0;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
+    {
+        std::vector<const unsigned short*> ptrs(count);
+        for (int b = 0; b < count; b++)
+        {
+            ptrs[b] = bottom_blobs[b].channel(q);
+        }
+
+        unsigned short* outptr = top_blob.channel(q);
+
+        int i = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+        for (; i + 15 < size; i += 16)
+        {
+            __m512 _sum = bfloat2float_avx512(_mm256_loadu_si256((const __m256i*)(ptrs[0] + i)));
+            if (coeffs_ptr)
+                _sum = _mm512_mul_ps(_sum, _mm512_set1_ps(coeffs_ptr[0]));
+
+            for (int b = 1; b < count; b++)
+            {
+                __m512 _p = bfloat2float_avx512(_mm256_loadu_si256((const __m256i*)(ptrs[b] + i)));
+                if (op_type == Operation_PROD)
+                    _sum = _mm512_mul_ps(_sum, _p);
+                else if (op_type == Operation_MAX)
+                    _sum = _mm512_max_ps(_sum, _p);
+                else if (coeffs_ptr)
+                    _sum = _mm512_fmadd_ps(_p, _mm512_set1_ps(coeffs_ptr[b]), _sum);
+                else
+                    _sum = _mm512_add_ps(_sum, _p);
+            }
+
+            _mm256_storeu_si256((__m256i*)(outptr + i), float2bfloat_avx512(_sum));
+        }
+#endif // __AVX512F__
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _sum = bfloat2float_avx(_mm_loadu_si128((const __m128i*)(ptrs[0] + i)));
+            if (coeffs_ptr)
+                _sum = _mm256_mul_ps(_sum, _mm256_set1_ps(coeffs_ptr[0]));
+
+            for (int b = 1; b < count; b++)
+            {
+                __m256 _p = bfloat2float_avx(_mm_loadu_si128((const __m128i*)(ptrs[b] + i)));
+                if (op_type == Operation_PROD)
+                    _sum = _mm256_mul_ps(_sum, _p);
+                else if (op_type == Operation_MAX)
+                    _sum = _mm256_max_ps(_sum, _p);
+                else if (coeffs_ptr)
+                    _sum = _mm256_comp_fmadd_ps(_p, _mm256_set1_ps(coeffs_ptr[b]), _sum);
+                else
+                    _sum = _mm256_add_ps(_sum, _p);
+            }
+
+            _mm_storeu_si128((__m128i*)(outptr + i), float2bfloat_avx(_sum));
+        }
+#endif // __AVX__
+        for (; i + 3 < size; i += 4)
+        {
+            __m128 _sum = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)(ptrs[0] + i)));
+            if (coeffs_ptr)
+                _sum = _mm_mul_ps(_sum, _mm_set1_ps(coeffs_ptr[0]));
+
+            for (int b = 1; b < count; b++)
+            {
+                __m128 _p = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)(ptrs[b] + i)));
+                if (op_type == Operation_PROD)
+                    _sum = _mm_mul_ps(_sum, _p);
+                else if (op_type == Operation_MAX)
+                    _sum = _mm_max_ps(_sum, _p);
+                else if (coeffs_ptr)
+                    _sum = _mm_comp_fmadd_ps(_p, _mm_set1_ps(coeffs_ptr[b]), _sum);
+                else
+                    _sum = _mm_add_ps(_sum, _p);
+            }
+
+            _mm_storel_epi64((__m128i*)(outptr + i), float2bfloat_sse(_sum, _sum));
+        }
+#endif // __SSE2__
+        for (; i < size; i++)
+        {
+            float sum = bfloat16_to_float32(ptrs[0][i]);
+            if (coeffs_ptr)
+                sum *= coeffs_ptr[0];
+
+            for (int b = 1; b < count; b++)
+            {
+                float p = bfloat16_to_float32(ptrs[b][i]);
+                if (op_type == Operation_PROD)
+                    sum *= p;
+                else if (op_type == Operation_MAX)
+                    sum = std::max(sum, p);
+                else if (coeffs_ptr)
+                    sum += p * coeffs_ptr[b];
+                else
+                    sum += p;
+            }
+
+            outptr[i] = float32_to_bfloat16(sum);
+        }
+    }
+
+    return 0;
+}
+#endif // NCNN_BF16
+
 } // namespace ncnn
@@ -15,8 +15,10 @@
 #endif // __AVX__
 #endif // __SSE2__
 #include "x86_usability.h"
+#include "x86_weight_quant.h"
 
 #include "cpu.h"
+#include "packedweightcache.h"
 
 namespace ncnn {
 
@@ -6980,6 +6982,19 @@ static int gemm_AT_x86(const Mat& AT, const Mat& B, const Mat& C, Mat& top_blob,
     if (BT.empty())
         return -100;
 
+#if __SSE2__
+    // 16-bit packed A is widened once per row of tiles
+    const bool AT_16bit = AT.elembits() == 16;
+
+    Mat ATX;
+    if (AT_16bit)
+    {
+        ATX.create(TILE_K * TILE_M, (K + TILE_K - 1) / TILE_K, nT, 4u, opt.workspace_allocator);
+        if (ATX.empty())
+            return -100;
+    }
+#endif
+
     const int nn_NK = nn_N * nn_K;
 
     // pack B
@@ -7045,6 +7060,16 @@ static int gemm_AT_x86(const Mat& AT, const Mat& B, const Mat& C, Mat& top_blob,
 
                 Mat AT_tile = AT.channel(i / TILE_M).row_range(k / TILE_K, 1);
 
+#if __SSE2__
+                if (AT_16bit)
+                {
+                    Mat AT_tile_fp32 = ATX.channel(get_omp_thread_num()).row_range(k / TILE_K, 1);
+                    if (j == 0)
+                        cast_packed_weight_to_fp32(AT_tile, AT_tile_fp32, max_ii * max_kk, opt.use_bf16_packed_weight);
+                    AT_tile = AT_tile_fp32;
+                }
+#endif
+
                 Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
 
                 bool k_end = !output_transpose && k + TILE_K >= K;
@@ -7080,6 +7105,19 @@ static int gemm_BT_x86(const Mat& A, const Mat& BT, const Mat& C, Mat& top_blob,
     if (ATX.empty())
         return -100;
 
+#if __SSE2__
+    // 16-bit packed B is widened tile by tile
+    const bool BT_16bit = BT.elembits() == 16;
+
+    Mat BTX;
+    if (BT_16bit)
+    {
+        BTX.create(TILE_K * TILE_N, 1, nT, 4u, opt.workspace_allocator);
+        if (BTX.empty())
+            return -100;
+    }
+#endif
+
     Mat topT;
     if (K > TILE_K || broadcast_type_C == 3 || output_transpose)
     {
@@ -7124,6 +7162,15 @@ static int gemm_BT_x86(const Mat& A, const Mat& BT, const Mat& C, Mat& top_blob,
 
                 Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
 
+#if __SSE2__
+                if (BT_16bit)
+                {
+                    Mat BT_tile_fp32 = BTX.channel(get_omp_thread_num());
+                    cast_packed_weight_to_fp32(BT_tile, BT_tile_fp32, max_jj * max_kk, opt.use_bf16_packed_weight);
+                    BT_tile = BT_tile_fp32;
+                }
+#endif
+
                 if (j == 0)
                 {
                     if (transA)
@@ -7163,6 +7210,28 @@ static int gemm_AT_BT_x86(const Mat& AT, const Mat& BT, const Mat& C, Mat& top_b
     int nn_M = (M + TILE_M - 1) / TILE_M;
     // int nn_N = (N + TILE_N - 1) / TILE_N;
 
+#if __SSE2__
+    // 16-bit packed A is widened once per row of tiles, 16-bit packed B tile by tile
+    const bool AT_16bit = AT.elembits() == 16;
+    const bool BT_16bit = BT.elembits() == 16;
+
+    Mat ATX;
+    if (AT_16bit)
+    {
+        ATX.create(TILE_K * TILE_M, (K + TILE_K - 1) / TILE_K, nT, 4u, opt.workspace_allocator);
+        if (ATX.empty())
+            return -100;
+    }
+
+    Mat BTX;
+    if (BT_16bit)
+    {
+        BTX.create(TILE_K * TILE_N, 1, nT, 4u, opt.workspace_allocator);
+        if (BTX.empty())
+            return -100;
+    }
+#endif
+
     Mat topT;
     if (K > TILE_K || broadcast_type_C == 3 || output_transpose)
     {
@@ -7203,6 +7272,23 @@ static int gemm_AT_BT_x86(const Mat& AT, const Mat& BT, const Mat& C, Mat& top_b
 
                 Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
 
+#if __SSE2__
+                if (AT_16bit)
+                {
+                    Mat AT_tile_fp32 = ATX.channel(get_omp_thread_num()).row_range(k / TILE_K, 1);
+                    if (j == 0)
+                        cast_packed_weight_to_fp32(AT_tile, AT_tile_fp32, max_ii * max_kk, opt.use_bf16_packed_weight);
+                    AT_tile = AT_tile_fp32;
+                }
+
+                if (BT_16bit)
+                {
+                    Mat BT_tile_fp32 = BTX.channel(get_omp_thread_num());
+                    cast_packed_weight_to_fp32(BT_tile, BT_tile_fp32, max_jj * max_kk, opt.use_bf16_packed_weight);
+                    BT_tile = BT_tile_fp32;
+                }
+#endif
+
                 bool k_end = !output_transpose && k + TILE_K >= K;
 
                 gemm_transB_packed_tile(AT_tile, BT_tile, CT_tile, topT_tile, top_blob, broadcast_type_C, i, max_ii, j, max_jj, k, max_kk, k_end);
@@ -7218,6 +7304,118 @@ static int gemm_AT_BT_x86(const Mat& AT, const Mat& BT, const Mat& C, Mat& top_b
     return 0;
 }
 
+// dequantize rows [r, r + max_rr) and columns [k, k + max_kk) of the weight-only quantized matrix
+static void dequantize_weight_quant_tile(const Mat& W, const Mat& W_scales, Mat& WT, int r, int max_rr, int k, int max_kk, int bits, int group_size)
+{
+    for (int rr = 0; rr < max_rr; rr++)
+    {
+        dequantize_weight_quant_row_x86(W.row<const unsigned char>(r + rr), W_scales.row(r + rr), k, max_kk, bits, group_size, WT.row(rr));
+    }
+}
+
+// the quantized constant matrix is never expanded as a whole
+// each tile is dequantized right before it is packed for the micro kernel
+// tiles of M and N are distributed together so that one row of tokens still keeps all threads busy
+static int gemm_x86_weight_quant(const Mat& A, const Mat& B, const Mat& W_scales, const Mat& C, Mat& top_blob, int broadcast_type_C, int constantA, int transA, int transB, int output_transpose, int K, int bits, int group_size, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
+{
+    const int M = constantA ? A.h : transA ? A.w : (A.dims == 3 ? A.c : A.h) * A.elempack;
+    const int N = constantA ? (transB ? (B.dims == 3 ? B.c : B.h) * B.elempack : B.w) : B.h;
+
+    int TILE_M, TILE_N, TILE_K;
+    get_optimal_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
+
+    const int nn_M = (M + TILE_M - 1) / TILE_M;
+    const int nn_N = (N + TILE_N - 1) / TILE_N;
+
+    Mat ATX(TILE_K * TILE_M, 1, nT, 4u, opt.workspace_allocator);
+    if (ATX.empty())
+        return -100;
+
+    Mat BTX(TILE_K * TILE_N, 1, nT, 4u, opt.workspace_allocator);
+    if (BTX.empty())
+        return -100;
+
+    Mat WTX(TILE_K, std::max(TILE_M, TILE_N), nT, 4u, opt.workspace_allocator);
+    if (WTX.empty())
+        return -100;
+
+    Mat topT(TILE_N * TILE_M, 1, nT, 4u, opt.workspace_allocator);
+    if (topT.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(nT)
+    for (int ppij = 0; ppij < nn_M * nn_N; ppij++)
+    {
+        const int ppi = ppij / nn_N;
+        const int ppj = ppij % nn_N;
+
+        const int i = ppi * TILE_M;
+        const int j = ppj * TILE_N;
+
+        const int max_ii = std::min((M - i), TILE_M);
+        const int max_jj = std::min((N - j), TILE_N);
+
+        Mat AT_tile = ATX.channel(get_omp_thread_num());
+        Mat BT_tile = BTX.channel(get_omp_thread_num());
+        Mat topT_tile = topT.channel(get_omp_thread_num());
+
+        if (broadcast_type_C == 3)
+        {
+            pack_A_tile(C, topT_tile, i, max_ii, j, max_jj);
+        }
+
+        const Mat& CT_tile = broadcast_type_C == 3 ? topT_tile : C;
+
+        for (int k = 0; k < K; k += TILE_K)
+        {
+            const int max_kk = std::min((K - k), TILE_K);
+
+            const int max_rr = constantA ? max_ii : max_jj;
+            Mat WT_tile(max_kk, max_rr, (void*)WTX.channel(get_omp_thread_num()).data);
+
+            if (constantA)
+            {
+                dequantize_weight_quant_tile(A, W_scales, WT_tile, i, max_ii, k, max_kk, bits, group_size);
+                pack_A_tile(WT_tile, AT_tile, 0, max_ii, 0, max_kk);
+
+                if (transB)
+                {
+                    pack_B_tile(B, BT_tile, j, max_jj, k, max_kk);
+                }
+                else
+                {
+                    transpose_pack_B_tile(B, BT_tile, j, max_jj, k, max_kk);
+                }
+            }
+            else
+            {
+                if (transA)
+                {
+                    transpose_pack_A_tile(A, AT_tile, i, max_ii, k, max_kk);
+                }
+                else
+                {
+                    pack_A_tile(A, AT_tile, i, max_ii, k, max_kk);
+                }
+
+                dequantize_weight_quant_tile(B, W_scales, WT_tile, j, max_jj, k, max_kk, bits, group_size);
+                pack_B_tile(WT_tile, BT_tile, 0, max_jj, 0, max_kk);
+            }
+
+            bool k_end = !output_transpose && k + TILE_K >= K;
+
+            gemm_transB_packed_tile(AT_tile, BT_tile, CT_tile, topT_tile, top_blob, broadcast_type_C, i, max_ii, j, max_jj, k, max_kk, k_end);
+        }
+
+        if (output_transpose)
+        {
+            transpose_unpack_output_tile(topT_tile, top_blob, i, max_ii, j, max_jj);
+        }
+    }
+
+    return 0;
+}
+
 int Gemm_x86::create_pipeline(const Option& opt)
 {
 #if NCNN_INT8
@@ -7227,7 +7425,18 @@ int Gemm_x86::create_pipeline(const Option& opt)
     }
 #endif
 
-    if (constantA)
+    // constant A and B are kept in bf16, or in fp16 with f16c, only when the caller opts in
+    bool use_bf16_weight = false;
+#if __SSE2__
+    use_bf16_weight = opt.use_bf16_packed_weight;
+#endif
+    bool use_fp16_weight = false;
+#if NCNN_F16C && __F16C__
+    use_fp16_weight = opt.use_fp16_packed_weight && cpu_support_x86_f16c() && !use_bf16_weight;
+#endif
+
+    // weight-only quantized A or B stays compressed and is dequantized in forward
+    if (constantA && !weight_quant_bits)
     {
         const int M = constantM;
         const int K = constantK;
@@ -7237,38 +7446,70 @@ int Gemm_x86::create_pipeline(const Option& opt)
 
         const int nn_M = (M + TILE_M - 1) / TILE_M;
 
-        AT_data.create(TILE_K * TILE_M, (K + TILE_K - 1) / TILE_K, (M + TILE_M - 1) / TILE_M, 4u, (Allocator*)0);
-        if (AT_data.empty())
-            return -100;
-
-        #pragma omp parallel for num_threads(opt.num_threads)
-        for (int ppj = 0; ppj < nn_M; ppj++)
+        const int params[6] = {typeindex, use_bf16_weight ? 5 : use_fp16_weight ? 3 : 1, transA, TILE_M, TILE_K, opt.num_threads};
+        uint64_t digest = 0;
+        if (packed_weight_cache_get(opt, A_data, params, 6, AT_data, digest) != 0)
         {
-            const int i = ppj * TILE_M;
+            AT_data.create(TILE_K * TILE_M, (K + TILE_K - 1) / TILE_K, (M + TILE_M - 1) / TILE_M, 4u, (Allocator*)0);
+            if (AT_data.empty())
+                return -100;
 
-            for (int k = 0; k < K; k += TILE_K)
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int ppj = 0; ppj < nn_M; ppj++)
             {
-                const int max_ii = std::min((M - i), TILE_M);
-                const int max_kk = std::min((K - k), TILE_K);
+                const int i = ppj * TILE_M;
 
-                Mat AT_tile = AT_data.channel(i / TILE_M).row_range(k / TILE_K, 1);
-
-                if (transA)
-                {
-                    transpose_pack_A_tile(A_data, AT_tile, i, max_ii, k, max_kk);
-                }
-                else
+                for (int k = 0; k < K; k += TILE_K)
                 {
-                    pack_A_tile(A_data, AT_tile, i, max_ii, k, max_kk);
+                    const int max_ii = std::min((M - i), TILE_M);
+                    const int max_kk = std::min((K - k), TILE_K);
+
+                    Mat AT_tile = AT_data.channel(i / TILE_M).row_range(k / TILE_K, 1);
+
+                    if (transA)
+                    {
+                        transpose_pack_A_tile(A_data, AT_tile, i, max_ii, k, max_kk);
+                    }
+                    else
+                    {
+                        pack_A_tile(A_data, AT_tile, i, max_ii, k, max_kk);
+                    }
                 }
             }
+
+            if (use_bf16_weight)
+            {
+                Option opt_pack = opt;
+                opt_pack.blob_allocator = 0;
+
+                Mat AT_data_bf16;
+                cast_float32_to_bfloat16(AT_data, AT_data_bf16, opt_pack);
+                if (AT_data_bf16.empty())
+                    return -100;
+
+                AT_data = AT_data_bf16;
+            }
+            if (use_fp16_weight)
+            {
+                Option opt_pack = opt;
+                opt_pack.blob_allocator = 0;
+
+                Mat AT_data_fp16;
+                cast_float32_to_float16(AT_data, AT_data_fp16, opt_pack);
+                if (AT_data_fp16.empty())
+                    return -100;
+
+                AT_data = AT_data_fp16;
+            }
+
+            packed_weight_cache_put(opt, digest, AT_data);
         }
 
         if (opt.lightmode)
             A_data.release();
     }
 
-    if (constantB)
+    if (constantB && !weight_quant_bits)
     {
         const int N = constantN;
         const int K = constantK;
@@ -7279,34 +7520,66 @@ int Gemm_x86::create_pipeline(const Option& opt)
         const int nn_N = (N + TILE_N - 1) / TILE_N;
         const int nn_K = (K + TILE_K - 1) / TILE_K;
 
-        BT_data.create(TILE_K * TILE_N, (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 4u, (Allocator*)0);
-        if (BT_data.empty())
-            return -100;
+        const int params[6] = {typeindex, use_bf16_weight ? 6 : use_fp16_weight ? 4 : 2, transB, TILE_N, TILE_K, opt.num_threads};
+        uint64_t digest = 0;
+        if (packed_weight_cache_get(opt, B_data, params, 6, BT_data, digest) != 0)
+        {
+            BT_data.create(TILE_K * TILE_N, (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 4u, (Allocator*)0);
+            if (BT_data.empty())
+                return -100;
 
-        const int nn_NK = nn_N * nn_K;
+            const int nn_NK = nn_N * nn_K;
 
-        #pragma omp parallel for num_threads(opt.num_threads)
-        for (int ppjk = 0; ppjk < nn_NK; ppjk++)
-        {
-            const int ppj = ppjk / nn_K;
-            const int ppk = ppjk % nn_K;
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int ppjk = 0; ppjk < nn_NK; ppjk++)
+            {
+                const int ppj = ppjk / nn_K;
+                const int ppk = ppjk % nn_K;
 
-            const int j = ppj * TILE_N;
-            const int k = ppk * TILE_K;
+                const int j = ppj * TILE_N;
+                const int k = ppk * TILE_K;
 
-            const int max_jj = std::min((N - j), TILE_N);
-            const int max_kk = std::min((K - k), TILE_K);
+                const int max_jj = std::min((N - j), TILE_N);
+                const int max_kk = std::min((K - k), TILE_K);
 
-            Mat BT_tile = BT_data.channel(j / TILE_N).row_range(k / TILE_K, 1);
+                Mat BT_tile = BT_data.channel(j / TILE_N).row_range(k / TILE_K, 1);
 
-            if (transB)
+                if (transB)
+                {
+                    pack_B_tile(B_data, BT_tile, j, max_jj, k, max_kk);
+                }
+                else
+                {
+                    transpose_pack_B_tile(B_data, BT_tile, j, max_jj, k, max_kk);
+                }
+            }
+
+            if (use_bf16_weight)
             {
-                pack_B_tile(B_data, BT_tile, j, max_jj, k, max_kk);
+                Option opt_pack = opt;
+                opt_pack.blob_allocator = 0;
+
+                Mat BT_data_bf16;
+                cast_float32_to_bfloat16(BT_data, BT_data_bf16, opt_pack);
+                if (BT_data_bf16.empty())
+                    return -100;
+
+                BT_data = BT_data_bf16;
             }
-            else
+            if (use_fp16_weight)
             {
-                transpose_pack_B_tile(B_data, BT_tile, j, max_jj, k, max_kk);
+                Option opt_pack = opt;
+                opt_pack.blob_allocator = 0;
+
+                Mat BT_data_fp16;
+                cast_float32_to_float16(BT_data, BT_data_fp16, opt_pack);
+                if (BT_data_fp16.empty())
+                    return -100;
+
+                BT_data = BT_data_fp16;
             }
+
+            packed_weight_cache_put(opt, digest, BT_data);
         }
 
         if (opt.lightmode)
@@ -7509,7 +7782,7 @@ int Gemm_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& to
         return -100;
 
     int _nT = nT ? nT : opt.num_threads;
-    if (nT != 0 && opt.num_threads != nT)
+    if (nT != 0 && opt.num_threads != nT && !opt.use_parallel_branch)
     {
         // force num_threads the same as in create_pipeline
         // so we could use pre-packed A/B from the same tile config
@@ -7517,7 +7790,14 @@ int Gemm_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& to
     }
 
     int ret = 0;
-    if (constantA && constantB)
+    if (weight_quant_bits)
+    {
+        const Mat& A = constantA ? A_data : bottom_blobs[0];
+        const Mat& B = constantB ? B_data : bottom_blobs[0];
+        const Mat& W_scales = constantA ? A_data_quant_scales : B_data_quant_scales;
+        ret = gemm_x86_weight_quant(A, B, W_scales, C, top_blob, broadcast_type_C, constantA, transA, transB, output_transpose, constantK, weight_quant_bits, weight_quant_group_size, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+    }
+    else if (constantA && constantB)
     {
         ret = gemm_AT_BT_x86(AT_data, BT_data, C, top_blob, broadcast_type_C, constantM, constantN, constantK, output_transpose, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
     }
@@ -7608,7 +7888,7 @@ struct gemm_x86_int8_omp_args
     float beta;
 };
 
-static int gemm_x86_int8(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob, int broadcast_type_C, int transA, int transB, int output_transpose, float alpha, float beta, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
+static int gemm_x86_int8(const Mat& A, float A_static_int8_scale, const Mat& B, float B_static_int8_scale, const Mat& C, Mat& top_blob, int broadcast_type_C, int transA, int transB, int output_transpose, float alpha, float beta, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
 {
     // NCNN_LOGE("gemm_x86_int8");
 
@@ -7660,15 +7940,25 @@ static int gemm_x86_int8(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob
     if (A_int8_scales.empty())
         return -100;
 
-    // dynamic quantize B
-    float B_int8_scale;
-    compute_B_int8_scale(B, B_int8_scale);
+    // dynamic quantize B unless the static scale is known
+    float B_int8_scale = B_static_int8_scale;
+    if (B_int8_scale == 0.f)
+        compute_B_int8_scale(B, B_int8_scale);
 
     // const float output_descale = 1.f / (A_int8_scale * B_int8_scale);
     Mat output_descales(M, 4u, opt.workspace_allocator);
     if (output_descales.empty())
         return -100;
 
+    if (A_static_int8_scale != 0.f)
+    {
+        for (int i = 0; i < M; i++)
+        {
+            A_int8_scales[i] = A_static_int8_scale;
+            output_descales[i] = 1.f / (A_static_int8_scale * B_int8_scale);
+        }
+    }
+
     // NCNN_LOGE("arm ds %f %f", 1/A_int8_scale, 1/B_int8_scale);
 
     // pack B
@@ -7738,7 +8028,7 @@ static int gemm_x86_int8(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob
 
                 if (j == 0)
                 {
-                    if (k == 0)
+                    if (k == 0 && A_static_int8_scale == 0.f)
                     {
                         if (transA)
                             transpose_compute_A_tile_int8_scales(A, A_int8_scales, B_int8_scale, output_descales, i, max_ii);
@@ -7764,7 +8054,7 @@ static int gemm_x86_int8(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob
     return 0;
 }
 
-static int gemm_AT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Mat& B, const Mat& C, Mat& top_blob, int broadcast_type_C, int M, int K, int transB, int output_transpose, float alpha, float beta, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
+static int gemm_AT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Mat& B, float B_static_int8_scale, const Mat& C, Mat& top_blob, int broadcast_type_C, int M, int K, int transB, int output_transpose, float alpha, float beta, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
 {
     // NCNN_LOGE("gemm_AT_x86_int8");
 
@@ -7787,9 +8077,10 @@ static int gemm_AT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Mat&
 
     const int nn_NK = nn_N * nn_K;
 
-    // dynamic quantize B
-    float B_int8_scale;
-    compute_B_int8_scale(B, B_int8_scale);
+    // dynamic quantize B unless the static scale is known
+    float B_int8_scale = B_static_int8_scale;
+    if (B_int8_scale == 0.f)
+        compute_B_int8_scale(B, B_int8_scale);
 
     // NCNN_LOGE("%.4f %.4f", A_int8_scale, B_int8_scale);
 
@@ -7873,7 +8164,7 @@ static int gemm_AT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Mat&
     return 0;
 }
 
-static int gemm_BT_x86_int8(const Mat& A, const Mat& BT, float B_int8_scale, const Mat& C, Mat& top_blob, int broadcast_type_C, int N, int K, int transA, int output_transpose, float alpha, float beta, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
+static int gemm_BT_x86_int8(const Mat& A, float A_static_int8_scale, const Mat& BT, float B_int8_scale, const Mat& C, Mat& top_blob, int broadcast_type_C, int N, int K, int transA, int output_transpose, float alpha, float beta, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
 {
     // NCNN_LOGE("gemm_BT_x86_int8");
 
@@ -7898,6 +8189,15 @@ static int gemm_BT_x86_int8(const Mat& A, const Mat& BT, float B_int8_scale, con
     if (output_descales.empty())
         return -100;
 
+    if (A_static_int8_scale != 0.f)
+    {
+        for (int i = 0; i < M; i++)
+        {
+            A_int8_scales[i] = A_static_int8_scale;
+            output_descales[i] = 1.f / (A_static_int8_scale * B_int8_scale);
+        }
+    }
+
     // NCNN_LOGE("scale %.4f  %.4f", A_int8_scale, B_int8_scale);
 
     Mat ATX;
@@ -7971,7 +8271,7 @@ static int gemm_BT_x86_int8(const Mat& A, const Mat& BT, float B_int8_scale, con
 
                 if (j == 0)
                 {
-                    if (k == 0)
+                    if (k == 0 && A_static_int8_scale == 0.f)
                     {
                         if (transA)
                             transpose_compute_A_tile_int8_scales(A, A_int8_scales, B_int8_scale, output_descales, i, max_ii);
@@ -8326,13 +8626,24 @@ int Gemm_x86::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat
         return -100;
 
     int _nT = nT ? nT : opt.num_threads;
-    if (nT != 0 && opt.num_threads != nT)
+    if (nT != 0 && opt.num_threads != nT && !opt.use_parallel_branch)
     {
         // force num_threads the same as in create_pipeline
         // so we could use pre-packed A/B from the same tile config
         NCNN_LOGE("opt.num_threads %d changed, gemm will use load-time value %d", opt.num_threads, nT);
     }
 
+    // static input scales from calibration, 0 for dynamic quantize
+    float A_static_int8_scale = 0.f;
+    float B_static_int8_scale = 0.f;
+    if (int8_scale_term == 3)
+    {
+        if (!constantA)
+            A_static_int8_scale = bottom_blob_int8_scales[0];
+        if (!constantB)
+            B_static_int8_scale = bottom_blob_int8_scales[constantA ? 0 : 1];
+    }
+
     int ret = 0;
     if (constantA && constantB)
     {
@@ -8341,18 +8652,18 @@ int Gemm_x86::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat
     else if (constantA)
     {
         const Mat& B = bottom_blobs[0];
-        ret = gemm_AT_x86_int8(AT_data, A_data_int8_scales, B, C, top_blob, broadcast_type_C, constantM, constantK, transB, output_transpose, alpha, beta, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+        ret = gemm_AT_x86_int8(AT_data, A_data_int8_scales, B, B_static_int8_scale, C, top_blob, broadcast_type_C, constantM, constantK, transB, output_transpose, alpha, beta, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
     }
     else if (constantB)
     {
         const Mat& A = bottom_blobs[0];
-        ret = gemm_BT_x86_int8(A, BT_data, B_data_int8_scale, C, top_blob, broadcast_type_C, constantN, constantK, transA, output_transpose, alpha, beta, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+        ret = gemm_BT_x86_int8(A, A_static_int8_scale, BT_data, B_data_int8_scale, C, top_blob, broadcast_type_C, constantN, constantK, transA, output_transpose, alpha, beta, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
     }
     else
     {
         const Mat& A = bottom_blobs[0];
         const Mat& B = bottom_blobs[1];
-        ret = gemm_x86_int8(A, B, C, top_blob, broadcast_type_C, transA, transB, output_transpose, alpha, beta, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+        ret = gemm_x86_int8(A, A_static_int8_scale, B, B_static_int8_scale, C, top_blob, broadcast_type_C, transA, transB, output_transpose, alpha, beta, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
     }
 
     return ret;
@@ -0,0 +1,600 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+static void gru_int8_interleave_weight(const Mat& weight, int q, int bs, int num_gates, int gate_stride, int K, signed char* pp)
+{
+    // bs rows of each gate side by side, adjacent k pairs form one madd operand, odd K is padded with zero
+    for (int k = 0; k < K; k += 2)
+    {
+        for (int g = 0; g < num_gates; g++)
+        {
+            for (int i = 0; i < bs; i++)
+            {
+                const signed char* p = weight.row<const signed char>(gate_stride * g + q + i);
+
+                pp[0] = p[k];
+                pp[1] = k + 1 < K ? p[k + 1] : 0;
+                pp += 2;
+            }
+        }
+    }
+}
+
+static void gru_transform_weight_int8(const Mat& weight_xc, const Mat& weight_xc_int8_scales, const Mat& weight_hc, const Mat& weight_hc_int8_scales, Mat& weight_xc_tm, Mat& weight_xc_tm_int8_descales, Mat& weight_hc_tm, Mat& weight_hc_tm_int8_descales, int size, int num_output, int num_directions, const Option& opt)
+{
+    const int size_pair = (size + 1) / 2 * 2;
+    const int num_output_pair = (num_output + 1) / 2 * 2;
+
+    weight_xc_tm.create(size_pair * num_output * 3, 1, num_directions, 1u, 1);
+    weight_hc_tm.create(num_output_pair * num_output * 3, 1, num_directions, 1u, 1);
+    weight_xc_tm_int8_descales.create(num_output * 3, num_directions);
+    weight_hc_tm_int8_descales.create(num_output * 3, num_directions);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int dr = 0; dr < num_directions; dr++)
+    {
+        const Mat weight_xc_dr = weight_xc.channel(dr);
+        const Mat weight_hc_dr = weight_hc.channel(dr);
+
+        // the input projection treats the R U N rows as one matrix
+        {
+            signed char* pp = weight_xc_tm.channel(dr);
+
+            const int M = num_output * 3;
+
+            int j = 0;
+#if __SSE2__
+#if __AVX2__
+#if __AVX512F__
+            for (; j + 15 < M; j += 16)
+            {
+                gru_int8_interleave_weight(weight_xc_dr, j, 16, 1, 0, size, pp + j * size_pair);
+            }
+#endif // __AVX512F__
+            for (; j + 7 < M; j += 8)
+            {
+                gru_int8_interleave_weight(weight_xc_dr, j, 8, 1, 0, size, pp + j * size_pair);
+            }
+#endif // __AVX2__
+            for (; j + 3 < M; j += 4)
+            {
+                gru_int8_interleave_weight(weight_xc_dr, j, 4, 1, 0, size, pp + j * size_pair);
+            }
+#endif // __SSE2__
+            for (; j < M; j++)
+            {
+                gru_int8_interleave_weight(weight_xc_dr, j, 1, 1, 0, size, pp + j * size_pair);
+            }
+        }
+
+        // the recurrent weights keep R U N of the same hidden units together
+        {
+            signed char* pp = weight_hc_tm.channel(dr);
+
+            int q = 0;
+#if __SSE2__
+#if __AVX2__
+#if __AVX512F__
+            for (; q + 15 < num_output; q += 16)
+            {
+                gru_int8_interleave_weight(weight_hc_dr, q, 16, 3, num_output, num_output, pp + q * 3 * num_output_pair);
+            }
+#endif // __AVX512F__
+            for (; q + 7 < num_output; q += 8)
+            {
+                gru_int8_interleave_weight(weight_hc_dr, q, 8, 3, num_output, num_output, pp + q * 3 * num_output_pair);
+            }
+#endif // __AVX2__
+            for (; q + 3 < num_output; q += 4)
+            {
+                gru_int8_interleave_weight(weight_hc_dr, q, 4, 3, num_output, num_output, pp + q * 3 * num_output_pair);
+            }
+#endif // __SSE2__
+            for (; q < num_output; q++)
+            {
+                gru_int8_interleave_weight(weight_hc_dr, q, 1, 3, num_output, num_output, pp + q * 3 * num_output_pair);
+            }
+        }
+
+        const float* weight_xc_int8_scales_ptr = weight_xc_int8_scales.row(dr);
+        const float* weight_hc_int8_scales_ptr = weight_hc_int8_scales.row(dr);
+        float* weight_xc_descales_ptr = weight_xc_tm_int8_descales.row(dr);
+        float* weight_hc_descales_ptr = weight_hc_tm_int8_descales.row(dr);
+
+        for (int i = 0; i < num_output * 3; i++)
+        {
+            weight_xc_descales_ptr[i] = 1.f / weight_xc_int8_scales_ptr[i];
+            weight_hc_descales_ptr[i] = 1.f / weight_hc_int8_scales_ptr[i];
+        }
+    }
+}
+
+#if __SSE2__
+static NCNN_FORCEINLINE __m128i gru_int8_loadl_epi8_epi16(const signed char* p)
+{
+    __m128i _p = _mm_loadl_epi64((const __m128i*)p);
+#if __SSE4_1__
+    return _mm_cvtepi8_epi16(_p);
+#else
+    return _mm_srai_epi16(_mm_unpacklo_epi8(_p, _p), 8);
+#endif
+}
+#endif // __SSE2__
+
+static void gru_int8_quantize(const float* ptr, int size, float scale, short* outptr)
+{
+    // int8 values are kept in int16 so that two adjacent ones form one madd operand
+    for (int i = 0; i < size; i++)
+    {
+        outptr[i] = float2int8(ptr[i] * scale);
+    }
+
+    if (size % 2 == 1)
+        outptr[size] = 0;
+}
+
+static float gru_int8_get_absmax(const float* ptr, int size)
+{
+    float absmax = 0.f;
+    for (int i = 0; i < size; i++)
+    {
+        absmax = std::max(absmax, (float)fabs(ptr[i]));
+    }
+
+    return absmax;
+}
+
+static int gru_int8_dynamic_quantize(const Mat& bottom_blob, const Mat& bottom_blob_static_int8_scales, Mat& bottom_blob_int8, Mat& bottom_blob_int8_descales, const Option& opt)
+{
+    const int size = bottom_blob.w;
+    const int T = bottom_blob.h;
+
+    bottom_blob_int8.create((size + 1) / 2 * 2, T, 2u, opt.workspace_allocator);
+    if (bottom_blob_int8.empty())
+        return -100;
+
+    bottom_blob_int8_descales.create(T, 4u, opt.workspace_allocator);
+    if (bottom_blob_int8_descales.empty())
+        return -100;
+
+    // dynamic quantize each timestep unless the static scale is known
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int t = 0; t < T; t++)
+    {
+        const float* ptr = bottom_blob.row(t);
+
+        float scale;
+        if (!bottom_blob_static_int8_scales.empty())
+        {
+            scale = bottom_blob_static_int8_scales[0];
+        }
+        else
+        {
+            const float absmax = gru_int8_get_absmax(ptr, size);
+            scale = absmax == 0.f ? 1.f : 127.f / absmax;
+        }
+
+        bottom_blob_int8_descales[t] = 1.f / scale;
+
+        gru_int8_quantize(ptr, size, scale, bottom_blob_int8.row<short>(t));
+    }
+
+    return 0;
+}
+
+static void gru_int8_gates_x(const Mat& bottom_blob_int8, const Mat& bottom_blob_int8_descales, Mat& gates_x, const Mat& weight_xc_tm, const float* weight_xc_descales, const float* bias_c, const Option& opt)
+{
+    // gates_x = bias + weight_xc * x for all timesteps, four timesteps share one weight load
+    const int size_pair = bottom_blob_int8.w;
+    const int T = bottom_blob_int8.h;
+    const int M = gates_x.w;
+
+    const signed char* weight_xc_ptr = weight_xc_tm;
+
+    int remain_M_start = 0;
+#if __SSE2__
+    int nn_M = 0;
+#if __AVX2__
+#if __AVX512F__
+    nn_M = (M - remain_M_start) >> 4;
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int jj = 0; jj < nn_M; jj++)
+    {
+        const int j = remain_M_start + jj * 16;
+
+        const signed char* kptr0 = weight_xc_ptr + j * size_pair;
+
+        __m512 _descale_w = _mm512_loadu_ps(weight_xc_descales + j);
+        __m512 _bias = _mm512_loadu_ps(bias_c + j);
+
+        int t = 0;
+        for (; t + 3 < T; t += 4)
+        {
+            const int* x0 = bottom_blob_int8.row<const int>(t);
+            const int* x1 = bottom_blob_int8.row<const int>(t + 1);
+            const int* x2 = bottom_blob_int8.row<const int>(t + 2);
+            const int* x3 = bottom_blob_int8.row<const int>(t + 3);
+
+            const signed char* kptr = kptr0;
+
+            __m512i _sum0 = _mm512_setzero_si512();
+            __m512i _sum1 = _mm512_setzero_si512();
+            __m512i _sum2 = _mm512_setzero_si512();
+            __m512i _sum3 = _mm512_setzero_si512();
+            for (int i = 0; i < size_pair / 2; i++)
+            {
+                __m512i _w = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)kptr));
+
+                _sum0 = _mm512_comp_dpwssd_epi32(_sum0, _w, _mm512_set1_epi32(x0[i]));
+                _sum1 = _mm512_comp_dpwssd_epi32(_sum1, _w, _mm512_set1_epi32(x1[i]));
+                _sum2 = _mm512_comp_dpwssd_epi32(_sum2, _w, _mm512_set1_epi32(x2[i]));
+                _sum3 = _mm512_comp_dpwssd_epi32(_sum3, _w, _mm512_set1_epi32(x3[i]));
+
+                kptr += 32;
+            }
+
+            _mm512_storeu_ps(gates_x.row(t) + j, _mm512_fmadd_ps(_mm512_cvtepi32_ps(_sum0), _mm512_mul_ps(_descale_w, _mm512_set1_ps(bottom_blob_int8_descales[t])), _bias));
+            _mm512_storeu_ps(gates_x.row(t + 1) + j, _mm512_fmadd_ps(_mm512_cvtepi32_ps(_sum1), _mm512_mul_ps(_descale_w, _mm512_set1_ps(bottom_blob_int8_descales[t + 1])), _bias));
+            _mm512_storeu_ps(gates_x.row(t + 2) + j, _mm512_fmadd_ps(_mm512_cvtepi32_ps(_sum2), _mm512_mul_ps(_descale_w, _mm512_set1_ps(bottom_blob_int8_descales[t + 2])), _bias));
+            _mm512_storeu_ps(gates_x.row(t + 3) + j, _mm512_fmadd_ps(_mm512_cvtepi32_ps(_sum3), _mm512_mul_ps(_descale_w, _mm512_set1_ps(bottom_blob_int8_descales[t + 3])), _bias));
+        }
+        for (; t < T; t++)
+        {
+            const int* x0 = bottom_blob_int8.row<const int>(t);
+
+            const signed char* kptr = kptr0;
+
+            __m512i _sum0 = _mm512_setzero_si512();
+            for (int i = 0; i < size_pair / 2; i++)
+            {
+                __m512i _w = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)kptr));
+
+                _sum0 = _mm512_comp_dpwssd_epi32(_sum0, _w, _mm512_set1_epi32(x0[i]));
+
+                kptr += 32;
+            }
+
+            _mm512_storeu_ps(gates_x.row(t) + j, _mm512_fmadd_ps(_mm512_cvtepi32_ps(_sum0), _mm512_mul_ps(_descale_w, _mm512_set1_ps(bottom_blob_int8_descales[t])), _bias));
+        }
+    }
+    remain_M_start += nn_M << 4;
+#endif // __AVX512F__
+    nn_M = (M - remain_M_start) >> 3;
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int jj = 0; jj < nn_M; jj++)
+    {
+        const int j = remain_M_start + jj * 8;
+
+        const signed char* kptr0 = weight_xc_ptr + j * size_pair;
+
+        __m256 _descale_w = _mm256_loadu_ps(weight_xc_descales + j);
+        __m256 _bias = _mm256_loadu_ps(bias_c + j);
+
+        int t = 0;
+        for (; t + 3 < T; t += 4)
+        {
+            const int* x0 = bottom_blob_int8.row<const int>(t);
+            const int* x1 = bottom_blob_int8.row<const int>(t + 1);
+            const int* x2 = bottom_blob_int8.row<const int>(t + 2);
+            const int* x3 = bottom_blob_int8.row<const int>(t + 3);
+
+            const signed char* kptr = kptr0;
+
+            __m256i _sum0 = _mm256_setzero_si256();
+            __m256i _sum1 = _mm256_setzero_si256();
+            __m256i _sum2 = _mm256_setzero_si256();
+            __m256i _sum3 = _mm256_setzero_si256();
+            for (int i = 0; i < size_pair / 2; i++)
+            {
+                __m256i _w = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)kptr));
+
+                _sum0 = _mm256_comp_dpwssd_epi32(_sum0, _w, _mm256_set1_epi32(x0[i]));
+                _sum1 = _mm256_comp_dpwssd_epi32(_sum1, _w, _mm256_set1_epi32(x1[i]));
+                _sum2 = _mm256_comp_dpwssd_epi32(_sum2, _w, _mm256_set1_epi32(x2[i]));
+                _sum3 = _mm256_comp_dpwssd_epi32(_sum3, _w, _mm256_set1_epi32(x3[i]));
+
+                kptr += 16;
+            }
+
+            _mm256_storeu_ps(gates_x.row(t) + j, _mm256_comp_fmadd_ps(_mm256_cvtepi32_ps(_sum0), _mm256_mul_ps(_descale_w, _mm256_set1_ps(bottom_blob_int8_descales[t])), _bias));
+            _mm256_storeu_ps(gates_x.row(t + 1) + j, _mm256_comp_fmadd_ps(_mm256_cvtepi32_ps(_sum1), _mm256_mul_ps(_descale_w, _mm256_set1_ps(bottom_blob_int8_descales[t + 1])), _bias));
+            _mm256_storeu_ps(gates_x.row(t + 2) + j, _mm256_comp_fmadd_ps(_mm256_cvtepi32_ps(_sum2), _mm256_mul_ps(_descale_w, _mm256_set1_ps(bottom_blob_int8_descales[t + 2])), _bias));
+            _mm256_storeu_ps(gates_x.row(t + 3) + j, _mm256_comp_fmadd_ps(_mm256_cvtepi32_ps(_sum3), _mm256_mul_ps(_descale_w, _mm256_set1_ps(bottom_blob_int8_descales[t + 3])), _bias));
+        }
+        for (; t < T; t++)
+        {
+            const int* x0 = bottom_blob_int8.row<const int>(t);
+
+            const signed char* kptr = kptr0;
+
+            __m256i _sum0 = _mm256_setzero_si256();
+            for (int i = 0; i < size_pair / 2; i++)
+            {
+                __m256i _w = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)kptr));
+
+                _sum0 = _mm256_comp_dpwssd_epi32(_sum0, _w, _mm256_set1_epi32(x0[i]));
+
+                kptr += 16;
+            }
+
+            _mm256_storeu_ps(gates_x.row(t) + j, _mm256_comp_fmadd_ps(_mm256_cvtepi32_ps(_sum0), _mm256_mul_ps(_descale_w, _mm256_set1_ps(bottom_blob_int8_descales[t])), _bias));
+        }
+    }
+    remain_M_start += nn_M << 3;
+#endif // __AVX2__
+    nn_M = (M - remain_M_start) >> 2;
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int jj = 0; jj < nn_M; jj++)
+    {
+        const int j = remain_M_start + jj * 4;
+
+        const signed char* kptr0 = weight_xc_ptr + j * size_pair;
+
+        __m128 _descale_w = _mm_loadu_ps(weight_xc_descales + j);
+        __m128 _bias = _mm_loadu_ps(bias_c + j);
+
+        int t = 0;
+        for (; t + 3 < T; t += 4)
+        {
+            const int* x0 = bottom_blob_int8.row<const int>(t);
+            const int* x1 = bottom_blob_int8.row<const int>(t + 1);
+            const int* x2 = bottom_blob_int8.row<const int>(t + 2);
+            const int* x3 = bottom_blob_int8.row<const int>(t + 3);
+
+            const signed char* kptr = kptr0;
+
+            __m128i _sum0 = _mm_setzero_si128();
+            __m128i _sum1 = _mm_setzero_si128();
+            __m128i _sum2 = _mm_setzero_si128();
+            __m128i _sum3 = _mm_setzero_si128();
+            for (int i = 0; i < size_pair / 2; i++)
+            {
+                __m128i _w = gru_int8_loadl_epi8_epi16(kptr);
+
+                _sum0 = _mm_comp_dpwssd_epi32(_sum0, _w, _mm_set1_epi32(x0[i]));
+                _sum1 = _mm_comp_dpwssd_epi32(_sum1, _w, _mm_set1_epi32(x1[i]));
+                _sum2 = _mm_comp_dpwssd_epi32(_sum2, _w, _mm_set1_epi32(x2[i]));
+                _sum3 = _mm_comp_dpwssd_epi32(_sum3, _w, _mm_set1_epi32(x3[i]));
+
+                kptr += 8;
+            }
+
+            _mm_storeu_ps(gates_x.row(t) + j, _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_sum0), _mm_mul_ps(_descale_w, _mm_set1_ps(bottom_blob_int8_descales[t])), _bias));
+            _mm_storeu_ps(gates_x.row(t + 1) + j, _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_sum1), _mm_mul_ps(_descale_w, _mm_set1_ps(bottom_blob_int8_descales[t + 1])), _bias));
+            _mm_storeu_ps(gates_x.row(t + 2) + j, _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_sum2), _mm_mul_ps(_descale_w, _mm_set1_ps(bottom_blob_int8_descales[t + 2])), _bias));
+            _mm_storeu_ps(gates_x.row(t + 3) + j, _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_sum3), _mm_mul_ps(_descale_w, _mm_set1_ps(bottom_blob_int8_descales[t + 3])), _bias));
+        }
+        for (; t < T; t++)
+        {
+            const int* x0 = bottom_blob_int8.row<const int>(t);
+
+            const signed char* kptr = kptr0;
+
+            __m128i _sum0 = _mm_setzero_si128();
+            for (int i = 0; i < size_pair / 2; i++)
+            {
+                __m128i _w = gru_int8_loadl_epi8_epi16(kptr);
+
+                _sum0 = _mm_comp_dpwssd_epi32(_sum0, _w, _mm_set1_epi32(x0[i]));
+
+                kptr += 8;
+            }
+
+            _mm_storeu_ps(gates_x.row(t) + j, _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_sum0), _mm_mul_ps(_descale_w, _mm_set1_ps(bottom_blob_int8_descales[t])), _bias));
+        }
+    }
+    remain_M_start += nn_M << 2;
+#endif // __SSE2__
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int j = remain_M_start; j < M; j++)
+    {
+        const signed char* kptr0 = weight_xc_ptr + j * size_pair;
+
+        for (int t = 0; t < T; t++)
+        {
+            const short* x0 = bottom_blob_int8.row<const short>(t);
+
+            const signed char* kptr = kptr0;
+
+            int sum = 0;
+            for (int i = 0; i < size_pair; i += 2)
+            {
+                sum += kptr[0] * x0[i] + kptr[1] * x0[i + 1];
+                kptr += 2;
+            }
+
+            gates_x.row(t)[j] = bias_c[j] + sum * (weight_xc_descales[j] * bottom_blob_int8_descales[t]);
+        }
+    }
+}
+
+static void gru_int8(const Mat& gates_x, Mat& top_blob, int reverse, const Mat& weight_hc_tm, const float* weight_hc_descales, const float* bias_c_BN, Mat& hidden_state, Mat& hidden_state_int8, const Option& opt)
+{
+    const int T = gates_x.h;
+    const int num_output = top_blob.w;
+    const int num_output_pair = hidden_state_int8.w;
+
+    const float* weight_hc_descales_R = weight_hc_descales;
+    const float* weight_hc_descales_U = weight_hc_descales + num_output;
+    const float* weight_hc_descales_N = weight_hc_descales + num_output * 2;
+
+    // unroll
+    for (int t = 0; t < T; t++)
+    {
+        int ti = reverse ? T - 1 - t : t;
+
+        // the previous output row is the hidden state
+        const float* hs = t == 0 ? (const float*)hidden_state : top_blob.row(reverse ? ti + 1 : ti - 1);
+
+        // dynamic quantize hidden_state
+        const float absmax = gru_int8_get_absmax(hs, num_output);
+        const float scale = absmax == 0.f ? 1.f : 127.f / absmax;
+        const float descale_h = 1.f / scale;
+
+        gru_int8_quantize(hs, num_output, scale, hidden_state_int8);
+
+        const int* hs_int8 = hidden_state_int8;
+
+        const float* gates_x_R = gates_x.row(ti);
+        const float* gates_x_U = gates_x_R + num_output;
+        const float* gates_x_N = gates_x_R + num_output * 2;
+
+        float* outptr = top_blob.row(ti);
+
+        int remain_num_output_start = 0;
+#if __SSE2__
+        int nn_num_output = 0;
+#if __AVX2__
+#if __AVX512F__
+        nn_num_output = (num_output - remain_num_output_start) >> 4;
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int qq = 0; qq < nn_num_output; qq++)
+        {
+            const int q = remain_num_output_start + qq * 16;
+
+            const signed char* kptr = (const signed char*)weight_hc_tm + q * 3 * num_output_pair;
+
+            __m512i _sum_R = _mm512_setzero_si512();
+            __m512i _sum_U = _mm512_setzero_si512();
+            __m512i _sum_N = _mm512_setzero_si512();
+            for (int i = 0; i < num_output_pair / 2; i++)
+            {
+                __m512i _h = _mm512_set1_epi32(hs_int8[i]);
+
+                _sum_R = _mm512_comp_dpwssd_epi32(_sum_R, _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)kptr)), _h);
+                _sum_U = _mm512_comp_dpwssd_epi32(_sum_U, _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(kptr + 32))), _h);
+                _sum_N = _mm512_comp_dpwssd_epi32(_sum_N, _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(kptr + 64))), _h);
+
+                kptr += 96;
+            }
+
+            __m512 _descale_h = _mm512_set1_ps(descale_h);
+
+            __m512 _R = _mm512_fmadd_ps(_mm512_cvtepi32_ps(_sum_R), _mm512_mul_ps(_mm512_loadu_ps(weight_hc_descales_R + q), _descale_h), _mm512_loadu_ps(gates_x_R + q));
+            __m512 _U = _mm512_fmadd_ps(_mm512_cvtepi32_ps(_sum_U), _mm512_mul_ps(_mm512_loadu_ps(weight_hc_descales_U + q), _descale_h), _mm512_loadu_ps(gates_x_U + q));
+            __m512 _N = _mm512_fmadd_ps(_mm512_cvtepi32_ps(_sum_N), _mm512_mul_ps(_mm512_loadu_ps(weight_hc_descales_N + q), _descale_h), _mm512_loadu_ps(bias_c_BN + q));
+
+            _R = sigmoid_avx512(_R);
+            _U = sigmoid_avx512(_U);
+            _N = tanh_avx512(_mm512_fmadd_ps(_R, _N, _mm512_loadu_ps(gates_x_N + q)));
+
+            // h_t := (1 - update) .* new + update .* h_{t-1}
+            __m512 _H = _mm512_fmadd_ps(_U, _mm512_sub_ps(_mm512_loadu_ps(hs + q), _N), _N);
+
+            _mm512_storeu_ps(outptr + q, _H);
+        }
+        remain_num_output_start += nn_num_output << 4;
+#endif // __AVX512F__
+        nn_num_output = (num_output - remain_num_output_start) >> 3;
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int qq = 0; qq < nn_num_output; qq++)
+        {
+            const int q = remain_num_output_start + qq * 8;
+
+            const signed char* kptr = (const signed char*)weight_hc_tm + q * 3 * num_output_pair;
+
+            __m256i _sum_R = _mm256_setzero_si256();
+            __m256i _sum_U = _mm256_setzero_si256();
+            __m256i _sum_N = _mm256_setzero_si256();
+            for (int i = 0; i < num_output_pair / 2; i++)
+            {
+                __m256i _h = _mm256_set1_epi32(hs_int8[i]);
+
+                _sum_R = _mm256_comp_dpwssd_epi32(_sum_R, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)kptr)), _h);
+                _sum_U = _mm256_comp_dpwssd_epi32(_sum_U, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(kptr + 16))), _h);
+                _sum_N = _mm256_comp_dpwssd_epi32(_sum_N, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(kptr + 32))), _h);
+
+                kptr += 48;
+            }
+
+            __m256 _descale_h = _mm256_set1_ps(descale_h);
+
+            __m256 _R = _mm256_comp_fmadd_ps(_mm256_cvtepi32_ps(_sum_R), _mm256_mul_ps(_mm256_loadu_ps(weight_hc_descales_R + q), _descale_h), _mm256_loadu_ps(gates_x_R + q));
+            __m256 _U = _mm256_comp_fmadd_ps(_mm256_cvtepi32_ps(_sum_U), _mm256_mul_ps(_mm256_loadu_ps(weight_hc_descales_U + q), _descale_h), _mm256_loadu_ps(gates_x_U + q));
+            __m256 _N = _mm256_comp_fmadd_ps(_mm256_cvtepi32_ps(_sum_N), _mm256_mul_ps(_mm256_loadu_ps(weight_hc_descales_N + q), _descale_h), _mm256_loadu_ps(bias_c_BN + q));
+
+            _R = sigmoid_avx(_R);
+            _U = sigmoid_avx(_U);
+            _N = tanh_avx(_mm256_comp_fmadd_ps(_R, _N, _mm256_loadu_ps(gates_x_N + q)));
+
+            // h_t := (1 - update) .* new + update .* h_{t-1}
+            __m256 _H = _mm256_comp_fmadd_ps(_U, _mm256_sub_ps(_mm256_loadu_ps(hs + q), _N), _N);
+
+            _mm256_storeu_ps(outptr + q, _H);
+        }
+        remain_num_output_start += nn_num_output << 3;
+#endif // __AVX2__
+        nn_num_output = (num_output - remain_num_output_start) >> 2;
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int qq = 0; qq < nn_num_output; qq++)
+        {
+            const int q = remain_num_output_start + qq * 4;
+
+            const signed char* kptr = (const signed char*)weight_hc_tm + q * 3 * num_output_pair;
+
+            __m128i _sum_R = _mm_setzero_si128();
+            __m128i _sum_U = _mm_setzero_si128();
+            __m128i _sum_N = _mm_setzero_si128();
+            for (int i = 0; i < num_output_pair / 2; i++)
+            {
+                __m128i _h = _mm_set1_epi32(hs_int8[i]);
+
+                _sum_R = _mm_comp_dpwssd_epi32(_sum_R, gru_int8_loadl_epi8_epi16(kptr), _h);
+                _sum_U = _mm_comp_dpwssd_epi32(_sum_U, gru_int8_loadl_epi8_epi16(kptr + 8), _h);
+                _sum_N = _mm_comp_dpwssd_epi32(_sum_N, gru_int8_loadl_epi8_epi16(kptr + 16), _h);
+
+                kptr += 24;
+            }
+
+            __m128 _descale_h = _mm_set1_ps(descale_h);
+
+            __m128 _R = _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_sum_R), _mm_mul_ps(_mm_loadu_ps(weight_hc_descales_R + q), _descale_h), _mm_loadu_ps(gates_x_R + q));
+            __m128 _U = _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_sum_U), _mm_mul_ps(_mm_loadu_ps(weight_hc_descales_U + q), _descale_h), _mm_loadu_ps(gates_x_U + q));
+            __m128 _N = _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_sum_N), _mm_mul_ps(_mm_loadu_ps(weight_hc_descales_N + q), _descale_h), _mm_loadu_ps(bias_c_BN + q));
+
+            _R = sigmoid_sse(_R);
+            _U = sigmoid_sse(_U);
+            _N = tanh_sse(_mm_comp_fmadd_ps(_R, _N, _mm_loadu_ps(gates_x_N + q)));
+
+            // h_t := (1 - update) .* new + update .* h_{t-1}
+            __m128 _H = _mm_comp_fmadd_ps(_U, _mm_sub_ps(_mm_loadu_ps(hs + q), _N), _N);
+
+            _mm_storeu_ps(outptr + q, _H);
+        }
+        remain_num_output_start += nn_num_output << 2;
+#endif // __SSE2__
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = remain_num_output_start; q < num_output; q++)
+        {
+            const signed char* kptr = (const signed char*)weight_hc_tm + q * 3 * num_output_pair;
+            const short* hs_int16 = hidden_state_int8;
+
+            int sum_R = 0;
+            int sum_U = 0;
+            int sum_N = 0;
+            for (int i = 0; i < num_output_pair; i += 2)
+            {
+                sum_R += kptr[0] * hs_int16[i] + kptr[1] * hs_int16[i + 1];
+                sum_U += kptr[2] * hs_int16[i] + kptr[3] * hs_int16[i + 1];
+                sum_N += kptr[4] * hs_int16[i] + kptr[5] * hs_int16[i + 1];
+                kptr += 6;
+            }
+
+            float R = gates_x_R[q] + sum_R * (weight_hc_descales_R[q] * descale_h);
+            float U = gates_x_U[q] + sum_U * (weight_hc_descales_U[q] * descale_h);
+            float N = bias_c_BN[q] + sum_N * (weight_hc_descales_N[q] * descale_h);
+
+            R = 1.f / (1.f + expf(-R));
+            U = 1.f / (1.f + expf(-U));
+            N = tanhf(gates_x_N[q] + R * N);
+
+            // h_t := (1 - update) .* new + update .* h_{t-1}
+            outptr[q] = (1 - U) * N + U * hs[q];
+        }
+    }
+
+    if (T > 0)
+    {
+        memcpy((float*)hidden_state, top_blob.row(reverse ? 0 : T - 1), num_output * sizeof(float));
+    }
+}
@@ -19,10 +19,18 @@ HardSwish_x86::HardSwish_x86()
 #if __SSE2__
     support_packing = true;
 #endif // __SSE2__
+#if NCNN_BF16
+    support_bf16_storage = true;
+#endif
 }
 
 int HardSwish_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
 {
+#if NCNN_BF16
+    if (opt.use_bf16_storage && bottom_top_blob.elembits() == 16)
+        return forward_inplace_bf16s(bottom_top_blob, opt);
+#endif
+
     int w = bottom_top_blob.w;
     int h = bottom_top_blob.h;
     int d = bottom_top_blob.d;
@@ -96,4 +104,81 @@ int HardSwish_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) cons
     return 0;
 }
 
+#if NCNN_BF16
+int HardSwish_x86::forward_inplace_bf16s(Mat& bottom_top_blob, const Option& opt) const
+{
+    int w = bottom_top_blob.w;
+    int h = bottom_top_blob.h;
+    int d = bottom_top_blob.d;
+    int channels = bottom_top_blob.c;
+    int elempack = bottom_top_blob.elempack;
+    int size = w * h * d * elempack;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
+    {
+        unsigned short* ptr = bottom_top_blob.channel(q);
+
+        int i = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+        __m512 _zero_avx512 = _mm512_setzero_ps();
+        __m512 _one_avx512 = _mm512_set1_ps(1.f);
+        __m512 _alpha_avx512 = _mm512_set1_ps(alpha);
+        __m512 _beta_avx512 = _mm512_set1_ps(beta);
+        for (; i + 15 < size; i += 16)
+        {
+            __m512 _p = bfloat2float_avx512(_mm256_loadu_si256((const __m256i*)ptr));
+            __m512 _ans = _mm512_fmadd_ps(_p, _alpha_avx512, _beta_avx512);
+            _ans = _mm512_min_ps(_mm512_max_ps(_ans, _zero_avx512), _one_avx512);
+            _p = _mm512_mul_ps(_ans, _p);
+            _mm256_storeu_si256((__m256i*)ptr, float2bfloat_avx512(_p));
+            ptr += 16;
+        }
+#endif // __AVX512F__
+        __m256 _zero_avx = _mm256_setzero_ps();
+        __m256 _one_avx = _mm256_set1_ps(1.f);
+        __m256 _alpha_avx = _mm256_set1_ps(alpha);
+        __m256 _beta_avx = _mm256_set1_ps(beta);
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = bfloat2float_avx(_mm_loadu_si128((const __m128i*)ptr));
+            __m256 _ans = _mm256_comp_fmadd_ps(_p, _alpha_avx, _beta_avx);
+            _ans = _mm256_min_ps(_mm256_max_ps(_ans, _zero_avx), _one_avx);
+            _p = _mm256_mul_ps(_ans, _p);
+            _mm_storeu_si128((__m128i*)ptr, float2bfloat_avx(_p));
+            ptr += 8;
+        }
+#endif // __AVX__
+        __m128 _zero = _mm_setzero_ps();
+        __m128 _one = _mm_set1_ps(1.f);
+        __m128 _alpha = _mm_set1_ps(alpha);
+        __m128 _beta = _mm_set1_ps(beta);
+        for (; i + 3 < size; i += 4)
+        {
+            __m128 _p = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)ptr));
+            __m128 _ans = _mm_comp_fmadd_ps(_p, _alpha, _beta);
+            _ans = _mm_min_ps(_mm_max_ps(_ans, _zero), _one);
+            _p = _mm_mul_ps(_ans, _p);
+            _mm_storel_epi64((__m128i*)ptr, float2bfloat_sse(_p, _p));
+            ptr += 4;
+        }
+#endif // __SSE2__
+        for (; i < size; i++)
+        {
+            float v = bfloat16_to_float32(*ptr);
+            if (v < lower)
+                v = 0.f;
+            else if (v <= upper)
+                v = v * (v * alpha + beta);
+            *ptr = float32_to_bfloat16(v);
+            ptr++;
+        }
+    }
+
+    return 0;
+}
+#endif // NCNN_BF16
+
 } // namespace ncnn
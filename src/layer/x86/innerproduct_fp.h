@@ -6,8 +6,15 @@ void innerproduct_fp16s_sse_f16c(const Mat& bottom_blob, Mat& top_blob, const Ma
 void innerproduct_transform_kernel_fp16s_sse_f16c(const Mat& weight_data, Mat& weight_data_tm, int num_input, int num_output, const Option& opt);
 #endif
 
+#if NCNN_RUNTIME_CPU && NCNN_AVX512BF16 && __AVX512F__ && !__AVX512BF16__
+void innerproduct_bf16s_sse_avx512bf16(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_tm, const Mat& bias_data, int activation_type, const Mat& activation_params, const Option& opt);
+void innerproduct_transform_kernel_bf16s_sse_avx512bf16(const Mat& weight_data, Mat& weight_data_tm, int num_input, int num_output, const Option& opt);
+#endif
+
 #if NCNN_IMPL_FP16S
 static void innerproduct_fp16s_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_tm, const Mat& bias_data, int activation_type, const Mat& activation_params, const Option& opt)
+#elif NCNN_IMPL_BF16S
+static void innerproduct_bf16s_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_tm, const Mat& bias_data, int activation_type, const Mat& activation_params, const Option& opt)
 #else
 static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_tm, const Mat& bias_data, int activation_type, const Mat& activation_params, const Option& opt)
 #endif
@@ -19,6 +26,13 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
         return;
     }
 #else // NCNN_RUNTIME_CPU
+#if NCNN_RUNTIME_CPU && NCNN_IMPL_BF16S && NCNN_AVX512BF16 && __AVX512F__ && !__AVX512BF16__
+    if (ncnn::cpu_support_x86_avx512_bf16())
+    {
+        innerproduct_bf16s_sse_avx512bf16(bottom_blob, top_blob, weight_data_tm, bias_data, activation_type, activation_params, opt);
+        return;
+    }
+#endif
 
     const int num_input = bottom_blob.w * bottom_blob.elempack;
     const int outw = top_blob.w;
@@ -48,7 +62,7 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 _sum0 = _mm512_loadu_ps(bias_data_ptr + p * 16);
             }
 
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
             const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
             const float* kptr = weight_data_tm.row(p);
@@ -56,6 +70,36 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
             const float* sptr = bottom_blob;
 
             int i = 0;
+#if NCNN_IMPL_BF16S && __AVX512BF16__
+            {
+                // dot two adjacent inputs per lane, the interleaved lanes hold outputs 0-3 8-11 4-7 12-15
+                __m512 _sum01 = _mm512_setzero_ps();
+                __m512 _sum23 = _mm512_setzero_ps();
+                for (; i + 3 < num_input; i += 4)
+                {
+                    __m512i _w01 = _mm512_loadu_si512(kptr);
+                    __m512i _w23 = _mm512_loadu_si512(kptr + 32);
+                    __m256i _w0 = _mm512_extracti32x8_epi32(_w01, 0);
+                    __m256i _w1 = _mm512_extracti32x8_epi32(_w01, 1);
+                    __m256i _w2 = _mm512_extracti32x8_epi32(_w23, 0);
+                    __m256i _w3 = _mm512_extracti32x8_epi32(_w23, 1);
+                    __m512i _ww01 = _mm512_inserti32x8(_mm512_castsi256_si512(_mm256_unpacklo_epi16(_w0, _w1)), _mm256_unpackhi_epi16(_w0, _w1), 1);
+                    __m512i _ww23 = _mm512_inserti32x8(_mm512_castsi256_si512(_mm256_unpacklo_epi16(_w2, _w3)), _mm256_unpackhi_epi16(_w2, _w3), 1);
+
+                    __m512i _val01 = _mm512_set1_epi32((int)(float32_to_bfloat16(sptr[0]) | ((unsigned int)float32_to_bfloat16(sptr[1]) << 16)));
+                    __m512i _val23 = _mm512_set1_epi32((int)(float32_to_bfloat16(sptr[2]) | ((unsigned int)float32_to_bfloat16(sptr[3]) << 16)));
+
+                    _sum01 = _mm512_dpbf16_ps(_sum01, (__m512bh)_val01, (__m512bh)_ww01);
+                    _sum23 = _mm512_dpbf16_ps(_sum23, (__m512bh)_val23, (__m512bh)_ww23);
+
+                    sptr += 4;
+                    kptr += 64;
+                }
+
+                __m512i _index = _mm512_setr_epi32(0, 1, 2, 3, 8, 9, 10, 11, 4, 5, 6, 7, 12, 13, 14, 15);
+                _sum1 = _mm512_permutexvar_ps(_index, _mm512_add_ps(_sum01, _sum23));
+            }
+#endif // NCNN_IMPL_BF16S && __AVX512BF16__
             for (; i + 7 < num_input; i += 8)
             {
                 __m512 _val0 = _mm512_set1_ps(sptr[0]);
@@ -69,6 +113,13 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m512 _w1 = _mm512_cvtph_ps(_mm512_extracti32x8_epi32(_w01, 1));
                 __m512 _w2 = _mm512_cvtph_ps(_mm512_extracti32x8_epi32(_w23, 0));
                 __m512 _w3 = _mm512_cvtph_ps(_mm512_extracti32x8_epi32(_w23, 1));
+#elif NCNN_IMPL_BF16S
+                __m512i _w01 = _mm512_loadu_si512(kptr);
+                __m512i _w23 = _mm512_loadu_si512(kptr + 32);
+                __m512 _w0 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w01, 0));
+                __m512 _w1 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w01, 1));
+                __m512 _w2 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w23, 0));
+                __m512 _w3 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w23, 1));
 #else
                 __m512 _w0 = _mm512_loadu_ps(kptr + 16 * 0);
                 __m512 _w1 = _mm512_loadu_ps(kptr + 16 * 1);
@@ -92,6 +143,13 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m512 _w5 = _mm512_cvtph_ps(_mm512_extracti32x8_epi32(_w45, 1));
                 __m512 _w6 = _mm512_cvtph_ps(_mm512_extracti32x8_epi32(_w67, 0));
                 __m512 _w7 = _mm512_cvtph_ps(_mm512_extracti32x8_epi32(_w67, 1));
+#elif NCNN_IMPL_BF16S
+                __m512i _w45 = _mm512_loadu_si512(kptr + 64);
+                __m512i _w67 = _mm512_loadu_si512(kptr + 96);
+                __m512 _w4 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w45, 0));
+                __m512 _w5 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w45, 1));
+                __m512 _w6 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w67, 0));
+                __m512 _w7 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w67, 1));
 #else
                 __m512 _w4 = _mm512_loadu_ps(kptr + 16 * 4);
                 __m512 _w5 = _mm512_loadu_ps(kptr + 16 * 5);
@@ -120,6 +178,13 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m512 _w1 = _mm512_cvtph_ps(_mm512_extracti32x8_epi32(_w01, 1));
                 __m512 _w2 = _mm512_cvtph_ps(_mm512_extracti32x8_epi32(_w23, 0));
                 __m512 _w3 = _mm512_cvtph_ps(_mm512_extracti32x8_epi32(_w23, 1));
+#elif NCNN_IMPL_BF16S
+                __m512i _w01 = _mm512_loadu_si512(kptr);
+                __m512i _w23 = _mm512_loadu_si512(kptr + 32);
+                __m512 _w0 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w01, 0));
+                __m512 _w1 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w01, 1));
+                __m512 _w2 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w23, 0));
+                __m512 _w3 = bfloat2float_avx512(_mm512_extracti32x8_epi32(_w23, 1));
 #else
                 __m512 _w0 = _mm512_loadu_ps(kptr);
                 __m512 _w1 = _mm512_loadu_ps(kptr + 16);
@@ -140,6 +205,8 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m512 _val = _mm512_set1_ps(sptr[0]);
 #if NCNN_IMPL_FP16S
                 __m512 _w = _mm512_cvtph_ps(_mm256_lddqu_si256((const __m256i*)kptr));
+#elif NCNN_IMPL_BF16S
+                __m512 _w = bfloat2float_avx512(_mm256_lddqu_si256((const __m256i*)kptr));
 #else
                 __m512 _w = _mm512_loadu_ps(kptr);
 #endif
@@ -184,7 +251,7 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 _sum0 = _mm256_loadu_ps(bias_data_ptr + p * 8);
             }
 
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
             const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
             const float* kptr = weight_data_tm.row(p);
@@ -205,6 +272,13 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m256 _w1 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w01, 1));
                 __m256 _w2 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w23, 0));
                 __m256 _w3 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w23, 1));
+#elif NCNN_IMPL_BF16S
+                __m256i _w01 = _mm256_lddqu_si256((const __m256i*)kptr);
+                __m256i _w23 = _mm256_lddqu_si256((const __m256i*)(kptr + 16));
+                __m256 _w0 = bfloat2float_avx(_mm256_extractf128_si256(_w01, 0));
+                __m256 _w1 = bfloat2float_avx(_mm256_extractf128_si256(_w01, 1));
+                __m256 _w2 = bfloat2float_avx(_mm256_extractf128_si256(_w23, 0));
+                __m256 _w3 = bfloat2float_avx(_mm256_extractf128_si256(_w23, 1));
 #else
                 __m256 _w0 = _mm256_loadu_ps(kptr);
                 __m256 _w1 = _mm256_loadu_ps(kptr + 8);
@@ -228,6 +302,13 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m256 _w5 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w45, 1));
                 __m256 _w6 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w67, 0));
                 __m256 _w7 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w67, 1));
+#elif NCNN_IMPL_BF16S
+                __m256i _w45 = _mm256_lddqu_si256((const __m256i*)(kptr + 32));
+                __m256i _w67 = _mm256_lddqu_si256((const __m256i*)(kptr + 48));
+                __m256 _w4 = bfloat2float_avx(_mm256_extractf128_si256(_w45, 0));
+                __m256 _w5 = bfloat2float_avx(_mm256_extractf128_si256(_w45, 1));
+                __m256 _w6 = bfloat2float_avx(_mm256_extractf128_si256(_w67, 0));
+                __m256 _w7 = bfloat2float_avx(_mm256_extractf128_si256(_w67, 1));
 #else
                 __m256 _w4 = _mm256_loadu_ps(kptr + 32);
                 __m256 _w5 = _mm256_loadu_ps(kptr + 40);
@@ -256,6 +337,13 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m256 _w1 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w01, 1));
                 __m256 _w2 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w23, 0));
                 __m256 _w3 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w23, 1));
+#elif NCNN_IMPL_BF16S
+                __m256i _w01 = _mm256_lddqu_si256((const __m256i*)kptr);
+                __m256i _w23 = _mm256_lddqu_si256((const __m256i*)(kptr + 16));
+                __m256 _w0 = bfloat2float_avx(_mm256_extractf128_si256(_w01, 0));
+                __m256 _w1 = bfloat2float_avx(_mm256_extractf128_si256(_w01, 1));
+                __m256 _w2 = bfloat2float_avx(_mm256_extractf128_si256(_w23, 0));
+                __m256 _w3 = bfloat2float_avx(_mm256_extractf128_si256(_w23, 1));
 #else
                 __m256 _w0 = _mm256_loadu_ps(kptr);
                 __m256 _w1 = _mm256_loadu_ps(kptr + 8);
@@ -276,6 +364,8 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m256 _val = _mm256_set1_ps(sptr[0]);
 #if NCNN_IMPL_FP16S
                 __m256 _w = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)kptr));
+#elif NCNN_IMPL_BF16S
+                __m256 _w = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)kptr));
 #else
                 __m256 _w = _mm256_loadu_ps(kptr);
 #endif
@@ -323,7 +413,7 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 _sum0 = _mm_loadu_ps(bias_data_ptr + p * 4);
             }
 
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
             const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
             const float* kptr = weight_data_tm.row(p);
@@ -355,6 +445,13 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m256 _w23 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w0123, 1));
                 __m256 _w45 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w4567, 0));
                 __m256 _w67 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w4567, 1));
+#elif NCNN_IMPL_BF16S
+                __m256i _w0123 = _mm256_lddqu_si256((const __m256i*)kptr);
+                __m256i _w4567 = _mm256_lddqu_si256((const __m256i*)(kptr + 16));
+                __m256 _w01 = bfloat2float_avx(_mm256_extractf128_si256(_w0123, 0));
+                __m256 _w23 = bfloat2float_avx(_mm256_extractf128_si256(_w0123, 1));
+                __m256 _w45 = bfloat2float_avx(_mm256_extractf128_si256(_w4567, 0));
+                __m256 _w67 = bfloat2float_avx(_mm256_extractf128_si256(_w4567, 1));
 #else
                 __m256 _w01 = _mm256_loadu_ps(kptr);
                 __m256 _w23 = _mm256_loadu_ps(kptr + 8);
@@ -386,6 +483,10 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m256i _w0123 = _mm256_lddqu_si256((const __m256i*)kptr);
                 __m256 _w01 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w0123, 0));
                 __m256 _w23 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w0123, 1));
+#elif NCNN_IMPL_BF16S
+                __m256i _w0123 = _mm256_lddqu_si256((const __m256i*)kptr);
+                __m256 _w01 = bfloat2float_avx(_mm256_extractf128_si256(_w0123, 0));
+                __m256 _w23 = bfloat2float_avx(_mm256_extractf128_si256(_w0123, 1));
 #else
                 __m256 _w01 = _mm256_loadu_ps(kptr);
                 __m256 _w23 = _mm256_loadu_ps(kptr + 8);
@@ -399,10 +500,17 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m128 _val2 = _mm_set1_ps(sptr[2]);
                 __m128 _val3 = _mm_set1_ps(sptr[3]);
 
+#if NCNN_IMPL_BF16S
+                __m128 _w0 = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)kptr));
+                __m128 _w1 = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)(kptr + 4)));
+                __m128 _w2 = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)(kptr + 8)));
+                __m128 _w3 = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)(kptr + 12)));
+#else
                 __m128 _w0 = _mm_loadu_ps(kptr);
                 __m128 _w1 = _mm_loadu_ps(kptr + 4);
                 __m128 _w2 = _mm_loadu_ps(kptr + 8);
                 __m128 _w3 = _mm_loadu_ps(kptr + 12);
+#endif
 
                 _sum0 = _mm_comp_fmadd_ps(_val0, _w0, _sum0);
                 _sum1 = _mm_comp_fmadd_ps(_val1, _w1, _sum1);
@@ -418,6 +526,8 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m128 _val = _mm_set1_ps(sptr[0]);
 #if NCNN_IMPL_FP16S
                 __m128 _w = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)kptr));
+#elif NCNN_IMPL_BF16S
+                __m128 _w = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)kptr));
 #else
                 __m128 _w = _mm_loadu_ps(kptr);
 #endif
@@ -473,7 +583,7 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 sums[7] = bias_data_ptr[p + 7];
             }
 
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
             const unsigned short* w0 = weight_data_tm.row<const unsigned short>(p);
             const unsigned short* w1 = weight_data_tm.row<const unsigned short>(p + 1);
             const unsigned short* w2 = weight_data_tm.row<const unsigned short>(p + 2);
@@ -513,6 +623,11 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m256 _w1 = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)w1));
                 __m256 _w2 = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)w2));
                 __m256 _w3 = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)w3));
+#elif NCNN_IMPL_BF16S
+                __m256 _w0 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w0));
+                __m256 _w1 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w1));
+                __m256 _w2 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w2));
+                __m256 _w3 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w3));
 #else
                 __m256 _w0 = _mm256_loadu_ps(w0);
                 __m256 _w1 = _mm256_loadu_ps(w1);
@@ -530,6 +645,11 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m256 _w5 = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)w5));
                 __m256 _w6 = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)w6));
                 __m256 _w7 = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)w7));
+#elif NCNN_IMPL_BF16S
+                __m256 _w4 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w4));
+                __m256 _w5 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w5));
+                __m256 _w6 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w6));
+                __m256 _w7 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w7));
 #else
                 __m256 _w4 = _mm256_loadu_ps(w4);
                 __m256 _w5 = _mm256_loadu_ps(w5);
@@ -563,6 +683,15 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 sums[5] += *m * float16_to_float32(*w5);
                 sums[6] += *m * float16_to_float32(*w6);
                 sums[7] += *m * float16_to_float32(*w7);
+#elif NCNN_IMPL_BF16S
+                sums[0] += *m * bfloat16_to_float32(*w0);
+                sums[1] += *m * bfloat16_to_float32(*w1);
+                sums[2] += *m * bfloat16_to_float32(*w2);
+                sums[3] += *m * bfloat16_to_float32(*w3);
+                sums[4] += *m * bfloat16_to_float32(*w4);
+                sums[5] += *m * bfloat16_to_float32(*w5);
+                sums[6] += *m * bfloat16_to_float32(*w6);
+                sums[7] += *m * bfloat16_to_float32(*w7);
 #else
                 sums[0] += *m * *w0;
                 sums[1] += *m * *w1;
@@ -615,7 +744,7 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 sums[3] = bias_data_ptr[p + 3];
             }
 
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
             const unsigned short* w0 = weight_data_tm.row<const unsigned short>(p);
             const unsigned short* w1 = weight_data_tm.row<const unsigned short>(p + 1);
             const unsigned short* w2 = weight_data_tm.row<const unsigned short>(p + 2);
@@ -643,6 +772,11 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m256 _w1 = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)w1));
                 __m256 _w2 = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)w2));
                 __m256 _w3 = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)w3));
+#elif NCNN_IMPL_BF16S
+                __m256 _w0 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w0));
+                __m256 _w1 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w1));
+                __m256 _w2 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w2));
+                __m256 _w3 = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w3));
 #else
                 __m256 _w0 = _mm256_loadu_ps(w0);
                 __m256 _w1 = _mm256_loadu_ps(w1);
@@ -676,6 +810,11 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m128 _w1 = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)w1));
                 __m128 _w2 = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)w2));
                 __m128 _w3 = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)w3));
+#elif NCNN_IMPL_BF16S
+                __m128 _w0 = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)w0));
+                __m128 _w1 = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)w1));
+                __m128 _w2 = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)w2));
+                __m128 _w3 = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)w3));
 #else
                 __m128 _w0 = _mm_loadu_ps(w0);
                 __m128 _w1 = _mm_loadu_ps(w1);
@@ -701,6 +840,11 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 sums[1] += *m * float16_to_float32(*w1);
                 sums[2] += *m * float16_to_float32(*w2);
                 sums[3] += *m * float16_to_float32(*w3);
+#elif NCNN_IMPL_BF16S
+                sums[0] += *m * bfloat16_to_float32(*w0);
+                sums[1] += *m * bfloat16_to_float32(*w1);
+                sums[2] += *m * bfloat16_to_float32(*w2);
+                sums[3] += *m * bfloat16_to_float32(*w3);
 #else
                 sums[0] += *m * *w0;
                 sums[1] += *m * *w1;
@@ -743,7 +887,7 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
             if (bias_data_ptr)
                 sum = bias_data_ptr[p];
 
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
             const unsigned short* w = weight_data_tm.row<const unsigned short>(p);
 #else
             const float* w = (const float*)weight_data_tm + num_input * p;
@@ -759,6 +903,8 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m256 _m = _mm256_loadu_ps(m);
 #if NCNN_IMPL_FP16S
                 __m256 _w = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)w));
+#elif NCNN_IMPL_BF16S
+                __m256 _w = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)w));
 #else
                 __m256 _w = _mm256_loadu_ps(w);
 #endif
@@ -774,6 +920,8 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
                 __m128 _m = _mm_loadu_ps(m);
 #if NCNN_IMPL_FP16S
                 __m128 _w = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)w));
+#elif NCNN_IMPL_BF16S
+                __m128 _w = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)w));
 #else
                 __m128 _w = _mm_loadu_ps(w);
 #endif
@@ -787,6 +935,8 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
             {
 #if NCNN_IMPL_FP16S
                 sum += *m * float16_to_float32(*w);
+#elif NCNN_IMPL_BF16S
+                sum += *m * bfloat16_to_float32(*w);
 #else
                 sum += *m * *w;
 #endif
@@ -813,6 +963,8 @@ static void innerproduct_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& w
 
 #if NCNN_IMPL_FP16S
 static void innerproduct_transform_kernel_fp16s_sse(const Mat& weight_data, Mat& weight_data_tm, int num_input, int num_output, const Option& opt)
+#elif NCNN_IMPL_BF16S
+static void innerproduct_transform_kernel_bf16s_sse(const Mat& weight_data, Mat& weight_data_tm, int num_input, int num_output, const Option& opt)
 #else
 static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weight_data_tm, int num_input, int num_output, const Option& opt)
 #endif
@@ -824,6 +976,13 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
         return;
     }
 #else // NCNN_RUNTIME_CPU
+#if NCNN_RUNTIME_CPU && NCNN_IMPL_BF16S && NCNN_AVX512BF16 && __AVX512F__ && !__AVX512BF16__
+    if (ncnn::cpu_support_x86_avx512_bf16())
+    {
+        innerproduct_transform_kernel_bf16s_sse_avx512bf16(weight_data, weight_data_tm, num_input, num_output, opt);
+        return;
+    }
+#endif
 
     int out_elempack = 1;
 #if __SSE2__
@@ -848,7 +1007,7 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
     {
         Mat weight_data_r2 = weight_data.reshape(num_input, num_output);
 
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
         weight_data_tm.create(num_input, num_output / 16, (size_t)32u, 16);
 #else
         weight_data_tm.create(num_input, num_output / 16, (size_t)64u, 16);
@@ -856,7 +1015,7 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
 
         for (int q = 0; q + 15 < num_output; q += 16)
         {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
             unsigned short* g0 = weight_data_tm.row<unsigned short>(q / 16);
 #else
             float* g0 = weight_data_tm.row(q / 16);
@@ -903,6 +1062,42 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
 
                 transpose16x16_epi16(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7, _r8, _r9, _ra, _rb, _rc, _rd, _re, _rf);
 
+                _mm256_storeu_si256((__m256i*)g0, _r0);
+                _mm256_storeu_si256((__m256i*)(g0 + 16), _r1);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 2), _r2);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 3), _r3);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 4), _r4);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 5), _r5);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 6), _r6);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 7), _r7);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 8), _r8);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 9), _r9);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 10), _ra);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 11), _rb);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 12), _rc);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 13), _rd);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 14), _re);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 15), _rf);
+#elif NCNN_IMPL_BF16S
+                __m256i _r0 = float2bfloat_avx512(_mm512_loadu_ps(k0));
+                __m256i _r1 = float2bfloat_avx512(_mm512_loadu_ps(k1));
+                __m256i _r2 = float2bfloat_avx512(_mm512_loadu_ps(k2));
+                __m256i _r3 = float2bfloat_avx512(_mm512_loadu_ps(k3));
+                __m256i _r4 = float2bfloat_avx512(_mm512_loadu_ps(k4));
+                __m256i _r5 = float2bfloat_avx512(_mm512_loadu_ps(k5));
+                __m256i _r6 = float2bfloat_avx512(_mm512_loadu_ps(k6));
+                __m256i _r7 = float2bfloat_avx512(_mm512_loadu_ps(k7));
+                __m256i _r8 = float2bfloat_avx512(_mm512_loadu_ps(k8));
+                __m256i _r9 = float2bfloat_avx512(_mm512_loadu_ps(k9));
+                __m256i _ra = float2bfloat_avx512(_mm512_loadu_ps(ka));
+                __m256i _rb = float2bfloat_avx512(_mm512_loadu_ps(kb));
+                __m256i _rc = float2bfloat_avx512(_mm512_loadu_ps(kc));
+                __m256i _rd = float2bfloat_avx512(_mm512_loadu_ps(kd));
+                __m256i _re = float2bfloat_avx512(_mm512_loadu_ps(ke));
+                __m256i _rf = float2bfloat_avx512(_mm512_loadu_ps(kf));
+
+                transpose16x16_epi16(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7, _r8, _r9, _ra, _rb, _rc, _rd, _re, _rf);
+
                 _mm256_storeu_si256((__m256i*)g0, _r0);
                 _mm256_storeu_si256((__m256i*)(g0 + 16), _r1);
                 _mm256_storeu_si256((__m256i*)(g0 + 16 * 2), _r2);
@@ -1032,6 +1227,68 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
                 _r6e = _mm256_unpacklo_epi64(_tmpj, _tmpn);
                 _r7f = _mm256_unpackhi_epi64(_tmpj, _tmpn);
 
+                _mm256_storeu_si256((__m256i*)g0, _r08);
+                _mm256_storeu_si256((__m256i*)(g0 + 16), _r19);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 2), _r2a);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 3), _r3b);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 4), _r4c);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 5), _r5d);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 6), _r6e);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 7), _r7f);
+#elif NCNN_IMPL_BF16S
+                __m128i _r0 = float2bfloat_avx(_mm256_loadu_ps(k0));
+                __m128i _r1 = float2bfloat_avx(_mm256_loadu_ps(k1));
+                __m128i _r2 = float2bfloat_avx(_mm256_loadu_ps(k2));
+                __m128i _r3 = float2bfloat_avx(_mm256_loadu_ps(k3));
+                __m128i _r4 = float2bfloat_avx(_mm256_loadu_ps(k4));
+                __m128i _r5 = float2bfloat_avx(_mm256_loadu_ps(k5));
+                __m128i _r6 = float2bfloat_avx(_mm256_loadu_ps(k6));
+                __m128i _r7 = float2bfloat_avx(_mm256_loadu_ps(k7));
+                __m128i _r8 = float2bfloat_avx(_mm256_loadu_ps(k8));
+                __m128i _r9 = float2bfloat_avx(_mm256_loadu_ps(k9));
+                __m128i _ra = float2bfloat_avx(_mm256_loadu_ps(ka));
+                __m128i _rb = float2bfloat_avx(_mm256_loadu_ps(kb));
+                __m128i _rc = float2bfloat_avx(_mm256_loadu_ps(kc));
+                __m128i _rd = float2bfloat_avx(_mm256_loadu_ps(kd));
+                __m128i _re = float2bfloat_avx(_mm256_loadu_ps(ke));
+                __m128i _rf = float2bfloat_avx(_mm256_loadu_ps(kf));
+
+                __m256i _r08 = combine4x2_epi32(_r0, _r8);
+                __m256i _r19 = combine4x2_epi32(_r1, _r9);
+                __m256i _r2a = combine4x2_epi32(_r2, _ra);
+                __m256i _r3b = combine4x2_epi32(_r3, _rb);
+                __m256i _r4c = combine4x2_epi32(_r4, _rc);
+                __m256i _r5d = combine4x2_epi32(_r5, _rd);
+                __m256i _r6e = combine4x2_epi32(_r6, _re);
+                __m256i _r7f = combine4x2_epi32(_r7, _rf);
+
+                __m256i _tmp0 = _mm256_unpacklo_epi16(_r08, _r19);
+                __m256i _tmp1 = _mm256_unpackhi_epi16(_r08, _r19);
+                __m256i _tmp2 = _mm256_unpacklo_epi16(_r2a, _r3b);
+                __m256i _tmp3 = _mm256_unpackhi_epi16(_r2a, _r3b);
+                __m256i _tmp4 = _mm256_unpacklo_epi16(_r4c, _r5d);
+                __m256i _tmp5 = _mm256_unpackhi_epi16(_r4c, _r5d);
+                __m256i _tmp6 = _mm256_unpacklo_epi16(_r6e, _r7f);
+                __m256i _tmp7 = _mm256_unpackhi_epi16(_r6e, _r7f);
+
+                __m256i _tmpg = _mm256_unpacklo_epi32(_tmp0, _tmp2);
+                __m256i _tmph = _mm256_unpackhi_epi32(_tmp0, _tmp2);
+                __m256i _tmpi = _mm256_unpacklo_epi32(_tmp1, _tmp3);
+                __m256i _tmpj = _mm256_unpackhi_epi32(_tmp1, _tmp3);
+                __m256i _tmpk = _mm256_unpacklo_epi32(_tmp4, _tmp6);
+                __m256i _tmpl = _mm256_unpackhi_epi32(_tmp4, _tmp6);
+                __m256i _tmpm = _mm256_unpacklo_epi32(_tmp5, _tmp7);
+                __m256i _tmpn = _mm256_unpackhi_epi32(_tmp5, _tmp7);
+
+                _r08 = _mm256_unpacklo_epi64(_tmpg, _tmpk);
+                _r19 = _mm256_unpackhi_epi64(_tmpg, _tmpk);
+                _r2a = _mm256_unpacklo_epi64(_tmph, _tmpl);
+                _r3b = _mm256_unpackhi_epi64(_tmph, _tmpl);
+                _r4c = _mm256_unpacklo_epi64(_tmpi, _tmpm);
+                _r5d = _mm256_unpackhi_epi64(_tmpi, _tmpm);
+                _r6e = _mm256_unpacklo_epi64(_tmpj, _tmpn);
+                _r7f = _mm256_unpackhi_epi64(_tmpj, _tmpn);
+
                 _mm256_storeu_si256((__m256i*)g0, _r08);
                 _mm256_storeu_si256((__m256i*)(g0 + 16), _r19);
                 _mm256_storeu_si256((__m256i*)(g0 + 16 * 2), _r2a);
@@ -1115,6 +1372,23 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
                 g0[13] = float32_to_float16(*kd++);
                 g0[14] = float32_to_float16(*ke++);
                 g0[15] = float32_to_float16(*kf++);
+#elif NCNN_IMPL_BF16S
+                g0[0] = float32_to_bfloat16(*k0++);
+                g0[1] = float32_to_bfloat16(*k1++);
+                g0[2] = float32_to_bfloat16(*k2++);
+                g0[3] = float32_to_bfloat16(*k3++);
+                g0[4] = float32_to_bfloat16(*k4++);
+                g0[5] = float32_to_bfloat16(*k5++);
+                g0[6] = float32_to_bfloat16(*k6++);
+                g0[7] = float32_to_bfloat16(*k7++);
+                g0[8] = float32_to_bfloat16(*k8++);
+                g0[9] = float32_to_bfloat16(*k9++);
+                g0[10] = float32_to_bfloat16(*ka++);
+                g0[11] = float32_to_bfloat16(*kb++);
+                g0[12] = float32_to_bfloat16(*kc++);
+                g0[13] = float32_to_bfloat16(*kd++);
+                g0[14] = float32_to_bfloat16(*ke++);
+                g0[15] = float32_to_bfloat16(*kf++);
 #else
                 g0[0] = *k0++;
                 g0[1] = *k1++;
@@ -1143,7 +1417,7 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
     {
         Mat weight_data_r2 = weight_data.reshape(num_input, num_output);
 
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
         weight_data_tm.create(num_input, num_output / 8, (size_t)16u, 8);
 #else
         weight_data_tm.create(num_input, num_output / 8, (size_t)32u, 8);
@@ -1151,7 +1425,7 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
 
         for (int q = 0; q + 7 < num_output; q += 8)
         {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
             unsigned short* g0 = weight_data_tm.row<unsigned short>(q / 8);
 #else
             float* g0 = weight_data_tm.row(q / 8);
@@ -1183,6 +1457,26 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
 
                 transpose16x8_epi16(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7);
 
+                _mm256_storeu_si256((__m256i*)g0, _r0);
+                _mm256_storeu_si256((__m256i*)(g0 + 16), _r1);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 2), _r2);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 3), _r3);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 4), _r4);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 5), _r5);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 6), _r6);
+                _mm256_storeu_si256((__m256i*)(g0 + 16 * 7), _r7);
+#elif NCNN_IMPL_BF16S
+                __m256i _r0 = float2bfloat_avx512(_mm512_loadu_ps(k0));
+                __m256i _r1 = float2bfloat_avx512(_mm512_loadu_ps(k1));
+                __m256i _r2 = float2bfloat_avx512(_mm512_loadu_ps(k2));
+                __m256i _r3 = float2bfloat_avx512(_mm512_loadu_ps(k3));
+                __m256i _r4 = float2bfloat_avx512(_mm512_loadu_ps(k4));
+                __m256i _r5 = float2bfloat_avx512(_mm512_loadu_ps(k5));
+                __m256i _r6 = float2bfloat_avx512(_mm512_loadu_ps(k6));
+                __m256i _r7 = float2bfloat_avx512(_mm512_loadu_ps(k7));
+
+                transpose16x8_epi16(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7);
+
                 _mm256_storeu_si256((__m256i*)g0, _r0);
                 _mm256_storeu_si256((__m256i*)(g0 + 16), _r1);
                 _mm256_storeu_si256((__m256i*)(g0 + 16 * 2), _r2);
@@ -1239,6 +1533,26 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
 
                 transpose8x8_epi16(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7);
 
+                _mm_storeu_si128((__m128i*)g0, _r0);
+                _mm_storeu_si128((__m128i*)(g0 + 8), _r1);
+                _mm_storeu_si128((__m128i*)(g0 + 16), _r2);
+                _mm_storeu_si128((__m128i*)(g0 + 24), _r3);
+                _mm_storeu_si128((__m128i*)(g0 + 32), _r4);
+                _mm_storeu_si128((__m128i*)(g0 + 40), _r5);
+                _mm_storeu_si128((__m128i*)(g0 + 48), _r6);
+                _mm_storeu_si128((__m128i*)(g0 + 56), _r7);
+#elif NCNN_IMPL_BF16S
+                __m128i _r0 = float2bfloat_avx(_mm256_loadu_ps(k0));
+                __m128i _r1 = float2bfloat_avx(_mm256_loadu_ps(k1));
+                __m128i _r2 = float2bfloat_avx(_mm256_loadu_ps(k2));
+                __m128i _r3 = float2bfloat_avx(_mm256_loadu_ps(k3));
+                __m128i _r4 = float2bfloat_avx(_mm256_loadu_ps(k4));
+                __m128i _r5 = float2bfloat_avx(_mm256_loadu_ps(k5));
+                __m128i _r6 = float2bfloat_avx(_mm256_loadu_ps(k6));
+                __m128i _r7 = float2bfloat_avx(_mm256_loadu_ps(k7));
+
+                transpose8x8_epi16(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7);
+
                 _mm_storeu_si128((__m128i*)g0, _r0);
                 _mm_storeu_si128((__m128i*)(g0 + 8), _r1);
                 _mm_storeu_si128((__m128i*)(g0 + 16), _r2);
@@ -1290,6 +1604,15 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
                 g0[5] = float32_to_float16(*k5++);
                 g0[6] = float32_to_float16(*k6++);
                 g0[7] = float32_to_float16(*k7++);
+#elif NCNN_IMPL_BF16S
+                g0[0] = float32_to_bfloat16(*k0++);
+                g0[1] = float32_to_bfloat16(*k1++);
+                g0[2] = float32_to_bfloat16(*k2++);
+                g0[3] = float32_to_bfloat16(*k3++);
+                g0[4] = float32_to_bfloat16(*k4++);
+                g0[5] = float32_to_bfloat16(*k5++);
+                g0[6] = float32_to_bfloat16(*k6++);
+                g0[7] = float32_to_bfloat16(*k7++);
 #else
                 g0[0] = *k0++;
                 g0[1] = *k1++;
@@ -1310,7 +1633,7 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
     {
         Mat weight_data_r2 = weight_data.reshape(num_input, num_output);
 
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
         weight_data_tm.create(num_input, num_output / 4, (size_t)8u, 4);
 #else
         weight_data_tm.create(num_input, num_output / 4, (size_t)16u, 4);
@@ -1318,7 +1641,7 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
 
         for (int q = 0; q + 3 < num_output; q += 4)
         {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
             unsigned short* g0 = weight_data_tm.row<unsigned short>(q / 4);
 #else
             float* g0 = weight_data_tm.row(q / 4);
@@ -1345,6 +1668,18 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
                 __m128i _r23_fp16 = _mm256_cvtps_ph(_r23, _MM_FROUND_TRUNC);
                 _mm_storeu_si128((__m128i*)g0, _r01_fp16);
                 _mm_storeu_si128((__m128i*)(g0 + 8), _r23_fp16);
+#elif NCNN_IMPL_BF16S
+#if __AVX__
+                __m256 _r01 = combine4x2_ps(_r0, _r1);
+                __m256 _r23 = combine4x2_ps(_r2, _r3);
+                __m128i _r01_bf16 = float2bfloat_avx(_r01);
+                __m128i _r23_bf16 = float2bfloat_avx(_r23);
+#else
+                __m128i _r01_bf16 = float2bfloat_sse(_r0, _r1);
+                __m128i _r23_bf16 = float2bfloat_sse(_r2, _r3);
+#endif
+                _mm_storeu_si128((__m128i*)g0, _r01_bf16);
+                _mm_storeu_si128((__m128i*)(g0 + 8), _r23_bf16);
 #else
                 _mm_storeu_ps(g0, _r0);
                 _mm_storeu_ps(g0 + 4, _r1);
@@ -1365,6 +1700,11 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
                 g0[1] = float32_to_float16(*k1++);
                 g0[2] = float32_to_float16(*k2++);
                 g0[3] = float32_to_float16(*k3++);
+#elif NCNN_IMPL_BF16S
+                g0[0] = float32_to_bfloat16(*k0++);
+                g0[1] = float32_to_bfloat16(*k1++);
+                g0[2] = float32_to_bfloat16(*k2++);
+                g0[3] = float32_to_bfloat16(*k3++);
 #else
                 g0[0] = *k0++;
                 g0[1] = *k1++;
@@ -1382,6 +1722,9 @@ static void innerproduct_transform_kernel_sse(const Mat& weight_data, Mat& weigh
 #if NCNN_IMPL_FP16S
         Mat weight_data_r2 = weight_data.reshape(num_input, num_output);
         ncnn::cast_float32_to_float16(weight_data_r2, weight_data_tm, opt);
+#elif NCNN_IMPL_BF16S
+        Mat weight_data_r2 = weight_data.reshape(num_input, num_output);
+        ncnn::cast_float32_to_bfloat16(weight_data_r2, weight_data_tm, opt);
 #else
         weight_data_tm = weight_data;
 #endif
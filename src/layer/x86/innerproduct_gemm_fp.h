@@ -5,8 +5,14 @@
 void innerproduct_gemm_fp16s_sse_f16c(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_tm, const Mat& bias_data, int activation_type, const Mat& activation_params, const Option& opt);
 #endif
 
+#if NCNN_RUNTIME_CPU && NCNN_AVX512BF16 && __AVX512F__ && !__AVX512BF16__
+void innerproduct_gemm_bf16s_sse_avx512bf16(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_tm, const Mat& bias_data, int activation_type, const Mat& activation_params, const Option& opt);
+#endif
+
 #if NCNN_IMPL_FP16S
 static void innerproduct_gemm_fp16s_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_tm, const Mat& bias_data, int activation_type, const Mat& activation_params, const Option& opt)
+#elif NCNN_IMPL_BF16S
+static void innerproduct_gemm_bf16s_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_tm, const Mat& bias_data, int activation_type, const Mat& activation_params, const Option& opt)
 #else
 static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_tm, const Mat& bias_data, int activation_type, const Mat& activation_params, const Option& opt)
 #endif
@@ -18,6 +24,13 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
         return;
     }
 #else // NCNN_RUNTIME_CPU
+#if NCNN_RUNTIME_CPU && NCNN_IMPL_BF16S && NCNN_AVX512BF16 && __AVX512F__ && !__AVX512BF16__
+    if (ncnn::cpu_support_x86_avx512_bf16())
+    {
+        innerproduct_gemm_bf16s_sse_avx512bf16(bottom_blob, top_blob, weight_data_tm, bias_data, activation_type, activation_params, opt);
+        return;
+    }
+#endif
 
     const int num_input = bottom_blob.w;
     const int elempack = bottom_blob.elempack;
@@ -52,7 +65,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -103,6 +116,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
 #if NCNN_IMPL_FP16S
                     __m512 _w = _mm512_cvtph_ps(_mm256_lddqu_si256((const __m256i*)kptr));
+#elif NCNN_IMPL_BF16S
+                    __m512 _w = bfloat2float_avx512(_mm256_lddqu_si256((const __m256i*)kptr));
 #else
                     __m512 _w = _mm512_loadu_ps(kptr);
 #endif
@@ -173,7 +188,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -193,6 +208,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m512 _val = _mm512_set1_ps(m[0]);
 #if NCNN_IMPL_FP16S
                     __m512 _w = _mm512_cvtph_ps(_mm256_lddqu_si256((const __m256i*)kptr));
+#elif NCNN_IMPL_BF16S
+                    __m512 _w = bfloat2float_avx512(_mm256_lddqu_si256((const __m256i*)kptr));
 #else
                     __m512 _w = _mm512_loadu_ps(kptr);
 #endif
@@ -216,7 +233,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -243,6 +260,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m512 _val3 = _mm512_set1_ps(m[3]);
 #if NCNN_IMPL_FP16S
                     __m512 _w = _mm512_cvtph_ps(_mm256_lddqu_si256((const __m256i*)kptr));
+#elif NCNN_IMPL_BF16S
+                    __m512 _w = bfloat2float_avx512(_mm256_lddqu_si256((const __m256i*)kptr));
 #else
                     __m512 _w = _mm512_loadu_ps(kptr);
 #endif
@@ -277,7 +296,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -312,6 +331,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m512 _val7 = _mm512_set1_ps(m[7]);
 #if NCNN_IMPL_FP16S
                     __m512 _w = _mm512_cvtph_ps(_mm256_lddqu_si256((const __m256i*)kptr));
+#elif NCNN_IMPL_BF16S
+                    __m512 _w = bfloat2float_avx512(_mm256_lddqu_si256((const __m256i*)kptr));
 #else
                     __m512 _w = _mm512_loadu_ps(kptr);
 #endif
@@ -358,7 +379,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = (const float*)weight_data_tm + num_input * p;
@@ -387,6 +408,15 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m256 _ww = combine4x2_ps(_w, _w);
                     __m512 _www = combine8x2_ps(_ww, _ww);
 
+                    __m512 _w0 = _mm512_permute_ps(_www, _MM_SHUFFLE(0, 0, 0, 0));
+                    __m512 _w1 = _mm512_permute_ps(_www, _MM_SHUFFLE(1, 1, 1, 1));
+                    __m512 _w2 = _mm512_permute_ps(_www, _MM_SHUFFLE(2, 2, 2, 2));
+                    __m512 _w3 = _mm512_permute_ps(_www, _MM_SHUFFLE(3, 3, 3, 3));
+#elif NCNN_IMPL_BF16S
+                    __m128 _w = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)kptr));
+                    __m256 _ww = combine4x2_ps(_w, _w);
+                    __m512 _www = combine8x2_ps(_ww, _ww);
+
                     __m512 _w0 = _mm512_permute_ps(_www, _MM_SHUFFLE(0, 0, 0, 0));
                     __m512 _w1 = _mm512_permute_ps(_www, _MM_SHUFFLE(1, 1, 1, 1));
                     __m512 _w2 = _mm512_permute_ps(_www, _MM_SHUFFLE(2, 2, 2, 2));
@@ -411,6 +441,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m512 _val = _mm512_loadu_ps(m);
 #if NCNN_IMPL_FP16S
                     __m512 _w = _mm512_set1_ps(float16_to_float32(kptr[0]));
+#elif NCNN_IMPL_BF16S
+                    __m512 _w = _mm512_set1_ps(bfloat16_to_float32(kptr[0]));
 #else
                     __m512 _w = _mm512_set1_ps(kptr[0]);
 #endif
@@ -437,7 +469,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -466,6 +498,15 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m256 _ww = combine4x2_ps(_w, _w);
                     __m512 _www = combine8x2_ps(_ww, _ww);
 
+                    __m512 _w0 = _mm512_permute_ps(_www, _MM_SHUFFLE(0, 0, 0, 0));
+                    __m512 _w1 = _mm512_permute_ps(_www, _MM_SHUFFLE(1, 1, 1, 1));
+                    __m512 _w2 = _mm512_permute_ps(_www, _MM_SHUFFLE(2, 2, 2, 2));
+                    __m512 _w3 = _mm512_permute_ps(_www, _MM_SHUFFLE(3, 3, 3, 3));
+#elif NCNN_IMPL_BF16S
+                    __m128 _w = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)kptr));
+                    __m256 _ww = combine4x2_ps(_w, _w);
+                    __m512 _www = combine8x2_ps(_ww, _ww);
+
                     __m512 _w0 = _mm512_permute_ps(_www, _MM_SHUFFLE(0, 0, 0, 0));
                     __m512 _w1 = _mm512_permute_ps(_www, _MM_SHUFFLE(1, 1, 1, 1));
                     __m512 _w2 = _mm512_permute_ps(_www, _MM_SHUFFLE(2, 2, 2, 2));
@@ -505,7 +546,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -543,6 +584,20 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m512 _www0 = _mm512_shuffle_f32x4(_ww, _ww, _MM_SHUFFLE(0, 0, 0, 0));
                     __m512 _www1 = _mm512_shuffle_f32x4(_ww, _ww, _MM_SHUFFLE(1, 1, 1, 1));
 
+                    __m512 _w0 = _mm512_permute_ps(_www0, _MM_SHUFFLE(0, 0, 0, 0));
+                    __m512 _w1 = _mm512_permute_ps(_www0, _MM_SHUFFLE(1, 1, 1, 1));
+                    __m512 _w2 = _mm512_permute_ps(_www0, _MM_SHUFFLE(2, 2, 2, 2));
+                    __m512 _w3 = _mm512_permute_ps(_www0, _MM_SHUFFLE(3, 3, 3, 3));
+                    __m512 _w4 = _mm512_permute_ps(_www1, _MM_SHUFFLE(0, 0, 0, 0));
+                    __m512 _w5 = _mm512_permute_ps(_www1, _MM_SHUFFLE(1, 1, 1, 1));
+                    __m512 _w6 = _mm512_permute_ps(_www1, _MM_SHUFFLE(2, 2, 2, 2));
+                    __m512 _w7 = _mm512_permute_ps(_www1, _MM_SHUFFLE(3, 3, 3, 3));
+#elif NCNN_IMPL_BF16S
+                    __m256 _w = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)kptr));
+                    __m512 _ww = _mm512_castps256_ps512(_w);
+                    __m512 _www0 = _mm512_shuffle_f32x4(_ww, _ww, _MM_SHUFFLE(0, 0, 0, 0));
+                    __m512 _www1 = _mm512_shuffle_f32x4(_ww, _ww, _MM_SHUFFLE(1, 1, 1, 1));
+
                     __m512 _w0 = _mm512_permute_ps(_www0, _MM_SHUFFLE(0, 0, 0, 0));
                     __m512 _w1 = _mm512_permute_ps(_www0, _MM_SHUFFLE(1, 1, 1, 1));
                     __m512 _w2 = _mm512_permute_ps(_www0, _MM_SHUFFLE(2, 2, 2, 2));
@@ -604,7 +659,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -638,6 +693,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m256 _val7 = _mm256_broadcast_ss(m + 7);
 #if NCNN_IMPL_FP16S
                     __m256 _w = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)kptr));
+#elif NCNN_IMPL_BF16S
+                    __m256 _w = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)kptr));
 #else
                     __m256 _w = _mm256_loadu_ps(kptr);
 #endif
@@ -684,7 +741,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -715,6 +772,13 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m256 _w1 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w01, 1));
                     __m256 _w2 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w23, 0));
                     __m256 _w3 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w23, 1));
+#elif NCNN_IMPL_BF16S
+                    __m256i _w01 = _mm256_lddqu_si256((const __m256i*)kptr);
+                    __m256i _w23 = _mm256_lddqu_si256((const __m256i*)(kptr + 16));
+                    __m256 _w0 = bfloat2float_avx(_mm256_extractf128_si256(_w01, 0));
+                    __m256 _w1 = bfloat2float_avx(_mm256_extractf128_si256(_w01, 1));
+                    __m256 _w2 = bfloat2float_avx(_mm256_extractf128_si256(_w23, 0));
+                    __m256 _w3 = bfloat2float_avx(_mm256_extractf128_si256(_w23, 1));
 #else
                     __m256 _w0 = _mm256_loadu_ps(kptr);
                     __m256 _w1 = _mm256_loadu_ps(kptr + 8);
@@ -738,6 +802,13 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m256 _w5 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w45, 1));
                     __m256 _w6 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w67, 0));
                     __m256 _w7 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w67, 1));
+#elif NCNN_IMPL_BF16S
+                    __m256i _w45 = _mm256_lddqu_si256((const __m256i*)(kptr + 32));
+                    __m256i _w67 = _mm256_lddqu_si256((const __m256i*)(kptr + 48));
+                    __m256 _w4 = bfloat2float_avx(_mm256_extractf128_si256(_w45, 0));
+                    __m256 _w5 = bfloat2float_avx(_mm256_extractf128_si256(_w45, 1));
+                    __m256 _w6 = bfloat2float_avx(_mm256_extractf128_si256(_w67, 0));
+                    __m256 _w7 = bfloat2float_avx(_mm256_extractf128_si256(_w67, 1));
 #else
                     __m256 _w4 = _mm256_loadu_ps(kptr + 32);
                     __m256 _w5 = _mm256_loadu_ps(kptr + 40);
@@ -766,6 +837,13 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m256 _w1 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w01, 1));
                     __m256 _w2 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w23, 0));
                     __m256 _w3 = _mm256_cvtph_ps(_mm256_extractf128_si256(_w23, 1));
+#elif NCNN_IMPL_BF16S
+                    __m256i _w01 = _mm256_lddqu_si256((const __m256i*)kptr);
+                    __m256i _w23 = _mm256_lddqu_si256((const __m256i*)(kptr + 16));
+                    __m256 _w0 = bfloat2float_avx(_mm256_extractf128_si256(_w01, 0));
+                    __m256 _w1 = bfloat2float_avx(_mm256_extractf128_si256(_w01, 1));
+                    __m256 _w2 = bfloat2float_avx(_mm256_extractf128_si256(_w23, 0));
+                    __m256 _w3 = bfloat2float_avx(_mm256_extractf128_si256(_w23, 1));
 #else
                     __m256 _w0 = _mm256_loadu_ps(kptr);
                     __m256 _w1 = _mm256_loadu_ps(kptr + 8);
@@ -786,6 +864,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m256 _val = _mm256_set1_ps(m[0]);
 #if NCNN_IMPL_FP16S
                     __m256 _w = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)kptr));
+#elif NCNN_IMPL_BF16S
+                    __m256 _w = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)kptr));
 #else
                     __m256 _w = _mm256_loadu_ps(kptr);
 #endif
@@ -812,7 +892,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -839,6 +919,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m256 _val3 = _mm256_broadcast_ss(m + 3);
 #if NCNN_IMPL_FP16S
                     __m256 _w = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)kptr));
+#elif NCNN_IMPL_BF16S
+                    __m256 _w = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)kptr));
 #else
                     __m256 _w = _mm256_loadu_ps(kptr);
 #endif
@@ -873,7 +955,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = (const float*)weight_data_tm + num_input * p;
@@ -901,6 +983,14 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m128 _w = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)kptr));
                     __m256 _ww = combine4x2_ps(_w, _w);
 
+                    __m256 _w0 = _mm256_permute_ps(_ww, _MM_SHUFFLE(0, 0, 0, 0));
+                    __m256 _w1 = _mm256_permute_ps(_ww, _MM_SHUFFLE(1, 1, 1, 1));
+                    __m256 _w2 = _mm256_permute_ps(_ww, _MM_SHUFFLE(2, 2, 2, 2));
+                    __m256 _w3 = _mm256_permute_ps(_ww, _MM_SHUFFLE(3, 3, 3, 3));
+#elif NCNN_IMPL_BF16S
+                    __m128 _w = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)kptr));
+                    __m256 _ww = combine4x2_ps(_w, _w);
+
                     __m256 _w0 = _mm256_permute_ps(_ww, _MM_SHUFFLE(0, 0, 0, 0));
                     __m256 _w1 = _mm256_permute_ps(_ww, _MM_SHUFFLE(1, 1, 1, 1));
                     __m256 _w2 = _mm256_permute_ps(_ww, _MM_SHUFFLE(2, 2, 2, 2));
@@ -925,6 +1015,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m256 _val = _mm256_loadu_ps(m);
 #if NCNN_IMPL_FP16S
                     __m256 _w = _mm256_set1_ps(float16_to_float32(kptr[0]));
+#elif NCNN_IMPL_BF16S
+                    __m256 _w = _mm256_set1_ps(bfloat16_to_float32(kptr[0]));
 #else
                     __m256 _w = _mm256_set1_ps(kptr[0]);
 #endif
@@ -951,7 +1043,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -979,6 +1071,14 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m128 _w = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)kptr));
                     __m256 _ww = combine4x2_ps(_w, _w);
 
+                    __m256 _w0 = _mm256_permute_ps(_ww, _MM_SHUFFLE(0, 0, 0, 0));
+                    __m256 _w1 = _mm256_permute_ps(_ww, _MM_SHUFFLE(1, 1, 1, 1));
+                    __m256 _w2 = _mm256_permute_ps(_ww, _MM_SHUFFLE(2, 2, 2, 2));
+                    __m256 _w3 = _mm256_permute_ps(_ww, _MM_SHUFFLE(3, 3, 3, 3));
+#elif NCNN_IMPL_BF16S
+                    __m128 _w = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)kptr));
+                    __m256 _ww = combine4x2_ps(_w, _w);
+
                     __m256 _w0 = _mm256_permute_ps(_ww, _MM_SHUFFLE(0, 0, 0, 0));
                     __m256 _w1 = _mm256_permute_ps(_ww, _MM_SHUFFLE(1, 1, 1, 1));
                     __m256 _w2 = _mm256_permute_ps(_ww, _MM_SHUFFLE(2, 2, 2, 2));
@@ -1019,7 +1119,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -1046,6 +1146,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m128 _val3 = _mm_set1_ps(m[3]);
 #if NCNN_IMPL_FP16S
                     __m128 _w = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)kptr));
+#elif NCNN_IMPL_BF16S
+                    __m128 _w = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)kptr));
 #else
                     __m128 _w = _mm_loadu_ps(kptr);
 #endif
@@ -1079,7 +1181,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output / num_output_elempack; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = weight_data_tm.row(p);
@@ -1099,6 +1201,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m128 _val = _mm_set1_ps(m[0]);
 #if NCNN_IMPL_FP16S
                     __m128 _w = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)kptr));
+#elif NCNN_IMPL_BF16S
+                    __m128 _w = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)kptr));
 #else
                     __m128 _w = _mm_loadu_ps(kptr);
 #endif
@@ -1121,7 +1225,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = (const float*)weight_data_tm + num_input * p;
@@ -1152,6 +1256,13 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m128 _w1 = _mm_permute_ps(_w, _MM_SHUFFLE(1, 1, 1, 1));
                     __m128 _w2 = _mm_permute_ps(_w, _MM_SHUFFLE(2, 2, 2, 2));
                     __m128 _w3 = _mm_permute_ps(_w, _MM_SHUFFLE(3, 3, 3, 3));
+#elif NCNN_IMPL_BF16S
+                    __m128 _w = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)kptr));
+
+                    __m128 _w0 = _mm_shuffle_ps(_w, _w, _MM_SHUFFLE(0, 0, 0, 0));
+                    __m128 _w1 = _mm_shuffle_ps(_w, _w, _MM_SHUFFLE(1, 1, 1, 1));
+                    __m128 _w2 = _mm_shuffle_ps(_w, _w, _MM_SHUFFLE(2, 2, 2, 2));
+                    __m128 _w3 = _mm_shuffle_ps(_w, _w, _MM_SHUFFLE(3, 3, 3, 3));
 #else
                     __m128 _w0 = _mm_set1_ps(kptr[0]);
                     __m128 _w1 = _mm_set1_ps(kptr[1]);
@@ -1172,6 +1283,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m128 _val = _mm_loadu_ps(m);
 #if NCNN_IMPL_FP16S
                     __m128 _w = _mm_set1_ps(float16_to_float32(kptr[0]));
+#elif NCNN_IMPL_BF16S
+                    __m128 _w = _mm_set1_ps(bfloat16_to_float32(kptr[0]));
 #else
                     __m128 _w = _mm_set1_ps(kptr[0]);
 #endif
@@ -1199,7 +1312,7 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
 
             for (int p = 0; p < num_output; p++)
             {
-#if NCNN_IMPL_FP16S
+#if NCNN_IMPL_FP16S || NCNN_IMPL_BF16S
                 const unsigned short* kptr = weight_data_tm.row<const unsigned short>(p);
 #else
                 const float* kptr = (const float*)weight_data_tm + num_input * p;
@@ -1222,6 +1335,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m256 _m = _mm256_loadu_ps(m);
 #if NCNN_IMPL_FP16S
                     __m256 _w = _mm256_cvtph_ps(_mm_lddqu_si128((const __m128i*)kptr));
+#elif NCNN_IMPL_BF16S
+                    __m256 _w = bfloat2float_avx(_mm_lddqu_si128((const __m128i*)kptr));
 #else
                     __m256 _w = _mm256_loadu_ps(kptr);
 #endif
@@ -1237,6 +1352,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                     __m128 _val = _mm_loadu_ps(m);
 #if NCNN_IMPL_FP16S
                     __m128 _w = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)kptr));
+#elif NCNN_IMPL_BF16S
+                    __m128 _w = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)kptr));
 #else
                     __m128 _w = _mm_loadu_ps(kptr);
 #endif
@@ -1250,6 +1367,8 @@ static void innerproduct_gemm_sse(const Mat& bottom_blob, Mat& top_blob, const M
                 {
 #if NCNN_IMPL_FP16S
                     sum += *m++ * float16_to_float32(*kptr++);
+#elif NCNN_IMPL_BF16S
+                    sum += *m++ * bfloat16_to_float32(*kptr++);
 #else
                     sum += *m++ * *kptr++;
 #endif
@@ -12,8 +12,10 @@
 
 #include "x86_activation.h"
 #include "x86_usability.h"
+#include "x86_weight_quant.h"
 
 #include "layer_type.h"
+#include "packedweightcache.h"
 
 #include "cpu.h"
 
@@ -29,11 +31,21 @@ namespace ncnn {
 #undef NCNN_IMPL_FP16S
 #endif
 
+#if NCNN_BF16
+#define NCNN_IMPL_BF16S 1
+#include "innerproduct_fp.h"
+#include "innerproduct_gemm_fp.h"
+#undef NCNN_IMPL_BF16S
+#endif
+
 InnerProduct_x86::InnerProduct_x86()
 {
 #if __SSE2__
     support_packing = true;
 #endif // __SSE2__
+#if NCNN_BF16
+    support_bf16_storage = true;
+#endif
 
     flatten = 0;
 }
@@ -51,6 +63,12 @@ int InnerProduct_x86::create_pipeline(const Option& opt)
         flatten->create_pipeline(opt);
     }
 
+    if (weight_quant_bits)
+    {
+        // keep weight_data quantized, it is expanded on the fly in forward_weight_quant
+        return 0;
+    }
+
 #if NCNN_INT8
     if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
     {
@@ -58,6 +76,13 @@ int InnerProduct_x86::create_pipeline(const Option& opt)
     }
 #endif
 
+#if NCNN_BF16
+    if (opt.use_bf16_storage)
+    {
+        return create_pipeline_bf16s(opt);
+    }
+#endif
+
 #if NCNN_F16C && __AVX__
     if (cpu_support_x86_f16c() && opt.use_fp16_storage)
     {
@@ -67,7 +92,14 @@ int InnerProduct_x86::create_pipeline(const Option& opt)
 
     const int num_input = weight_data_size / num_output;
 
-    innerproduct_transform_kernel_sse(weight_data, weight_data_tm, num_input, num_output, opt);
+    const int params[4] = {typeindex, 1, num_output, opt.use_packing_layout};
+    uint64_t digest = 0;
+    if (packed_weight_cache_get(opt, weight_data, params, 4, weight_data_tm, digest) != 0)
+    {
+        innerproduct_transform_kernel_sse(weight_data, weight_data_tm, num_input, num_output, opt);
+
+        packed_weight_cache_put(opt, digest, weight_data_tm);
+    }
 
     if (opt.lightmode)
         weight_data.release();
@@ -89,6 +121,18 @@ int InnerProduct_x86::destroy_pipeline(const Option& opt)
 
 int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+#if NCNN_BF16
+    if (opt.use_bf16_storage)
+    {
+        return forward_bf16s(bottom_blob, top_blob, opt);
+    }
+#endif
+
+    if (weight_quant_bits)
+    {
+        return forward_weight_quant(bottom_blob, top_blob, opt);
+    }
+
 #if NCNN_INT8
     if (opt.use_int8_inference && int8_scale_term)
     {
@@ -160,12 +204,84 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
     return 0;
 }
 
+int InnerProduct_x86::forward_weight_quant(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int num_input = weight_data_size / num_output;
+
+    Mat bottom_blob_unpacked;
+    if (bottom_blob.dims == 2 && bottom_blob.w == num_input)
+    {
+        // gemm
+        Option opt_unpack = opt;
+        opt_unpack.blob_allocator = opt.workspace_allocator;
+
+        convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_unpack);
+        if (bottom_blob_unpacked.empty())
+            return -100;
+    }
+    else
+    {
+        // flatten
+        bottom_blob_unpacked = bottom_blob;
+        if (bottom_blob.dims != 1)
+        {
+            Option opt_flatten = opt;
+            opt_flatten.blob_allocator = opt.workspace_allocator;
+
+            flatten->forward(bottom_blob, bottom_blob_unpacked, opt_flatten);
+            if (bottom_blob_unpacked.empty())
+                return -100;
+        }
+
+        // num_input
+        bottom_blob_unpacked.w = bottom_blob_unpacked.w * bottom_blob_unpacked.elempack;
+        bottom_blob_unpacked.elemsize = 4u;
+        bottom_blob_unpacked.elempack = 1;
+    }
+
+    const int h = bottom_blob_unpacked.dims == 2 ? bottom_blob_unpacked.h : 1;
+
+    if (bottom_blob_unpacked.dims == 2)
+        top_blob.create(num_output, h, 4u, opt.blob_allocator);
+    else
+        top_blob.create(num_output, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // the dequantization is fused into the dot product, one group scale per segment
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < num_output; p++)
+    {
+        const unsigned char* kptr = weight_data.row<const unsigned char>(p);
+        const float* scales = weight_data_quant_scales.row(p);
+        const float bias = bias_term ? bias_data[p] : 0.f;
+
+        for (int j = 0; j < h; j++)
+        {
+            const float* ptr = bottom_blob_unpacked.row(j);
+
+            float sum = bias + dot_weight_quant_row_x86(ptr, kptr, scales, num_input, weight_quant_bits, weight_quant_group_size);
+
+            top_blob.row(j)[p] = activation_ss(sum, activation_type, activation_params);
+        }
+    }
+
+    return 0;
+}
+
 #if NCNN_F16C && __AVX__
 int InnerProduct_x86::create_pipeline_fp16s(const Option& opt)
 {
     const int num_input = weight_data_size / num_output;
 
-    innerproduct_transform_kernel_fp16s_sse(weight_data, weight_data_tm, num_input, num_output, opt);
+    const int params[4] = {typeindex, 2, num_output, opt.use_packing_layout};
+    uint64_t digest = 0;
+    if (packed_weight_cache_get(opt, weight_data, params, 4, weight_data_tm, digest) != 0)
+    {
+        innerproduct_transform_kernel_fp16s_sse(weight_data, weight_data_tm, num_input, num_output, opt);
+
+        packed_weight_cache_put(opt, digest, weight_data_tm);
+    }
 
     if (opt.lightmode)
         weight_data.release();
@@ -229,6 +345,139 @@ int InnerProduct_x86::forward_fp16s(const Mat& bottom_blob, Mat& top_blob, const
 }
 #endif // NCNN_F16C && __AVX__
 
+#if NCNN_BF16
+int InnerProduct_x86::create_pipeline_bf16s(const Option& opt)
+{
+    const int num_input = weight_data_size / num_output;
+
+    const int params[4] = {typeindex, 3, num_output, opt.use_packing_layout};
+    uint64_t digest = 0;
+    if (packed_weight_cache_get(opt, weight_data, params, 4, weight_data_tm, digest) != 0)
+    {
+        innerproduct_transform_kernel_bf16s_sse(weight_data, weight_data_tm, num_input, num_output, opt);
+
+        packed_weight_cache_put(opt, digest, weight_data_tm);
+    }
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+int InnerProduct_x86::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int num_input = weight_data_size / num_output;
+
+    // the weights stay bf16 and are widened in the kernel, activations are widened once here
+    const bool bf16_blob = bottom_blob.elembits() == 16;
+
+    Option opt_fp32 = opt;
+    if (bf16_blob)
+        opt_fp32.blob_allocator = opt.workspace_allocator;
+
+    Mat bottom_blob_fp32 = bottom_blob;
+    if (bf16_blob)
+    {
+        cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt_fp32);
+        if (bottom_blob_fp32.empty())
+            return -100;
+    }
+
+    Mat top_blob_fp32;
+    bool quantized = weight_quant_bits != 0;
+#if NCNN_INT8
+    quantized = quantized || (opt.use_int8_inference && int8_scale_term);
+#endif
+    if (quantized)
+    {
+        // quantized weights keep their own fp32 paths
+        opt_fp32.use_bf16_storage = false;
+
+        Mat bottom_blob_fp32_packed = bottom_blob_fp32;
+#if __AVX__
+        // 16-bit blobs may come in pack4, which the int8 quantize on avx does not take
+        if (bottom_blob_fp32.elempack == 4)
+        {
+            const int dims = bottom_blob_fp32.dims;
+            const int elemcount = (dims == 1 ? bottom_blob_fp32.w : dims == 2 ? bottom_blob_fp32.h : bottom_blob_fp32.c) * 4;
+
+            convert_packing(bottom_blob_fp32, bottom_blob_fp32_packed, elemcount % 8 == 0 ? 8 : 1, opt_fp32);
+            if (bottom_blob_fp32_packed.empty())
+                return -100;
+        }
+#endif // __AVX__
+
+        int ret = forward(bottom_blob_fp32_packed, top_blob_fp32, opt_fp32);
+        if (ret != 0)
+            return ret;
+    }
+    else if (bottom_blob_fp32.dims == 2 && bottom_blob_fp32.w == num_input)
+    {
+        // gemm
+        int h = bottom_blob_fp32.h;
+        size_t elemsize = bottom_blob_fp32.elemsize;
+        int elempack = bottom_blob_fp32.elempack;
+
+        top_blob_fp32.create(num_output, h, elemsize, elempack, opt_fp32.blob_allocator);
+        if (top_blob_fp32.empty())
+            return -100;
+
+        innerproduct_gemm_bf16s_sse(bottom_blob_fp32, top_blob_fp32, weight_data_tm, bias_data, activation_type, activation_params, opt);
+    }
+    else
+    {
+        // flatten
+        Mat bottom_blob_flattened = bottom_blob_fp32;
+        if (bottom_blob_fp32.dims != 1)
+        {
+            Option opt_flatten = opt;
+            opt_flatten.blob_allocator = opt.workspace_allocator;
+
+            flatten->forward(bottom_blob_fp32, bottom_blob_flattened, opt_flatten);
+            if (bottom_blob_flattened.empty())
+                return -100;
+        }
+
+        size_t elemsize = bottom_blob_flattened.elemsize;
+        int elempack = bottom_blob_flattened.elempack;
+
+        int out_elempack = 1;
+#if __SSE2__
+        if (opt.use_packing_layout)
+        {
+#if __AVX512F__
+            out_elempack = num_output % 16 == 0 ? 16 : num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#elif __AVX__
+            out_elempack = num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#else
+            out_elempack = num_output % 4 == 0 ? 4 : 1;
+#endif
+        }
+#endif // __SSE2__
+        size_t out_elemsize = elemsize / elempack * out_elempack;
+
+        top_blob_fp32.create(num_output / out_elempack, out_elemsize, out_elempack, opt_fp32.blob_allocator);
+        if (top_blob_fp32.empty())
+            return -100;
+
+        innerproduct_bf16s_sse(bottom_blob_flattened, top_blob_fp32, weight_data_tm, bias_data, activation_type, activation_params, opt);
+    }
+
+    if (!bf16_blob)
+    {
+        top_blob = top_blob_fp32;
+        return 0;
+    }
+
+    cast_float32_to_bfloat16(top_blob_fp32, top_blob, opt);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+#endif // NCNN_BF16
+
 #if NCNN_INT8
 int InnerProduct_x86::create_pipeline_int8_x86(const Option& opt)
 {
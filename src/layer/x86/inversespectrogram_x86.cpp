@@ -0,0 +1,170 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "inversespectrogram_x86.h"
+
+#include "cpu.h"
+#include "x86_fft.h"
+
+namespace ncnn {
+
+InverseSpectrogram_x86::InverseSpectrogram_x86()
+{
+}
+
+int InverseSpectrogram_x86::create_pipeline(const Option& /*opt*/)
+{
+    fft_make_plan(n_fft, fft_radices, fft_roots, fft_twiddles);
+
+    return 0;
+}
+
+int InverseSpectrogram_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int frames = bottom_blob.h;
+    const int freqs = bottom_blob.c;
+
+    const int onesided = freqs == n_fft / 2 + 1 ? 1 : 0;
+
+    const int outsize = center ? (frames - 1) * hoplen + (n_fft - n_fft / 2 * 2) : (frames - 1) * hoplen + n_fft;
+
+    const size_t elemsize = bottom_blob.elemsize;
+
+    if (returns == 0)
+    {
+        top_blob.create(2, outsize, elemsize, opt.blob_allocator);
+    }
+    else
+    {
+        top_blob.create(outsize, elemsize, opt.blob_allocator);
+    }
+    if (top_blob.empty())
+        return -100;
+
+    Mat window_sumsquare(outsize + n_fft, elemsize, opt.workspace_allocator);
+    if (window_sumsquare.empty())
+        return -100;
+
+    // windowed inverse transform of every frame
+    Mat frames_data(n_fft * 2, frames, 4u, opt.workspace_allocator);
+    if (frames_data.empty())
+        return -100;
+
+    // two fft buffers per thread
+    Mat fft_workspace(n_fft * 2 * 2, 1, opt.num_threads, 4u, opt.workspace_allocator);
+    if (fft_workspace.empty())
+        return -100;
+
+    float norm = 1.f;
+    if (normalized == 1)
+        norm = sqrt(n_fft);
+    if (normalized == 2)
+        norm = window_data[n_fft];
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int j = 0; j < frames; j++)
+    {
+        float* x = fft_workspace.channel(get_omp_thread_num());
+        float* buf = x + n_fft * 2;
+
+        // collect conjugated complex, ifft(X) = conj(fft(conj(X))) / n
+        if (onesided == 1)
+        {
+            for (int k = 0; k < n_fft / 2 + 1; k++)
+            {
+                const float* ptr = bottom_blob.channel(k).row(j);
+                x[k * 2] = ptr[0] * norm;
+                x[k * 2 + 1] = -ptr[1] * norm;
+            }
+            for (int k = n_fft / 2 + 1; k < n_fft; k++)
+            {
+                const float* ptr = bottom_blob.channel(n_fft - k).row(j);
+                x[k * 2] = ptr[0] * norm;
+                x[k * 2 + 1] = ptr[1] * norm;
+            }
+        }
+        else
+        {
+            for (int k = 0; k < n_fft; k++)
+            {
+                const float* ptr = bottom_blob.channel(k).row(j);
+                x[k * 2] = ptr[0] * norm;
+                x[k * 2 + 1] = -ptr[1] * norm;
+            }
+        }
+
+        const float* z = fft_forward(x, buf, n_fft, fft_radices, fft_roots, fft_twiddles);
+
+        float* outptr = frames_data.row(j);
+
+        // apply window
+        for (int i = 0; i < n_fft; i++)
+        {
+            const float w = window_data[i] / n_fft;
+            outptr[i * 2] = z[i * 2] * w;
+            outptr[i * 2 + 1] = -z[i * 2 + 1] * w;
+        }
+    }
+
+    top_blob.fill(0.f);
+    window_sumsquare.fill(0.f);
+
+    // overlap add
+    for (int j = 0; j < frames; j++)
+    {
+        const float* ptr = frames_data.row(j);
+
+        for (int i = 0; i < n_fft; i++)
+        {
+            int output_index = j * hoplen + i;
+            if (center == 1)
+            {
+                output_index -= n_fft / 2;
+            }
+            if (output_index >= 0 && output_index < outsize)
+            {
+                // square window
+                window_sumsquare[output_index] += window_data[i] * window_data[i];
+
+                if (returns == 0)
+                {
+                    top_blob.row(output_index)[0] += ptr[i * 2];
+                    top_blob.row(output_index)[1] += ptr[i * 2 + 1];
+                }
+                if (returns == 1)
+                {
+                    top_blob[output_index] += ptr[i * 2];
+                }
+                if (returns == 2)
+                {
+                    top_blob[output_index] += ptr[i * 2 + 1];
+                }
+            }
+        }
+    }
+
+    // square window norm
+    if (returns == 0)
+    {
+        for (int i = 0; i < outsize; i++)
+        {
+            if (window_sumsquare[i] != 0.f)
+            {
+                top_blob.row(i)[0] /= window_sumsquare[i];
+                top_blob.row(i)[1] /= window_sumsquare[i];
+            }
+        }
+    }
+    else
+    {
+        for (int i = 0; i < outsize; i++)
+        {
+            if (window_sumsquare[i] != 0.f)
+                top_blob[i] /= window_sumsquare[i];
+        }
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -752,12 +752,12 @@ int LSTM_x86::create_pipeline_int8(const Option& opt)
     return 0;
 }
 
-static void lstm_dynamic_quantize(const Mat& bottom_blob, Mat& bottom_blob_int8, Mat& bottom_blob_int8_descales, const Option& opt)
+static void lstm_dynamic_quantize(const Mat& bottom_blob, const Mat& bottom_blob_static_int8_scales, Mat& bottom_blob_int8, Mat& bottom_blob_int8_descales, const Option& opt)
 {
     int size = bottom_blob.w;
     int T = bottom_blob.h;
 
-    // dynamic quantize bottom_blob
+    // dynamic quantize bottom_blob unless the static scale is known
     bottom_blob_int8_descales.create(T, (size_t)4u, 1, opt.blob_allocator);
 
     bottom_blob_int8.create(size, T, (size_t)1u, opt.blob_allocator);
@@ -768,6 +768,16 @@ static void lstm_dynamic_quantize(const Mat& bottom_blob, Mat& bottom_blob_int8,
         const float* ptr = bottom_blob.row(t);
         signed char* outptr = bottom_blob_int8.row<signed char>(t);
 
+        if (!bottom_blob_static_int8_scales.empty())
+        {
+            const float scale = bottom_blob_static_int8_scales[0];
+
+            bottom_blob_int8_descales[t] = 1.f / scale;
+
+            lstm_dynamic_quantize_scale2int8(ptr, size, scale, outptr);
+            continue;
+        }
+
         const float absmax = lstm_dynamic_quantize_get_absmax(ptr, size);
 
         bottom_blob_int8_descales[t] = absmax / 127.f;
@@ -805,7 +815,7 @@ int LSTM_x86::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Option&
         Option opt_quant = opt;
         opt_quant.blob_allocator = opt.workspace_allocator;
         opt_quant.use_packing_layout = false;
-        lstm_dynamic_quantize(bottom_blob, bottom_blob_int8, bottom_blob_int8_descales, opt_quant);
+        lstm_dynamic_quantize(bottom_blob, bottom_blob_int8_scales, bottom_blob_int8, bottom_blob_int8_descales, opt_quant);
     }
 
     // Uni directional
@@ -890,7 +900,7 @@ int LSTM_x86::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat
         Option opt_quant = opt;
         opt_quant.blob_allocator = opt.workspace_allocator;
         opt_quant.use_packing_layout = false;
-        lstm_dynamic_quantize(bottom_blob, bottom_blob_int8, bottom_blob_int8_descales, opt_quant);
+        lstm_dynamic_quantize(bottom_blob, bottom_blob_int8_scales, bottom_blob_int8, bottom_blob_int8_descales, opt_quant);
     }
 
     // Uni directional
@@ -7,6 +7,85 @@
 
 namespace ncnn {
 
+#if NCNN_INT8
+// normalize each output column of B to absmax 1, the absmax of the columns are stored for scaling the output back
+static int normalize_B_columns(const Mat& B, int transB, Mat& B_normalized, Mat& B_absmax, const Option& opt)
+{
+    const int N = transB ? B.h : B.w;
+    const int K = transB ? B.w : B.h;
+
+    B_normalized.create(B.w, B.h, (size_t)4u, 1, opt.workspace_allocator);
+    if (B_normalized.empty())
+        return -100;
+
+    B_absmax.create(N, (size_t)4u, 1, opt.workspace_allocator);
+    if (B_absmax.empty())
+        return -100;
+
+    if (transB)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int j = 0; j < N; j++)
+        {
+            const float* ptr = B.row(j);
+            float* outptr = B_normalized.row(j);
+
+            float absmax = 0.f;
+            for (int k = 0; k < K; k++)
+            {
+                absmax = std::max(absmax, (float)fabs(ptr[k]));
+            }
+
+            if (absmax == 0.f)
+                absmax = 1.f;
+
+            for (int k = 0; k < K; k++)
+            {
+                outptr[k] = ptr[k] / absmax;
+            }
+
+            B_absmax[j] = absmax;
+        }
+    }
+    else
+    {
+        float* absmax = B_absmax;
+        for (int j = 0; j < N; j++)
+        {
+            absmax[j] = 0.f;
+        }
+
+        for (int k = 0; k < K; k++)
+        {
+            const float* ptr = B.row(k);
+            for (int j = 0; j < N; j++)
+            {
+                absmax[j] = std::max(absmax[j], (float)fabs(ptr[j]));
+            }
+        }
+
+        for (int j = 0; j < N; j++)
+        {
+            if (absmax[j] == 0.f)
+                absmax[j] = 1.f;
+        }
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int k = 0; k < K; k++)
+        {
+            const float* ptr = B.row(k);
+            float* outptr = B_normalized.row(k);
+            for (int j = 0; j < N; j++)
+            {
+                outptr[j] = ptr[j] / absmax[j];
+            }
+        }
+    }
+
+    return 0;
+}
+#endif // NCNN_INT8
+
 MatMul_x86::MatMul_x86()
 {
     gemm = 0;
@@ -28,6 +107,9 @@ int MatMul_x86::create_pipeline(const Option& opt)
     pd.set(10, -1);    // constant_broadcast_type_C = null
     pd.set(11, 0);     // output_N1M
     pd.set(12, 1);     // output_elempack
+#if NCNN_INT8
+    pd.set(18, int8_scale_term);
+#endif
 
     gemm->load_param(pd);
 
@@ -50,6 +132,47 @@ int MatMul_x86::destroy_pipeline(const Option& opt)
     return 0;
 }
 
+int MatMul_x86::forward_gemm(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        // the int8 gemm quantizes B with one scale for the whole matrix
+        // with every output column normalized to absmax 1, that scale quantizes each column with its own range
+        Mat B_normalized;
+        Mat B_absmax;
+        int ret = normalize_B_columns(bottom_blobs[1], transB, B_normalized, B_absmax, opt);
+        if (ret != 0)
+            return ret;
+
+        std::vector<Mat> _bottom_blobs(2);
+        _bottom_blobs[0] = bottom_blobs[0];
+        _bottom_blobs[1] = B_normalized;
+        ret = gemm->forward(_bottom_blobs, top_blobs, opt);
+        if (ret != 0)
+            return ret;
+
+        // scale the output columns back
+        Mat& top_blob = top_blobs[0];
+        const float* absmax = B_absmax;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < top_blob.h; i++)
+        {
+            float* ptr = top_blob.row(i);
+            for (int j = 0; j < top_blob.w; j++)
+            {
+                ptr[j] *= absmax[j];
+            }
+        }
+
+        return 0;
+    }
+#endif // NCNN_INT8
+
+    return gemm->forward(bottom_blobs, top_blobs, opt);
+}
+
 int MatMul_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
     const Mat& A = bottom_blobs[0];
@@ -67,14 +190,14 @@ int MatMul_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
         std::vector<Mat> _bottom_blobs(2);
         _bottom_blobs[0] = A.reshape(A.w, 1);
         _bottom_blobs[1] = transB ? B.reshape(B.w, 1) : B.reshape(1, B.w);
-        gemm->forward(_bottom_blobs, top_blobs, opt);
+        forward_gemm(_bottom_blobs, top_blobs, opt);
 
         top_blob = top_blob.reshape(1, opt.blob_allocator);
     }
     else if (Adims == 2 && Bdims == 2)
     {
         // matrix multiply
-        gemm->forward(bottom_blobs, top_blobs, opt);
+        forward_gemm(bottom_blobs, top_blobs, opt);
     }
     else if (Adims == 1 && Bdims == 2)
     {
@@ -82,7 +205,7 @@ int MatMul_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
         std::vector<Mat> _bottom_blobs(2);
         _bottom_blobs[0] = A.reshape(A.w, 1);
         _bottom_blobs[1] = B;
-        gemm->forward(_bottom_blobs, top_blobs, opt);
+        forward_gemm(_bottom_blobs, top_blobs, opt);
 
         top_blob = top_blob.reshape(top_blob.w, opt.blob_allocator);
     }
@@ -92,7 +215,7 @@ int MatMul_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
         std::vector<Mat> _bottom_blobs(2);
         _bottom_blobs[0] = A;
         _bottom_blobs[1] = transB ? B.reshape(B.w, 1) : B.reshape(1, B.w);
-        gemm->forward(_bottom_blobs, top_blobs, opt);
+        forward_gemm(_bottom_blobs, top_blobs, opt);
 
         top_blob = top_blob.reshape(top_blob.h, opt.blob_allocator);
     }
@@ -116,7 +239,7 @@ int MatMul_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
             _bottom_blobs[1] = B1.channel(p);
             std::vector<Mat> _top_blobs(1);
             _top_blobs[0] = top_blob1.channel(p);
-            gemm->forward(_bottom_blobs, _top_blobs, opt);
+            forward_gemm(_bottom_blobs, _top_blobs, opt);
         }
 
         if (Bdims == 3)
@@ -144,7 +267,7 @@ int MatMul_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
             _bottom_blobs[1] = BT;
             std::vector<Mat> _top_blobs(1);
             _top_blobs[0] = top_blob1.channel(p);
-            gemm->forward(_bottom_blobs, _top_blobs, opt);
+            forward_gemm(_bottom_blobs, _top_blobs, opt);
         }
 
         if (Adims == 3)
@@ -175,7 +298,7 @@ int MatMul_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
             _bottom_blobs[1] = B1.channel(Bp);
             std::vector<Mat> _top_blobs(1);
             _top_blobs[0] = top_blob.channel(p);
-            gemm->forward(_bottom_blobs, _top_blobs, opt);
+            forward_gemm(_bottom_blobs, _top_blobs, opt);
         }
     }
     else if (max_ABdims == 4)
@@ -207,7 +330,7 @@ int MatMul_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
                 _bottom_blobs[1] = B1.channel(Bp).depth(Bd);
                 std::vector<Mat> _top_blobs(1);
                 _top_blobs[0] = top_blob.channel(p).depth(q);
-                gemm->forward(_bottom_blobs, _top_blobs, opt);
+                forward_gemm(_bottom_blobs, _top_blobs, opt);
             }
         }
     }
@@ -0,0 +1,382 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+// fused attention for one head and a tile of queries
+// queries sit in the simd lanes, keys are visited block by block
+// with online softmax, the running max and sum of each query rescale the partial output
+// so the score matrix of the whole sequence is never materialized
+
+#if __AVX512F__
+#define FLASH_ATTENTION_LANES 16
+typedef __m512 flash_attention_vec;
+static NCNN_FORCEINLINE __m512 flash_attention_load(const float* ptr)
+{
+    return _mm512_loadu_ps(ptr);
+}
+static NCNN_FORCEINLINE void flash_attention_store(float* ptr, const __m512& _v)
+{
+    _mm512_storeu_ps(ptr, _v);
+}
+static NCNN_FORCEINLINE __m512 flash_attention_set1(float v)
+{
+    return _mm512_set1_ps(v);
+}
+static NCNN_FORCEINLINE __m512 flash_attention_fmadd(const __m512& _a, const __m512& _b, const __m512& _c)
+{
+    return _mm512_fmadd_ps(_a, _b, _c);
+}
+static NCNN_FORCEINLINE __m512 flash_attention_mul(const __m512& _a, const __m512& _b)
+{
+    return _mm512_mul_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m512 flash_attention_add(const __m512& _a, const __m512& _b)
+{
+    return _mm512_add_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m512 flash_attention_sub(const __m512& _a, const __m512& _b)
+{
+    return _mm512_sub_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m512 flash_attention_max(const __m512& _a, const __m512& _b)
+{
+    return _mm512_max_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m512 flash_attention_exp(const __m512& _v)
+{
+    return exp512_ps(_v);
+}
+#elif __AVX__
+#define FLASH_ATTENTION_LANES 8
+typedef __m256 flash_attention_vec;
+static NCNN_FORCEINLINE __m256 flash_attention_load(const float* ptr)
+{
+    return _mm256_loadu_ps(ptr);
+}
+static NCNN_FORCEINLINE void flash_attention_store(float* ptr, const __m256& _v)
+{
+    _mm256_storeu_ps(ptr, _v);
+}
+static NCNN_FORCEINLINE __m256 flash_attention_set1(float v)
+{
+    return _mm256_set1_ps(v);
+}
+static NCNN_FORCEINLINE __m256 flash_attention_fmadd(const __m256& _a, const __m256& _b, const __m256& _c)
+{
+    return _mm256_comp_fmadd_ps(_a, _b, _c);
+}
+static NCNN_FORCEINLINE __m256 flash_attention_mul(const __m256& _a, const __m256& _b)
+{
+    return _mm256_mul_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m256 flash_attention_add(const __m256& _a, const __m256& _b)
+{
+    return _mm256_add_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m256 flash_attention_sub(const __m256& _a, const __m256& _b)
+{
+    return _mm256_sub_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m256 flash_attention_max(const __m256& _a, const __m256& _b)
+{
+    return _mm256_max_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m256 flash_attention_exp(const __m256& _v)
+{
+    return exp256_ps(_v);
+}
+#elif __SSE2__
+#define FLASH_ATTENTION_LANES 4
+typedef __m128 flash_attention_vec;
+static NCNN_FORCEINLINE __m128 flash_attention_load(const float* ptr)
+{
+    return _mm_loadu_ps(ptr);
+}
+static NCNN_FORCEINLINE void flash_attention_store(float* ptr, const __m128& _v)
+{
+    _mm_storeu_ps(ptr, _v);
+}
+static NCNN_FORCEINLINE __m128 flash_attention_set1(float v)
+{
+    return _mm_set1_ps(v);
+}
+static NCNN_FORCEINLINE __m128 flash_attention_fmadd(const __m128& _a, const __m128& _b, const __m128& _c)
+{
+    return _mm_comp_fmadd_ps(_a, _b, _c);
+}
+static NCNN_FORCEINLINE __m128 flash_attention_mul(const __m128& _a, const __m128& _b)
+{
+    return _mm_mul_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m128 flash_attention_add(const __m128& _a, const __m128& _b)
+{
+    return _mm_add_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m128 flash_attention_sub(const __m128& _a, const __m128& _b)
+{
+    return _mm_sub_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m128 flash_attention_max(const __m128& _a, const __m128& _b)
+{
+    return _mm_max_ps(_a, _b);
+}
+static NCNN_FORCEINLINE __m128 flash_attention_exp(const __m128& _v)
+{
+    return exp_ps(_v);
+}
+#else
+#define FLASH_ATTENTION_LANES 1
+typedef float flash_attention_vec;
+static NCNN_FORCEINLINE float flash_attention_load(const float* ptr)
+{
+    return *ptr;
+}
+static NCNN_FORCEINLINE void flash_attention_store(float* ptr, float v)
+{
+    *ptr = v;
+}
+static NCNN_FORCEINLINE float flash_attention_set1(float v)
+{
+    return v;
+}
+static NCNN_FORCEINLINE float flash_attention_fmadd(float a, float b, float c)
+{
+    return a * b + c;
+}
+static NCNN_FORCEINLINE float flash_attention_mul(float a, float b)
+{
+    return a * b;
+}
+static NCNN_FORCEINLINE float flash_attention_add(float a, float b)
+{
+    return a + b;
+}
+static NCNN_FORCEINLINE float flash_attention_sub(float a, float b)
+{
+    return a - b;
+}
+static NCNN_FORCEINLINE float flash_attention_max(float a, float b)
+{
+    return std::max(a, b);
+}
+static NCNN_FORCEINLINE float flash_attention_exp(float v)
+{
+    return expf(v);
+}
+#endif
+
+#define FLASH_ATTENTION_KEY_BLOCK 64
+
+// scratch floats per thread for flash_attention_tile()
+static int flash_attention_scratch_size(int embed_dim_per_head)
+{
+    return FLASH_ATTENTION_LANES * (embed_dim_per_head * 2 + FLASH_ATTENTION_KEY_BLOCK);
+}
+
+// q      embed_dim_per_head rows of src_seqlen, scaled already
+// k      dst_seqlen rows, the head features of each key start at offset
+// v      dst_seqlen rows, the head features of each value start at offset
+// mask   src_seqlen rows of dst_seqlen, may be empty
+// out    embed_dim_per_head rows of src_seqlen
+// queries [i, i + max_ii) are computed, max_ii <= FLASH_ATTENTION_LANES
+static void flash_attention_tile(const Mat& q, const Mat& k, const Mat& v, int offset, const Mat& mask, Mat& out, int i, int max_ii, float* scratch)
+{
+    const int W = FLASH_ATTENTION_LANES;
+    const int embed_dim_per_head = q.h;
+    const int dst_seqlen = k.h;
+
+    float* qtile = scratch;
+    float* otile = qtile + embed_dim_per_head * W;
+    float* stile = otile + embed_dim_per_head * W;
+
+    // gather the queries into lanes, the unused lanes are zero
+    for (int d = 0; d < embed_dim_per_head; d++)
+    {
+        const float* qptr = q.row(d) + i;
+        float* pp = qtile + d * W;
+
+        int ii = 0;
+        for (; ii < max_ii; ii++)
+        {
+            pp[ii] = qptr[ii];
+        }
+        for (; ii < W; ii++)
+        {
+            pp[ii] = 0.f;
+        }
+    }
+
+    for (int d = 0; d < embed_dim_per_head * W; d++)
+    {
+        otile[d] = 0.f;
+    }
+
+    flash_attention_vec _max = flash_attention_set1(-FLT_MAX);
+    flash_attention_vec _sum = flash_attention_set1(0.f);
+
+    for (int j0 = 0; j0 < dst_seqlen; j0 += FLASH_ATTENTION_KEY_BLOCK)
+    {
+        const int max_jj = std::min(dst_seqlen - j0, FLASH_ATTENTION_KEY_BLOCK);
+
+        // scores = q^T k
+        int jj = 0;
+        for (; jj + 3 < max_jj; jj += 4)
+        {
+            const float* k0 = k.row(j0 + jj) + offset;
+            const float* k1 = k.row(j0 + jj + 1) + offset;
+            const float* k2 = k.row(j0 + jj + 2) + offset;
+            const float* k3 = k.row(j0 + jj + 3) + offset;
+
+            flash_attention_vec _s0 = flash_attention_set1(0.f);
+            flash_attention_vec _s1 = flash_attention_set1(0.f);
+            flash_attention_vec _s2 = flash_attention_set1(0.f);
+            flash_attention_vec _s3 = flash_attention_set1(0.f);
+            for (int d = 0; d < embed_dim_per_head; d++)
+            {
+                flash_attention_vec _q = flash_attention_load(qtile + d * W);
+                _s0 = flash_attention_fmadd(_q, flash_attention_set1(k0[d]), _s0);
+                _s1 = flash_attention_fmadd(_q, flash_attention_set1(k1[d]), _s1);
+                _s2 = flash_attention_fmadd(_q, flash_attention_set1(k2[d]), _s2);
+                _s3 = flash_attention_fmadd(_q, flash_attention_set1(k3[d]), _s3);
+            }
+            flash_attention_store(stile + jj * W, _s0);
+            flash_attention_store(stile + (jj + 1) * W, _s1);
+            flash_attention_store(stile + (jj + 2) * W, _s2);
+            flash_attention_store(stile + (jj + 3) * W, _s3);
+        }
+        for (; jj < max_jj; jj++)
+        {
+            const float* k0 = k.row(j0 + jj) + offset;
+
+            flash_attention_vec _s0 = flash_attention_set1(0.f);
+            for (int d = 0; d < embed_dim_per_head; d++)
+            {
+                _s0 = flash_attention_fmadd(flash_attention_load(qtile + d * W), flash_attention_set1(k0[d]), _s0);
+            }
+            flash_attention_store(stile + jj * W, _s0);
+        }
+
+        if (!mask.empty())
+        {
+            for (int ii = 0; ii < max_ii; ii++)
+            {
+                const float* mptr = mask.row(i + ii) + j0;
+                for (jj = 0; jj < max_jj; jj++)
+                {
+                    stile[jj * W + ii] += mptr[jj];
+                }
+            }
+        }
+
+        // online softmax, rescale what has been accumulated with the previous max
+        flash_attention_vec _max_new = _max;
+        for (jj = 0; jj < max_jj; jj++)
+        {
+            _max_new = flash_attention_max(_max_new, flash_attention_load(stile + jj * W));
+        }
+
+        flash_attention_vec _alpha = flash_attention_exp(flash_attention_sub(_max, _max_new));
+        _sum = flash_attention_mul(_sum, _alpha);
+        for (jj = 0; jj < max_jj; jj++)
+        {
+            flash_attention_vec _p = flash_attention_exp(flash_attention_sub(flash_attention_load(stile + jj * W), _max_new));
+            flash_attention_store(stile + jj * W, _p);
+            _sum = flash_attention_add(_sum, _p);
+        }
+        _max = _max_new;
+
+        // out = out * alpha + p v^T
+        int d = 0;
+        for (; d + 3 < embed_dim_per_head; d += 4)
+        {
+            flash_attention_vec _o0 = flash_attention_mul(flash_attention_load(otile + d * W), _alpha);
+            flash_attention_vec _o1 = flash_attention_mul(flash_attention_load(otile + (d + 1) * W), _alpha);
+            flash_attention_vec _o2 = flash_attention_mul(flash_attention_load(otile + (d + 2) * W), _alpha);
+            flash_attention_vec _o3 = flash_attention_mul(flash_attention_load(otile + (d + 3) * W), _alpha);
+            for (jj = 0; jj < max_jj; jj++)
+            {
+                const float* vptr = v.row(j0 + jj) + offset + d;
+
+                flash_attention_vec _p = flash_attention_load(stile + jj * W);
+                _o0 = flash_attention_fmadd(_p, flash_attention_set1(vptr[0]), _o0);
+                _o1 = flash_attention_fmadd(_p, flash_attention_set1(vptr[1]), _o1);
+                _o2 = flash_attention_fmadd(_p, flash_attention_set1(vptr[2]), _o2);
+                _o3 = flash_attention_fmadd(_p, flash_attention_set1(vptr[3]), _o3);
+            }
+            flash_attention_store(otile + d * W, _o0);
+            flash_attention_store(otile + (d + 1) * W, _o1);
+            flash_attention_store(otile + (d + 2) * W, _o2);
+            flash_attention_store(otile + (d + 3) * W, _o3);
+        }
+        for (; d < embed_dim_per_head; d++)
+        {
+            flash_attention_vec _o0 = flash_attention_mul(flash_attention_load(otile + d * W), _alpha);
+            for (jj = 0; jj < max_jj; jj++)
+            {
+                _o0 = flash_attention_fmadd(flash_attention_load(stile + jj * W), flash_attention_set1(v.row(j0 + jj)[offset + d]), _o0);
+            }
+            flash_attention_store(otile + d * W, _o0);
+        }
+    }
+
+    // normalize and scatter the lanes back to the queries
+    flash_attention_store(stile, _sum);
+    for (int ii = 0; ii < max_ii; ii++)
+    {
+        stile[ii] = 1.f / stile[ii];
+    }
+    flash_attention_vec _inv_sum = flash_attention_load(stile);
+
+    for (int d = 0; d < embed_dim_per_head; d++)
+    {
+        float* outptr = out.row(d) + i;
+
+        if (max_ii == W)
+        {
+            flash_attention_store(outptr, flash_attention_mul(flash_attention_load(otile + d * W), _inv_sum));
+        }
+        else
+        {
+            flash_attention_store(otile + d * W, flash_attention_mul(flash_attention_load(otile + d * W), _inv_sum));
+            for (int ii = 0; ii < max_ii; ii++)
+            {
+                outptr[ii] = otile[d * W + ii];
+            }
+        }
+    }
+}
+
+// q_affine  embed_dim rows of src_seqlen, scaled already
+// k_affine  dst_seqlen rows of embed_dim
+// v_affine  dst_seqlen rows of embed_dim
+// mask      src_seqlen rows of dst_seqlen, one channel per head or shared, may be empty
+// top_blob  embed_dim rows of src_seqlen
+static int flash_attention(const Mat& q_affine, const Mat& k_affine, const Mat& v_affine, const Mat& mask, Mat& top_blob, int num_heads, const Option& opt)
+{
+    const int embed_dim = q_affine.h;
+    const int embed_dim_per_head = embed_dim / num_heads;
+    const int src_seqlen = q_affine.w;
+
+    const int nT = opt.num_threads;
+
+    Mat scratch(flash_attention_scratch_size(embed_dim_per_head), 1, nT, 4u, opt.workspace_allocator);
+    if (scratch.empty())
+        return -100;
+
+    const int tile_count = (src_seqlen + FLASH_ATTENTION_LANES - 1) / FLASH_ATTENTION_LANES;
+
+    #pragma omp parallel for num_threads(nT)
+    for (int t = 0; t < num_heads * tile_count; t++)
+    {
+        const int h = t / tile_count;
+        const int i = (t % tile_count) * FLASH_ATTENTION_LANES;
+        const int max_ii = std::min(src_seqlen - i, FLASH_ATTENTION_LANES);
+
+        const Mat q = q_affine.row_range(h * embed_dim_per_head, embed_dim_per_head);
+        const Mat maskm = mask.dims == 3 ? mask.channel(h) : mask;
+        Mat out = top_blob.row_range(h * embed_dim_per_head, embed_dim_per_head);
+
+        flash_attention_tile(q, k_affine, v_affine, h * embed_dim_per_head, maskm, out, i, max_ii, scratch.channel(get_omp_thread_num()));
+    }
+
+    return 0;
+}
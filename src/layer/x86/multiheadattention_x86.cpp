@@ -5,8 +5,27 @@
 
 #include "layer_type.h"
 
+#include <float.h>
+
+#if __SSE2__
+#include <emmintrin.h>
+#include "sse_mathfun.h"
+#if __AVX__
+#include <immintrin.h>
+#include "avx_mathfun.h"
+#if __AVX512F__
+#include "avx512_mathfun.h"
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+#include "cpu.h"
+
 namespace ncnn {
 
+#include "multiheadattention_flash.h"
+
 MultiHeadAttention_x86::MultiHeadAttention_x86()
 {
 #if __SSE2__
@@ -35,6 +54,8 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         opt.use_packing_layout = false; // TODO enable packing
     }
 
+    // fp32 attention is fused, the score matrix is only materialized for int8
+    if (int8_scale_term)
     {
         qk_softmax = ncnn::create_layer_cpu(ncnn::LayerType::Softmax);
         ncnn::ParamDict pd;
@@ -68,11 +89,13 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         pd.set(18, int8_scale_term);
 #endif
         q_gemm->load_param(pd);
-        Mat weights[3];
+        Mat weights[4];
         weights[0] = q_weight_data;
         weights[1] = q_bias_data;
 #if NCNN_INT8
         weights[2] = q_weight_data_int8_scales;
+        if (int8_scale_term == 3)
+            weights[3] = bottom_blob_int8_scales.range(0, 1);
 #endif
         q_gemm->load_model(ModelBinFromMatArray(weights));
         q_gemm->create_pipeline(opt);
@@ -98,16 +121,18 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         pd.set(10, 1);        // constant_broadcast_type_C
         pd.set(11, 0);        // output_N1M
         pd.set(12, 1);        // output_elempack
-        pd.set(14, 0);        // output_transpose
+        pd.set(14, int8_scale_term ? 0 : 1); // output_transpose, one row per token for the fused attention
 #if NCNN_INT8
         pd.set(18, int8_scale_term);
 #endif
         k_gemm->load_param(pd);
-        Mat weights[3];
+        Mat weights[4];
         weights[0] = k_weight_data;
         weights[1] = k_bias_data;
 #if NCNN_INT8
         weights[2] = k_weight_data_int8_scales;
+        if (int8_scale_term == 3)
+            weights[3] = bottom_blob_int8_scales.range(1, 1);
 #endif
         k_gemm->load_model(ModelBinFromMatArray(weights));
         k_gemm->create_pipeline(opt);
@@ -133,16 +158,18 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         pd.set(10, 1);        // constant_broadcast_type_C
         pd.set(11, 0);        // output_N1M
         pd.set(12, 1);        // output_elempack
-        pd.set(14, 0);        // output_transpose
+        pd.set(14, int8_scale_term ? 0 : 1); // output_transpose, one row per token for the fused attention
 #if NCNN_INT8
         pd.set(18, int8_scale_term);
 #endif
         v_gemm->load_param(pd);
-        Mat weights[3];
+        Mat weights[4];
         weights[0] = v_weight_data;
         weights[1] = v_bias_data;
 #if NCNN_INT8
         weights[2] = v_weight_data_int8_scales;
+        if (int8_scale_term == 3)
+            weights[3] = bottom_blob_int8_scales.range(2, 1);
 #endif
         v_gemm->load_model(ModelBinFromMatArray(weights));
         v_gemm->create_pipeline(opt);
@@ -168,7 +195,7 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         pd.set(10, 4);        // constant_broadcast_type_C
         pd.set(11, 0);        // output_N1M
 #if NCNN_INT8
-        pd.set(18, int8_scale_term);
+        pd.set(18, int8_scale_term ? 2 : 0); // dynamic quantize the attention output
 #endif
         o_gemm->load_param(pd);
         Mat weights[3];
@@ -189,6 +216,7 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         }
     }
 
+    if (int8_scale_term)
     {
         qk_gemm = ncnn::create_layer_cpu(ncnn::LayerType::Gemm);
         ncnn::ParamDict pd;
@@ -204,7 +232,7 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         pd.set(11, 0);                  // output_N1M
         pd.set(12, 1);                  // output_elempack
 #if NCNN_INT8
-        pd.set(18, int8_scale_term);
+        pd.set(18, 2);
 #endif
         qk_gemm->load_param(pd);
         qk_gemm->load_model(ModelBinFromMatArray(0));
@@ -213,6 +241,7 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         qk_gemm->create_pipeline(opt1);
     }
 
+    if (int8_scale_term)
     {
         qkv_gemm = ncnn::create_layer_cpu(ncnn::LayerType::Gemm);
         ncnn::ParamDict pd;
@@ -229,7 +258,7 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         pd.set(12, 1);  // output_elempack
         pd.set(14, 1);  // output_transpose
 #if NCNN_INT8
-        pd.set(18, int8_scale_term);
+        pd.set(18, 2);
 #endif
         qkv_gemm->load_param(pd);
         qkv_gemm->load_model(ModelBinFromMatArray(0));
@@ -300,12 +329,75 @@ int MultiHeadAttention_x86::destroy_pipeline(const Option& _opt)
     return 0;
 }
 
+// the quantized gemm takes one row per feature
+static int transpose_kv(const Mat& kv, Mat& affine, const Option& opt)
+{
+    const int embed_dim = kv.w;
+    const int dst_seqlen = kv.h;
+
+    affine.create(dst_seqlen, embed_dim, 4u, opt.workspace_allocator);
+    if (affine.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < embed_dim; i++)
+    {
+        float* outptr = affine.row(i);
+        for (int j = 0; j < dst_seqlen; j++)
+        {
+            outptr[j] = kv.row(j)[i];
+        }
+    }
+
+    return 0;
+}
+
+// append the projected keys or values of the new tokens to the cache in place
+// affine is replaced by the keys or values of all tokens
+int MultiHeadAttention_x86::update_kv_cache(const Mat& cached_blob, Mat& affine, Mat& top_blob, const Option& opt) const
+{
+    // the int8 gemms output one row per feature, the fp32 ones one row per token
+    const bool transposed = int8_scale_term != 0;
+
+    const int past_seqlen = cached_blob.empty() ? 0 : cached_blob.h;
+    const int cur_seqlen = transposed ? affine.w : affine.h;
+
+    int ret = append_kv_cache(cached_blob, past_seqlen + cur_seqlen, top_blob, opt);
+    if (ret != 0)
+        return ret;
+
+    if (!transposed)
+    {
+        memcpy(top_blob.row(past_seqlen), affine.data, (size_t)embed_dim * cur_seqlen * sizeof(float));
+
+        affine = top_blob;
+        return 0;
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < cur_seqlen; i++)
+    {
+        float* outptr = top_blob.row(past_seqlen + i);
+        for (int j = 0; j < embed_dim; j++)
+        {
+            outptr[j] = affine.row(j)[i];
+        }
+    }
+
+    return transpose_kv(top_blob, affine, opt);
+}
+
 int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& _opt) const
 {
+    const bool use_kv_cache = kv_cache && top_blobs.size() == 3;
+    const size_t input_blob_count = use_kv_cache ? bottom_blobs.size() - 2 : bottom_blobs.size();
+
     const Mat& q_blob = bottom_blobs[0];
-    const Mat& k_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
-    const Mat& v_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : (bottom_blobs.size() == 2 || (bottom_blobs.size() == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
-    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blobs.size() - 1] : Mat();
+    const Mat& k_blob = (input_blob_count == 1 || (input_blob_count == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
+    const Mat& v_blob = (input_blob_count == 1 || (input_blob_count == 2 && attn_mask)) ? q_blob : (input_blob_count == 2 || (input_blob_count == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
+    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[input_blob_count - 1] : Mat();
+    const Mat& cached_k_blob = use_kv_cache ? bottom_blobs[input_blob_count] : Mat();
+    const Mat& cached_v_blob = use_kv_cache ? bottom_blobs[input_blob_count + 1] : Mat();
 
     Option opt = _opt;
     if (int8_scale_term)
@@ -327,7 +419,6 @@ int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::v
 
     const int embed_dim_per_head = embed_dim / num_heads;
     const int src_seqlen = q_blob.h * q_blob.elempack;
-    const int dst_seqlen = k_blob.h * k_blob.elempack;
 
     Mat q_affine;
     int retq = q_gemm->forward(q_blob, q_affine, opt);
@@ -339,6 +430,44 @@ int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::v
     if (retk != 0)
         return retk;
 
+    if (use_kv_cache)
+    {
+        int ret = update_kv_cache(cached_k_blob, k_affine, top_blobs[1], opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    const int dst_seqlen = int8_scale_term ? k_affine.w : k_affine.h;
+
+    if (!int8_scale_term)
+    {
+        Mat v_affine;
+        int retv = v_gemm->forward(v_blob, v_affine, opt);
+        if (retv != 0)
+            return retv;
+
+        if (use_kv_cache)
+        {
+            int ret = update_kv_cache(cached_v_blob, v_affine, top_blobs[2], opt);
+            if (ret != 0)
+                return ret;
+        }
+
+        Mat qkv_cross(src_seqlen, embed_dim_per_head * num_heads, 4u, opt.blob_allocator);
+        if (qkv_cross.empty())
+            return -100;
+
+        int retqkv = flash_attention(q_affine, k_affine, v_affine, attn_mask_blob_unpacked, qkv_cross, num_heads, opt);
+        if (retqkv != 0)
+            return retqkv;
+
+        q_affine.release();
+        k_affine.release();
+        v_affine.release();
+
+        return o_gemm->forward(qkv_cross, top_blobs[0], opt);
+    }
+
     Mat qk_cross(dst_seqlen, src_seqlen * num_heads, 4u, opt.blob_allocator);
     if (qk_cross.empty())
         return -100;
@@ -380,6 +509,13 @@ int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::v
     if (retv != 0)
         return retv;
 
+    if (use_kv_cache)
+    {
+        int ret = update_kv_cache(cached_v_blob, v_affine, top_blobs[2], opt);
+        if (ret != 0)
+            return ret;
+    }
+
     Mat qkv_cross(src_seqlen, embed_dim_per_head * num_heads, 4u, opt.blob_allocator);
     if (qkv_cross.empty())
         return -100;
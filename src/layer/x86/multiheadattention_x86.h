@@ -18,6 +18,9 @@ public:
 
     virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 
+protected:
+    int update_kv_cache(const Mat& cached_blob, Mat& affine, Mat& top_blob, const Option& opt) const;
+
 public:
     Layer* q_gemm;
     Layer* k_gemm;
@@ -10,6 +10,8 @@
 #endif
 #endif // __SSE2__
 
+#include "x86_usability.h"
+
 #include <float.h>
 
 namespace ncnn {
@@ -33,6 +35,9 @@ Pooling_x86::Pooling_x86()
 #if __SSE2__
     support_packing = true;
 #endif // __SSE2__
+#if NCNN_BF16
+    support_bf16_storage = true;
+#endif
 }
 
 int Pooling_x86::create_pipeline(const Option& /*opt*/)
@@ -59,6 +64,11 @@ int Pooling_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& op
         return Pooling::forward(bottom_blob, top_blob, opt);
     }
 
+#if NCNN_BF16
+    if (opt.use_bf16_storage && bottom_blob.elembits() == 16)
+        return forward_bf16s(bottom_blob, top_blob, opt);
+#endif
+
 #if __SSE2__
     int elempack = bottom_blob.elempack;
     int w = bottom_blob.w;
@@ -815,4 +825,250 @@ int Pooling_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& op
 #endif
 }
 
+#if NCNN_BF16
+int Pooling_x86::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    // bf16 is widened in registers and reduced in fp32, the padded border is never materialized
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+    const bool is_max = pooling_type == PoolMethod_MAX;
+
+    if (global_pooling)
+    {
+        top_blob.create(channels, elemsize, elempack, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        const int size = w * h;
+        const float scale = is_max ? 1.f : 1.f / size;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            const unsigned short* ptr = bottom_blob.channel(q);
+            unsigned short* outptr = (unsigned short*)top_blob + q * elempack;
+
+            int l = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+            for (; l + 15 < elempack; l += 16)
+            {
+                __m512 _s = is_max ? _mm512_set1_ps(-FLT_MAX) : _mm512_setzero_ps();
+                for (int i = 0; i < size; i++)
+                {
+                    __m512 _val = bfloat2float_avx512(_mm256_loadu_si256((const __m256i*)(ptr + i * elempack + l)));
+                    _s = is_max ? _mm512_max_ps(_s, _val) : _mm512_add_ps(_s, _val);
+                }
+                _s = _mm512_mul_ps(_s, _mm512_set1_ps(scale));
+                _mm256_storeu_si256((__m256i*)(outptr + l), float2bfloat_avx512(_s));
+            }
+#endif // __AVX512F__
+            for (; l + 7 < elempack; l += 8)
+            {
+                __m256 _s = is_max ? _mm256_set1_ps(-FLT_MAX) : _mm256_setzero_ps();
+                for (int i = 0; i < size; i++)
+                {
+                    __m256 _val = bfloat2float_avx(_mm_loadu_si128((const __m128i*)(ptr + i * elempack + l)));
+                    _s = is_max ? _mm256_max_ps(_s, _val) : _mm256_add_ps(_s, _val);
+                }
+                _s = _mm256_mul_ps(_s, _mm256_set1_ps(scale));
+                _mm_storeu_si128((__m128i*)(outptr + l), float2bfloat_avx(_s));
+            }
+#endif // __AVX__
+            for (; l + 3 < elempack; l += 4)
+            {
+                __m128 _s = is_max ? _mm_set1_ps(-FLT_MAX) : _mm_setzero_ps();
+                for (int i = 0; i < size; i++)
+                {
+                    __m128 _val = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)(ptr + i * elempack + l)));
+                    _s = is_max ? _mm_max_ps(_s, _val) : _mm_add_ps(_s, _val);
+                }
+                _s = _mm_mul_ps(_s, _mm_set1_ps(scale));
+                _mm_storel_epi64((__m128i*)(outptr + l), float2bfloat_sse(_s, _s));
+            }
+#endif // __SSE2__
+            for (; l < elempack; l++)
+            {
+                float s = is_max ? -FLT_MAX : 0.f;
+                for (int i = 0; i < size; i++)
+                {
+                    float val = bfloat16_to_float32(ptr[i * elempack + l]);
+                    s = is_max ? std::max(s, val) : s + val;
+                }
+                outptr[l] = float32_to_bfloat16(s * scale);
+            }
+        }
+
+        return 0;
+    }
+
+    // the same geometry as make_padding, in input coordinates
+    int pad_t = pad_top;
+    int pad_l = pad_left;
+    int wtailpad = 0;
+    int htailpad = 0;
+    int wb = w + pad_left + pad_right;
+    int hb = h + pad_top + pad_bottom;
+    if (pad_mode == 0) // full padding
+    {
+        int wtail = (w + pad_left + pad_right - kernel_w) % stride_w;
+        int htail = (h + pad_top + pad_bottom - kernel_h) % stride_h;
+
+        if (wtail != 0)
+            wtailpad = stride_w - wtail;
+        if (htail != 0)
+            htailpad = stride_h - htail;
+
+        wb += wtailpad;
+        hb += htailpad;
+    }
+    else if (pad_mode == 2 || pad_mode == 3) // onnx padding=SAME_UPPER or SAME_LOWER
+    {
+        int wpad = kernel_w + (w - 1) / stride_w * stride_w - w;
+        int hpad = kernel_h + (h - 1) / stride_h * stride_h - h;
+        if (wpad > 0 || hpad > 0)
+        {
+            pad_t = pad_mode == 2 ? hpad / 2 : hpad - hpad / 2;
+            pad_l = pad_mode == 2 ? wpad / 2 : wpad - wpad / 2;
+            wb = w + wpad;
+            hb = h + hpad;
+        }
+        else
+        {
+            pad_t = 0;
+            pad_l = 0;
+            wb = w;
+            hb = h;
+        }
+    }
+
+    int outw = (wb - kernel_w) / stride_w + 1;
+    int outh = (hb - kernel_h) / stride_h + 1;
+
+    top_blob.create(outw, outh, channels, elemsize, elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const int maxk = kernel_w * kernel_h;
+
+    // the averaging area counted by the fp32 path, in padded coordinates
+    const int area_y0 = pad_top;
+    const int area_y1 = hb - pad_bottom - htailpad;
+    const int area_x0 = pad_left;
+    const int area_x1 = wb - pad_right - wtailpad;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
+    {
+        const Mat m = bottom_blob.channel(q);
+        unsigned short* outptr = top_blob.channel(q);
+
+        for (int i = 0; i < outh; i++)
+        {
+            const int sy0 = i * stride_h;
+            const int y0 = std::max(sy0, pad_t) - pad_t;
+            const int y1 = std::min(sy0 + kernel_h, pad_t + h) - pad_t;
+
+            for (int j = 0; j < outw; j++)
+            {
+                const int sx0 = j * stride_w;
+                const int x0 = std::max(sx0, pad_l) - pad_l;
+                const int x1 = std::min(sx0 + kernel_w, pad_l + w) - pad_l;
+
+                float scale = 1.f;
+                if (!is_max)
+                {
+                    if (avgpool_count_include_pad == 0)
+                    {
+                        const int area_h = std::min(sy0 + kernel_h, area_y1) - std::max(sy0, area_y0);
+                        const int area_w = std::min(sx0 + kernel_w, area_x1) - std::max(sx0, area_x0);
+                        scale = 1.f / (area_h * area_w);
+                    }
+                    else
+                    {
+                        scale = 1.f / maxk;
+                    }
+                }
+
+                int l = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+                for (; l + 15 < elempack; l += 16)
+                {
+                    __m512 _s = is_max ? _mm512_set1_ps(-FLT_MAX) : _mm512_setzero_ps();
+                    for (int y = y0; y < y1; y++)
+                    {
+                        const unsigned short* sptr = m.row<const unsigned short>(y) + l;
+                        for (int x = x0; x < x1; x++)
+                        {
+                            __m512 _val = bfloat2float_avx512(_mm256_loadu_si256((const __m256i*)(sptr + x * elempack)));
+                            _s = is_max ? _mm512_max_ps(_s, _val) : _mm512_add_ps(_s, _val);
+                        }
+                    }
+                    _s = _mm512_mul_ps(_s, _mm512_set1_ps(scale));
+                    _mm256_storeu_si256((__m256i*)(outptr + l), float2bfloat_avx512(_s));
+                }
+#endif // __AVX512F__
+                for (; l + 7 < elempack; l += 8)
+                {
+                    __m256 _s = is_max ? _mm256_set1_ps(-FLT_MAX) : _mm256_setzero_ps();
+                    for (int y = y0; y < y1; y++)
+                    {
+                        const unsigned short* sptr = m.row<const unsigned short>(y) + l;
+                        for (int x = x0; x < x1; x++)
+                        {
+                            __m256 _val = bfloat2float_avx(_mm_loadu_si128((const __m128i*)(sptr + x * elempack)));
+                            _s = is_max ? _mm256_max_ps(_s, _val) : _mm256_add_ps(_s, _val);
+                        }
+                    }
+                    _s = _mm256_mul_ps(_s, _mm256_set1_ps(scale));
+                    _mm_storeu_si128((__m128i*)(outptr + l), float2bfloat_avx(_s));
+                }
+#endif // __AVX__
+                for (; l + 3 < elempack; l += 4)
+                {
+                    __m128 _s = is_max ? _mm_set1_ps(-FLT_MAX) : _mm_setzero_ps();
+                    for (int y = y0; y < y1; y++)
+                    {
+                        const unsigned short* sptr = m.row<const unsigned short>(y) + l;
+                        for (int x = x0; x < x1; x++)
+                        {
+                            __m128 _val = bfloat2float_sse(_mm_loadl_epi64((const __m128i*)(sptr + x * elempack)));
+                            _s = is_max ? _mm_max_ps(_s, _val) : _mm_add_ps(_s, _val);
+                        }
+                    }
+                    _s = _mm_mul_ps(_s, _mm_set1_ps(scale));
+                    _mm_storel_epi64((__m128i*)(outptr + l), float2bfloat_sse(_s, _s));
+                }
+#endif // __SSE2__
+                for (; l < elempack; l++)
+                {
+                    float s = is_max ? -FLT_MAX : 0.f;
+                    for (int y = y0; y < y1; y++)
+                    {
+                        const unsigned short* sptr = m.row<const unsigned short>(y) + l;
+                        for (int x = x0; x < x1; x++)
+                        {
+                            float val = bfloat16_to_float32(sptr[x * elempack]);
+                            s = is_max ? std::max(s, val) : s + val;
+                        }
+                    }
+                    outptr[l] = float32_to_bfloat16(s * scale);
+                }
+
+                outptr += elempack;
+            }
+        }
+    }
+
+    return 0;
+}
+#endif // NCNN_BF16
+
 } // namespace ncnn
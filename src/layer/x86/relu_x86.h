@@ -16,6 +16,9 @@ public:
     virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
 
 protected:
+#if NCNN_BF16
+    int forward_inplace_bf16s(Mat& bottom_top_blob, const Option& opt) const;
+#endif
     int forward_inplace_int8(Mat& bottom_top_blob, const Option& opt) const;
 };
 
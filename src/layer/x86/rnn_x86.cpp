@@ -0,0 +1,442 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "rnn_x86.h"
+
+#include "layer_type.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#include "sse_mathfun.h"
+#if __AVX__
+#include <immintrin.h>
+#include "avx_mathfun.h"
+#if __AVX512F__
+#include "avx512_mathfun.h"
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_activation.h"
+#include "x86_usability.h"
+
+namespace ncnn {
+
+#if NCNN_INT8
+#include "rnn_int8.h"
+#endif
+
+RNN_x86::RNN_x86()
+{
+    xc_gemm[0] = 0;
+    xc_gemm[1] = 0;
+}
+
+static void rnn_transform_weight_hc_block(const Mat& weight_hc, int q, int bs, int num_output, float* pp)
+{
+    // bs hidden units side by side for each previous hidden value
+    for (int i = 0; i < num_output; i++)
+    {
+        for (int k = 0; k < bs; k++)
+        {
+            *pp++ = weight_hc.row(q + k)[i];
+        }
+    }
+}
+
+int RNN_x86::create_pipeline(const Option& opt)
+{
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        return create_pipeline_int8(opt);
+    }
+#endif
+
+    const int num_directions = direction == 2 ? 2 : 1;
+    const int size = weight_data_size / num_directions / num_output;
+
+    // the input projection stays in fp32
+    Option opt_gemm = opt;
+    opt_gemm.use_fp16_storage = false;
+    opt_gemm.use_bf16_storage = false;
+
+    // project the whole sequence at once, rows of the output are the gates of each timestep
+    for (int dr = 0; dr < num_directions; dr++)
+    {
+        xc_gemm[dr] = ncnn::create_layer_cpu(ncnn::LayerType::Gemm);
+        ncnn::ParamDict pd;
+        pd.set(2, 0);          // transA
+        pd.set(3, 1);          // transB
+        pd.set(4, 0);          // constantA
+        pd.set(5, 1);          // constantB
+        pd.set(6, 1);          // constantC
+        pd.set(7, 0);          // M
+        pd.set(8, num_output); // N
+        pd.set(9, size);       // K
+        pd.set(10, 4);         // constant_broadcast_type_C
+        pd.set(11, 0);         // output_N1M
+        pd.set(12, 1);         // output_elempack
+        pd.set(14, 0);         // output_transpose
+        xc_gemm[dr]->load_param(pd);
+        Mat weights[2];
+        weights[0] = weight_xc_data.channel(dr);
+        weights[1] = bias_c_data.channel(dr).clone().reshape(num_output, 1);
+        xc_gemm[dr]->load_model(ModelBinFromMatArray(weights));
+        xc_gemm[dr]->create_pipeline(opt_gemm);
+    }
+
+    weight_hc_data_packed.create(num_output * num_output, 1, num_directions);
+    if (weight_hc_data_packed.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int dr = 0; dr < num_directions; dr++)
+    {
+        const Mat weight_hc = weight_hc_data.channel(dr);
+        float* pp = weight_hc_data_packed.channel(dr);
+
+        int q = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+        for (; q + 15 < num_output; q += 16)
+        {
+            rnn_transform_weight_hc_block(weight_hc, q, 16, num_output, pp + q * num_output);
+        }
+#endif // __AVX512F__
+        for (; q + 7 < num_output; q += 8)
+        {
+            rnn_transform_weight_hc_block(weight_hc, q, 8, num_output, pp + q * num_output);
+        }
+#endif // __AVX__
+        for (; q + 3 < num_output; q += 4)
+        {
+            rnn_transform_weight_hc_block(weight_hc, q, 4, num_output, pp + q * num_output);
+        }
+#endif // __SSE2__
+        for (; q < num_output; q++)
+        {
+            rnn_transform_weight_hc_block(weight_hc, q, 1, num_output, pp + q * num_output);
+        }
+    }
+
+    if (opt.lightmode)
+    {
+        weight_xc_data.release();
+        bias_c_data.release();
+        weight_hc_data.release();
+    }
+
+    return 0;
+}
+
+int RNN_x86::destroy_pipeline(const Option& opt)
+{
+    Option opt_gemm = opt;
+    opt_gemm.use_fp16_storage = false;
+    opt_gemm.use_bf16_storage = false;
+
+    for (int dr = 0; dr < 2; dr++)
+    {
+        if (xc_gemm[dr])
+        {
+            xc_gemm[dr]->destroy_pipeline(opt_gemm);
+            delete xc_gemm[dr];
+            xc_gemm[dr] = 0;
+        }
+    }
+
+    return 0;
+}
+
+static void rnn(const Mat& gates_x, Mat& top_blob, int reverse, const Mat& weight_hc, Mat& hidden_state, const Option& opt)
+{
+    const int T = gates_x.h;
+    const int num_output = top_blob.w;
+
+    // unroll
+    for (int t = 0; t < T; t++)
+    {
+        int ti = reverse ? T - 1 - t : t;
+
+        // the previous output row is the hidden state
+        const float* hs = t == 0 ? (const float*)hidden_state : top_blob.row(reverse ? ti + 1 : ti - 1);
+
+        const float* gates_x_H = gates_x.row(ti);
+
+        float* outptr = top_blob.row(ti);
+
+        int remain_num_output_start = 0;
+#if __SSE2__
+        int nn_num_output = 0;
+#if __AVX__
+#if __AVX512F__
+        nn_num_output = (num_output - remain_num_output_start) >> 4;
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int qq = 0; qq < nn_num_output; qq++)
+        {
+            const int q = remain_num_output_start + qq * 16;
+
+            const float* kptr = (const float*)weight_hc + q * num_output;
+
+            __m512 _H0 = _mm512_loadu_ps(gates_x_H + q);
+            __m512 _H1 = _mm512_setzero_ps();
+            int i = 0;
+            for (; i + 1 < num_output; i += 2)
+            {
+                _H0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr), _mm512_set1_ps(hs[i]), _H0);
+                _H1 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr + 16), _mm512_set1_ps(hs[i + 1]), _H1);
+
+                kptr += 32;
+            }
+            for (; i < num_output; i++)
+            {
+                _H0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr), _mm512_set1_ps(hs[i]), _H0);
+
+                kptr += 16;
+            }
+
+            _mm512_storeu_ps(outptr + q, tanh_avx512(_mm512_add_ps(_H0, _H1)));
+        }
+        remain_num_output_start += nn_num_output << 4;
+#endif // __AVX512F__
+        nn_num_output = (num_output - remain_num_output_start) >> 3;
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int qq = 0; qq < nn_num_output; qq++)
+        {
+            const int q = remain_num_output_start + qq * 8;
+
+            const float* kptr = (const float*)weight_hc + q * num_output;
+
+            __m256 _H0 = _mm256_loadu_ps(gates_x_H + q);
+            __m256 _H1 = _mm256_setzero_ps();
+            int i = 0;
+            for (; i + 1 < num_output; i += 2)
+            {
+                _H0 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _mm256_set1_ps(hs[i]), _H0);
+                _H1 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 8), _mm256_set1_ps(hs[i + 1]), _H1);
+
+                kptr += 16;
+            }
+            for (; i < num_output; i++)
+            {
+                _H0 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _mm256_set1_ps(hs[i]), _H0);
+
+                kptr += 8;
+            }
+
+            _mm256_storeu_ps(outptr + q, tanh_avx(_mm256_add_ps(_H0, _H1)));
+        }
+        remain_num_output_start += nn_num_output << 3;
+#endif // __AVX__
+        nn_num_output = (num_output - remain_num_output_start) >> 2;
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int qq = 0; qq < nn_num_output; qq++)
+        {
+            const int q = remain_num_output_start + qq * 4;
+
+            const float* kptr = (const float*)weight_hc + q * num_output;
+
+            __m128 _H0 = _mm_loadu_ps(gates_x_H + q);
+            __m128 _H1 = _mm_setzero_ps();
+            int i = 0;
+            for (; i + 1 < num_output; i += 2)
+            {
+                _H0 = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr), _mm_set1_ps(hs[i]), _H0);
+                _H1 = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 4), _mm_set1_ps(hs[i + 1]), _H1);
+
+                kptr += 8;
+            }
+            for (; i < num_output; i++)
+            {
+                _H0 = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr), _mm_set1_ps(hs[i]), _H0);
+
+                kptr += 4;
+            }
+
+            _mm_storeu_ps(outptr + q, tanh_sse(_mm_add_ps(_H0, _H1)));
+        }
+        remain_num_output_start += nn_num_output << 2;
+#endif // __SSE2__
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = remain_num_output_start; q < num_output; q++)
+        {
+            const float* kptr = (const float*)weight_hc + q * num_output;
+
+            float H = gates_x_H[q];
+            for (int i = 0; i < num_output; i++)
+            {
+                H += kptr[i] * hs[i];
+            }
+
+            outptr[q] = tanhf(H);
+        }
+    }
+
+    if (T > 0)
+    {
+        memcpy((float*)hidden_state, top_blob.row(reverse ? 0 : T - 1), num_output * sizeof(float));
+    }
+}
+
+int RNN_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    std::vector<Mat> bottom_blobs(1, bottom_blob);
+    std::vector<Mat> top_blobs(1, top_blob);
+    int ret = forward(bottom_blobs, top_blobs, opt);
+    top_blob = top_blobs[0];
+    return ret;
+}
+
+int RNN_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const Mat& bottom_blob = bottom_blobs[0];
+    int T = bottom_blob.h;
+    int num_directions = direction == 2 ? 2 : 1;
+
+    Mat hidden;
+    Allocator* hidden_allocator = top_blobs.size() == 2 ? opt.blob_allocator : opt.workspace_allocator;
+    if (bottom_blobs.size() == 2)
+    {
+        hidden = bottom_blobs[1].clone(hidden_allocator);
+    }
+    else
+    {
+        hidden.create(num_output, num_directions, 4u, hidden_allocator);
+        if (hidden.empty())
+            return -100;
+        hidden.fill(0.f);
+    }
+
+    Mat& top_blob = top_blobs[0];
+    top_blob.create(num_output * num_directions, T, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // input projections of all timesteps, the recurrence only multiplies the hidden state
+    Mat gates_x[2];
+#if NCNN_INT8
+    Mat hidden_int8[2];
+    if (int8_scale_term)
+    {
+        Mat bottom_blob_int8;
+        Mat bottom_blob_int8_descales;
+        int ret = rnn_int8_dynamic_quantize(bottom_blob, bottom_blob_int8_scales, bottom_blob_int8, bottom_blob_int8_descales, opt);
+        if (ret != 0)
+            return ret;
+
+        for (int dr = 0; dr < num_directions; dr++)
+        {
+            gates_x[dr].create(num_output, T, 4u, opt.workspace_allocator);
+            if (gates_x[dr].empty())
+                return -100;
+
+            hidden_int8[dr].create((num_output + 1) / 2 * 2, 2u, opt.workspace_allocator);
+            if (hidden_int8[dr].empty())
+                return -100;
+
+            rnn_int8_gates_x(bottom_blob_int8, bottom_blob_int8_descales, gates_x[dr], weight_xc_data_packed.channel(dr), weight_xc_data_int8_descales.row(dr), bias_c_data.channel(dr), opt);
+        }
+    }
+    else
+#endif
+    {
+        Option opt_gemm = opt;
+        opt_gemm.blob_allocator = opt.workspace_allocator;
+        opt_gemm.use_fp16_storage = false;
+        opt_gemm.use_bf16_storage = false;
+
+        for (int dr = 0; dr < num_directions; dr++)
+        {
+            int ret = xc_gemm[dr]->forward(bottom_blob, gates_x[dr], opt_gemm);
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    // Uni directional
+    if (direction == 0 || direction == 1)
+    {
+        Mat hidden0 = hidden.row_range(0, 1);
+#if NCNN_INT8
+        if (int8_scale_term)
+        {
+            rnn_int8(gates_x[0], top_blob, direction, weight_hc_data_packed.channel(0), weight_hc_data_int8_descales.row(0), hidden0, hidden_int8[0], opt);
+        }
+        else
+#endif
+        {
+            rnn(gates_x[0], top_blob, direction, weight_hc_data_packed.channel(0), hidden0, opt);
+        }
+    }
+
+    if (direction == 2)
+    {
+        Mat top_blob_forward(num_output, T, 4u, opt.workspace_allocator);
+        if (top_blob_forward.empty())
+            return -100;
+
+        Mat top_blob_reverse(num_output, T, 4u, opt.workspace_allocator);
+        if (top_blob_reverse.empty())
+            return -100;
+
+        Mat top_blob_dr[2] = {top_blob_forward, top_blob_reverse};
+
+        for (int dr = 0; dr < 2; dr++)
+        {
+            Mat hidden_dr = hidden.row_range(dr, 1);
+#if NCNN_INT8
+            if (int8_scale_term)
+            {
+                rnn_int8(gates_x[dr], top_blob_dr[dr], dr, weight_hc_data_packed.channel(dr), weight_hc_data_int8_descales.row(dr), hidden_dr, hidden_int8[dr], opt);
+            }
+            else
+#endif
+            {
+                rnn(gates_x[dr], top_blob_dr[dr], dr, weight_hc_data_packed.channel(dr), hidden_dr, opt);
+            }
+        }
+
+        // concat w
+        for (int i = 0; i < T; i++)
+        {
+            const float* pf = top_blob_forward.row(i);
+            const float* pr = top_blob_reverse.row(i);
+            float* ptr = top_blob.row(i);
+
+            memcpy(ptr, pf, num_output * sizeof(float));
+            memcpy(ptr + num_output, pr, num_output * sizeof(float));
+        }
+    }
+
+    if (top_blobs.size() == 2)
+    {
+        top_blobs[1] = hidden;
+    }
+
+    return 0;
+}
+
+#if NCNN_INT8
+int RNN_x86::create_pipeline_int8(const Option& opt)
+{
+    const int num_directions = direction == 2 ? 2 : 1;
+    const int size = weight_data_size / num_directions / num_output;
+
+    rnn_transform_weight_int8(weight_xc_data, weight_xc_data_int8_scales, weight_hc_data, weight_hc_data_int8_scales, weight_xc_data_packed, weight_xc_data_int8_descales, weight_hc_data_packed, weight_hc_data_int8_descales, size, num_output, num_directions, opt);
+
+    // bias_c_data is kept for the input projection
+    if (opt.lightmode)
+    {
+        weight_xc_data.release();
+        weight_hc_data.release();
+        weight_xc_data_int8_scales.release();
+        weight_hc_data_int8_scales.release();
+    }
+
+    return 0;
+}
+#endif // NCNN_INT8
+
+} // namespace ncnn
@@ -0,0 +1,43 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef LAYER_RNN_X86_H
+#define LAYER_RNN_X86_H
+
+#include "rnn.h"
+
+namespace ncnn {
+
+class RNN_x86 : public RNN
+{
+public:
+    RNN_x86();
+
+    virtual int create_pipeline(const Option& opt);
+    virtual int destroy_pipeline(const Option& opt);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+    virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
+protected:
+#if NCNN_INT8
+    int create_pipeline_int8(const Option& opt);
+#endif
+
+public:
+    // input projection of the whole sequence for each direction
+    Layer* xc_gemm[2];
+
+    Mat weight_xc_data_packed;
+    Mat weight_hc_data_packed;
+
+#if NCNN_INT8
+    Mat weight_xc_data_int8_descales;
+    Mat weight_hc_data_int8_descales;
+#endif
+};
+
+} // namespace ncnn
+
+#endif // LAYER_RNN_X86_H
@@ -0,0 +1,176 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "spectrogram_x86.h"
+
+#include "cpu.h"
+#include "x86_fft.h"
+
+namespace ncnn {
+
+Spectrogram_x86::Spectrogram_x86()
+{
+}
+
+int Spectrogram_x86::create_pipeline(const Option& /*opt*/)
+{
+    fft_make_plan(n_fft, fft_radices, fft_roots, fft_twiddles);
+
+    return 0;
+}
+
+int Spectrogram_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    Mat bottom_blob_bordered = bottom_blob;
+    if (center == 1)
+    {
+        Option opt_b = opt;
+        opt_b.blob_allocator = opt.workspace_allocator;
+        if (pad_type == 0)
+            copy_make_border(bottom_blob, bottom_blob_bordered, 0, 0, n_fft / 2, n_fft / 2, BORDER_CONSTANT, 0.f, opt_b);
+        if (pad_type == 1)
+            copy_make_border(bottom_blob, bottom_blob_bordered, 0, 0, n_fft / 2, n_fft / 2, BORDER_REPLICATE, 0.f, opt_b);
+        if (pad_type == 2)
+            copy_make_border(bottom_blob, bottom_blob_bordered, 0, 0, n_fft / 2, n_fft / 2, BORDER_REFLECT, 0.f, opt_b);
+    }
+
+    const int size = bottom_blob_bordered.w;
+
+    const int frames = (size - n_fft) / hoplen + 1;
+    const int freqs_onesided = n_fft / 2 + 1;
+    const int freqs = onesided ? freqs_onesided : n_fft;
+
+    const size_t elemsize = bottom_blob_bordered.elemsize;
+
+    if (power == 0)
+    {
+        top_blob.create(2, frames, freqs, elemsize, opt.blob_allocator);
+    }
+    else
+    {
+        top_blob.create(frames, freqs, elemsize, opt.blob_allocator);
+    }
+    if (top_blob.empty())
+        return -100;
+
+    // two fft buffers per thread
+    Mat fft_workspace(n_fft * 2 * 2, 1, opt.num_threads, 4u, opt.workspace_allocator);
+    if (fft_workspace.empty())
+        return -100;
+
+    float norm = 1.f;
+    if (normalized == 1)
+        norm = 1.f / sqrt(n_fft);
+    if (normalized == 2)
+        norm = window_data[n_fft];
+
+    // two real frames are transformed at once as the real and imaginary part of one complex sequence
+    const int frame_pairs = (frames + 1) / 2;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int jj = 0; jj < frame_pairs; jj++)
+    {
+        const int j0 = jj * 2;
+        const int j1 = j0 + 1;
+
+        float* x = fft_workspace.channel(get_omp_thread_num());
+        float* buf = x + n_fft * 2;
+
+        {
+            const float* ptr0 = (const float*)bottom_blob_bordered + j0 * hoplen;
+            const float* ptr1 = (const float*)bottom_blob_bordered + j1 * hoplen;
+            const float* window = window_data;
+
+            if (j1 < frames)
+            {
+                for (int k = 0; k < n_fft; k++)
+                {
+                    x[k * 2] = ptr0[k] * window[k];
+                    x[k * 2 + 1] = ptr1[k] * window[k];
+                }
+            }
+            else
+            {
+                for (int k = 0; k < n_fft; k++)
+                {
+                    x[k * 2] = ptr0[k] * window[k];
+                    x[k * 2 + 1] = 0.f;
+                }
+            }
+        }
+
+        const float* z = fft_forward(x, buf, n_fft, fft_radices, fft_roots, fft_twiddles);
+
+        for (int i = 0; i < freqs_onesided; i++)
+        {
+            const int ni = i == 0 ? 0 : n_fft - i;
+
+            const float zr = z[i * 2];
+            const float zi = z[i * 2 + 1];
+            const float yr = z[ni * 2];
+            const float yi = z[ni * 2 + 1];
+
+            float re[2];
+            float im[2];
+            re[0] = (zr + yr) * 0.5f * norm;
+            im[0] = (zi - yi) * 0.5f * norm;
+            re[1] = (zi + yi) * 0.5f * norm;
+            im[1] = (yr - zr) * 0.5f * norm;
+
+            for (int q = 0; q < 2 && j0 + q < frames; q++)
+            {
+                const int j = j0 + q;
+
+                if (power == 0)
+                {
+                    // complex as real
+                    float* outptr = top_blob.channel(i).row(j);
+                    outptr[0] = re[q];
+                    outptr[1] = im[q];
+                }
+                if (power == 1)
+                {
+                    // magnitude
+                    top_blob.row(i)[j] = sqrt(re[q] * re[q] + im[q] * im[q]);
+                }
+                if (power == 2)
+                {
+                    top_blob.row(i)[j] = re[q] * re[q] + im[q] * im[q];
+                }
+            }
+        }
+    }
+
+    if (!onesided)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = freqs_onesided; i < n_fft; i++)
+        {
+            if (power == 0)
+            {
+                const float* ptr = top_blob.channel(n_fft - i);
+                float* outptr = top_blob.channel(i);
+
+                for (int j = 0; j < frames; j++)
+                {
+                    // complex as real
+                    outptr[0] = ptr[0];
+                    outptr[1] = -ptr[1];
+                    ptr += 2;
+                    outptr += 2;
+                }
+            }
+            else // if (power == 1 || power == 2)
+            {
+                const float* ptr = top_blob.row(n_fft - i);
+                float* outptr = top_blob.row(i);
+
+                memcpy(outptr, ptr, frames * sizeof(float));
+            }
+        }
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
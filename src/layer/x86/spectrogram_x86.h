@@ -0,0 +1,28 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef LAYER_SPECTROGRAM_X86_H
+#define LAYER_SPECTROGRAM_X86_H
+
+#include "spectrogram.h"
+
+namespace ncnn {
+
+class Spectrogram_x86 : public Spectrogram
+{
+public:
+    Spectrogram_x86();
+
+    virtual int create_pipeline(const Option& opt);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    std::vector<int> fft_radices;
+    Mat fft_roots;
+    Mat fft_twiddles;
+};
+
+} // namespace ncnn
+
+#endif // LAYER_SPECTROGRAM_X86_H
@@ -0,0 +1,435 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef X86_FFT_H
+#define X86_FFT_H
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+#include "mat.h"
+
+// mixed radix stockham fft over interleaved complex float
+// n is factorized into radix 4, 2, 3, 5 stages and a generic radix for the remaining primes
+// the butterflies of one stage run over the contiguous stride index, two or four complex values per simd register
+
+struct fft_cpx
+{
+    float re;
+    float im;
+};
+
+static NCNN_FORCEINLINE fft_cpx fft_load(const float* p, fft_cpx)
+{
+    fft_cpx v;
+    v.re = p[0];
+    v.im = p[1];
+    return v;
+}
+
+static NCNN_FORCEINLINE void fft_store(float* p, const fft_cpx& v)
+{
+    p[0] = v.re;
+    p[1] = v.im;
+}
+
+static NCNN_FORCEINLINE fft_cpx fft_add(const fft_cpx& a, const fft_cpx& b)
+{
+    fft_cpx v;
+    v.re = a.re + b.re;
+    v.im = a.im + b.im;
+    return v;
+}
+
+static NCNN_FORCEINLINE fft_cpx fft_sub(const fft_cpx& a, const fft_cpx& b)
+{
+    fft_cpx v;
+    v.re = a.re - b.re;
+    v.im = a.im - b.im;
+    return v;
+}
+
+static NCNN_FORCEINLINE fft_cpx fft_scale(const fft_cpx& a, float s)
+{
+    fft_cpx v;
+    v.re = a.re * s;
+    v.im = a.im * s;
+    return v;
+}
+
+// a * -i
+static NCNN_FORCEINLINE fft_cpx fft_mul_neg_i(const fft_cpx& a)
+{
+    fft_cpx v;
+    v.re = a.im;
+    v.im = -a.re;
+    return v;
+}
+
+static NCNN_FORCEINLINE fft_cpx fft_mul(const fft_cpx& a, const float* w)
+{
+    fft_cpx v;
+    v.re = a.re * w[0] - a.im * w[1];
+    v.im = a.re * w[1] + a.im * w[0];
+    return v;
+}
+
+#if __SSE2__
+static NCNN_FORCEINLINE __m128 fft_load(const float* p, __m128)
+{
+    return _mm_loadu_ps(p);
+}
+
+static NCNN_FORCEINLINE void fft_store(float* p, const __m128& v)
+{
+    _mm_storeu_ps(p, v);
+}
+
+static NCNN_FORCEINLINE __m128 fft_add(const __m128& a, const __m128& b)
+{
+    return _mm_add_ps(a, b);
+}
+
+static NCNN_FORCEINLINE __m128 fft_sub(const __m128& a, const __m128& b)
+{
+    return _mm_sub_ps(a, b);
+}
+
+static NCNN_FORCEINLINE __m128 fft_scale(const __m128& a, float s)
+{
+    return _mm_mul_ps(a, _mm_set1_ps(s));
+}
+
+static NCNN_FORCEINLINE __m128 fft_mul_neg_i(const __m128& a)
+{
+    // (re, im) -> (im, -re)
+    __m128 _swap = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_xor_ps(_swap, _mm_castsi128_ps(_mm_setr_epi32(0, 0x80000000, 0, 0x80000000)));
+}
+
+static NCNN_FORCEINLINE __m128 fft_mul(const __m128& a, const float* w)
+{
+    __m128 _wr = _mm_set1_ps(w[0]);
+    __m128 _wi = _mm_setr_ps(-w[1], w[1], -w[1], w[1]);
+    __m128 _swap = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_add_ps(_mm_mul_ps(a, _wr), _mm_mul_ps(_swap, _wi));
+}
+
+#if __AVX__
+static NCNN_FORCEINLINE __m256 fft_load(const float* p, __m256)
+{
+    return _mm256_loadu_ps(p);
+}
+
+static NCNN_FORCEINLINE void fft_store(float* p, const __m256& v)
+{
+    _mm256_storeu_ps(p, v);
+}
+
+static NCNN_FORCEINLINE __m256 fft_add(const __m256& a, const __m256& b)
+{
+    return _mm256_add_ps(a, b);
+}
+
+static NCNN_FORCEINLINE __m256 fft_sub(const __m256& a, const __m256& b)
+{
+    return _mm256_sub_ps(a, b);
+}
+
+static NCNN_FORCEINLINE __m256 fft_scale(const __m256& a, float s)
+{
+    return _mm256_mul_ps(a, _mm256_set1_ps(s));
+}
+
+static NCNN_FORCEINLINE __m256 fft_mul_neg_i(const __m256& a)
+{
+    __m256 _swap = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm256_xor_ps(_swap, _mm256_castsi256_ps(_mm256_setr_epi32(0, 0x80000000, 0, 0x80000000, 0, 0x80000000, 0, 0x80000000)));
+}
+
+static NCNN_FORCEINLINE __m256 fft_mul(const __m256& a, const float* w)
+{
+    __m256 _wr = _mm256_set1_ps(w[0]);
+    __m256 _wi = _mm256_setr_ps(-w[1], w[1], -w[1], w[1], -w[1], w[1], -w[1], w[1]);
+    __m256 _swap = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm256_add_ps(_mm256_mul_ps(a, _wr), _mm256_mul_ps(_swap, _wi));
+}
+#endif // __AVX__
+#endif // __SSE2__
+
+// x[q + s * (p + t * m)] -> y[q + s * (r * p + u)] with twiddle w^(p * u)
+template<typename T>
+static NCNN_FORCEINLINE void fft_butterfly2(const float* x, float* y, const float* tw, int m, int s)
+{
+    const T a0 = fft_load(x, T());
+    const T a1 = fft_load(x + s * m * 2, T());
+
+    fft_store(y, fft_add(a0, a1));
+    fft_store(y + s * 2, fft_mul(fft_sub(a0, a1), tw));
+}
+
+template<typename T>
+static NCNN_FORCEINLINE void fft_butterfly3(const float* x, float* y, const float* tw, int m, int s)
+{
+    const float sin_pi_3 = 0.866025403784438647f;
+
+    const T a0 = fft_load(x, T());
+    const T a1 = fft_load(x + s * m * 2, T());
+    const T a2 = fft_load(x + s * m * 4, T());
+
+    const T t0 = fft_add(a1, a2);
+    const T t1 = fft_sub(a0, fft_scale(t0, 0.5f));
+    const T t2 = fft_mul_neg_i(fft_scale(fft_sub(a1, a2), sin_pi_3));
+
+    fft_store(y, fft_add(a0, t0));
+    fft_store(y + s * 2, fft_mul(fft_add(t1, t2), tw));
+    fft_store(y + s * 4, fft_mul(fft_sub(t1, t2), tw + 2));
+}
+
+template<typename T>
+static NCNN_FORCEINLINE void fft_butterfly4(const float* x, float* y, const float* tw, int m, int s)
+{
+    const T a0 = fft_load(x, T());
+    const T a1 = fft_load(x + s * m * 2, T());
+    const T a2 = fft_load(x + s * m * 4, T());
+    const T a3 = fft_load(x + s * m * 6, T());
+
+    const T t0 = fft_add(a0, a2);
+    const T t1 = fft_sub(a0, a2);
+    const T t2 = fft_add(a1, a3);
+    const T t3 = fft_mul_neg_i(fft_sub(a1, a3));
+
+    fft_store(y, fft_add(t0, t2));
+    fft_store(y + s * 2, fft_mul(fft_add(t1, t3), tw));
+    fft_store(y + s * 4, fft_mul(fft_sub(t0, t2), tw + 2));
+    fft_store(y + s * 6, fft_mul(fft_sub(t1, t3), tw + 4));
+}
+
+template<typename T>
+static NCNN_FORCEINLINE void fft_butterfly5(const float* x, float* y, const float* tw, int m, int s)
+{
+    const float c1 = 0.309016994374947424f;  // cos(2pi/5)
+    const float c2 = -0.809016994374947424f; // cos(4pi/5)
+    const float s1 = 0.951056516295153572f;  // sin(2pi/5)
+    const float s2 = 0.587785252292473129f;  // sin(4pi/5)
+
+    const T a0 = fft_load(x, T());
+    const T a1 = fft_load(x + s * m * 2, T());
+    const T a2 = fft_load(x + s * m * 4, T());
+    const T a3 = fft_load(x + s * m * 6, T());
+    const T a4 = fft_load(x + s * m * 8, T());
+
+    const T t1 = fft_add(a1, a4);
+    const T t2 = fft_add(a2, a3);
+    const T t3 = fft_sub(a1, a4);
+    const T t4 = fft_sub(a2, a3);
+
+    const T b1 = fft_add(a0, fft_add(fft_scale(t1, c1), fft_scale(t2, c2)));
+    const T b2 = fft_add(a0, fft_add(fft_scale(t1, c2), fft_scale(t2, c1)));
+    const T d1 = fft_mul_neg_i(fft_add(fft_scale(t3, s1), fft_scale(t4, s2)));
+    const T d2 = fft_mul_neg_i(fft_sub(fft_scale(t3, s2), fft_scale(t4, s1)));
+
+    fft_store(y, fft_add(a0, fft_add(t1, t2)));
+    fft_store(y + s * 2, fft_mul(fft_add(b1, d1), tw));
+    fft_store(y + s * 4, fft_mul(fft_add(b2, d2), tw + 2));
+    fft_store(y + s * 6, fft_mul(fft_sub(b2, d2), tw + 4));
+    fft_store(y + s * 8, fft_mul(fft_sub(b1, d1), tw + 6));
+}
+
+template<int r>
+static NCNN_FORCEINLINE void fft_butterfly_any(const float* x, float* y, const float* tw, int m, int s)
+{
+    if (r == 2) fft_butterfly2<fft_cpx>(x, y, tw, m, s);
+    if (r == 3) fft_butterfly3<fft_cpx>(x, y, tw, m, s);
+    if (r == 4) fft_butterfly4<fft_cpx>(x, y, tw, m, s);
+    if (r == 5) fft_butterfly5<fft_cpx>(x, y, tw, m, s);
+}
+
+template<int r>
+static void fft_stage(const float* x, float* y, const float* tw, int m, int s)
+{
+    for (int p = 0; p < m; p++)
+    {
+        const float* x0 = x + p * s * 2;
+        float* y0 = y + p * r * s * 2;
+        const float* tw0 = tw + p * (r - 1) * 2;
+
+        int q = 0;
+#if __SSE2__
+#if __AVX__
+        for (; q + 3 < s; q += 4)
+        {
+            if (r == 2) fft_butterfly2<__m256>(x0 + q * 2, y0 + q * 2, tw0, m, s);
+            if (r == 3) fft_butterfly3<__m256>(x0 + q * 2, y0 + q * 2, tw0, m, s);
+            if (r == 4) fft_butterfly4<__m256>(x0 + q * 2, y0 + q * 2, tw0, m, s);
+            if (r == 5) fft_butterfly5<__m256>(x0 + q * 2, y0 + q * 2, tw0, m, s);
+        }
+#endif // __AVX__
+        for (; q + 1 < s; q += 2)
+        {
+            if (r == 2) fft_butterfly2<__m128>(x0 + q * 2, y0 + q * 2, tw0, m, s);
+            if (r == 3) fft_butterfly3<__m128>(x0 + q * 2, y0 + q * 2, tw0, m, s);
+            if (r == 4) fft_butterfly4<__m128>(x0 + q * 2, y0 + q * 2, tw0, m, s);
+            if (r == 5) fft_butterfly5<__m128>(x0 + q * 2, y0 + q * 2, tw0, m, s);
+        }
+#endif // __SSE2__
+        for (; q < s; q++)
+        {
+            fft_butterfly_any<r>(x0 + q * 2, y0 + q * 2, tw0, m, s);
+        }
+    }
+}
+
+// direct dft of radix r over the roots of the whole transform
+static void fft_stage_generic(const float* x, float* y, const float* tw, const float* roots, int n, int r, int m, int s)
+{
+    const int root_step = n / r;
+
+    for (int p = 0; p < m; p++)
+    {
+        const float* tw0 = tw + p * (r - 1) * 2;
+
+        for (int q = 0; q < s; q++)
+        {
+            const float* x0 = x + (q + s * p) * 2;
+            float* y0 = y + (q + s * r * p) * 2;
+
+            for (int u = 0; u < r; u++)
+            {
+                float re = 0.f;
+                float im = 0.f;
+                for (int t = 0; t < r; t++)
+                {
+                    const float* a = x0 + s * m * t * 2;
+                    const float* w = roots + (t * u % r) * root_step * 2;
+                    re += a[0] * w[0] - a[1] * w[1];
+                    im += a[0] * w[1] + a[1] * w[0];
+                }
+
+                if (u == 0)
+                {
+                    y0[0] = re;
+                    y0[1] = im;
+                }
+                else
+                {
+                    const float* w = tw0 + (u - 1) * 2;
+                    y0[u * s * 2] = re * w[0] - im * w[1];
+                    y0[u * s * 2 + 1] = re * w[1] + im * w[0];
+                }
+            }
+        }
+    }
+}
+
+// radices and twiddles for every stage, roots are exp(-2pi i k / n)
+static void fft_make_plan(int n, std::vector<int>& radices, ncnn::Mat& roots, ncnn::Mat& twiddles)
+{
+    radices.clear();
+    {
+        int v = n;
+        while (v % 4 == 0)
+        {
+            radices.push_back(4);
+            v /= 4;
+        }
+        while (v % 2 == 0)
+        {
+            radices.push_back(2);
+            v /= 2;
+        }
+        for (int f = 3; v > 1; f += 2)
+        {
+            while (v % f == 0)
+            {
+                radices.push_back(f);
+                v /= f;
+            }
+        }
+    }
+
+    roots.create(2, n);
+    for (int k = 0; k < n; k++)
+    {
+        const double angle = -2 * 3.14159265358979323846 * k / n;
+        roots.row(k)[0] = (float)cos(angle);
+        roots.row(k)[1] = (float)sin(angle);
+    }
+
+    int twiddles_size = 0;
+    {
+        int n_cur = n;
+        for (size_t i = 0; i < radices.size(); i++)
+        {
+            const int m = n_cur / radices[i];
+            twiddles_size += m * (radices[i] - 1);
+            n_cur = m;
+        }
+    }
+
+    twiddles.create(2, std::max(twiddles_size, 1));
+    {
+        float* ptr = twiddles;
+
+        int n_cur = n;
+        for (size_t i = 0; i < radices.size(); i++)
+        {
+            const int r = radices[i];
+            const int m = n_cur / r;
+            for (int p = 0; p < m; p++)
+            {
+                for (int u = 1; u < r; u++)
+                {
+                    const float* w = roots.row(p * u * (n / n_cur));
+                    ptr[0] = w[0];
+                    ptr[1] = w[1];
+                    ptr += 2;
+                }
+            }
+            n_cur = m;
+        }
+    }
+}
+
+// forward transform of x, buf has the same size and the result is returned in one of them
+static float* fft_forward(float* x, float* buf, int n, const std::vector<int>& radices, const ncnn::Mat& roots, const ncnn::Mat& twiddles)
+{
+    const float* tw = twiddles;
+
+    int n_cur = n;
+    int s = 1;
+    for (size_t i = 0; i < radices.size(); i++)
+    {
+        const int r = radices[i];
+        const int m = n_cur / r;
+
+        if (r == 4)
+            fft_stage<4>(x, buf, tw, m, s);
+        else if (r == 2)
+            fft_stage<2>(x, buf, tw, m, s);
+        else if (r == 3)
+            fft_stage<3>(x, buf, tw, m, s);
+        else if (r == 5)
+            fft_stage<5>(x, buf, tw, m, s);
+        else
+            fft_stage_generic(x, buf, tw, roots, n, r, m, s);
+
+        std::swap(x, buf);
+
+        tw += m * (r - 1) * 2;
+        s *= r;
+        n_cur = m;
+    }
+
+    return x;
+}
+
+#endif // X86_FFT_H
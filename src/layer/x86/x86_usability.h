@@ -1821,7 +1821,87 @@ static NCNN_FORCEINLINE __m512i float2bfloat_avx512(const __m512& v0, const __m5
 
 #endif // __AVX512F__
 #endif // __AVX2__
+
+#if __F16C__
+// widen a contiguous run of fp16 values, used for packed weight tiles kept in half precision
+static NCNN_FORCEINLINE void cast_fp16_to_fp32_f16c(const unsigned short* ptr, float* outptr, int size)
+{
+    int i = 0;
+#if __AVX512F__
+    for (; i + 15 < size; i += 16)
+    {
+        _mm512_storeu_ps(outptr, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)ptr)));
+        ptr += 16;
+        outptr += 16;
+    }
+#endif // __AVX512F__
+    for (; i + 7 < size; i += 8)
+    {
+        _mm256_storeu_ps(outptr, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)ptr)));
+        ptr += 8;
+        outptr += 8;
+    }
+    for (; i + 3 < size; i += 4)
+    {
+        _mm_storeu_ps(outptr, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)ptr)));
+        ptr += 4;
+        outptr += 4;
+    }
+    for (; i < size; i++)
+    {
+        *outptr++ = ncnn::float16_to_float32(*ptr++);
+    }
+}
+#endif // __F16C__
+
 #endif // __AVX__
+
+// widen a contiguous run of bf16 values, used for packed weight tiles kept in bfloat16
+static NCNN_FORCEINLINE void cast_bf16_to_fp32_sse(const unsigned short* ptr, float* outptr, int size)
+{
+    int i = 0;
+#if __AVX__
+#if __AVX512F__
+    for (; i + 15 < size; i += 16)
+    {
+        _mm512_storeu_ps(outptr, bfloat2float_avx512(_mm256_loadu_si256((const __m256i*)ptr)));
+        ptr += 16;
+        outptr += 16;
+    }
+#endif // __AVX512F__
+    for (; i + 7 < size; i += 8)
+    {
+        _mm256_storeu_ps(outptr, bfloat2float_avx(_mm_loadu_si128((const __m128i*)ptr)));
+        ptr += 8;
+        outptr += 8;
+    }
+#endif // __AVX__
+    for (; i + 3 < size; i += 4)
+    {
+        _mm_storeu_ps(outptr, bfloat2float_sse(_mm_loadl_epi64((const __m128i*)ptr)));
+        ptr += 4;
+        outptr += 4;
+    }
+    for (; i < size; i++)
+    {
+        *outptr++ = ncnn::bfloat16_to_float32(*ptr++);
+    }
+}
+
+// widen a packed weight tile kept in 16 bits, bf16 or fp16 as chosen in create_pipeline
+static NCNN_FORCEINLINE void cast_packed_weight_to_fp32(const unsigned short* ptr, float* outptr, int size, bool bf16)
+{
+#if __F16C__
+    if (!bf16)
+    {
+        cast_fp16_to_fp32_f16c(ptr, outptr, size);
+        return;
+    }
+#else
+    (void)bf16;
+#endif // __F16C__
+    cast_bf16_to_fp32_sse(ptr, outptr, size);
+}
 #endif // __SSE2__
 
 #endif // X86_USABILITY_H
@@ -0,0 +1,205 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef X86_WEIGHT_QUANT_H
+#define X86_WEIGHT_QUANT_H
+
+#include "mat.h"
+#include "weight_quant.h"
+#include "x86_usability.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif
+#endif // __SSE2__
+
+#if __SSE2__
+// sign extend 4 int8 to float
+static NCNN_FORCEINLINE __m128 weight_quant_cvt_int8_sse(__m128i _v)
+{
+    _v = _mm_unpacklo_epi8(_v, _v);
+    _v = _mm_unpacklo_epi16(_v, _v);
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_v, 24));
+}
+
+// 8 bytes of int4 to 16 int8 in order
+static NCNN_FORCEINLINE __m128i weight_quant_unpack_int4_sse(const unsigned char* ptr)
+{
+    const __m128i _mask = _mm_set1_epi8(15);
+    __m128i _b = _mm_loadl_epi64((const __m128i*)ptr);
+    __m128i _lo = _mm_and_si128(_b, _mask);
+    __m128i _hi = _mm_and_si128(_mm_srli_epi16(_b, 4), _mask);
+    return _mm_sub_epi8(_mm_unpacklo_epi8(_lo, _hi), _mm_set1_epi8(8));
+}
+#endif // __SSE2__
+
+// dequantize values [k, k + n) of one weight-only quantized row into outptr
+static inline void dequantize_weight_quant_row_x86(const unsigned char* ptr, const float* scales, int k, int n, int bits, int group_size, float* outptr)
+{
+    const int k_end = k + n;
+
+    int x = k;
+    while (x < k_end)
+    {
+        const int g = group_size == 0 ? 0 : x / group_size;
+        const int seg_end = group_size == 0 ? k_end : std::min(k_end, (g + 1) * group_size);
+        const float descale = scales[g] == 0.f ? 0.f : 1.f / scales[g];
+
+        float* pp = outptr + (x - k);
+
+        if (bits == 8)
+        {
+#if __SSE2__
+#if __AVX2__
+            __m256 _descale_avx = _mm256_set1_ps(descale);
+            for (; x + 7 < seg_end; x += 8)
+            {
+                __m256 _v = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(ptr + x))));
+                _mm256_storeu_ps(pp, _mm256_mul_ps(_v, _descale_avx));
+                pp += 8;
+            }
+#endif // __AVX2__
+            __m128 _descale = _mm_set1_ps(descale);
+            for (; x + 3 < seg_end; x += 4)
+            {
+                int v4;
+                memcpy(&v4, ptr + x, 4);
+                __m128 _v = weight_quant_cvt_int8_sse(_mm_cvtsi32_si128(v4));
+                _mm_storeu_ps(pp, _mm_mul_ps(_v, _descale));
+                pp += 4;
+            }
+#endif // __SSE2__
+        }
+        else
+        {
+            if (x % 2 == 1 && x < seg_end)
+            {
+                *pp++ = weight_quant_value(ptr, x, bits) * descale;
+                x++;
+            }
+#if __SSE2__
+            for (; x + 15 < seg_end; x += 16)
+            {
+                __m128i _v = weight_quant_unpack_int4_sse(ptr + x / 2);
+#if __AVX2__
+                __m256 _descale_avx = _mm256_set1_ps(descale);
+                __m256 _v0 = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_v));
+                __m256 _v1 = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(_v, 8)));
+                _mm256_storeu_ps(pp, _mm256_mul_ps(_v0, _descale_avx));
+                _mm256_storeu_ps(pp + 8, _mm256_mul_ps(_v1, _descale_avx));
+#else
+                __m128 _descale = _mm_set1_ps(descale);
+                _mm_storeu_ps(pp, _mm_mul_ps(weight_quant_cvt_int8_sse(_v), _descale));
+                _mm_storeu_ps(pp + 4, _mm_mul_ps(weight_quant_cvt_int8_sse(_mm_srli_si128(_v, 4)), _descale));
+                _mm_storeu_ps(pp + 8, _mm_mul_ps(weight_quant_cvt_int8_sse(_mm_srli_si128(_v, 8)), _descale));
+                _mm_storeu_ps(pp + 12, _mm_mul_ps(weight_quant_cvt_int8_sse(_mm_srli_si128(_v, 12)), _descale));
+#endif // __AVX2__
+                pp += 16;
+            }
+#endif // __SSE2__
+        }
+        for (; x < seg_end; x++)
+        {
+            *pp++ = weight_quant_value(ptr, x, bits) * descale;
+        }
+    }
+}
+
+// dot product of K float32 values with one weight-only quantized row
+static inline float dot_weight_quant_row_x86(const float* xptr, const unsigned char* ptr, const float* scales, int K, int bits, int group_size)
+{
+    float sum = 0.f;
+#if __SSE2__
+#if __AVX2__
+    __m256 _sum_avx = _mm256_setzero_ps();
+#endif
+    __m128 _sum = _mm_setzero_ps();
+#endif // __SSE2__
+
+    int x = 0;
+    while (x < K)
+    {
+        const int g = group_size == 0 ? 0 : x / group_size;
+        const int seg_end = group_size == 0 ? K : std::min(K, (g + 1) * group_size);
+        const float descale = scales[g] == 0.f ? 0.f : 1.f / scales[g];
+
+        float sum_seg = 0.f;
+#if __SSE2__
+#if __AVX2__
+        __m256 _sum_seg_avx = _mm256_setzero_ps();
+#endif
+        __m128 _sum_seg = _mm_setzero_ps();
+#endif // __SSE2__
+
+        if (bits == 8)
+        {
+#if __SSE2__
+#if __AVX2__
+            for (; x + 7 < seg_end; x += 8)
+            {
+                __m256 _v = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(ptr + x))));
+                _sum_seg_avx = _mm256_comp_fmadd_ps(_mm256_loadu_ps(xptr + x), _v, _sum_seg_avx);
+            }
+#endif // __AVX2__
+            for (; x + 3 < seg_end; x += 4)
+            {
+                int v4;
+                memcpy(&v4, ptr + x, 4);
+                __m128 _v = weight_quant_cvt_int8_sse(_mm_cvtsi32_si128(v4));
+                _sum_seg = _mm_comp_fmadd_ps(_mm_loadu_ps(xptr + x), _v, _sum_seg);
+            }
+#endif // __SSE2__
+        }
+        else
+        {
+            if (x % 2 == 1 && x < seg_end)
+            {
+                sum_seg += xptr[x] * weight_quant_value(ptr, x, bits);
+                x++;
+            }
+#if __SSE2__
+            for (; x + 15 < seg_end; x += 16)
+            {
+                __m128i _v = weight_quant_unpack_int4_sse(ptr + x / 2);
+#if __AVX2__
+                __m256 _v0 = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_v));
+                __m256 _v1 = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(_v, 8)));
+                _sum_seg_avx = _mm256_comp_fmadd_ps(_mm256_loadu_ps(xptr + x), _v0, _sum_seg_avx);
+                _sum_seg_avx = _mm256_comp_fmadd_ps(_mm256_loadu_ps(xptr + x + 8), _v1, _sum_seg_avx);
+#else
+                _sum_seg = _mm_comp_fmadd_ps(_mm_loadu_ps(xptr + x), weight_quant_cvt_int8_sse(_v), _sum_seg);
+                _sum_seg = _mm_comp_fmadd_ps(_mm_loadu_ps(xptr + x + 4), weight_quant_cvt_int8_sse(_mm_srli_si128(_v, 4)), _sum_seg);
+                _sum_seg = _mm_comp_fmadd_ps(_mm_loadu_ps(xptr + x + 8), weight_quant_cvt_int8_sse(_mm_srli_si128(_v, 8)), _sum_seg);
+                _sum_seg = _mm_comp_fmadd_ps(_mm_loadu_ps(xptr + x + 12), weight_quant_cvt_int8_sse(_mm_srli_si128(_v, 12)), _sum_seg);
+#endif // __AVX2__
+            }
+#endif // __SSE2__
+        }
+        for (; x < seg_end; x++)
+        {
+            sum_seg += xptr[x] * weight_quant_value(ptr, x, bits);
+        }
+
+        // apply the group scale once for the whole segment
+#if __SSE2__
+#if __AVX2__
+        _sum_avx = _mm256_comp_fmadd_ps(_sum_seg_avx, _mm256_set1_ps(descale), _sum_avx);
+#endif
+        _sum = _mm_comp_fmadd_ps(_sum_seg, _mm_set1_ps(descale), _sum);
+#endif // __SSE2__
+        sum += sum_seg * descale;
+    }
+
+#if __SSE2__
+#if __AVX2__
+    sum += _mm256_reduce_add_ps(_sum_avx);
+#endif
+    sum += _mm_reduce_add_ps(_sum);
+#endif // __SSE2__
+
+    return sum;
+}
+
+#endif // X86_WEIGHT_QUANT_H
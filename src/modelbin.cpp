@@ -183,6 +183,41 @@ Mat ModelBinFromDataReader::load(int w, int type) const
 
             return m;
         }
+        else if (flag_struct.tag == 0x000D4B34)
+        {
+            // int4 data, two values per byte
+            const int nbytes = (w + 1) / 2;
+            size_t align_data_size = alignSize(nbytes, 4);
+
+#if !__BIG_ENDIAN__
+            // try reference data
+            const void* refbuf = 0;
+            nread = d->dr.reference(align_data_size, &refbuf);
+            if (nread == align_data_size)
+            {
+                m = Mat(nbytes, (void*)refbuf, (size_t)1u);
+            }
+            else
+#endif
+            {
+                std::vector<unsigned char> int4_weights;
+                int4_weights.resize(align_data_size);
+                nread = d->dr.read(&int4_weights[0], align_data_size);
+                if (nread != align_data_size)
+                {
+                    NCNN_LOGE("ModelBin read int4_weights failed %zd", nread);
+                    return Mat();
+                }
+
+                m.create(nbytes, (size_t)1u);
+                if (m.empty())
+                    return m;
+
+                memcpy(m.data, &int4_weights[0], nbytes);
+            }
+
+            return m;
+        }
         else if (flag_struct.tag == 0x0002C056)
         {
 #if !__BIG_ENDIAN__
@@ -8,14 +8,13 @@
 #include "layer_type.h"
 #include "modelbin.h"
 #include "paramdict.h"
+#include "profiler.h"
 
 #include <stdarg.h>
 #include <stdint.h>
 #include <string.h>
 
-#if NCNN_BENCHMARK
 #include "benchmark.h"
-#endif // NCNN_BENCHMARK
 
 #if NCNN_VULKAN
 #include "command.h"
@@ -24,440 +23,2283 @@
 
 namespace ncnn {
 
-class NetPrivate
+// allocations of one extract call packed into a single arena by lifetime
+class MemoryPlan
 {
 public:
-    NetPrivate(Option& _opt);
-
-    Option& opt;
-
-#if NCNN_VULKAN
+    // requested blob index and the shapes of the blobs present before forward
+    std::vector<int> signature;
 
-    int upload_model();
-
-#endif // NCNN_VULKAN
-
-    friend class Extractor;
-    int forward_layer(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const;
+    // arena offset and size of each allocation in request order
+    std::vector<size_t> offsets;
+    std::vector<size_t> sizes;
 
-#if NCNN_VULKAN
-    int forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const;
-#endif // NCNN_VULKAN
+    size_t arena_size;
 
-    int convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt) const;
+    // allocations in the order they were freed, and the rank of each allocation in it
+    std::vector<int> free_order;
+    std::vector<int> free_ranks;
 
-    int do_forward_layer(const Layer* layer, std::vector<Mat>& blob_mats, const Option& opt) const;
-#if NCNN_VULKAN
-    int do_forward_layer(const Layer* layer, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const;
-#endif // NCNN_VULKAN
+    // count of allocations freed before each allocation was requested
+    // the replay slot is only safe when all of them are released again
+    std::vector<int> required_free_counts;
 
-    void update_input_output_indexes();
-#if NCNN_STRING
-    void update_input_output_names();
-#endif // NCNN_STRING
+    // sorted distinct offsets, and the index of the offset of each allocation in it
+    std::vector<size_t> distinct_offsets;
+    std::vector<int> offset_indexes;
+};
 
-    std::vector<Blob> blobs;
-    std::vector<Layer*> layers;
+// flat forward order compiled for one requested layer and one set of present blobs
+class ExecutionPlan
+{
+public:
+    // hash of the requested layer and the present blobs, compared before the blob list
+    size_t hash;
+    int layer_index;
+    std::vector<int> present_blob_indexes;
 
-    std::vector<int> input_blob_indexes;
-    std::vector<int> output_blob_indexes;
-#if NCNN_STRING
-    std::vector<const char*> input_blob_names;
-    std::vector<const char*> output_blob_names;
-#endif // NCNN_STRING
+    // layers in forward order
+    std::vector<int> layer_indexes;
 
-    std::vector<custom_layer_registry_entry> custom_layer_registry;
-    std::vector<overwrite_builtin_layer_registry_entry> overwrite_builtin_layer_registry;
+    // bottom blobs still consumed by later layers, kept alive across light mode release
+    std::vector<std::vector<int> > retained_blob_indexes;
 
-    PoolAllocator* local_blob_allocator;
-    PoolAllocator* local_workspace_allocator;
+    // whether the layer may cast or pack its bottom blobs, decided from the layer flags
+    std::vector<char> layer_convert_layouts;
 
-#if NCNN_VULKAN
-    const VulkanDevice* vkdev;
+    // distinct featmasks of the layers and the index of each layer in them, -1 for no featmask
+    std::vector<int> featmasks;
+    std::vector<int> layer_featmask_indexes;
+};
 
-    VkAllocator* weight_vkallocator;
-    VkAllocator* weight_staging_vkallocator;
+// how a layer carries state from one chunk of a stream to the next
+class StreamLayerInfo
+{
+public:
+    StreamLayerInfo()
+        : type(0), state_count(0), kernel_extent(1), stride(1), pad_left(0)
+    {
+    }
 
-    PipelineCache* pipeline_cache;
-#endif // NCNN_VULKAN
+    // 0 = stateless across time
+    // 1 = recurrent, state_count hidden state blobs are passed to the next chunk
+    // 2 = window along w, trailing input frames are kept as left context of the next chunk
+    // 3 = attention, cached keys and values of the past chunks are passed to the next chunk
+    // -1 = recurrent or window layer that can not be streamed
+    int type;
+    int state_count;
+
+    // window geometry for type 2
+    int kernel_extent;
+    int stride;
+    int pad_left;
 };
 
-NetPrivate::NetPrivate(Option& _opt)
-    : opt(_opt)
+// state of one layer in the stream of an extractor
+class StreamLayerState
 {
-    local_blob_allocator = 0;
-    local_workspace_allocator = 0;
+public:
+    StreamLayerState()
+        : context_start(0), output_count(0)
+    {
+    }
 
-#if NCNN_VULKAN
-    vkdev = 0;
-    weight_vkallocator = 0;
-    weight_staging_vkallocator = 0;
-    pipeline_cache = 0;
-#endif // NCNN_VULKAN
-}
+    // hidden states from the last chunk
+    std::vector<Mat> states;
 
-static Option get_masked_option(const Option& opt, int featmask)
-{
-    // mask option usage as layer specific featmask
-    Option opt1 = opt;
-    opt1.use_fp16_arithmetic = opt1.use_fp16_arithmetic && !(featmask & (1 << 0));
-    opt1.use_fp16_storage = opt1.use_fp16_storage && !(featmask & (1 << 1));
-    opt1.use_fp16_packed = opt1.use_fp16_packed && !(featmask & (1 << 1));
-    opt1.use_bf16_storage = opt1.use_bf16_storage && !(featmask & (1 << 2));
-    opt1.use_int8_packed = opt1.use_int8_packed && !(featmask & (1 << 3));
-    opt1.use_int8_storage = opt1.use_int8_storage && !(featmask & (1 << 3));
-    opt1.use_int8_arithmetic = opt1.use_int8_arithmetic && !(featmask & (1 << 3));
-    opt1.use_vulkan_compute = opt1.use_vulkan_compute && !(featmask & (1 << 4));
-    opt1.use_tensor_storage = opt1.use_tensor_storage && !(featmask & (1 << 4));
-    opt1.use_sgemm_convolution = opt1.use_sgemm_convolution && !(featmask & (1 << 5));
-    opt1.use_winograd_convolution = opt1.use_winograd_convolution && !(featmask & (1 << 6));
+    // trailing input frames in the layout the layer consumes
+    Mat context;
 
-    if (featmask & (1 << 7))
-        opt1.num_threads = 1;
+    // stream frame index of the first context frame
+    int context_start;
 
-    return opt1;
-}
+    // output frames produced so far
+    int output_count;
+};
 
-#if NCNN_VULKAN
-int NetPrivate::upload_model()
+// open addressing table from live pointers to T, for the payouts of an allocator
+template<typename T>
+class PointerTable
 {
-    ncnn::VkTransfer cmd(vkdev);
-
-    // create gpu device allocator if null
-    if (!weight_vkallocator)
+public:
+    PointerTable()
+        : count(0), used(0)
     {
-        weight_vkallocator = new VkWeightAllocator(vkdev);
     }
-    if (!weight_staging_vkallocator)
+
+    bool empty() const
     {
-        weight_staging_vkallocator = new VkWeightStagingAllocator(vkdev);
+        return count == 0;
     }
 
-    Option opt_upload = opt;
-    opt_upload.blob_allocator = 0;
-    opt_upload.workspace_allocator = 0;
-    opt_upload.blob_vkallocator = weight_vkallocator;
-    opt_upload.workspace_vkallocator = weight_vkallocator;
-    opt_upload.staging_vkallocator = weight_staging_vkallocator;
+    void clear()
+    {
+        slots.clear();
+        count = 0;
+        used = 0;
+    }
 
-    for (size_t i = 0; i < layers.size(); i++)
+    // ptr must not be in the table
+    void insert(void* ptr, const T& value)
     {
-        if (layers[i]->support_vulkan)
+        if ((used + 1) * 2 > slots.size())
         {
-            int uret = layers[i]->upload_model(cmd, get_masked_option(opt_upload, layers[i]->featmask));
-            if (uret != 0)
-            {
-                NCNN_LOGE("layer upload_model %d failed", (int)i);
-                return -1;
-            }
+            size_t capacity = 16;
+            while (capacity < (count + 1) * 4)
+                capacity *= 2;
+
+            rehash(capacity);
         }
-    }
 
-    return cmd.submit_and_wait();
-}
-#endif // NCNN_VULKAN
+        size_t i = hash(ptr) & (slots.size() - 1);
+        while (slots[i].first && slots[i].first != tombstone())
+            i = (i + 1) & (slots.size() - 1);
 
-int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const
-{
-    const Layer* layer = layers[layer_index];
+        if (!slots[i].first)
+            used++;
 
-    //     NCNN_LOGE("forward_layer %d %s", layer_index, layer->name.c_str());
+        slots[i].first = ptr;
+        slots[i].second = value;
+        count++;
+    }
 
-    // load bottom blobs
-    for (size_t i = 0; i < layer->bottoms.size(); i++)
+    // remove ptr and return its value, false if not found
+    bool take(void* ptr, T& value)
     {
-        int bottom_blob_index = layer->bottoms[i];
+        if (slots.empty())
+            return false;
 
-        if (blob_mats[bottom_blob_index].dims == 0)
+        size_t i = hash(ptr) & (slots.size() - 1);
+        while (slots[i].first)
         {
-            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, opt);
-            if (ret != 0)
-                return ret;
+            if (slots[i].first == ptr)
+            {
+                value = slots[i].second;
+                slots[i].first = tombstone();
+                count--;
+                return true;
+            }
+
+            i = (i + 1) & (slots.size() - 1);
         }
+
+        return false;
     }
 
-#if NCNN_BENCHMARK
-    double start = get_current_time();
-    Mat bottom_blob;
-    if (layer->one_blob_only)
+private:
+    static void* tombstone()
     {
-        int bottom_blob_index = layer->bottoms[0];
-        bottom_blob.dims = blob_mats[bottom_blob_index].dims;
-        bottom_blob.w = blob_mats[bottom_blob_index].w;
-        bottom_blob.h = blob_mats[bottom_blob_index].h;
-        bottom_blob.d = blob_mats[bottom_blob_index].d;
-        bottom_blob.c = blob_mats[bottom_blob_index].c;
-        bottom_blob.elempack = blob_mats[bottom_blob_index].elempack;
-        bottom_blob.elemsize = blob_mats[bottom_blob_index].elemsize;
+        return (void*)1;
     }
-#endif
-    int ret = 0;
-    if (layer->featmask)
+
+    static size_t hash(const void* ptr)
     {
-        ret = do_forward_layer(layer, blob_mats, get_masked_option(opt, layer->featmask));
+        uint64_t x = (uint64_t)(size_t)ptr;
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return (size_t)x;
     }
-    else
+
+    void rehash(size_t capacity)
     {
-        ret = do_forward_layer(layer, blob_mats, opt);
+        std::vector<std::pair<void*, T> > old_slots(capacity, std::make_pair((void*)0, T()));
+        std::swap(slots, old_slots);
+        count = 0;
+        used = 0;
+
+        for (size_t i = 0; i < old_slots.size(); i++)
+        {
+            if (old_slots[i].first && old_slots[i].first != tombstone())
+                insert(old_slots[i].first, old_slots[i].second);
+        }
     }
-#if NCNN_BENCHMARK
-    double end = get_current_time();
-    if (layer->one_blob_only)
+
+    // null for empty, tombstone for removed
+    std::vector<std::pair<void*, T> > slots;
+    size_t count;
+    size_t used;
+};
+
+// blob and workspace allocator of an extractor when use_memory_planner enabled
+// the first run records the allocation lifetimes, later runs hand out arena views
+class MemoryPlanAllocator : public Allocator
+{
+public:
+    MemoryPlanAllocator();
+    ~MemoryPlanAllocator();
+
+    // record allocations of the coming forward
+    void begin_record(Allocator* allocator);
+
+    // serve allocations of the coming forward from an arena laid out by plan
+    // an arena no longer referenced by any blob is reused
+    int begin_replay(const MemoryPlan* plan, Allocator* allocator);
+
+    // finish the forward, return false if the record or replay is unusable
+    bool end(MemoryPlan* plan);
+
+    // release all arenas, blobs allocated here must be released before
+    void clear();
+
+    virtual void* fastMalloc(size_t size);
+    virtual void fastFree(void* ptr);
+
+protected:
+    void* fallback_malloc(size_t size, Allocator* a);
+    bool fallback_free(void* ptr);
+
+    Mutex lock;
+
+    // 0 = pass through, 1 = record, 2 = replay
+    int mode;
+    Allocator* allocator;
+
+    // memory not coming from arenas with the allocator it belongs to
+    PointerTable<Allocator*> fallback_payouts;
+
+    // record
+    int clock;
+    std::vector<size_t> record_sizes;
+    std::vector<int> record_starts;
+    std::vector<int> record_ends;
+
+    // record index of each allocation not yet freed
+    PointerTable<int> record_payouts;
+
+    // replay
+    const MemoryPlan* plan;
+    unsigned char* arena;
+    int arena_index;
+    int request_index;
+    int miss_count;
+
+    // 0 = not requested, 1 = served from arena, 2 = released or not in arena
+    std::vector<unsigned char> replay_states;
+
+    // allocation living at each distinct offset, -1 for none
+    std::vector<int> replay_offset_payouts;
+
+    // allocations in free_order before free_cursor must be released for the next request
+    int free_cursor;
+    int released_required_count;
+
+    std::vector<std::pair<unsigned char*, Allocator*> > arenas;
+    std::vector<size_t> arena_sizes;
+
+    // blobs still referencing each arena
+    std::vector<int> arena_payout_counts;
+};
+
+// binary search in sorted offsets, -1 if not found
+static int find_offset_index(const std::vector<size_t>& offsets, size_t offset)
+{
+    int lo = 0;
+    int hi = (int)offsets.size();
+    while (lo < hi)
     {
-        int top_blob_index = layer->tops[0];
-        benchmark(layer, bottom_blob, blob_mats[top_blob_index], start, end);
+        const int mid = (lo + hi) / 2;
+        if (offsets[mid] < offset)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
-    else
+
+    return lo < (int)offsets.size() && offsets[lo] == offset ? lo : -1;
+}
+
+MemoryPlanAllocator::MemoryPlanAllocator()
+{
+    mode = 0;
+    allocator = 0;
+    clock = 0;
+    plan = 0;
+    arena = 0;
+    arena_index = -1;
+    request_index = 0;
+    miss_count = 0;
+    free_cursor = 0;
+    released_required_count = 0;
+}
+
+MemoryPlanAllocator::~MemoryPlanAllocator()
+{
+    clear();
+}
+
+void MemoryPlanAllocator::begin_record(Allocator* _allocator)
+{
+    MutexLockGuard g(lock);
+
+    mode = 1;
+    allocator = _allocator;
+    clock = 0;
+    record_sizes.clear();
+    record_starts.clear();
+    record_ends.clear();
+    record_payouts.clear();
+}
+
+int MemoryPlanAllocator::begin_replay(const MemoryPlan* _plan, Allocator* _allocator)
+{
+    MutexLockGuard g(lock);
+
+    mode = 0;
+    allocator = _allocator;
+
+    arena_index = -1;
+    for (size_t i = 0; i < arenas.size(); i++)
     {
-        benchmark(layer, start, end);
+        if (arena_payout_counts[i] == 0 && arenas[i].second == allocator && arena_sizes[i] >= _plan->arena_size)
+        {
+            arena_index = (int)i;
+            break;
+        }
     }
-#endif
-    if (ret != 0)
-        return ret;
 
-    //     NCNN_LOGE("forward_layer %d %s done", layer_index, layer->name.c_str());
-    //     const Mat& blob = blob_mats[layer->tops[0]];
-    //     NCNN_LOGE("[%-2d %-16s %-16s]  %d    blobs count = %-3d   size = %-3d x %-3d", layer_index, layer->type.c_str(), layer->name.c_str(), layer->tops[0], blob.c, blob.h, blob.w);
+    if (arena_index == -1)
+    {
+        unsigned char* ptr = allocator ? (unsigned char*)allocator->fastMalloc(_plan->arena_size) : (unsigned char*)ncnn::fastMalloc(_plan->arena_size);
+        if (!ptr)
+            return -100;
+
+        arena_index = (int)arenas.size();
+        arenas.push_back(std::make_pair(ptr, allocator));
+        arena_sizes.push_back(_plan->arena_size);
+        arena_payout_counts.push_back(0);
+    }
+
+    arena = arenas[arena_index].first;
+
+    mode = 2;
+    plan = _plan;
+    request_index = 0;
+    miss_count = 0;
+    replay_states.assign(plan->sizes.size(), 0);
+    replay_offset_payouts.assign(plan->distinct_offsets.size(), -1);
+    free_cursor = 0;
+    released_required_count = 0;
 
     return 0;
 }
 
-#if NCNN_VULKAN
-int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const
+bool MemoryPlanAllocator::end(MemoryPlan* _plan)
 {
-    const Layer* layer = layers[layer_index];
-
-    //     NCNN_LOGE("forward_layer %d %d %s", layer->support_vulkan, layer_index, layer->name.c_str());
+    MutexLockGuard g(lock);
 
-    bool cmd_submit_and_wait = false;
+    bool usable = true;
 
-    // load bottom blobs
-    for (size_t i = 0; i < layer->bottoms.size(); i++)
+    if (mode == 1)
     {
-        int bottom_blob_index = layer->bottoms[i];
+        const int count = (int)record_sizes.size();
 
-        if (blob_mats_gpu[bottom_blob_index].dims == 0 && blob_mats[bottom_blob_index].dims == 0)
+        // allocations kept after forward live until the arena is released
+        for (int i = 0; i < count; i++)
         {
-            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, blob_mats_gpu, cmd, opt);
-            if (ret != 0)
-                return ret;
+            if (record_ends[i] == -1)
+                record_ends[i] = clock;
         }
 
-        if (layer->support_vulkan)
+        // place the largest allocation first at the lowest offset
+        // not occupied by any placed allocation living at the same time
+        std::vector<std::pair<size_t, int> > size_order(count);
+        for (int i = 0; i < count; i++)
         {
-            if (blob_mats_gpu[bottom_blob_index].dims == 0)
-            {
-                // host to buffer
-                cmd.record_upload(blob_mats[bottom_blob_index], blob_mats_gpu[bottom_blob_index], opt);
+            size_order[i] = std::make_pair(record_sizes[i], -i);
+        }
+        std::partial_sort(size_order.begin(), size_order.end(), size_order.end(), std::greater<std::pair<size_t, int> >());
 
-                if (opt.lightmode)
+        _plan->offsets.resize(count);
+        _plan->sizes = record_sizes;
+        _plan->arena_size = 0;
+
+        std::vector<int> placed;
+        std::vector<std::pair<size_t, size_t> > occupied;
+        for (int i = 0; i < count; i++)
+        {
+            const int k = -size_order[i].second;
+            const size_t size = record_sizes[k];
+
+            occupied.clear();
+            for (size_t j = 0; j < placed.size(); j++)
+            {
+                const int q = placed[j];
+                if (record_starts[q] < record_ends[k] && record_starts[k] < record_ends[q])
                 {
-                    // delete after taken in light mode
-                    blob_mats[bottom_blob_index].release();
+                    occupied.push_back(std::make_pair(_plan->offsets[q], _plan->offsets[q] + record_sizes[q]));
                 }
             }
-        }
-        else
-        {
-            if (blob_mats[bottom_blob_index].dims == 0)
+            std::partial_sort(occupied.begin(), occupied.end(), occupied.end(), std::less<std::pair<size_t, size_t> >());
+
+            size_t offset = 0;
+            for (size_t j = 0; j < occupied.size(); j++)
             {
-                Option opt_download = opt;
-                opt_download.use_packing_layout = layer->support_packing;
+                if (occupied[j].first >= offset + size)
+                    break;
 
-                // buffer to host
-                cmd.record_download(blob_mats_gpu[bottom_blob_index], blob_mats[bottom_blob_index], opt_download);
+                offset = std::max(offset, occupied[j].second);
+            }
 
-                if (opt.lightmode)
-                {
-                    // delete after taken in light mode
-                    blob_mats_gpu[bottom_blob_index].release();
-                }
+            _plan->offsets[k] = offset;
+            _plan->arena_size = std::max(_plan->arena_size, offset + size);
 
-                cmd_submit_and_wait = true;
-            }
+            placed.push_back(k);
         }
-    }
 
-    int ret;
-    if (cmd_submit_and_wait)
-    {
-        ret = cmd.submit_and_wait();
+        std::vector<std::pair<int, int> > end_order(count);
+        for (int i = 0; i < count; i++)
+        {
+            end_order[i] = std::make_pair(record_ends[i], i);
+        }
+        std::partial_sort(end_order.begin(), end_order.end(), end_order.end(), std::less<std::pair<int, int> >());
 
-#if NCNN_BENCHMARK
-        std::vector<uint64_t> results(layer_index * 2);
-        cmd.get_query_pool_results(0, layer_index * 2, results);
-        for (int i = 0; i < layer_index; i++)
+        _plan->free_order.resize(count);
+        _plan->free_ranks.resize(count);
+        for (int i = 0; i < count; i++)
         {
-            uint64_t start = results[i * 2];
-            uint64_t end = results[i * 2 + 1];
-            if (start == 0 || end == 0)
-                continue;
+            _plan->free_order[i] = end_order[i].second;
+            _plan->free_ranks[end_order[i].second] = i;
+        }
 
-            double duration_us = (end - start) * vkdev->info.timestamp_period() / 1000;
-            NCNN_LOGE("%-24s %-30s %8.2lfus    |", layers[i]->type.c_str(), layers[i]->name.c_str(), duration_us);
+        // starts increase with the request index, so a cursor walks end_order once
+        _plan->required_free_counts.resize(count);
+        int cursor = 0;
+        for (int i = 0; i < count; i++)
+        {
+            while (cursor < count && end_order[cursor].first <= record_starts[i])
+                cursor++;
+
+            _plan->required_free_counts[i] = cursor;
         }
-#endif // NCNN_BENCHMARK
 
-        cmd.reset();
-        if (ret != 0)
-            return ret;
-    }
+        std::vector<size_t> sorted_offsets = _plan->offsets;
+        std::partial_sort(sorted_offsets.begin(), sorted_offsets.end(), sorted_offsets.end(), std::less<size_t>());
 
-    if (layer->support_vulkan)
-    {
-#if NCNN_BENCHMARK
-        cmd.record_write_timestamp(layer_index * 2);
-#endif
-        if (layer->featmask)
+        _plan->distinct_offsets.clear();
+        for (int i = 0; i < count; i++)
         {
-            ret = do_forward_layer(layer, blob_mats_gpu, cmd, get_masked_option(opt, layer->featmask));
+            if (_plan->distinct_offsets.empty() || _plan->distinct_offsets.back() != sorted_offsets[i])
+                _plan->distinct_offsets.push_back(sorted_offsets[i]);
         }
-        else
+
+        _plan->offset_indexes.resize(count);
+        for (int i = 0; i < count; i++)
         {
-            ret = do_forward_layer(layer, blob_mats_gpu, cmd, opt);
+            _plan->offset_indexes[i] = find_offset_index(_plan->distinct_offsets, _plan->offsets[i]);
         }
-#if NCNN_BENCHMARK
-        cmd.record_write_timestamp(layer_index * 2 + 1);
-#endif
+
+        usable = count > 0;
+    }
+
+    if (mode == 2)
+    {
+        // the forward did not follow the plan
+        usable = miss_count == 0 && request_index == (int)plan->sizes.size();
+    }
+
+    mode = 0;
+    plan = 0;
+    arena = 0;
+    arena_index = -1;
+    record_payouts.clear();
+    replay_states.clear();
+    replay_offset_payouts.clear();
+
+    return usable;
+}
+
+void MemoryPlanAllocator::clear()
+{
+    MutexLockGuard g(lock);
+
+    for (size_t i = 0; i < arenas.size(); i++)
+    {
+        if (arenas[i].second)
+            arenas[i].second->fastFree(arenas[i].first);
+        else
+            ncnn::fastFree(arenas[i].first);
+    }
+    arenas.clear();
+    arena_sizes.clear();
+    arena_payout_counts.clear();
+
+    if (!fallback_payouts.empty())
+    {
+        NCNN_LOGE("FATAL ERROR! memory plan allocator cleared too early");
     }
+}
+
+void* MemoryPlanAllocator::fallback_malloc(size_t size, Allocator* a)
+{
+    void* ptr = a ? a->fastMalloc(size) : ncnn::fastMalloc(size);
+    if (ptr)
+        fallback_payouts.insert(ptr, a);
+
+    return ptr;
+}
+
+bool MemoryPlanAllocator::fallback_free(void* ptr)
+{
+    Allocator* a = 0;
+    if (!fallback_payouts.take(ptr, a))
+        return false;
+
+    if (a)
+        a->fastFree(ptr);
     else
+        ncnn::fastFree(ptr);
+
+    return true;
+}
+
+void* MemoryPlanAllocator::fastMalloc(size_t size)
+{
+    MutexLockGuard g(lock);
+
+    size = alignSize(size, NCNN_MALLOC_ALIGN);
+
+    if (mode == 1)
     {
-#if NCNN_BENCHMARK
-        double start = get_current_time();
-        Mat bottom_blob;
-        if (layer->one_blob_only)
+        // recorded memory bypasses the pool allocator and goes back to the system when freed
+        // otherwise its budgets would stay in the pool next to the arena replacing them
+        void* ptr = fallback_malloc(size, 0);
+        if (ptr)
         {
-            int bottom_blob_index = layer->bottoms[0];
-            bottom_blob = blob_mats[bottom_blob_index].shape();
-        }
-#endif
-        if (layer->featmask)
-        {
-            ret = do_forward_layer(layer, blob_mats, get_masked_option(opt, layer->featmask));
+            record_payouts.insert(ptr, (int)record_sizes.size());
+            record_sizes.push_back(size);
+            record_starts.push_back(clock);
+            record_ends.push_back(-1);
+            clock++;
         }
-        else
+        return ptr;
+    }
+
+    if (mode == 2)
+    {
+        const int i = request_index++;
+        if (i < (int)plan->sizes.size())
         {
-            ret = do_forward_layer(layer, blob_mats, opt);
+            // the allocations freed before this one in the record may share its slot
+            // the slot is safe once all of them are released
+            const int required_free_count = plan->required_free_counts[i];
+            while (free_cursor < required_free_count)
+            {
+                if (replay_states[plan->free_order[free_cursor]] == 2)
+                    released_required_count++;
+
+                free_cursor++;
+            }
+
+            if (size <= plan->sizes[i] && released_required_count == required_free_count)
+            {
+                replay_states[i] = 1;
+                replay_offset_payouts[plan->offset_indexes[i]] = i;
+                arena_payout_counts[arena_index]++;
+                return arena + plan->offsets[i];
+            }
+
+            replay_states[i] = 2;
         }
-#if NCNN_BENCHMARK
-        double end = get_current_time();
-        if (layer->one_blob_only)
+
+        miss_count++;
+    }
+
+    return fallback_malloc(size, allocator);
+}
+
+void MemoryPlanAllocator::fastFree(void* ptr)
+{
+    MutexLockGuard g(lock);
+
+    int record_index = -1;
+    if (mode == 1 && record_payouts.take(ptr, record_index))
+    {
+        record_ends[record_index] = clock++;
+    }
+
+    if (mode == 2 && (unsigned char*)ptr >= arena && (unsigned char*)ptr < arena + plan->arena_size)
+    {
+        const int offset_index = find_offset_index(plan->distinct_offsets, (unsigned char*)ptr - arena);
+        const int i = offset_index == -1 ? -1 : replay_offset_payouts[offset_index];
+        if (i != -1)
         {
-            int top_blob_index = layer->tops[0];
-            benchmark(layer, bottom_blob, blob_mats[top_blob_index], start, end);
+            replay_states[i] = 2;
+            replay_offset_payouts[offset_index] = -1;
+            if (plan->free_ranks[i] < free_cursor)
+                released_required_count++;
+
+            arena_payout_counts[arena_index]--;
+            return;
         }
-        else
+    }
+
+    if (fallback_free(ptr))
+        return;
+
+    // memory of arenas stays until clear, an arena no longer referenced is reused
+    for (size_t i = 0; i < arenas.size(); i++)
+    {
+        if ((unsigned char*)ptr >= arenas[i].first && (unsigned char*)ptr < arenas[i].first + arena_sizes[i])
         {
-            benchmark(layer, start, end);
+            arena_payout_counts[i]--;
+            return;
         }
-#endif
     }
-    if (ret != 0)
-        return ret;
 
-    //     NCNN_LOGE("forward_layer %d %d %s done", layer->support_vulkan, layer_index, layer->name.c_str());
+    NCNN_LOGE("FATAL ERROR! memory plan allocator get wild %p", ptr);
+}
 
-    return 0;
+// the event being recorded on this thread
+static ThreadLocalStorage tls_profiler_recorder;
+
+static ThreadLocalStorage tls_profiler_thread_id;
+static int g_profiler_thread_count = 0;
+
+static int get_profiler_thread_id()
+{
+    // stored plus one, zero means unassigned
+    size_t id = (size_t)tls_profiler_thread_id.get();
+    if (id == 0)
+    {
+        id = (size_t)NCNN_XADD(&g_profiler_thread_count, 1) + 1;
+        tls_profiler_thread_id.set((void*)id);
+    }
+
+    return (int)id - 1;
 }
-#endif // NCNN_VULKAN
 
-int NetPrivate::convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt) const
+// header of m without data
+static Mat profiler_shape(const Mat& m)
 {
-    if (bottom_blob.elembits() == 32)
+    Mat shape;
+    shape.dims = m.dims;
+    shape.w = m.w;
+    shape.h = m.h;
+    shape.d = m.d;
+    shape.c = m.c;
+    shape.elempack = m.elempack;
+    shape.elemsize = m.elemsize;
+    return shape;
+}
+
+static Profiler* get_profiler(const Option& opt)
+{
+    return opt.extension ? opt.extension->profiler : 0;
+}
+
+// times one span on the calling thread and passes it to the profiler
+// does nothing when the profiler is null
+class ProfilerRecorder
+{
+public:
+    ProfilerRecorder(Profiler* _profiler, int type, const Layer* layer, int layer_index)
+        : profiler(_profiler), parent(0)
     {
-        // clang-format off
-        // *INDENT-OFF*
+        if (!profiler)
+            return;
 
-#if NCNN_ARM82
-        if (opt.use_fp16_storage && cpu_support_arm_asimdhp() && layer->support_fp16_storage)
-        {
-            Mat bottom_blob_fp16;
-            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
-            bottom_blob = bottom_blob_fp16;
-        }
-        else
-#endif // NCNN_ARM82
-#if NCNN_VFPV4
-        if (opt.use_fp16_storage && !opt.use_bf16_storage && cpu_support_arm_vfpv4() && layer->support_fp16_storage)
+        parent = (ProfilerRecorder*)tls_profiler_recorder.get();
+        tls_profiler_recorder.set(this);
+
+        event.type = type;
+        event.layer = layer;
+        event.layer_index = layer_index;
+
+        // a layout conversion belongs to the layer being forwarded
+        if (layer_index == -1 && parent)
+            event.layer_index = parent->event.layer_index;
+
+        event.start = get_current_time();
+    }
+
+    ~ProfilerRecorder()
+    {
+        if (!profiler)
+            return;
+
+        tls_profiler_recorder.set(parent);
+
+        if (parent)
         {
-            Mat bottom_blob_fp16;
-            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
-            bottom_blob = bottom_blob_fp16;
+            parent->event.blob_allocated_bytes += event.blob_allocated_bytes;
+            parent->event.workspace_allocated_bytes += event.workspace_allocated_bytes;
         }
-        else
-#endif // NCNN_VFPV4
-#if NCNN_ZFH
-        if (opt.use_fp16_storage && (ncnn::cpu_support_riscv_zvfh() || (!ncnn::cpu_support_riscv_v() && ncnn::cpu_support_riscv_zfh())) && layer->support_fp16_storage)
+    }
+
+    void add_bottoms(const Layer* layer, const std::vector<Mat>& blob_mats)
+    {
+        if (!profiler)
+            return;
+
+        for (size_t i = 0; i < layer->bottoms.size(); i++)
         {
-            Mat bottom_blob_fp16;
-            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
-            bottom_blob = bottom_blob_fp16;
+            event.bottom_shapes.push_back(profiler_shape(blob_mats[layer->bottoms[i]]));
         }
-        else
-#endif // NCNN_ZFH
-#if NCNN_BF16
-        if (opt.use_bf16_storage && layer->support_bf16_storage)
+    }
+
+    void add_tops(const Layer* layer, const std::vector<Mat>& blob_mats)
+    {
+        if (!profiler)
+            return;
+
+        for (size_t i = 0; i < layer->tops.size(); i++)
         {
-            Mat bottom_blob_bf16;
-            cast_float32_to_bfloat16(bottom_blob, bottom_blob_bf16, opt);
-            bottom_blob = bottom_blob_bf16;
+            event.top_shapes.push_back(profiler_shape(blob_mats[layer->tops[i]]));
         }
-        else
-#endif // NCNN_BF16
+    }
+
+    void finish()
+    {
+        if (!profiler)
+            return;
+
+        event.end = get_current_time();
+        event.thread_id = get_profiler_thread_id();
+
+        profiler->record(event);
+    }
+
+    Profiler* profiler;
+    ProfilerRecorder* parent;
+    ProfilerEvent event;
+};
+
+// counts the bytes requested from allocator into the event recorded on the calling thread
+// one is kept by the net for each allocator used with a profiler, so blobs outlive the extractor
+class ProfilerAllocator : public Allocator
+{
+public:
+    ProfilerAllocator(Allocator* _allocator, int _kind)
+        : allocator(_allocator), kind(_kind), payout_count(0), user_count(0)
+    {
+    }
+
+    virtual void* fastMalloc(size_t size)
+    {
+        ProfilerRecorder* recorder = (ProfilerRecorder*)tls_profiler_recorder.get();
+        if (recorder)
         {
+            if (kind == 0)
+                recorder->event.blob_allocated_bytes += size;
+            else
+                recorder->event.workspace_allocated_bytes += size;
         }
 
-        // *INDENT-ON*
-        // clang-format on
+        void* ptr = allocator ? allocator->fastMalloc(size) : ncnn::fastMalloc(size);
+        if (ptr)
+            NCNN_XADD(&payout_count, 1);
 
-        if (bottom_blob.empty())
-            return -100;
+        return ptr;
     }
 
-    int dst_elempack = 1;
-    if (opt.use_packing_layout)
+    virtual void fastFree(void* ptr)
     {
-        // resolve dst_elempack
-        int dims = bottom_blob.dims;
-        int elemcount = 0;
-        if (dims == 1) elemcount = bottom_blob.elempack * bottom_blob.w;
-        if (dims == 2) elemcount = bottom_blob.elempack * bottom_blob.h;
-        if (dims == 3 || dims == 4) elemcount = bottom_blob.elempack * bottom_blob.c;
+        if (allocator)
+            allocator->fastFree(ptr);
+        else
+            ncnn::fastFree(ptr);
 
-        int elembits = bottom_blob.elembits();
+        NCNN_XADD(&payout_count, -1);
+    }
 
-        if (layer->support_packing)
-        {
-            if (elembits == 32)
-            {
-#if NCNN_AVX512
-                if (elemcount % 16 == 0 && ncnn::cpu_support_x86_avx512())
-                    dst_elempack = 16;
-                else if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
-                    dst_elempack = 8;
-                else if (elemcount % 4 == 0)
-                    dst_elempack = 4;
-#elif NCNN_AVX
-                if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
-                    dst_elempack = 8;
-                else if (elemcount % 4 == 0)
-                    dst_elempack = 4;
-#elif NCNN_RVV || NCNN_XTHEADVECTOR
-                const int packn = ncnn::cpu_riscv_vlenb() / 4;
-                if (elemcount % packn == 0)
-                    dst_elempack = packn;
-#else
-                if (elemcount % 4 == 0)
-                    dst_elempack = 4;
-#endif
-            }
-            if (elembits == 16)
-            {
-#if NCNN_ARM82
-                if (elemcount % 8 == 0 && ncnn::cpu_support_arm_asimdhp() && opt.use_fp16_arithmetic && layer->support_fp16_storage)
-                    dst_elempack = 8;
-                else if (elemcount % 4 == 0)
-                    dst_elempack = 4;
+    // the allocator passed through, null for the default one
+    Allocator* allocator;
+
+    // 0 = blob, 1 = workspace
+    int kind;
+
+    // memory not yet freed, updated atomically
+    int payout_count;
+
+    // extract calls using it, guarded by profiler_allocators_lock
+    int user_count;
+};
+
+#if NCNN_THREADS
+// worker threads kept by the net for running branches in parallel
+// threads are started on demand and live until the net is cleared
+class ParallelBranchThreadPool
+{
+public:
+    ParallelBranchThreadPool();
+    ~ParallelBranchThreadPool();
+
+    // run func on the calling thread and on up to helper_count idle workers
+    // return when all of them are done
+    void run(void* (*func)(void*), void* args, int helper_count);
+
+protected:
+    static void* worker(void* args);
+
+    struct Job
+    {
+        void* (*func)(void*);
+        void* args;
+
+        // workers running this job
+        int running_count;
+    };
+
+    Mutex lock;
+    ConditionVariable condition;
+
+    std::vector<Thread*> threads;
+
+    // one entry for each helper a job asked for and no worker has taken yet
+    std::vector<Job*> pending_jobs;
+
+    bool stopping;
+};
+
+ParallelBranchThreadPool::ParallelBranchThreadPool()
+{
+    stopping = false;
+}
+
+ParallelBranchThreadPool::~ParallelBranchThreadPool()
+{
+    lock.lock();
+    stopping = true;
+    condition.broadcast();
+    lock.unlock();
+
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+}
+
+void ParallelBranchThreadPool::run(void* (*func)(void*), void* args, int helper_count)
+{
+    Job job;
+    job.func = func;
+    job.args = args;
+    job.running_count = 0;
+
+    lock.lock();
+    while ((int)threads.size() < helper_count)
+    {
+        threads.push_back(new Thread(worker, (void*)this));
+    }
+    for (int i = 0; i < helper_count; i++)
+    {
+        pending_jobs.push_back(&job);
+    }
+    condition.broadcast();
+    lock.unlock();
+
+    // the calling thread works too
+    func(args);
+
+    lock.lock();
+
+    // the job is done once func returns on any thread, helpers not started yet are not needed
+    size_t j = 0;
+    for (size_t i = 0; i < pending_jobs.size(); i++)
+    {
+        if (pending_jobs[i] != &job)
+            pending_jobs[j++] = pending_jobs[i];
+    }
+    pending_jobs.resize(j);
+
+    while (job.running_count > 0)
+    {
+        condition.wait(lock);
+    }
+    lock.unlock();
+}
+
+void* ParallelBranchThreadPool::worker(void* args)
+{
+    ParallelBranchThreadPool* pool = (ParallelBranchThreadPool*)args;
+
+    pool->lock.lock();
+    for (;;)
+    {
+        while (pool->pending_jobs.empty() && !pool->stopping)
+        {
+            pool->condition.wait(pool->lock);
+        }
+
+        if (pool->pending_jobs.empty())
+            break;
+
+        Job* job = pool->pending_jobs.back();
+        pool->pending_jobs.pop_back();
+
+        job->running_count++;
+
+        pool->lock.unlock();
+
+        job->func(job->args);
+
+        pool->lock.lock();
+
+        job->running_count--;
+
+        pool->condition.broadcast();
+    }
+    pool->lock.unlock();
+
+    return 0;
+}
+#endif // NCNN_THREADS
+
+class NetPrivate
+{
+public:
+    NetPrivate(Option& _opt);
+
+    Option& opt;
+
+#if NCNN_VULKAN
+
+    int upload_model();
+
+#endif // NCNN_VULKAN
+
+    friend class Extractor;
+    int forward_layer(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const;
+
+    // run the deferred create_pipeline of the layer once
+    int create_pipeline_lazy(int layer_index) const;
+
+#if NCNN_THREADS
+    int forward_layer_parallel_branch(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const;
+
+    // the worker pool of parallel branches, created on first use
+    ParallelBranchThreadPool* get_parallel_branch_pool() const;
+#endif // NCNN_THREADS
+
+    // forward on cpu with the strategy chosen by opt
+    int forward_layer_cpu(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const;
+
+    int forward_memory_planned(int blob_index, std::vector<Mat>& blob_mats, const Option& opt, MemoryPlanAllocator* allocator) const;
+
+    // layers needed for the requested layer, each after the producers of its bottom blobs
+    void collect_forward_layers(int layer_index, const std::vector<Mat>& blob_mats, std::vector<int>& layer_indexes) const;
+
+    // compile or look up the cached plan for the requested layer
+    // the plan is compiled into uncached_plan when the cache is full
+    int get_execution_plan(int layer_index, const std::vector<Mat>& blob_mats, const ExecutionPlan*& plan, ExecutionPlan& uncached_plan) const;
+
+    // stream_states is given in streaming mode, one for each layer
+    int forward_execution_plan(const ExecutionPlan* plan, std::vector<Mat>& blob_mats, const Option& opt, std::vector<StreamLayerState>* stream_states = 0) const;
+
+    int forward_layer_batch(int layer_index, std::vector<std::vector<Mat> >& batch_blob_mats, const Option& opt) const;
+
+#if NCNN_VULKAN
+    int forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const;
+#endif // NCNN_VULKAN
+
+    int convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt) const;
+    int do_convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt) const;
+
+    // pass-through allocator counting the bytes for the profiler, kind 0 = blob, 1 = workspace
+    // every get is paired with a put when the forward is done
+    Allocator* get_profiler_allocator(Allocator* allocator, int kind) const;
+    void put_profiler_allocator(Allocator* allocator) const;
+    bool is_profiler_allocator(const Allocator* allocator) const;
+
+    // convert_layout is skipped for fp32 pack1 bottom blobs when may_convert_layout is false
+    int do_forward_layer(const Layer* layer, std::vector<Mat>& blob_mats, const Option& opt, bool may_convert_layout = true) const;
+    int do_forward_layer_stacked(const Layer* layer, std::vector<std::vector<Mat> >& batch_blob_mats, const Option& opt) const;
+    int do_forward_layer_streaming(int layer_index, StreamLayerState& state, std::vector<Mat>& blob_mats, const Option& opt) const;
+#if NCNN_VULKAN
+    int do_forward_layer(const Layer* layer, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const;
+#endif // NCNN_VULKAN
+
+    void update_input_output_indexes();
+#if NCNN_STRING
+    void update_input_output_names();
+#endif // NCNN_STRING
+
+    std::vector<Blob> blobs;
+    std::vector<Layer*> layers;
+
+    // streaming behavior of each layer, decided from the layer params
+    std::vector<StreamLayerInfo> stream_layers;
+
+    std::vector<int> input_blob_indexes;
+    std::vector<int> output_blob_indexes;
+#if NCNN_STRING
+    std::vector<const char*> input_blob_names;
+    std::vector<const char*> output_blob_names;
+#endif // NCNN_STRING
+
+    std::vector<custom_layer_registry_entry> custom_layer_registry;
+    std::vector<overwrite_builtin_layer_registry_entry> overwrite_builtin_layer_registry;
+
+    PoolAllocator* local_blob_allocator;
+    PoolAllocator* local_workspace_allocator;
+
+    // memory plans shared by all extractors
+    mutable Mutex memory_plans_lock;
+    mutable std::vector<MemoryPlan*> memory_plans;
+
+    // execution plans shared by all extractors
+    mutable Mutex execution_plans_lock;
+    mutable std::vector<ExecutionPlan*> execution_plans;
+
+    // pipeline state of each layer when create_pipeline is deferred, empty otherwise
+    // set atomically, so that created pipelines are checked without the lock
+    mutable Mutex lazy_pipelines_lock;
+    mutable std::vector<int> pipeline_created;
+
+    // counting allocators shared by all extractors with a profiler
+    mutable Mutex profiler_allocators_lock;
+    mutable std::vector<ProfilerAllocator*> profiler_allocators;
+
+#if NCNN_THREADS
+    // worker pool shared by all extractors running branches in parallel
+    mutable Mutex parallel_branch_pool_lock;
+    mutable ParallelBranchThreadPool* parallel_branch_pool;
+#endif // NCNN_THREADS
+
+#if NCNN_STDIO
+    // model file mapped by load_model_mmap, referenced by layer weights
+    DataReaderFromMmap* model_mmap;
+#endif // NCNN_STDIO
+
+#if NCNN_VULKAN
+    const VulkanDevice* vkdev;
+
+    VkAllocator* weight_vkallocator;
+    VkAllocator* weight_staging_vkallocator;
+
+    PipelineCache* pipeline_cache;
+#endif // NCNN_VULKAN
+};
+
+NetPrivate::NetPrivate(Option& _opt)
+    : opt(_opt)
+{
+    local_blob_allocator = 0;
+    local_workspace_allocator = 0;
+
+#if NCNN_THREADS
+    parallel_branch_pool = 0;
+#endif // NCNN_THREADS
+
+#if NCNN_STDIO
+    model_mmap = 0;
+#endif // NCNN_STDIO
+
+#if NCNN_VULKAN
+    vkdev = 0;
+    weight_vkallocator = 0;
+    weight_staging_vkallocator = 0;
+    pipeline_cache = 0;
+#endif // NCNN_VULKAN
+}
+
+static Option get_masked_option(const Option& opt, int featmask)
+{
+    // mask option usage as layer specific featmask
+    Option opt1 = opt;
+    opt1.use_fp16_arithmetic = opt1.use_fp16_arithmetic && !(featmask & (1 << 0));
+    opt1.use_fp16_storage = opt1.use_fp16_storage && !(featmask & (1 << 1));
+    opt1.use_fp16_packed = opt1.use_fp16_packed && !(featmask & (1 << 1));
+    opt1.use_bf16_storage = opt1.use_bf16_storage && !(featmask & (1 << 2));
+    opt1.use_int8_packed = opt1.use_int8_packed && !(featmask & (1 << 3));
+    opt1.use_int8_storage = opt1.use_int8_storage && !(featmask & (1 << 3));
+    opt1.use_int8_arithmetic = opt1.use_int8_arithmetic && !(featmask & (1 << 3));
+    opt1.use_vulkan_compute = opt1.use_vulkan_compute && !(featmask & (1 << 4));
+    opt1.use_tensor_storage = opt1.use_tensor_storage && !(featmask & (1 << 4));
+    opt1.use_sgemm_convolution = opt1.use_sgemm_convolution && !(featmask & (1 << 5));
+    opt1.use_winograd_convolution = opt1.use_winograd_convolution && !(featmask & (1 << 6));
+
+    if (featmask & (1 << 7))
+        opt1.num_threads = 1;
+
+    return opt1;
+}
+
+static StreamLayerInfo get_stream_layer_info(const Layer* layer, const ParamDict& pd)
+{
+    StreamLayerInfo info;
+
+    const int typeindex = layer->typeindex;
+
+    if (typeindex == LayerType::LSTM || typeindex == LayerType::GRU || typeindex == LayerType::RNN)
+    {
+        // states wired explicitly in the graph are left to the caller
+        if (layer->bottoms.size() != 1 || layer->tops.size() != 1)
+            return info;
+
+        const int direction = pd.get(2, 0);
+
+        info.type = direction == 0 ? 1 : -1;
+        info.state_count = typeindex == LayerType::LSTM ? 2 : 1;
+        return info;
+    }
+
+    int kernel_w = 1;
+    int dilation_w = 1;
+    int stride_w = 1;
+    int pad_left = 0;
+    int pad_right = 0;
+    bool streamable = true;
+
+    if (typeindex == LayerType::Convolution1D || typeindex == LayerType::ConvolutionDepthWise1D)
+    {
+        kernel_w = pd.get(1, 0);
+        dilation_w = pd.get(2, 1);
+        stride_w = pd.get(3, 1);
+        pad_left = pd.get(4, 0);
+        pad_right = pd.get(15, pad_left);
+
+        const int dynamic_weight = pd.get(19, 0);
+        if (dynamic_weight)
+            streamable = false;
+    }
+    else if (typeindex == LayerType::Pooling1D)
+    {
+        kernel_w = pd.get(1, 0);
+        stride_w = pd.get(2, 1);
+        pad_left = pd.get(3, 0);
+        pad_right = pd.get(14, pad_left);
+
+        const int global_pooling = pd.get(4, 0);
+        const int pad_mode = pd.get(5, 0);
+        const int adaptive_pooling = pd.get(7, 0);
+        if (global_pooling || adaptive_pooling)
+            streamable = false;
+
+        // full padding appends a tail depending on the chunk length, same padding is symmetric
+        if (pad_mode == 2 || pad_mode == 3 || (pad_mode == 0 && stride_w != 1))
+            streamable = false;
+    }
+    else if (typeindex == LayerType::MultiHeadAttention)
+    {
+        // the cache wired explicitly in the graph is left to the caller
+        const int kv_cache = pd.get(7, 0);
+        if (kv_cache && layer->tops.size() == 1)
+        {
+            info.type = 3;
+            info.state_count = 2;
+        }
+        return info;
+    }
+    else
+    {
+        return info;
+    }
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+
+    // outputs must not look ahead, the frames skipped by stride must all be kept
+    if (pad_left < 0 || pad_right != 0 || pad_left % stride_w != 0 || stride_w > kernel_extent_w)
+        streamable = false;
+
+    info.type = streamable ? 2 : -1;
+    info.kernel_extent = kernel_extent_w;
+    info.stride = stride_w;
+    info.pad_left = pad_left;
+    return info;
+}
+
+#if NCNN_VULKAN
+int NetPrivate::upload_model()
+{
+    ncnn::VkTransfer cmd(vkdev);
+
+    // create gpu device allocator if null
+    if (!weight_vkallocator)
+    {
+        weight_vkallocator = new VkWeightAllocator(vkdev);
+    }
+    if (!weight_staging_vkallocator)
+    {
+        weight_staging_vkallocator = new VkWeightStagingAllocator(vkdev);
+    }
+
+    Option opt_upload = opt;
+    opt_upload.blob_allocator = 0;
+    opt_upload.workspace_allocator = 0;
+    opt_upload.blob_vkallocator = weight_vkallocator;
+    opt_upload.workspace_vkallocator = weight_vkallocator;
+    opt_upload.staging_vkallocator = weight_staging_vkallocator;
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (layers[i]->support_vulkan)
+        {
+            int uret = layers[i]->upload_model(cmd, get_masked_option(opt_upload, layers[i]->featmask));
+            if (uret != 0)
+            {
+                NCNN_LOGE("layer upload_model %d failed", (int)i);
+                return -1;
+            }
+        }
+    }
+
+    return cmd.submit_and_wait();
+}
+#endif // NCNN_VULKAN
+
+int NetPrivate::create_pipeline_lazy(int layer_index) const
+{
+    if (pipeline_created.empty())
+        return 0;
+
+    // atomic read, the lock is only taken until the pipeline is created
+    int* created = &pipeline_created[layer_index];
+    if (NCNN_XADD(created, 0))
+        return 0;
+
+    MutexLockGuard lock(lazy_pipelines_lock);
+
+    if (*created)
+        return 0;
+
+    Layer* layer = layers[layer_index];
+
+    // pipelines are created with the load-time option
+    Option opt1 = get_masked_option(opt, layer->featmask);
+
+    int ret = layer->create_pipeline(opt1);
+    if (ret != 0)
+    {
+#if NCNN_STRING
+        NCNN_LOGE("layer create_pipeline %d %s failed", layer_index, layer->name.c_str());
+#else
+        NCNN_LOGE("layer create_pipeline %d failed", layer_index);
+#endif
+        return ret;
+    }
+
+    NCNN_XADD(created, 1);
+
+    return 0;
+}
+
+int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const
+{
+    const Layer* layer = layers[layer_index];
+
+    //     NCNN_LOGE("forward_layer %d %s", layer_index, layer->name.c_str());
+
+    // load bottom blobs
+    for (size_t i = 0; i < layer->bottoms.size(); i++)
+    {
+        int bottom_blob_index = layer->bottoms[i];
+
+        if (blob_mats[bottom_blob_index].dims == 0)
+        {
+            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, opt);
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    {
+        int ret = create_pipeline_lazy(layer_index);
+        if (ret != 0)
+            return ret;
+    }
+
+    ProfilerRecorder profiler_recorder(get_profiler(opt), 0, layer, layer_index);
+    profiler_recorder.add_bottoms(layer, blob_mats);
+
+#if NCNN_BENCHMARK
+    double start = get_current_time();
+    Mat bottom_blob;
+    if (layer->one_blob_only)
+    {
+        int bottom_blob_index = layer->bottoms[0];
+        bottom_blob.dims = blob_mats[bottom_blob_index].dims;
+        bottom_blob.w = blob_mats[bottom_blob_index].w;
+        bottom_blob.h = blob_mats[bottom_blob_index].h;
+        bottom_blob.d = blob_mats[bottom_blob_index].d;
+        bottom_blob.c = blob_mats[bottom_blob_index].c;
+        bottom_blob.elempack = blob_mats[bottom_blob_index].elempack;
+        bottom_blob.elemsize = blob_mats[bottom_blob_index].elemsize;
+    }
+#endif
+    int ret = 0;
+    if (layer->featmask)
+    {
+        ret = do_forward_layer(layer, blob_mats, get_masked_option(opt, layer->featmask));
+    }
+    else
+    {
+        ret = do_forward_layer(layer, blob_mats, opt);
+    }
+#if NCNN_BENCHMARK
+    double end = get_current_time();
+    if (layer->one_blob_only)
+    {
+        int top_blob_index = layer->tops[0];
+        benchmark(layer, bottom_blob, blob_mats[top_blob_index], start, end);
+    }
+    else
+    {
+        benchmark(layer, start, end);
+    }
+#endif
+    profiler_recorder.add_tops(layer, blob_mats);
+    profiler_recorder.finish();
+    if (ret != 0)
+        return ret;
+
+    //     NCNN_LOGE("forward_layer %d %s done", layer_index, layer->name.c_str());
+    //     const Mat& blob = blob_mats[layer->tops[0]];
+    //     NCNN_LOGE("[%-2d %-16s %-16s]  %d    blobs count = %-3d   size = %-3d x %-3d", layer_index, layer->type.c_str(), layer->name.c_str(), layer->tops[0], blob.c, blob.h, blob.w);
+
+    return 0;
+}
+
+#if NCNN_THREADS
+class ParallelBranchScheduler
+{
+public:
+    const NetPrivate* d;
+    std::vector<Mat>* blob_mats;
+    const Option* opt;
+    int worker_count;
+
+    Mutex lock;
+    ConditionVariable condition;
+
+    // layers whose bottom blobs are all ready
+    std::vector<int> ready_layers;
+
+    // number of bottom blobs not produced yet, indexed by layer
+    std::vector<int> pending_counts;
+
+    // layers consuming the top blobs, indexed by layer
+    std::vector<std::vector<int> > dependent_layers;
+
+    // consumers not finished yet, indexed by blob
+    std::vector<int> consumer_counts;
+
+    // layers reading a blob that other layers read too, indexed by layer
+    // they run without light mode and the scheduler releases their bottom blobs after the last consumer
+    std::vector<unsigned char> shared_bottom_layers;
+
+    int remaining_count;
+    int running_count;
+    int ret;
+};
+
+static void* parallel_branch_worker(void* args)
+{
+    ParallelBranchScheduler* s = (ParallelBranchScheduler*)args;
+
+    set_flush_denormals(s->opt->flush_denormals);
+
+    Option opt = *s->opt;
+
+    s->lock.lock();
+    for (;;)
+    {
+        while (s->ready_layers.empty() && s->remaining_count > 0 && s->ret == 0)
+        {
+            s->condition.wait(s->lock);
+        }
+
+        if (s->remaining_count == 0 || s->ret != 0)
+            break;
+
+        int layer_index = s->ready_layers.back();
+        s->ready_layers.pop_back();
+
+        s->running_count++;
+
+        // split the thread budget among the layers that are able to run now
+        int concurrency = std::min(s->worker_count, s->running_count + (int)s->ready_layers.size());
+        opt.num_threads = std::max(s->opt->num_threads / concurrency, 1);
+
+        // a shared blob must not be released or modified in place while another layer reads it
+        const bool shared_bottom = s->shared_bottom_layers[layer_index];
+        opt.lightmode = s->opt->lightmode && !shared_bottom;
+
+        s->lock.unlock();
+
+        int ret = s->d->forward_layer(layer_index, *s->blob_mats, opt);
+
+        s->lock.lock();
+
+        s->running_count--;
+        s->remaining_count--;
+
+        if (ret != 0)
+        {
+            s->ret = ret;
+        }
+        else
+        {
+            const Layer* layer = s->d->layers[layer_index];
+            if (shared_bottom && s->opt->lightmode)
+            {
+                for (size_t i = 0; i < layer->bottoms.size(); i++)
+                {
+                    int bottom_blob_index = layer->bottoms[i];
+                    s->consumer_counts[bottom_blob_index]--;
+                    if (s->consumer_counts[bottom_blob_index] == 0)
+                    {
+                        // delete after taken by the last consumer in light mode
+                        (*s->blob_mats)[bottom_blob_index].release();
+                    }
+                }
+            }
+
+            const std::vector<int>& dependents = s->dependent_layers[layer_index];
+            for (size_t i = 0; i < dependents.size(); i++)
+            {
+                int dependent_layer_index = dependents[i];
+                s->pending_counts[dependent_layer_index]--;
+                if (s->pending_counts[dependent_layer_index] == 0)
+                {
+                    s->ready_layers.push_back(dependent_layer_index);
+                }
+            }
+        }
+
+        s->condition.broadcast();
+    }
+    s->lock.unlock();
+
+    return 0;
+}
+
+ParallelBranchThreadPool* NetPrivate::get_parallel_branch_pool() const
+{
+    MutexLockGuard lock(parallel_branch_pool_lock);
+
+    if (!parallel_branch_pool)
+        parallel_branch_pool = new ParallelBranchThreadPool;
+
+    return parallel_branch_pool;
+}
+
+int NetPrivate::forward_layer_parallel_branch(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const
+{
+    const int layer_count = (int)layers.size();
+
+    // collect the layers needed for producing the requested blob
+    std::vector<int> needed_layers;
+    std::vector<unsigned char> layer_visited(layer_count, 0);
+    {
+        std::vector<int> layer_stack;
+        layer_stack.push_back(layer_index);
+        layer_visited[layer_index] = 1;
+
+        while (!layer_stack.empty())
+        {
+            int li = layer_stack.back();
+            layer_stack.pop_back();
+
+            needed_layers.push_back(li);
+
+            const Layer* layer = layers[li];
+            for (size_t i = 0; i < layer->bottoms.size(); i++)
+            {
+                int bottom_blob_index = layer->bottoms[i];
+                if (blob_mats[bottom_blob_index].dims != 0)
+                    continue;
+
+                int producer = blobs[bottom_blob_index].producer;
+                if (!layer_visited[producer])
+                {
+                    layer_visited[producer] = 1;
+                    layer_stack.push_back(producer);
+                }
+            }
+        }
+    }
+
+    const int worker_count = std::min(opt.num_threads, (int)needed_layers.size());
+    if (worker_count <= 1)
+        return forward_layer(layer_index, blob_mats, opt);
+
+    ParallelBranchScheduler s;
+    s.d = this;
+    s.blob_mats = &blob_mats;
+    s.opt = &opt;
+    s.worker_count = worker_count;
+    s.pending_counts.resize(layer_count, 0);
+    s.dependent_layers.resize(layer_count);
+    s.consumer_counts.resize(blobs.size(), 0);
+    s.shared_bottom_layers.resize(layer_count, 0);
+    s.remaining_count = (int)needed_layers.size();
+    s.running_count = 0;
+    s.ret = 0;
+
+    for (size_t i = 0; i < needed_layers.size(); i++)
+    {
+        int li = needed_layers[i];
+        const Layer* layer = layers[li];
+        for (size_t j = 0; j < layer->bottoms.size(); j++)
+        {
+            int bottom_blob_index = layer->bottoms[j];
+
+            s.consumer_counts[bottom_blob_index]++;
+
+            if (blob_mats[bottom_blob_index].dims != 0)
+                continue;
+
+            s.pending_counts[li]++;
+            s.dependent_layers[blobs[bottom_blob_index].producer].push_back(li);
+        }
+    }
+
+    // blobs read by several layers without a split in between, or twice by the same layer
+    for (size_t i = 0; i < needed_layers.size(); i++)
+    {
+        int li = needed_layers[i];
+        const Layer* layer = layers[li];
+        for (size_t j = 0; j < layer->bottoms.size(); j++)
+        {
+            if (s.consumer_counts[layer->bottoms[j]] > 1)
+                s.shared_bottom_layers[li] = 1;
+        }
+    }
+
+    // layers found later are closer to the graph inputs and pop from the ready stack first
+    for (size_t i = 0; i < needed_layers.size(); i++)
+    {
+        int li = needed_layers[i];
+        if (s.pending_counts[li] == 0)
+            s.ready_layers.push_back(li);
+    }
+
+    get_parallel_branch_pool()->run(parallel_branch_worker, (void*)&s, worker_count - 1);
+
+    return s.ret;
+}
+#endif // NCNN_THREADS
+
+int NetPrivate::forward_layer_cpu(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const
+{
+#if NCNN_THREADS
+    if (opt.use_parallel_branch)
+        return forward_layer_parallel_branch(layer_index, blob_mats, opt);
+#endif // NCNN_THREADS
+
+    if (opt.use_execution_plan)
+    {
+        ExecutionPlan uncached_plan;
+        const ExecutionPlan* plan = 0;
+        int ret = get_execution_plan(layer_index, blob_mats, plan, uncached_plan);
+        if (ret != 0)
+            return ret;
+
+        return forward_execution_plan(plan, blob_mats, opt);
+    }
+
+    return forward_layer(layer_index, blob_mats, opt);
+}
+
+int NetPrivate::forward_memory_planned(int blob_index, std::vector<Mat>& blob_mats, const Option& opt, MemoryPlanAllocator* allocator) const
+{
+    // the allocation sequence is decided by the requested blob and the blobs present
+    std::vector<int> signature;
+    signature.push_back(blob_index);
+    signature.push_back(opt.lightmode);
+    signature.push_back(opt.num_threads);
+    for (size_t i = 0; i < blob_mats.size(); i++)
+    {
+        const Mat& m = blob_mats[i];
+        if (m.dims == 0)
+            continue;
+
+        signature.push_back((int)i);
+        signature.push_back(m.dims);
+        signature.push_back(m.w);
+        signature.push_back(m.h);
+        signature.push_back(m.d);
+        signature.push_back(m.c);
+        signature.push_back(m.elempack);
+        signature.push_back((int)m.elemsize);
+    }
+
+    const MemoryPlan* plan = 0;
+    {
+        MutexLockGuard g(memory_plans_lock);
+
+        for (size_t i = 0; i < memory_plans.size(); i++)
+        {
+            if (memory_plans[i]->signature == signature)
+            {
+                plan = memory_plans[i];
+                break;
+            }
+        }
+    }
+
+    const int layer_index = blobs[blob_index].producer;
+
+    Option opt1 = opt;
+    opt1.blob_allocator = allocator;
+    opt1.workspace_allocator = allocator;
+
+    if (plan)
+    {
+        int ret = allocator->begin_replay(plan, opt.blob_allocator);
+        if (ret != 0)
+            return ret;
+
+        ret = forward_layer_cpu(layer_index, blob_mats, opt1);
+
+        allocator->end(0);
+
+        return ret;
+    }
+
+    allocator->begin_record(opt.blob_allocator);
+
+    int ret = forward_layer_cpu(layer_index, blob_mats, opt1);
+
+    MemoryPlan* new_plan = new MemoryPlan;
+    new_plan->signature = signature;
+
+    bool usable = allocator->end(new_plan);
+    if (ret == 0 && usable)
+    {
+        MutexLockGuard g(memory_plans_lock);
+
+        // plans are kept until net clear, extractors may be replaying them
+        bool exists = false;
+        for (size_t i = 0; i < memory_plans.size(); i++)
+        {
+            if (memory_plans[i]->signature == signature)
+            {
+                exists = true;
+                break;
+            }
+        }
+
+        if (!exists && memory_plans.size() < 32)
+        {
+            memory_plans.push_back(new_plan);
+            new_plan = 0;
+        }
+    }
+
+    delete new_plan;
+
+    return ret;
+}
+
+void NetPrivate::collect_forward_layers(int layer_index, const std::vector<Mat>& blob_mats, std::vector<int>& layer_indexes) const
+{
+    // post-order walk, 0 = unvisited, 1 = expanded, 2 = emitted
+    std::vector<unsigned char> layer_states(layers.size(), 0);
+    std::vector<int> layer_stack(1, layer_index);
+
+    while (!layer_stack.empty())
+    {
+        int li = layer_stack.back();
+
+        if (layer_states[li] == 0)
+        {
+            layer_states[li] = 1;
+
+            // push in reverse so that the first bottom is forwarded first, as the recursion does
+            const Layer* layer = layers[li];
+            for (int i = (int)layer->bottoms.size() - 1; i >= 0; i--)
+            {
+                int bottom_blob_index = layer->bottoms[i];
+                if (blob_mats[bottom_blob_index].dims != 0)
+                    continue;
+
+                int producer = blobs[bottom_blob_index].producer;
+                if (layer_states[producer] == 0)
+                    layer_stack.push_back(producer);
+            }
+
+            continue;
+        }
+
+        layer_stack.pop_back();
+
+        if (layer_states[li] == 1)
+        {
+            layer_states[li] = 2;
+            layer_indexes.push_back(li);
+        }
+    }
+}
+
+static bool execution_plan_matches(const ExecutionPlan* plan, size_t hash, int layer_index, const std::vector<Mat>& blob_mats, int present_blob_count)
+{
+    if (plan->hash != hash || plan->layer_index != layer_index || (int)plan->present_blob_indexes.size() != present_blob_count)
+        return false;
+
+    for (size_t i = 0; i < plan->present_blob_indexes.size(); i++)
+    {
+        if (blob_mats[plan->present_blob_indexes[i]].dims == 0)
+            return false;
+    }
+
+    return true;
+}
+
+int NetPrivate::get_execution_plan(int layer_index, const std::vector<Mat>& blob_mats, const ExecutionPlan*& plan, ExecutionPlan& uncached_plan) const
+{
+    // fnv-1a over the requested layer and the present blob indexes
+    size_t hash = 2166136261u;
+    hash = (hash ^ (size_t)layer_index) * 16777619u;
+    int present_blob_count = 0;
+    for (size_t i = 0; i < blob_mats.size(); i++)
+    {
+        if (blob_mats[i].dims == 0)
+            continue;
+
+        hash = (hash ^ i) * 16777619u;
+        present_blob_count++;
+    }
+
+    {
+        MutexLockGuard g(execution_plans_lock);
+
+        for (size_t i = 0; i < execution_plans.size(); i++)
+        {
+            if (execution_plan_matches(execution_plans[i], hash, layer_index, blob_mats, present_blob_count))
+            {
+                plan = execution_plans[i];
+                return 0;
+            }
+        }
+    }
+
+    ExecutionPlan& new_plan = uncached_plan;
+    new_plan.hash = hash;
+    new_plan.layer_index = layer_index;
+    new_plan.present_blob_indexes.clear();
+    for (size_t i = 0; i < blob_mats.size(); i++)
+    {
+        if (blob_mats[i].dims != 0)
+            new_plan.present_blob_indexes.push_back((int)i);
+    }
+
+    collect_forward_layers(layer_index, blob_mats, new_plan.layer_indexes);
+
+    // layer flags are final after create_pipeline
+    for (size_t i = 0; i < new_plan.layer_indexes.size(); i++)
+    {
+        int ret = create_pipeline_lazy(new_plan.layer_indexes[i]);
+        if (ret != 0)
+            return ret;
+    }
+
+    // the recursion recomputes a blob released before its last consumer
+    // keep such blobs until the last consumer in the plan instead
+    std::vector<int> blob_consumer_counts(blobs.size(), 0);
+    for (size_t i = 0; i < new_plan.layer_indexes.size(); i++)
+    {
+        const Layer* layer = layers[new_plan.layer_indexes[i]];
+        for (size_t j = 0; j < layer->bottoms.size(); j++)
+        {
+            blob_consumer_counts[layer->bottoms[j]]++;
+        }
+    }
+
+    new_plan.retained_blob_indexes.resize(new_plan.layer_indexes.size());
+    new_plan.layer_convert_layouts.resize(new_plan.layer_indexes.size());
+    new_plan.layer_featmask_indexes.resize(new_plan.layer_indexes.size());
+    for (size_t i = 0; i < new_plan.layer_indexes.size(); i++)
+    {
+        const Layer* layer = layers[new_plan.layer_indexes[i]];
+        for (size_t j = 0; j < layer->bottoms.size(); j++)
+        {
+            int bottom_blob_index = layer->bottoms[j];
+            if (--blob_consumer_counts[bottom_blob_index] > 0)
+                new_plan.retained_blob_indexes[i].push_back(bottom_blob_index);
+        }
+
+        new_plan.layer_convert_layouts[i] = layer->support_packing || layer->support_fp16_storage || layer->support_bf16_storage;
+
+        new_plan.layer_featmask_indexes[i] = -1;
+        if (layer->featmask)
+        {
+            size_t k = 0;
+            for (; k < new_plan.featmasks.size(); k++)
+            {
+                if (new_plan.featmasks[k] == layer->featmask)
+                    break;
+            }
+            if (k == new_plan.featmasks.size())
+                new_plan.featmasks.push_back(layer->featmask);
+
+            new_plan.layer_featmask_indexes[i] = (int)k;
+        }
+    }
+
+    MutexLockGuard g(execution_plans_lock);
+
+    // another extractor may have compiled the same plan meanwhile
+    for (size_t i = 0; i < execution_plans.size(); i++)
+    {
+        if (execution_plan_matches(execution_plans[i], hash, layer_index, blob_mats, present_blob_count))
+        {
+            plan = execution_plans[i];
+            return 0;
+        }
+    }
+
+    // plans are kept until net clear, extractors may be running them
+    if (execution_plans.size() < 32)
+    {
+        execution_plans.push_back(new ExecutionPlan(new_plan));
+        plan = execution_plans.back();
+        return 0;
+    }
+
+    plan = &uncached_plan;
+
+    return 0;
+}
+
+int NetPrivate::forward_execution_plan(const ExecutionPlan* plan, std::vector<Mat>& blob_mats, const Option& opt, std::vector<StreamLayerState>* stream_states) const
+{
+    std::vector<Mat> retained_blobs;
+
+    std::vector<Option> masked_opts(plan->featmasks.size());
+    for (size_t i = 0; i < plan->featmasks.size(); i++)
+    {
+        masked_opts[i] = get_masked_option(opt, plan->featmasks[i]);
+    }
+
+    for (size_t i = 0; i < plan->layer_indexes.size(); i++)
+    {
+        const Layer* layer = layers[plan->layer_indexes[i]];
+
+        const int featmask_index = plan->layer_featmask_indexes[i];
+        const Option& opt1 = featmask_index == -1 ? opt : masked_opts[featmask_index];
+
+        const std::vector<int>& retained_blob_indexes = plan->retained_blob_indexes[i];
+        if (opt.lightmode && !retained_blob_indexes.empty())
+        {
+            retained_blobs.resize(retained_blob_indexes.size());
+            for (size_t j = 0; j < retained_blob_indexes.size(); j++)
+            {
+                retained_blobs[j] = blob_mats[retained_blob_indexes[j]];
+            }
+        }
+
+        ProfilerRecorder profiler_recorder(get_profiler(opt), 0, layer, plan->layer_indexes[i]);
+        profiler_recorder.add_bottoms(layer, blob_mats);
+
+#if NCNN_BENCHMARK
+        double start = get_current_time();
+        Mat bottom_blob;
+        if (layer->one_blob_only)
+        {
+            int bottom_blob_index = layer->bottoms[0];
+            bottom_blob.dims = blob_mats[bottom_blob_index].dims;
+            bottom_blob.w = blob_mats[bottom_blob_index].w;
+            bottom_blob.h = blob_mats[bottom_blob_index].h;
+            bottom_blob.d = blob_mats[bottom_blob_index].d;
+            bottom_blob.c = blob_mats[bottom_blob_index].c;
+            bottom_blob.elempack = blob_mats[bottom_blob_index].elempack;
+            bottom_blob.elemsize = blob_mats[bottom_blob_index].elemsize;
+        }
+#endif
+        int ret = 0;
+        if (stream_states && stream_layers[plan->layer_indexes[i]].type != 0)
+        {
+            StreamLayerState& state = (*stream_states)[plan->layer_indexes[i]];
+            ret = do_forward_layer_streaming(plan->layer_indexes[i], state, blob_mats, opt1);
+        }
+        else
+        {
+            ret = do_forward_layer(layer, blob_mats, opt1, plan->layer_convert_layouts[i]);
+        }
+#if NCNN_BENCHMARK
+        double end = get_current_time();
+        if (layer->one_blob_only)
+        {
+            int top_blob_index = layer->tops[0];
+            benchmark(layer, bottom_blob, blob_mats[top_blob_index], start, end);
+        }
+        else
+        {
+            benchmark(layer, start, end);
+        }
+#endif
+        profiler_recorder.add_tops(layer, blob_mats);
+        profiler_recorder.finish();
+        if (ret != 0)
+            return ret;
+
+        if (opt.lightmode && !retained_blob_indexes.empty())
+        {
+            for (size_t j = 0; j < retained_blob_indexes.size(); j++)
+            {
+                blob_mats[retained_blob_indexes[j]] = retained_blobs[j];
+                retained_blobs[j].release();
+            }
+        }
+    }
+
+    return 0;
+}
+
+int NetPrivate::forward_layer_batch(int layer_index, std::vector<std::vector<Mat> >& batch_blob_mats, const Option& opt) const
+{
+    const int batch = (int)batch_blob_mats.size();
+
+    ExecutionPlan uncached_plan;
+    const ExecutionPlan* plan = 0;
+    {
+        int ret = get_execution_plan(layer_index, batch_blob_mats[0], plan, uncached_plan);
+        if (ret != 0)
+            return ret;
+    }
+
+    std::vector<Option> masked_opts(plan->featmasks.size());
+    for (size_t i = 0; i < plan->featmasks.size(); i++)
+    {
+        masked_opts[i] = get_masked_option(opt, plan->featmasks[i]);
+    }
+
+    std::vector<std::vector<Mat> > retained_blobs(batch);
+
+    for (size_t i = 0; i < plan->layer_indexes.size(); i++)
+    {
+        const Layer* layer = layers[plan->layer_indexes[i]];
+
+        const int featmask_index = plan->layer_featmask_indexes[i];
+        const Option& opt1 = featmask_index == -1 ? opt : masked_opts[featmask_index];
+
+        const std::vector<int>& retained_blob_indexes = plan->retained_blob_indexes[i];
+        if (opt.lightmode && !retained_blob_indexes.empty())
+        {
+            for (int b = 0; b < batch; b++)
+            {
+                retained_blobs[b].resize(retained_blob_indexes.size());
+                for (size_t j = 0; j < retained_blob_indexes.size(); j++)
+                {
+                    retained_blobs[b][j] = batch_blob_mats[b][retained_blob_indexes[j]];
+                }
+            }
+        }
+
+        ProfilerRecorder profiler_recorder(get_profiler(opt), 0, layer, plan->layer_indexes[i]);
+        profiler_recorder.add_bottoms(layer, batch_blob_mats[0]);
+
+#if NCNN_BENCHMARK
+        double start = get_current_time();
+#endif
+        int ret = 0;
+        if (batch > 1 && (layer->support_batch_stacking || layer->support_batch_depth_stacking) && !layer->support_inplace && layer->bottoms.size() == 1 && layer->tops.size() == 1)
+        {
+            // stack samples into one forward, so the weights are streamed once
+            ret = do_forward_layer_stacked(layer, batch_blob_mats, opt1);
+        }
+        else
+        {
+            for (int b = 0; b < batch; b++)
+            {
+                ret = do_forward_layer(layer, batch_blob_mats[b], opt1, plan->layer_convert_layouts[i]);
+                if (ret != 0)
+                    break;
+            }
+        }
+#if NCNN_BENCHMARK
+        double end = get_current_time();
+        benchmark(layer, start, end);
+#endif
+        profiler_recorder.add_tops(layer, batch_blob_mats[0]);
+        profiler_recorder.finish();
+        if (ret != 0)
+            return ret;
+
+        if (opt.lightmode && !retained_blob_indexes.empty())
+        {
+            for (int b = 0; b < batch; b++)
+            {
+                for (size_t j = 0; j < retained_blob_indexes.size(); j++)
+                {
+                    batch_blob_mats[b][retained_blob_indexes[j]] = retained_blobs[b][j];
+                    retained_blobs[b][j].release();
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+#if NCNN_VULKAN
+int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const
+{
+    const Layer* layer = layers[layer_index];
+
+    //     NCNN_LOGE("forward_layer %d %d %s", layer->support_vulkan, layer_index, layer->name.c_str());
+
+    bool cmd_submit_and_wait = false;
+
+    // load bottom blobs
+    for (size_t i = 0; i < layer->bottoms.size(); i++)
+    {
+        int bottom_blob_index = layer->bottoms[i];
+
+        if (blob_mats_gpu[bottom_blob_index].dims == 0 && blob_mats[bottom_blob_index].dims == 0)
+        {
+            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, blob_mats_gpu, cmd, opt);
+            if (ret != 0)
+                return ret;
+        }
+
+        if (layer->support_vulkan)
+        {
+            if (blob_mats_gpu[bottom_blob_index].dims == 0)
+            {
+                // host to buffer
+                cmd.record_upload(blob_mats[bottom_blob_index], blob_mats_gpu[bottom_blob_index], opt);
+
+                if (opt.lightmode)
+                {
+                    // delete after taken in light mode
+                    blob_mats[bottom_blob_index].release();
+                }
+            }
+        }
+        else
+        {
+            if (blob_mats[bottom_blob_index].dims == 0)
+            {
+                Option opt_download = opt;
+                opt_download.use_packing_layout = layer->support_packing;
+
+                // buffer to host
+                cmd.record_download(blob_mats_gpu[bottom_blob_index], blob_mats[bottom_blob_index], opt_download);
+
+                if (opt.lightmode)
+                {
+                    // delete after taken in light mode
+                    blob_mats_gpu[bottom_blob_index].release();
+                }
+
+                cmd_submit_and_wait = true;
+            }
+        }
+    }
+
+    int ret;
+    if (cmd_submit_and_wait)
+    {
+        ret = cmd.submit_and_wait();
+
+#if NCNN_BENCHMARK
+        std::vector<uint64_t> results(layer_index * 2);
+        cmd.get_query_pool_results(0, layer_index * 2, results);
+        for (int i = 0; i < layer_index; i++)
+        {
+            uint64_t start = results[i * 2];
+            uint64_t end = results[i * 2 + 1];
+            if (start == 0 || end == 0)
+                continue;
+
+            double duration_us = (end - start) * vkdev->info.timestamp_period() / 1000;
+            NCNN_LOGE("%-24s %-30s %8.2lfus    |", layers[i]->type.c_str(), layers[i]->name.c_str(), duration_us);
+        }
+#endif // NCNN_BENCHMARK
+
+        cmd.reset();
+        if (ret != 0)
+            return ret;
+    }
+
+    if (layer->support_vulkan)
+    {
+#if NCNN_BENCHMARK
+        cmd.record_write_timestamp(layer_index * 2);
+#endif
+        if (layer->featmask)
+        {
+            ret = do_forward_layer(layer, blob_mats_gpu, cmd, get_masked_option(opt, layer->featmask));
+        }
+        else
+        {
+            ret = do_forward_layer(layer, blob_mats_gpu, cmd, opt);
+        }
+#if NCNN_BENCHMARK
+        cmd.record_write_timestamp(layer_index * 2 + 1);
+#endif
+    }
+    else
+    {
+#if NCNN_BENCHMARK
+        double start = get_current_time();
+        Mat bottom_blob;
+        if (layer->one_blob_only)
+        {
+            int bottom_blob_index = layer->bottoms[0];
+            bottom_blob = blob_mats[bottom_blob_index].shape();
+        }
+#endif
+        if (layer->featmask)
+        {
+            ret = do_forward_layer(layer, blob_mats, get_masked_option(opt, layer->featmask));
+        }
+        else
+        {
+            ret = do_forward_layer(layer, blob_mats, opt);
+        }
+#if NCNN_BENCHMARK
+        double end = get_current_time();
+        if (layer->one_blob_only)
+        {
+            int top_blob_index = layer->tops[0];
+            benchmark(layer, bottom_blob, blob_mats[top_blob_index], start, end);
+        }
+        else
+        {
+            benchmark(layer, start, end);
+        }
+#endif
+    }
+    if (ret != 0)
+        return ret;
+
+    //     NCNN_LOGE("forward_layer %d %d %s done", layer->support_vulkan, layer_index, layer->name.c_str());
+
+    return 0;
+}
+#endif // NCNN_VULKAN
+
+int NetPrivate::convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt) const
+{
+    if (!get_profiler(opt))
+        return do_convert_layout(bottom_blob, layer, opt);
+
+    ProfilerRecorder profiler_recorder(get_profiler(opt), 1, layer, -1);
+
+    const Mat bottom_blob_shape = profiler_shape(bottom_blob);
+    const void* bottom_blob_data = bottom_blob.data;
+
+    int ret = do_convert_layout(bottom_blob, layer, opt);
+
+    // only record the conversions actually inserted
+    if (ret == 0 && bottom_blob.data != bottom_blob_data)
+    {
+        profiler_recorder.event.bottom_shapes.push_back(bottom_blob_shape);
+        profiler_recorder.event.top_shapes.push_back(profiler_shape(bottom_blob));
+        profiler_recorder.finish();
+    }
+
+    return ret;
+}
+
+int NetPrivate::do_convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt) const
+{
+    // nothing to convert in a zero sized blob, such as the kv cache of the first step
+    if (bottom_blob.empty())
+        return 0;
+
+    if (bottom_blob.elembits() == 32)
+    {
+        // clang-format off
+        // *INDENT-OFF*
+
+#if NCNN_ARM82
+        if (opt.use_fp16_storage && cpu_support_arm_asimdhp() && layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp16;
+            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
+            bottom_blob = bottom_blob_fp16;
+        }
+        else
+#endif // NCNN_ARM82
+#if NCNN_VFPV4
+        if (opt.use_fp16_storage && !opt.use_bf16_storage && cpu_support_arm_vfpv4() && layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp16;
+            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
+            bottom_blob = bottom_blob_fp16;
+        }
+        else
+#endif // NCNN_VFPV4
+#if NCNN_ZFH
+        if (opt.use_fp16_storage && (ncnn::cpu_support_riscv_zvfh() || (!ncnn::cpu_support_riscv_v() && ncnn::cpu_support_riscv_zfh())) && layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp16;
+            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
+            bottom_blob = bottom_blob_fp16;
+        }
+        else
+#endif // NCNN_ZFH
+#if NCNN_BF16
+        if (opt.use_bf16_storage && layer->support_bf16_storage)
+        {
+            Mat bottom_blob_bf16;
+            cast_float32_to_bfloat16(bottom_blob, bottom_blob_bf16, opt);
+            bottom_blob = bottom_blob_bf16;
+        }
+        else
+#endif // NCNN_BF16
+        {
+        }
+
+        // *INDENT-ON*
+        // clang-format on
+
+        if (bottom_blob.empty())
+            return -100;
+    }
+
+    int dst_elempack = 1;
+    if (opt.use_packing_layout)
+    {
+        // resolve dst_elempack
+        int dims = bottom_blob.dims;
+        int elemcount = 0;
+        if (dims == 1) elemcount = bottom_blob.elempack * bottom_blob.w;
+        if (dims == 2) elemcount = bottom_blob.elempack * bottom_blob.h;
+        if (dims == 3 || dims == 4) elemcount = bottom_blob.elempack * bottom_blob.c;
+
+        int elembits = bottom_blob.elembits();
+
+        if (layer->support_packing)
+        {
+            if (elembits == 32)
+            {
+#if NCNN_AVX512
+                if (elemcount % 16 == 0 && ncnn::cpu_support_x86_avx512())
+                    dst_elempack = 16;
+                else if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
+                    dst_elempack = 8;
+                else if (elemcount % 4 == 0)
+                    dst_elempack = 4;
+#elif NCNN_AVX
+                if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
+                    dst_elempack = 8;
+                else if (elemcount % 4 == 0)
+                    dst_elempack = 4;
+#elif NCNN_RVV || NCNN_XTHEADVECTOR
+                const int packn = ncnn::cpu_riscv_vlenb() / 4;
+                if (elemcount % packn == 0)
+                    dst_elempack = packn;
+#else
+                if (elemcount % 4 == 0)
+                    dst_elempack = 4;
+#endif
+            }
+            if (elembits == 16)
+            {
+#if NCNN_ARM82
+                if (elemcount % 8 == 0 && ncnn::cpu_support_arm_asimdhp() && opt.use_fp16_arithmetic && layer->support_fp16_storage)
+                    dst_elempack = 8;
+                else if (elemcount % 4 == 0)
+                    dst_elempack = 4;
+#elif NCNN_AVX512
+                if (elemcount % 16 == 0 && ncnn::cpu_support_x86_avx512())
+                    dst_elempack = 16;
+                else if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
+                    dst_elempack = 8;
+                else if (elemcount % 4 == 0)
+                    dst_elempack = 4;
+#elif NCNN_AVX
+                if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
+                    dst_elempack = 8;
+                else if (elemcount % 4 == 0)
+                    dst_elempack = 4;
 #elif NCNN_RVV || NCNN_XTHEADVECTOR
                 const int packn = ncnn::cpu_riscv_vlenb() / 2;
                 if (elemcount % packn == 0)
@@ -467,212 +2309,630 @@ int NetPrivate::convert_layout(Mat& bottom_blob, const Layer* layer, const Optio
                     dst_elempack = 4;
 #endif
             }
-            if (elembits == 8)
+            if (elembits == 8)
+            {
+#if NCNN_RVV || NCNN_XTHEADVECTOR
+                const int packn = ncnn::cpu_riscv_vlenb() / 1;
+                if (elemcount % packn == 0)
+                    dst_elempack = packn;
+#else
+                if (elemcount % 8 == 0)
+                    dst_elempack = 8;
+#endif
+            }
+        }
+    }
+
+    if (bottom_blob.elempack != dst_elempack)
+    {
+        Mat bottom_blob_packed;
+        convert_packing(bottom_blob, bottom_blob_packed, dst_elempack, opt);
+        bottom_blob = bottom_blob_packed;
+
+        if (bottom_blob.empty())
+            return -100;
+    }
+
+    if (bottom_blob.elembits() == 16)
+    {
+        // clang-format off
+        // *INDENT-OFF*
+
+#if NCNN_ARM82
+        if (opt.use_fp16_storage && cpu_support_arm_asimdhp() && !layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp32;
+            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
+            bottom_blob = bottom_blob_fp32;
+        }
+        else
+#endif // NCNN_ARM82
+#if NCNN_VFPV4
+        if (opt.use_fp16_storage && !opt.use_bf16_storage && cpu_support_arm_vfpv4() && !layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp32;
+            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
+            bottom_blob = bottom_blob_fp32;
+        }
+        else
+#endif // NCNN_VFPV4
+#if NCNN_ZFH
+        if (opt.use_fp16_storage && (ncnn::cpu_support_riscv_zvfh() || (!ncnn::cpu_support_riscv_v() && ncnn::cpu_support_riscv_zfh())) && !layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp32;
+            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
+            bottom_blob = bottom_blob_fp32;
+        }
+        else
+#endif // NCNN_ZFH
+#if NCNN_BF16
+        if (opt.use_bf16_storage && !layer->support_bf16_storage)
+        {
+            Mat bottom_blob_fp32;
+            cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt);
+            bottom_blob = bottom_blob_fp32;
+        }
+        else
+#endif // NCNN_BF16
+        {
+        }
+
+        // *INDENT-ON*
+        // clang-format on
+
+        if (bottom_blob.empty())
+            return -100;
+    }
+
+    return 0;
+}
+
+Allocator* NetPrivate::get_profiler_allocator(Allocator* allocator, int kind) const
+{
+    MutexLockGuard lock(profiler_allocators_lock);
+
+    for (size_t i = 0; i < profiler_allocators.size(); i++)
+    {
+        if (profiler_allocators[i]->allocator == allocator && profiler_allocators[i]->kind == kind)
+        {
+            profiler_allocators[i]->user_count++;
+            return profiler_allocators[i];
+        }
+    }
+
+    // extractors may pass a new allocator every time
+    // drop the counting allocators neither in use nor owning memory
+    if (profiler_allocators.size() >= 16)
+    {
+        size_t j = 0;
+        for (size_t i = 0; i < profiler_allocators.size(); i++)
+        {
+            ProfilerAllocator* a = profiler_allocators[i];
+            if (a->user_count == 0 && NCNN_XADD(&a->payout_count, 0) == 0)
+            {
+                delete a;
+                continue;
+            }
+
+            profiler_allocators[j++] = a;
+        }
+        profiler_allocators.resize(j);
+    }
+
+    ProfilerAllocator* profiler_allocator = new ProfilerAllocator(allocator, kind);
+    profiler_allocator->user_count = 1;
+    profiler_allocators.push_back(profiler_allocator);
+
+    return profiler_allocator;
+}
+
+void NetPrivate::put_profiler_allocator(Allocator* allocator) const
+{
+    MutexLockGuard lock(profiler_allocators_lock);
+
+    for (size_t i = 0; i < profiler_allocators.size(); i++)
+    {
+        if (profiler_allocators[i] == allocator)
+        {
+            profiler_allocators[i]->user_count--;
+            return;
+        }
+    }
+}
+
+bool NetPrivate::is_profiler_allocator(const Allocator* allocator) const
+{
+    MutexLockGuard lock(profiler_allocators_lock);
+
+    for (size_t i = 0; i < profiler_allocators.size(); i++)
+    {
+        if (profiler_allocators[i] == allocator)
+            return true;
+    }
+
+    return false;
+}
+
+int NetPrivate::do_forward_layer(const Layer* layer, std::vector<Mat>& blob_mats, const Option& opt, bool may_convert_layout) const
+{
+    if (layer->one_blob_only)
+    {
+        int bottom_blob_index = layer->bottoms[0];
+        int top_blob_index = layer->tops[0];
+
+        Mat& bottom_blob_ref = blob_mats[bottom_blob_index];
+        Mat bottom_blob;
+
+        if (opt.lightmode)
+        {
+            // deep copy for inplace forward if data is shared
+            if (layer->support_inplace && *bottom_blob_ref.refcount != 1)
             {
-#if NCNN_RVV || NCNN_XTHEADVECTOR
-                const int packn = ncnn::cpu_riscv_vlenb() / 1;
-                if (elemcount % packn == 0)
-                    dst_elempack = packn;
-#else
-                if (elemcount % 8 == 0)
-                    dst_elempack = 8;
-#endif
+                bottom_blob = bottom_blob_ref.clone(opt.blob_allocator);
+                if (bottom_blob.empty())
+                    return -100;
+            }
+        }
+        if (bottom_blob.dims == 0)
+        {
+            bottom_blob = bottom_blob_ref;
+        }
+
+        // the layer takes fp32 pack1 blobs as they are
+        if (may_convert_layout || bottom_blob.elempack != 1 || bottom_blob.elembits() == 16)
+        {
+            int ret = convert_layout(bottom_blob, layer, opt);
+            if (ret != 0)
+                return ret;
+        }
+
+        // forward
+        if (opt.lightmode && layer->support_inplace)
+        {
+            Mat& bottom_top_blob = bottom_blob;
+            int ret = layer->forward_inplace(bottom_top_blob, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blob
+            blob_mats[top_blob_index] = bottom_top_blob;
+        }
+        else
+        {
+            Mat top_blob;
+            int ret = layer->forward(bottom_blob, top_blob, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blob
+            blob_mats[top_blob_index] = top_blob;
+        }
+
+        if (opt.lightmode)
+        {
+            // delete after taken in light mode
+            blob_mats[bottom_blob_index].release();
+        }
+    }
+    else
+    {
+        std::vector<Mat> bottom_blobs(layer->bottoms.size());
+        for (size_t i = 0; i < layer->bottoms.size(); i++)
+        {
+            int bottom_blob_index = layer->bottoms[i];
+
+            Mat& bottom_blob_ref = blob_mats[bottom_blob_index];
+            bottom_blobs[i].release();
+
+            if (opt.lightmode)
+            {
+                // deep copy for inplace forward if data is shared
+                if (layer->support_inplace && *bottom_blob_ref.refcount != 1)
+                {
+                    bottom_blobs[i] = bottom_blob_ref.clone(opt.blob_allocator);
+                    if (bottom_blobs[i].empty())
+                        return -100;
+                }
+            }
+            if (bottom_blobs[i].dims == 0)
+            {
+                bottom_blobs[i] = bottom_blob_ref;
+            }
+
+            if (may_convert_layout || bottom_blobs[i].elempack != 1 || bottom_blobs[i].elembits() == 16)
+            {
+                int ret = convert_layout(bottom_blobs[i], layer, opt);
+                if (ret != 0)
+                    return ret;
+            }
+        }
+
+        if (opt.lightmode)
+        {
+            for (size_t i = 0; i < layer->bottoms.size(); i++)
+            {
+                int bottom_blob_index = layer->bottoms[i];
+
+                // delete after taken in light mode
+                // released before forward so that a blob nobody else holds reaches the layer with refcount 1
+                blob_mats[bottom_blob_index].release();
+            }
+        }
+
+        // forward
+        if (opt.lightmode && layer->support_inplace)
+        {
+            std::vector<Mat>& bottom_top_blobs = bottom_blobs;
+            int ret = layer->forward_inplace(bottom_top_blobs, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blobs
+            for (size_t i = 0; i < layer->tops.size(); i++)
+            {
+                int top_blob_index = layer->tops[i];
+
+                blob_mats[top_blob_index] = bottom_top_blobs[i];
+            }
+        }
+        else
+        {
+            std::vector<Mat> top_blobs(layer->tops.size());
+            int ret = layer->forward(bottom_blobs, top_blobs, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blobs
+            for (size_t i = 0; i < layer->tops.size(); i++)
+            {
+                int top_blob_index = layer->tops[i];
+
+                blob_mats[top_blob_index] = top_blobs[i];
             }
         }
     }
 
-    if (bottom_blob.elempack != dst_elempack)
+    return 0;
+}
+
+int NetPrivate::do_forward_layer_stacked(const Layer* layer, std::vector<std::vector<Mat> >& batch_blob_mats, const Option& opt) const
+{
+    const int batch = (int)batch_blob_mats.size();
+    const int bottom_blob_index = layer->bottoms[0];
+    const int top_blob_index = layer->tops[0];
+
+    const Mat bottom_blob0 = batch_blob_mats[0][bottom_blob_index];
+
+    // 1-dim sample is one row, 2-dim sample is h rows, 3-dim sample is one depth slice
+    bool stack_rows = layer->support_batch_stacking && (bottom_blob0.dims == 2 || (bottom_blob0.dims == 1 && layer->typeindex == LayerType::InnerProduct));
+    bool stack_depth = layer->support_batch_depth_stacking && bottom_blob0.dims == 3;
+    for (int b = 1; b < batch && (stack_rows || stack_depth); b++)
     {
-        Mat bottom_blob_packed;
-        convert_packing(bottom_blob, bottom_blob_packed, dst_elempack, opt);
-        bottom_blob = bottom_blob_packed;
+        const Mat& m = batch_blob_mats[b][bottom_blob_index];
+        if (m.dims != bottom_blob0.dims || m.w != bottom_blob0.w || m.h != bottom_blob0.h || m.c != bottom_blob0.c || m.elemsize != bottom_blob0.elemsize || m.elempack != bottom_blob0.elempack)
+        {
+            stack_rows = false;
+            stack_depth = false;
+        }
+    }
+
+    Option opt_stack = opt;
+    opt_stack.blob_allocator = opt.workspace_allocator;
 
+    const size_t elemsize = bottom_blob0.elemsize / bottom_blob0.elempack;
+    const int w = bottom_blob0.dims == 1 ? bottom_blob0.w * bottom_blob0.elempack : bottom_blob0.w;
+    const int rows = bottom_blob0.dims == 1 ? 1 : bottom_blob0.h * bottom_blob0.elempack;
+
+    Mat bottom_blob;
+    if (stack_rows)
+    {
+        bottom_blob.create(w, rows * batch, elemsize, opt.workspace_allocator);
         if (bottom_blob.empty())
             return -100;
+
+        for (int b = 0; b < batch; b++)
+        {
+            Mat m = batch_blob_mats[b][bottom_blob_index];
+            if (m.dims == 2 && m.elempack != 1)
+            {
+                Mat m_unpacked;
+                convert_packing(m, m_unpacked, 1, opt_stack);
+                if (m_unpacked.empty())
+                    return -100;
+
+                m = m_unpacked;
+            }
+
+            memcpy(bottom_blob.row<unsigned char>(b * rows), m.data, (size_t)w * rows * elemsize);
+        }
     }
+    else if (stack_depth)
+    {
+        bottom_blob.create(bottom_blob0.w, bottom_blob0.h, batch, bottom_blob0.c, bottom_blob0.elemsize, bottom_blob0.elempack, opt.workspace_allocator);
+        if (bottom_blob.empty())
+            return -100;
 
-    if (bottom_blob.elembits() == 16)
+        const size_t plane_size = (size_t)bottom_blob0.w * bottom_blob0.h * bottom_blob0.elemsize;
+        for (int q = 0; q < bottom_blob0.c; q++)
+        {
+            unsigned char* outptr = bottom_blob.channel(q);
+            for (int b = 0; b < batch; b++)
+            {
+                const Mat& m = batch_blob_mats[b][bottom_blob_index];
+                memcpy(outptr + plane_size * b, m.channel(q).data, plane_size);
+            }
+        }
+    }
+
+    Mat top_blob;
+    if (stack_rows || stack_depth)
     {
-        // clang-format off
-        // *INDENT-OFF*
+        int ret = convert_layout(bottom_blob, layer, opt);
+        if (ret != 0)
+            return ret;
 
-#if NCNN_ARM82
-        if (opt.use_fp16_storage && cpu_support_arm_asimdhp() && !layer->support_fp16_storage)
+        if (layer->one_blob_only)
         {
-            Mat bottom_blob_fp32;
-            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
-            bottom_blob = bottom_blob_fp32;
+            ret = layer->forward(bottom_blob, top_blob, opt);
         }
         else
-#endif // NCNN_ARM82
-#if NCNN_VFPV4
-        if (opt.use_fp16_storage && !opt.use_bf16_storage && cpu_support_arm_vfpv4() && !layer->support_fp16_storage)
         {
-            Mat bottom_blob_fp32;
-            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
-            bottom_blob = bottom_blob_fp32;
+            std::vector<Mat> bottom_blobs(1, bottom_blob);
+            std::vector<Mat> top_blobs(1);
+            ret = layer->forward(bottom_blobs, top_blobs, opt);
+            top_blob = top_blobs[0];
+        }
+        if (ret != 0)
+            return ret;
+
+        // rows must map to rows, which is not the case for a flattening InnerProduct
+        if (stack_rows && (top_blob.dims != 2 || top_blob.h * top_blob.elempack != rows * batch))
+            stack_rows = false;
+        if (stack_depth && (top_blob.dims != 4 || top_blob.d != batch))
+            stack_depth = false;
+    }
+
+    if (!stack_rows && !stack_depth)
+    {
+        for (int b = 0; b < batch; b++)
+        {
+            int ret = do_forward_layer(layer, batch_blob_mats[b], opt);
+            if (ret != 0)
+                return ret;
+        }
+
+        return 0;
+    }
+
+    if (stack_depth)
+    {
+        const size_t out_plane_size = (size_t)top_blob.w * top_blob.h * top_blob.elemsize;
+
+        for (int b = 0; b < batch; b++)
+        {
+            Mat top;
+            top.create(top_blob.w, top_blob.h, top_blob.c, top_blob.elemsize, top_blob.elempack, opt.blob_allocator);
+            if (top.empty())
+                return -100;
+
+            for (int q = 0; q < top_blob.c; q++)
+            {
+                memcpy(top.channel(q).data, (const unsigned char*)top_blob.channel(q).data + out_plane_size * b, out_plane_size);
+            }
+
+            batch_blob_mats[b][top_blob_index] = top;
         }
-        else
-#endif // NCNN_VFPV4
-#if NCNN_ZFH
-        if (opt.use_fp16_storage && (ncnn::cpu_support_riscv_zvfh() || (!ncnn::cpu_support_riscv_v() && ncnn::cpu_support_riscv_zfh())) && !layer->support_fp16_storage)
+    }
+    else
+    {
+        const size_t out_elemsize = top_blob.elemsize / top_blob.elempack;
+        const int out_w = top_blob.w;
+
+        // keep the output packing only if samples split at packed row boundaries
+        if (top_blob.elempack != 1 && (bottom_blob0.dims == 1 || rows % top_blob.elempack != 0))
         {
-            Mat bottom_blob_fp32;
-            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
-            bottom_blob = bottom_blob_fp32;
+            Mat top_blob_unpacked;
+            convert_packing(top_blob, top_blob_unpacked, 1, opt_stack);
+            if (top_blob_unpacked.empty())
+                return -100;
+
+            top_blob = top_blob_unpacked;
         }
-        else
-#endif // NCNN_ZFH
-#if NCNN_BF16
-        if (opt.use_bf16_storage && !layer->support_bf16_storage)
+
+        const int out_packed_rows = rows / top_blob.elempack;
+
+        for (int b = 0; b < batch; b++)
         {
-            Mat bottom_blob_fp32;
-            cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt);
-            bottom_blob = bottom_blob_fp32;
+            Mat top;
+            if (bottom_blob0.dims == 1)
+            {
+                top.create(out_w, out_elemsize, opt.blob_allocator);
+            }
+            else
+            {
+                top.create(out_w, out_packed_rows, top_blob.elemsize, top_blob.elempack, opt.blob_allocator);
+            }
+            if (top.empty())
+                return -100;
+
+            memcpy(top.data, top_blob.row<const unsigned char>(b * out_packed_rows), top.total() * top.elemsize);
+
+            batch_blob_mats[b][top_blob_index] = top;
         }
-        else
-#endif // NCNN_BF16
+    }
+
+    if (opt.lightmode)
+    {
+        for (int b = 0; b < batch; b++)
         {
+            // delete after taken in light mode
+            batch_blob_mats[b][bottom_blob_index].release();
         }
+    }
 
-        // *INDENT-ON*
-        // clang-format on
+    return 0;
+}
 
-        if (bottom_blob.empty())
-            return -100;
+// copy frames [x, x + outw) of each row along w
+static int copy_stream_frames(const Mat& src, Mat& dst, int x, int outw, Allocator* allocator)
+{
+    dst.create(outw, src.h, src.elemsize, src.elempack, allocator);
+    if (dst.empty())
+        return -100;
+
+    for (int i = 0; i < src.h; i++)
+    {
+        memcpy(dst.row<unsigned char>(i), src.row<const unsigned char>(i) + x * src.elemsize, outw * src.elemsize);
     }
 
     return 0;
 }
 
-int NetPrivate::do_forward_layer(const Layer* layer, std::vector<Mat>& blob_mats, const Option& opt) const
+// join two blobs of the same rows along w
+static int concat_stream_frames(const Mat& a, const Mat& b, Mat& dst, Allocator* allocator)
 {
-    if (layer->one_blob_only)
+    if (a.h != b.h || a.elemsize != b.elemsize || a.elempack != b.elempack)
+        return -1;
+
+    dst.create(a.w + b.w, a.h, a.elemsize, a.elempack, allocator);
+    if (dst.empty())
+        return -100;
+
+    for (int i = 0; i < a.h; i++)
     {
-        int bottom_blob_index = layer->bottoms[0];
-        int top_blob_index = layer->tops[0];
+        unsigned char* outptr = dst.row<unsigned char>(i);
+        memcpy(outptr, a.row<const unsigned char>(i), a.w * a.elemsize);
+        memcpy(outptr + a.w * a.elemsize, b.row<const unsigned char>(i), b.w * b.elemsize);
+    }
 
-        Mat& bottom_blob_ref = blob_mats[bottom_blob_index];
-        Mat bottom_blob;
+    return 0;
+}
 
-        if (opt.lightmode)
+int NetPrivate::do_forward_layer_streaming(int layer_index, StreamLayerState& state, std::vector<Mat>& blob_mats, const Option& opt) const
+{
+    const Layer* layer = layers[layer_index];
+    const StreamLayerInfo& info = stream_layers[layer_index];
+
+    if (info.type == -1)
+    {
+        NCNN_LOGE("layer %d is not causal and can not be streamed", layer_index);
+        return -1;
+    }
+
+    const int bottom_blob_index = layer->bottoms[0];
+    const int top_blob_index = layer->tops[0];
+
+    Mat bottom_blob = blob_mats[bottom_blob_index];
+
+    int ret = convert_layout(bottom_blob, layer, opt);
+    if (ret != 0)
+        return ret;
+
+    if (info.type == 1 || info.type == 3)
+    {
+        // hidden states are zero initialized for the first chunk, the kv cache is empty
+        if (info.type == 3 && state.states.empty())
         {
-            // deep copy for inplace forward if data is shared
-            if (layer->support_inplace && *bottom_blob_ref.refcount != 1)
-            {
-                bottom_blob = bottom_blob_ref.clone(opt.blob_allocator);
-                if (bottom_blob.empty())
-                    return -100;
-            }
+            state.states.resize(info.state_count);
         }
-        if (bottom_blob.dims == 0)
+
+        std::vector<Mat> bottom_blobs(layer->bottoms.size() + state.states.size());
+        bottom_blobs[0] = bottom_blob;
+        for (size_t i = 1; i < layer->bottoms.size(); i++)
         {
-            bottom_blob = bottom_blob_ref;
+            bottom_blobs[i] = blob_mats[layer->bottoms[i]];
+
+            ret = convert_layout(bottom_blobs[i], layer, opt);
+            if (ret != 0)
+                return ret;
+        }
+        for (size_t i = 0; i < state.states.size(); i++)
+        {
+            // hand the state over, a state still shared with a copied extractor is not updated in place
+            bottom_blobs[layer->bottoms.size() + i] = state.states[i];
+            state.states[i].release();
         }
 
-        int ret = convert_layout(bottom_blob, layer, opt);
+        std::vector<Mat> top_blobs(1 + info.state_count);
+        ret = layer->forward(bottom_blobs, top_blobs, opt);
         if (ret != 0)
             return ret;
 
-        // forward
-        if (opt.lightmode && layer->support_inplace)
+        blob_mats[top_blob_index] = top_blobs[0];
+        state.states.assign(top_blobs.begin() + 1, top_blobs.end());
+    }
+    else
+    {
+        if (bottom_blob.dims != 2)
         {
-            Mat& bottom_top_blob = bottom_blob;
-            int ret = layer->forward_inplace(bottom_top_blob, opt);
-            if (ret != 0)
-                return ret;
+            NCNN_LOGE("layer %d streaming input dims %d is not 2", layer_index, bottom_blob.dims);
+            return -1;
+        }
 
-            // store top blob
-            blob_mats[top_blob_index] = bottom_top_blob;
+        // the chunk follows the left context
+        Mat frames;
+        if (state.context.empty())
+        {
+            frames = bottom_blob;
         }
         else
         {
-            Mat top_blob;
-            int ret = layer->forward(bottom_blob, top_blob, opt);
+            ret = concat_stream_frames(state.context, bottom_blob, frames, opt.workspace_allocator);
             if (ret != 0)
                 return ret;
-
-            // store top blob
-            blob_mats[top_blob_index] = top_blob;
         }
 
-        if (opt.lightmode)
+        // frames lost to the padding replayed in front of the left context
+        const int skip = state.output_count - state.context_start / info.stride;
+
+        const int outw = info.pad_left + frames.w < info.kernel_extent ? 0 : (info.pad_left + frames.w - info.kernel_extent) / info.stride + 1;
+        if (outw <= skip)
         {
-            // delete after taken in light mode
-            blob_mats[bottom_blob_index].release();
+            NCNN_LOGE("layer %d streaming chunk %d is too short for a new frame", layer_index, bottom_blob.w);
+            return -1;
         }
-    }
-    else
-    {
-        std::vector<Mat> bottom_blobs(layer->bottoms.size());
-        for (size_t i = 0; i < layer->bottoms.size(); i++)
-        {
-            int bottom_blob_index = layer->bottoms[i];
-
-            Mat& bottom_blob_ref = blob_mats[bottom_blob_index];
-            bottom_blobs[i].release();
 
-            if (opt.lightmode)
-            {
-                // deep copy for inplace forward if data is shared
-                if (layer->support_inplace && *bottom_blob_ref.refcount != 1)
-                {
-                    bottom_blobs[i] = bottom_blob_ref.clone(opt.blob_allocator);
-                    if (bottom_blobs[i].empty())
-                        return -100;
-                }
-            }
-            if (bottom_blobs[i].dims == 0)
-            {
-                bottom_blobs[i] = bottom_blob_ref;
-            }
+        Mat top_blob;
+        ret = layer->forward(frames, top_blob, opt);
+        if (ret != 0)
+            return ret;
 
-            int ret = convert_layout(bottom_blobs[i], layer, opt);
+        if (skip > 0)
+        {
+            Mat top_blob_new;
+            ret = copy_stream_frames(top_blob, top_blob_new, skip, top_blob.w - skip, opt.blob_allocator);
             if (ret != 0)
                 return ret;
+
+            top_blob = top_blob_new;
         }
 
-        // forward
-        if (opt.lightmode && layer->support_inplace)
-        {
-            std::vector<Mat>& bottom_top_blobs = bottom_blobs;
-            int ret = layer->forward_inplace(bottom_top_blobs, opt);
-            if (ret != 0)
-                return ret;
+        state.output_count += top_blob.w;
 
-            // store top blobs
-            for (size_t i = 0; i < layer->tops.size(); i++)
-            {
-                int top_blob_index = layer->tops[i];
+        // keep the frames the next output window starts from
+        const int context_start = std::max(state.output_count * info.stride - info.pad_left, 0);
+        const int context_offset = context_start - state.context_start;
 
-                blob_mats[top_blob_index] = bottom_top_blobs[i];
-            }
-        }
-        else
+        Mat context;
+        if (context_offset < frames.w)
         {
-            std::vector<Mat> top_blobs(layer->tops.size());
-            int ret = layer->forward(bottom_blobs, top_blobs, opt);
+            ret = copy_stream_frames(frames, context, context_offset, frames.w - context_offset, opt.blob_allocator);
             if (ret != 0)
                 return ret;
+        }
 
-            // store top blobs
-            for (size_t i = 0; i < layer->tops.size(); i++)
-            {
-                int top_blob_index = layer->tops[i];
+        state.context = context;
+        state.context_start = context_start;
 
-                blob_mats[top_blob_index] = top_blobs[i];
-            }
-        }
+        blob_mats[top_blob_index] = top_blob;
+    }
 
-        if (opt.lightmode)
+    if (opt.lightmode)
+    {
+        // delete after taken in light mode
+        for (size_t i = 0; i < layer->bottoms.size(); i++)
         {
-            for (size_t i = 0; i < layer->bottoms.size(); i++)
-            {
-                int bottom_blob_index = layer->bottoms[i];
-
-                // delete after taken in light mode
-                blob_mats[bottom_blob_index].release();
-            }
+            blob_mats[layer->bottoms[i]].release();
         }
     }
 
@@ -993,6 +3253,8 @@ int Net::load_param(const DataReader& dr)
     }
 
     d->layers.resize((size_t)layer_count);
+    d->stream_layers.clear();
+    d->stream_layers.resize((size_t)layer_count);
     d->blobs.resize((size_t)blob_count);
 
 #if NCNN_VULKAN
@@ -1240,6 +3502,8 @@ int Net::load_param(const DataReader& dr)
             layer = layer_cpu;
         }
 
+        d->stream_layers[i] = get_stream_layer_info(layer, pd);
+
         d->layers[i] = layer;
     }
 
@@ -1292,6 +3556,8 @@ int Net::load_param_bin(const DataReader& dr)
     }
 
     d->layers.resize(layer_count);
+    d->stream_layers.clear();
+    d->stream_layers.resize(layer_count);
     d->blobs.resize(blob_count);
 
 #if NCNN_VULKAN
@@ -1521,6 +3787,8 @@ int Net::load_param_bin(const DataReader& dr)
             layer = layer_cpu;
         }
 
+        d->stream_layers[i] = get_stream_layer_info(layer, pd);
+
         d->layers[i] = layer;
     }
 
@@ -1555,6 +3823,21 @@ int Net::load_model(const DataReader& dr)
     }
 #endif // NCNN_VULKAN
 
+    // pipelines are created when the layers are first forwarded
+    bool lazy_create_pipeline = opt.use_lazy_create_pipeline && !opt.use_vulkan_compute;
+
+    // weights must be read in order, pipelines are independent of each other
+    bool parallel_create_pipeline = opt.use_parallel_create_pipeline && !opt.use_vulkan_compute && opt.num_threads > 1 && !lazy_create_pipeline;
+
+    if (lazy_create_pipeline)
+    {
+        d->pipeline_created.assign(layer_count, 0);
+    }
+    else
+    {
+        d->pipeline_created.clear();
+    }
+
     ModelBinFromDataReader mb(dr);
     for (int i = 0; i < layer_count; i++)
     {
@@ -1580,6 +3863,9 @@ int Net::load_model(const DataReader& dr)
             break;
         }
 
+        if (parallel_create_pipeline || lazy_create_pipeline)
+            continue;
+
         Option opt1 = get_masked_option(opt, layer->featmask);
 
         int cret = layer->create_pipeline(opt1);
@@ -1595,6 +3881,36 @@ int Net::load_model(const DataReader& dr)
         }
     }
 
+    if (ret == 0 && parallel_create_pipeline)
+    {
+        // every layer keeps the full opt.num_threads, so weights are laid out the same as created one by one
+        std::vector<int> cret(layer_count, 0);
+
+        #pragma omp parallel for schedule(dynamic) num_threads(opt.num_threads)
+        for (int i = 0; i < layer_count; i++)
+        {
+            Layer* layer = d->layers[i];
+
+            Option opt1 = get_masked_option(opt, layer->featmask);
+
+            cret[i] = layer->create_pipeline(opt1);
+        }
+
+        for (int i = 0; i < layer_count; i++)
+        {
+            if (cret[i] != 0)
+            {
+#if NCNN_STRING
+                NCNN_LOGE("layer create_pipeline %d %s failed", i, d->layers[i]->name.c_str());
+#else
+                NCNN_LOGE("layer create_pipeline %d failed", i);
+#endif
+                ret = -1;
+                break;
+            }
+        }
+    }
+
     if (opt.use_local_pool_allocator)
     {
         if (opt.blob_allocator == 0)
@@ -1694,6 +4010,24 @@ int Net::load_model(const char* modelpath)
     fclose(fp);
     return ret;
 }
+
+int Net::load_model_mmap(const char* modelpath)
+{
+    DataReaderFromMmap* model_mmap = new DataReaderFromMmap(modelpath);
+    if (model_mmap->empty())
+    {
+        delete model_mmap;
+        return -1;
+    }
+
+    int ret = load_model(*model_mmap);
+
+    // weights loaded before may still reference the previous mapping until now
+    delete d->model_mmap;
+    d->model_mmap = model_mmap;
+
+    return ret;
+}
 #endif // NCNN_STDIO
 
 int Net::load_param(const unsigned char* _mem)
@@ -1785,13 +4119,19 @@ void Net::clear()
     {
         Layer* layer = d->layers[i];
 
-        Option opt1 = get_masked_option(opt, layer->featmask);
+        // deferred pipeline never created
+        bool pipeline_created = d->pipeline_created.empty() || d->pipeline_created[i];
 
-        int dret = layer->destroy_pipeline(opt1);
-        if (dret != 0)
+        if (pipeline_created)
         {
-            NCNN_LOGE("layer destroy_pipeline failed");
-            // ignore anyway
+            Option opt1 = get_masked_option(opt, layer->featmask);
+
+            int dret = layer->destroy_pipeline(opt1);
+            if (dret != 0)
+            {
+                NCNN_LOGE("layer destroy_pipeline failed");
+                // ignore anyway
+            }
         }
 
         if (layer->typeindex & ncnn::LayerType::CustomBit)
@@ -1831,6 +4171,39 @@ void Net::clear()
         }
     }
     d->layers.clear();
+    d->stream_layers.clear();
+    d->pipeline_created.clear();
+
+#if NCNN_STDIO
+    if (d->model_mmap)
+    {
+        delete d->model_mmap;
+        d->model_mmap = 0;
+    }
+#endif // NCNN_STDIO
+
+    for (size_t i = 0; i < d->memory_plans.size(); i++)
+    {
+        delete d->memory_plans[i];
+    }
+    d->memory_plans.clear();
+
+    for (size_t i = 0; i < d->execution_plans.size(); i++)
+    {
+        delete d->execution_plans[i];
+    }
+    d->execution_plans.clear();
+
+    for (size_t i = 0; i < d->profiler_allocators.size(); i++)
+    {
+        delete d->profiler_allocators[i];
+    }
+    d->profiler_allocators.clear();
+
+#if NCNN_THREADS
+    delete d->parallel_branch_pool;
+    d->parallel_branch_pool = 0;
+#endif // NCNN_THREADS
 
     if (d->local_blob_allocator)
     {
@@ -2037,11 +4410,29 @@ public:
     ExtractorPrivate(const Net* _net)
         : net(_net)
     {
+        memory_plan_allocator = 0;
+        streaming = false;
+        stream_chunk_extracted = false;
     }
     const Net* net;
     std::vector<Mat> blob_mats;
     Option opt;
 
+    // copy of the net option extension with the profiler of this extractor
+    // opt.extension points here once set_profiler is called
+    OptionExtension opt_extension;
+
+    MemoryPlanAllocator* memory_plan_allocator;
+
+    bool streaming;
+    // the next input starts a new chunk
+    bool stream_chunk_extracted;
+    // state of each layer in the current stream
+    std::vector<StreamLayerState> stream_states;
+
+    // blob mats of each sample for batched input
+    std::vector<std::vector<Mat> > batch_blob_mats;
+
 #if NCNN_VULKAN
     VkAllocator* local_blob_vkallocator;
     VkAllocator* local_staging_vkallocator;
@@ -2071,15 +4462,39 @@ Extractor::~Extractor()
 {
     clear();
 
+    delete d->memory_plan_allocator;
+
     delete d;
 }
 
+static void detach_memory_planned_blobs(std::vector<Mat>& blob_mats, const MemoryPlanAllocator* allocator, Allocator* blob_allocator = 0)
+{
+    if (!allocator)
+        return;
+
+    // copy the blobs out of the arenas of the extractor
+    for (size_t i = 0; i < blob_mats.size(); i++)
+    {
+        if (blob_mats[i].allocator == allocator)
+            blob_mats[i] = blob_mats[i].clone(blob_allocator);
+    }
+}
+
 Extractor::Extractor(const Extractor& rhs)
     : d(new ExtractorPrivate(0))
 {
     d->net = rhs.d->net;
     d->blob_mats = rhs.d->blob_mats;
     d->opt = rhs.d->opt;
+    d->opt_extension = rhs.d->opt_extension;
+    if (rhs.d->opt.extension == &rhs.d->opt_extension)
+        d->opt.extension = &d->opt_extension;
+    d->batch_blob_mats = rhs.d->batch_blob_mats;
+    d->streaming = rhs.d->streaming;
+    d->stream_chunk_extracted = rhs.d->stream_chunk_extracted;
+    d->stream_states = rhs.d->stream_states;
+
+    detach_memory_planned_blobs(d->blob_mats, rhs.d->memory_plan_allocator);
 
 #if NCNN_VULKAN
     d->local_blob_vkallocator = 0;
@@ -2097,6 +4512,15 @@ Extractor& Extractor::operator=(const Extractor& rhs)
     d->net = rhs.d->net;
     d->blob_mats = rhs.d->blob_mats;
     d->opt = rhs.d->opt;
+    d->opt_extension = rhs.d->opt_extension;
+    if (rhs.d->opt.extension == &rhs.d->opt_extension)
+        d->opt.extension = &d->opt_extension;
+    d->batch_blob_mats = rhs.d->batch_blob_mats;
+    d->streaming = rhs.d->streaming;
+    d->stream_chunk_extracted = rhs.d->stream_chunk_extracted;
+    d->stream_states = rhs.d->stream_states;
+
+    detach_memory_planned_blobs(d->blob_mats, rhs.d->memory_plan_allocator);
 
 #if NCNN_VULKAN
     d->local_blob_vkallocator = 0;
@@ -2111,6 +4535,12 @@ Extractor& Extractor::operator=(const Extractor& rhs)
 void Extractor::clear()
 {
     d->blob_mats.clear();
+    d->batch_blob_mats.clear();
+
+    if (d->memory_plan_allocator)
+    {
+        d->memory_plan_allocator->clear();
+    }
 
 #if NCNN_VULKAN
     if (d->opt.use_vulkan_compute)
@@ -2136,6 +4566,24 @@ void Extractor::set_light_mode(bool enable)
     d->opt.lightmode = enable;
 }
 
+void Extractor::set_streaming(bool enable)
+{
+    d->streaming = enable;
+
+    reset_stream();
+}
+
+void Extractor::reset_stream()
+{
+    d->stream_chunk_extracted = false;
+    d->stream_states.clear();
+
+    if (d->streaming)
+    {
+        d->stream_states.resize(d->net->layers().size());
+    }
+}
+
 void Extractor::set_num_threads(int num_threads)
 {
     NCNN_LOGE("ex.set_num_threads() is no-op, please set net.opt.num_threads=N before net.load_param()");
@@ -2152,6 +4600,19 @@ void Extractor::set_workspace_allocator(Allocator* allocator)
     d->opt.workspace_allocator = allocator;
 }
 
+void Extractor::set_profiler(Profiler* profiler)
+{
+    // the extension of the net is shared by all its extractors
+    if (d->opt.extension != &d->opt_extension)
+    {
+        if (d->opt.extension)
+            d->opt_extension = *d->opt.extension;
+        d->opt.extension = &d->opt_extension;
+    }
+
+    d->opt_extension.profiler = profiler;
+}
+
 #if NCNN_VULKAN
 void Extractor::set_vulkan_compute(bool enable)
 {
@@ -2211,6 +4672,42 @@ int Extractor::extract(const char* blob_name, Mat& feat, int type)
 
     return extract(blob_index, feat, type);
 }
+
+int Extractor::input(const char* blob_name, const std::vector<Mat>& in)
+{
+    int blob_index = d->net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+    {
+        NCNN_LOGE("Try");
+        const std::vector<const char*>& input_names = d->net->input_names();
+        for (size_t i = 0; i < input_names.size(); i++)
+        {
+            NCNN_LOGE("    ex.input(\"%s\", in%d);", input_names[i], (int)i);
+        }
+
+        return -1;
+    }
+
+    return input(blob_index, in);
+}
+
+int Extractor::extract(const char* blob_name, std::vector<Mat>& feats, int type)
+{
+    int blob_index = d->net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+    {
+        NCNN_LOGE("Try");
+        const std::vector<const char*>& output_names = d->net->output_names();
+        for (size_t i = 0; i < output_names.size(); i++)
+        {
+            NCNN_LOGE("    ex.extract(\"%s\", out%d);", output_names[i], (int)i);
+        }
+
+        return -1;
+    }
+
+    return extract(blob_index, feats, type);
+}
 #endif // NCNN_STRING
 
 int Extractor::input(int blob_index, const Mat& in)
@@ -2218,11 +4715,97 @@ int Extractor::input(int blob_index, const Mat& in)
     if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
         return -1;
 
+    if (d->streaming && d->stream_chunk_extracted)
+    {
+        // blobs of the previous chunk
+        for (size_t i = 0; i < d->blob_mats.size(); i++)
+        {
+            d->blob_mats[i].release();
+        }
+
+        d->stream_chunk_extracted = false;
+    }
+
     d->blob_mats[blob_index] = in;
 
     return 0;
 }
 
+static int convert_extracted_blob(Mat& feat, int type, const Option& opt)
+{
+    if (opt.use_packing_layout && (type == 0) && feat.elempack != 1)
+    {
+        Mat bottom_blob_unpacked;
+        convert_packing(feat, bottom_blob_unpacked, 1, opt);
+        feat = bottom_blob_unpacked;
+        if (feat.empty())
+            return -100;
+    }
+
+    // clang-format off
+    // *INDENT-OFF*
+#if NCNN_ARM82
+    if (opt.use_fp16_storage && cpu_support_arm_asimdhp() && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_float16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_ARM82
+#if NCNN_VFPV4
+    if (opt.use_fp16_storage && !opt.use_bf16_storage && cpu_support_arm_vfpv4() && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_float16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_VFPV4
+#if NCNN_ZVFH
+    if (opt.use_fp16_storage && cpu_support_riscv_zvfh() && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_float16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_ZVFH
+#if NCNN_BF16
+    if (opt.use_bf16_storage && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_bfloat16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_BF16
+    if (feat.elembits() == 8 && (type == 0))
+    {
+        Mat feat_fp32;
+        cast_int8_to_float32(feat, feat_fp32, opt);
+        feat = feat_fp32;
+    }
+    // *INDENT-ON*
+    // clang-format on
+    if (feat.empty())
+        return -100;
+
+    return 0;
+}
+
 int Extractor::extract(int blob_index, Mat& feat, int type)
 {
     if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
@@ -2253,6 +4836,23 @@ int Extractor::extract(int blob_index, Mat& feat, int type)
             }
         }
 
+        // count the allocator bytes of each layer
+        Option opt = d->opt;
+        if (get_profiler(opt))
+        {
+            opt.blob_allocator = d->net->d->get_profiler_allocator(opt.blob_allocator, 0);
+            opt.workspace_allocator = d->net->d->get_profiler_allocator(opt.workspace_allocator, 1);
+        }
+
+        if (d->streaming)
+        {
+            ExecutionPlan uncached_plan;
+            const ExecutionPlan* plan = 0;
+            ret = d->net->d->get_execution_plan(layer_index, d->blob_mats, plan, uncached_plan);
+            if (ret == 0)
+                ret = d->net->d->forward_execution_plan(plan, d->blob_mats, opt, &d->stream_states);
+        }
+        else
 #if NCNN_VULKAN
         if (d->opt.use_vulkan_compute)
         {
@@ -2303,12 +4903,38 @@ int Extractor::extract(int blob_index, Mat& feat, int type)
             }
         }
         else
+#endif // NCNN_VULKAN
+        if (d->opt.use_memory_planner)
         {
-            ret = d->net->d->forward_layer(layer_index, d->blob_mats, d->opt);
+            if (!d->memory_plan_allocator)
+            {
+                d->memory_plan_allocator = new MemoryPlanAllocator;
+            }
+
+            ret = d->net->d->forward_memory_planned(blob_index, d->blob_mats, opt, d->memory_plan_allocator);
         }
-#else
-        ret = d->net->d->forward_layer(layer_index, d->blob_mats, d->opt);
-#endif // NCNN_VULKAN
+        else
+        {
+            ret = d->net->d->forward_layer_cpu(layer_index, d->blob_mats, opt);
+        }
+
+        if (get_profiler(opt))
+        {
+            d->net->d->put_profiler_allocator(opt.blob_allocator);
+            d->net->d->put_profiler_allocator(opt.workspace_allocator);
+        }
+    }
+
+    if (d->streaming)
+    {
+        d->stream_chunk_extracted = true;
+    }
+
+    if (d->memory_plan_allocator && d->opt.lightmode)
+    {
+        // the few blobs kept after forward move off the arena, so the next extract reuses it
+        // and keep them off the local pool allocator as well
+        detach_memory_planned_blobs(d->blob_mats, d->memory_plan_allocator, d->opt.blob_allocator == d->net->d->local_blob_allocator ? 0 : d->opt.blob_allocator);
     }
 
     feat = d->blob_mats[blob_index];
@@ -2316,76 +4942,184 @@ int Extractor::extract(int blob_index, Mat& feat, int type)
     // empty is valid for outputs
     if (!feat.empty())
     {
-        if (d->opt.use_packing_layout && (type == 0) && feat.elempack != 1)
+        if (convert_extracted_blob(feat, type, d->opt) != 0)
+            return -100;
+
+        if (get_profiler(d->opt) && d->net->d->is_profiler_allocator(feat.allocator))
         {
-            Mat bottom_blob_unpacked;
-            convert_packing(feat, bottom_blob_unpacked, 1, d->opt);
-            feat = bottom_blob_unpacked;
+            // detach the returned mat from the counting allocator of net
+            feat = feat.clone(d->opt.blob_allocator == d->net->d->local_blob_allocator ? 0 : d->opt.blob_allocator);
             if (feat.empty())
                 return -100;
         }
 
-        // clang-format off
-        // *INDENT-OFF*
-#if NCNN_ARM82
-        if (d->opt.use_fp16_storage && cpu_support_arm_asimdhp() && (type == 0))
+        if (d->opt.use_local_pool_allocator && feat.allocator == d->net->d->local_blob_allocator)
         {
-            if (feat.elembits() == 16)
-            {
-                Mat feat_fp32;
-                cast_float16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
-            }
+            // detach the returned mat from local pool allocator
+            // so we could destroy net instance much earlier
+            feat = feat.clone();
+            if (feat.empty())
+                return -100;
         }
-        else
-#endif // NCNN_ARM82
-#if NCNN_VFPV4
-        if (d->opt.use_fp16_storage && !d->opt.use_bf16_storage && cpu_support_arm_vfpv4() && (type == 0))
+
+        if (d->memory_plan_allocator && feat.allocator == d->memory_plan_allocator)
         {
-            if (feat.elembits() == 16)
-            {
-                Mat feat_fp32;
-                cast_float16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
-            }
+            // detach the returned mat from the arena of this extractor
+            // and keep it off the local pool allocator as well
+            feat = feat.clone(d->opt.blob_allocator == d->net->d->local_blob_allocator ? 0 : d->opt.blob_allocator);
+            if (feat.empty())
+                return -100;
         }
-        else
-#endif // NCNN_VFPV4
-#if NCNN_ZVFH
-        if (d->opt.use_fp16_storage && cpu_support_riscv_zvfh() && (type == 0))
+    }
+
+    set_kmp_blocktime(old_blocktime);
+    set_flush_denormals(old_flush_denormals);
+
+    return ret;
+}
+
+int Extractor::input(int blob_index, const std::vector<Mat>& in)
+{
+    if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
+        return -1;
+
+    if (in.empty())
+        return -1;
+
+    if (d->batch_blob_mats.empty())
+    {
+        d->batch_blob_mats.resize(in.size(), std::vector<Mat>(d->blob_mats.size()));
+    }
+
+    if (d->batch_blob_mats.size() != in.size())
+    {
+        NCNN_LOGE("batch size mismatch, %d vs %d", (int)in.size(), (int)d->batch_blob_mats.size());
+        return -1;
+    }
+
+    for (size_t b = 0; b < in.size(); b++)
+    {
+        d->batch_blob_mats[b][blob_index] = in[b];
+    }
+
+    return 0;
+}
+
+int Extractor::extract(int blob_index, std::vector<Mat>& feats, int type)
+{
+    if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
+        return -1;
+
+    const int batch = (int)d->batch_blob_mats.size();
+    if (batch == 0)
+    {
+        NCNN_LOGE("no batched input, call ex.input(blob, std::vector<Mat>) first");
+        return -1;
+    }
+
+    feats.resize(batch);
+
+#if NCNN_VULKAN
+    if (d->opt.use_vulkan_compute)
+    {
+        // forward samples one by one, each with its own blob mats
+        int ret = 0;
+        for (int b = 0; b < batch; b++)
+        {
+            d->blob_mats.swap(d->batch_blob_mats[b]);
+            d->blob_mats_gpu.clear();
+            d->blob_mats_gpu.resize(d->blob_mats.size());
+
+            ret = extract(blob_index, feats[b], type);
+
+            d->blob_mats.swap(d->batch_blob_mats[b]);
+            if (ret != 0)
+                break;
+        }
+
+        d->blob_mats_gpu.clear();
+        d->blob_mats_gpu.resize(d->blob_mats.size());
+
+        return ret;
+    }
+#endif // NCNN_VULKAN
+
+    // all samples must provide the same blobs
+    for (int b = 1; b < batch; b++)
+    {
+        for (size_t i = 0; i < d->blob_mats.size(); i++)
         {
-            if (feat.elembits() == 16)
+            if ((d->batch_blob_mats[b][i].dims == 0) != (d->batch_blob_mats[0][i].dims == 0))
             {
-                Mat feat_fp32;
-                cast_float16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
+                NCNN_LOGE("batched input of sample %d does not match sample 0", b);
+                return -1;
             }
         }
-        else
-#endif // NCNN_ZVFH
-#if NCNN_BF16
-        if (d->opt.use_bf16_storage && (type == 0))
+    }
+
+    int old_blocktime = get_kmp_blocktime();
+    set_kmp_blocktime(d->opt.openmp_blocktime);
+
+    int old_flush_denormals = get_flush_denormals();
+    set_flush_denormals(d->opt.flush_denormals);
+
+    int ret = 0;
+
+    if (d->batch_blob_mats[0][blob_index].dims == 0)
+    {
+        int layer_index = d->net->blobs()[blob_index].producer;
+
+        // use local allocator
+        if (d->opt.use_local_pool_allocator)
         {
-            if (feat.elembits() == 16)
+            if (!d->opt.blob_allocator)
+            {
+                d->opt.blob_allocator = d->net->d->local_blob_allocator;
+            }
+            if (!d->opt.workspace_allocator)
             {
-                Mat feat_fp32;
-                cast_bfloat16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
+                d->opt.workspace_allocator = d->net->d->local_workspace_allocator;
             }
         }
-        else
-#endif // NCNN_BF16
-        if (feat.elembits() == 8 && (type == 0))
+
+        // count the allocator bytes of each layer
+        Option opt = d->opt;
+        if (get_profiler(opt))
         {
-            Mat feat_fp32;
-            cast_int8_to_float32(feat, feat_fp32, d->opt);
-            feat = feat_fp32;
+            opt.blob_allocator = d->net->d->get_profiler_allocator(opt.blob_allocator, 0);
+            opt.workspace_allocator = d->net->d->get_profiler_allocator(opt.workspace_allocator, 1);
         }
-        // *INDENT-ON*
-        // clang-format on
+
+        ret = d->net->d->forward_layer_batch(layer_index, d->batch_blob_mats, opt);
+
+        if (get_profiler(opt))
+        {
+            d->net->d->put_profiler_allocator(opt.blob_allocator);
+            d->net->d->put_profiler_allocator(opt.workspace_allocator);
+        }
+    }
+
+    for (int b = 0; b < batch; b++)
+    {
+        Mat& feat = feats[b];
+
+        feat = d->batch_blob_mats[b][blob_index];
+
+        // empty is valid for outputs
         if (feat.empty())
+            continue;
+
+        if (convert_extracted_blob(feat, type, d->opt) != 0)
             return -100;
 
+        if (get_profiler(d->opt) && d->net->d->is_profiler_allocator(feat.allocator))
+        {
+            // detach the returned mat from the counting allocator of net
+            feat = feat.clone(d->opt.blob_allocator == d->net->d->local_blob_allocator ? 0 : d->opt.blob_allocator);
+            if (feat.empty())
+                return -100;
+        }
+
         if (d->opt.use_local_pool_allocator && feat.allocator == d->net->d->local_blob_allocator)
         {
             // detach the returned mat from local pool allocator
@@ -81,6 +81,13 @@ public:
     // return 0 if success
     int load_model(FILE* fp);
     int load_model(const char* modelpath);
+
+    // map network weight data from model file read-only
+    // weight data kept as is by create_pipeline is referenced from the mapping instead of copied
+    // so the pages are shared with all processes loading the same model file
+    // the mapping is released in clear()
+    // return 0 if success
+    int load_model_mmap(const char* modelpath);
 #endif // NCNN_STDIO
 
     // load network structure from external memory
@@ -181,6 +188,28 @@ public:
     // set workspace memory allocator
     void set_workspace_allocator(Allocator* allocator);
 
+    // record the per-layer timing, blob shapes, layout conversions and allocator bytes
+    // of the following extract calls on cpu, see profiler.h
+    // the profiler must outlive the extract calls, null to stop recording
+    // null by default
+    void set_profiler(Profiler* profiler);
+
+    // enable streaming mode
+    // each input is the next chunk of a stream along time
+    // blobs of the previous chunk are dropped on the next input()
+    // LSTM GRU RNN keep their hidden states across chunks
+    // Convolution1D ConvolutionDepthWise1D Pooling1D keep the trailing input frames as left context
+    // and only the new output frames are produced, the same as for the whole stream at once
+    // these windowed layers must be causal with pad_right = 0, and recurrent layers must be forward only
+    // MultiHeadAttention with kv_cache keeps the projected keys and values of the past chunks
+    // each chunk must be long enough to produce at least one new frame at every layer
+    // streaming always runs on cpu
+    // disabled by default
+    void set_streaming(bool enable);
+
+    // drop the states of the current stream and start a new one
+    void reset_stream();
+
 #if NCNN_VULKAN
     // deprecated, no-op
     // instead, set net.opt.use_vulkan_compute before net.load_param()
@@ -215,6 +244,26 @@ public:
     // type = 1, do not convert fp16/bf16 or / and packing
     int extract(int blob_index, Mat& feat, int type = 0);
 
+#if NCNN_STRING
+    // set batched input by blob name, one mat per sample
+    // samples of all batched inputs must have the same count
+    // return 0 if success
+    int input(const char* blob_name, const std::vector<Mat>& in);
+
+    // get batched result by blob name, one mat per sample
+    // each layer runs for all samples before the next layer
+    // return 0 if success
+    int extract(const char* blob_name, std::vector<Mat>& feats, int type = 0);
+#endif // NCNN_STRING
+
+    // set batched input by blob index
+    // return 0 if success
+    int input(int blob_index, const std::vector<Mat>& in);
+
+    // get batched result by blob index
+    // return 0 if success
+    int extract(int blob_index, std::vector<Mat>& feats, int type = 0);
+
 #if NCNN_VULKAN
 #if NCNN_STRING
     // set input by blob name
@@ -7,12 +7,21 @@
 
 namespace ncnn {
 
+OptionExtension::OptionExtension()
+{
+    version = NCNN_OPTION_EXTENSION_VERSION;
+
+    packed_weight_cache = 0;
+
+    profiler = 0;
+}
+
 Option::Option()
 {
     lightmode = true;
     use_shader_pack8 = false;
     use_subgroup_ops = false;
-    use_reserved_0 = false;
+    use_parallel_create_pipeline = false;
 
     num_threads = get_physical_big_cpu_count();
     blob_allocator = 0;
@@ -44,12 +53,11 @@ Option::Option()
     use_packing_layout = true;
 
     vulkan_device_index = -1;
-    use_reserved_1 = false;
+    use_lazy_create_pipeline = false;
 
     use_tensor_storage = false;
-    use_reserved_1p = false;
-
-    use_reserved_2 = false;
+    use_fp16_packed_weight = false;
+    use_bf16_packed_weight = false;
 
     flush_denormals = 3;
 
@@ -67,9 +75,13 @@ Option::Option()
     use_fp16_uniform = true;
     use_int8_uniform = true;
 
-    use_reserved_9 = false;
-    use_reserved_10 = false;
-    use_reserved_11 = false;
+    use_parallel_branch = false;
+
+    use_memory_planner = false;
+
+    use_execution_plan = false;
+
+    extension = 0;
 }
 
 } // namespace ncnn
@@ -14,6 +14,35 @@ class PipelineCache;
 #endif // NCNN_VULKAN
 
 class Allocator;
+class PackedWeightCache;
+class Profiler;
+
+#define NCNN_OPTION_EXTENSION_VERSION 1
+
+// options that do not fit in the reserved slots of Option
+// Option keeps a single pointer to it, fields are only appended here
+// and each new field bumps NCNN_OPTION_EXTENSION_VERSION
+class NCNN_EXPORT OptionExtension
+{
+public:
+    // default option extension
+    OptionExtension();
+
+public:
+    // NCNN_OPTION_EXTENSION_VERSION this was created with
+    // fields added in a later version must not be read when version is lower
+    int version;
+
+    // cpu packed weight cache
+    // create_pipeline looks up transformed weights here before transforming
+    // null by default
+    PackedWeightCache* packed_weight_cache;
+
+    // per-layer profiler of cpu forward
+    // nothing is recorded when null, null by default
+    Profiler* profiler;
+};
+
 class NCNN_EXPORT Option
 {
 public:
@@ -32,7 +61,11 @@ public:
     // enable subgroup in shader
     bool use_subgroup_ops;
 
-    bool use_reserved_0;
+    // run create_pipeline of all layers concurrently after the weights are read
+    // the transformed weights are the same as the ones created one by one
+    // layers are not created concurrently with vulkan compute
+    // disabled by default
+    bool use_parallel_create_pipeline;
 
     // thread count
     // default value is the one returned by get_cpu_count()
@@ -85,7 +118,7 @@ public:
     bool use_vulkan_compute;
 
     // enable bf16 data type for storage
-    // improve most operator performance on all arm devices, may consume more memory
+    // improve most operator performance on all arm devices and on x86 with avx512 bf16, may consume more memory
     bool use_bf16_storage;
 
     // enable options for gpu inference
@@ -105,12 +138,23 @@ public:
     // the vulkan device
     int vulkan_device_index;
 
-    bool use_reserved_1;
+    // defer create_pipeline of each layer until the layer is first forwarded
+    // layers never reached keep their weights untransformed
+    // layers are not deferred with vulkan compute
+    // disabled by default
+    bool use_lazy_create_pipeline;
 
     bool use_tensor_storage;
 
-    bool use_reserved_1p;
-    bool use_reserved_2;
+    // keep the packed constant weights of x86 gemm and im2col convolution in fp16 with f16c
+    // lossy, the weights stay fp32 unless this is set
+    // disabled by default
+    bool use_fp16_packed_weight;
+
+    // keep the packed constant weights of x86 gemm and im2col convolution in bf16
+    // lossy, takes precedence over use_fp16_packed_weight and needs no f16c
+    // disabled by default
+    bool use_bf16_packed_weight;
 
     // enable DAZ(Denormals-Are-Zero) and FTZ(Flush-To-Zero)
     // default value is 3
@@ -141,9 +185,30 @@ public:
     bool use_fp16_uniform;
     bool use_int8_uniform;
 
-    bool use_reserved_9;
-    bool use_reserved_10;
-    bool use_reserved_11;
+    // run independent branches of the graph concurrently
+    // the num_threads budget is partitioned among the layers running at the same time
+    // gemm and winograd convolution keep the load-time num_threads their packed weights were tiled for
+    // blob_allocator and workspace_allocator must be thread-safe when enabled
+    // disabled by default
+    bool use_parallel_branch;
+
+    // plan the blob memory of each extract call once per input shape
+    // allocations recorded in the first run are packed into one arena by lifetime
+    // and later runs with the same input shapes are served from that arena
+    // workspace memory is planned into the same arena
+    // disabled by default
+    bool use_memory_planner;
+
+    // replay a cached flat layer order instead of the recursive forward
+    // the order is compiled once for each requested blob and set of input blobs
+    // disabled by default
+    bool use_execution_plan;
+
+    // more options, see OptionExtension
+    // it must outlive the net like the allocators
+    // appended after the reserved slots ran out, sizeof(Option) grew by one pointer
+    // null by default
+    OptionExtension* extension;
 };
 
 } // namespace ncnn
@@ -0,0 +1,504 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "packedweightcache.h"
+
+#include "cpu.h"
+#include "datareader.h"
+
+#include <string.h>
+
+namespace ncnn {
+
+// https://en.wikipedia.org/wiki/MurmurHash
+static uint32_t murmur3_32(const unsigned char* data, size_t size, uint32_t seed)
+{
+    uint32_t h = seed;
+
+    const size_t nblocks = size / 4;
+    for (size_t i = 0; i < nblocks; i++)
+    {
+        uint32_t k;
+        memcpy(&k, data + i * 4, 4);
+
+        k *= 0xcc9e2d51;
+        k = (k << 15) | (k >> (32 - 15));
+        k *= 0x1b873593;
+
+        h ^= k;
+        h = (h << 13) | (h >> (32 - 13));
+        h = (h * 5) + 0xe6546b64;
+    }
+
+    const unsigned char* tail = data + nblocks * 4;
+    uint32_t k = 0;
+    switch (size & 3)
+    {
+    case 3:
+        k ^= tail[2] << 16;
+    // fallthrough
+    case 2:
+        k ^= tail[1] << 8;
+    // fallthrough
+    case 1:
+        k ^= tail[0];
+        k *= 0xcc9e2d51;
+        k = (k << 15) | (k >> (32 - 15));
+        k *= 0x1b873593;
+        h ^= k;
+    }
+
+    h ^= (uint32_t)size;
+
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+
+    return h;
+}
+
+static uint64_t murmur3_64(const void* data, size_t size, uint64_t seed)
+{
+    // two independent lanes are enough to make collisions between model versions negligible
+    uint32_t lo = murmur3_32((const unsigned char*)data, size, (uint32_t)seed);
+    uint32_t hi = murmur3_32((const unsigned char*)data, size, (uint32_t)(seed >> 32) ^ 0x9747b28c);
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// the ncnn build and the cpu features decide how weights are packed
+static uint64_t get_cpu_fingerprint()
+{
+    int features[24] = {
+        cpu_support_x86_avx(),
+        cpu_support_x86_fma(),
+        cpu_support_x86_xop(),
+        cpu_support_x86_f16c(),
+        cpu_support_x86_avx2(),
+        cpu_support_x86_avx_vnni(),
+        cpu_support_x86_avx_vnni_int8(),
+        cpu_support_x86_avx_vnni_int16(),
+        cpu_support_x86_avx_ne_convert(),
+        cpu_support_x86_avx512(),
+        cpu_support_x86_avx512_vnni(),
+        cpu_support_x86_avx512_bf16(),
+        cpu_support_x86_avx512_fp16(),
+        cpu_support_arm_neon(),
+        cpu_support_arm_vfpv4(),
+        cpu_support_arm_asimdhp(),
+        cpu_support_arm_asimddp(),
+        cpu_support_arm_asimdfhm(),
+        cpu_support_arm_bf16(),
+        cpu_support_arm_i8mm(),
+        cpu_support_arm_sve(),
+        cpu_support_mips_msa(),
+        cpu_support_riscv_v(),
+        get_cpu_level2_cache_size()
+    };
+
+    uint64_t fingerprint = murmur3_64(features, sizeof(features), 0);
+
+#ifdef NCNN_VERSION_STRING
+    const char* version = NCNN_VERSION_STRING;
+    fingerprint = murmur3_64(version, strlen(version), fingerprint);
+#endif
+
+    return fingerprint;
+}
+
+static const uint32_t PACKED_WEIGHT_CACHE_MAGIC = 0x5750434e; // NCPW
+static const int PACKED_WEIGHT_CACHE_VERSION = 1;
+
+// all headers are 16 bytes aligned, so that packed data could be referenced in place
+struct packed_weight_cache_header
+{
+    uint32_t magic;
+    int version;
+    uint64_t fingerprint;
+    int entry_count;
+    int reserved[3];
+};
+
+struct packed_weight_cache_entry_header
+{
+    uint64_t digest;
+    int dims;
+    int w;
+    int h;
+    int d;
+    int c;
+    int elemsize;
+    int elempack;
+    int reserved[3];
+};
+
+static Mat make_mat(const packed_weight_cache_entry_header& eh, void* data)
+{
+    if (eh.dims == 1)
+        return Mat(eh.w, data, (size_t)eh.elemsize, eh.elempack);
+    if (eh.dims == 2)
+        return Mat(eh.w, eh.h, data, (size_t)eh.elemsize, eh.elempack);
+    if (eh.dims == 3)
+        return Mat(eh.w, eh.h, eh.c, data, (size_t)eh.elemsize, eh.elempack);
+    if (eh.dims == 4)
+        return Mat(eh.w, eh.h, eh.d, eh.c, data, (size_t)eh.elemsize, eh.elempack);
+
+    return Mat();
+}
+
+class PackedWeightCachePrivate
+{
+public:
+    struct packed_weight_cache_artifact
+    {
+        uint64_t digest;
+        Mat packed;
+    };
+
+    // data_size is the byte count left in the reader, -1 when unknown
+    int load(const DataReader& dr, size_t data_size);
+
+    mutable Mutex cache_lock;
+    std::vector<packed_weight_cache_artifact> cache_artifacts;
+};
+
+// reject entry headers that do not describe a mat fitting in data_size bytes
+static bool check_entry_header(const packed_weight_cache_entry_header& eh, size_t data_size)
+{
+    if (eh.dims < 1 || eh.dims > 4)
+        return false;
+
+    if (eh.elempack < 1 || eh.elemsize < eh.elempack || eh.elemsize % eh.elempack != 0)
+        return false;
+
+    const int shape[4] = {eh.w, eh.dims >= 2 ? eh.h : 1, eh.dims == 4 ? eh.d : 1, eh.dims >= 3 ? eh.c : 1};
+
+    size_t size = (size_t)eh.elemsize;
+    for (int i = 0; i < 4; i++)
+    {
+        if (shape[i] < 1 || (size_t)shape[i] > data_size / size)
+            return false;
+
+        size *= shape[i];
+    }
+
+    return true;
+}
+
+PackedWeightCache::PackedWeightCache()
+    : d(new PackedWeightCachePrivate)
+{
+}
+
+PackedWeightCache::~PackedWeightCache()
+{
+    clear();
+
+    delete d;
+}
+
+PackedWeightCache::PackedWeightCache(const PackedWeightCache&)
+    : d(0)
+{
+}
+
+PackedWeightCache& PackedWeightCache::operator=(const PackedWeightCache&)
+{
+    return *this;
+}
+
+void PackedWeightCache::clear()
+{
+    MutexLockGuard lock(d->cache_lock);
+
+    d->cache_artifacts.clear();
+}
+
+int PackedWeightCachePrivate::load(const DataReader& dr, size_t data_size)
+{
+    packed_weight_cache_header header;
+    if (dr.read(&header, sizeof(header)) != sizeof(header))
+    {
+        NCNN_LOGE("read packed weight cache header failed");
+        return -1;
+    }
+
+    if (header.magic != PACKED_WEIGHT_CACHE_MAGIC || header.version != PACKED_WEIGHT_CACHE_VERSION)
+    {
+        NCNN_LOGE("packed weight cache magic or version mismatch");
+        return -1;
+    }
+
+    if (header.fingerprint != get_cpu_fingerprint())
+    {
+        NCNN_LOGE("packed weight cache was written by another ncnn build or cpu, ignored");
+        return -1;
+    }
+
+    size_t remaining = data_size - sizeof(header);
+
+    // every entry takes at least its header
+    if (header.entry_count < 0 || (size_t)header.entry_count > remaining / sizeof(packed_weight_cache_entry_header))
+    {
+        NCNN_LOGE("packed weight cache entry count %d invalid", header.entry_count);
+        return -1;
+    }
+
+    std::vector<packed_weight_cache_artifact> artifacts(header.entry_count);
+
+    for (int i = 0; i < header.entry_count; i++)
+    {
+        packed_weight_cache_entry_header eh;
+        if (remaining < sizeof(eh) || dr.read(&eh, sizeof(eh)) != sizeof(eh))
+        {
+            NCNN_LOGE("read packed weight cache entry failed");
+            return -1;
+        }
+
+        remaining -= sizeof(eh);
+
+        if (!check_entry_header(eh, remaining))
+        {
+            NCNN_LOGE("packed weight cache entry %d invalid", i);
+            return -1;
+        }
+
+        // header only, to know the storage size including channel gaps
+        Mat shape = make_mat(eh, (void*)0);
+
+        const size_t size = shape.total() * shape.elemsize;
+        const size_t padded_size = alignSize(size, 16);
+        if (padded_size > remaining)
+        {
+            NCNN_LOGE("packed weight cache entry %d invalid", i);
+            return -1;
+        }
+
+        remaining -= padded_size;
+
+        Mat packed;
+
+        const void* refbuf = 0;
+        size_t nread = dr.reference(padded_size, &refbuf);
+        if (nread == padded_size && (size_t)refbuf % 16 == 0)
+        {
+            // zero-copy
+            packed = make_mat(eh, (void*)refbuf);
+        }
+        else
+        {
+            packed.create_like(shape);
+            if (packed.empty())
+                return -100;
+
+            if (nread == padded_size)
+            {
+                memcpy(packed.data, refbuf, size);
+            }
+            else if (nread == 0)
+            {
+                if (dr.read(packed.data, size) != size)
+                {
+                    NCNN_LOGE("read packed weight cache data failed");
+                    return -1;
+                }
+
+                unsigned char padding[16];
+                if (padded_size != size && dr.read(padding, padded_size - size) != padded_size - size)
+                {
+                    NCNN_LOGE("read packed weight cache data failed");
+                    return -1;
+                }
+            }
+            else
+            {
+                NCNN_LOGE("read packed weight cache data failed");
+                return -1;
+            }
+        }
+
+        artifacts[i].digest = eh.digest;
+        artifacts[i].packed = packed;
+    }
+
+    MutexLockGuard lock(cache_lock);
+
+    for (size_t i = 0; i < artifacts.size(); i++)
+    {
+        bool exists = false;
+        for (size_t j = 0; j < cache_artifacts.size(); j++)
+        {
+            if (cache_artifacts[j].digest == artifacts[i].digest)
+            {
+                exists = true;
+                break;
+            }
+        }
+
+        if (!exists)
+            cache_artifacts.push_back(artifacts[i]);
+    }
+
+    return 0;
+}
+
+int PackedWeightCache::load(const DataReader& dr)
+{
+    return d->load(dr, (size_t)-1);
+}
+
+#if NCNN_STDIO
+int PackedWeightCache::load(FILE* fp)
+{
+    // bytes left in the file, so that entries are checked before allocating
+    size_t data_size = (size_t)-1;
+    long pos = ftell(fp);
+    if (pos >= 0 && fseek(fp, 0, SEEK_END) == 0)
+    {
+        long end = ftell(fp);
+        if (end >= pos)
+            data_size = (size_t)(end - pos);
+
+        fseek(fp, pos, SEEK_SET);
+    }
+
+    DataReaderFromStdio dr(fp);
+    return d->load(dr, data_size);
+}
+
+int PackedWeightCache::load(const char* cachepath)
+{
+    FILE* fp = fopen(cachepath, "rb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", cachepath);
+        return -1;
+    }
+
+    int ret = load(fp);
+    fclose(fp);
+    return ret;
+}
+
+int PackedWeightCache::save(FILE* fp) const
+{
+    MutexLockGuard lock(d->cache_lock);
+
+    packed_weight_cache_header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PACKED_WEIGHT_CACHE_MAGIC;
+    header.version = PACKED_WEIGHT_CACHE_VERSION;
+    header.fingerprint = get_cpu_fingerprint();
+    header.entry_count = (int)d->cache_artifacts.size();
+
+    if (fwrite(&header, sizeof(header), 1, fp) != 1)
+        return -1;
+
+    for (size_t i = 0; i < d->cache_artifacts.size(); i++)
+    {
+        const Mat& packed = d->cache_artifacts[i].packed;
+
+        packed_weight_cache_entry_header eh;
+        memset(&eh, 0, sizeof(eh));
+        eh.digest = d->cache_artifacts[i].digest;
+        eh.dims = packed.dims;
+        eh.w = packed.w;
+        eh.h = packed.h;
+        eh.d = packed.d;
+        eh.c = packed.c;
+        eh.elemsize = (int)packed.elemsize;
+        eh.elempack = packed.elempack;
+
+        if (fwrite(&eh, sizeof(eh), 1, fp) != 1)
+            return -1;
+
+        const size_t size = packed.total() * packed.elemsize;
+        const size_t padded_size = alignSize(size, 16);
+
+        if (fwrite(packed.data, 1, size, fp) != size)
+            return -1;
+
+        const unsigned char padding[16] = {0};
+        if (padded_size != size && fwrite(padding, 1, padded_size - size, fp) != padded_size - size)
+            return -1;
+    }
+
+    return 0;
+}
+
+int PackedWeightCache::save(const char* cachepath) const
+{
+    FILE* fp = fopen(cachepath, "wb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", cachepath);
+        return -1;
+    }
+
+    int ret = save(fp);
+    fclose(fp);
+    return ret;
+}
+#endif // NCNN_STDIO
+
+int PackedWeightCache::size() const
+{
+    MutexLockGuard lock(d->cache_lock);
+
+    return (int)d->cache_artifacts.size();
+}
+
+int PackedWeightCache::get(uint64_t digest, Mat& packed) const
+{
+    MutexLockGuard lock(d->cache_lock);
+
+    for (size_t i = 0; i < d->cache_artifacts.size(); i++)
+    {
+        if (d->cache_artifacts[i].digest == digest)
+        {
+            packed = d->cache_artifacts[i].packed;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+void PackedWeightCache::put(uint64_t digest, const Mat& packed)
+{
+    if (packed.empty())
+        return;
+
+    MutexLockGuard lock(d->cache_lock);
+
+    for (size_t i = 0; i < d->cache_artifacts.size(); i++)
+    {
+        if (d->cache_artifacts[i].digest == digest)
+            return;
+    }
+
+    PackedWeightCachePrivate::packed_weight_cache_artifact artifact;
+    artifact.digest = digest;
+    artifact.packed = packed;
+    d->cache_artifacts.push_back(artifact);
+}
+
+uint64_t PackedWeightCache::digest(const Mat& weight, const int* params, int param_count, int isa)
+{
+    int shape[7] = {weight.dims, weight.w, weight.h, weight.d, weight.c, (int)weight.elemsize, weight.elempack};
+
+    uint64_t h = murmur3_64(shape, sizeof(shape), (uint64_t)isa);
+    h = murmur3_64(params, param_count * sizeof(int), h);
+
+    // skip the gaps between channels
+    const size_t channel_size = (size_t)weight.w * weight.h * weight.d * weight.elemsize;
+    for (int q = 0; q < weight.c; q++)
+    {
+        h = murmur3_64(weight.channel(q).data, channel_size, h);
+    }
+
+    return h;
+}
+
+} // namespace ncnn
@@ -0,0 +1,154 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef NCNN_PACKEDWEIGHTCACHE_H
+#define NCNN_PACKEDWEIGHTCACHE_H
+
+#include "platform.h"
+
+#include "mat.h"
+#include "option.h"
+
+namespace ncnn {
+
+class DataReader;
+class PackedWeightCachePrivate;
+// weight data transformed in cpu create_pipeline, keyed by digest
+// save it after the first load and load it on the next start to skip the transforms
+class NCNN_EXPORT PackedWeightCache
+{
+public:
+    PackedWeightCache();
+
+    virtual ~PackedWeightCache();
+
+    void clear();
+
+    // load entries saved by save()
+    // the whole file is dropped if it was written by another ncnn build or cpu
+    // return 0 if success
+    int load(const DataReader& dr);
+#if NCNN_STDIO
+    int load(FILE* fp);
+    int load(const char* cachepath);
+#endif // NCNN_STDIO
+
+    // save all entries
+    // return 0 if success
+#if NCNN_STDIO
+    int save(FILE* fp) const;
+    int save(const char* cachepath) const;
+#endif // NCNN_STDIO
+
+    // entry count
+    int size() const;
+
+    // get transformed weight by digest
+    // return 0 if found
+    int get(uint64_t digest, Mat& packed) const;
+
+    // store transformed weight by digest
+    void put(uint64_t digest, const Mat& packed);
+
+public:
+    // digest of the source weight, the transform kind and everything else the transform depends on
+    // isa tells apart the same transform compiled for different instruction sets
+    static uint64_t digest(const Mat& weight, const int* params, int param_count, int isa);
+
+private:
+    PackedWeightCache(const PackedWeightCache&);
+    PackedWeightCache& operator=(const PackedWeightCache&);
+
+private:
+    PackedWeightCachePrivate* const d;
+};
+
+// instruction set of the translation unit including this header
+static inline int packed_weight_cache_isa()
+{
+    int isa = 0;
+#if __SSE2__
+    isa |= 1 << 0;
+#endif
+#if __AVX__
+    isa |= 1 << 1;
+#endif
+#if __FMA__
+    isa |= 1 << 2;
+#endif
+#if __F16C__
+    isa |= 1 << 3;
+#endif
+#if __AVX2__
+    isa |= 1 << 4;
+#endif
+#if __AVX512F__
+    isa |= 1 << 5;
+#endif
+#if __AVX512VNNI__ || __AVXVNNI__
+    isa |= 1 << 6;
+#endif
+#if __AVX512BF16__
+    isa |= 1 << 7;
+#endif
+#if __AVX512FP16__
+    isa |= 1 << 8;
+#endif
+#if __ARM_NEON
+    isa |= 1 << 9;
+#endif
+#if __ARM_FEATURE_FP16_VECTOR_ARITHMETIC
+    isa |= 1 << 10;
+#endif
+#if __ARM_FEATURE_DOTPROD
+    isa |= 1 << 11;
+#endif
+#if __ARM_FEATURE_MATMUL_INT8
+    isa |= 1 << 12;
+#endif
+#if __ARM_FEATURE_SVE
+    isa |= 1 << 13;
+#endif
+#if __mips_msa
+    isa |= 1 << 14;
+#endif
+#if __loongarch_sx
+    isa |= 1 << 15;
+#endif
+#if __loongarch_asx
+    isa |= 1 << 16;
+#endif
+#if __riscv_vector
+    isa |= 1 << 17;
+#endif
+    return isa;
+}
+
+static inline PackedWeightCache* packed_weight_cache_of(const Option& opt)
+{
+    return opt.extension ? opt.extension->packed_weight_cache : 0;
+}
+
+// look up the transformed weight in opt.extension->packed_weight_cache
+// params tell the transform kind and all its arguments
+// return 0 if found, otherwise digest is filled for packed_weight_cache_put()
+static inline int packed_weight_cache_get(const Option& opt, const Mat& weight, const int* params, int param_count, Mat& packed, uint64_t& digest)
+{
+    PackedWeightCache* cache = packed_weight_cache_of(opt);
+    if (!cache)
+        return -1;
+
+    digest = PackedWeightCache::digest(weight, params, param_count, packed_weight_cache_isa());
+    return cache->get(digest, packed);
+}
+
+static inline void packed_weight_cache_put(const Option& opt, uint64_t digest, const Mat& packed)
+{
+    PackedWeightCache* cache = packed_weight_cache_of(opt);
+    if (cache)
+        cache->put(digest, packed);
+}
+
+} // namespace ncnn
+
+#endif // NCNN_PACKEDWEIGHTCACHE_H
@@ -0,0 +1,178 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "profiler.h"
+
+#include "layer.h"
+
+namespace ncnn {
+
+ProfilerEvent::ProfilerEvent()
+{
+    type = 0;
+    layer = 0;
+    layer_index = -1;
+    start = 0.0;
+    end = 0.0;
+    thread_id = 0;
+    blob_allocated_bytes = 0;
+    workspace_allocated_bytes = 0;
+}
+
+Profiler::~Profiler()
+{
+}
+
+class ProfileCollectorPrivate
+{
+public:
+    Mutex lock;
+    std::vector<ProfilerEvent> events;
+};
+
+ProfileCollector::ProfileCollector()
+    : Profiler(), d(new ProfileCollectorPrivate)
+{
+}
+
+ProfileCollector::~ProfileCollector()
+{
+    delete d;
+}
+
+ProfileCollector::ProfileCollector(const ProfileCollector&)
+    : d(0)
+{
+}
+
+ProfileCollector& ProfileCollector::operator=(const ProfileCollector&)
+{
+    return *this;
+}
+
+void ProfileCollector::record(const ProfilerEvent& event)
+{
+    MutexLockGuard g(d->lock);
+
+    d->events.push_back(event);
+}
+
+void ProfileCollector::clear()
+{
+    MutexLockGuard g(d->lock);
+
+    d->events.clear();
+}
+
+std::vector<ProfilerEvent> ProfileCollector::events() const
+{
+    MutexLockGuard g(d->lock);
+
+    return d->events;
+}
+
+#if NCNN_STDIO
+static void write_json_string(FILE* fp, const char* s)
+{
+    fputc('"', fp);
+    for (; *s; s++)
+    {
+        const unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            fprintf(fp, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(fp, "\\u%04x", c);
+        else
+            fputc(c, fp);
+    }
+    fputc('"', fp);
+}
+
+static void write_json_shape(FILE* fp, const Mat& m)
+{
+    fprintf(fp, "\"dims=%d w=%d h=%d d=%d c=%d elempack=%d elemsize=%d\"", m.dims, m.w, m.h, m.d, m.c, m.elempack, (int)m.elemsize);
+}
+
+int ProfileCollector::save_chrome_trace(FILE* fp) const
+{
+    std::vector<ProfilerEvent> events = this->events();
+
+    double time_origin = 0.0;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        if (i == 0 || events[i].start < time_origin)
+            time_origin = events[i].start;
+    }
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const ProfilerEvent& e = events[i];
+
+        fprintf(fp, i == 0 ? "\n" : ",\n");
+
+        // complete event with microsecond timestamps
+        fprintf(fp, "{\"name\":");
+        if (e.type == 1)
+        {
+            write_json_string(fp, "convert_layout");
+        }
+        else
+        {
+#if NCNN_STRING
+            write_json_string(fp, e.layer && !e.layer->name.empty() ? e.layer->name.c_str() : "layer");
+#else
+            write_json_string(fp, "layer");
+#endif
+        }
+        fprintf(fp, ",\"cat\":\"%s\",\"ph\":\"X\"", e.type == 1 ? "convert_layout" : "layer");
+        fprintf(fp, ",\"ts\":%.3f,\"dur\":%.3f", (e.start - time_origin) * 1000.0, (e.end - e.start) * 1000.0);
+        fprintf(fp, ",\"pid\":0,\"tid\":%d", e.thread_id);
+
+        fprintf(fp, ",\"args\":{\"layer_index\":%d", e.layer_index);
+        if (e.layer)
+        {
+#if NCNN_STRING
+            fprintf(fp, ",\"type\":");
+            write_json_string(fp, e.layer->type.c_str());
+#else
+            fprintf(fp, ",\"typeindex\":%d", e.layer->typeindex);
+#endif
+        }
+        for (size_t j = 0; j < e.bottom_shapes.size(); j++)
+        {
+            fprintf(fp, ",\"bottom%d\":", (int)j);
+            write_json_shape(fp, e.bottom_shapes[j]);
+        }
+        for (size_t j = 0; j < e.top_shapes.size(); j++)
+        {
+            fprintf(fp, ",\"top%d\":", (int)j);
+            write_json_shape(fp, e.top_shapes[j]);
+        }
+        fprintf(fp, ",\"blob_allocated_bytes\":%lu,\"workspace_allocated_bytes\":%lu}}", (unsigned long)e.blob_allocated_bytes, (unsigned long)e.workspace_allocated_bytes);
+    }
+
+    fprintf(fp, "\n]}\n");
+
+    return ferror(fp) ? -1 : 0;
+}
+
+int ProfileCollector::save_chrome_trace(const char* path) const
+{
+    FILE* fp = fopen(path, "wb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", path);
+        return -1;
+    }
+
+    int ret = save_chrome_trace(fp);
+
+    fclose(fp);
+
+    return ret;
+}
+#endif // NCNN_STDIO
+
+} // namespace ncnn
@@ -0,0 +1,95 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef NCNN_PROFILER_H
+#define NCNN_PROFILER_H
+
+#include "mat.h"
+#include "platform.h"
+
+#if NCNN_STDIO
+#include <stdio.h>
+#endif // NCNN_STDIO
+
+namespace ncnn {
+
+class Layer;
+
+// one timed span recorded during extract
+class NCNN_EXPORT ProfilerEvent
+{
+public:
+    ProfilerEvent();
+
+    // 0 = layer forward
+    // 1 = layout conversion of one bottom blob inserted before the layer forward
+    int type;
+
+    // the layer forwarded, or the layer consuming the converted blob
+    const Layer* layer;
+    int layer_index;
+
+    // get_current_time() in ms
+    double start;
+    double end;
+
+    // small index of the thread recording the event, in order of first use
+    int thread_id;
+
+    // shapes of the bottom and top blobs, the mats carry no data
+    // a batched forward reports the shapes of the first sample
+    std::vector<Mat> bottom_shapes;
+    std::vector<Mat> top_shapes;
+
+    // bytes requested from the blob and workspace allocator on the recording thread
+    // layer forward includes the bytes of its layout conversions
+    size_t blob_allocated_bytes;
+    size_t workspace_allocated_bytes;
+};
+
+// receives the events of the extractors it is set to
+// record() is called from several threads when use_parallel_branch is enabled
+// only layers forwarded on cpu are profiled
+class NCNN_EXPORT Profiler
+{
+public:
+    virtual ~Profiler();
+
+    virtual void record(const ProfilerEvent& event) = 0;
+};
+
+// keeps all events in memory for inspection and export
+class ProfileCollectorPrivate;
+class NCNN_EXPORT ProfileCollector : public Profiler
+{
+public:
+    ProfileCollector();
+    virtual ~ProfileCollector();
+
+    virtual void record(const ProfilerEvent& event);
+
+    // drop all events
+    void clear();
+
+    // events in the order they finished
+    std::vector<ProfilerEvent> events() const;
+
+#if NCNN_STDIO
+    // write chrome trace json, open with chrome://tracing or ui.perfetto.dev
+    // timestamps are relative to the earliest event
+    // return 0 if success
+    int save_chrome_trace(FILE* fp) const;
+    int save_chrome_trace(const char* path) const;
+#endif // NCNN_STDIO
+
+private:
+    ProfileCollector(const ProfileCollector&);
+    ProfileCollector& operator=(const ProfileCollector&);
+
+private:
+    ProfileCollectorPrivate* const d;
+};
+
+} // namespace ncnn
+
+#endif // NCNN_PROFILER_H
@@ -0,0 +1,214 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <stdio.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "mat.h"
+#include "platform.h"
+
+static int test_allocator_0()
+{
+    // freed budgets are reused for the same or smaller sizes
+    ncnn::BinnedPoolAllocator allocator;
+
+    void* p0 = allocator.fastMalloc(1000);
+    void* p1 = allocator.fastMalloc(3000);
+    if (!p0 || !p1 || (size_t)p0 % NCNN_MALLOC_ALIGN != 0 || (size_t)p1 % NCNN_MALLOC_ALIGN != 0)
+    {
+        fprintf(stderr, "test_allocator_0 malloc failed\n");
+        return -1;
+    }
+
+    memset(p0, 0, 1000);
+    memset(p1, 0, 3000);
+
+    allocator.fastFree(p0);
+    allocator.fastFree(p1);
+
+    void* q0 = allocator.fastMalloc(1000);
+    void* q1 = allocator.fastMalloc(2000);
+    if (q0 != p0 || q1 != p1)
+    {
+        fprintf(stderr, "test_allocator_0 reuse failed\n");
+        return -1;
+    }
+
+    allocator.fastFree(q0);
+    allocator.fastFree(q1);
+
+    return 0;
+}
+
+static int test_allocator_1()
+{
+    // budgets much larger than the request are not used with size compare ratio
+    ncnn::BinnedPoolAllocator allocator;
+    allocator.set_size_compare_ratio(0.5f);
+
+    void* p0 = allocator.fastMalloc(100000);
+    allocator.fastFree(p0);
+
+    void* q0 = allocator.fastMalloc(20000);
+    if (q0 == p0)
+    {
+        fprintf(stderr, "test_allocator_1 size compare ratio failed\n");
+        return -1;
+    }
+
+    void* q1 = allocator.fastMalloc(60000);
+    if (q1 != p0)
+    {
+        fprintf(stderr, "test_allocator_1 reuse failed\n");
+        return -1;
+    }
+
+    allocator.fastFree(q0);
+    allocator.fastFree(q1);
+
+    return 0;
+}
+
+static int test_allocator_2()
+{
+    // the pool keeps serving correct buffers through drops and clear
+    ncnn::BinnedPoolAllocator allocator;
+    allocator.set_size_drop_threshold(4);
+
+    void* ptrs[64];
+    for (int i = 0; i < 64; i++)
+    {
+        const size_t size = 16 + (size_t)i * 977;
+        ptrs[i] = allocator.fastMalloc(size);
+        memset(ptrs[i], i, size);
+    }
+
+    for (int i = 0; i < 64; i += 2)
+    {
+        allocator.fastFree(ptrs[i]);
+    }
+
+    for (int i = 0; i < 64; i += 2)
+    {
+        const size_t size = 16 + (size_t)(63 - i) * 977;
+        ptrs[i] = allocator.fastMalloc(size);
+        memset(ptrs[i], i, size);
+    }
+
+    for (int i = 1; i < 64; i += 2)
+    {
+        const unsigned char* p = (const unsigned char*)ptrs[i];
+        const size_t size = 16 + (size_t)i * 977;
+        if (p[0] != i || p[size - 1] != i)
+        {
+            fprintf(stderr, "test_allocator_2 buffer %d corrupted\n", i);
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < 64; i++)
+    {
+        allocator.fastFree(ptrs[i]);
+    }
+
+    allocator.clear();
+
+    return 0;
+}
+
+#if NCNN_THREADS
+struct allocator_thread_args
+{
+    ncnn::Allocator* allocator;
+    int seed;
+    int result;
+};
+
+static void* allocator_thread(void* args)
+{
+    allocator_thread_args* ta = (allocator_thread_args*)args;
+
+    void* ptrs[8] = {0};
+    size_t sizes[8] = {0};
+
+    unsigned int seed = ta->seed;
+    for (int i = 0; i < 20000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        const int j = (seed >> 16) % 8;
+
+        if (ptrs[j])
+        {
+            const unsigned char* p = (const unsigned char*)ptrs[j];
+            if (p[0] != (unsigned char)j || p[sizes[j] - 1] != (unsigned char)j)
+                ta->result = -1;
+
+            ta->allocator->fastFree(ptrs[j]);
+        }
+
+        sizes[j] = 1 + (seed >> 8) % 40000;
+        ptrs[j] = ta->allocator->fastMalloc(sizes[j]);
+        memset(ptrs[j], j, sizes[j]);
+    }
+
+    for (int j = 0; j < 8; j++)
+    {
+        ta->allocator->fastFree(ptrs[j]);
+    }
+
+    return 0;
+}
+
+static int test_allocator_3()
+{
+    // many threads sharing one pool never get overlapping buffers
+    ncnn::BinnedPoolAllocator allocator;
+
+    const int thread_count = 8;
+
+    allocator_thread_args args[thread_count];
+    ncnn::Thread* threads[thread_count];
+    for (int i = 0; i < thread_count; i++)
+    {
+        args[i].allocator = &allocator;
+        args[i].seed = 7767517 + i;
+        args[i].result = 0;
+        threads[i] = new ncnn::Thread(allocator_thread, &args[i]);
+    }
+
+    int ret = 0;
+    for (int i = 0; i < thread_count; i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+
+        if (args[i].result != 0)
+            ret = -1;
+    }
+
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_allocator_3 buffer corrupted\n");
+        return -1;
+    }
+
+    return 0;
+}
+#endif // NCNN_THREADS
+
+int main()
+{
+#if NCNN_THREADS
+    return 0
+           || test_allocator_0()
+           || test_allocator_1()
+           || test_allocator_2()
+           || test_allocator_3();
+#else
+    return 0
+           || test_allocator_0()
+           || test_allocator_1()
+           || test_allocator_2();
+#endif
+}
@@ -0,0 +1,191 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "datareader.h"
+#include "net.h"
+#include "testutil.h"
+
+#include <string.h>
+
+// flag 0 for each weight header and random float32 weights
+class DataReaderRandomWeights : public ncnn::DataReader
+{
+public:
+    virtual size_t read(void* buf, size_t size) const
+    {
+        if (size == 4)
+        {
+            memset(buf, 0, size);
+            return size;
+        }
+
+        float* ptr = (float*)buf;
+        for (size_t i = 0; i < size / sizeof(float); i++)
+        {
+            ptr[i] = RandomFloat(-0.5f, 0.5f);
+        }
+
+        return size;
+    }
+};
+
+static int load_net(ncnn::Net& net, const char* param_txt, const ncnn::Option& opt)
+{
+    net.opt = opt;
+
+    int ret = net.load_param_mem(param_txt);
+    if (ret != 0)
+        return ret;
+
+    DataReaderRandomWeights dr;
+    return net.load_model(dr);
+}
+
+// extract the batch at once and compare every sample with its own extraction
+static int test_batch(const char* param_txt, const std::vector<ncnn::Mat>& in, const ncnn::Option& opt, int expect_dims = 0)
+{
+    ncnn::Net net;
+    int ret = load_net(net, param_txt, opt);
+    if (ret != 0)
+    {
+        fprintf(stderr, "load net failed\n");
+        return -1;
+    }
+
+    std::vector<ncnn::Mat> out;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+
+        ex.input("in", in);
+        ret = ex.extract("out", out);
+        if (ret != 0 || out.size() != in.size())
+        {
+            fprintf(stderr, "extract batch failed\n");
+            return -1;
+        }
+    }
+
+    const float epsilon = opt.use_fp16_packed || opt.use_fp16_storage ? 0.1 : 0.001;
+
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        ncnn::Extractor ex = net.create_extractor();
+
+        ncnn::Mat out_ref;
+        ex.input("in", in[i]);
+        ex.extract("out", out_ref);
+
+        if ((expect_dims && out[i].dims != expect_dims) || CompareMat(out[i], out_ref, epsilon) != 0)
+        {
+            fprintf(stderr, "test_batch sample %d mismatch use_packing_layout=%d use_fp16_storage=%d\n", (int)i, opt.use_packing_layout, opt.use_fp16_storage);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_batch(const char* param_txt, const std::vector<ncnn::Mat>& in, int expect_dims = 0)
+{
+    ncnn::Option opts[3];
+
+    opts[0].use_packing_layout = false;
+    opts[0].use_fp16_packed = false;
+    opts[0].use_fp16_storage = false;
+    opts[0].use_bf16_storage = false;
+
+    opts[1].use_packing_layout = true;
+    opts[1].use_fp16_packed = true;
+    opts[1].use_fp16_storage = false;
+    opts[1].use_bf16_storage = false;
+
+    opts[2].use_packing_layout = true;
+    opts[2].use_fp16_packed = true;
+    opts[2].use_fp16_storage = true;
+    opts[2].use_bf16_storage = false;
+
+    for (int i = 0; i < 3; i++)
+    {
+        opts[i].num_threads = 1;
+
+        // im2col gemm convolution is the path that stacks samples
+        opts[i].use_winograd_convolution = false;
+        opts[i].use_sgemm_convolution = true;
+
+        int ret = test_batch(param_txt, in, opts[i], expect_dims);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int test_batch_0()
+{
+    // two branches joined by concat
+    const char* param_txt = "7767517\n"
+                            "7 8\n"
+                            "Input            in       0 1 in 0=12 1=10 2=8\n"
+                            "Convolution      conv0    1 1 in c0 0=16 1=3 4=1 5=1 6=1152 9=1\n"
+                            "Split            split    1 2 c0 s0 s1\n"
+                            "Convolution      conv1    1 1 s0 c1 0=8 1=1 5=1 6=128 9=1\n"
+                            "Convolution      conv2    1 1 s1 c2 0=8 1=3 4=1 5=1 6=1152 9=1\n"
+                            "Concat           concat   2 1 c1 c2 cat\n"
+                            "Pooling          out      1 1 cat out 0=1 4=1\n";
+
+    std::vector<ncnn::Mat> in(3);
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        in[i] = RandomMat(12, 10, 8);
+    }
+
+    return test_batch(param_txt, in);
+}
+
+static int test_batch_1()
+{
+    // InnerProduct on 1-dim samples and Gemm on 2-dim samples are stacked along rows
+    const char* param_txt = "7767517\n"
+                            "5 5\n"
+                            "Input        in       0 1 in 0=16\n"
+                            "InnerProduct fc       1 1 in fc 0=32 1=1 2=512\n"
+                            "Reshape      reshape  1 1 fc fc2d 0=8 1=4\n"
+                            "Gemm         gemm     1 1 fc2d gemm 4=0 5=1 6=1 8=16 9=8 10=4\n"
+                            "ReLU         out      1 1 gemm out\n";
+
+    std::vector<ncnn::Mat> in(5);
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        in[i] = RandomMat(16);
+    }
+
+    return test_batch(param_txt, in);
+}
+
+static int test_batch_2()
+{
+    // Convolution on 3-dim samples is stacked along depth into one im2col gemm
+    const char* param_txt = "7767517\n"
+                            "3 3\n"
+                            "Input        in       0 1 in 0=9 1=7 2=12\n"
+                            "Convolution  conv0    1 1 in conv0 0=24 1=3 3=1 4=1 5=1 6=2592 9=1\n"
+                            "Convolution  out      1 1 conv0 out 0=16 1=1 5=1 6=384\n";
+
+    std::vector<ncnn::Mat> in(2);
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        in[i] = RandomMat(9, 7, 12);
+    }
+
+    return test_batch(param_txt, in, 3);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_batch_0()
+           || test_batch_1()
+           || test_batch_2();
+}
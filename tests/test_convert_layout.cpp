@@ -0,0 +1,135 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "layer.h"
+#include "net.h"
+#include "testutil.h"
+
+// copies the input and records the layout it was given
+class LayoutProbe : public ncnn::Layer
+{
+public:
+    LayoutProbe()
+    {
+        one_blob_only = true;
+        support_packing = true;
+        support_bf16_storage = true;
+    }
+
+    virtual int forward(const ncnn::Mat& bottom_blob, ncnn::Mat& top_blob, const ncnn::Option& opt) const
+    {
+        elempack = bottom_blob.elempack;
+        elembits = bottom_blob.elembits();
+
+        top_blob = bottom_blob.clone(opt.blob_allocator);
+        return top_blob.empty() ? -100 : 0;
+    }
+
+    static int elempack;
+    static int elembits;
+};
+
+int LayoutProbe::elempack = 0;
+int LayoutProbe::elembits = 0;
+
+DEFINE_LAYER_CREATOR(LayoutProbe)
+
+static int probe_layout(const ncnn::Mat& in, bool use_bf16_storage, int& elempack, int& elembits)
+{
+    char param_str[256];
+    if (in.dims == 1)
+        sprintf(param_str, "7767517\n2 2\nInput in 0 1 in 0=%d\nLayoutProbe probe 1 1 in out\n", in.w);
+    else if (in.dims == 2)
+        sprintf(param_str, "7767517\n2 2\nInput in 0 1 in 0=%d 1=%d\nLayoutProbe probe 1 1 in out\n", in.w, in.h);
+    else
+        sprintf(param_str, "7767517\n2 2\nInput in 0 1 in 0=%d 1=%d 2=%d\nLayoutProbe probe 1 1 in out\n", in.w, in.h, in.c);
+
+    ncnn::Net net;
+    net.opt.num_threads = 1;
+    net.opt.use_packing_layout = true;
+    net.opt.use_fp16_packed = false;
+    net.opt.use_fp16_storage = false;
+    net.opt.use_fp16_arithmetic = false;
+    net.opt.use_bf16_storage = use_bf16_storage;
+    net.register_custom_layer("LayoutProbe", LayoutProbe_layer_creator);
+    net.load_param_mem(param_str);
+
+    const unsigned char model_data[1] = {0};
+    net.load_model(model_data);
+
+    LayoutProbe::elempack = 0;
+    LayoutProbe::elembits = 0;
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.input("in", in);
+
+    ncnn::Mat out;
+    int ret = ex.extract("out", out);
+    if (ret != 0 || CompareMat(out, in, 0.01) != 0)
+    {
+        fprintf(stderr, "probe_layout extract failed use_bf16_storage=%d\n", use_bf16_storage);
+        return -1;
+    }
+
+    elempack = LayoutProbe::elempack;
+    elembits = LayoutProbe::elembits;
+
+    return 0;
+}
+
+static int test_convert_layout(const ncnn::Mat& in)
+{
+    int elempack = 0;
+    int elembits = 0;
+    if (probe_layout(in, false, elempack, elembits) != 0)
+        return -1;
+
+    int elempack_bf16 = 0;
+    int elembits_bf16 = 0;
+    if (probe_layout(in, true, elempack_bf16, elembits_bf16) != 0)
+        return -1;
+
+    // 16-bit blobs take the same pack16/pack8/pack4 layout as fp32 blobs on x86
+    if (elembits != 32 || elembits_bf16 != 16 || elempack_bf16 != elempack)
+    {
+        fprintf(stderr, "test_convert_layout failed in.dims=%d in=(%d %d %d) fp32 elempack=%d bf16 elempack=%d elembits=%d\n", in.dims, in.w, in.h, in.c, elempack, elempack_bf16, elembits_bf16);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_convert_layout_0()
+{
+    return 0
+           || test_convert_layout(RandomMat(5, 7, 32))
+           || test_convert_layout(RandomMat(5, 7, 16))
+           || test_convert_layout(RandomMat(5, 7, 8))
+           || test_convert_layout(RandomMat(5, 7, 12))
+           || test_convert_layout(RandomMat(5, 7, 3));
+}
+
+static int test_convert_layout_1()
+{
+    return 0
+           || test_convert_layout(RandomMat(5, 32))
+           || test_convert_layout(RandomMat(5, 24))
+           || test_convert_layout(RandomMat(5, 4))
+           || test_convert_layout(RandomMat(48))
+           || test_convert_layout(RandomMat(40))
+           || test_convert_layout(RandomMat(13));
+}
+
+int main()
+{
+    SRAND(7767517);
+
+#if NCNN_BF16 && (NCNN_AVX512 || NCNN_AVX)
+    return 0
+           || test_convert_layout_0()
+           || test_convert_layout_1();
+#else
+    // other targets keep their own layout for 16-bit blobs
+    return 0;
+#endif
+}
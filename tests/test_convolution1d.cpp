@@ -202,9 +202,98 @@ static int test_convolution1d_1()
     return 0;
 }
 
+#if NCNN_INT8
+static int test_convolution1d_int8(int w, int h, int outh, int kernel, int dilation, int stride, int pad, int bias)
+{
+    ncnn::Mat a = RandomMat(w, h);
+
+    ncnn::ParamDict pd;
+    pd.set(0, outh);     // num_output
+    pd.set(1, kernel);   // kernel_w
+    pd.set(2, dilation); // dilation_w
+    pd.set(3, stride);   // stride_w
+    pd.set(4, pad);      // pad_w
+    pd.set(5, bias);     // bias_term
+    pd.set(6, outh * h * kernel);
+    pd.set(8, 1); // int8_scale_term
+
+    int activation_type = RAND() % 5; // 0 1 2 3 4
+    ncnn::Mat activation_params(2);
+    activation_params[0] = RandomFloat(-1, 0); // alpha
+    activation_params[1] = RandomFloat(0, 1);  // beta
+    pd.set(9, activation_type);
+    pd.set(10, activation_params);
+
+    std::vector<ncnn::Mat> weights(bias ? 4 : 3);
+    weights[0] = RandomMat(outh * h * kernel);
+    ncnn::Mat weight_scales = scales_mat(weights[0], outh, h * kernel, h * kernel);
+    ncnn::Mat input_scales = scales_mat(a, 1, w * h, w * h);
+    if (bias)
+    {
+        weights[1] = RandomMat(outh);
+        weights[2] = weight_scales;
+        weights[3] = input_scales;
+    }
+    else
+    {
+        weights[1] = weight_scales;
+        weights[2] = input_scales;
+    }
+
+    int flag = TEST_LAYER_DISABLE_GPU_TESTING;
+    int ret = test_layer("Convolution1D", pd, weights, a, 0.001f, 0, flag);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution1d_int8 failed w=%d h=%d outh=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d act=%d actparams=[%f,%f]\n", w, h, outh, kernel, dilation, stride, pad, bias, activation_type, activation_params[0], activation_params[1]);
+    }
+
+    return ret;
+}
+
+static int test_convolution1d_2()
+{
+    static const int kdsp[7][4] = {
+        {1, 1, 1, 0},
+        {2, 1, 2, -233},
+        {3, 1, 1, 1},
+        {3, 1, 2, 1},
+        {3, 2, 1, -234},
+        {5, 1, 1, 2},
+        {7, 2, 2, 3},
+    };
+
+    for (int i = 0; i < 7; i++)
+    {
+        const int k = kdsp[i][0];
+        const int d = kdsp[i][1];
+        const int s = kdsp[i][2];
+        const int p = kdsp[i][3];
+
+        int ret = 0
+                  || test_convolution1d_int8(11, 1, 1, k, d, s, p, 1)
+                  || test_convolution1d_int8(11, 4, 13, k, d, s, p, 0)
+                  || test_convolution1d_int8(11, 13, 4, k, d, s, p, 1)
+                  || test_convolution1d_int8(11, 8, 8, k, d, s, p, 0)
+                  || test_convolution1d_int8(11, 12, 16, k, d, s, p, 1)
+                  || test_convolution1d_int8(11, 16, 24, k, d, s, p, 0)
+                  || test_convolution1d_int8(25, 31, 48, k, d, s, p, 1)
+                  || test_convolution1d_int8(25, 48, 32, k, d, s, p, 0);
+
+        if (ret != 0)
+            return -1;
+    }
+
+    return 0;
+}
+#endif // NCNN_INT8
+
 int main()
 {
     SRAND(7767517);
 
+#if NCNN_INT8
+    return test_convolution1d_0() || test_convolution1d_1() || test_convolution1d_2();
+#else
     return test_convolution1d_0() || test_convolution1d_1();
+#endif
 }
@@ -128,6 +128,122 @@ static int test_convolution_3()
     return 0;
 }
 
+static int test_convolution_fp16w(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias)
+{
+    ncnn::Mat a = RandomMat(w, h, c);
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);
+    pd.set(1, kernel);
+    pd.set(2, dilation);
+    pd.set(3, stride);
+    pd.set(4, pad);
+    pd.set(5, bias);
+    pd.set(6, outch * c * kernel * kernel);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch * c * kernel * kernel);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_packing_layout = true;
+    opt.use_fp16_packed = true;
+    opt.use_fp16_storage = true;
+    opt.use_fp16_arithmetic = false;
+    opt.use_bf16_storage = false;
+    opt.use_sgemm_convolution = true;
+    opt.use_winograd_convolution = false;
+    opt.use_fp16_packed_weight = true;
+
+    int ret = test_layer_opt("Convolution", pd, weights, opt, a, 0.01);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution_fp16w failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d\n", w, h, c, outch, kernel, dilation, stride, pad, bias);
+        return ret;
+    }
+
+    opt.use_packing_layout = false;
+
+    ret = test_layer_opt("Convolution", pd, weights, opt, a, 0.01);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution_fp16w failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d\n", w, h, c, outch, kernel, dilation, stride, pad, bias);
+    }
+
+    return ret;
+}
+
+static int test_convolution_bf16w(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias)
+{
+    ncnn::Mat a = RandomMat(w, h, c);
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);
+    pd.set(1, kernel);
+    pd.set(2, dilation);
+    pd.set(3, stride);
+    pd.set(4, pad);
+    pd.set(5, bias);
+    pd.set(6, outch * c * kernel * kernel);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch * c * kernel * kernel);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_packing_layout = true;
+    opt.use_fp16_packed = false;
+    opt.use_fp16_storage = false;
+    opt.use_fp16_arithmetic = false;
+    opt.use_bf16_storage = false;
+    opt.use_sgemm_convolution = true;
+    opt.use_winograd_convolution = false;
+    opt.use_bf16_packed_weight = true;
+
+    int ret = test_layer_opt("Convolution", pd, weights, opt, a, 0.05);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution_bf16w failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d\n", w, h, c, outch, kernel, dilation, stride, pad, bias);
+        return ret;
+    }
+
+    opt.use_packing_layout = false;
+
+    ret = test_layer_opt("Convolution", pd, weights, opt, a, 0.05);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution_bf16w failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d\n", w, h, c, outch, kernel, dilation, stride, pad, bias);
+    }
+
+    return ret;
+}
+
+static int test_convolution_4()
+{
+    return 0
+           || test_convolution_fp16w(9, 7, 1, 1, 1, 1, 1, 0, 1)
+           || test_convolution_fp16w(9, 7, 4, 13, 3, 1, 1, 1, 0)
+           || test_convolution_fp16w(9, 7, 13, 4, 1, 1, 2, 0, 1)
+           || test_convolution_fp16w(9, 7, 16, 24, 3, 1, 1, 1, 1)
+           || test_convolution_fp16w(9, 7, 24, 16, 3, 2, 2, 2, 0)
+           || test_convolution_fp16w(9, 7, 32, 32, 1, 1, 1, 0, 1);
+}
+
+static int test_convolution_5()
+{
+    return 0
+           || test_convolution_bf16w(9, 7, 1, 1, 1, 1, 1, 0, 1)
+           || test_convolution_bf16w(9, 7, 4, 13, 3, 1, 1, 1, 0)
+           || test_convolution_bf16w(9, 7, 13, 4, 1, 1, 2, 0, 1)
+           || test_convolution_bf16w(9, 7, 16, 24, 3, 1, 1, 1, 1)
+           || test_convolution_bf16w(9, 7, 24, 16, 3, 2, 2, 2, 0)
+           || test_convolution_bf16w(9, 7, 32, 32, 1, 1, 1, 0, 1);
+}
+
 #if NCNN_INT8
 static int test_convolution_int8(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias, bool requant = false)
 {
@@ -445,10 +561,14 @@ int main()
            || test_convolution_1()
            || test_convolution_1_2()
            || test_convolution_2()
-           || test_convolution_3();
+           || test_convolution_3()
+           || test_convolution_4()
+           || test_convolution_5();
 #else
     return 0
            || test_convolution_2()
-           || test_convolution_3();
+           || test_convolution_3()
+           || test_convolution_4()
+           || test_convolution_5();
 #endif
 }
@@ -113,9 +113,22 @@ static int test_convolutiondepthwise_0()
     return 0;
 }
 
+static int test_convolutiondepthwise_1()
+{
+    // large kernels
+    return 0
+           || test_convolutiondepthwise(19, 17, 8, 8, 9, 1, 1, 4, 1, 8)
+           || test_convolutiondepthwise(23, 21, 16, 16, 11, 1, 2, -233, 0, 16)
+           || test_convolutiondepthwise(28, 28, 32, 32, 13, 1, 1, 6, 1, 32)
+           || test_convolutiondepthwise(14, 14, 16, 16, 31, 1, 1, 15, 1, 16)
+           || test_convolutiondepthwise(31, 29, 12, 12, 7, 2, 1, -233, 1, 12);
+}
+
 int main()
 {
     SRAND(7767517);
 
-    return test_convolutiondepthwise_0();
+    return 0
+           || test_convolutiondepthwise_0()
+           || test_convolutiondepthwise_1();
 }
@@ -193,9 +193,101 @@ static int test_convolutiondepthwise1d_1()
     return 0;
 }
 
+#if NCNN_INT8
+static int test_convolutiondepthwise1d_int8(int w, int h, int outh, int kernel, int dilation, int stride, int pad, int bias, int group)
+{
+    ncnn::Mat a = RandomMat(w, h);
+
+    ncnn::ParamDict pd;
+    pd.set(0, outh);     // num_output
+    pd.set(1, kernel);   // kernel_w
+    pd.set(2, dilation); // dilation_w
+    pd.set(3, stride);   // stride_w
+    pd.set(4, pad);      // pad_w
+    pd.set(5, bias);     // bias_term
+    pd.set(6, outh / group * h / group * kernel * group);
+    pd.set(7, group);
+    pd.set(8, 1); // int8_scale_term
+
+    int activation_type = RAND() % 5; // 0 1 2 3 4
+    ncnn::Mat activation_params(2);
+    activation_params[0] = RandomFloat(-1, 0); // alpha
+    activation_params[1] = RandomFloat(0, 1);  // beta
+    pd.set(9, activation_type);
+    pd.set(10, activation_params);
+
+    const int weight_data_size_g = outh / group * h / group * kernel;
+
+    std::vector<ncnn::Mat> weights(bias ? 4 : 3);
+    weights[0] = RandomMat(weight_data_size_g * group);
+    ncnn::Mat weight_scales = scales_mat(weights[0], group, weight_data_size_g, weight_data_size_g);
+    ncnn::Mat input_scales = scales_mat(a, 1, w * h, w * h);
+    if (bias)
+    {
+        weights[1] = RandomMat(outh);
+        weights[2] = weight_scales;
+        weights[3] = input_scales;
+    }
+    else
+    {
+        weights[1] = weight_scales;
+        weights[2] = input_scales;
+    }
+
+    int flag = TEST_LAYER_DISABLE_GPU_TESTING;
+    int ret = test_layer("ConvolutionDepthWise1D", pd, weights, a, 0.001f, 0, flag);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolutiondepthwise1d_int8 failed w=%d h=%d outh=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d group=%d act=%d actparams=[%f,%f]\n", w, h, outh, kernel, dilation, stride, pad, bias, group, activation_type, activation_params[0], activation_params[1]);
+    }
+
+    return ret;
+}
+
+static int test_convolutiondepthwise1d_2()
+{
+    static const int kdsp[7][4] = {
+        {1, 1, 1, 0},
+        {2, 1, 2, -233},
+        {3, 1, 1, 1},
+        {3, 1, 2, 1},
+        {3, 2, 1, -234},
+        {5, 1, 1, 2},
+        {7, 2, 2, 3},
+    };
+
+    for (int i = 0; i < 7; i++)
+    {
+        const int k = kdsp[i][0];
+        const int d = kdsp[i][1];
+        const int s = kdsp[i][2];
+        const int p = kdsp[i][3];
+
+        int ret = 0
+                  || test_convolutiondepthwise1d_int8(11, 1, 1, k, d, s, p, 1, 1)
+                  || test_convolutiondepthwise1d_int8(11, 2, 2, k, d, s, p, 0, 2)
+                  || test_convolutiondepthwise1d_int8(11, 4, 2, k, d, s, p, 1, 2)
+                  || test_convolutiondepthwise1d_int8(11, 7, 7, k, d, s, p, 0, 7)
+                  || test_convolutiondepthwise1d_int8(11, 8, 8, k, d, s, p, 1, 2)
+                  || test_convolutiondepthwise1d_int8(11, 12, 12, k, d, s, p, 0, 4)
+                  || test_convolutiondepthwise1d_int8(11, 16, 8, k, d, s, p, 1, 2)
+                  || test_convolutiondepthwise1d_int8(11, 16, 16, k, d, s, p, 0, 16);
+
+        if (ret != 0)
+            return -1;
+    }
+
+    return 0;
+}
+#endif // NCNN_INT8
+
 int main()
 {
     SRAND(7767517);
 
+#if NCNN_INT8
+    return test_convolutiondepthwise1d_0() || test_convolutiondepthwise1d_1() || test_convolutiondepthwise1d_2();
+#else
     return test_convolutiondepthwise1d_0() || test_convolutiondepthwise1d_1();
+#endif
 }
@@ -97,9 +97,110 @@ static int test_deconvolutiondepthwise_0()
     return 0;
 }
 
+#if NCNN_INT8
+static int test_deconvolutiondepthwise_int8(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias, int group, int output_pad_right, int output_pad_bottom, int output_w, int output_h)
+{
+    ncnn::Mat a = RandomMat(w, h, c);
+
+    if (output_w > 0 && output_h > 0 && pad != -233 && pad != -234)
+    {
+        pad = -233;
+    }
+
+    const int weight_data_size_g = outch / group * c / group * kernel * kernel;
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);    // num_output
+    pd.set(1, kernel);   // kernel_w
+    pd.set(2, dilation); // dilation_w
+    pd.set(3, stride);   // stride_w
+    pd.set(4, pad);      // pad_w
+    pd.set(5, bias);     // bias_term
+    pd.set(6, weight_data_size_g * group);
+    pd.set(7, group);
+    pd.set(8, 1); // int8_scale_term
+
+    int activation_type = RAND() % 5; // 0 1 2 3 4
+    ncnn::Mat activation_params(2);
+    activation_params[0] = RandomFloat(-1, 0); // alpha
+    activation_params[1] = RandomFloat(0, 1);  // beta
+    pd.set(9, activation_type);
+    pd.set(10, activation_params);
+
+    pd.set(18, output_pad_right);
+    pd.set(19, output_pad_bottom);
+    pd.set(20, output_w);
+    pd.set(21, output_h);
+
+    std::vector<ncnn::Mat> weights(bias ? 4 : 3);
+    weights[0] = RandomMat(weight_data_size_g * group);
+    ncnn::Mat weight_scales = scales_mat(weights[0], group, weight_data_size_g, weight_data_size_g);
+    ncnn::Mat input_scales = scales_mat(a, 1, w * h * c, a.cstep);
+    if (bias)
+    {
+        weights[1] = RandomMat(outch);
+        weights[2] = weight_scales;
+        weights[3] = input_scales;
+    }
+    else
+    {
+        weights[1] = weight_scales;
+        weights[2] = input_scales;
+    }
+
+    int flag = TEST_LAYER_DISABLE_GPU_TESTING;
+    int ret = test_layer("DeconvolutionDepthWise", pd, weights, a, 0.001f, 0, flag);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_deconvolutiondepthwise_int8 failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d group=%d act=%d actparams=[%f,%f] output_pad_right=%d output_pad_bottom=%d output_w=%d output_h=%d\n", w, h, c, outch, kernel, dilation, stride, pad, bias, group, activation_type, activation_params[0], activation_params[1], output_pad_right, output_pad_bottom, output_w, output_h);
+    }
+
+    return ret;
+}
+
+static int test_deconvolutiondepthwise_1()
+{
+    static const int kdsp[7][4] = {
+        {1, 1, 1, 0},
+        {2, 1, 2, -233},
+        {3, 1, 1, 1},
+        {3, 1, 2, 1},
+        {3, 2, 1, -234},
+        {4, 1, 2, 1},
+        {5, 2, 2, 2},
+    };
+
+    for (int i = 0; i < 7; i++)
+    {
+        const int k = kdsp[i][0];
+        const int d = kdsp[i][1];
+        const int s = kdsp[i][2];
+        const int p = kdsp[i][3];
+
+        int ret = 0
+                  || test_deconvolutiondepthwise_int8(15, 7, 1, 1, k, d, s, p, 1, 1, 0, 0, 0, 0)
+                  || test_deconvolutiondepthwise_int8(15, 7, 2, 2, k, d, s, p, 0, 1, 1, 1, 7, 5)
+                  || test_deconvolutiondepthwise_int8(15, 7, 3, 3, k, d, s, p, 0, 3, 0, 1, 0, 0)
+                  || test_deconvolutiondepthwise_int8(15, 7, 4, 2, k, d, s, p, 1, 2, 0, 0, 7, 5)
+                  || test_deconvolutiondepthwise_int8(15, 7, 8, 8, k, d, s, p, 0, 2, 0, 2, 7, 5)
+                  || test_deconvolutiondepthwise_int8(15, 7, 12, 12, k, d, s, p, 0, 4, 3, 3, 0, 0)
+                  || test_deconvolutiondepthwise_int8(15, 7, 16, 16, k, d, s, p, 1, 16, 0, 0, 0, 0);
+
+        if (ret != 0)
+            return -1;
+    }
+
+    return 0;
+}
+#endif // NCNN_INT8
+
 int main()
 {
     SRAND(7767517);
 
+#if NCNN_INT8
+    return test_deconvolutiondepthwise_0() || test_deconvolutiondepthwise_1();
+#else
     return test_deconvolutiondepthwise_0();
+#endif
 }
@@ -125,6 +125,84 @@ static int test_gemm_bias(int M, int N, int K, const ncnn::Mat& C, float alpha,
     return ret;
 }
 
+static int test_gemm_fp16w(int M, int N, int K, int transA, int transB, int constantA, int constantB)
+{
+    ncnn::ParamDict pd;
+    pd.set(2, transA);
+    pd.set(3, transB);
+    pd.set(4, constantA);
+    pd.set(5, constantB);
+    pd.set(6, 1);
+    pd.set(7, M);
+    pd.set(8, N);
+    pd.set(9, K);
+    pd.set(10, -1);
+
+    std::vector<ncnn::Mat> weights;
+    if (constantA) weights.push_back(transA ? RandomMat(M, K) : RandomMat(K, M));
+    if (constantB) weights.push_back(transB ? RandomMat(K, N) : RandomMat(N, K));
+
+    std::vector<ncnn::Mat> a;
+    if (!constantA) a.push_back(transA ? RandomMat(M, K) : RandomMat(K, M));
+    if (!constantB) a.push_back(transB ? RandomMat(K, N) : RandomMat(N, K));
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_packing_layout = true;
+    opt.use_fp16_packed = true;
+    opt.use_fp16_storage = true;
+    opt.use_fp16_arithmetic = false;
+    opt.use_bf16_storage = false;
+    opt.use_fp16_packed_weight = true;
+
+    int ret = test_layer_opt("Gemm", pd, weights, opt, a, 1, 0.01);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_gemm_fp16w failed M=%d N=%d K=%d transA=%d transB=%d constantA=%d constantB=%d\n", M, N, K, transA, transB, constantA, constantB);
+    }
+
+    return ret;
+}
+
+static int test_gemm_bf16w(int M, int N, int K, int transA, int transB, int constantA, int constantB)
+{
+    ncnn::ParamDict pd;
+    pd.set(2, transA);
+    pd.set(3, transB);
+    pd.set(4, constantA);
+    pd.set(5, constantB);
+    pd.set(6, 1);
+    pd.set(7, M);
+    pd.set(8, N);
+    pd.set(9, K);
+    pd.set(10, -1);
+
+    std::vector<ncnn::Mat> weights;
+    if (constantA) weights.push_back(transA ? RandomMat(M, K) : RandomMat(K, M));
+    if (constantB) weights.push_back(transB ? RandomMat(K, N) : RandomMat(N, K));
+
+    std::vector<ncnn::Mat> a;
+    if (!constantA) a.push_back(transA ? RandomMat(M, K) : RandomMat(K, M));
+    if (!constantB) a.push_back(transB ? RandomMat(K, N) : RandomMat(N, K));
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_packing_layout = true;
+    opt.use_fp16_packed = false;
+    opt.use_fp16_storage = false;
+    opt.use_fp16_arithmetic = false;
+    opt.use_bf16_storage = false;
+    opt.use_bf16_packed_weight = true;
+
+    int ret = test_layer_opt("Gemm", pd, weights, opt, a, 1, 0.05);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_gemm_bf16w failed M=%d N=%d K=%d transA=%d transB=%d constantA=%d constantB=%d\n", M, N, K, transA, transB, constantA, constantB);
+    }
+
+    return ret;
+}
+
 static int test_gemm_0(int M, int N, int K)
 {
     return 0
@@ -286,7 +364,13 @@ int main()
 
         int ret = 0
                   || test_gemm_0(M, N, K)
-                  || test_gemm_1(M, N, K);
+                  || test_gemm_1(M, N, K)
+                  || test_gemm_fp16w(M, N, K, 0, 1, 1, 0)
+                  || test_gemm_fp16w(M, N, K, 1, 0, 0, 1)
+                  || test_gemm_fp16w(M, N, K, 0, 0, 1, 1)
+                  || test_gemm_bf16w(M, N, K, 0, 1, 1, 0)
+                  || test_gemm_bf16w(M, N, K, 1, 0, 0, 1)
+                  || test_gemm_bf16w(M, N, K, 0, 0, 1, 1);
 
         if (ret != 0)
             return ret;
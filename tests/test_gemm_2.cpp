@@ -0,0 +1,137 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "testutil.h"
+
+#include "weight_quant.h"
+
+static int test_gemm_weight_quant(int M, int N, int K, int TILE_M, int TILE_N, int TILE_K, float alpha, int constantA, int trans, int output_transpose, int bits, int group_size, int broadcast_type_C)
+{
+    // constant A is stored [M, K] and constant B is stored [N, K]
+    const int transA = constantA ? 0 : trans;
+    const int transB = constantA ? trans : 1;
+
+    ncnn::ParamDict pd;
+    pd.set(0, alpha);
+    pd.set(1, 1.f); // beta
+    pd.set(2, transA);
+    pd.set(3, transB);
+    pd.set(4, constantA);
+    pd.set(5, constantA ? 0 : 1);
+    pd.set(6, 1);
+    pd.set(7, M);
+    pd.set(8, N);
+    pd.set(9, K);
+    pd.set(10, broadcast_type_C);
+    pd.set(14, output_transpose);
+    pd.set(19, bits);
+    pd.set(20, TILE_M);
+    pd.set(21, TILE_N);
+    pd.set(22, TILE_K);
+    pd.set(23, group_size);
+
+    ncnn::Mat W;
+    ncnn::Mat W_scales;
+    quantize_weight_quant(RandomMat(K, constantA ? M : N), W, W_scales, K, bits, group_size, ncnn::Option());
+
+    std::vector<ncnn::Mat> weights;
+    weights.push_back(W);
+    if (broadcast_type_C == 1) weights.push_back(RandomMat(M));
+    if (broadcast_type_C == 3) weights.push_back(RandomMat(N, M));
+    if (broadcast_type_C == 4) weights.push_back(RandomMat(N, 1));
+    weights.push_back(W_scales);
+
+    std::vector<ncnn::Mat> a(1);
+    if (constantA)
+        a[0] = transB ? RandomMat(K, N) : RandomMat(N, K);
+    else
+        a[0] = transA ? RandomMat(M, K) : RandomMat(K, M);
+
+    int ret = test_layer("Gemm", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_gemm_weight_quant failed M=%d N=%d K=%d TILE_M=%d TILE_N=%d TILE_K=%d alpha=%f constantA=%d trans=%d output_transpose=%d bits=%d group_size=%d broadcast_type_C=%d\n", M, N, K, TILE_M, TILE_N, TILE_K, alpha, constantA, trans, output_transpose, bits, group_size, broadcast_type_C);
+    }
+
+    return ret;
+}
+
+static int test_gemm_0(int M, int N, int K, int TILE_M, int TILE_N, int TILE_K, int bits, int group_size)
+{
+    return 0
+           || test_gemm_weight_quant(M, N, K, TILE_M, TILE_N, TILE_K, 2.1f, 0, 0, 0, bits, group_size, -1)
+           || test_gemm_weight_quant(M, N, K, TILE_M, TILE_N, TILE_K, 3.1f, 0, 1, 0, bits, group_size, 4)
+           || test_gemm_weight_quant(M, N, K, TILE_M, TILE_N, TILE_K, 4.1f, 1, 0, 0, bits, group_size, 1)
+           || test_gemm_weight_quant(M, N, K, TILE_M, TILE_N, TILE_K, 5.1f, 1, 1, 0, bits, group_size, -1)
+           || test_gemm_weight_quant(M, N, K, TILE_M, TILE_N, TILE_K, 2.1f, 0, 0, 1, bits, group_size, 3)
+           || test_gemm_weight_quant(M, N, K, TILE_M, TILE_N, TILE_K, 3.1f, 0, 1, 1, bits, group_size, -1)
+           || test_gemm_weight_quant(M, N, K, TILE_M, TILE_N, TILE_K, 4.1f, 1, 0, 1, bits, group_size, -1)
+           || test_gemm_weight_quant(M, N, K, TILE_M, TILE_N, TILE_K, 5.1f, 1, 1, 1, bits, group_size, 3);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    int mnk[][3] = {
+        {1, 1, 1},
+        {2, 3, 5},
+        {4, 4, 4},
+        {7, 9, 13},
+        {8, 8, 8},
+        {15, 15, 15},
+        {16, 16, 16},
+        {31, 31, 31},
+        {1, 20, 64},
+        {24, 1, 47},
+        {40, 40, 40},
+        {13, 37, 100},
+        {64, 30, 129},
+    };
+
+    int tile_mnk[][3] = {
+        {1, 1, 1},
+        {2, 2, 2},
+        {4, 4, 4},
+        {8, 8, 8},
+        {12, 12, 16},
+        {16, 16, 32},
+        {20, 20, 48},
+        {32, 32, 64},
+    };
+
+    int mnk_count = sizeof(mnk) / sizeof(int) / 3;
+    int tile_mnk_count = sizeof(tile_mnk) / sizeof(int) / 3;
+
+    for (int i = 0; i < mnk_count; i++)
+    {
+        int M = mnk[i][0];
+        int N = mnk[i][1];
+        int K = mnk[i][2];
+
+        int ret = 0
+                  || test_gemm_0(M, N, K, 0, 0, 0, 8, 0)
+                  || test_gemm_0(M, N, K, 0, 0, 0, 4, 0)
+                  || test_gemm_0(M, N, K, 0, 0, 0, 8, 32)
+                  || test_gemm_0(M, N, K, 0, 0, 0, 4, 32);
+
+        if (ret != 0)
+            return ret;
+
+        for (int j = 0; j < tile_mnk_count; j++)
+        {
+            int TILE_M = tile_mnk[j][0];
+            int TILE_N = tile_mnk[j][1];
+            int TILE_K = tile_mnk[j][2];
+
+            int ret = 0
+                      || test_gemm_0(M, N, K, TILE_M, TILE_N, TILE_K, 4, 16)
+                      || test_gemm_0(M, N, K, TILE_M, TILE_N, TILE_K, 8, 0);
+
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    return 0;
+}
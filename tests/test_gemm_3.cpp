@@ -227,6 +227,61 @@ static int test_gemm_int8(int M, int N, int K, float alpha, int transA, int tran
     return ret;
 }
 
+static int test_gemm_int8_static(int M, int N, int K, float alpha, int transA, int transB, int output_elemtype, int output_transpose, int constantA, int constantB, int output_N1M)
+{
+    ncnn::ParamDict pd;
+    pd.set(0, alpha);
+    pd.set(1, 1.f); // beta
+    pd.set(2, transA);
+    pd.set(3, transB);
+    pd.set(4, constantA);
+    pd.set(5, constantB);
+    pd.set(6, 1);
+    pd.set(7, M);
+    pd.set(8, N);
+    pd.set(9, K);
+    pd.set(10, -1);
+    pd.set(11, output_N1M);
+    pd.set(13, output_elemtype);
+    pd.set(14, output_transpose);
+    pd.set(18, 3); // int8_scale_term
+
+    const int input_count = (constantA ? 0 : 1) + (constantB ? 0 : 1);
+
+    std::vector<ncnn::Mat> weights;
+    if (constantA) weights.push_back(transA ? RandomS8Mat(M, K) : RandomS8Mat(K, M));
+    if (constantB) weights.push_back(transB ? RandomS8Mat(K, N) : RandomS8Mat(N, K));
+    if (constantA) weights.push_back(RandomMat(M, 10.f, 20.f));
+    if (constantB) weights.push_back(RandomMat(1, 10.f, 20.f));
+    if (input_count > 0)
+    {
+        // static input scales, absmax of the inputs is 10
+        ncnn::Mat bottom_blob_int8_scales(input_count);
+        bottom_blob_int8_scales.fill(127.f / 10.f);
+        weights.push_back(bottom_blob_int8_scales);
+    }
+
+    std::vector<ncnn::Mat> a;
+    if (!constantA)
+    {
+        a.push_back(transA ? (output_N1M ? ncnn::Mat(M, 1, K) : ncnn::Mat(M, K)) : (output_N1M ? ncnn::Mat(K, 1, M) : ncnn::Mat(K, M)));
+        RandomizeB(a[a.size() - 1], 10.f);
+    }
+    if (!constantB)
+    {
+        a.push_back(transB ? (output_N1M ? ncnn::Mat(K, 1, N) : ncnn::Mat(K, N)) : (output_N1M ? ncnn::Mat(N, 1, K) : ncnn::Mat(N, K)));
+        RandomizeB(a[a.size() - 1], 10.f);
+    }
+
+    int ret = test_layer("Gemm", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_gemm_int8_static failed M=%d N=%d K=%d alpha=%f transA=%d transB=%d output_elemtype=%d output_transpose=%d constantA=%d constantB=%d output_N1M=%d\n", M, N, K, alpha, transA, transB, output_elemtype, output_transpose, constantA, constantB, output_N1M);
+    }
+
+    return ret;
+}
+
 static int test_gemm_int8_bias(int M, int N, int K, const ncnn::Mat& C, float alpha, float beta, int transA, int transB, int output_elemtype, int output_transpose, int constantA, int constantB, int constantC)
 {
     int broadcast_type_C = 0;
@@ -399,7 +454,12 @@ static int test_gemm_0(int M, int N, int K)
            || test_gemm_int8(M, N, K, -5.1f, 1, 0, 0, 1, 1, 1, 1)
 
            || test_gemm_int8_fp16s(M, N, K, 1.f, 0, 1, 0, 0, 0, 0, 0)
-           || test_gemm_int8_fp16s(M, N, K, 1.f, 1, 0, 0, 1, 0, 0, 0);
+           || test_gemm_int8_fp16s(M, N, K, 1.f, 1, 0, 0, 1, 0, 0, 0)
+
+           || test_gemm_int8_static(M, N, K, 2.1f, 0, 1, 0, 0, 0, 0, 0)
+           || test_gemm_int8_static(M, N, K, 3.1f, 1, 0, 0, 1, 0, 0, 1)
+           || test_gemm_int8_static(M, N, K, 0.2f, 0, 1, 0, 0, 1, 0, 1)
+           || test_gemm_int8_static(M, N, K, 0.4f, 1, 0, 0, 0, 0, 1, 0);
 }
 
 static int test_gemm_1(int M, int N, int K)
@@ -3,6 +3,8 @@
 
 #include "testutil.h"
 
+#include "weight_quant.h"
+
 static int test_innerproduct(const ncnn::Mat& a, int outch, int bias)
 {
     ncnn::ParamDict pd;
@@ -246,6 +248,65 @@ static int test_innerproduct_5()
 }
 #endif // NCNN_INT8
 
+static int test_innerproduct_weight_quant(const ncnn::Mat& a, int outch, int bias, int bits, int group_size)
+{
+    const int k = a.dims == 2 ? a.w : a.w * a.h * a.c;
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch); // num_output
+    pd.set(1, bias);  // bias_term
+    pd.set(2, outch * k);
+    pd.set(11, bits);       // weight_quant_bits
+    pd.set(12, group_size); // weight_quant_group_size
+
+    int activation_type = RAND() % 7; // 0 1 2 3 4 5 6
+    ncnn::Mat activation_params(2);
+    activation_params[0] = (activation_type == 6) ? RandomFloat(0, 1) : RandomFloat(-1, 0); // alpha
+    activation_params[1] = RandomFloat(0, 1);                                               // beta
+    pd.set(9, activation_type);
+    pd.set(10, activation_params);
+
+    ncnn::Mat weight_data;
+    ncnn::Mat weight_data_quant_scales;
+    quantize_weight_quant(RandomMat(k, outch), weight_data, weight_data_quant_scales, k, bits, group_size, ncnn::Option());
+
+    std::vector<ncnn::Mat> weights(bias ? 3 : 2);
+    weights[0] = weight_data;
+    if (bias)
+    {
+        weights[1] = RandomMat(outch);
+        weights[2] = weight_data_quant_scales;
+    }
+    else
+    {
+        weights[1] = weight_data_quant_scales;
+    }
+
+    int ret = test_layer("InnerProduct", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_innerproduct_weight_quant failed a.dims=%d a=(%d %d %d) outch=%d bias=%d bits=%d group_size=%d act=%d actparams=[%f,%f]\n", a.dims, a.w, a.h, a.c, outch, bias, bits, group_size, activation_type, activation_params[0], activation_params[1]);
+    }
+
+    return ret;
+}
+
+static int test_innerproduct_6()
+{
+    return 0
+           || test_innerproduct_weight_quant(RandomMat(1, 3, 1), 1, 1, 8, 0)
+           || test_innerproduct_weight_quant(RandomMat(9, 3, 8), 7, 1, 8, 32)
+           || test_innerproduct_weight_quant(RandomMat(37), 16, 0, 8, 0)
+           || test_innerproduct_weight_quant(RandomMat(127), 9, 1, 4, 0)
+           || test_innerproduct_weight_quant(RandomMat(3, 5, 7), 8, 0, 4, 0)
+           || test_innerproduct_weight_quant(RandomMat(5, 4, 16), 12, 1, 4, 32)
+           || test_innerproduct_weight_quant(RandomMat(200), 3, 1, 4, 64)
+           || test_innerproduct_weight_quant(RandomMat(17, 12), 8, 1, 8, 0)
+           || test_innerproduct_weight_quant(RandomMat(64, 5), 16, 0, 8, 32)
+           || test_innerproduct_weight_quant(RandomMat(45, 7), 7, 1, 4, 0)
+           || test_innerproduct_weight_quant(RandomMat(96, 16), 13, 0, 4, 32);
+}
+
 int main()
 {
     SRAND(7767517);
@@ -257,12 +318,14 @@ int main()
            || test_innerproduct_2()
            || test_innerproduct_3()
            || test_innerproduct_4()
-           || test_innerproduct_5();
+           || test_innerproduct_5()
+           || test_innerproduct_6();
 #else
     return 0
            || test_innerproduct_0()
            || test_innerproduct_1()
            || test_innerproduct_2()
-           || test_innerproduct_4();
+           || test_innerproduct_4()
+           || test_innerproduct_6();
 #endif
 }
@@ -37,9 +37,21 @@ static int test_inversespectrogram_0()
            || test_inversespectrogram(124, 28, 55, 2, 12, 55, 1, 1, 2);
 }
 
+static int test_inversespectrogram_1()
+{
+    return 0
+           || test_inversespectrogram(9, 257, 512, 1, 128, 400, 1, 1, 0)
+           || test_inversespectrogram(11, 201, 400, 0, 160, 400, 1, 1, 1)
+           || test_inversespectrogram(31, 96, 96, 2, 24, 96, 2, 0, 2)
+           || test_inversespectrogram(8, 34, 66, 1, 33, 60, 1, 0, 0)
+           || test_inversespectrogram(21, 25, 49, 0, 10, 49, 2, 1, 1);
+}
+
 int main()
 {
     SRAND(7767517);
 
-    return test_inversespectrogram_0();
+    return 0
+           || test_inversespectrogram_0()
+           || test_inversespectrogram_1();
 }
@@ -0,0 +1,234 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "datareader.h"
+#include "layer.h"
+#include "net.h"
+#include "testutil.h"
+
+#include <string.h>
+
+// flag 0 for each weight header and random float32 weights
+class DataReaderRandomWeights : public ncnn::DataReader
+{
+public:
+    virtual size_t read(void* buf, size_t size) const
+    {
+        if (size == 4)
+        {
+            memset(buf, 0, size);
+            return size;
+        }
+
+        float* ptr = (float*)buf;
+        for (size_t i = 0; i < size / sizeof(float); i++)
+        {
+            ptr[i] = RandomFloat(-0.5f, 0.5f);
+        }
+
+        return size;
+    }
+};
+
+// two branches joined by concat
+static const char* param_txt = "7767517\n"
+                               "7 8\n"
+                               "Input            in       0 1 in 0=12 1=10 2=8\n"
+                               "Convolution      conv0    1 1 in c0 0=16 1=3 4=1 5=1 6=1152 9=1\n"
+                               "Split            split    1 2 c0 s0 s1\n"
+                               "Convolution      conv1    1 1 s0 c1 0=8 1=1 5=1 6=128 9=1\n"
+                               "ConvolutionDepthWise convdw 1 1 s1 c2 0=16 1=3 4=1 5=1 6=144 7=16\n"
+                               "Concat           concat   2 1 c1 c2 cat\n"
+                               "InnerProduct     out      1 1 cat out 0=10 1=1 2=28800\n";
+
+static int load_net(ncnn::Net& net, const ncnn::Option& opt)
+{
+    SRAND(7767517);
+
+    net.opt = opt;
+
+    int ret = net.load_param_mem(param_txt);
+    if (ret != 0)
+        return ret;
+
+    DataReaderRandomWeights dr;
+    return net.load_model(dr);
+}
+
+static int extract(const ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& out)
+{
+    ncnn::Extractor ex = net.create_extractor();
+
+    ex.input("in", in);
+    return ex.extract("out", out);
+}
+
+static int test_lazy_create_pipeline(const ncnn::Option& opt)
+{
+    ncnn::Net net_ref;
+    ncnn::Net net;
+    {
+        ncnn::Option opt_lazy = opt;
+        opt_lazy.use_lazy_create_pipeline = true;
+
+        if (load_net(net_ref, opt) != 0 || load_net(net, opt_lazy) != 0)
+        {
+            fprintf(stderr, "load net failed\n");
+            return -1;
+        }
+    }
+
+    ncnn::Mat in = RandomMat(12, 10, 8);
+
+    ncnn::Mat out_ref;
+    if (extract(net_ref, in, out_ref) != 0)
+        return -1;
+
+    const float epsilon = opt.use_fp16_packed || opt.use_fp16_storage ? 0.1 : 0.001;
+
+    // the first run creates the pipelines, the following runs reuse them
+    for (int i = 0; i < 2; i++)
+    {
+        ncnn::Mat out;
+        if (extract(net, in, out) != 0 || CompareMat(out, out_ref, epsilon) != 0)
+        {
+            fprintf(stderr, "test_lazy_create_pipeline failed run=%d use_packing_layout=%d use_fp16_storage=%d\n", i, opt.use_packing_layout, opt.use_fp16_storage);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_lazy_create_pipeline_0()
+{
+    ncnn::Option opts[3];
+
+    opts[0].use_packing_layout = false;
+    opts[0].use_fp16_packed = false;
+    opts[0].use_fp16_storage = false;
+    opts[0].use_bf16_storage = false;
+
+    opts[1].use_packing_layout = true;
+    opts[1].use_fp16_packed = true;
+    opts[1].use_fp16_storage = false;
+    opts[1].use_bf16_storage = false;
+
+    opts[2].use_packing_layout = true;
+    opts[2].use_fp16_packed = true;
+    opts[2].use_fp16_storage = true;
+    opts[2].use_bf16_storage = false;
+
+    for (int i = 0; i < 3; i++)
+    {
+        opts[i].num_threads = 1;
+
+        int ret = test_lazy_create_pipeline(opts[i]);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// copies the input and counts the pipelines created
+class PipelineProbe : public ncnn::Layer
+{
+public:
+    PipelineProbe()
+    {
+        one_blob_only = true;
+    }
+
+    virtual int create_pipeline(const ncnn::Option& /*opt*/)
+    {
+        created_count++;
+        return 0;
+    }
+
+    virtual int forward(const ncnn::Mat& bottom_blob, ncnn::Mat& top_blob, const ncnn::Option& opt) const
+    {
+        top_blob = bottom_blob.clone(opt.blob_allocator);
+        return top_blob.empty() ? -100 : 0;
+    }
+
+    static int created_count;
+};
+
+int PipelineProbe::created_count = 0;
+
+DEFINE_LAYER_CREATOR(PipelineProbe)
+
+static int test_lazy_create_pipeline_1()
+{
+    const char* param_str = "7767517\n"
+                            "4 5\n"
+                            "Input         data         0 1 data 0=8 1=4\n"
+                            "Split         splitncnn_0  1 2 data data_0 data_1\n"
+                            "PipelineProbe probe1       1 1 data_0 out1\n"
+                            "PipelineProbe probe2       1 1 data_1 out2\n";
+
+    PipelineProbe::created_count = 0;
+
+    ncnn::Net net;
+    net.opt.num_threads = 1;
+    net.opt.use_lazy_create_pipeline = true;
+    net.register_custom_layer("PipelineProbe", PipelineProbe_layer_creator);
+    net.load_param_mem(param_str);
+
+    const unsigned char model_data[1] = {0};
+    net.load_model(model_data);
+
+    if (PipelineProbe::created_count != 0)
+    {
+        fprintf(stderr, "%d pipelines created at load\n", PipelineProbe::created_count);
+        return -1;
+    }
+
+    ncnn::Mat in = RandomMat(8, 4);
+
+    // probe2 is never reached
+    for (int i = 0; i < 2; i++)
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("data", in);
+
+        ncnn::Mat out1;
+        int ret = ex.extract("out1", out1);
+        if (ret != 0 || CompareMat(out1, in, 0.001) != 0)
+            return -1;
+    }
+
+    if (PipelineProbe::created_count != 1)
+    {
+        fprintf(stderr, "%d pipelines created, expect 1\n", PipelineProbe::created_count);
+        return -1;
+    }
+
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("data", in);
+
+        ncnn::Mat out2;
+        int ret = ex.extract("out2", out2);
+        if (ret != 0 || CompareMat(out2, in, 0.001) != 0)
+            return -1;
+    }
+
+    if (PipelineProbe::created_count != 2)
+    {
+        fprintf(stderr, "%d pipelines created, expect 2\n", PipelineProbe::created_count);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_lazy_create_pipeline_0()
+           || test_lazy_create_pipeline_1();
+}
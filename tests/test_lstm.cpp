@@ -364,6 +364,52 @@ static int test_lstm_int8(int size, int T, int outch, int direction, int hidden_
     return ret;
 }
 
+static int test_lstm_int8_static(int size, int T, int outch, int direction, int hidden_size = 0)
+{
+    int num_directions = direction == 2 ? 2 : 1;
+    if (hidden_size == 0)
+        hidden_size = outch;
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);
+    pd.set(1, hidden_size * size * 4 * num_directions);
+    pd.set(2, direction);
+    pd.set(3, hidden_size);
+    pd.set(8, 3); // int8_scale_term
+
+    std::vector<ncnn::Mat> weights(hidden_size == outch ? 5 : 6);
+    weights[0] = RandomS8Mat(hidden_size * size * 4 * num_directions);
+    weights[1] = RandomMat(hidden_size * 4 * num_directions);
+    weights[2] = RandomS8Mat(outch * hidden_size * 4 * num_directions);
+    if (hidden_size != outch)
+    {
+        weights[3] = RandomMat(hidden_size * outch * num_directions);
+        weights[4] = RandomMat(hidden_size * 4 * num_directions, 100.f, 200.f);
+        weights[5] = RandomMat(hidden_size * 4 * num_directions, 100.f, 200.f);
+    }
+    else
+    {
+        weights[3] = RandomMat(hidden_size * 4 * num_directions, 100.f, 200.f);
+        weights[4] = RandomMat(hidden_size * 4 * num_directions, 100.f, 200.f);
+    }
+
+    // static input scale, absmax of the input is 10
+    ncnn::Mat bottom_blob_int8_scales(1);
+    bottom_blob_int8_scales[0] = 127.f / 10.f;
+    weights.push_back(bottom_blob_int8_scales);
+
+    ncnn::Mat a(size, T);
+    RandomizeA(a, 10.f);
+
+    int ret = test_layer("LSTM", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_lstm_int8_static failed size=%d T=%d outch=%d direction=%d hidden_size=%d\n", size, T, outch, direction, hidden_size);
+    }
+
+    return ret;
+}
+
 static int test_lstm_int8_with_hidden(int size, int T, int outch, int direction, int hidden_size = 0)
 {
     int num_directions = direction == 2 ? 2 : 1;
@@ -635,7 +681,13 @@ static int test_lstm_7()
            || test_lstm_int8(5, 16, 16, 1)
            || test_lstm_int8(3, 16, 8, 1)
            || test_lstm_int8(8, 16, 16, 1)
-           || test_lstm_int8(2, 5, 17, 1, 15);
+           || test_lstm_int8(2, 5, 17, 1, 15)
+
+           || test_lstm_int8_static(4, 1, 1, 0)
+           || test_lstm_int8_static(17, 8, 8, 1)
+           || test_lstm_int8_static(19, 15, 8, 2)
+           || test_lstm_int8_static(8, 16, 16, 2)
+           || test_lstm_int8_static(2, 5, 17, 2, 15);
 }
 #endif
 
@@ -43,6 +43,29 @@ static int test_matmul_transb(const ncnn::Mat& a, const ncnn::Mat& b)
     return ret;
 }
 
+#if NCNN_INT8
+static int test_matmul_int8(const ncnn::Mat& a, const ncnn::Mat& b, int transB)
+{
+    ncnn::ParamDict pd;
+    pd.set(0, transB);
+    pd.set(18, 2); // int8_scale_term
+
+    std::vector<ncnn::Mat> weights(0);
+
+    std::vector<ncnn::Mat> as(2);
+    as[0] = a;
+    as[1] = b;
+
+    int ret = test_layer("MatMul", pd, weights, as);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_matmul_int8 failed a.dims=%d a=(%d %d %d %d) b.dims=%d b=(%d %d %d %d) transB=%d\n", a.dims, a.w, a.h, a.d, a.c, b.dims, b.w, b.h, b.d, b.c, transB);
+    }
+
+    return ret;
+}
+#endif // NCNN_INT8
+
 static int test_matmul_0()
 {
     return 0
@@ -219,10 +242,75 @@ static int test_matmul_15()
            || test_matmul_transb(RandomMat(14, 20, 8, 18), RandomMat(14, 9, 8, 18));
 }
 
+#if NCNN_INT8
+static int test_matmul_16()
+{
+    return 0
+           || test_matmul_int8(RandomMat(124), RandomMat(124), 0)
+           || test_matmul_int8(RandomMat(16), RandomMat(12, 16), 0)
+           || test_matmul_int8(RandomMat(11), RandomMat(11, 16), 1)
+           || test_matmul_int8(RandomMat(14, 10), RandomMat(5, 14), 0)
+           || test_matmul_int8(RandomMat(16, 16), RandomMat(16, 10), 1)
+           || test_matmul_int8(RandomMat(14, 28), RandomMat(14), 0)
+           || test_matmul_int8(RandomMat(31, 4, 16), RandomMat(31), 1)
+           || test_matmul_int8(RandomMat(24), RandomMat(6, 24, 16), 0)
+           || test_matmul_int8(RandomMat(14, 23, 10), RandomMat(5, 14), 0)
+           || test_matmul_int8(RandomMat(16, 22, 16), RandomMat(16, 10, 16), 1)
+           || test_matmul_int8(RandomMat(5, 24), RandomMat(6, 5, 4, 19), 0)
+           || test_matmul_int8(RandomMat(14, 20, 8, 18), RandomMat(14, 9, 8, 18), 1);
+}
+
+// output columns of B spanning four orders of magnitude, each column is quantized with its own scale
+static ncnn::Mat RandomMatScaledColumns(int w, int h, int transB)
+{
+    ncnn::Mat m = RandomMat(w, h);
+    for (int i = 0; i < h; i++)
+    {
+        float* ptr = m.row(i);
+        for (int j = 0; j < w; j++)
+        {
+            const int n = transB ? i : j;
+            ptr[j] *= n % 3 == 0 ? 100.f : n % 3 == 1 ? 1.f : 0.01f;
+        }
+    }
+    return m;
+}
+
+static int test_matmul_17()
+{
+    return 0
+           || test_matmul_int8(RandomMat(14, 10), RandomMatScaledColumns(5, 14, 0), 0)
+           || test_matmul_int8(RandomMat(16, 16), RandomMatScaledColumns(16, 10, 1), 1)
+           || test_matmul_int8(RandomMat(24, 7, 3), RandomMatScaledColumns(12, 24, 0), 0)
+           || test_matmul_int8(RandomMat(32, 9, 3), RandomMatScaledColumns(32, 17, 1), 1);
+}
+#endif // NCNN_INT8
+
 int main()
 {
     SRAND(7767517);
 
+#if NCNN_INT8
+    return 0
+           || test_matmul_0()
+           || test_matmul_1()
+           || test_matmul_2()
+           || test_matmul_3()
+           || test_matmul_4()
+           || test_matmul_5()
+           || test_matmul_6()
+           || test_matmul_7()
+           || test_matmul_8()
+           || test_matmul_9()
+           || test_matmul_10()
+           || test_matmul_11()
+           || test_matmul_12()
+           || test_matmul_13()
+           || test_matmul_14()
+           || test_matmul_15()
+           || test_matmul_16()
+           || test_matmul_17();
+#else
     return 0
            || test_matmul_0()
            || test_matmul_1()
@@ -240,4 +328,5 @@ int main()
            || test_matmul_13()
            || test_matmul_14()
            || test_matmul_15();
+#endif
 }
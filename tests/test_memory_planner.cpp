@@ -0,0 +1,240 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "datareader.h"
+#include "net.h"
+#include "testutil.h"
+
+#include <string.h>
+
+// flag 0 for each weight header and random float32 weights
+class DataReaderRandomWeights : public ncnn::DataReader
+{
+public:
+    virtual size_t read(void* buf, size_t size) const
+    {
+        if (size == 4)
+        {
+            memset(buf, 0, size);
+            return size;
+        }
+
+        float* ptr = (float*)buf;
+        for (size_t i = 0; i < size / sizeof(float); i++)
+        {
+            ptr[i] = RandomFloat(-0.5f, 0.5f);
+        }
+
+        return size;
+    }
+};
+
+// two branches joined by concat, the split blobs die at different layers
+static const char* param_txt = "7767517\n"
+                               "8 9\n"
+                               "Input            in       0 1 in 0=12 1=10 2=8\n"
+                               "Convolution      conv0    1 1 in c0 0=16 1=3 4=1 5=1 6=1152 9=1\n"
+                               "Split            split    1 2 c0 s0 s1\n"
+                               "Convolution      conv1    1 1 s0 c1 0=8 1=1 5=1 6=128 9=1\n"
+                               "Convolution      conv2    1 1 s1 c2 0=8 1=3 4=1 5=1 6=1152 9=1\n"
+                               "Concat           concat   2 1 c1 c2 cat\n"
+                               "Convolution      conv3    1 1 cat c3 0=4 1=1 5=1 6=64\n"
+                               "Pooling          out      1 1 c3 out 0=1 4=1\n";
+
+static int load_net(ncnn::Net& net, const ncnn::Option& opt)
+{
+    SRAND(7767517);
+
+    net.opt = opt;
+
+    int ret = net.load_param_mem(param_txt);
+    if (ret != 0)
+        return ret;
+
+    DataReaderRandomWeights dr;
+    return net.load_model(dr);
+}
+
+static int extract(const ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& c3, ncnn::Mat& out)
+{
+    ncnn::Extractor ex = net.create_extractor();
+
+    ex.input("in", in);
+
+    int ret = ex.extract("c3", c3);
+    if (ret != 0)
+        return ret;
+
+    return ex.extract("out", out);
+}
+
+static int test_memory_planner(const ncnn::Option& opt)
+{
+    ncnn::Net net_ref;
+    ncnn::Net net;
+    {
+        ncnn::Option opt_planner = opt;
+        opt_planner.use_memory_planner = true;
+
+        if (load_net(net_ref, opt) != 0 || load_net(net, opt_planner) != 0)
+        {
+            fprintf(stderr, "load net failed\n");
+            return -1;
+        }
+    }
+
+    ncnn::Mat in = RandomMat(12, 10, 8);
+
+    ncnn::Mat c3_ref;
+    ncnn::Mat out_ref;
+    if (extract(net_ref, in, c3_ref, out_ref) != 0)
+        return -1;
+
+    const float epsilon = opt.use_fp16_storage ? 0.1 : 0.001;
+
+    // the first run records the plan, the following runs replay it
+    for (int i = 0; i < 3; i++)
+    {
+        ncnn::Mat c3;
+        ncnn::Mat out;
+        if (extract(net, in, c3, out) != 0)
+            return -1;
+
+        if (CompareMat(c3, c3_ref, epsilon) != 0 || CompareMat(out, out_ref, epsilon) != 0)
+        {
+            fprintf(stderr, "test_memory_planner failed run=%d use_packing_layout=%d use_fp16_storage=%d\n", i, opt.use_packing_layout, opt.use_fp16_storage);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_memory_planner_0()
+{
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_packing_layout = false;
+    opt.use_fp16_packed = false;
+    opt.use_fp16_storage = false;
+    opt.use_bf16_storage = false;
+
+    return test_memory_planner(opt);
+}
+
+static int test_memory_planner_1()
+{
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_packing_layout = true;
+    opt.use_fp16_packed = true;
+    opt.use_fp16_storage = false;
+    opt.use_bf16_storage = false;
+
+    int ret = test_memory_planner(opt);
+    if (ret != 0)
+        return ret;
+
+    opt.use_fp16_storage = true;
+
+    return test_memory_planner(opt);
+}
+
+class CountingAllocator : public ncnn::Allocator
+{
+public:
+    CountingAllocator()
+        : malloc_count(0)
+    {
+    }
+
+    virtual void* fastMalloc(size_t size)
+    {
+        malloc_count++;
+        return ncnn::fastMalloc(size);
+    }
+
+    virtual void fastFree(void* ptr)
+    {
+        ncnn::fastFree(ptr);
+    }
+
+    int malloc_count;
+};
+
+static int test_memory_planner_2()
+{
+    const char* param_str = "7767517\n"
+                            "4 4\n"
+                            "Input        data     0 1 data 0=16 1=16 2=8\n"
+                            "Convolution  conv     1 1 data conv 0=16 1=3 4=1 5=1 6=1152 9=1\n"
+                            "Convolution  conv2    1 1 conv out1 0=8 1=1 5=1 6=128\n"
+                            "Convolution  conv3    1 1 out1 out2 0=4 1=1 5=1 6=32\n";
+
+    // conv, conv2 and conv3 weights with flag and bias
+    ncnn::Mat model_data = RandomMat(1 + 1152 + 16 + 1 + 128 + 8 + 1 + 32 + 4);
+    model_data[0] = 0.f;
+    model_data[1 + 1152 + 16] = 0.f;
+    model_data[1 + 1152 + 16 + 1 + 128 + 8] = 0.f;
+
+    // layouts and extracted blobs stay as they are, so every allocation is counted
+    CountingAllocator blob_allocator;
+
+    ncnn::Net net;
+    net.opt.num_threads = 1;
+    net.opt.use_packing_layout = false;
+    net.opt.use_fp16_packed = false;
+    net.opt.use_fp16_storage = false;
+    net.opt.use_bf16_storage = false;
+    net.opt.use_memory_planner = true;
+    net.opt.blob_allocator = &blob_allocator;
+    net.load_param_mem(param_str);
+    net.load_model((const unsigned char*)model_data.data);
+
+    ncnn::Mat in = RandomMat(16, 16, 8);
+
+    // the first extractor records the plans
+    ncnn::Mat out1_ref;
+    ncnn::Mat out2_ref;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("data", in);
+        ex.extract("out1", out1_ref);
+        ex.extract("out2", out2_ref);
+    }
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.input("data", in);
+
+    // one arena, and the copy of out1 detached from it
+    ncnn::Mat out1;
+    blob_allocator.malloc_count = 0;
+    ex.extract("out1", out1);
+    if (blob_allocator.malloc_count != 2)
+    {
+        fprintf(stderr, "memory planner replay made %d allocations, expect 2\n", blob_allocator.malloc_count);
+        return -1;
+    }
+
+    // the arena is reused, only the copy of out2 is allocated
+    ncnn::Mat out2;
+    blob_allocator.malloc_count = 0;
+    ex.extract("out2", out2);
+    if (blob_allocator.malloc_count != 1)
+    {
+        fprintf(stderr, "memory planner replay made %d allocations, expect 1\n", blob_allocator.malloc_count);
+        return -1;
+    }
+
+    return CompareMat(out1, out1_ref, 0.001) || CompareMat(out2, out2_ref, 0.001);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_memory_planner_0()
+           || test_memory_planner_1()
+           || test_memory_planner_2();
+}
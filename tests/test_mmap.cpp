@@ -0,0 +1,198 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "datareader.h"
+#include "net.h"
+#include "testutil.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+static const char* param_txt = "7767517\n"
+                               "4 4\n"
+                               "Input        in       0 1 in 0=16 1=16 2=8\n"
+                               "Convolution  conv0    1 1 in c0 0=16 1=3 4=1 5=1 6=1152 9=1\n"
+                               "Convolution  conv1    1 1 c0 c1 0=8 1=1 5=1 6=128\n"
+                               "Convolution  out      1 1 c1 out 0=4 1=1 5=1 6=32\n";
+
+// conv0, conv1 and out weights with flag and bias
+static ncnn::Mat RandomModel()
+{
+    ncnn::Mat model_data = RandomMat(1 + 1152 + 16 + 1 + 128 + 8 + 1 + 32 + 4);
+    model_data[0] = 0.f;
+    model_data[1 + 1152 + 16] = 0.f;
+    model_data[1 + 1152 + 16 + 1 + 128 + 8] = 0.f;
+    return model_data;
+}
+
+static std::string temp_filepath(const char* filename)
+{
+    const char* tmpdir = getenv("TMPDIR");
+    if (!tmpdir)
+        tmpdir = getenv("TEMP");
+    if (!tmpdir)
+        tmpdir = "/tmp";
+
+    return std::string(tmpdir) + "/" + filename;
+}
+
+static int write_file(const char* filepath, const ncnn::Mat& m)
+{
+    FILE* fp = fopen(filepath, "wb");
+    if (!fp)
+    {
+        fprintf(stderr, "fopen %s failed\n", filepath);
+        return -1;
+    }
+
+    size_t nwrite = fwrite(m.data, m.elemsize, m.total(), fp);
+    fclose(fp);
+
+    return nwrite == m.total() ? 0 : -1;
+}
+
+static int extract(const ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& out)
+{
+    ncnn::Extractor ex = net.create_extractor();
+
+    ex.input("in", in);
+    return ex.extract("out", out);
+}
+
+static int test_mmap(const ncnn::Mat& model_data, const char* modelpath, const ncnn::Option& opt)
+{
+    ncnn::Net net_ref;
+    net_ref.opt = opt;
+    net_ref.load_param_mem(param_txt);
+    net_ref.load_model((const unsigned char*)model_data.data);
+
+    ncnn::Net net;
+    net.opt = opt;
+    net.load_param_mem(param_txt);
+    if (net.load_model_mmap(modelpath) != 0)
+    {
+        fprintf(stderr, "load_model_mmap failed\n");
+        return -1;
+    }
+
+    ncnn::Mat in = RandomMat(16, 16, 8);
+
+    ncnn::Mat out_ref;
+    ncnn::Mat out;
+    if (extract(net_ref, in, out_ref) != 0 || extract(net, in, out) != 0)
+        return -1;
+
+    const float epsilon = opt.use_fp16_packed || opt.use_fp16_storage ? 0.1 : 0.001;
+    if (CompareMat(out, out_ref, epsilon) != 0)
+    {
+        fprintf(stderr, "test_mmap failed use_packing_layout=%d use_fp16_storage=%d\n", opt.use_packing_layout, opt.use_fp16_storage);
+        return -1;
+    }
+
+    // a second mapping replaces the first one
+    if (net.load_model_mmap(modelpath) != 0 || extract(net, in, out) != 0 || CompareMat(out, out_ref, epsilon) != 0)
+    {
+        fprintf(stderr, "test_mmap reload failed use_packing_layout=%d use_fp16_storage=%d\n", opt.use_packing_layout, opt.use_fp16_storage);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_mmap_0()
+{
+    ncnn::Mat model_data = RandomModel();
+
+    const std::string modelpath = temp_filepath("test_mmap_0.bin");
+    if (write_file(modelpath.c_str(), model_data) != 0)
+        return -1;
+
+    ncnn::Option opts[3];
+
+    opts[0].use_packing_layout = false;
+    opts[0].use_fp16_packed = false;
+    opts[0].use_fp16_storage = false;
+    opts[0].use_bf16_storage = false;
+
+    opts[1].use_packing_layout = true;
+    opts[1].use_fp16_packed = true;
+    opts[1].use_fp16_storage = false;
+    opts[1].use_bf16_storage = false;
+
+    opts[2].use_packing_layout = true;
+    opts[2].use_fp16_packed = true;
+    opts[2].use_fp16_storage = true;
+    opts[2].use_bf16_storage = false;
+
+    int ret = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        opts[i].num_threads = 1;
+
+        ret = test_mmap(model_data, modelpath.c_str(), opts[i]);
+        if (ret != 0)
+            break;
+    }
+
+    remove(modelpath.c_str());
+
+    return ret;
+}
+
+static int test_mmap_1()
+{
+    ncnn::Mat model_data = RandomModel();
+
+    const std::string modelpath = temp_filepath("test_mmap_1.bin");
+    if (write_file(modelpath.c_str(), model_data) != 0)
+        return -1;
+
+    int ret = 0;
+    {
+        ncnn::DataReaderFromMmap dr(modelpath.c_str());
+
+        // reference and read walk the same cursor
+        const void* ref = 0;
+        float buf[4];
+        if (dr.empty()
+                || dr.reference(16 * sizeof(float), &ref) != 16 * sizeof(float)
+                || memcmp(ref, (const float*)model_data, 16 * sizeof(float)) != 0
+                || dr.read(buf, sizeof(buf)) != sizeof(buf)
+                || memcmp(buf, (const float*)model_data + 16, sizeof(buf)) != 0)
+        {
+            fprintf(stderr, "DataReaderFromMmap content mismatch\n");
+            ret = -1;
+        }
+
+        // nothing left past the end
+        const size_t rest = (model_data.total() - 20) * sizeof(float);
+        if (ret == 0 && (dr.reference(rest, &ref) != rest || dr.read(buf, sizeof(buf)) != 0))
+        {
+            fprintf(stderr, "DataReaderFromMmap read past the end\n");
+            ret = -1;
+        }
+    }
+
+    remove(modelpath.c_str());
+
+    // a missing file is not mapped
+    ncnn::Net net;
+    net.load_param_mem(param_txt);
+    if (ret == 0 && net.load_model_mmap(modelpath.c_str()) == 0)
+    {
+        fprintf(stderr, "load_model_mmap of a missing file succeeded\n");
+        ret = -1;
+    }
+
+    return ret;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_mmap_0()
+           || test_mmap_1();
+}
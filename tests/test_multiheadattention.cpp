@@ -121,6 +121,52 @@ static int test_multiheadattention_sameqkv(const ncnn::Mat& a, int embed_dim, in
     return ret;
 }
 
+static int test_multiheadattention_kvcache(const ncnn::Mat& a, int past_seqlen, int embed_dim, int num_heads, int attn_mask)
+{
+    const int qdim = a.w;
+
+    ncnn::ParamDict pd;
+    pd.set(0, embed_dim);
+    pd.set(1, num_heads);
+    pd.set(2, embed_dim * qdim);
+    pd.set(3, qdim);
+    pd.set(4, qdim);
+    pd.set(5, attn_mask);
+    pd.set(7, 1);
+
+    std::vector<ncnn::Mat> weights(8);
+    weights[0] = RandomMat(embed_dim * qdim);
+    weights[1] = RandomMat(embed_dim);
+    weights[2] = RandomMat(embed_dim * qdim);
+    weights[3] = RandomMat(embed_dim);
+    weights[4] = RandomMat(embed_dim * qdim);
+    weights[5] = RandomMat(embed_dim);
+    weights[6] = RandomMat(qdim * embed_dim);
+    weights[7] = RandomMat(qdim);
+
+    std::vector<ncnn::Mat> as(1);
+    as[0] = a;
+
+    if (attn_mask)
+    {
+        as.push_back(RandomMat(past_seqlen + a.h, a.h));
+    }
+
+    // the cache of the first step is empty
+    as.push_back(past_seqlen == 0 ? ncnn::Mat() : RandomMat(embed_dim, past_seqlen, 1));
+    as.push_back(past_seqlen == 0 ? ncnn::Mat() : RandomMat(embed_dim, past_seqlen, 1));
+
+    float epsilon = 0.005;
+
+    int ret = test_layer("MultiHeadAttention", pd, weights, as, 3, epsilon);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_multiheadattention_kvcache failed a=(%d %d) past_seqlen=%d embed_dim=%d num_heads=%d attn_mask=%d\n", a.w, a.h, past_seqlen, embed_dim, num_heads, attn_mask);
+    }
+
+    return ret;
+}
+
 static int test_multiheadattention_0()
 {
     return 0
@@ -152,6 +198,27 @@ static int test_multiheadattention_2()
            || test_multiheadattention_sameqkv(RandomMat(48, 127), 64, 8);
 }
 
+static int test_multiheadattention_3()
+{
+    return 0
+           || test_multiheadattention_kvcache(RandomMat(64, 1), 0, 64, 4, 0)
+           || test_multiheadattention_kvcache(RandomMat(16, 5), 0, 16, 2, 1)
+           || test_multiheadattention_kvcache(RandomMat(64, 1), 31, 64, 4, 0)
+           || test_multiheadattention_kvcache(RandomMat(48, 1), 16, 64, 8, 1)
+           || test_multiheadattention_kvcache(RandomMat(16, 4), 27, 16, 2, 0)
+           || test_multiheadattention_kvcache(RandomMat(12, 8), 40, 12, 3, 1);
+}
+
+static int test_multiheadattention_4()
+{
+    // long sequences span several key blocks of the fused attention
+    return 0
+           || test_multiheadattention(RandomMat(64, 384), RandomMat(64, 384), RandomMat(64, 384), 64, 4, 0)
+           || test_multiheadattention(RandomMat(64, 384), RandomMat(64, 384), RandomMat(64, 384), 64, 4, 1)
+           || test_multiheadattention(RandomMat(32, 33), RandomMat(40, 203), RandomMat(24, 203), 48, 3, 1)
+           || test_multiheadattention_sameqkv(RandomMat(96, 257), 96, 6);
+}
+
 int main()
 {
     SRAND(7767517);
@@ -159,5 +226,7 @@ int main()
     return 0
            || test_multiheadattention_0()
            || test_multiheadattention_1()
-           || test_multiheadattention_2();
+           || test_multiheadattention_2()
+           || test_multiheadattention_3()
+           || test_multiheadattention_4();
 }
@@ -55,6 +55,61 @@ static int test_multiheadattention_int8(const ncnn::Mat& q, const ncnn::Mat& k,
     return ret;
 }
 
+static int test_multiheadattention_int8_static(const ncnn::Mat& q, const ncnn::Mat& k, const ncnn::Mat& v, int embed_dim, int num_heads, int attn_mask)
+{
+    const int qdim = q.w;
+    const int kdim = k.w;
+    const int vdim = v.w;
+
+    ncnn::ParamDict pd;
+    pd.set(0, embed_dim);
+    pd.set(1, num_heads);
+    pd.set(2, embed_dim * qdim);
+    pd.set(3, kdim);
+    pd.set(4, vdim);
+    pd.set(5, attn_mask);
+    pd.set(6, 1.f / sqrtf(embed_dim / num_heads));
+    pd.set(18, 3); // int8_scale_term
+
+    std::vector<ncnn::Mat> weights(13);
+    weights[0] = RandomS8Mat(embed_dim * qdim);
+    weights[1] = RandomMat(embed_dim);
+    weights[2] = RandomS8Mat(embed_dim * kdim);
+    weights[3] = RandomMat(embed_dim);
+    weights[4] = RandomS8Mat(embed_dim * vdim);
+    weights[5] = RandomMat(embed_dim);
+    weights[6] = RandomS8Mat(qdim * embed_dim);
+    weights[7] = RandomMat(qdim);
+    weights[8] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[9] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[10] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[11] = RandomMat(1, 160.f, 200.f);
+
+    // static q k v input scales, RandomMat absmax is 1.2
+    weights[12].create(3);
+    weights[12].fill(127.f / 1.2f);
+
+    std::vector<ncnn::Mat> as(3);
+    as[0] = q;
+    as[1] = k;
+    as[2] = v;
+
+    if (attn_mask)
+    {
+        as.push_back(RandomMat(k.h, q.h));
+    }
+
+    float epsilon = 0.1;
+
+    int ret = test_layer("MultiHeadAttention", pd, weights, as, 1, epsilon);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_multiheadattention_int8_static failed q=(%d %d) k=(%d %d) v=(%d %d) embed_dim=%d num_heads=%d kdim=%d vdim=%d attn_mask=%d\n", q.w, q.h, k.w, k.h, v.w, v.h, embed_dim, num_heads, kdim, vdim, attn_mask);
+    }
+
+    return ret;
+}
+
 static int test_multiheadattention_int8_samekv(const ncnn::Mat& q, const ncnn::Mat& kv, int embed_dim, int num_heads)
 {
     const int qdim = q.w;
@@ -139,6 +194,50 @@ static int test_multiheadattention_int8_sameqkv(const ncnn::Mat& a, int embed_di
     return ret;
 }
 
+static int test_multiheadattention_int8_kvcache(const ncnn::Mat& a, int past_seqlen, int embed_dim, int num_heads)
+{
+    const int qdim = a.w;
+
+    ncnn::ParamDict pd;
+    pd.set(0, embed_dim);
+    pd.set(1, num_heads);
+    pd.set(2, embed_dim * qdim);
+    pd.set(3, qdim);
+    pd.set(4, qdim);
+    pd.set(6, 1.f / sqrtf(embed_dim / num_heads));
+    pd.set(7, 1);  // kv_cache
+    pd.set(18, 2); // int8_scale_term
+
+    std::vector<ncnn::Mat> weights(12);
+    weights[0] = RandomS8Mat(embed_dim * qdim);
+    weights[1] = RandomMat(embed_dim);
+    weights[2] = RandomS8Mat(embed_dim * qdim);
+    weights[3] = RandomMat(embed_dim);
+    weights[4] = RandomS8Mat(embed_dim * qdim);
+    weights[5] = RandomMat(embed_dim);
+    weights[6] = RandomS8Mat(qdim * embed_dim);
+    weights[7] = RandomMat(qdim);
+    weights[8] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[9] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[10] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[11] = RandomMat(1, 160.f, 200.f);
+
+    std::vector<ncnn::Mat> as(3);
+    as[0] = a;
+    as[1] = past_seqlen == 0 ? ncnn::Mat() : RandomMat(embed_dim, past_seqlen, 1);
+    as[2] = past_seqlen == 0 ? ncnn::Mat() : RandomMat(embed_dim, past_seqlen, 1);
+
+    float epsilon = 0.1;
+
+    int ret = test_layer("MultiHeadAttention", pd, weights, as, 3, epsilon);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_multiheadattention_int8_kvcache failed a=(%d %d) past_seqlen=%d embed_dim=%d num_heads=%d\n", a.w, a.h, past_seqlen, embed_dim, num_heads);
+    }
+
+    return ret;
+}
+
 static int test_multiheadattention_0()
 {
     return 0
@@ -169,6 +268,23 @@ static int test_multiheadattention_2()
            || test_multiheadattention_int8_sameqkv(RandomMat(64, 128), 64, 4)
            || test_multiheadattention_int8_sameqkv(RandomMat(48, 127), 64, 8);
 }
+
+static int test_multiheadattention_3()
+{
+    return 0
+           || test_multiheadattention_int8_static(RandomMat(62, 66), RandomMat(32, 66), RandomMat(20, 66), 62, 2, 0)
+           || test_multiheadattention_int8_static(RandomMat(26, 64), RandomMat(32, 64), RandomMat(18, 64), 26, 2, 1)
+           || test_multiheadattention_int8_static(RandomMat(48, 127), RandomMat(64, 127), RandomMat(64, 127), 64, 16, 1)
+           || test_multiheadattention_int8_static(RandomMat(12, 17), RandomMat(28, 32), RandomMat(11, 32), 12, 3, 0);
+}
+
+static int test_multiheadattention_4()
+{
+    return 0
+           || test_multiheadattention_int8_kvcache(RandomMat(32, 1), 0, 32, 4)
+           || test_multiheadattention_int8_kvcache(RandomMat(32, 1), 23, 32, 4)
+           || test_multiheadattention_int8_kvcache(RandomMat(12, 4), 17, 12, 3);
+}
 #endif
 
 int main()
@@ -179,7 +295,9 @@ int main()
     return 0
            || test_multiheadattention_0()
            || test_multiheadattention_1()
-           || test_multiheadattention_2();
+           || test_multiheadattention_2()
+           || test_multiheadattention_3()
+           || test_multiheadattention_4();
 #else
     // test nothing
     return 0;
@@ -0,0 +1,255 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "datareader.h"
+#include "net.h"
+#include "packedweightcache.h"
+#include "testutil.h"
+
+#include <string.h>
+
+// flag 0 for each weight header and random float32 weights
+class DataReaderRandomWeights : public ncnn::DataReader
+{
+public:
+    virtual size_t read(void* buf, size_t size) const
+    {
+        if (size == 4)
+        {
+            memset(buf, 0, size);
+            return size;
+        }
+
+        float* ptr = (float*)buf;
+        for (size_t i = 0; i < size / sizeof(float); i++)
+        {
+            ptr[i] = RandomFloat(-0.5f, 0.5f);
+        }
+
+        return size;
+    }
+};
+
+// convolution, gemm and innerproduct transform their weights in create_pipeline
+static const char* param_txt = "7767517\n"
+                               "8 9\n"
+                               "Input            in       0 1 in 0=12 1=10 2=8\n"
+                               "Convolution      conv0    1 1 in c0 0=16 1=3 4=1 5=1 6=1152 9=1\n"
+                               "Split            split    1 2 c0 s0 s1\n"
+                               "Convolution      conv1    1 1 s0 c1 0=8 1=1 5=1 6=128 9=1\n"
+                               "ConvolutionDepthWise convdw 1 1 s1 c2 0=16 1=3 4=1 5=1 6=144 7=16\n"
+                               "Concat           concat   2 1 c1 c2 cat\n"
+                               "Pooling          pool     1 1 cat p0 0=1 4=1\n"
+                               "InnerProduct     out      1 1 p0 out 0=10 1=1 2=240\n";
+
+static int load_net(ncnn::Net& net, const ncnn::Option& opt)
+{
+    SRAND(7767517);
+
+    net.opt = opt;
+
+    int ret = net.load_param_mem(param_txt);
+    if (ret != 0)
+        return ret;
+
+    DataReaderRandomWeights dr;
+    return net.load_model(dr);
+}
+
+static int extract(const ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& out)
+{
+    ncnn::Extractor ex = net.create_extractor();
+
+    ex.input("in", in);
+    return ex.extract("out", out);
+}
+
+static int test_packedweightcache(const ncnn::Option& opt)
+{
+    ncnn::Mat in = RandomMat(12, 10, 8);
+
+    FILE* fp = tmpfile();
+    if (!fp)
+    {
+        fprintf(stderr, "tmpfile failed\n");
+        return -1;
+    }
+
+    // the first load transforms weights and fills the cache
+    ncnn::Mat out_ref;
+    {
+        ncnn::PackedWeightCache cache;
+        ncnn::OptionExtension opt_extension;
+        opt_extension.packed_weight_cache = &cache;
+
+        ncnn::Net net;
+        ncnn::Option opt_cache = opt;
+        opt_cache.extension = &opt_extension;
+        if (load_net(net, opt_cache) != 0)
+        {
+            fprintf(stderr, "load net failed\n");
+            fclose(fp);
+            return -1;
+        }
+
+        if (cache.size() == 0)
+        {
+            fprintf(stderr, "packed weight cache is empty after load\n");
+            fclose(fp);
+            return -1;
+        }
+
+        if (extract(net, in, out_ref) != 0 || cache.save(fp) != 0)
+        {
+            fclose(fp);
+            return -1;
+        }
+    }
+
+    // the second load takes all transformed weights from the saved cache
+    ncnn::PackedWeightCache cache;
+    rewind(fp);
+    int ret = cache.load(fp);
+    fclose(fp);
+    if (ret != 0)
+    {
+        fprintf(stderr, "packed weight cache load failed\n");
+        return -1;
+    }
+
+    const int cache_size = cache.size();
+
+    ncnn::OptionExtension opt_extension;
+    opt_extension.packed_weight_cache = &cache;
+
+    ncnn::Net net;
+    ncnn::Option opt_cache = opt;
+    opt_cache.extension = &opt_extension;
+    if (load_net(net, opt_cache) != 0)
+    {
+        fprintf(stderr, "load net failed\n");
+        return -1;
+    }
+
+    if (cache.size() != cache_size)
+    {
+        fprintf(stderr, "packed weight cache missed %d transforms\n", cache.size() - cache_size);
+        return -1;
+    }
+
+    ncnn::Mat out;
+    if (extract(net, in, out) != 0)
+        return -1;
+
+    const float epsilon = opt.use_fp16_packed || opt.use_fp16_storage ? 0.1 : 0.001;
+    if (CompareMat(out, out_ref, epsilon) != 0)
+    {
+        fprintf(stderr, "test_packedweightcache failed use_packing_layout=%d use_fp16_storage=%d\n", opt.use_packing_layout, opt.use_fp16_storage);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_packedweightcache_0()
+{
+    ncnn::Option opts[3];
+
+    opts[0].use_packing_layout = false;
+    opts[0].use_fp16_packed = false;
+    opts[0].use_fp16_storage = false;
+    opts[0].use_bf16_storage = false;
+
+    opts[1].use_packing_layout = true;
+    opts[1].use_fp16_packed = true;
+    opts[1].use_fp16_storage = false;
+    opts[1].use_bf16_storage = false;
+
+    opts[2].use_packing_layout = true;
+    opts[2].use_fp16_packed = true;
+    opts[2].use_fp16_storage = true;
+    opts[2].use_bf16_storage = false;
+
+    for (int i = 0; i < 3; i++)
+    {
+        opts[i].num_threads = 1;
+
+        int ret = test_packedweightcache(opts[i]);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int test_packedweightcache_1()
+{
+    ncnn::PackedWeightCache cache;
+    cache.put(1, RandomMat(13, 7, 5));
+    cache.put(2, RandomMat(24));
+
+    FILE* fp = tmpfile();
+    if (!fp)
+    {
+        fprintf(stderr, "tmpfile failed\n");
+        return -1;
+    }
+
+    if (cache.save(fp) != 0)
+    {
+        fclose(fp);
+        return -1;
+    }
+
+    // entry_count at byte 16, dims and w of the first entry at byte 40 and 44
+    const int corrupts[4][2] = {
+        {16, -1},
+        {16, 0x7fffffff},
+        {40, 7},
+        {44, 0x7fffffff},
+    };
+
+    int ret = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        int value = 0;
+        fseek(fp, corrupts[i][0], SEEK_SET);
+        if (fread(&value, sizeof(int), 1, fp) != 1)
+            ret = -1;
+        fseek(fp, corrupts[i][0], SEEK_SET);
+        fwrite(&corrupts[i][1], sizeof(int), 1, fp);
+        fseek(fp, 0, SEEK_SET);
+
+        ncnn::PackedWeightCache cache2;
+        if (cache2.load(fp) != -1 || cache2.size() != 0)
+        {
+            fprintf(stderr, "corrupt packed weight cache offset %d value %d loaded\n", corrupts[i][0], corrupts[i][1]);
+            ret = -1;
+        }
+
+        fseek(fp, corrupts[i][0], SEEK_SET);
+        fwrite(&value, sizeof(int), 1, fp);
+    }
+
+    // the restored file loads again
+    ncnn::PackedWeightCache cache3;
+    fseek(fp, 0, SEEK_SET);
+    if (cache3.load(fp) != 0 || cache3.size() != 2)
+    {
+        fprintf(stderr, "restored packed weight cache failed to load\n");
+        ret = -1;
+    }
+
+    fclose(fp);
+
+    return ret;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_packedweightcache_0()
+           || test_packedweightcache_1();
+}
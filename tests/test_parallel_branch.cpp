@@ -0,0 +1,277 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "datareader.h"
+#include "net.h"
+#include "testutil.h"
+
+#include <string.h>
+
+// flag 0 for each weight header and random float32 weights
+class DataReaderRandomWeights : public ncnn::DataReader
+{
+public:
+    virtual size_t read(void* buf, size_t size) const
+    {
+        if (size == 4)
+        {
+            memset(buf, 0, size);
+            return size;
+        }
+
+        float* ptr = (float*)buf;
+        for (size_t i = 0; i < size / sizeof(float); i++)
+        {
+            ptr[i] = RandomFloat(-0.5f, 0.5f);
+        }
+
+        return size;
+    }
+};
+
+// two googlenet inception modules with fewer channels
+static const char* inception_param_txt = "7767517\n"
+                                         "21 27\n"
+                                         "Input            in       0 1 in 0=16 1=16 2=16\n"
+                                         "Split            split0   1 4 in s0 s1 s2 s3\n"
+                                         "Convolution      3a_1x1   1 1 s3 a1 0=8 1=1 5=1 6=128 9=1\n"
+                                         "Convolution      3a_3x3r  1 1 s2 a2r 0=8 1=1 5=1 6=128 9=1\n"
+                                         "Convolution      3a_3x3   1 1 a2r a2 0=12 1=3 4=1 5=1 6=864 9=1\n"
+                                         "Convolution      3a_5x5r  1 1 s1 a3r 0=4 1=1 5=1 6=64 9=1\n"
+                                         "Convolution      3a_5x5   1 1 a3r a3 0=6 1=5 4=2 5=1 6=600 9=1\n"
+                                         "Pooling          3a_pool  1 1 s0 a4p 1=3 3=1\n"
+                                         "Convolution      3a_proj  1 1 a4p a4 0=6 1=1 5=1 6=96 9=1\n"
+                                         "Concat           3a_out   4 1 a1 a2 a3 a4 a\n"
+                                         "Split            split1   1 4 a t0 t1 t2 t3\n"
+                                         "Convolution      3b_1x1   1 1 t3 b1 0=16 1=1 5=1 6=512 9=1\n"
+                                         "Convolution      3b_3x3r  1 1 t2 b2r 0=8 1=1 5=1 6=256 9=1\n"
+                                         "Convolution      3b_3x3   1 1 b2r b2 0=16 1=3 4=1 5=1 6=1152 9=1\n"
+                                         "Convolution      3b_5x5r  1 1 t1 b3r 0=4 1=1 5=1 6=128 9=1\n"
+                                         "Convolution      3b_5x5   1 1 b3r b3 0=8 1=5 4=2 5=1 6=800 9=1\n"
+                                         "Pooling          3b_pool  1 1 t0 b4p 1=3 3=1\n"
+                                         "Convolution      3b_proj  1 1 b4p b4 0=8 1=1 5=1 6=256 9=1\n"
+                                         "Concat           3b_out   4 1 b1 b2 b3 b4 b\n"
+                                         "Pooling          pool     1 1 b p 0=1 4=1\n"
+                                         "InnerProduct     out      1 1 p out 0=10 1=1 2=480\n";
+
+// c0 and c1 are read by several layers without a split, sigmoid would modify c0 in place
+static const char* shared_param_txt = "7767517\n"
+                                      "9 9\n"
+                                      "Input            in       0 1 in 0=12 1=10 2=8\n"
+                                      "Convolution      conv0    1 1 in c0 0=16 1=3 4=1 5=1 6=1152 9=1\n"
+                                      "Convolution      conv1    1 1 c0 c1 0=8 1=1 5=1 6=128\n"
+                                      "ConvolutionDepthWise convdw 1 1 c0 c2 0=16 1=3 4=1 5=1 6=144 7=16\n"
+                                      "Convolution      conv2    1 1 c2 c3 0=8 1=1 5=1 6=128\n"
+                                      "Sigmoid          sigmoid  1 1 c0 c4\n"
+                                      "Convolution      conv3    1 1 c4 c5 0=8 1=1 5=1 6=128\n"
+                                      "BinaryOp         mul      2 1 c1 c1 m 0=2\n"
+                                      "Eltwise          out      3 1 m c3 c5 out 0=1\n";
+
+static int load_net(ncnn::Net& net, const char* param_txt, const ncnn::Option& opt)
+{
+    SRAND(7767517);
+
+    net.opt = opt;
+
+    int ret = net.load_param_mem(param_txt);
+    if (ret != 0)
+        return ret;
+
+    DataReaderRandomWeights dr;
+    return net.load_model(dr);
+}
+
+static int extract(const ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& out)
+{
+    ncnn::Extractor ex = net.create_extractor();
+
+    ex.input("in", in);
+    return ex.extract("out", out);
+}
+
+static int test_parallel_branch(const char* param_txt, const ncnn::Mat& in, const ncnn::Option& opt)
+{
+    ncnn::Net net_ref;
+    ncnn::Net net;
+    {
+        // the serial path releases a blob after its first consumer in light mode
+        ncnn::Option opt_ref = opt;
+        opt_ref.lightmode = false;
+
+        ncnn::Option opt_parallel = opt;
+        opt_parallel.use_parallel_branch = true;
+
+        if (load_net(net_ref, param_txt, opt_ref) != 0 || load_net(net, param_txt, opt_parallel) != 0)
+        {
+            fprintf(stderr, "load net failed\n");
+            return -1;
+        }
+    }
+
+    ncnn::Mat out_ref;
+    if (extract(net_ref, in, out_ref) != 0)
+        return -1;
+
+    const float epsilon = opt.use_fp16_packed || opt.use_fp16_storage ? 0.1 : 0.001;
+
+    // the first run starts the workers, the following runs reuse them
+    for (int i = 0; i < 3; i++)
+    {
+        ncnn::Mat out;
+        if (extract(net, in, out) != 0 || CompareMat(out, out_ref, epsilon) != 0)
+        {
+            fprintf(stderr, "test_parallel_branch failed run=%d lightmode=%d use_packing_layout=%d use_fp16_storage=%d\n", i, opt.lightmode, opt.use_packing_layout, opt.use_fp16_storage);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_parallel_branch(const char* param_txt, const ncnn::Mat& in)
+{
+    ncnn::Option opts[4];
+
+    opts[0].use_packing_layout = false;
+    opts[0].use_fp16_packed = false;
+    opts[0].use_fp16_storage = false;
+    opts[0].use_bf16_storage = false;
+
+    opts[1].use_packing_layout = true;
+    opts[1].use_fp16_packed = true;
+    opts[1].use_fp16_storage = false;
+    opts[1].use_bf16_storage = false;
+
+    opts[2].use_packing_layout = true;
+    opts[2].use_fp16_packed = true;
+    opts[2].use_fp16_storage = true;
+    opts[2].use_bf16_storage = false;
+
+    opts[3].lightmode = false;
+    opts[3].use_packing_layout = true;
+    opts[3].use_fp16_packed = false;
+    opts[3].use_fp16_storage = false;
+    opts[3].use_bf16_storage = false;
+
+    for (int i = 0; i < 4; i++)
+    {
+        opts[i].num_threads = 4;
+
+        int ret = test_parallel_branch(param_txt, in, opts[i]);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int test_parallel_branch_0()
+{
+    return test_parallel_branch(inception_param_txt, RandomMat(16, 16, 16));
+}
+
+static int test_parallel_branch_1()
+{
+    return test_parallel_branch(shared_param_txt, RandomMat(12, 10, 8));
+}
+
+#if NCNN_THREADS
+struct extract_thread_args
+{
+    const ncnn::Net* net;
+    const ncnn::Mat* in;
+    const ncnn::Mat* out_ref;
+    int result;
+};
+
+static void* extract_thread(void* args)
+{
+    extract_thread_args* ta = (extract_thread_args*)args;
+
+    for (int i = 0; i < 4; i++)
+    {
+        ncnn::Mat out;
+        if (extract(*ta->net, *ta->in, out) != 0 || CompareMat(out, *ta->out_ref, 0.001) != 0)
+            ta->result = -1;
+    }
+
+    return 0;
+}
+
+static int test_parallel_branch_2()
+{
+    // extractors on several threads share the workers of the net
+    ncnn::Option opt;
+    opt.num_threads = 4;
+    opt.use_packing_layout = true;
+    opt.use_fp16_packed = false;
+    opt.use_fp16_storage = false;
+    opt.use_bf16_storage = false;
+
+    ncnn::Net net_ref;
+    ncnn::Net net;
+    {
+        ncnn::Option opt_parallel = opt;
+        opt_parallel.use_parallel_branch = true;
+
+        if (load_net(net_ref, inception_param_txt, opt) != 0 || load_net(net, inception_param_txt, opt_parallel) != 0)
+        {
+            fprintf(stderr, "load net failed\n");
+            return -1;
+        }
+    }
+
+    ncnn::Mat in = RandomMat(16, 16, 16);
+
+    ncnn::Mat out_ref;
+    if (extract(net_ref, in, out_ref) != 0)
+        return -1;
+
+    const int thread_count = 3;
+
+    extract_thread_args args[thread_count];
+    ncnn::Thread* threads[thread_count];
+    for (int i = 0; i < thread_count; i++)
+    {
+        args[i].net = &net;
+        args[i].in = &in;
+        args[i].out_ref = &out_ref;
+        args[i].result = 0;
+        threads[i] = new ncnn::Thread(extract_thread, &args[i]);
+    }
+
+    int ret = 0;
+    for (int i = 0; i < thread_count; i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+
+        if (args[i].result != 0)
+            ret = -1;
+    }
+
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_parallel_branch_2 concurrent extract failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+#endif // NCNN_THREADS
+
+int main()
+{
+    SRAND(7767517);
+
+#if NCNN_THREADS
+    return 0
+           || test_parallel_branch_0()
+           || test_parallel_branch_1()
+           || test_parallel_branch_2();
+#else
+    return 0
+           || test_parallel_branch_0()
+           || test_parallel_branch_1();
+#endif
+}
@@ -0,0 +1,399 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "datareader.h"
+#include "net.h"
+#include "profiler.h"
+#include "testutil.h"
+
+#include <string.h>
+
+// flag 0 for each weight header and random float32 weights
+class DataReaderRandomWeights : public ncnn::DataReader
+{
+public:
+    virtual size_t read(void* buf, size_t size) const
+    {
+        if (size == 4)
+        {
+            memset(buf, 0, size);
+            return size;
+        }
+
+        float* ptr = (float*)buf;
+        for (size_t i = 0; i < size / sizeof(float); i++)
+        {
+            ptr[i] = RandomFloat(-0.5f, 0.5f);
+        }
+
+        return size;
+    }
+};
+
+// two branches joined by concat
+static const char* param_txt = "7767517\n"
+                               "7 8\n"
+                               "Input            in       0 1 in 0=12 1=10 2=8\n"
+                               "Convolution      conv0    1 1 in c0 0=16 1=3 4=1 5=1 6=1152\n"
+                               "Split            split    1 2 c0 s0 s1\n"
+                               "ReLU             relu     1 1 s0 r0\n"
+                               "Convolution      conv1    1 1 s1 c1 0=8 1=1 5=1 6=128\n"
+                               "Concat           concat   2 1 r0 c1 cat\n"
+                               "Pooling          out      1 1 cat out 0=1 4=1\n";
+
+static int load_net(ncnn::Net& net, const ncnn::Option& opt)
+{
+    net.opt = opt;
+
+    int ret = net.load_param_mem(param_txt);
+    if (ret != 0)
+        return ret;
+
+    DataReaderRandomWeights dr;
+    return net.load_model(dr);
+}
+
+static int extract(const ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& out, ncnn::Profiler* profiler)
+{
+    ncnn::Extractor ex = net.create_extractor();
+    ex.set_profiler(profiler);
+
+    ex.input("in", in);
+    return ex.extract("out", out);
+}
+
+static int find_layer_event(const std::vector<ncnn::ProfilerEvent>& events, int layer_index)
+{
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        if (events[i].type == 0 && events[i].layer_index == layer_index)
+            return (int)i;
+    }
+
+    return -1;
+}
+
+static int check_events(const ncnn::Net& net, const std::vector<ncnn::ProfilerEvent>& events, const char* tag)
+{
+    const std::vector<ncnn::Layer*>& layers = net.layers();
+
+    // every layer but input forwarded once
+    int layer_event_count = 0;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const ncnn::ProfilerEvent& e = events[i];
+
+        if (e.end < e.start || e.layer_index < 0 || e.layer_index >= (int)layers.size() || e.layer != layers[e.layer_index])
+        {
+            fprintf(stderr, "%s event %d broken\n", tag, (int)i);
+            return -1;
+        }
+
+        if (e.type == 0)
+        {
+            layer_event_count++;
+
+            if (e.bottom_shapes.size() != e.layer->bottoms.size() || e.top_shapes.size() != e.layer->tops.size())
+            {
+                fprintf(stderr, "%s event %d shape count mismatch\n", tag, (int)i);
+                return -1;
+            }
+        }
+        else
+        {
+            // conversion inside the forward span of its layer
+            int j = find_layer_event(events, e.layer_index);
+            if (j == -1 || e.start < events[j].start || e.end > events[j].end || e.thread_id != events[j].thread_id)
+            {
+                fprintf(stderr, "%s conversion event %d outside its layer\n", tag, (int)i);
+                return -1;
+            }
+
+            if (e.bottom_shapes.size() != 1 || e.top_shapes.size() != 1)
+            {
+                fprintf(stderr, "%s conversion event %d shape count mismatch\n", tag, (int)i);
+                return -1;
+            }
+        }
+    }
+
+    if (layer_event_count != (int)layers.size() - 1)
+    {
+        fprintf(stderr, "%s expect %d layer events but got %d\n", tag, (int)layers.size() - 1, layer_event_count);
+        return -1;
+    }
+
+    // conv0 consumes the 12x10x8 input and produces 16 channels with padding
+    int j = find_layer_event(events, 1);
+    if (j == -1)
+    {
+        fprintf(stderr, "%s conv0 event missing\n", tag);
+        return -1;
+    }
+
+    const ncnn::Mat& bottom = events[j].bottom_shapes[0];
+    const ncnn::Mat& top = events[j].top_shapes[0];
+    if (bottom.w != 12 || bottom.h != 10 || bottom.c * bottom.elempack != 8 || top.w != 12 || top.h != 10 || top.c * top.elempack != 16 || bottom.data || top.data)
+    {
+        fprintf(stderr, "%s conv0 shapes mismatch\n", tag);
+        return -1;
+    }
+
+    if (events[j].blob_allocated_bytes < top.total() * top.elemsize)
+    {
+        fprintf(stderr, "%s conv0 blob allocated bytes %lu too small\n", tag, (unsigned long)events[j].blob_allocated_bytes);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_profiler_0()
+{
+    // profiled extract gives the same result and one event per layer in every forward strategy
+    ncnn::Mat in = RandomMat(12, 10, 8);
+
+    for (int k = 0; k < 4; k++)
+    {
+        ncnn::Option opt;
+        opt.use_execution_plan = k == 1;
+        opt.use_memory_planner = k == 2;
+        opt.use_parallel_branch = k == 3;
+        opt.num_threads = k == 3 ? 2 : 1;
+
+        ncnn::Net net;
+        int ret = load_net(net, opt);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_profiler_0 load_net failed\n");
+            return -1;
+        }
+
+        ncnn::Mat out_ref;
+        ret = extract(net, in, out_ref, 0);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_profiler_0 extract failed\n");
+            return -1;
+        }
+
+        ncnn::ProfileCollector profiler;
+
+        ncnn::Mat out;
+        ret = extract(net, in, out, &profiler);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_profiler_0 profiled extract failed\n");
+            return -1;
+        }
+
+        if (CompareMat(out, out_ref, 0.001) != 0)
+        {
+            fprintf(stderr, "test_profiler_0 output mismatch k=%d\n", k);
+            return -1;
+        }
+
+        char tag[64];
+        sprintf(tag, "test_profiler_0 k=%d", k);
+        if (check_events(net, profiler.events(), tag) != 0)
+            return -1;
+
+        // the returned mat does not reference the counting allocator of net
+        net.clear();
+
+        if (CompareMat(out, out_ref, 0.001) != 0)
+        {
+            fprintf(stderr, "test_profiler_0 output changed after net clear k=%d\n", k);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_profiler_1()
+{
+    // layout conversion before packed layers is recorded
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_packing_layout = true;
+
+    ncnn::Net net;
+    int ret = load_net(net, opt);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_profiler_1 load_net failed\n");
+        return -1;
+    }
+
+    ncnn::ProfileCollector profiler;
+
+    ncnn::Mat out;
+    ret = extract(net, RandomMat(12, 10, 8), out, &profiler);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_profiler_1 extract failed\n");
+        return -1;
+    }
+
+    std::vector<ncnn::ProfilerEvent> events = profiler.events();
+
+    int conversion_count = 0;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const ncnn::ProfilerEvent& e = events[i];
+        if (e.type != 1)
+            continue;
+
+        conversion_count++;
+
+        if (e.bottom_shapes[0].elempack == e.top_shapes[0].elempack && e.bottom_shapes[0].elemsize == e.top_shapes[0].elemsize)
+        {
+            fprintf(stderr, "test_profiler_1 conversion event %d without conversion\n", (int)i);
+            return -1;
+        }
+    }
+
+    // the 8 channel input is packed for conv0 when the layer supports packing
+    if (net.layers()[1]->support_packing && conversion_count == 0)
+    {
+        fprintf(stderr, "test_profiler_1 conversion events missing\n");
+        return -1;
+    }
+
+    // nothing is recorded without profiler
+    profiler.clear();
+
+    ret = extract(net, RandomMat(12, 10, 8), out, 0);
+    if (ret != 0 || !profiler.events().empty())
+    {
+        fprintf(stderr, "test_profiler_1 events recorded without profiler\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_profiler_2()
+{
+    // chrome trace export
+    ncnn::Option opt;
+    opt.num_threads = 1;
+
+    ncnn::Net net;
+    int ret = load_net(net, opt);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_profiler_2 load_net failed\n");
+        return -1;
+    }
+
+    ncnn::ProfileCollector profiler;
+
+    ncnn::Mat out;
+    ret = extract(net, RandomMat(12, 10, 8), out, &profiler);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_profiler_2 extract failed\n");
+        return -1;
+    }
+
+    FILE* fp = tmpfile();
+    if (!fp)
+    {
+        fprintf(stderr, "test_profiler_2 tmpfile failed\n");
+        return -1;
+    }
+
+    ret = profiler.save_chrome_trace(fp);
+
+    std::vector<char> json(65536, 0);
+    rewind(fp);
+    size_t nread = fread(&json[0], 1, json.size() - 1, fp);
+    fclose(fp);
+
+    if (ret != 0 || nread == 0)
+    {
+        fprintf(stderr, "test_profiler_2 save_chrome_trace failed\n");
+        return -1;
+    }
+
+    const char* s = &json[0];
+    if (strncmp(s, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 39) != 0 || !strstr(s, "\"name\":\"conv1\"") || !strstr(s, "\"type\":\"Concat\"") || !strstr(s, "\"ph\":\"X\"") || !strstr(s, "\n]}\n"))
+    {
+        fprintf(stderr, "test_profiler_2 chrome trace malformed\n%s\n", s);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_profiler_3()
+{
+    // a new allocator for every extract, counting allocators of the dead ones are dropped
+    ncnn::Mat in = RandomMat(12, 10, 8);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+
+    ncnn::Net net;
+    int ret = load_net(net, opt);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_profiler_3 load_net failed\n");
+        return -1;
+    }
+
+    ncnn::Mat out_ref;
+    ret = extract(net, in, out_ref, 0);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_profiler_3 extract failed\n");
+        return -1;
+    }
+
+    for (int i = 0; i < 40; i++)
+    {
+        ncnn::UnlockedPoolAllocator blob_allocator;
+        ncnn::UnlockedPoolAllocator workspace_allocator;
+        ncnn::ProfileCollector profiler;
+
+        ncnn::Mat out;
+        {
+            ncnn::Extractor ex = net.create_extractor();
+            ex.set_blob_allocator(&blob_allocator);
+            ex.set_workspace_allocator(&workspace_allocator);
+            ex.set_profiler(&profiler);
+
+            ex.input("in", in);
+            ret = ex.extract("out", out);
+            if (ret != 0)
+            {
+                fprintf(stderr, "test_profiler_3 profiled extract failed\n");
+                return -1;
+            }
+        }
+
+        if (CompareMat(out, out_ref, 0.001) != 0)
+        {
+            fprintf(stderr, "test_profiler_3 output mismatch i=%d\n", i);
+            return -1;
+        }
+
+        if (check_events(net, profiler.events(), "test_profiler_3") != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_profiler_0()
+           || test_profiler_1()
+           || test_profiler_2()
+           || test_profiler_3();
+}
@@ -316,6 +316,40 @@ static int test_rnn_int8(int size, int T, int outch, int direction)
     return ret;
 }
 
+static int test_rnn_int8_static(int size, int T, int outch, int direction)
+{
+    int num_directions = direction == 2 ? 2 : 1;
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);
+    pd.set(1, outch * size * num_directions);
+    pd.set(2, direction);
+    pd.set(8, 3); // int8_scale_term
+
+    std::vector<ncnn::Mat> weights(5);
+    weights[0] = RandomS8Mat(outch * size * num_directions);
+    weights[1] = RandomMat(outch * num_directions);
+    weights[2] = RandomS8Mat(outch * outch * num_directions);
+    weights[3] = RandomMat(outch * num_directions, 100.f, 200.f);
+    weights[4] = RandomMat(outch * num_directions, 100.f, 200.f);
+
+    // static input scale, absmax of the input is 10
+    ncnn::Mat bottom_blob_int8_scales(1);
+    bottom_blob_int8_scales[0] = 127.f / 10.f;
+    weights.push_back(bottom_blob_int8_scales);
+
+    ncnn::Mat a(size, T);
+    RandomizeA(a, 10.f);
+
+    int ret = test_layer("RNN", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_rnn_int8_static failed size=%d T=%d outch=%d direction=%d\n", size, T, outch, direction);
+    }
+
+    return ret;
+}
+
 int test_rnn_int8_with_hidden(int size, int T, int outch, int direction)
 {
     int num_directions = direction == 2 ? 2 : 1;
@@ -541,7 +575,12 @@ static int test_rnn_7()
            || test_rnn_int8(5, 16, 16, 1)
            || test_rnn_int8(3, 16, 8, 1)
            || test_rnn_int8(8, 16, 16, 1)
-           || test_rnn_int8(2, 5, 17, 1);
+           || test_rnn_int8(2, 5, 17, 1)
+
+           || test_rnn_int8_static(4, 1, 1, 0)
+           || test_rnn_int8_static(17, 8, 8, 1)
+           || test_rnn_int8_static(19, 15, 8, 2)
+           || test_rnn_int8_static(8, 16, 16, 2);
 }
 #endif
 
@@ -39,9 +39,21 @@ static int test_spectrogram_0()
            || test_spectrogram(124, 55, 2, 12, 55, 1, 1, 2, 2, 0);
 }
 
+static int test_spectrogram_1()
+{
+    return 0
+           || test_spectrogram(1000, 512, 2, 128, 400, 1, 1, 2, 0, 1)
+           || test_spectrogram(2000, 400, 0, 160, 400, 1, 1, 2, 1, 1)
+           || test_spectrogram(777, 96, 1, 24, 96, 2, 1, 0, 2, 0)
+           || test_spectrogram(300, 66, 0, 33, 60, 1, 0, 0, 0, 0)
+           || test_spectrogram(250, 49, 2, 10, 49, 2, 1, 1, 1, 1);
+}
+
 int main()
 {
     SRAND(7767517);
 
-    return test_spectrogram_0();
+    return 0
+           || test_spectrogram_0()
+           || test_spectrogram_1();
 }
@@ -147,7 +147,7 @@ static ncnn::Mat read_file_content(const char* filepath)
     return m;
 }
 
-static int test_squeezenet(const ncnn::Option& opt, int load_model_type, float epsilon = 0.001)
+static int test_squeezenet(const ncnn::Option& opt, int load_model_type, float epsilon = 0.001, int run_count = 1)
 {
     ncnn::Net squeezenet;
 
@@ -206,28 +206,35 @@ static int test_squeezenet(const ncnn::Option& opt, int load_model_type, float e
     const float mean_vals[3] = {104.f, 117.f, 123.f};
     in.substract_mean_normalize(mean_vals, 0);
 
-    ncnn::Extractor ex = squeezenet.create_extractor();
-
-    ncnn::Mat out;
-    if (load_model_type == 0 || load_model_type == 1)
+    for (int i = 0; i < run_count; i++)
     {
-        ex.input("data", in);
-        ex.extract("prob", out);
-    }
-    if (load_model_type == 2 || load_model_type == 3)
-    {
-        ex.input(0, in);
-        ex.extract(82, out);
-    }
+        ncnn::Extractor ex = squeezenet.create_extractor();
 
-    std::vector<float> cls_scores;
-    cls_scores.resize(out.w);
-    for (int j = 0; j < out.w; j++)
-    {
-        cls_scores[j] = out[j];
+        ncnn::Mat out;
+        if (load_model_type == 0 || load_model_type == 1)
+        {
+            ex.input("data", in);
+            ex.extract("prob", out);
+        }
+        if (load_model_type == 2 || load_model_type == 3)
+        {
+            ex.input(0, in);
+            ex.extract(82, out);
+        }
+
+        std::vector<float> cls_scores;
+        cls_scores.resize(out.w);
+        for (int j = 0; j < out.w; j++)
+        {
+            cls_scores[j] = out[j];
+        }
+
+        int ret = check_top2(cls_scores, epsilon);
+        if (ret != 0)
+            return ret;
     }
 
-    return check_top2(cls_scores, epsilon);
+    return 0;
 }
 
 class MyConvolution : public ncnn::Layer
@@ -503,5 +510,39 @@ int main()
 #endif // NCNN_VULKAN
     }
 
+    for (int i = 0; i < 4; i++)
+    {
+        ncnn::Option opt = opts[i];
+        opt.num_threads = 4;
+        opt.use_vulkan_compute = false;
+        opt.use_parallel_create_pipeline = true;
+
+        float epsilon = opt.use_fp16_packed || opt.use_fp16_storage ? 0.1 : 0.01;
+
+        int ret = test_squeezenet(opt, load_model_types[i], epsilon);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_squeezenet parallel create_pipeline failed use_packing_layout=%d use_fp16_storage=%d\n", opt.use_packing_layout, opt.use_fp16_storage);
+            return ret;
+        }
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        ncnn::Option opt = opts[i];
+        opt.use_vulkan_compute = false;
+        opt.use_execution_plan = true;
+
+        float epsilon = opt.use_fp16_packed || opt.use_fp16_storage ? 0.1 : 0.01;
+
+        // the first run compiles the plan, the following runs replay it
+        int ret = test_squeezenet(opt, load_model_types[i], epsilon, 2);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_squeezenet execution plan failed use_packing_layout=%d\n", opt.use_packing_layout);
+            return ret;
+        }
+    }
+
     return 0;
 }
@@ -0,0 +1,559 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "datareader.h"
+#include "net.h"
+#include "testutil.h"
+
+#include <string.h>
+
+// flag 0 for each weight header and random float32 weights
+class DataReaderRandomWeights : public ncnn::DataReader
+{
+public:
+    virtual size_t read(void* buf, size_t size) const
+    {
+        if (size == 4)
+        {
+            memset(buf, 0, size);
+            return size;
+        }
+
+        float* ptr = (float*)buf;
+        for (size_t i = 0; i < size / sizeof(float); i++)
+        {
+            ptr[i] = RandomFloat(-0.5f, 0.5f);
+        }
+
+        return size;
+    }
+};
+
+static int load_net(ncnn::Net& net, const char* param_txt, const ncnn::Option& opt)
+{
+    net.opt = opt;
+
+    int ret = net.load_param_mem(param_txt);
+    if (ret != 0)
+        return ret;
+
+    DataReaderRandomWeights dr;
+    return net.load_model(dr);
+}
+
+// extract the whole sequence at once
+static int extract_full(const ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& out)
+{
+    ncnn::Extractor ex = net.create_extractor();
+
+    ex.input("in", in);
+    return ex.extract("out", out);
+}
+
+// extract the sequence chunk by chunk and join the frames along h
+static int extract_streaming(const ncnn::Net& net, const ncnn::Mat& in, const std::vector<int>& chunks, ncnn::Mat& out)
+{
+    ncnn::Extractor ex = net.create_extractor();
+    ex.set_streaming(true);
+
+    std::vector<ncnn::Mat> outs;
+    int total_h = 0;
+
+    int x = 0;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        ncnn::Mat chunk(chunks[i], in.h);
+        for (int y = 0; y < in.h; y++)
+        {
+            memcpy(chunk.row(y), in.row(y) + x, chunks[i] * sizeof(float));
+        }
+        x += chunks[i];
+
+        ex.input("in", chunk);
+
+        ncnn::Mat chunk_out;
+        int ret = ex.extract("out", chunk_out);
+        if (ret != 0)
+            return ret;
+
+        outs.push_back(chunk_out);
+        total_h += chunk_out.h;
+    }
+
+    out.create(outs[0].w, total_h);
+
+    int y = 0;
+    for (size_t i = 0; i < outs.size(); i++)
+    {
+        memcpy(out.row(y), outs[i], outs[i].w * outs[i].h * sizeof(float));
+        y += outs[i].h;
+    }
+
+    return 0;
+}
+
+static int test_streaming(const char* param_txt, int frames, const std::vector<int>& chunks, const ncnn::Option& opt)
+{
+    SRAND(7767517);
+
+    ncnn::Net net;
+    int ret = load_net(net, param_txt, opt);
+    if (ret != 0)
+    {
+        fprintf(stderr, "load net failed\n");
+        return -1;
+    }
+
+    ncnn::Mat in = RandomMat(frames, 4);
+
+    ncnn::Mat out_full;
+    ret = extract_full(net, in, out_full);
+    if (ret != 0)
+    {
+        fprintf(stderr, "extract full failed\n");
+        return -1;
+    }
+
+    ncnn::Mat out_streaming;
+    ret = extract_streaming(net, in, chunks, out_streaming);
+    if (ret != 0)
+    {
+        fprintf(stderr, "extract streaming failed\n");
+        return -1;
+    }
+
+    const float epsilon = opt.use_fp16_storage || opt.use_bf16_storage ? 0.1 : 0.001;
+    if (CompareMat(out_full, out_streaming, epsilon) != 0)
+    {
+        fprintf(stderr, "test_streaming failed frames=%d chunks=%d use_packing_layout=%d use_fp16_storage=%d use_bf16_storage=%d\n", frames, (int)chunks.size(), opt.use_packing_layout, opt.use_fp16_storage, opt.use_bf16_storage);
+        return -1;
+    }
+
+    return 0;
+}
+
+static const char param_conv1d_lstm[] = "7767517\n"
+                                        "6 6\n"
+                                        "Input in 0 1 in\n"
+                                        "Convolution1D conv 1 1 in c0 0=8 1=3 4=2 15=0 5=1 6=96 9=1\n"
+                                        "ConvolutionDepthWise1D convdw 1 1 c0 c1 0=8 1=3 2=2 3=2 4=4 15=0 5=1 6=24 7=8\n"
+                                        "Pooling1D pool 1 1 c1 c2 0=0 1=2 3=1 14=0 5=1\n"
+                                        "Permute permute 1 1 c2 c3 0=1\n"
+                                        "LSTM lstm 1 1 c3 out 0=6 1=192\n";
+
+static const char param_conv1d_gru_rnn[] = "7767517\n"
+                                           "6 6\n"
+                                           "Input in 0 1 in\n"
+                                           "Convolution1D conv 1 1 in c0 0=16 1=4 3=2 4=2 15=0 5=1 6=256\n"
+                                           "Pooling1D pool 1 1 c0 c1 0=1 1=3 3=2 14=0 5=0 6=0\n"
+                                           "Permute permute 1 1 c1 c2 0=1\n"
+                                           "GRU gru 1 1 c2 c3 0=8 1=384\n"
+                                           "RNN rnn 1 1 c3 out 0=5 1=40\n";
+
+static int test_streaming_0()
+{
+    ncnn::Option opts[3];
+    opts[0].use_packing_layout = false;
+    opts[0].use_fp16_storage = false;
+    opts[0].use_bf16_storage = false;
+    opts[1].use_packing_layout = true;
+    opts[1].use_fp16_storage = false;
+    opts[1].use_bf16_storage = false;
+    opts[2].use_packing_layout = true;
+    opts[2].use_fp16_storage = true;
+    opts[2].use_bf16_storage = true;
+
+    std::vector<int> even_chunks(4, 8);
+
+    std::vector<int> uneven_chunks;
+    uneven_chunks.push_back(5);
+    uneven_chunks.push_back(11);
+    uneven_chunks.push_back(3);
+    uneven_chunks.push_back(13);
+
+    for (int i = 0; i < 3; i++)
+    {
+        opts[i].num_threads = 1;
+
+        int ret = 0
+                  || test_streaming(param_conv1d_lstm, 32, even_chunks, opts[i])
+                  || test_streaming(param_conv1d_lstm, 32, uneven_chunks, opts[i])
+                  || test_streaming(param_conv1d_gru_rnn, 32, even_chunks, opts[i])
+                  || test_streaming(param_conv1d_gru_rnn, 32, uneven_chunks, opts[i]);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int test_streaming_1()
+{
+    // symmetric padding looks ahead and can not be streamed
+    static const char param_txt[] = "7767517\n"
+                                    "2 2\n"
+                                    "Input in 0 1 in\n"
+                                    "Convolution1D conv 1 1 in out 0=8 1=3 4=1 5=1 6=96\n";
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+
+    ncnn::Net net;
+    int ret = load_net(net, param_txt, opt);
+    if (ret != 0)
+    {
+        fprintf(stderr, "load net failed\n");
+        return -1;
+    }
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.set_streaming(true);
+
+    ex.input("in", RandomMat(8, 4));
+
+    ncnn::Mat out;
+    ret = ex.extract("out", out);
+    if (ret == 0)
+    {
+        fprintf(stderr, "test_streaming_1 failed, non-causal layer streamed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static const char param_kv_cache[] = "7767517\n"
+                                     "2 2\n"
+                                     "Input in 0 1 in\n"
+                                     "MultiHeadAttention mha 1 1 in out 0=16 1=2 2=256 7=1\n";
+
+static const char param_kv_cache_blobs[] = "7767517\n"
+                                           "4 6\n"
+                                           "Input in 0 1 in\n"
+                                           "Input k_cache 0 1 k_cache\n"
+                                           "Input v_cache 0 1 v_cache\n"
+                                           "MultiHeadAttention mha 3 3 in k_cache v_cache out k_cache_out v_cache_out 0=16 1=2 2=256 7=1\n";
+
+static const char param_causal_mask[] = "7767517\n"
+                                        "3 3\n"
+                                        "Input in 0 1 in\n"
+                                        "Input mask 0 1 mask\n"
+                                        "MultiHeadAttention mha 2 1 in mask out 0=16 1=2 2=256 5=1\n";
+
+static int load_net_seeded(ncnn::Net& net, const char* param_txt)
+{
+    ncnn::Option opt;
+    opt.num_threads = 1;
+
+    // the same seed gives every net the same weights
+    SRAND(7767517);
+    return load_net(net, param_txt, opt);
+}
+
+// the whole sequence with causal mask
+static int extract_causal(const ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& out)
+{
+    const int seqlen = in.h;
+
+    ncnn::Mat mask(seqlen, seqlen);
+    for (int i = 0; i < seqlen; i++)
+    {
+        float* ptr = mask.row(i);
+        for (int j = 0; j < seqlen; j++)
+        {
+            ptr[j] = j <= i ? 0.f : -10000.f;
+        }
+    }
+
+    ncnn::Extractor ex = net.create_extractor();
+
+    ex.input("in", in);
+    ex.input("mask", mask);
+    return ex.extract("out", out);
+}
+
+// one decoding step with the cache passed through blobs, the caches are replaced by the updated ones
+static int extract_kv_step(const ncnn::Net& net, const ncnn::Mat& token, ncnn::Mat& k_cache, ncnn::Mat& v_cache, ncnn::Mat& out)
+{
+    ncnn::Extractor ex = net.create_extractor();
+
+    ex.input("in", token);
+    ex.input("k_cache", k_cache);
+    ex.input("v_cache", v_cache);
+
+    int ret = ex.extract("out", out);
+    if (ret != 0)
+        return ret;
+
+    ret = ex.extract("k_cache_out", k_cache);
+    if (ret != 0)
+        return ret;
+
+    return ex.extract("v_cache_out", v_cache);
+}
+
+static int test_streaming_2()
+{
+    // token by token with kv cache is the same as the whole sequence with causal mask
+    const int seqlen = 12;
+
+    ncnn::Net net_kv_cache;
+    int ret = load_net_seeded(net_kv_cache, param_kv_cache);
+    if (ret != 0)
+    {
+        fprintf(stderr, "load net failed\n");
+        return -1;
+    }
+
+    ncnn::Net net_causal_mask;
+    ret = load_net_seeded(net_causal_mask, param_causal_mask);
+    if (ret != 0)
+    {
+        fprintf(stderr, "load net failed\n");
+        return -1;
+    }
+
+    ncnn::Mat in = RandomMat(16, seqlen);
+
+    ncnn::Mat out_full;
+    ret = extract_causal(net_causal_mask, in, out_full);
+    if (ret != 0)
+    {
+        fprintf(stderr, "extract full failed\n");
+        return -1;
+    }
+
+    ncnn::Mat out_streaming(16, seqlen);
+    {
+        ncnn::Extractor ex = net_kv_cache.create_extractor();
+        ex.set_streaming(true);
+
+        for (int i = 0; i < seqlen; i++)
+        {
+            ncnn::Mat token = in.row_range(i, 1).clone();
+
+            ex.input("in", token);
+
+            ncnn::Mat out;
+            ret = ex.extract("out", out);
+            if (ret != 0 || out.h != 1)
+            {
+                fprintf(stderr, "extract streaming failed\n");
+                return -1;
+            }
+
+            memcpy(out_streaming.row(i), out, 16 * sizeof(float));
+        }
+    }
+
+    if (CompareMat(out_full, out_streaming, 0.001) != 0)
+    {
+        fprintf(stderr, "test_streaming_2 failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_streaming_3()
+{
+    // two branches decoding from one shared kv cache do not see each other
+    const int prefix = 5;
+    const int steps = 3;
+
+    ncnn::Net net_kv_cache;
+    int ret = load_net_seeded(net_kv_cache, param_kv_cache_blobs);
+    if (ret != 0)
+    {
+        fprintf(stderr, "load net failed\n");
+        return -1;
+    }
+
+    ncnn::Net net_causal_mask;
+    ret = load_net_seeded(net_causal_mask, param_causal_mask);
+    if (ret != 0)
+    {
+        fprintf(stderr, "load net failed\n");
+        return -1;
+    }
+
+    // the prefix followed by the tokens of branch a, then the same prefix followed by the tokens of branch b
+    ncnn::Mat in_a = RandomMat(16, prefix + steps);
+    ncnn::Mat in_b = in_a.clone();
+    {
+        ncnn::Mat tokens_b = RandomMat(16, steps);
+        memcpy(in_b.row(prefix), tokens_b, 16 * steps * sizeof(float));
+    }
+
+    ncnn::Mat out_a;
+    ncnn::Mat out_b;
+    ret = extract_causal(net_causal_mask, in_a, out_a) || extract_causal(net_causal_mask, in_b, out_b);
+    if (ret != 0)
+    {
+        fprintf(stderr, "extract full failed\n");
+        return -1;
+    }
+
+    // the empty cache of the first step
+    ncnn::Mat k_cache(16, 0, 1);
+    ncnn::Mat v_cache(16, 0, 1);
+
+    for (int i = 0; i < prefix; i++)
+    {
+        const void* k_cache_data = k_cache.data;
+        const bool k_cache_spare = k_cache.data && (int)(k_cache.cstep / 16) > k_cache.h;
+
+        // the caches are handed over, so the new token is appended in place when there are spare rows
+        ncnn::Mat k_cache_in = k_cache;
+        ncnn::Mat v_cache_in = v_cache;
+        k_cache.release();
+        v_cache.release();
+
+        ncnn::Extractor ex = net_kv_cache.create_extractor();
+
+        ex.input("in", in_a.row_range(i, 1).clone());
+        ex.input("k_cache", k_cache_in);
+        ex.input("v_cache", v_cache_in);
+        k_cache_in.release();
+        v_cache_in.release();
+
+        ncnn::Mat out;
+        ret = ex.extract("out", out) || ex.extract("k_cache_out", k_cache) || ex.extract("v_cache_out", v_cache);
+        if (ret != 0)
+        {
+            fprintf(stderr, "extract prefix failed\n");
+            return -1;
+        }
+
+        if (k_cache_spare && k_cache.data != k_cache_data)
+        {
+            fprintf(stderr, "test_streaming_3 exclusive kv cache not appended in place\n");
+            return -1;
+        }
+    }
+
+    const ncnn::Mat k_cache_prefix = k_cache.clone();
+
+    // both branches start from the same cache and take turns
+    ncnn::Mat k_cache_a = k_cache;
+    ncnn::Mat v_cache_a = v_cache;
+    ncnn::Mat k_cache_b = k_cache;
+    ncnn::Mat v_cache_b = v_cache;
+    for (int i = prefix; i < prefix + steps; i++)
+    {
+        ncnn::Mat step_out_a;
+        ncnn::Mat step_out_b;
+        ret = extract_kv_step(net_kv_cache, in_a.row_range(i, 1).clone(), k_cache_a, v_cache_a, step_out_a)
+              || extract_kv_step(net_kv_cache, in_b.row_range(i, 1).clone(), k_cache_b, v_cache_b, step_out_b);
+        if (ret != 0)
+        {
+            fprintf(stderr, "extract branch failed\n");
+            return -1;
+        }
+
+        if (CompareMat(out_a.row_range(i, 1), step_out_a.reshape(16, 1), 0.001) != 0 || CompareMat(out_b.row_range(i, 1), step_out_b.reshape(16, 1), 0.001) != 0)
+        {
+            fprintf(stderr, "test_streaming_3 branch output mismatch at %d\n", i);
+            return -1;
+        }
+    }
+
+    if (CompareMat(k_cache_prefix, k_cache, 0) != 0 || k_cache.h != prefix)
+    {
+        fprintf(stderr, "test_streaming_3 shared kv cache modified\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_streaming_4()
+{
+    // a copied streaming extractor decodes on its own
+    const int prefix = 4;
+    const int steps = 3;
+
+    ncnn::Net net_kv_cache;
+    int ret = load_net_seeded(net_kv_cache, param_kv_cache);
+    if (ret != 0)
+    {
+        fprintf(stderr, "load net failed\n");
+        return -1;
+    }
+
+    ncnn::Net net_causal_mask;
+    ret = load_net_seeded(net_causal_mask, param_causal_mask);
+    if (ret != 0)
+    {
+        fprintf(stderr, "load net failed\n");
+        return -1;
+    }
+
+    ncnn::Mat in_a = RandomMat(16, prefix + steps);
+    ncnn::Mat in_b = in_a.clone();
+    {
+        ncnn::Mat tokens_b = RandomMat(16, steps);
+        memcpy(in_b.row(prefix), tokens_b, 16 * steps * sizeof(float));
+    }
+
+    ncnn::Mat out_a;
+    ncnn::Mat out_b;
+    ret = extract_causal(net_causal_mask, in_a, out_a) || extract_causal(net_causal_mask, in_b, out_b);
+    if (ret != 0)
+    {
+        fprintf(stderr, "extract full failed\n");
+        return -1;
+    }
+
+    ncnn::Extractor ex_a = net_kv_cache.create_extractor();
+    ex_a.set_streaming(true);
+
+    for (int i = 0; i < prefix; i++)
+    {
+        ex_a.input("in", in_a.row_range(i, 1).clone());
+
+        ncnn::Mat out;
+        ret = ex_a.extract("out", out);
+        if (ret != 0)
+        {
+            fprintf(stderr, "extract prefix failed\n");
+            return -1;
+        }
+    }
+
+    ncnn::Extractor ex_b = ex_a;
+
+    for (int i = prefix; i < prefix + steps; i++)
+    {
+        ex_a.input("in", in_a.row_range(i, 1).clone());
+        ex_b.input("in", in_b.row_range(i, 1).clone());
+
+        ncnn::Mat step_out_a;
+        ncnn::Mat step_out_b;
+        ret = ex_a.extract("out", step_out_a) || ex_b.extract("out", step_out_b);
+        if (ret != 0)
+        {
+            fprintf(stderr, "extract branch failed\n");
+            return -1;
+        }
+
+        if (CompareMat(out_a.row_range(i, 1), step_out_a, 0.001) != 0 || CompareMat(out_b.row_range(i, 1), step_out_b, 0.001) != 0)
+        {
+            fprintf(stderr, "test_streaming_4 branch output mismatch at %d\n", i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    return 0
+           || test_streaming_0()
+           || test_streaming_1()
+           || test_streaming_2()
+           || test_streaming_3()
+           || test_streaming_4();
+}
@@ -3,6 +3,8 @@
 
 #include "testutil.h"
 
+#include "allocator.h"
+#include "benchmark.h"
 #include "cpu.h"
 #include "layer.h"
 #include "mat.h"
@@ -399,6 +401,18 @@ static int convert_to_optimal_layout(const ncnn::Mat& a, ncnn::Mat& a4, const nc
                 dst_elempack = 8;
             else if (elemcount % 4 == 0)
                 dst_elempack = 4;
+#elif NCNN_AVX512
+            if (elemcount % 16 == 0 && ncnn::cpu_support_x86_avx512())
+                dst_elempack = 16;
+            else if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
+                dst_elempack = 8;
+            else if (elemcount % 4 == 0)
+                dst_elempack = 4;
+#elif NCNN_AVX
+            if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
+                dst_elempack = 8;
+            else if (elemcount % 4 == 0)
+                dst_elempack = 4;
 #elif NCNN_RVV || NCNN_XTHEADVECTOR
             const int packn = ncnn::cpu_riscv_vlenb() / 2;
             if (elemcount % packn == 0)
@@ -638,6 +652,113 @@ int test_layer_cpu(int typeindex, const ncnn::ParamDict& pd, const std::vector<n
     return 0;
 }
 
+int bench_layer_cpu(const char* layer_type, const ncnn::ParamDict& pd, const std::vector<ncnn::Mat>& weights, const ncnn::Option& _opt, const std::vector<ncnn::Mat>& a, int top_blob_count, int loop_count, double& time_min, double& time_avg, int flag)
+{
+    ncnn::Layer* op = ncnn::create_layer_cpu(layer_type);
+    if (!op)
+        return -1;
+
+    if (!op->support_packing && _opt.use_packing_layout)
+    {
+        delete op;
+        return 233;
+    }
+    if (!op->support_bf16_storage && !op->support_fp16_storage && (_opt.use_bf16_storage || _opt.use_fp16_arithmetic))
+    {
+        delete op;
+        return 233;
+    }
+
+    op->load_param(pd);
+
+    if (op->one_blob_only && a.size() != 1)
+    {
+        fprintf(stderr, "layer with one_blob_only but consume multiple inputs\n");
+        delete op;
+        return -1;
+    }
+
+    ncnn::ModelBinFromMatArray mb(weights.data());
+
+    op->load_model(mb);
+
+    ncnn::UnlockedPoolAllocator blob_allocator;
+    ncnn::UnlockedPoolAllocator workspace_allocator;
+
+    ncnn::Option opt = _opt;
+    opt.use_vulkan_compute = false;
+    opt.blob_allocator = &blob_allocator;
+    opt.workspace_allocator = &workspace_allocator;
+
+    op->create_pipeline(opt);
+
+    if ((!op->support_packing && _opt.use_packing_layout) || (!op->support_bf16_storage && !op->support_fp16_storage && (_opt.use_bf16_storage || _opt.use_fp16_arithmetic)))
+    {
+        op->destroy_pipeline(opt);
+        delete op;
+        return 233;
+    }
+
+    std::vector<ncnn::Mat> a4(a.size());
+    for (size_t i = 0; i < a4.size(); i++)
+    {
+        convert_to_optimal_layout(a[i], a4[i], opt, op, flag);
+    }
+
+    time_min = 1e30;
+    time_avg = 0;
+
+    // the first forward warms up the pools and caches
+    for (int i = -1; i < loop_count; i++)
+    {
+        std::vector<ncnn::Mat> c(top_blob_count);
+
+        // inplace layers get a fresh copy which is not timed
+        if (op->support_inplace)
+        {
+            for (size_t j = 0; j < a4.size(); j++)
+            {
+                c[j] = a4[j].clone(&blob_allocator);
+            }
+        }
+
+        double start = ncnn::get_current_time();
+
+        int ret = 0;
+        if (op->one_blob_only && op->support_inplace)
+            ret = op->forward_inplace(c[0], opt);
+        else if (op->one_blob_only)
+            ret = op->forward(a4[0], c[0], opt);
+        else if (op->support_inplace)
+            ret = op->forward_inplace(c, opt);
+        else
+            ret = op->forward(a4, c, opt);
+
+        double end = ncnn::get_current_time();
+
+        if (ret != 0)
+        {
+            op->destroy_pipeline(opt);
+            delete op;
+            return ret;
+        }
+
+        if (i < 0)
+            continue;
+
+        time_min = std::min(time_min, end - start);
+        time_avg += end - start;
+    }
+
+    time_avg /= loop_count;
+
+    op->destroy_pipeline(opt);
+
+    delete op;
+
+    return 0;
+}
+
 #if NCNN_VULKAN
 int test_layer_gpu(int typeindex, const ncnn::ParamDict& pd, const std::vector<ncnn::Mat>& weights, const ncnn::Option& _opt, const std::vector<ncnn::Mat>& a, int top_blob_count, std::vector<ncnn::Mat>& d, const std::vector<ncnn::Mat>& top_shapes, void (*func)(ncnn::Layer*), int flag)
 {
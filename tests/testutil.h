@@ -105,4 +105,11 @@ int test_layer_oom(const char* layer_type, const ncnn::ParamDict& pd, const std:
 
 int test_layer_oom(const char* layer_type, const ncnn::ParamDict& pd, const std::vector<ncnn::Mat>& weights, const ncnn::Mat& a, int flag = 0);
 
+// benchmark
+
+// forward the cpu layer with the input layout test_layer_cpu uses, keeping opt.num_threads
+// one untimed forward warms up, then loop_count forwards are timed in ms
+// return 233 if the layer does not support the storage requested by opt
+int bench_layer_cpu(const char* layer_type, const ncnn::ParamDict& pd, const std::vector<ncnn::Mat>& weights, const ncnn::Option& opt, const std::vector<ncnn::Mat>& a, int top_blob_count, int loop_count, double& time_min, double& time_avg, int flag = 0);
+
 #endif // TESTUTIL_H
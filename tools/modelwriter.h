@@ -235,6 +235,7 @@ public:
     int fprintf_param_float_array(int id, const ncnn::Mat& m, FILE* pp);
 
     int fwrite_weight_tag_data(const ncnn::Mat& data, FILE* bp, float a = -1.2f, float b = 1.2f);
+    int fwrite_weight_int4_tag_data(const ncnn::Mat& data, FILE* bp);
     int fwrite_weight_data(const ncnn::Mat& data, FILE* bp, float a = -1.2f, float b = 1.2f);
 
     int save(const char* parampath, const char* binpath);
@@ -655,6 +656,28 @@ int ModelWriter::fwrite_weight_tag_data(const ncnn::Mat& data, FILE* bp, float a
     return 0;
 }
 
+int ModelWriter::fwrite_weight_int4_tag_data(const ncnn::Mat& data, FILE* bp)
+{
+    int p0 = ftell(bp);
+
+    // two int4 values per byte
+    ncnn::Mat data_flattened = data.reshape(data.w * data.h * data.d * data.c);
+    if (gen_random_weight)
+        Randomize(data_flattened);
+
+    const int tag = 0x000D4B34; // int4 magic
+    fwrite(&tag, sizeof(int), 1, bp);
+    fwrite(data_flattened.data, data_flattened.elemsize, data_flattened.w, bp);
+
+    // padding to 32bit align
+    int nwrite = ftell(bp) - p0;
+    size_t nalign = alignSize(nwrite, 4);
+    unsigned char padding[4] = {0x00, 0x00, 0x00, 0x00};
+    fwrite(padding, sizeof(unsigned char), nalign - nwrite, bp);
+
+    return 0;
+}
+
 int ModelWriter::fwrite_weight_data(const ncnn::Mat& data, FILE* bp, float a, float b)
 {
     int p0 = ftell(bp);
@@ -929,6 +952,7 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             fprintf_param_value(" 18=%e", pad_value)
             fprintf_param_value(" 5=%d", bias_term)
             fprintf_param_value(" 6=%d", weight_data_size)
+            fprintf_param_value(" 8=%d", int8_scale_term)
             fprintf_param_value(" 9=%d", activation_type)
             {
                 if (!op->activation_params.empty()) fprintf_param_float_array(10, op->activation_params, pp);
@@ -939,6 +963,15 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             {
                 fwrite_weight_tag_data(op->weight_data, bp);
                 fwrite_weight_data(op->bias_data, bp);
+
+#if NCNN_INT8
+                // write int8_scale data
+                if (op->int8_scale_term)
+                {
+                    fwrite_weight_data(op->weight_data_int8_scales, bp, 90, 100);
+                    fwrite_weight_data(op->bottom_blob_int8_scales, bp, 0.001, 1);
+                }
+#endif // NCNN_INT8
             }
 
             if (shape_ready)
@@ -1103,6 +1136,7 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             fprintf_param_value(" 5=%d", bias_term)
             fprintf_param_value(" 6=%d", weight_data_size)
             fprintf_param_value(" 7=%d", group)
+            fprintf_param_value(" 8=%d", int8_scale_term)
             fprintf_param_value(" 9=%d", activation_type)
             {
                 if (!op->activation_params.empty()) fprintf_param_float_array(10, op->activation_params, pp);
@@ -1113,6 +1147,17 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             {
                 fwrite_weight_tag_data(op->weight_data, bp);
                 fwrite_weight_data(op->bias_data, bp);
+
+#if NCNN_INT8
+                // write int8_scale data
+                if (op->int8_scale_term)
+                {
+                    op->bottom_blob_int8_scales.w = 1;
+
+                    fwrite_weight_data(op->weight_data_int8_scales, bp, 90, 100);
+                    fwrite_weight_data(op->bottom_blob_int8_scales, bp, 0.001, 1);
+                }
+#endif // NCNN_INT8
             }
 
             if (shape_ready)
@@ -1279,6 +1324,7 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             }
             fprintf_param_value(" 5=%d", bias_term)
             fprintf_param_value(" 6=%d", weight_data_size)
+            fprintf_param_value(" 8=%d", int8_scale_term)
             fprintf_param_value(" 9=%d", activation_type)
             {
                 if (!op->activation_params.empty()) fprintf_param_float_array(10, op->activation_params, pp);
@@ -1289,6 +1335,15 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             {
                 fwrite_weight_tag_data(op->weight_data, bp);
                 fwrite_weight_data(op->bias_data, bp);
+
+#if NCNN_INT8
+                // write int8_scale data
+                if (op->int8_scale_term)
+                {
+                    fwrite_weight_data(op->weight_data_int8_scales, bp, 90, 100);
+                    fwrite_weight_data(op->bottom_blob_int8_scales, bp, 0.001, 1);
+                }
+#endif // NCNN_INT8
             }
 
             if (shape_ready)
@@ -1444,6 +1499,7 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             fprintf_param_value(" 5=%d", bias_term)
             fprintf_param_value(" 6=%d", weight_data_size)
             fprintf_param_value(" 7=%d", group)
+            fprintf_param_value(" 8=%d", int8_scale_term)
             fprintf_param_value(" 9=%d", activation_type)
             {
                 if (!op->activation_params.empty()) fprintf_param_float_array(10, op->activation_params, pp);
@@ -1454,6 +1510,17 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             {
                 fwrite_weight_tag_data(op->weight_data, bp);
                 fwrite_weight_data(op->bias_data, bp);
+
+#if NCNN_INT8
+                // write int8_scale data
+                if (op->int8_scale_term)
+                {
+                    op->bottom_blob_int8_scales.w = 1;
+
+                    fwrite_weight_data(op->weight_data_int8_scales, bp, 90, 100);
+                    fwrite_weight_data(op->bottom_blob_int8_scales, bp, 0.001, 1);
+                }
+#endif // NCNN_INT8
             }
 
             if (shape_ready)
@@ -1772,23 +1839,44 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             fprintf_param_value(" 13=%d", output_elemtype)
             fprintf_param_value(" 14=%d", output_transpose)
             fprintf_param_value(" 18=%d", int8_scale_term)
+            fprintf_param_value(" 19=%d", weight_quant_bits)
             fprintf_param_value(" 20=%d", constant_TILE_M)
             fprintf_param_value(" 21=%d", constant_TILE_N)
             fprintf_param_value(" 22=%d", constant_TILE_K)
+            fprintf_param_value(" 23=%d", weight_quant_group_size)
 
             if (op->constantA == 1)
             {
-                fwrite_weight_tag_data(op->A_data, bp);
+                if (op->weight_quant_bits == 4)
+                    fwrite_weight_int4_tag_data(op->A_data, bp);
+                else
+                    fwrite_weight_tag_data(op->A_data, bp);
             }
             if (op->constantB == 1)
             {
-                fwrite_weight_tag_data(op->B_data, bp);
+                if (op->weight_quant_bits == 4)
+                    fwrite_weight_int4_tag_data(op->B_data, bp);
+                else
+                    fwrite_weight_tag_data(op->B_data, bp);
             }
             if (op->constantC == 1 && op->constant_broadcast_type_C != -1)
             {
                 fwrite_weight_tag_data(op->C_data, bp);
             }
 
+            // write weight-only quantized scales
+            if (op->weight_quant_bits)
+            {
+                if (op->constantA == 1)
+                {
+                    fwrite_weight_data(op->A_data_quant_scales, bp, 90, 100);
+                }
+                if (op->constantB == 1)
+                {
+                    fwrite_weight_data(op->B_data_quant_scales, bp, 90, 100);
+                }
+            }
+
 #if NCNN_INT8
             // write int8_scale data
             if (op->int8_scale_term)
@@ -1803,6 +1891,10 @@ int ModelWriter::save(const char* parampath, const char* binpath)
                     B_data_int8_scales[0] = op->B_data_int8_scale;
                     fwrite_weight_data(B_data_int8_scales, bp, 90, 100);
                 }
+                if (op->int8_scale_term == 3 && (op->constantA == 0 || op->constantB == 0))
+                {
+                    fwrite_weight_data(op->bottom_blob_int8_scales, bp, 0.001, 1);
+                }
             }
 #endif // NCNN_INT8
         }
@@ -1856,6 +1948,10 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             {
                 fwrite_weight_data(op->weight_xc_data_int8_scales, bp, 90, 100);
                 fwrite_weight_data(op->weight_hc_data_int8_scales, bp, 90, 100);
+                if (op->int8_scale_term == 3)
+                {
+                    fwrite_weight_data(op->bottom_blob_int8_scales, bp, 0.001, 1);
+                }
             }
 #endif // NCNN_INT8
         }
@@ -1888,10 +1984,21 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             {
                 if (!op->activation_params.empty()) fprintf_param_float_array(10, op->activation_params, pp);
             }
+            fprintf_param_value(" 11=%d", weight_quant_bits)
+            fprintf_param_value(" 12=%d", weight_quant_group_size)
 
-            fwrite_weight_tag_data(op->weight_data, bp);
+            if (op->weight_quant_bits == 4)
+                fwrite_weight_int4_tag_data(op->weight_data, bp);
+            else
+                fwrite_weight_tag_data(op->weight_data, bp);
             fwrite_weight_data(op->bias_data, bp);
 
+            // write weight-only quantized scales
+            if (op->weight_quant_bits)
+            {
+                fwrite_weight_data(op->weight_data_quant_scales, bp, 90, 100);
+            }
+
 #if NCNN_INT8
             // write int8_scale data
             if (op->int8_scale_term)
@@ -2006,6 +2113,10 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             {
                 fwrite_weight_data(op->weight_xc_data_int8_scales, bp, 90, 100);
                 fwrite_weight_data(op->weight_hc_data_int8_scales, bp, 90, 100);
+                if (op->int8_scale_term == 3)
+                {
+                    fwrite_weight_data(op->bottom_blob_int8_scales, bp, 0.001, 1);
+                }
             }
 #endif // NCNN_INT8
         }
@@ -2015,6 +2126,7 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             ncnn::MatMul* op_default = (ncnn::MatMul*)layer_default;
 
             fprintf_param_value(" 0=%d", transB)
+            fprintf_param_value(" 18=%d", int8_scale_term)
         }
         else if (layer->type == "MemoryData")
         {
@@ -2060,6 +2172,10 @@ int ModelWriter::save(const char* parampath, const char* binpath)
                 ncnn::Mat out_weight_data_int8_scales(1);
                 out_weight_data_int8_scales[0] = op->out_weight_data_int8_scale;
                 fwrite_weight_data(out_weight_data_int8_scales, bp, 90, 100);
+                if (op->int8_scale_term == 3)
+                {
+                    fwrite_weight_data(op->bottom_blob_int8_scales, bp, 0.001, 1);
+                }
             }
 #endif // NCNN_INT8
         }
@@ -2380,6 +2496,10 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             {
                 fwrite_weight_data(op->weight_xc_data_int8_scales, bp, 90, 100);
                 fwrite_weight_data(op->weight_hc_data_int8_scales, bp, 90, 100);
+                if (op->int8_scale_term == 3)
+                {
+                    fwrite_weight_data(op->bottom_blob_int8_scales, bp, 0.001, 1);
+                }
             }
 #endif // NCNN_INT8
         }
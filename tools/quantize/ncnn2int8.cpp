@@ -6,6 +6,7 @@
 #endif
 
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <map>
 #include <set>
@@ -19,6 +20,7 @@
 
 // ncnn private header
 #include "../modelwriter.h"
+#include "layer/weight_quant.h"
 
 class DataReaderFromEmpty : public ncnn::DataReader
 {
@@ -113,9 +115,17 @@ public:
     std::map<std::string, ncnn::Mat> blob_int8scale_table;
     std::map<std::string, ncnn::Mat> weight_int8scale_table;
 
+    // weight-only quantization for InnerProduct and Gemm, 0=off 8=int8 4=int4
+    int weight_only_bits;
+    int weight_only_group_size;
+
 public:
     int quantize_convolution();
     int quantize_convolutiondepthwise();
+    int quantize_deconvolution();
+    int quantize_deconvolutiondepthwise();
+    int quantize_convolution1d();
+    int quantize_convolutiondepthwise1d();
     int quantize_innerproduct();
 
     int quantize_rnn();
@@ -125,6 +135,9 @@ public:
     int quantize_embed();
     int quantize_gemm();
     int quantize_multiheadattention();
+    int quantize_matmul();
+
+    int quantize_weight_only();
 
     int fuse_requantize();
 };
@@ -132,6 +145,8 @@ public:
 NetQuantize::NetQuantize()
     : ModelWriter()
 {
+    weight_only_bits = 0;
+    weight_only_group_size = 0;
 }
 
 int NetQuantize::quantize_convolution()
@@ -254,6 +269,253 @@ int NetQuantize::quantize_convolutiondepthwise()
     return 0;
 }
 
+int NetQuantize::quantize_deconvolution()
+{
+    const int layer_count = static_cast<int>(layers.size());
+    for (int i = 0; i < layer_count; i++)
+    {
+        // find deconvolution layer
+        if (layers[i]->type != "Deconvolution")
+            continue;
+
+        std::map<std::string, ncnn::Mat>::iterator iter_data = blob_int8scale_table.find(layers[i]->name);
+        if (iter_data == blob_int8scale_table.end())
+            continue;
+
+        char key[256];
+        sprintf(key, "%s_param_0", layers[i]->name.c_str());
+
+        std::map<std::string, ncnn::Mat>::iterator iter = weight_int8scale_table.find(key);
+        if (iter == weight_int8scale_table.end())
+        {
+            fprintf(stderr, "this layer need to be quantized, but no scale param!\n");
+            return -1;
+        }
+
+        // Deconvolution - quantize weight from fp32 to int8
+        ncnn::Deconvolution* deconvolution = (ncnn::Deconvolution*)layers[i];
+
+        if (deconvolution->dynamic_weight)
+            continue;
+
+        ncnn::Mat bottom_blob_int8_scales = iter_data->second;
+        ncnn::Mat weight_data_int8_scales = iter->second;
+
+        fprintf(stderr, "quantize_deconvolution %s\n", deconvolution->name.c_str());
+
+        {
+            const int maxk = deconvolution->kernel_w * deconvolution->kernel_h;
+            const int num_input = deconvolution->weight_data_size / deconvolution->num_output / maxk;
+
+            ncnn::Mat weight_data_r2 = deconvolution->weight_data.reshape(maxk, num_input, deconvolution->num_output);
+
+            ncnn::Mat weight_data_int8;
+
+            ncnn::Option opt_q = opt;
+            opt_q.blob_allocator = deconvolution->weight_data.allocator;
+            opt_q.use_packing_layout = false;
+            ncnn::quantize_to_int8(weight_data_r2, weight_data_int8, weight_data_int8_scales, opt_q);
+            if (weight_data_int8.empty())
+                return -100;
+
+            deconvolution->weight_data = weight_data_int8.reshape(deconvolution->weight_data_size);
+        }
+
+        deconvolution->int8_scale_term = 1;
+        deconvolution->weight_data_int8_scales = weight_data_int8_scales;
+        deconvolution->bottom_blob_int8_scales = bottom_blob_int8_scales;
+    }
+
+    return 0;
+}
+
+int NetQuantize::quantize_deconvolutiondepthwise()
+{
+    const int layer_count = static_cast<int>(layers.size());
+    for (int i = 0; i < layer_count; i++)
+    {
+        // find deconvolutiondepthwise layer
+        if (layers[i]->type != "DeconvolutionDepthWise")
+            continue;
+
+        std::map<std::string, ncnn::Mat>::iterator iter_data = blob_int8scale_table.find(layers[i]->name);
+        if (iter_data == blob_int8scale_table.end())
+            continue;
+
+        char key[256];
+        sprintf(key, "%s_param_0", layers[i]->name.c_str());
+
+        std::map<std::string, ncnn::Mat>::iterator iter = weight_int8scale_table.find(key);
+        if (iter == weight_int8scale_table.end())
+        {
+            fprintf(stderr, "this layer need to be quantized, but no scale param!\n");
+            return -1;
+        }
+
+        // DeconvolutionDepthWise - quantize weight from fp32 to int8
+        ncnn::DeconvolutionDepthWise* deconvdw = (ncnn::DeconvolutionDepthWise*)layers[i];
+
+        if (deconvdw->dynamic_weight)
+            continue;
+
+        ncnn::Mat bottom_blob_int8_scales = iter_data->second;
+        ncnn::Mat weight_data_int8_scales = iter->second;
+
+        fprintf(stderr, "quantize_deconvolutiondepthwise %s\n", deconvdw->name.c_str());
+
+        {
+            ncnn::Mat int8_weight_data(deconvdw->weight_data_size, (size_t)1u);
+            if (int8_weight_data.empty())
+                return -100;
+
+            const int weight_data_size_g = deconvdw->weight_data_size / deconvdw->group;
+
+            for (int g = 0; g < deconvdw->group; g++)
+            {
+                ncnn::Option opt_q = opt;
+                opt_q.blob_allocator = int8_weight_data.allocator;
+                opt_q.use_packing_layout = false;
+
+                const ncnn::Mat weight_data_g = deconvdw->weight_data.range(weight_data_size_g * g, weight_data_size_g);
+                ncnn::Mat int8_weight_data_g = int8_weight_data.range(weight_data_size_g * g, weight_data_size_g);
+                const ncnn::Mat weight_data_int8_scales_g = weight_data_int8_scales.range(g, 1);
+                ncnn::quantize_to_int8(weight_data_g, int8_weight_data_g, weight_data_int8_scales_g, opt_q);
+            }
+
+            deconvdw->weight_data = int8_weight_data;
+        }
+
+        deconvdw->int8_scale_term = 1;
+        deconvdw->weight_data_int8_scales = weight_data_int8_scales;
+        deconvdw->bottom_blob_int8_scales = bottom_blob_int8_scales;
+    }
+
+    return 0;
+}
+
+int NetQuantize::quantize_convolution1d()
+{
+    const int layer_count = static_cast<int>(layers.size());
+    for (int i = 0; i < layer_count; i++)
+    {
+        // find convolution1d layer
+        if (layers[i]->type != "Convolution1D")
+            continue;
+
+        std::map<std::string, ncnn::Mat>::iterator iter_data = blob_int8scale_table.find(layers[i]->name);
+        if (iter_data == blob_int8scale_table.end())
+            continue;
+
+        char key[256];
+        sprintf(key, "%s_param_0", layers[i]->name.c_str());
+
+        std::map<std::string, ncnn::Mat>::iterator iter = weight_int8scale_table.find(key);
+        if (iter == weight_int8scale_table.end())
+        {
+            fprintf(stderr, "this layer need to be quantized, but no scale param!\n");
+            return -1;
+        }
+
+        // Convolution1D - quantize weight from fp32 to int8
+        ncnn::Convolution1D* convolution1d = (ncnn::Convolution1D*)layers[i];
+
+        if (convolution1d->dynamic_weight)
+            continue;
+
+        ncnn::Mat bottom_blob_int8_scales = iter_data->second;
+        ncnn::Mat weight_data_int8_scales = iter->second;
+
+        fprintf(stderr, "quantize_convolution1d %s\n", convolution1d->name.c_str());
+
+        {
+            const int num_input = convolution1d->weight_data_size / convolution1d->num_output / convolution1d->kernel_w;
+
+            ncnn::Mat weight_data_r2 = convolution1d->weight_data.reshape(convolution1d->kernel_w, num_input, convolution1d->num_output);
+
+            ncnn::Mat weight_data_int8;
+
+            ncnn::Option opt_q = opt;
+            opt_q.blob_allocator = convolution1d->weight_data.allocator;
+            opt_q.use_packing_layout = false;
+            ncnn::quantize_to_int8(weight_data_r2, weight_data_int8, weight_data_int8_scales, opt_q);
+            if (weight_data_int8.empty())
+                return -100;
+
+            convolution1d->weight_data = weight_data_int8.reshape(convolution1d->weight_data_size);
+        }
+
+        convolution1d->int8_scale_term = 1;
+        convolution1d->weight_data_int8_scales = weight_data_int8_scales;
+        convolution1d->bottom_blob_int8_scales = bottom_blob_int8_scales;
+    }
+
+    return 0;
+}
+
+int NetQuantize::quantize_convolutiondepthwise1d()
+{
+    const int layer_count = static_cast<int>(layers.size());
+    for (int i = 0; i < layer_count; i++)
+    {
+        // find convolutiondepthwise1d layer
+        if (layers[i]->type != "ConvolutionDepthWise1D")
+            continue;
+
+        std::map<std::string, ncnn::Mat>::iterator iter_data = blob_int8scale_table.find(layers[i]->name);
+        if (iter_data == blob_int8scale_table.end())
+            continue;
+
+        char key[256];
+        sprintf(key, "%s_param_0", layers[i]->name.c_str());
+
+        std::map<std::string, ncnn::Mat>::iterator iter = weight_int8scale_table.find(key);
+        if (iter == weight_int8scale_table.end())
+        {
+            fprintf(stderr, "this layer need to be quantized, but no scale param!\n");
+            return -1;
+        }
+
+        // ConvolutionDepthWise1D - quantize weight from fp32 to int8
+        ncnn::ConvolutionDepthWise1D* convdw1d = (ncnn::ConvolutionDepthWise1D*)layers[i];
+
+        if (convdw1d->dynamic_weight)
+            continue;
+
+        ncnn::Mat bottom_blob_int8_scales = iter_data->second;
+        ncnn::Mat weight_data_int8_scales = iter->second;
+
+        fprintf(stderr, "quantize_convolutiondepthwise1d %s\n", convdw1d->name.c_str());
+
+        {
+            ncnn::Mat int8_weight_data(convdw1d->weight_data_size, (size_t)1u);
+            if (int8_weight_data.empty())
+                return -100;
+
+            const int weight_data_size_g = convdw1d->weight_data_size / convdw1d->group;
+
+            for (int g = 0; g < convdw1d->group; g++)
+            {
+                ncnn::Option opt_q = opt;
+                opt_q.blob_allocator = int8_weight_data.allocator;
+                opt_q.use_packing_layout = false;
+
+                const ncnn::Mat weight_data_g = convdw1d->weight_data.range(weight_data_size_g * g, weight_data_size_g);
+                ncnn::Mat int8_weight_data_g = int8_weight_data.range(weight_data_size_g * g, weight_data_size_g);
+                const ncnn::Mat weight_data_int8_scales_g = weight_data_int8_scales.range(g, 1);
+                ncnn::quantize_to_int8(weight_data_g, int8_weight_data_g, weight_data_int8_scales_g, opt_q);
+            }
+
+            convdw1d->weight_data = int8_weight_data;
+        }
+
+        convdw1d->int8_scale_term = 1;
+        convdw1d->weight_data_int8_scales = weight_data_int8_scales;
+        convdw1d->bottom_blob_int8_scales = bottom_blob_int8_scales;
+    }
+
+    return 0;
+}
+
 int NetQuantize::quantize_innerproduct()
 {
     const int layer_count = static_cast<int>(layers.size());
@@ -384,6 +646,14 @@ int NetQuantize::quantize_rnn()
         }
 
         rnn->int8_scale_term = 2;
+
+        // static input scales from the calibration table
+        std::map<std::string, ncnn::Mat>::iterator iter_data = blob_int8scale_table.find(rnn->name);
+        if (iter_data != blob_int8scale_table.end() && iter_data->second.w == 1)
+        {
+            rnn->int8_scale_term = 3;
+            rnn->bottom_blob_int8_scales = iter_data->second;
+        }
         rnn->weight_xc_data_int8_scales = weight_xc_data_int8_scales;
         rnn->weight_hc_data_int8_scales = weight_hc_data_int8_scales;
     }
@@ -466,6 +736,14 @@ int NetQuantize::quantize_lstm()
         }
 
         lstm->int8_scale_term = 2;
+
+        // static input scales from the calibration table
+        std::map<std::string, ncnn::Mat>::iterator iter_data = blob_int8scale_table.find(lstm->name);
+        if (iter_data != blob_int8scale_table.end() && iter_data->second.w == 1)
+        {
+            lstm->int8_scale_term = 3;
+            lstm->bottom_blob_int8_scales = iter_data->second;
+        }
         lstm->weight_xc_data_int8_scales = weight_xc_data_int8_scales;
         lstm->weight_hc_data_int8_scales = weight_hc_data_int8_scales;
     }
@@ -548,6 +826,14 @@ int NetQuantize::quantize_gru()
         }
 
         gru->int8_scale_term = 2;
+
+        // static input scales from the calibration table
+        std::map<std::string, ncnn::Mat>::iterator iter_data = blob_int8scale_table.find(gru->name);
+        if (iter_data != blob_int8scale_table.end() && iter_data->second.w == 1)
+        {
+            gru->int8_scale_term = 3;
+            gru->bottom_blob_int8_scales = iter_data->second;
+        }
         gru->weight_xc_data_int8_scales = weight_xc_data_int8_scales;
         gru->weight_hc_data_int8_scales = weight_hc_data_int8_scales;
     }
@@ -706,6 +992,14 @@ int NetQuantize::quantize_gemm()
         }
 
         gemm->int8_scale_term = 2;
+
+        // static input scales from the calibration table
+        std::map<std::string, ncnn::Mat>::iterator iter_data = blob_int8scale_table.find(gemm->name);
+        if (iter_data != blob_int8scale_table.end() && iter_data->second.w == (gemm->constantA ? 0 : 1) + (gemm->constantB ? 0 : 1))
+        {
+            gemm->int8_scale_term = 3;
+            gemm->bottom_blob_int8_scales = iter_data->second;
+        }
     }
 
     return 0;
@@ -837,6 +1131,44 @@ int NetQuantize::quantize_multiheadattention()
         }
 
         mha->int8_scale_term = 2;
+
+        // static input scales from the calibration table
+        std::map<std::string, ncnn::Mat>::iterator iter_data = blob_int8scale_table.find(mha->name);
+        if (iter_data != blob_int8scale_table.end() && iter_data->second.w == 3)
+        {
+            mha->int8_scale_term = 3;
+            mha->bottom_blob_int8_scales = iter_data->second;
+        }
+    }
+
+    return 0;
+}
+
+int NetQuantize::quantize_matmul()
+{
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (layers[i]->type != "MatMul")
+            continue;
+
+        // MatMul - int8 compute for the product with a constant operand
+        ncnn::MatMul* matmul = (ncnn::MatMul*)layers[i];
+
+        bool has_constant_operand = false;
+        for (size_t j = 0; j < matmul->bottoms.size(); j++)
+        {
+            int producer = blobs[matmul->bottoms[j]].producer;
+            if (producer != -1 && layers[producer]->type == "MemoryData")
+                has_constant_operand = true;
+        }
+
+        if (!has_constant_operand)
+            continue;
+
+        fprintf(stderr, "quantize_matmul %s\n", matmul->name.c_str());
+
+        // A is quantized per row and B per tensor at runtime
+        matmul->int8_scale_term = 2;
     }
 
     return 0;
@@ -1045,11 +1377,120 @@ int NetQuantize::fuse_requantize()
     return 0;
 }
 
+int NetQuantize::quantize_weight_only()
+{
+    ncnn::Option opt_q = opt;
+    opt_q.blob_allocator = 0;
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (layers[i]->type == "InnerProduct")
+        {
+            // InnerProduct - quantize weight from fp32 to weight-only int8 or int4
+            ncnn::InnerProduct* fc = (ncnn::InnerProduct*)layers[i];
+
+            fprintf(stderr, "quantize_weight_only %s\n", fc->name.c_str());
+
+            const int num_input = fc->weight_data_size / fc->num_output;
+
+            ncnn::Mat weight_data_r2 = fc->weight_data.reshape(num_input, fc->num_output);
+
+            ncnn::Mat weight_data_quant;
+            ncnn::Mat weight_data_quant_scales;
+            quantize_weight_quant(weight_data_r2, weight_data_quant, weight_data_quant_scales, num_input, weight_only_bits, weight_only_group_size, opt_q);
+            if (weight_data_quant.empty())
+                return -100;
+
+            fc->weight_data = weight_data_quant;
+            fc->weight_data_quant_scales = weight_data_quant_scales;
+            fc->weight_quant_bits = weight_only_bits;
+            fc->weight_quant_group_size = weight_only_group_size;
+        }
+
+        if (layers[i]->type == "Gemm")
+        {
+            // Gemm - quantize constant A or B from fp32 to weight-only int8 or int4
+            ncnn::Gemm* gemm = (ncnn::Gemm*)layers[i];
+
+            // one constant operand only
+            if (gemm->constantA == gemm->constantB)
+                continue;
+
+            fprintf(stderr, "quantize_weight_only %s\n", gemm->name.c_str());
+
+            if (gemm->constantA)
+            {
+                if (gemm->transA == 1)
+                {
+                    // transpose for row-wise quantization
+                    ncnn::Mat A_data_transposed(gemm->constantK * gemm->constantM);
+                    for (int i = 0; i < gemm->constantM; i++)
+                    {
+                        float* ptr = (float*)A_data_transposed + i * gemm->constantK;
+                        for (int j = 0; j < gemm->constantK; j++)
+                        {
+                            ptr[j] = gemm->A_data[j * gemm->constantM + i];
+                        }
+                    }
+                    gemm->A_data = A_data_transposed;
+                    gemm->transA = 0;
+                }
+
+                ncnn::Mat A_data = gemm->A_data.reshape(gemm->constantK, gemm->constantM);
+
+                ncnn::Mat A_data_quant;
+                ncnn::Mat A_data_quant_scales;
+                quantize_weight_quant(A_data, A_data_quant, A_data_quant_scales, gemm->constantK, weight_only_bits, weight_only_group_size, opt_q);
+                if (A_data_quant.empty())
+                    return -100;
+
+                gemm->A_data = A_data_quant;
+                gemm->A_data_quant_scales = A_data_quant_scales;
+            }
+
+            if (gemm->constantB)
+            {
+                if (gemm->transB == 0)
+                {
+                    // transpose for row-wise quantization
+                    ncnn::Mat B_data_transposed(gemm->constantK * gemm->constantN);
+                    for (int i = 0; i < gemm->constantN; i++)
+                    {
+                        float* ptr = (float*)B_data_transposed + i * gemm->constantK;
+                        for (int j = 0; j < gemm->constantK; j++)
+                        {
+                            ptr[j] = gemm->B_data[j * gemm->constantN + i];
+                        }
+                    }
+                    gemm->B_data = B_data_transposed;
+                    gemm->transB = 1;
+                }
+
+                ncnn::Mat B_data = gemm->B_data.reshape(gemm->constantK, gemm->constantN);
+
+                ncnn::Mat B_data_quant;
+                ncnn::Mat B_data_quant_scales;
+                quantize_weight_quant(B_data, B_data_quant, B_data_quant_scales, gemm->constantK, weight_only_bits, weight_only_group_size, opt_q);
+                if (B_data_quant.empty())
+                    return -100;
+
+                gemm->B_data = B_data_quant;
+                gemm->B_data_quant_scales = B_data_quant_scales;
+            }
+
+            gemm->weight_quant_bits = weight_only_bits;
+            gemm->weight_quant_group_size = weight_only_group_size;
+        }
+    }
+
+    return 0;
+}
+
 int main(int argc, char** argv)
 {
-    if (argc != 5 && argc != 6)
+    if (argc < 5)
     {
-        fprintf(stderr, "usage: %s [inparam] [inbin] [outparam] [outbin] [calibration table]\n", argv[0]);
+        fprintf(stderr, "usage: %s [inparam] [inbin] [outparam] [outbin] [calibration table] [weight_only=8/4] [group_size=N]\n", argv[0]);
         return -1;
     }
 
@@ -1057,11 +1498,52 @@ int main(int argc, char** argv)
     const char* inbin = argv[2];
     const char* outparam = argv[3];
     const char* outbin = argv[4];
-    const char* int8scale_table_path = argc == 6 ? argv[5] : NULL;
+    const char* int8scale_table_path = NULL;
 
     NetQuantize quantizer;
     quantizer.storage_type = 1; // use fp16 where int8 not applied
 
+    for (int i = 5; i < argc; i++)
+    {
+        // key=value options, anything else is the calibration table
+        const char* eq = strchr(argv[i], '=');
+        if (!eq)
+        {
+            int8scale_table_path = argv[i];
+            continue;
+        }
+
+        std::string key(argv[i], eq - argv[i]);
+        const char* value = eq + 1;
+
+        if (key == "weight_only")
+        {
+            if (strcmp(value, "8") == 0 || strcmp(value, "int8") == 0)
+                quantizer.weight_only_bits = 8;
+            else if (strcmp(value, "4") == 0 || strcmp(value, "int4") == 0)
+                quantizer.weight_only_bits = 4;
+            else
+            {
+                fprintf(stderr, "unsupported weight_only %s\n", value);
+                return -1;
+            }
+        }
+        else if (key == "group_size")
+        {
+            quantizer.weight_only_group_size = atoi(value);
+            if (quantizer.weight_only_group_size < 0)
+            {
+                fprintf(stderr, "invalid group_size %s\n", value);
+                return -1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return -1;
+        }
+    }
+
     // parse the calibration scale table
     if (int8scale_table_path)
     {
@@ -1085,14 +1567,31 @@ int main(int argc, char** argv)
 
     quantizer.quantize_convolution();
     quantizer.quantize_convolutiondepthwise();
-    quantizer.quantize_innerproduct();
+    quantizer.quantize_deconvolution();
+    quantizer.quantize_deconvolutiondepthwise();
+    quantizer.quantize_convolution1d();
+    quantizer.quantize_convolutiondepthwise1d();
+
+    if (quantizer.weight_only_bits)
+    {
+        // InnerProduct and Gemm keep float32 activations
+        quantizer.quantize_weight_only();
+    }
+    else
+    {
+        quantizer.quantize_innerproduct();
+    }
 
     quantizer.quantize_rnn();
     quantizer.quantize_lstm();
     quantizer.quantize_gru();
     quantizer.quantize_embed();
-    quantizer.quantize_gemm();
+    if (!quantizer.weight_only_bits)
+    {
+        quantizer.quantize_gemm();
+    }
     quantizer.quantize_multiheadattention();
+    quantizer.quantize_matmul();
 
     quantizer.fuse_requantize();
 
@@ -36,8 +36,17 @@
 
 // ncnn private header
 #include "layer/convolution.h"
+#include "layer/convolution1d.h"
 #include "layer/convolutiondepthwise.h"
+#include "layer/convolutiondepthwise1d.h"
+#include "layer/deconvolution.h"
+#include "layer/deconvolutiondepthwise.h"
+#include "layer/gemm.h"
+#include "layer/gru.h"
 #include "layer/innerproduct.h"
+#include "layer/lstm.h"
+#include "layer/multiheadattention.h"
+#include "layer/rnn.h"
 
 class QuantBlobStat
 {
@@ -92,6 +101,10 @@ public:
     std::vector<int> conv_bottom_blobs;
     std::vector<int> conv_top_blobs;
 
+    // owner layer of each calibrated bottom blob
+    // the conv layers come first, followed by the dynamic quantized layers that take static input scales
+    std::vector<int> bottom_blob_layers;
+
     // result
     std::vector<QuantBlobStat> quant_blob_stats;
     std::vector<ncnn::Mat> weight_scales;
@@ -120,11 +133,53 @@ int QuantNet::init()
     for (int i = 0; i < (int)layers.size(); i++)
     {
         const ncnn::Layer* layer = layers[i];
-        if (layer->type == "Convolution" || layer->type == "ConvolutionDepthWise" || layer->type == "InnerProduct")
+        if (layer->type == "Convolution" || layer->type == "ConvolutionDepthWise" || layer->type == "InnerProduct" || layer->type == "Deconvolution" || layer->type == "DeconvolutionDepthWise" || layer->type == "Convolution1D" || layer->type == "ConvolutionDepthWise1D")
         {
             conv_layers.push_back(i);
             conv_bottom_blobs.push_back(layer->bottoms[0]);
             conv_top_blobs.push_back(layer->tops[0]);
+            bottom_blob_layers.push_back(i);
+        }
+    }
+
+    // find the input blobs of gemm, attention and recurrent layers
+    for (int i = 0; i < (int)layers.size(); i++)
+    {
+        const ncnn::Layer* layer = layers[i];
+        if (layer->type == "Gemm")
+        {
+            const ncnn::Gemm* gemm = (const ncnn::Gemm*)layer;
+
+            // non-constant A and B in order
+            const int input_count = (gemm->constantA ? 0 : 1) + (gemm->constantB ? 0 : 1);
+            for (int j = 0; j < input_count; j++)
+            {
+                conv_bottom_blobs.push_back(layer->bottoms[j]);
+                bottom_blob_layers.push_back(i);
+            }
+        }
+        if (layer->type == "MultiHeadAttention")
+        {
+            const ncnn::MultiHeadAttention* mha = (const ncnn::MultiHeadAttention*)layer;
+
+            const bool use_kv_cache = mha->kv_cache && layer->tops.size() == 3;
+            const size_t input_blob_count = use_kv_cache ? layer->bottoms.size() - 2 : layer->bottoms.size();
+
+            const int q_blob = layer->bottoms[0];
+            const int k_blob = (input_blob_count == 1 || (input_blob_count == 2 && mha->attn_mask)) ? q_blob : layer->bottoms[1];
+            const int v_blob = (input_blob_count == 1 || (input_blob_count == 2 && mha->attn_mask)) ? q_blob : (input_blob_count == 2 || (input_blob_count == 3 && mha->attn_mask)) ? k_blob : layer->bottoms[2];
+
+            conv_bottom_blobs.push_back(q_blob);
+            conv_bottom_blobs.push_back(k_blob);
+            conv_bottom_blobs.push_back(v_blob);
+            bottom_blob_layers.push_back(i);
+            bottom_blob_layers.push_back(i);
+            bottom_blob_layers.push_back(i);
+        }
+        if (layer->type == "RNN" || layer->type == "LSTM" || layer->type == "GRU")
+        {
+            conv_bottom_blobs.push_back(layer->bottoms[0]);
+            bottom_blob_layers.push_back(i);
         }
     }
 
@@ -166,14 +221,24 @@ int QuantNet::save_table(const char* tablepath)
 
     for (int i = 0; i < conv_bottom_blob_count; i++)
     {
-        const ncnn::Mat& bottom_blob_scale = bottom_blob_scales[i];
+        const int layer_index = bottom_blob_layers[i];
+
+        // the scales of all inputs of one layer go into one line
+        if (i == 0 || bottom_blob_layers[i - 1] != layer_index)
+        {
+            fprintf(fp, "%s ", layers[layer_index]->name.c_str());
+        }
 
-        fprintf(fp, "%s ", layers[conv_layers[i]]->name.c_str());
+        const ncnn::Mat& bottom_blob_scale = bottom_blob_scales[i];
         for (int j = 0; j < bottom_blob_scale.w; j++)
         {
             fprintf(fp, "%f ", bottom_blob_scale[j]);
         }
-        fprintf(fp, "\n");
+
+        if (i + 1 == conv_bottom_blob_count || bottom_blob_layers[i + 1] != layer_index)
+        {
+            fprintf(fp, "\n");
+        }
     }
 
     fclose(fp);
@@ -191,7 +256,7 @@ void QuantNet::print_quant_info() const
 
         float scale = 127 / stat.threshold;
 
-        fprintf(stderr, "%-40s : max = %-15f  threshold = %-15f  scale = %-15f\n", layers[conv_layers[i]]->name.c_str(), stat.absmax, stat.threshold, scale);
+        fprintf(stderr, "%-40s : max = %-15f  threshold = %-15f  scale = %-15f\n", layers[bottom_blob_layers[i]]->name.c_str(), stat.absmax, stat.threshold, scale);
     }
 }
 
@@ -405,6 +470,98 @@ int QuantNet::quantize_KL()
                 weight_scales[i][n] = 127 / absmax;
             }
         }
+
+        if (layer->type == "Deconvolution")
+        {
+            const ncnn::Deconvolution* deconvolution = (const ncnn::Deconvolution*)layer;
+
+            const int num_output = deconvolution->num_output;
+            const int weight_data_size_output = deconvolution->weight_data_size / num_output;
+
+            weight_scales[i].create(num_output);
+
+            for (int n = 0; n < num_output; n++)
+            {
+                const ncnn::Mat weight_data_n = deconvolution->weight_data.range(weight_data_size_output * n, weight_data_size_output);
+
+                float absmax = 0.f;
+                for (int k = 0; k < weight_data_size_output; k++)
+                {
+                    absmax = std::max(absmax, (float)fabs(weight_data_n[k]));
+                }
+
+                weight_scales[i][n] = 127 / absmax;
+            }
+        }
+
+        if (layer->type == "DeconvolutionDepthWise")
+        {
+            const ncnn::DeconvolutionDepthWise* deconvolutiondepthwise = (const ncnn::DeconvolutionDepthWise*)layer;
+
+            const int group = deconvolutiondepthwise->group;
+            const int weight_data_size_output = deconvolutiondepthwise->weight_data_size / group;
+
+            weight_scales[i].create(group);
+
+            for (int n = 0; n < group; n++)
+            {
+                const ncnn::Mat weight_data_n = deconvolutiondepthwise->weight_data.range(weight_data_size_output * n, weight_data_size_output);
+
+                float absmax = 0.f;
+                for (int k = 0; k < weight_data_size_output; k++)
+                {
+                    absmax = std::max(absmax, (float)fabs(weight_data_n[k]));
+                }
+
+                weight_scales[i][n] = 127 / absmax;
+            }
+        }
+
+        if (layer->type == "Convolution1D")
+        {
+            const ncnn::Convolution1D* convolution1d = (const ncnn::Convolution1D*)layer;
+
+            const int num_output = convolution1d->num_output;
+            const int weight_data_size_output = convolution1d->weight_data_size / num_output;
+
+            weight_scales[i].create(num_output);
+
+            for (int n = 0; n < num_output; n++)
+            {
+                const ncnn::Mat weight_data_n = convolution1d->weight_data.range(weight_data_size_output * n, weight_data_size_output);
+
+                float absmax = 0.f;
+                for (int k = 0; k < weight_data_size_output; k++)
+                {
+                    absmax = std::max(absmax, (float)fabs(weight_data_n[k]));
+                }
+
+                weight_scales[i][n] = 127 / absmax;
+            }
+        }
+
+        if (layer->type == "ConvolutionDepthWise1D")
+        {
+            const ncnn::ConvolutionDepthWise1D* convolutiondepthwise1d = (const ncnn::ConvolutionDepthWise1D*)layer;
+
+            const int group = convolutiondepthwise1d->group;
+            const int weight_data_size_output = convolutiondepthwise1d->weight_data_size / group;
+
+            weight_scales[i].create(group);
+
+            for (int n = 0; n < group; n++)
+            {
+                const ncnn::Mat weight_data_n = convolutiondepthwise1d->weight_data.range(weight_data_size_output * n, weight_data_size_output);
+
+                float absmax = 0.f;
+                for (int k = 0; k < weight_data_size_output; k++)
+                {
+                    absmax = std::max(absmax, (float)fabs(weight_data_n[k]));
+                }
+
+                weight_scales[i][n] = 127 / absmax;
+            }
+        }
     }
 
     // count the absmax
@@ -885,6 +1042,102 @@ int QuantNet::quantize_ACIQ()
                 weight_scales[i][n] = 127 / threshold;
             }
         }
+
+        if (layer->type == "Deconvolution")
+        {
+            const ncnn::Deconvolution* deconvolution = (const ncnn::Deconvolution*)layer;
+
+            const int num_output = deconvolution->num_output;
+            const int weight_data_size_output = deconvolution->weight_data_size / num_output;
+
+            weight_scales[i].create(num_output);
+
+            for (int n = 0; n < num_output; n++)
+            {
+                const ncnn::Mat weight_data_n = deconvolution->weight_data.range(weight_data_size_output * n, weight_data_size_output);
+
+                float absmax = 0.f;
+                for (int k = 0; k < weight_data_size_output; k++)
+                {
+                    absmax = std::max(absmax, (float)fabs(weight_data_n[k]));
+                }
+
+                const float threshold = compute_aciq_gaussian_clip(absmax, weight_data_size_output);
+                weight_scales[i][n] = 127 / threshold;
+            }
+        }
+
+        if (layer->type == "DeconvolutionDepthWise")
+        {
+            const ncnn::DeconvolutionDepthWise* deconvolutiondepthwise = (const ncnn::DeconvolutionDepthWise*)layer;
+
+            const int group = deconvolutiondepthwise->group;
+            const int weight_data_size_output = deconvolutiondepthwise->weight_data_size / group;
+
+            weight_scales[i].create(group);
+
+            for (int n = 0; n < group; n++)
+            {
+                const ncnn::Mat weight_data_n = deconvolutiondepthwise->weight_data.range(weight_data_size_output * n, weight_data_size_output);
+
+                float absmax = 0.f;
+                for (int k = 0; k < weight_data_size_output; k++)
+                {
+                    absmax = std::max(absmax, (float)fabs(weight_data_n[k]));
+                }
+
+                const float threshold = compute_aciq_gaussian_clip(absmax, weight_data_size_output);
+                weight_scales[i][n] = 127 / threshold;
+            }
+        }
+
+        if (layer->type == "Convolution1D")
+        {
+            const ncnn::Convolution1D* convolution1d = (const ncnn::Convolution1D*)layer;
+
+            const int num_output = convolution1d->num_output;
+            const int weight_data_size_output = convolution1d->weight_data_size / num_output;
+
+            weight_scales[i].create(num_output);
+
+            for (int n = 0; n < num_output; n++)
+            {
+                const ncnn::Mat weight_data_n = convolution1d->weight_data.range(weight_data_size_output * n, weight_data_size_output);
+
+                float absmax = 0.f;
+                for (int k = 0; k < weight_data_size_output; k++)
+                {
+                    absmax = std::max(absmax, (float)fabs(weight_data_n[k]));
+                }
+
+                const float threshold = compute_aciq_gaussian_clip(absmax, weight_data_size_output);
+                weight_scales[i][n] = 127 / threshold;
+            }
+        }
+
+        if (layer->type == "ConvolutionDepthWise1D")
+        {
+            const ncnn::ConvolutionDepthWise1D* convolutiondepthwise1d = (const ncnn::ConvolutionDepthWise1D*)layer;
+
+            const int group = convolutiondepthwise1d->group;
+            const int weight_data_size_output = convolutiondepthwise1d->weight_data_size / group;
+
+            weight_scales[i].create(group);
+
+            for (int n = 0; n < group; n++)
+            {
+                const ncnn::Mat weight_data_n = convolutiondepthwise1d->weight_data.range(weight_data_size_output * n, weight_data_size_output);
+
+                float absmax = 0.f;
+                for (int k = 0; k < weight_data_size_output; k++)
+                {
+                    absmax = std::max(absmax, (float)fabs(weight_data_n[k]));
+                }
+
+                const float threshold = compute_aciq_gaussian_clip(absmax, weight_data_size_output);
+                weight_scales[i][n] = 127 / threshold;
+            }
+        }
     }
 
     // count the absmax
@@ -1060,6 +1313,92 @@ static int get_layer_param(const ncnn::Layer* layer, ncnn::ParamDict& pd)
         pd.set(9, innerproduct->activation_type);
         pd.set(10, innerproduct->activation_params);
     }
+    else if (layer->type == "Deconvolution")
+    {
+        ncnn::Deconvolution* deconvolution = (ncnn::Deconvolution*)layer;
+
+        pd.set(0, deconvolution->num_output);
+        pd.set(1, deconvolution->kernel_w);
+        pd.set(11, deconvolution->kernel_h);
+        pd.set(2, deconvolution->dilation_w);
+        pd.set(12, deconvolution->dilation_h);
+        pd.set(3, deconvolution->stride_w);
+        pd.set(13, deconvolution->stride_h);
+        pd.set(4, deconvolution->pad_left);
+        pd.set(15, deconvolution->pad_right);
+        pd.set(14, deconvolution->pad_top);
+        pd.set(16, deconvolution->pad_bottom);
+        pd.set(18, deconvolution->output_pad_right);
+        pd.set(19, deconvolution->output_pad_bottom);
+        pd.set(20, deconvolution->output_w);
+        pd.set(21, deconvolution->output_h);
+        pd.set(5, deconvolution->bias_term);
+        pd.set(6, deconvolution->weight_data_size);
+        pd.set(8, deconvolution->int8_scale_term);
+        pd.set(9, deconvolution->activation_type);
+        pd.set(10, deconvolution->activation_params);
+    }
+    else if (layer->type == "DeconvolutionDepthWise")
+    {
+        ncnn::DeconvolutionDepthWise* deconvolutiondepthwise = (ncnn::DeconvolutionDepthWise*)layer;
+
+        pd.set(0, deconvolutiondepthwise->num_output);
+        pd.set(1, deconvolutiondepthwise->kernel_w);
+        pd.set(11, deconvolutiondepthwise->kernel_h);
+        pd.set(2, deconvolutiondepthwise->dilation_w);
+        pd.set(12, deconvolutiondepthwise->dilation_h);
+        pd.set(3, deconvolutiondepthwise->stride_w);
+        pd.set(13, deconvolutiondepthwise->stride_h);
+        pd.set(4, deconvolutiondepthwise->pad_left);
+        pd.set(15, deconvolutiondepthwise->pad_right);
+        pd.set(14, deconvolutiondepthwise->pad_top);
+        pd.set(16, deconvolutiondepthwise->pad_bottom);
+        pd.set(18, deconvolutiondepthwise->output_pad_right);
+        pd.set(19, deconvolutiondepthwise->output_pad_bottom);
+        pd.set(20, deconvolutiondepthwise->output_w);
+        pd.set(21, deconvolutiondepthwise->output_h);
+        pd.set(5, deconvolutiondepthwise->bias_term);
+        pd.set(6, deconvolutiondepthwise->weight_data_size);
+        pd.set(7, deconvolutiondepthwise->group);
+        pd.set(8, deconvolutiondepthwise->int8_scale_term);
+        pd.set(9, deconvolutiondepthwise->activation_type);
+        pd.set(10, deconvolutiondepthwise->activation_params);
+    }
+    else if (layer->type == "Convolution1D")
+    {
+        ncnn::Convolution1D* convolution1d = (ncnn::Convolution1D*)layer;
+
+        pd.set(0, convolution1d->num_output);
+        pd.set(1, convolution1d->kernel_w);
+        pd.set(2, convolution1d->dilation_w);
+        pd.set(3, convolution1d->stride_w);
+        pd.set(4, convolution1d->pad_left);
+        pd.set(15, convolution1d->pad_right);
+        pd.set(18, convolution1d->pad_value);
+        pd.set(5, convolution1d->bias_term);
+        pd.set(6, convolution1d->weight_data_size);
+        pd.set(8, convolution1d->int8_scale_term);
+        pd.set(9, convolution1d->activation_type);
+        pd.set(10, convolution1d->activation_params);
+    }
+    else if (layer->type == "ConvolutionDepthWise1D")
+    {
+        ncnn::ConvolutionDepthWise1D* convolutiondepthwise1d = (ncnn::ConvolutionDepthWise1D*)layer;
+
+        pd.set(0, convolutiondepthwise1d->num_output);
+        pd.set(1, convolutiondepthwise1d->kernel_w);
+        pd.set(2, convolutiondepthwise1d->dilation_w);
+        pd.set(3, convolutiondepthwise1d->stride_w);
+        pd.set(4, convolutiondepthwise1d->pad_left);
+        pd.set(15, convolutiondepthwise1d->pad_right);
+        pd.set(18, convolutiondepthwise1d->pad_value);
+        pd.set(5, convolutiondepthwise1d->bias_term);
+        pd.set(6, convolutiondepthwise1d->weight_data_size);
+        pd.set(7, convolutiondepthwise1d->group);
+        pd.set(8, convolutiondepthwise1d->int8_scale_term);
+        pd.set(9, convolutiondepthwise1d->activation_type);
+        pd.set(10, convolutiondepthwise1d->activation_params);
+    }
     else
     {
         fprintf(stderr, "unexpected layer type %s in get_layer_param\n", layer->type.c_str());
@@ -1092,6 +1431,34 @@ static int get_layer_weights(const ncnn::Layer* layer, std::vector<ncnn::Mat>& w
         if (innerproduct->bias_term)
             weights.push_back(innerproduct->bias_data);
     }
+    else if (layer->type == "Deconvolution")
+    {
+        ncnn::Deconvolution* deconvolution = (ncnn::Deconvolution*)layer;
+        weights.push_back(deconvolution->weight_data);
+        if (deconvolution->bias_term)
+            weights.push_back(deconvolution->bias_data);
+    }
+    else if (layer->type == "DeconvolutionDepthWise")
+    {
+        ncnn::DeconvolutionDepthWise* deconvolutiondepthwise = (ncnn::DeconvolutionDepthWise*)layer;
+        weights.push_back(deconvolutiondepthwise->weight_data);
+        if (deconvolutiondepthwise->bias_term)
+            weights.push_back(deconvolutiondepthwise->bias_data);
+    }
+    else if (layer->type == "Convolution1D")
+    {
+        ncnn::Convolution1D* convolution1d = (ncnn::Convolution1D*)layer;
+        weights.push_back(convolution1d->weight_data);
+        if (convolution1d->bias_term)
+            weights.push_back(convolution1d->bias_data);
+    }
+    else if (layer->type == "ConvolutionDepthWise1D")
+    {
+        ncnn::ConvolutionDepthWise1D* convolutiondepthwise1d = (ncnn::ConvolutionDepthWise1D*)layer;
+        weights.push_back(convolutiondepthwise1d->weight_data);
+        if (convolutiondepthwise1d->bias_term)
+            weights.push_back(convolutiondepthwise1d->bias_data);
+    }
     else
     {
         fprintf(stderr, "unexpected layer type %s in get_layer_weights\n", layer->type.c_str());
@@ -1368,6 +1735,15 @@ int QuantNet::quantize_EQ()
         stat.threshold = 127 / bottom_blob_scale[0];
     }
 
+    // eq searches against the int8 conv kernels only
+    // gemm, attention and recurrent input scales stay at the kl result
+    for (int i = conv_layer_count; i < conv_bottom_blob_count; i++)
+    {
+        const ncnn::Layer* layer = layers[bottom_blob_layers[i]];
+
+        fprintf(stderr, "%s b = %f  eq is not supported for %s, keep kl scale\n", layer->name.c_str(), bottom_blob_scales[i][0], layer->type.c_str());
+    }
+
     return 0;
 }
 